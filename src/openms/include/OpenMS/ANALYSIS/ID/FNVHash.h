@@ -0,0 +1,96 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+namespace OpenMS
+{
+  namespace Internal
+  {
+    /**
+      @brief Incremental 64 bit FNV-1a hash
+
+      Used to derive cache keys and signatures from protein databases and search settings.
+      It is fast and stable across platforms, but not a cryptographic hash.
+    */
+    class FNVHash
+    {
+    public:
+      /// adds @p size bytes starting at @p data
+      void add(const char* data, Size size)
+      {
+        for (Size i = 0; i < size; ++i)
+        {
+          hash_ = (hash_ ^ UInt64((unsigned char)data[i])) * 1099511628211ull;
+        }
+      }
+
+      /// adds the single byte @p c (e.g. a separator)
+      void add(char c)
+      {
+        add(&c, 1);
+      }
+
+      /// adds @p s including its terminating zero, which separates consecutive strings
+      void add(const String& s)
+      {
+        add(s.c_str(), s.size() + 1);
+      }
+
+      /// the hash of all data added so far
+      UInt64 getHash() const
+      {
+        return hash_;
+      }
+
+      /// the hash as 16 hexadecimal digits
+      String toHex() const
+      {
+        static const char digits[] = "0123456789abcdef";
+        String hex(16, '0');
+        for (Size i = 0; i < 16; ++i)
+        {
+          hex[15 - i] = digits[(hash_ >> (4 * i)) & 0xf];
+        }
+        return hex;
+      }
+
+    private:
+      UInt64 hash_ = 14695981039346656037ull;
+    };
+  }
+}
@@ -92,6 +92,9 @@ public:
     /**
     @brief Calculates the FDR of one run from a concatenated sequence DB search.    
 
+    Scores, target/decoy labels and charges of all hits are first extracted into flat arrays; sorting and the
+    write-back of the results are parallelized with OpenMP. Results do not depend on the number of threads.
+
     @param id peptide identifications, containing target and decoy hits
     @param annotate_peptide_fdr adds the peptide q-value or peptide fdr meta value to each PSM. Calculation uses best PSM per peptide.
     */
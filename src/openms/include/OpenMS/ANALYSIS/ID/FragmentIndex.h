@@ -0,0 +1,217 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Inverted index from binned fragment m/z to the peptides producing these fragments.
+
+    The index is used to quickly find candidate peptides for a spectrum
+    without generating and scoring the theoretical spectra of all peptides
+    in the precursor mass window (see e.g. Kong et al., MSFragger,
+    Nat. Methods 2017).
+
+    Peptides are sorted by mass and identified by their position in this
+    order. The fragment m/z range is split into bins of equal width and each
+    bin stores the (sorted) ids of all peptides with a fragment in it. The
+    peptides of a precursor mass window form a contiguous id range, so a
+    query only needs to count, for every peak of a spectrum, the peptides of
+    the bins overlapping the fragment tolerance window that fall into this
+    range. Candidates sharing many peaks with the spectrum can then be scored
+    in full using the fragments stored in the index (getSpectrum()).
+
+    Since fragments are only compared by bin, the shared peak count is an
+    approximation (up to one bin width) of the number of matching peaks.
+
+    The index can be stored to and loaded from a binary file, so it only
+    needs to be built once per database. A free-form signature (e.g.
+    describing database and digestion settings) can be stored with it to
+    check whether a stored index is still valid.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI FragmentIndex
+  {
+public:
+    /// A peptide in the index
+    struct Peptide
+    {
+      String sequence; ///< unmodified sequence
+      Size modification_index = 0; ///< index of the modified variant (as enumerated by ModifiedPeptideGenerator)
+      double mass = 0.0; ///< monoisotopic mass of the modified peptide
+    };
+
+    /// A (singly charged) fragment of a peptide
+    struct Fragment
+    {
+      double mz = 0.0; ///< fragment m/z
+      float intensity = 1.0f; ///< intensity of the theoretical peak
+      char ion_type = ' '; ///< ion type, e.g. 'b' or 'y'
+    };
+
+    /// Default constructor (bin width 0.02 Th)
+    FragmentIndex();
+
+    /// Constructor with the width of the fragment m/z bins (in Th)
+    explicit FragmentIndex(double bin_width);
+
+    /**
+      @brief Builds the index
+
+      Peptides are sorted by mass (ties by sequence and modification index)
+      and their ids refer to this order, not to the order of @p peptides.
+
+      @param peptides The peptides
+      @param fragments The fragments of each peptide (same order as @p peptides)
+
+      @exception Exception::InvalidSize if the number of fragment lists does not match the number of peptides
+    */
+    void build(std::vector<Peptide> peptides, const std::vector<std::vector<Fragment>>& fragments);
+
+    /// Removes all peptides and fragments
+    void clear();
+
+    /// Returns the number of peptides
+    Size size() const;
+
+    /// Returns true if no peptides are indexed
+    bool empty() const;
+
+    /// Returns the width of the fragment m/z bins (in Th)
+    double getBinWidth() const;
+
+    /// Returns the peptides (sorted by mass)
+    const std::vector<Peptide>& getPeptides() const;
+
+    /// Returns the peptide with the given @p id
+    const Peptide& getPeptide(Size id) const;
+
+    /// Returns the signature stored with the index
+    const String& getSignature() const;
+
+    /// Sets the signature stored with the index
+    void setSignature(const String& signature);
+
+    /**
+      @brief Returns the range of peptide ids [first, second) with mass in [@p min_mass, @p max_mass]
+    */
+    std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const;
+
+    /**
+      @brief Creates the theoretical spectrum of the peptide with the given @p id
+
+      Peaks are sorted by m/z. The ion types are stored as first
+      StringDataArray ("IonNames"), as expected by HyperScore.
+    */
+    void getSpectrum(Size id, PeakSpectrum& spectrum) const;
+
+    /**
+      @brief Counts the peaks of @p spectrum shared with each peptide in the mass range [@p min_mass, @p max_mass]
+
+      A peak is shared with a peptide, if the peptide has a fragment in one
+      of the bins overlapping the tolerance window around the peak. Every
+      peak is counted at most once per peptide.
+
+      @param spectrum The (centroided) spectrum
+      @param min_mass Minimal peptide mass
+      @param max_mass Maximal peptide mass
+      @param fragment_tolerance Fragment mass tolerance (applied left and right of each peak)
+      @param fragment_tolerance_ppm Unit of the fragment mass tolerance is ppm (Th otherwise)
+      @param min_shared_peaks Only peptides sharing at least this many peaks are reported
+      @param candidates Pairs of peptide id and shared peak count are appended here (sorted by id)
+    */
+    void query(const PeakSpectrum& spectrum,
+               double min_mass,
+               double max_mass,
+               double fragment_tolerance,
+               bool fragment_tolerance_ppm,
+               Size min_shared_peaks,
+               std::vector<std::pair<Size, Size>>& candidates) const;
+
+    /**
+      @brief Stores the index in a binary file
+
+      @exception Exception::UnableToCreateFile if the file cannot be written
+    */
+    void store(const String& filename) const;
+
+    /**
+      @brief Loads the index from a binary file (written by store())
+
+      @exception Exception::FileNotFound if the file cannot be opened
+      @exception Exception::ParseError if the file is not a valid fragment index
+    */
+    void load(const String& filename);
+
+protected:
+    /// width of the fragment m/z bins
+    double bin_width_;
+
+    /// free-form signature
+    String signature_;
+
+    /// peptides (sorted by mass)
+    std::vector<Peptide> peptides_;
+
+    /// masses of the peptides (for binary search)
+    std::vector<double> masses_;
+
+    /// start of the fragments of each peptide in fragment_mz_ (size: number of peptides + 1)
+    std::vector<UInt64> fragment_offsets_;
+
+    /// fragment m/z (sorted per peptide)
+    std::vector<double> fragment_mz_;
+
+    /// fragment intensities
+    std::vector<float> fragment_intensity_;
+
+    /// fragment ion types
+    std::vector<char> fragment_type_;
+
+    /// start of the peptide ids of each bin in bin_peptides_ (size: number of bins + 1)
+    std::vector<UInt64> bin_offsets_;
+
+    /// peptide ids of each bin (sorted per bin)
+    std::vector<UInt32> bin_peptides_;
+  };
+
+} // namespace OpenMS
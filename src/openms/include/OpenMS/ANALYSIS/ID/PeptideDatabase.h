@@ -0,0 +1,221 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Precomputed table of the (modified) peptides of a protein database
+
+    Digesting a protein database and enumerating the modified variants of
+    all peptides (using ProteaseDigestion and ModifiedPeptideGenerator)
+    takes a considerable amount of time for large databases. This class
+    stores the result as a table sorted by monoisotopic mass that can be
+    written to disk and memory-mapped on later runs, so it is computed only
+    once for a database and a set of digestion settings.
+
+    Each entry consists of the unmodified sequence, the modified sequence
+    (as written by AASequence::toString()), the index of the modified
+    variant (in the order enumerated by ModifiedPeptideGenerator), the
+    monoisotopic mass and the indices of all proteins containing the
+    peptide. Peptides containing the ambiguous amino acids X, B or Z are
+    skipped.
+
+    Tables are identified by a key (see getCacheKey()) that combines the
+    digestion settings with a hash of the protein sequences. loadOrBuild()
+    uses the key to reuse a table from a cache directory, or to build and
+    store it there if no matching table exists.
+
+    The file format is a flat binary image of the table (in native byte
+    order), so a loaded table is accessed directly in the mapped file
+    without any parsing or copying.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI PeptideDatabase
+  {
+public:
+    /// Digestion and modification settings a table depends on
+    struct OPENMS_DLLAPI Settings
+    {
+      String enzyme = "Trypsin"; ///< name of the enzyme (see ProteaseDB)
+      Size missed_cleavages = 1; ///< maximal number of missed cleavages
+      Size min_size = 7; ///< minimal peptide length
+      Size max_size = 40; ///< maximal peptide length (0 = disabled)
+      StringList fixed_modifications; ///< fixed modifications (UniMod names, e.g. 'Carbamidomethyl (C)')
+      StringList variable_modifications; ///< variable modifications (UniMod names, e.g. 'Oxidation (M)')
+      Size max_variable_mods_per_peptide = 2; ///< maximal number of variable modifications per peptide
+
+      /// Returns a textual description of the settings (part of the cache key)
+      String toString() const;
+    };
+
+    /// Default constructor (empty table)
+    PeptideDatabase();
+
+    /// Copying is not allowed (a loaded table is backed by a memory mapping)
+    PeptideDatabase(const PeptideDatabase&) = delete;
+    PeptideDatabase& operator=(const PeptideDatabase&) = delete;
+
+    /// Move constructor
+    PeptideDatabase(PeptideDatabase&&) = default;
+
+    /// Move assignment operator
+    PeptideDatabase& operator=(PeptideDatabase&&) = default;
+
+    /**
+      @brief Digests @p proteins and builds the table of all (modified) peptides
+
+      The key of the table is set to getCacheKey(@p proteins, @p settings).
+
+      @exception Exception::ElementNotFound if the enzyme or a modification is unknown
+    */
+    void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings);
+
+    /**
+      @brief Writes the table to a binary file
+
+      @exception Exception::UnableToCreateFile if the file cannot be written
+    */
+    void store(const String& filename) const;
+
+    /**
+      @brief Memory-maps a table written by store()
+
+      @exception Exception::FileNotFound if the file does not exist
+      @exception Exception::ParseError if the file is not a valid peptide table
+    */
+    void load(const String& filename);
+
+    /**
+      @brief Loads the table for @p proteins and @p settings from @p cache_dir or builds (and stores) it
+
+      The table is stored in a file named after the hash of its key, so
+      tables for different databases or settings can share a directory.
+      The file is written under a temporary name and renamed afterwards, so
+      concurrent runs never read incomplete files.
+
+      @return true if a matching table was found in the cache directory
+    */
+    bool loadOrBuild(const String& cache_dir, const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings);
+
+    /// Returns the key of the table for @p proteins and @p settings (settings and a hash of the protein sequences)
+    static String getCacheKey(const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings);
+
+    /// Returns the file name used for a table with the given @p key in @p cache_dir
+    static String getCacheFilename(const String& cache_dir, const String& key);
+
+    /// Returns the key of the table
+    const String& getKey() const;
+
+    /// Returns true if the table is backed by a memory-mapped file
+    bool isMapped() const;
+
+    /// Returns the number of entries
+    Size size() const;
+
+    /// Returns true if the table has no entries
+    bool empty() const;
+
+    /// Returns the number of proteins the table was built from
+    Size getNumberOfProteins() const;
+
+    /// Returns the accession (FASTA identifier) of protein @p protein_index
+    StringView getProteinAccession(Size protein_index) const;
+
+    /// Returns the monoisotopic mass of entry @p index
+    double getMass(Size index) const;
+
+    /// Returns the unmodified sequence of entry @p index
+    StringView getSequence(Size index) const;
+
+    /// Returns the modified sequence of entry @p index
+    StringView getModifiedSequence(Size index) const;
+
+    /// Returns the index of the modified variant of entry @p index (as enumerated by ModifiedPeptideGenerator)
+    Size getModificationIndex(Size index) const;
+
+    /// Returns the range [first, second) of the (sorted) indices of the proteins containing entry @p index
+    std::pair<const UInt32*, const UInt32*> getProteinIndices(Size index) const;
+
+    /// Returns the range of entries [first, second) with mass in [@p min_mass, @p max_mass]
+    std::pair<Size, Size> getMassRange(double min_mass, double max_mass) const;
+
+protected:
+    /// Points the accessors to the table image @p data (validates the image)
+    void attach_(const char* data, Size size, const String& filename);
+
+    /// key of the table
+    String key_;
+
+    /// table image (if built in memory)
+    std::vector<char> buffer_;
+
+    /// table image (if loaded from a file)
+    MemoryMappedFile file_;
+
+    /// start and size of the table image
+    const char* image_ = nullptr;
+    Size image_size_ = 0;
+
+    Size n_entries_ = 0;
+    Size n_proteins_ = 0;
+
+    /// @name Sections of the table image
+    //@{
+    const double* masses_ = nullptr;
+    const UInt64* sequence_offsets_ = nullptr;
+    const char* sequences_ = nullptr;
+    const UInt64* modified_offsets_ = nullptr;
+    const char* modified_sequences_ = nullptr;
+    const UInt32* modification_indices_ = nullptr;
+    const UInt64* protein_offsets_ = nullptr;
+    const UInt32* protein_indices_ = nullptr;
+    const UInt64* accession_offsets_ = nullptr;
+    const char* accessions_ = nullptr;
+    //@}
+  };
+
+} // namespace OpenMS
@@ -108,6 +108,12 @@ namespace OpenMS
   Threading:
   This tool support multiple threads (@p threads option) to speed up computation, at the cost of little extra memory.
 
+  Search backends:
+  By default, an Aho-Corasick trie is built over the peptides and the database is streamed through it (@p backend 'aho_corasick').
+  Alternatively, the peptides can be looked up in a suffix array of the whole database (@p backend 'suffix_array', see ProteinSuffixArray),
+  which is stored in @p suffix_array_file and reused as long as the database (and the @p IL_equivalent setting) does not change.
+  Both backends report the same hits; the suffix array pays off when many identification files are mapped against the same database.
+
 */
 
  class OPENMS_DLLAPI PeptideIndexing :
@@ -195,6 +201,9 @@ public:
     /// Same as run() with TFI_File, but for proteins which are already in memory
     ExitCodes run(FASTAContainer<TFI_Vector>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids);
 
+    /// Same as run() with TFI_File, but for proteins loaded (in parallel) into a FASTAArena
+    ExitCodes run(FASTAContainer<TFI_Arena>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids);
+
     /// Which string is used to determine if a protein is a decoy or not
     const String& getDecoyString() const;
 
@@ -218,6 +227,8 @@ public:
     Unmatched unmatched_action_ = Unmatched::IS_ERROR;
     bool IL_equivalent_{ false };
     bool allow_nterm_protein_cleavage_{ true };
+    bool use_suffix_array_{ false };
+    String suffix_array_file_{};
 
     Int aaa_max_{0};
     Int mm_max_{0};
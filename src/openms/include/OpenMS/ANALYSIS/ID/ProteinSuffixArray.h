@@ -0,0 +1,182 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Persistent suffix array over the sequences of a protein database
+
+    PeptideIndexing builds an Aho-Corasick trie over the peptides of a single
+    identification run and streams the whole database through it. When many
+    identification files are mapped against the same database, it is cheaper
+    to index the database once and look up the peptides in that index.
+
+    The index consists of the (normalized) protein sequences, concatenated and
+    separated by a terminator, and a suffix array over this text. Normalization
+    removes stop codons ('*') and converts all residues to upper case.
+    If the index is built I/L equivalent, 'L' and 'J' are converted to 'I' in
+    the proteins (and 'L' to 'I' in the peptides during search).
+
+    Peptides are searched by narrowing the suffix array interval residue by
+    residue. Ambiguous amino acids in the proteins ('B' = D/N, 'J' = I/L,
+    'Z' = E/Q and 'X' = any unambiguous amino acid) and mismatches are
+    supported by backtracking, with the same semantics as ACTrie.
+
+    The index can be written to disk (store()) and memory-mapped on later runs
+    (load()). The file is a flat binary image in native byte order.
+    Building the index requires about 25 bytes of memory per residue; the
+    index itself uses 5 bytes per residue. Databases are limited to 2^32 - 1
+    residues (including one terminator per protein).
+  */
+  class OPENMS_DLLAPI ProteinSuffixArray
+  {
+public:
+    /// A peptide occurrence: protein index and (0-based) position in the protein
+    struct Match
+    {
+      UInt32 protein;
+      UInt32 position;
+
+      bool operator<(const Match& rhs) const
+      {
+        return protein < rhs.protein || (protein == rhs.protein && position < rhs.position);
+      }
+      bool operator==(const Match& rhs) const
+      {
+        return protein == rhs.protein && position == rhs.position;
+      }
+    };
+
+    /// Default constructor (empty index)
+    ProteinSuffixArray();
+
+    /// Copying is not allowed (a loaded index is backed by a memory mapping)
+    ProteinSuffixArray(const ProteinSuffixArray&) = delete;
+    ProteinSuffixArray& operator=(const ProteinSuffixArray&) = delete;
+
+    /// Move constructor
+    ProteinSuffixArray(ProteinSuffixArray&&) = default;
+
+    /// Move assignment operator
+    ProteinSuffixArray& operator=(ProteinSuffixArray&&) = default;
+
+    /**
+      @brief Builds the index over the protein sequences @p proteins
+
+      @exception Exception::InvalidSize if the database is too large
+    */
+    void build(const StringList& proteins, bool IL_equivalent);
+
+    /**
+      @brief Writes the index to a binary file
+
+      @exception Exception::UnableToCreateFile if the file cannot be written
+    */
+    void store(const String& filename) const;
+
+    /**
+      @brief Memory-maps an index written by store()
+
+      @exception Exception::FileNotFound if the file does not exist
+      @exception Exception::ParseError if the file is not a valid index
+    */
+    void load(const String& filename);
+
+    /// Returns true if the index was built I/L equivalent
+    bool isILEquivalent() const;
+
+    /// Returns the number of proteins
+    Size size() const;
+
+    /// Returns the normalized sequence of protein @p index
+    StringView getSequence(Size index) const;
+
+    /// Returns true if the index was built from @p proteins with the given I/L setting (i.e. can be used for them)
+    bool isIndexOf(const StringList& proteins, bool IL_equivalent) const;
+
+    /**
+      @brief Finds all occurrences of @p peptide in the proteins
+
+      @param peptide The peptide sequence (unmodified, upper case); 'L' is converted to 'I' if the index is I/L equivalent
+      @param max_aaa Maximum number of ambiguous amino acids (B, J, Z, X) in the protein that may be matched
+      @param max_mm Maximum number of mismatches
+      @param matches Occurrences, sorted by protein and position (previous content is removed)
+    */
+    void findAll(const String& peptide, UInt32 max_aaa, UInt32 max_mm, std::vector<Match>& matches) const;
+
+    /// Normalizes a protein sequence as done by build()
+    static String normalize(const String& protein, bool IL_equivalent);
+
+protected:
+    /// Collects the matches of @p peptide from @p depth onwards, with the suffix array interval [@p lo, @p hi) matching the first @p depth residues
+    void search_(const String& peptide, Size depth, Size lo, Size hi, UInt32 aaa_left, UInt32 mm_left, std::vector<Match>& matches) const;
+
+    /// Restricts the interval [@p lo, @p hi) to suffixes with residue @p aa at offset @p depth
+    void narrow_(Size depth, char aa, Size& lo, Size& hi) const;
+
+    /// Points the accessors to the index image @p data (validates the image)
+    void attach_(const char* data, Size size, const String& filename);
+
+    /// index image (if built in memory)
+    std::vector<char> buffer_;
+
+    /// index image (if loaded from a file)
+    MemoryMappedFile file_;
+
+    /// start and size of the index image
+    const char* image_ = nullptr;
+    Size image_size_ = 0;
+
+    bool IL_equivalent_ = false;
+    Size n_proteins_ = 0;
+    Size text_size_ = 0;
+
+    /// @name Sections of the index image
+    //@{
+    const UInt64* protein_offsets_ = nullptr; ///< start of each protein in the text (n_proteins + 1 values)
+    const char* text_ = nullptr; ///< normalized proteins, each followed by a terminator
+    const UInt32* suffix_array_ = nullptr;
+    //@}
+  };
+
+} // namespace OpenMS
@@ -32,17 +32,24 @@
 // $Authors: Timo Sachsenberg $
 // --------------------------------------------------------------------------
 
+#include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 
 #include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
 
+#include <boost/regex_fwd.hpp> // forward declaration of boost::regex
+
+#include <unordered_map>
 #include <vector>
 
 namespace OpenMS
 {
+class FragmentIndex;
+class ProteaseDigestion;
 
 class OPENMS_DLLAPI SimpleSearchEngineAlgorithm :
   public DefaultParamHandler,
@@ -93,6 +100,73 @@ class OPENMS_DLLAPI SimpleSearchEngineAlgorithm :
     /// @brief filter, deisotope, decharge spectra
     static void preprocessSpectra_(PeakMap& exp, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm);
 
+    /// Hits collected by a single thread, indexed by spectrum (only spectra with at least one hit are stored)
+    typedef std::unordered_map<Size, std::vector<AnnotatedHit_> > LocalHits_;
+
+    /// Number of spectra a thread collects hits for before merging them into the hits of all spectra (bounds the memory of LocalHits_)
+    static const Size max_local_hit_spectra_ = 1000;
+
+    /**
+      @brief The search modifications resolved once, before the parallel scoring loops
+
+      Parsing a modified sequence with AASequence::fromString() looks up every modification in ModificationsDB and ResidueDB,
+      which synchronize all threads. This table maps the text of each fixed and variable modification (as written by
+      AASequence::toString()) to the modified residue or terminal modification, so candidates stored as text
+      (e.g. in a PeptideDatabase) are rebuilt without entering these databases.
+    */
+    class ModificationTable_
+    {
+    public:
+      /// resolves the modifications of @p fixed_modifications and @p variable_modifications
+      ModificationTable_(const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+        const ModifiedPeptideGenerator::MapToResidueType& variable_modifications);
+
+      /**
+        @brief rebuilds a candidate from its unmodified and modified sequence
+
+        Unmodified residues are taken from the read-only one letter code table of ResidueDB.
+        Sequences with modifications not in the table are parsed with AASequence::fromString().
+      */
+      AASequence getCandidate(const String& unmodified_sequence, const String& modified_sequence) const;
+
+    private:
+      /// modified residues by their text (e.g. "M(Oxidation)")
+      std::unordered_map<std::string, const Residue*> residues_;
+      /// terminal modifications by their text (e.g. ".(Acetyl)")
+      std::unordered_map<std::string, const ResidueModification*> terminal_modifications_;
+    };
+
+    /// @brief add a hit to the candidates of a spectrum, pruning them to the best @p top_hits once twice as many have been collected
+    static void addHit_(std::vector<AnnotatedHit_>& hits, AnnotatedHit_&& hit, Size top_hits);
+
+    /// @brief merge the hits collected by one thread into the hits of all spectra (not thread-safe, call once per thread in a critical section)
+    static void mergeHits_(LocalHits_& local_hits, std::vector<std::vector<AnnotatedHit_> >& annotated_hits, Size top_hits);
+
+    /// @brief digest all proteins in parallel and return the unique unmodified (fully or @p semi_specific) peptides passing the residue and motif filters
+    void digestDatabase_(const std::vector<FASTAFile::FASTAEntry>& fasta_db,
+      const ProteaseDigestion& digestor,
+      bool semi_specific,
+      const boost::regex& peptide_motif_regex,
+      std::vector<StringView>& peptides) const;
+
+    /// @brief signature of the database and search settings a fragment index depends on
+    String getFragmentIndexSignature_(const std::vector<FASTAFile::FASTAEntry>& fasta_db, const ProteaseDigestion& digestor) const;
+
+    /// @brief digest the database and build the fragment index of all (modified) peptides
+    void buildFragmentIndex_(const std::vector<FASTAFile::FASTAEntry>& fasta_db,
+      const ProteaseDigestion& digestor,
+      const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+      const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+      const boost::regex& peptide_motif_regex,
+      FragmentIndex& index) const;
+
+    /// @brief spectrum-centric search: score only the candidates sharing most fragments with each spectrum
+    void searchFragmentIndex_(const PeakMap& spectra,
+      const std::vector<HyperScore::PreparedSpectrum>& prepared_spectra,
+      const std::vector<std::vector<double> >& precursor_masses,
+      const FragmentIndex& index,
+      std::vector<std::vector<SimpleSearchEngineAlgorithm::AnnotatedHit_> >& annotated_hits) const;
+
     /// @brief filter and annotate search results
     /// most of the parameters are used to properly add meta data to the id objects
     void postProcessHits_(const PeakMap& exp, 
@@ -146,6 +220,15 @@ class OPENMS_DLLAPI SimpleSearchEngineAlgorithm :
     String peptide_motif_;
 
     Size report_top_hits_;
+
+    bool fragment_index_enabled_;
+    String fragment_index_file_;
+    double fragment_index_bin_width_;
+    Size fragment_index_candidates_;
+    Size fragment_index_min_shared_peaks_;
+    bool fragment_index_semi_specific_;
+
+    String peptide_db_cache_dir_;
 };
 
 } // namespace
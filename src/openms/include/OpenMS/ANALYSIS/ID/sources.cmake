@@ -21,6 +21,8 @@ ConsensusMapMergerAlgorithm.h
 FalseDiscoveryRate.h
 FIAMSDataProcessor.h
 FIAMSScheduler.h
+FNVHash.h
+FragmentIndex.h
 HiddenMarkovModel.h
 IDBoostGraph.h
 IDDecoyProbability.h
@@ -36,7 +38,9 @@ MetaboliteSpectralMatching.h
 PeptideProteinResolution.h
 PrecursorPurity.h
 ProtonDistributionModel.h
+PeptideDatabase.h
 PeptideIndexing.h
+ProteinSuffixArray.h
 PercolatorFeatureSetHelper.h
 SimpleSearchEngineAlgorithm.h
 SiriusAdapterAlgorithm.h
@@ -41,6 +41,7 @@
 
 namespace OpenMS
 {
+  class LinkingFeatureStore;
 
 ///
 /**
@@ -171,6 +172,17 @@ private:
       The algorithm takes a number of feature or consensus maps and searches
       for corresponding (consensus) features across different maps.
 
+      The input is split into m/z partitions that no cluster can cross (see
+      parameter nr_partitions). With OpenMP, the RT transformation data and
+      the linking of the partitions are computed concurrently; the consensus
+      features of each partition are collected separately and appended in
+      partition order, so the output does not depend on the number of threads.
+
+      For inputs too large to be held in memory, the features can be spilled
+      to a LinkingFeatureStore and linked from there (see
+      group(LinkingFeatureStore&, ConsensusMap&)); only the partitions that
+      are currently processed are loaded.
+
       @htmlinclude OpenMS_FeatureGroupingAlgorithmKD.parameters
 
       @ingroup FeatureGrouping
@@ -203,6 +215,17 @@ public:
     void group(const std::vector<ConsensusMap>& maps,
                        ConsensusMap& out) override;
 
+    /**
+        @brief Applies the algorithm to the feature maps in @p store
+
+        Gives the same consensus features as group() for the maps added to
+        the store, but without peptide and protein identifications, which can
+        be added afterwards with LinkingFeatureStore::restoreIdentifications().
+
+        @exception IllegalArgument is thrown if less than two input maps are given.
+    */
+    void group(LinkingFeatureStore& store, ConsensusMap& out);
+
     /// Creates a new instance of this class (for Factory)
     static FeatureGroupingAlgorithm* create()
     {
@@ -231,14 +254,31 @@ private:
     template <typename MapType>
     void group_(const std::vector<MapType>& input_maps, ConsensusMap& out);
 
-    /// Run the actual clustering algorithm
-    void runClustering_(const KDTreeFeatureMaps& kd_data, ConsensusMap& out);
+    /// Sets the linking parameters, checks the number of maps and clears @p out
+    void setUp_(Size num_maps, ConsensusMap& out);
+
+    /// Sets up feature_distance_ for the given intensity maximum of the input
+    void setUpDistance_(double max_intensity);
+
+    /**
+        @brief Aligns (optionally) and links the features of all m/z partitions and appends the results to @p out
+
+        @p load_partition(j, maps) must provide the features of all input maps in partition @p j
+        (it is called concurrently for different partitions).
+
+        @return false if the RT transformations could not be computed
+    */
+    template <typename MapType, typename PartitionLoader>
+    bool linkPartitions_(Size num_maps, const std::vector<double>& partition_boundaries, const PartitionLoader& load_partition, ConsensusMap& out);
+
+    /// Run the actual clustering algorithm (@p distance is a thread-local copy of feature_distance_)
+    void runClustering_(const KDTreeFeatureMaps& kd_data, FeatureDistance& distance, ConsensusMap& out) const;
 
     /// Update maximum possible sizes of potential consensus features for indices specified in @p update_these
-    void updateClusterProxies_(std::set<ClusterProxyKD>& potential_clusters, std::vector<ClusterProxyKD>& cluster_for_idx, const std::set<Size>& update_these, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data);
+    void updateClusterProxies_(std::set<ClusterProxyKD>& potential_clusters, std::vector<ClusterProxyKD>& cluster_for_idx, const std::set<Size>& update_these, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data, FeatureDistance& distance) const;
 
     /// Compute the current best cluster with center index @p i (mutates @p proxy and @p cf_indices)
-    ClusterProxyKD computeBestClusterForCenter_(Size i, std::vector<Size>& cf_indices, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data) const;
+    ClusterProxyKD computeBestClusterForCenter_(Size i, std::vector<Size>& cf_indices, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data, FeatureDistance& distance) const;
 
     /// Construct consensus feature and add to out map
     void addConsensusFeature_(const std::vector<Size>& indices, const KDTreeFeatureMaps& kd_data, ConsensusMap& out) const;
@@ -0,0 +1,180 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/KERNEL/ConsensusMap.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+
+#include <fstream>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Disk-backed store of the feature data needed for feature linking
+
+    Linking a large number of feature maps with FeatureGroupingAlgorithmKD
+    does not require the full features, only their position, intensity,
+    charge, quality, width, unique id and adduct annotation (meta values
+    Constants::UserParam::DC_CHARGE_ADDUCTS and
+    Constants::UserParam::ADDUCT_GROUP; empty values are treated as absent).
+    addMap() extracts these fields from a map, sorts them by m/z and appends
+    them column by column to a temporary file, so only one input map needs
+    to be held in memory at a time.
+
+    After setPartitions(), loadPartition() reads the features of one m/z
+    partition of all maps back from the file (with a separate file handle,
+    so partitions can be loaded concurrently). Peptide and protein
+    identifications are not stored; restoreIdentifications() adds them to
+    the linked consensus map from the fully loaded input maps.
+
+    The file is written in native byte order and removed on destruction.
+
+    @ingroup FeatureGrouping
+  */
+  class OPENMS_DLLAPI LinkingFeatureStore
+  {
+public:
+    /**
+      @brief Creates an empty store that spills to @p filename
+
+      @exception Exception::UnableToCreateFile if the file cannot be created
+    */
+    explicit LinkingFeatureStore(const String& filename);
+
+    /// Destructor (removes the file)
+    ~LinkingFeatureStore();
+
+    /// Copying is not allowed (the store owns its file)
+    LinkingFeatureStore(const LinkingFeatureStore&) = delete;
+    LinkingFeatureStore& operator=(const LinkingFeatureStore&) = delete;
+
+    /**
+      @brief Appends the linking-relevant data of the features in @p map as the next input map
+
+      @exception Exception::InvalidValue if two features of @p map have the same unique id
+      @exception Exception::UnableToCreateFile if the data cannot be written
+    */
+    void addMap(const FeatureMap& map);
+
+    /// Number of input maps
+    Size size() const;
+
+    /// Total number of features of all maps
+    Size getNumberOfFeatures() const;
+
+    /// Maximum feature intensity of all maps (0 if there are no features)
+    double getMaxIntensity() const;
+
+    /**
+      @brief Calls @p f with the m/z of every feature of all maps, in ascending order
+
+      The values are merged from the sorted m/z columns of the maps, with a
+      small read buffer per map.
+    */
+    void forEachMZ(const std::function<void(double)>& f) const;
+
+    /**
+      @brief Defines the m/z partitions [@p boundaries[j], @p boundaries[j + 1]) for loadPartition()
+
+      @p boundaries must be sorted.
+    */
+    void setPartitions(const std::vector<double>& boundaries);
+
+    /// Number of partitions defined by setPartitions()
+    Size getNumberOfPartitions() const;
+
+    /**
+      @brief Loads the features of partition @p j into @p maps (one map per input map)
+
+      Features keep the order of the input map they were added with. This
+      method is thread-safe.
+
+      @exception Exception::IndexOverflow if @p j is not a valid partition
+      @exception Exception::FileNotFound if the file cannot be read
+    */
+    void loadPartition(Size j, std::vector<FeatureMap>& maps) const;
+
+    /**
+      @brief Adds the identifications of input map @p map_index to the consensus map @p out
+
+      @p out must be the result of linking the maps of this store, and
+      @p map must be the full version of the map added as @p map_index.
+      Peptide identifications of the features are added to the consensus
+      features containing them (annotated with their map index), protein
+      identifications and unassigned peptide identifications of @p map are
+      appended to @p out, as FeatureGroupingAlgorithm does for maps linked
+      in memory. Call this for all maps in order, starting with map 0; the
+      consensus features must not be reordered in between.
+
+      @exception Exception::InvalidValue if @p map does not match the stored map
+    */
+    void restoreIdentifications(Size map_index, const FeatureMap& map, ConsensusMap& out);
+
+private:
+    /// Location of the columns of one input map in the file
+    struct MapEntry_
+    {
+      Size size = 0; ///< number of features
+      UInt64 offset = 0; ///< start of the first column
+      UInt64 adduct_chars = 0; ///< length of the adduct string heap
+      std::vector<Size> partition_offsets; ///< first (m/z sorted) feature of each partition
+    };
+
+    /// Reads elements [@p begin, @p end) of column @p column of map @p entry
+    template <typename T>
+    void readColumn_(std::ifstream& ifs, const MapEntry_& entry, Size column, Size begin, Size end, std::vector<T>& values) const;
+
+    /// Reads the strings [@p begin, @p end) of the string column starting at column @p column of @p entry
+    void readStrings_(std::ifstream& ifs, const MapEntry_& entry, Size column, Size begin, Size end, std::vector<String>& values) const;
+
+    /// Opens the file for reading
+    void openForReading_(std::ifstream& ifs) const;
+
+    String filename_;
+    std::ofstream ofs_;
+    UInt64 file_size_ = 0;
+    std::vector<MapEntry_> maps_;
+    Size num_features_ = 0;
+    double max_intensity_ = 0.0;
+    Size num_partitions_ = 0;
+
+    /// (unique id, consensus feature index) of each map, sorted by unique id (built by restoreIdentifications())
+    std::vector<std::vector<std::pair<UInt64, Size> > > handle_index_;
+  };
+
+} // namespace OpenMS
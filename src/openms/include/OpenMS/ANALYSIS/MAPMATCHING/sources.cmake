@@ -16,6 +16,7 @@ FeatureGroupingAlgorithmQT.h
 FeatureGroupingAlgorithmUnlabeled.h
 FeatureMapping.h
 LabeledPairFinder.h
+LinkingFeatureStore.h
 MapAlignmentAlgorithmIdentification.h
 MapAlignmentAlgorithmKD.h
 MapAlignmentAlgorithmPoseClustering.h
@@ -39,6 +39,10 @@
 
 namespace OpenMS
 {
+  namespace Internal
+  {
+    class ColMassHandler;
+  }
 
   /**
    * @brief The ChromatogramExtractorAlgorithm extracts chromatograms from a MS data.
@@ -65,7 +69,7 @@ public:
     {
       double mz = 0.0; ///< m/z value around which should be extracted
       double ion_mobility = 0.0; ///< ion mobility value around which should be extracted
-      double mz_precursor = 0.0; ///< precursor m/z value (is currently ignored by the algorithm)
+      double mz_precursor = 0.0; ///< precursor m/z value (is currently ignored by the algorithm, StreamingChromatogramExtractor uses it to select the SWATH window)
       double rt_start = 0.0; ///< rt start of extraction (in seconds)
       double rt_end = 0.0; ///< rt end of extraction (in seconds)
       std::string id; ///< identifier
@@ -108,6 +112,32 @@ public:
         double im_extraction_window,
         const String& filter);
 
+    /**
+     * @brief Extract chromatograms from one spectrum group of a colMass file.
+     *
+     * Produces the same chromatograms as the extraction from a spectrum
+     * access of the spectra of group @p group (e.g. one SWATH window), but
+     * only decompresses the parts of the file which overlap the RT ranges
+     * and m/z extraction windows of @p extraction_coordinates. (The only
+     * difference: the first and the last peak of a spectrum are extracted
+     * like all other peaks, while extract_value_tophat may skip or count them
+     * twice in complete spectra.)
+     *
+     * @param input Open colMass file
+     * @param group Index of the spectrum group (see Internal::ColMassHandler::getSpectrumGroups())
+     *
+     * For the remaining parameters, see the overload above.
+     *
+    */
+    void extractChromatograms(const Internal::ColMassHandler& input,
+        Size group,
+        std::vector< OpenSwath::ChromatogramPtr >& output,
+        const std::vector<ExtractionCoordinates>& extraction_coordinates,
+        double mz_extraction_window,
+        bool ppm,
+        double im_extraction_window,
+        const String& filter);
+
     /**
      * @brief Extract the next mz value and add the integrated intensity to integrated_intensity.
      *
@@ -185,6 +215,16 @@ private:
 
     int getFilterNr_(const String& filter);
 
+    /// Extract the intensities of all coordinates whose RT range contains @p current_rt from a single spectrum
+    void extractSpectrum_(const OpenSwath::SpectrumPtr& sptr,
+        double current_rt,
+        std::vector< OpenSwath::ChromatogramPtr >& output,
+        const std::vector<ExtractionCoordinates>& extraction_coordinates,
+        double mz_extraction_window,
+        bool ppm,
+        double im_extraction_window,
+        int used_filter);
+
   };
 
 }
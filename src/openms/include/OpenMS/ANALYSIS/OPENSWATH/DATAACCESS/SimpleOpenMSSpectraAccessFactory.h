@@ -50,7 +50,7 @@ namespace OpenMS
   {
   public:
 
-    /// Simple Factory method to get a SpectrumAccess Ptr from an MSExperiment
+    /// Simple Factory method to get a SpectrumAccess Ptr from an MSExperiment (cached experiments are accessed through SpectrumAccessOpenMSCachedMapped)
     static OpenSwath::SpectrumAccessPtr getSpectrumAccessOpenMSPtr(boost::shared_ptr<OpenMS::PeakMap> exp);
 
   private:
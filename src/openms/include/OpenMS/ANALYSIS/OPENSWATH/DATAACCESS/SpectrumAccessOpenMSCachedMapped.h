@@ -0,0 +1,129 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/MSChromatogram.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <OpenMS/FORMAT/MappedCachedMzML.h>
+
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
+
+namespace OpenMS
+{
+
+  /**
+    @brief An implementation of the Spectrum Access interface using a memory-mapped cache file
+
+    This class implements the OpenSWATH Spectrum Access interface
+    (ISpectrumAccess) using the MappedCachedMzML class which maps a cached
+    mzML file into memory. In addition to the (copying) ISpectrumAccess
+    interface, spectra and chromatograms can be accessed as views directly
+    into the mapped file (getSpectrumViewById(), getChromatogramViewById())
+    without any allocation or system call.
+
+    In contrast to SpectrumAccessOpenMSCached, this implementation does not
+    keep a file stream and all access functions can be used from multiple
+    threads concurrently. lightClone() only shares the mapping, index and
+    meta data.
+
+  */
+  class OPENMS_DLLAPI SpectrumAccessOpenMSCachedMapped :
+    public OpenSwath::ISpectrumAccess,
+    public OpenMS::MappedCachedMzML
+  {
+
+public:
+    typedef OpenMS::PeakMap MSExperimentType;
+    typedef OpenMS::MSSpectrum MSSpectrumType;
+
+    /**
+      @brief Constructor, maps the cached file
+
+      @param filename The filename of the .mzML file (it is assumed a second
+      file .mzML.cached exists).
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::ParseError is thrown if the file cannot be parsed
+    */
+    explicit SpectrumAccessOpenMSCachedMapped(const String& filename);
+
+    /**
+      @brief Destructor
+    */
+    ~SpectrumAccessOpenMSCachedMapped() override;
+
+    /// Copy constructor
+    SpectrumAccessOpenMSCachedMapped(const SpectrumAccessOpenMSCachedMapped & rhs);
+
+    /// Light clone operator (actual data will not get copied)
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const override;
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id) override;
+
+    OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const override;
+
+    std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const override;
+
+    size_t getNrSpectra() const override;
+
+    SpectrumSettings getSpectraMetaInfo(int id) const;
+
+    OpenSwath::ChromatogramPtr getChromatogramById(int id) override;
+
+    size_t getNrChromatograms() const override;
+
+    ChromatogramSettings getChromatogramMetaInfo(int id) const;
+
+    std::string getChromatogramNativeID(int id) const override;
+
+    /**
+      @brief Zero-copy access to spectrum @p id (see MappedCachedMzML::getSpectrumView())
+
+      @throws Exception::IllegalArgument is thrown for cached files without aligned data arrays
+    */
+    SpectrumView getSpectrumViewById(int id) const;
+
+    /**
+      @brief Zero-copy access to chromatogram @p id (see MappedCachedMzML::getChromatogramView())
+
+      @throws Exception::IllegalArgument is thrown for cached files without aligned data arrays
+    */
+    ChromatogramView getChromatogramViewById(int id) const;
+  };
+
+} //end namespace
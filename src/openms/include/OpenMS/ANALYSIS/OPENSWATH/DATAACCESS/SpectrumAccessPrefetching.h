@@ -0,0 +1,163 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace OpenMS
+{
+
+  /**
+    @brief A spectrum access wrapper that reads spectra ahead on a background I/O thread.
+
+    Wraps a (disk-based) spectrum access such as SpectrumAccessOpenMSCached or
+    SpectrumAccessSqMass and loads spectra into a bounded LRU cache of decoded
+    spectra before they are requested, so that the calling thread does not
+    stall on I/O for every scan:
+
+    - sequential access (as done by the chromatogram extraction) triggers a
+      read-ahead of the next spectra
+    - the spectra returned by getSpectraByRT are queued since they are
+      usually requested next (as done during scoring)
+    - further spectra can be requested explicitly using prefetch()
+
+    A spectrum that is requested but not yet available is read synchronously
+    by the calling thread. The background thread uses its own light clone of
+    the wrapped access, the same instance must (as for any ISpectrumAccess)
+    only be used by one thread at a time; use lightClone() to obtain a copy for
+    another thread. Light clones share the access statistics.
+
+  */
+  class OPENMS_DLLAPI SpectrumAccessPrefetching :
+    public SpectrumAccessTransforming
+  {
+public:
+
+    /// Access statistics, shared by all light clones
+    struct Statistics
+    {
+      std::atomic<Size> hits{0}; ///< Spectra that were already in the cache
+      std::atomic<Size> late_hits{0}; ///< Spectra that were still being read by the background thread when requested
+      std::atomic<Size> misses{0}; ///< Spectra that had to be read synchronously
+      std::atomic<Size> prefetched{0}; ///< Spectra read by the background thread
+    };
+    typedef boost::shared_ptr<Statistics> StatisticsPtr;
+
+    /**
+      @brief Constructor
+
+      @param sptr The spectrum access to wrap
+      @param cache_size Maximal number of decoded spectra kept in memory
+      @param read_ahead Number of spectra to read ahead on sequential access (at most half the cache size is used)
+      @param statistics Statistics to record into (a new object is created if empty)
+    */
+    explicit SpectrumAccessPrefetching(OpenSwath::SpectrumAccessPtr sptr, Size cache_size = 128, Size read_ahead = 32,
+                                       StatisticsPtr statistics = StatisticsPtr());
+
+    /// Destructor, stops the background thread
+    ~SpectrumAccessPrefetching() override;
+
+    /// Light clone operator, the clone has its own cache and background thread but shares the statistics
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const override;
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id) override;
+
+    /// Return the ids of spectra within RT +/- deltaRT and queue them for prefetching
+    std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const override;
+
+    /// Queue the given spectra for loading by the background thread
+    void prefetch(const std::vector<std::size_t>& ids) const;
+
+    /// Return the access statistics (shared by all light clones)
+    const StatisticsPtr& getStatistics() const;
+
+protected:
+
+    typedef std::list<std::pair<int, OpenSwath::SpectrumPtr> > CacheList_;
+
+    /// Queue a spectrum for the background thread, returns false if the queue is full (mutex_ needs to be held)
+    bool enqueue_(int id) const;
+
+    /// Insert a spectrum into the cache and evict the least recently used one (mutex_ needs to be held)
+    void insert_(int id, const OpenSwath::SpectrumPtr& spectrum) const;
+
+    /// Main loop of the background thread
+    void ioLoop_() const;
+
+    /// Maximal number of spectra in the cache
+    Size cache_size_;
+    /// Number of spectra to read ahead on sequential access
+    Size read_ahead_;
+    /// Statistics
+    StatisticsPtr statistics_;
+    /// Spectrum access used by the background thread
+    OpenSwath::SpectrumAccessPtr io_sptr_;
+
+    /// Last spectrum requested through getSpectrumById
+    int last_id_;
+    /// First spectrum not yet queued for read-ahead
+    int read_ahead_end_;
+
+    /// Guards all members below
+    mutable std::mutex mutex_;
+    /// Signals new work for the background thread
+    mutable std::condition_variable work_cv_;
+    /// Signals that the background thread finished reading a spectrum
+    mutable std::condition_variable loaded_cv_;
+    /// Spectra to be read by the background thread (only those still in queued_ are read)
+    mutable std::deque<int> queue_;
+    mutable std::unordered_set<int> queued_;
+    /// Spectrum currently read by the background thread (-1 if none)
+    mutable int in_flight_;
+    /// Cached spectra, most recently used first
+    mutable CacheList_ cache_;
+    mutable std::unordered_map<int, CacheList_::iterator> cache_index_;
+    /// Whether the background thread should stop
+    mutable bool stop_;
+    /// Background thread (started on first use)
+    mutable std::thread io_thread_;
+  };
+
+}
@@ -130,6 +130,17 @@ namespace OpenSwath
         /// Initialize the scoring object and building the cross-correlation matrix of chromatograms of precursor isotopes and transitions
         void initializeXCorrPrecursorCombinedMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids);
 
+        /**
+           @brief Initialize all cross-correlation matrices of a peak group at once
+
+           Builds the same matrices as initializeXCorrMatrix(),
+           initializeXCorrPrecursorMatrix(), initializeXCorrPrecursorContrastMatrix()
+           and initializeXCorrPrecursorCombinedMatrix(). Each trace is standardized
+           only once and each pair of traces is correlated only once (the
+           combined matrix is assembled from the other matrices).
+        */
+        void initializeXCorrMatrices(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids, const std::vector<std::string>& precursor_ids);
+
         /**
            @brief Calculate the cross-correlation coelution score
 
@@ -263,6 +274,16 @@ namespace OpenSwath
         /// Initialize the mutual information vector with the MS1 trace
         void initializeMIPrecursorCombinedMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids);
 
+        /**
+           @brief Initialize all mutual information matrices of a peak group at once
+
+           Builds the same matrices as initializeMIMatrix(),
+           initializeMIPrecursorMatrix(), initializeMIPrecursorContrastMatrix() and
+           initializeMIPrecursorCombinedMatrix(), computing the rank vector of
+           each trace and the mutual information of each pair only once.
+        */
+        void initializeMIMatrices(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids, const std::vector<std::string>& precursor_ids);
+
         double calcMIScore();
         double calcMIWeightedScore(const std::vector<double>& normalized_library_intensity);
         double calcMIPrecursorScore();
@@ -0,0 +1,244 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Compact, memory-mappable representation of an OpenSWATH assay library
+
+    Loading a large assay library (PQP, TSV or TraML) into an
+    OpenSwath::LightTargetedExperiment requires parsing the whole file and
+    allocating several strings per transition. For deep spectral libraries
+    with millions of precursors this takes minutes and a lot of memory.
+    This class stores the content of a LightTargetedExperiment as a flat
+    binary image that is written once (e.g. by TargetedFileConverter) and
+    memory-mapped on later runs, so loading only requires validating the
+    image.
+
+    In the image, all strings (transition names, compound ids, sequences,
+    protein accessions etc.) are interned in a single string pool and
+    referenced by integer ids. Compounds are sorted by precursor m/z and
+    referenced by their index. The transitions of each compound are stored
+    contiguously (in their original order), so getTransitionRange() returns
+    the transitions of a compound without any lookup. Additional indices
+    allow range queries by retention time (getRTRange()) and lookups by
+    compound id (findCompound()).
+
+    The precursor m/z of a compound is the precursor m/z of its first
+    transition (compounds without transitions have a precursor m/z of zero).
+
+    The subset of compounds needed for an analysis (e.g. the compounds in a
+    SWATH window, see getMZRange()) can be converted to a
+    LightTargetedExperiment using toLightTargetedExperiment().
+
+    The file format is a flat binary image in native byte order.
+
+    @ingroup OpenSwath
+  */
+  class OPENMS_DLLAPI MappedTransitionLibrary
+  {
+public:
+    /// Default constructor (empty library)
+    MappedTransitionLibrary();
+
+    /// Copying is not allowed (a loaded library is backed by a memory mapping)
+    MappedTransitionLibrary(const MappedTransitionLibrary&) = delete;
+    MappedTransitionLibrary& operator=(const MappedTransitionLibrary&) = delete;
+
+    /// Move constructor
+    MappedTransitionLibrary(MappedTransitionLibrary&&) = default;
+
+    /// Move assignment operator
+    MappedTransitionLibrary& operator=(MappedTransitionLibrary&&) = default;
+
+    /**
+      @brief Builds the library from @p exp
+
+      @exception Exception::IllegalArgument if a transition references a compound that is not part of @p exp
+    */
+    void build(const OpenSwath::LightTargetedExperiment& exp);
+
+    /**
+      @brief Writes the library to a binary file
+
+      @exception Exception::UnableToCreateFile if the file cannot be written
+    */
+    void store(const String& filename) const;
+
+    /**
+      @brief Memory-maps a library written by store()
+
+      @exception Exception::FileNotFound if the file does not exist
+      @exception Exception::ParseError if the file is not a valid transition library
+    */
+    void load(const String& filename);
+
+    /// Returns true if the file @p filename starts with the magic bytes of a transition library
+    static bool isMappedTransitionLibrary(const String& filename);
+
+    /// Returns true if the library is backed by a memory-mapped file
+    bool isMapped() const;
+
+    /// Returns the number of compounds (peptides or metabolites)
+    Size getNumberOfCompounds() const;
+
+    /// Returns the number of transitions
+    Size getNumberOfTransitions() const;
+
+    /// Returns the number of proteins
+    Size getNumberOfProteins() const;
+
+    /// @name Compound accessors (compounds are sorted by precursor m/z)
+    //@{
+    /// Returns the precursor m/z of compound @p index
+    double getPrecursorMZ(Size index) const;
+
+    /// Returns the (normalized) retention time of compound @p index
+    double getRT(Size index) const;
+
+    /// Returns the drift time of compound @p index (-1 if not set)
+    double getDriftTime(Size index) const;
+
+    /// Returns the charge of compound @p index (0 if not set)
+    Int getCharge(Size index) const;
+
+    /// Returns the id of compound @p index
+    StringView getCompoundId(Size index) const;
+
+    /// Returns the (modified) sequence of compound @p index (empty for metabolites)
+    StringView getSequence(Size index) const;
+
+    /// Returns the range [first, second) of the transitions of compound @p index
+    std::pair<Size, Size> getTransitionRange(Size index) const;
+
+    /// Returns compound @p index
+    OpenSwath::LightCompound getCompound(Size index) const;
+    //@}
+
+    /// Returns transition @p index (transitions are grouped by compound)
+    OpenSwath::LightTransition getTransition(Size index) const;
+
+    /// Returns protein @p index
+    OpenSwath::LightProtein getProtein(Size index) const;
+
+    /// Returns the range of compounds [first, second) with precursor m/z in [@p min_mz, @p max_mz]
+    std::pair<Size, Size> getMZRange(double min_mz, double max_mz) const;
+
+    /// Returns the range [first, second) of the indices of all compounds with retention time in [@p min_rt, @p max_rt] (sorted by retention time)
+    std::pair<const UInt32*, const UInt32*> getRTRange(double min_rt, double max_rt) const;
+
+    /// Returns the index of the compound with id @p id, or getNumberOfCompounds() if there is no such compound
+    Size findCompound(const String& id) const;
+
+    /**
+      @brief Converts the library to a LightTargetedExperiment
+
+      Compounds are written in order of precursor m/z, followed by their
+      transitions.
+    */
+    void toLightTargetedExperiment(OpenSwath::LightTargetedExperiment& exp) const;
+
+    /**
+      @brief Converts the compounds with precursor m/z in [@p min_mz, @p max_mz] to a LightTargetedExperiment
+
+      Only the transitions of these compounds and the proteins they reference are included.
+    */
+    void toLightTargetedExperiment(double min_mz, double max_mz, OpenSwath::LightTargetedExperiment& exp) const;
+
+protected:
+    /// Converts the compounds [@p first, @p last) to @p exp
+    void toLightTargetedExperiment_(Size first, Size last, OpenSwath::LightTargetedExperiment& exp) const;
+
+    /// Returns string @p id of the string pool
+    StringView getString_(UInt32 id) const;
+
+    /// Points the accessors to the library image @p data (validates the image)
+    void attach_(const char* data, Size size, const String& filename);
+
+    /// library image (if built in memory)
+    std::vector<char> buffer_;
+
+    /// library image (if loaded from a file)
+    MemoryMappedFile file_;
+
+    /// start and size of the library image
+    const char* image_ = nullptr;
+    Size image_size_ = 0;
+
+    Size n_compounds_ = 0;
+    Size n_transitions_ = 0;
+    Size n_proteins_ = 0;
+    Size n_strings_ = 0;
+
+    /// @name Sections of the library image
+    //@{
+    const UInt64* string_offsets_ = nullptr;
+    const char* strings_ = nullptr;
+
+    const double* compound_mz_ = nullptr;
+    const double* compound_rt_ = nullptr;
+    const double* compound_drift_time_ = nullptr;
+    const Int32* compound_charge_ = nullptr;
+    const UInt32* compound_strings_ = nullptr; ///< id, sequence, group label, gene name, sum formula, compound name (6 per compound)
+    const UInt64* transition_offsets_ = nullptr;
+    const UInt64* protein_ref_offsets_ = nullptr;
+    const UInt32* protein_refs_ = nullptr;
+    const UInt64* modification_offsets_ = nullptr;
+    const Int32* modifications_ = nullptr; ///< location and UniMod id (2 per modification)
+    const UInt32* rt_order_ = nullptr;
+    const UInt32* id_order_ = nullptr;
+
+    const UInt32* transition_names_ = nullptr;
+    const double* transition_product_mz_ = nullptr;
+    const double* transition_precursor_mz_ = nullptr;
+    const double* transition_precursor_im_ = nullptr;
+    const double* transition_intensity_ = nullptr;
+    const Int32* transition_charge_ = nullptr;
+    const unsigned char* transition_flags_ = nullptr; ///< decoy, detecting, quantifying, identifying (bits 0-3)
+
+    const UInt32* protein_strings_ = nullptr; ///< id, sequence (2 per protein)
+    //@}
+  };
+
+} // namespace OpenMS
@@ -42,6 +42,9 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
 
 namespace OpenMS
 {
@@ -111,6 +114,18 @@ namespace OpenMS
         <tr> <td BGCOLOR="#EBEBEB">VAR_...</td> <td>REAL</td> <td>Fragment ion score used in pyProphet  </td> </tr>
       </table>
 
+    If checkpointing is enabled (see enableCheckpointing()), the file
+    additionally contains a manifest of the SWATH windows written so far
+    while the analysis is running:
+
+      <table>
+        <tr> <th BGCOLOR="#EBEBEB" colspan=3>CHECKPOINT</th> </tr>
+        <tr> <td BGCOLOR="#EBEBEB">WINDOW</td> <td>INT</td> <td>Index of a completely written SWATH window (-1 for the entry holding the fingerprint)</td> </tr>
+        <tr> <td BGCOLOR="#EBEBEB">FINGERPRINT</td> <td>TEXT</td> <td>Hash of all inputs and parameters of the run</td> </tr>
+      </table>
+
+    The manifest is removed by finishCheckpointing() once the run is complete.
+
    */
   class OPENMS_DLLAPI OpenSwathOSWWriter
   {
@@ -122,6 +137,16 @@ namespace OpenMS
     bool sonar_;
     bool enable_uis_scoring_;
 
+    /// Queue and thread used by startWriterThread() (shared between copies)
+    struct AsyncWriter;
+    std::shared_ptr<AsyncWriter> async_writer_;
+    /// Serializes synchronous writes of several threads to the same file (shared between copies)
+    std::shared_ptr<std::mutex> sync_write_mutex_;
+
+    String checkpoint_fingerprint_;
+    bool resume_;
+    std::set<Size> completed_windows_;
+
   public:
 
     OpenSwathOSWWriter(const String& output_filename,
@@ -193,11 +218,108 @@ namespace OpenMS
      * @note Try to call this function as little as possible (it opens a new
      * database connection each time)
      *
-     * @note Only call inside an OpenMP critical section
+     * @note May be called concurrently from several threads. Without a
+     * running writer thread (see startWriterThread()) the calls are
+     * serialized on an internal lock, as SQLite allows only one writer.
      *
      */
     void writeLines(const std::vector<String>& to_osw_output);
 
+    /// Same as above, but hands over the statements without copying them to the writer thread
+    void writeLines(std::vector<String>&& to_osw_output);
+
+    /**
+     * @brief Start a dedicated thread which performs all subsequent writes
+     *
+     * Once started, writeLines() only appends the statements to a lock-free
+     * queue and returns immediately, so it may be called concurrently from
+     * several threads. The writer thread keeps a single connection open (in
+     * WAL mode) and commits everything that was queued since its last commit
+     * in one transaction. Call flush() to wait until all statements are on disk.
+     *
+     * If more than @p max_queued_statements statements are waiting to be
+     * committed, writeLines() blocks until the writer thread has caught up.
+     * After a failed statement on the writer thread, writeLines() discards all
+     * further statements and flush() reports the error.
+     *
+     * Does nothing if the writer is not active or the thread is already running.
+     *
+     * @note Call writeHeader() before starting the writer thread
+     *
+     */
+    void startWriterThread(Size max_queued_statements = 10000);
+
+    /**
+     * @brief Commit all queued statements and stop the writer thread
+     *
+     * Blocks until everything passed to writeLines() has been written. The
+     * database is switched back to the default (rollback journal) mode, so the
+     * resulting file is identical to one written without the writer thread.
+     *
+     * @throws Exception::IllegalArgument or Exception::SqlOperationFailed if a statement failed on the writer thread
+     *
+     */
+    void flush();
+
+    /**
+     * @brief Checks whether @p filename contains a checkpoint manifest created with @p fingerprint
+     *
+     * If so, an interrupted run can be resumed on this file (see enableCheckpointing()).
+     *
+     */
+    static bool hasCheckpoint(const String& filename, const String& fingerprint);
+
+    /**
+     * @brief Record which SWATH windows are completely written to the file
+     *
+     * Completed windows are recorded in a manifest table (CHECKPOINT), in the
+     * same transaction as their features (see prepareCheckpoint()), so that the
+     * manifest always matches the features present in the file.
+     *
+     * If the file already contains a manifest created with the same @p
+     * fingerprint, the interrupted run is resumed: its run id is reused,
+     * writeHeader() keeps the existing tables and getCompletedWindows()
+     * returns the windows which do not need to be processed again. Otherwise
+     * writeHeader() creates the manifest together with the other tables.
+     *
+     * @param fingerprint Hash of all inputs and parameters that influence the results
+     *
+     * @throws Exception::IllegalArgument if the file contains a manifest with a different fingerprint
+     *
+     * @note Call before writeHeader()
+     *
+     */
+    void enableCheckpointing(const String& fingerprint);
+
+    /// Whether completed windows are recorded (see enableCheckpointing())
+    bool isCheckpointing() const;
+
+    /// Whether enableCheckpointing() resumes a previous run
+    bool isResuming() const;
+
+    /// SWATH windows completely written by a previous run (see enableCheckpointing())
+    const std::set<Size>& getCompletedWindows() const;
+
+    /**
+     * @brief Prepare the statement which marks SWATH window @p window as completely written
+     *
+     * Pass it to writeLines() together with the statements of all features
+     * of this window. Returns an empty string if checkpointing is disabled.
+     *
+     */
+    String prepareCheckpoint(Size window) const;
+
+    /**
+     * @brief Remove the manifest once all windows are written
+     *
+     * The resulting file is identical to one written without checkpointing.
+     * Does nothing if checkpointing is disabled.
+     *
+     * @note Call flush() first if the writer thread is running
+     *
+     */
+    void finishCheckpointing();
+
   };
 
 }
@@ -63,8 +63,10 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMTransitionGroupPicker.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/SwathMapMassCorrection.h>
 #include <OpenMS/FILTERING/TRANSFORMERS/LinearResamplerAlign.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
 
 #include <cassert>
+#include <functional>
 #include <limits>
 
 // #define OPENSWATH_WORKFLOW_DEBUG
@@ -120,13 +122,8 @@ protected:
     /** @brief Constructor
      *
      *  @param use_ms1_traces Whether to use MS1 data
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
-     *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
+     *  @param threads_outer_loop How many SWATH windows should be processed
+     *  at the same time (-1 for one window per thread)
      *
      **/
     OpenSwathWorkflowBase(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, bool pasef, int threads_outer_loop) :
@@ -187,6 +184,34 @@ protected:
                                        const int ms1_isotopes = -1) const;
 
 
+    /** @brief Number of SWATH windows that are processed at the same time
+     *
+     * This is threads_outer_loop_ if it is set and the number of threads
+     * otherwise, but never more than there are windows (and at least one).
+     *
+     * @param nr_windows Number of windows to be processed
+     *
+    */
+    Size getWindowSlotCount_(Size nr_windows) const;
+
+    /** @brief Process SWATH windows in parallel, at most @p nr_slots of them at the same time
+     *
+     * Each window becomes an (untied) OpenMP task that may create further
+     * tasks. The windows are distributed round-robin over @p nr_slots
+     * slots and the tasks of a slot depend on each other, so a window is
+     * only started once the previous window of its slot is done. Without
+     * task support (OpenMP < 4.0) the windows are processed in a parallel
+     * loop on @p nr_slots threads.
+     *
+     * @param windows Indices of the windows in the order they should be started
+     * @param nr_slots Maximal number of windows processed at the same time
+     * @param process_window Called once with the index of each window
+     *
+    */
+    static void runWindowTasks_(const std::vector<Size>& windows,
+                                Size nr_slots,
+                                const std::function<void(Size)>& process_window);
+
     /**
      * @brief Spectrum Access to the MS1 map (note that this is *not* threadsafe!)
      *
@@ -222,13 +247,13 @@ protected:
     */
     bool pasef_;
 
-    /** @brief How many threads should be used for the outer loop
+    /** @brief How many SWATH windows should be processed at the same time
      *
-     *  @note A value of -1 will use all threads in the outer loop
+     *  All threads work on the batches of the windows currently processed, so
+     *  this only limits how many windows are held in memory at once (e.g.
+     *  when loading them into memory).
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
+     *  @note A value of -1 processes as many windows at once as there are threads
      *
      **/
     int threads_outer_loop_;
@@ -390,9 +415,10 @@ protected:
    *
    *    - Obtain precursor ion chromatograms (if enabled) through MS1Extraction_()
    *    - Perform scoring of precursor ion chromatograms if no MS2 is given
-   *    - Iterate through each SWATH-MS window:
-   *      - Select which transitions to extract (proceed in batches) using OpenSwathHelper::selectSwathTransitions()
-   *      - Iterate through each batch of transitions:
+   *    - Select which transitions to extract from each SWATH-MS window (see selectTransitionsForWindow_())
+   *    - Process each SWATH-MS window as a task, starting with the windows containing most assays:
+   *      - Load the window into memory (if requested)
+   *      - Process each batch of transitions as a separate task:
    *        - Extract current batch of transitions from current SWATH window:
    *          - Select transitions for current batch (see selectCompoundsForBatch_())
    *          - Prepare transition extraction (see prepareExtractionCoordinates_())
@@ -400,6 +426,11 @@ protected:
    *          - Convert data to OpenMS format using ChromatogramExtractor::return_chromatogram()
    *        - Score extracted transitions (see scoreAllChromatograms_())
    *        - Write scored chromatograms and peak groups to disk (see writeOutFeaturesAndChroms_())
+   *    - Report the time spent in each of these stages and the core utilization
+   *
+   * Idle threads pick up pending batch tasks of any window, so all threads
+   * stay busy until the last batch is finished, even if the windows contain
+   * very different numbers of assays (e.g. with variable windows).
    *
    */
   class OPENMS_DLLAPI OpenSwathWorkflow :
@@ -414,15 +445,10 @@ protected:
      *
      *  @param use_ms1_traces Whether to use MS1 data
      *  @param use_ms1_ion_mobility Whether to use ion mobility extraction on MS1 traces
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
+     *  @param threads_outer_loop How many SWATH windows should be processed
+     *  at the same time (-1 for one window per thread)
      *  @param prm Whether data is acquired in targeted DIA (e.g. PRM mode) with potentially overlapping windows
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
-     *
      **/
     OpenSwathWorkflow(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, bool pasef, int threads_outer_loop) :
     OpenSwathWorkflowBase(use_ms1_traces, use_ms1_ion_mobility, prm, pasef, threads_outer_loop)
@@ -453,6 +479,12 @@ protected:
      * potentially decrease the utility of parallelization while loading data
      * into memory will increase memory usage but decrease execution time.
      *
+     * @note If checkpointing is enabled on \p result_osw (see
+     * OpenSwathOSWWriter::enableCheckpointing()), the features of each SWATH
+     * window are kept in memory until the window is complete and then written
+     * together with its checkpoint entry. Windows completed by an interrupted
+     * previous run are skipped.
+     *
     */
     void performExtraction(const std::vector< OpenSwath::SwathMap > & swath_maps,
                            const TransformationDescription trafo,
@@ -471,6 +503,54 @@ protected:
 
   protected:
 
+    /// Stages of performExtraction() for which the time spent is reported
+    enum ExtractionStage
+    {
+      STAGE_SELECTION,
+      STAGE_LOADING,
+      STAGE_MS1_EXTRACTION,
+      STAGE_MS2_EXTRACTION,
+      STAGE_SCORING,
+      STAGE_WRITING,
+      SIZE_OF_EXTRACTIONSTAGE
+    };
+
+    /** @brief Add the time measured by a running stop watch to a stage total and reset the stop watch
+     *
+     * @note Thread-safe, the total is updated atomically.
+    */
+    static void addStageTime_(double& stage_total, StopWatch& stage_time);
+
+    /// Print the time spent per stage (summed over all threads) and the resulting core utilization
+    void reportStageTimes_(const double (&stage_times)[SIZE_OF_EXTRACTIONSTAGE], double wall_time) const;
+
+    /** @brief Select the transitions to be extracted from a single SWATH window
+     *
+     * For regular data all transitions with a precursor inside the window
+     * are selected. For PRM and diaPASEF data only transitions assigned to
+     * this window in @p tr_win_map are selected.
+     *
+     * @param swath_maps The raw data (swath maps)
+     * @param map_idx Index of the current window in @p swath_maps
+     * @param transition_exp The full set of transitions
+     * @param tr_win_map Maps each transition to its best window (only used for PRM and diaPASEF data)
+     * @param cp Parameter set for the chromatogram extraction
+     * @param transition_exp_used_all Output containing the selected transitions, compounds and proteins
+     *
+    */
+    void selectTransitionsForWindow_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+                                     SignedSize map_idx,
+                                     const OpenSwath::LightTargetedExperiment& transition_exp,
+                                     const std::vector<int>& tr_win_map,
+                                     const ChromExtractParams & cp,
+                                     OpenSwath::LightTargetedExperiment& transition_exp_used_all) const;
+
+    /// Number of transitions selectTransitionsForWindow_() would select for window @p map_idx (without copying them)
+    Size countTransitionsForWindow_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+                                    SignedSize map_idx,
+                                    const OpenSwath::LightTargetedExperiment& transition_exp,
+                                    const std::vector<int>& tr_win_map,
+                                    const ChromExtractParams & cp) const;
 
     /** @brief Write output features and chromatograms
      *
@@ -526,6 +606,7 @@ protected:
      * @param tsv_writer TSV writer for storing output (on the fly)
      * @param osw_writer OSW Writer object to store identified features in SQLite format
      * @param ms1only If true, will only score on MS1 level and ignore MS2 level
+     * @param osw_output If given, the OSW statements are appended here instead of being passed to @p osw_writer (used to write all features of a window at once)
      *
     */
     void scoreAllChromatograms_(
@@ -540,7 +621,8 @@ protected:
         OpenSwathTSVWriter & tsv_writer,
         OpenSwathOSWWriter & osw_writer,
         int nr_ms1_isotopes = 0,
-        bool ms1only = false) const;
+        bool ms1only = false,
+        std::vector<String>* osw_output = nullptr) const;
 
     /** @brief Select which compounds to analyze in the next batch (and copy to output)
      *
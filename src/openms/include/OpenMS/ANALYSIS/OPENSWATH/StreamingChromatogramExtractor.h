@@ -0,0 +1,225 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractorAlgorithm.h>
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/SwathMap.h>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Extracts chromatograms of MS1 and all SWATH windows in a single pass over a stream of spectra
+
+    In contrast to ChromatogramExtractorAlgorithm, which extracts from a
+    spectrum access (i.e. an in-memory or cached map of a single SWATH
+    window), this consumer extracts while the spectra are read (e.g. using
+    MzMLFile::transform()). Neither a cached file nor an in-memory map is
+    needed and the input is read only once, independent of the number of
+    SWATH windows.
+
+    Usage:
+      - Add the coordinates extracted from MS1 spectra (addMS1Coordinates())
+        and those extracted from MS2 spectra (addMS2Coordinates())
+      - Pass all spectra to consumeSpectrum() (e.g. via MzMLFile::transform())
+      - The chromatograms passed in as output are now filled
+
+    MS2 coordinates are assigned to SWATH windows while the spectra are read:
+    when a spectrum with a new isolation window is encountered, all not yet
+    assigned coordinates whose precursor m/z (ExtractionCoordinates::mz_precursor)
+    fall into the window are assigned to it (using the same criterion as
+    OpenSwathHelper::selectSwathTransitions()). Each coordinate is thus
+    extracted from the first matching window of the input only. Windows are
+    identified by their precursor m/z and ion mobility limits, as in
+    FullSwathFileConsumer.
+
+    Within a spectrum, all coordinates of a window are extracted in one sweep
+    over the peaks (the window borders of coordinates sorted by m/z are
+    monotonic). The intensities within the m/z window of a coordinate are
+    summed over a contiguous range of peaks, using either equal weights
+    ("tophat") or weights decreasing linearly from the center of the window
+    ("bartlett"). Peaks exactly on the window border are not counted.
+
+    @note The peaks of each spectrum need to be sorted by m/z.
+
+    @note Compared to ChromatogramExtractorAlgorithm::extract_value_tophat(),
+    the first and the last peak of a spectrum are extracted like all other
+    peaks and the intensities are summed from low to high m/z (which can
+    cause differences in the last digits).
+  */
+  class OPENMS_DLLAPI StreamingChromatogramExtractor :
+    public Interfaces::IMSDataConsumer
+  {
+public:
+
+    typedef ChromatogramExtractorAlgorithm::ExtractionCoordinates ExtractionCoordinates;
+
+    /**
+      @brief Constructor
+
+      @param mz_extraction_window Extracts a window of this size in m/z
+      dimension in Th or ppm (e.g. a window of 50 ppm means an extraction of
+      25 ppm on either side)
+      @param ppm Whether mz_extraction_window is in ppm or in Th
+      @param im_extraction_window Full window width for IM extraction (a value <= 0 disables IM extraction)
+      @param filter Which function to apply in m/z space ("tophat" or "bartlett")
+
+      @throws Exception::IllegalArgument if the filter is unknown
+    */
+    StreamingChromatogramExtractor(double mz_extraction_window, bool ppm, double im_extraction_window, const String& filter);
+
+    /// Destructor
+    ~StreamingChromatogramExtractor() override;
+
+    /**
+      @brief Add coordinates to be extracted from all MS1 spectra
+
+      @param coordinates Extracts around these coordinates (from rt_start to
+      rt_end in seconds - extracts the whole chromatogram if rt_end - rt_start < 0)
+      @param output Output chromatograms, one per coordinate (data is appended while spectra are consumed)
+
+      @throws Exception::IllegalArgument if sizes of @p coordinates and @p output differ or spectra were already consumed
+    */
+    void addMS1Coordinates(const std::vector<ExtractionCoordinates>& coordinates,
+                           const std::vector<OpenSwath::ChromatogramPtr>& output);
+
+    /**
+      @brief Add coordinates to be extracted from the MS2 spectra of the SWATH window containing their precursor
+
+      @param coordinates Extracts around these coordinates (see addMS1Coordinates()), mz_precursor is used to select the SWATH window
+      @param output Output chromatograms, one per coordinate (data is appended while spectra are consumed)
+      @param min_upper_edge_dist Minimal distance of the precursor to the upper edge of a window (in Th)
+
+      @throws Exception::IllegalArgument if sizes of @p coordinates and @p output differ or spectra were already consumed
+    */
+    void addMS2Coordinates(const std::vector<ExtractionCoordinates>& coordinates,
+                           const std::vector<OpenSwath::ChromatogramPtr>& output,
+                           double min_upper_edge_dist = 0.0);
+
+    /// The SWATH windows encountered so far (in the order of the input)
+    const std::vector<OpenSwath::SwathMap>& getSwathWindows() const;
+
+    /**
+      @brief Index of the SWATH window (see getSwathWindows()) from which a MS2 coordinate is extracted
+
+      @param index Index of the coordinate (counting all coordinates passed to addMS2Coordinates() in order)
+      @return Window index, or -1 if no matching window was encountered (so far)
+    */
+    int getWindowIndex(Size index) const;
+
+    /// Number of spectra consumed so far
+    Size getNrSpectra() const;
+
+    /// @name IMSDataConsumer interface
+    //@{
+    /// ignored
+    void setExpectedSize(Size expectedSpectra, Size expectedChromatograms) override;
+
+    /**
+      @brief Extract all coordinates matching the spectrum
+
+      MS1 spectra are used for the MS1 coordinates, all other spectra for the
+      MS2 coordinates of their SWATH window.
+
+      @throws Exception::InvalidParameter if a MS2 spectrum has no precursor
+      @throws Exception::IllegalArgument if ion mobility extraction is requested but a spectrum has no ion mobility array
+    */
+    void consumeSpectrum(SpectrumType& s) override;
+
+    /// ignored
+    void consumeChromatogram(ChromatogramType& c) override;
+
+    /// ignored
+    void setExperimentalSettings(const ExperimentalSettings& exp) override;
+    //@}
+
+protected:
+
+    /// A coordinate with precomputed window borders
+    struct Target_
+    {
+      double mz;
+      double left;
+      double right;
+      double ion_mobility;
+      double rt_start;
+      double rt_end;
+      OpenSwath::ChromatogramPtr output;
+    };
+
+    /// Create a target for a coordinate (precomputes the m/z window)
+    Target_ makeTarget_(const ExtractionCoordinates& coordinate, const OpenSwath::ChromatogramPtr& output) const;
+
+    /// Sort targets by m/z (such that the window borders are monotonic)
+    static void sortTargets_(std::vector<Target_>& targets);
+
+    /// Find the window of a MS2 spectrum, adding a new window (and assigning its coordinates) if needed
+    Size findOrAddWindow_(const SpectrumType& s);
+
+    /// Extract all @p targets (sorted by m/z) from the peaks currently stored in mz_, intensity_ and im_
+    void extractTargets_(const std::vector<Target_>& targets, double rt, bool has_im) const;
+
+    /// Copy the peaks (and ion mobility values) of @p s into mz_, intensity_ and im_; returns whether IM data is present
+    bool loadSpectrum_(const SpectrumType& s);
+
+    double mz_extraction_window_;
+    bool ppm_;
+    double im_extraction_window_;
+    /// true for "bartlett", false for "tophat"
+    bool bartlett_;
+
+    /// MS1 targets (sorted by m/z)
+    std::vector<Target_> ms1_targets_;
+
+    /// MS2 coordinates waiting for their window (in the order they were added)
+    std::vector<Target_> ms2_targets_;
+    std::vector<double> ms2_precursor_mz_;
+    std::vector<double> ms2_min_upper_edge_dist_;
+    std::vector<int> ms2_window_;
+
+    std::vector<OpenSwath::SwathMap> windows_;
+    /// targets of each window (sorted by m/z)
+    std::vector<std::vector<Target_> > window_targets_;
+
+    Size nr_spectra_ = 0;
+
+    /// peaks of the current spectrum (reused between spectra)
+    std::vector<double> mz_;
+    std::vector<double> intensity_;
+    std::vector<double> im_;
+  };
+}
+
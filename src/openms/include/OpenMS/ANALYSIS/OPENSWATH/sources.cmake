@@ -10,6 +10,7 @@ set(sources_list_h
   DIAPrescoring.h
   DIAScoring.h
   IonMobilityScoring.h
+  MappedTransitionLibrary.h
   MasstraceCorrelator.h
   MRMAssay.h
   MRMDecoy.h
@@ -36,6 +37,7 @@ set(sources_list_h
   SwathWindowLoader.h
   SwathQC.h
   SpectrumAddition.h
+  StreamingChromatogramExtractor.h
   TargetedSpectraExtractor.h
   TransitionTSVFile.h
   TransitionPQPFile.h
@@ -38,10 +38,12 @@
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/CONCEPT/Macros.h>
 #include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/CHEMISTRY/SimpleTSG.h>
 #include <vector>
 
 namespace OpenMS
 {
+  class ColumnarSpectrum;
 
 /**
  *  @brief An implementation of the X!Tandem HyperScore PSM scoring function
@@ -67,6 +69,14 @@ struct OPENMS_DLLAPI HyperScore
                         const PeakSpectrum& exp_spectrum, 
                         const PeakSpectrum& theo_spectrum);
 
+  /** @brief compute the (ln transformed) X!Tandem HyperScore for a measured spectrum stored as structure of arrays
+   *  Peaks are matched exactly as in the PeakSpectrum overload (closest peak within tolerance), so both return the same score.
+   */
+  static double compute(double fragment_mass_tolerance, 
+                        bool fragment_mass_tolerance_unit_ppm, 
+                        const ColumnarSpectrum& exp_spectrum, 
+                        const PeakSpectrum& theo_spectrum);
+
   /** @brief compute the (ln transformed) X!Tandem HyperScore 
    *  overload that returns some additional information on the match
    */
@@ -84,9 +94,113 @@ struct OPENMS_DLLAPI HyperScore
                         PSMDetail& d
                        );
 
+  /**
+   *  @brief A measured spectrum prepared for scoring it against many theoretical spectra
+   *
+   *  m/z and intensity values are copied into two contiguous arrays and a table stores the first peak of each m/z bin.
+   *  The peak closest to a theoretical peak is then found with one table lookup and a scan of (typically) a few peaks,
+   *  instead of walking the measured spectrum in parallel with every theoretical spectrum.
+   *  Peaks are matched as by MatchedIterator (closest peak within tolerance, the smaller m/z on ties), so the scores
+   *  are identical to those of the PeakSpectrum overloads.
+   *  @note Unlike MatchedIterator, the search does not get stuck on measured peaks whose distances to a theoretical
+   *  peak are equal in single precision (e.g. duplicated m/z values); such spectra may therefore score higher.
+   */
+  class PreparedSpectrum
+  {
+  public:
+    /// Default constructor (no peaks)
+    PreparedSpectrum() = default;
+
+    /**
+     *  @brief Prepares the peaks of @p exp_spectrum, which must be sorted by m/z
+     *  @param exp_spectrum measured spectrum
+     *  @param bin_width width of the lookup bins (in Th)
+     *  @exception Exception::InvalidValue if @p bin_width is not positive
+     */
+    explicit PreparedSpectrum(const PeakSpectrum& exp_spectrum, double bin_width = 1.0);
+
+    /// number of peaks
+    Size size() const { return mz_.size(); }
+
+    /// true if there are no peaks
+    bool empty() const { return mz_.empty(); }
+
+    /// m/z of the peak at @p index
+    double getMZ(Size index) const { return mz_[index]; }
+
+    /// intensity of the peak at @p index
+    float getIntensity(Size index) const { return intensity_[index]; }
+
+    /// index of the first peak with an m/z not smaller than @p mz (size() if there is none)
+    Size lowerBound(double mz) const;
+
+    /// index of the peak closest to @p mz, preferring the smaller m/z on ties (the spectrum must not be empty)
+    Size findNearest(double mz) const;
+
+  private:
+    std::vector<double> mz_;
+    std::vector<float> intensity_;
+    /// index of the first peak of each bin
+    std::vector<UInt32> bin_begin_;
+    double min_mz_ = 0.0;
+    double inv_bin_width_ = 1.0;
+  };
+
+  /// compute the (ln transformed) X!Tandem HyperScore using a prepared measured spectrum (same score as the PeakSpectrum overload)
+  static double compute(double fragment_mass_tolerance,
+                        bool fragment_mass_tolerance_unit_ppm,
+                        const PreparedSpectrum& exp_spectrum,
+                        const PeakSpectrum& theo_spectrum);
+
+  /// compute the (ln transformed) X!Tandem HyperScore and match details using a prepared measured spectrum (same result as the PeakSpectrum overload)
+  static double computeWithDetail(double fragment_mass_tolerance,
+                        bool fragment_mass_tolerance_unit_ppm,
+                        const PreparedSpectrum& exp_spectrum,
+                        const PeakSpectrum& theo_spectrum,
+                        PSMDetail& d);
+
+  /**
+   *  @brief compute the (ln transformed) X!Tandem HyperScore and match details for fragments generated by SimpleTSG
+   *
+   *  The ion type of each fragment replaces the ion annotation, so the result is the same as for a theoretical
+   *  spectrum with the same peaks and ion names (see FragmentIndex::getSpectrum), without building that spectrum.
+   *  @param theo_fragments theoretical fragments sorted by m/z
+   */
+  static double computeWithDetail(double fragment_mass_tolerance,
+                        bool fragment_mass_tolerance_unit_ppm,
+                        const PreparedSpectrum& exp_spectrum,
+                        const std::vector<SimpleTSG::Fragment>& theo_fragments,
+                        PSMDetail& d);
+
+  /**
+   *  @brief compute the HyperScores of one measured spectrum against many theoretical spectra
+   *
+   *  The prepared measured spectrum stays in cache while all candidates are scored.
+   *  @param fragment_mass_tolerance mass tolerance applied left and right of the theoretical spectrum peak position
+   *  @param fragment_mass_tolerance_unit_ppm Unit of the mass tolerance is: Thomson if false, ppm if true
+   *  @param exp_spectrum prepared measured spectrum
+   *  @param theo_spectra theoretical spectra (with ion annotations as provided by TheoreticalSpectrumGenerator)
+   *  @param scores score of each theoretical spectrum (resized to the number of theoretical spectra)
+   *  @param details match details of each theoretical spectrum (resized to the number of theoretical spectra)
+   */
+  static void computeBatch(double fragment_mass_tolerance,
+                           bool fragment_mass_tolerance_unit_ppm,
+                           const PreparedSpectrum& exp_spectrum,
+                           const std::vector<PeakSpectrum>& theo_spectra,
+                           std::vector<double>& scores,
+                           std::vector<PSMDetail>& details);
+
   private:
     /// helper to compute the log factorial
     static double logfactorial_(const int x, int base = 2);
+
+    /**
+     *  @brief shared body of the compute() overloads
+     *
+     *  @p for_each_match(visit) calls visit(theo_index, exp_intensity) for each theoretical peak matched in the measured spectrum.
+     */
+    template <typename MATCHER>
+    static double computeFromMatches_(const PeakSpectrum& theo_spectrum, MATCHER for_each_match);
 };
 
 }
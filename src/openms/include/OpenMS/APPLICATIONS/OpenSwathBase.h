@@ -46,6 +46,7 @@
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
 #include <OpenMS/FORMAT/TransformationXMLFile.h>
 #include <OpenMS/FORMAT/SwathFile.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/MappedTransitionLibrary.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/SwathWindowLoader.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionTSVFile.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionPQPFile.h>
@@ -343,9 +344,17 @@ protected:
       tsv_reader.convertTSVToTargetedExperiment(tr_file.c_str(), tr_type, transition_exp);
       progresslogger.endProgress();
     }
+    else if (tr_type == FileTypes::TLIB)
+    {
+      progresslogger.startProgress(0, 1, "Load transition library");
+      MappedTransitionLibrary library;
+      library.load(tr_file);
+      library.toLightTargetedExperiment(transition_exp);
+      progresslogger.endProgress();
+    }
     else
     {
-      OPENMS_LOG_ERROR << "Provide valid TraML, TSV or PQP transition file." << std::endl;
+      OPENMS_LOG_ERROR << "Provide valid TraML, TSV, PQP or binary (tlib) transition file." << std::endl;
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Need to provide valid input file.");
     }
     return transition_exp;
@@ -0,0 +1,181 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CHEMISTRY/Residue.h>
+#include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  class AASequence;
+  class ResidueModification;
+
+  /**
+      @brief Generates the fragment ion ladders of peptides into flat buffers
+
+      This is a lightweight alternative to TheoreticalSpectrumGenerator for search engines that score many candidates.
+      It generates the same single-peak a-, b-, c-, x-, y- and z-ion m/z values (bit-identical, sorted by m/z),
+      but no isotope, loss, precursor or immonium peaks, and no spectrum object, ion names or charge arrays.
+
+      The fragments are written to a vector owned by the caller, so repeated calls with the same vector do not allocate.
+      The cumulative residue masses of the last peptide are kept: the next peptide only adds up the residues
+      after the prefix (and before the suffix) it shares with the previous one. Candidates should therefore be generated in an
+      order in which neighbours share residues, e.g. all modified variants of a peptide in a row or peptides sorted by sequence.
+
+      Parameters are named as in TheoreticalSpectrumGenerator, so its parameters can be copied.
+
+      @note Because of the cached ladders, a single instance must not be used by several threads at the same time.
+
+      @htmlinclude OpenMS_SimpleTSG.parameters
+
+      @ingroup Chemistry
+  */
+  class OPENMS_DLLAPI SimpleTSG :
+    public DefaultParamHandler
+  {
+    public:
+
+      /// A fragment ion
+      struct Fragment
+      {
+        double mz = 0.0; ///< m/z of the fragment
+        float intensity = 1.0f; ///< intensity of the ion type (as set by the parameters)
+        char ion_type = ' '; ///< ion type ('a', 'b', 'c', 'x', 'y' or 'z')
+        Int charge = 1; ///< charge of the fragment
+      };
+
+      /** @name Constructors and Destructors
+      */
+      //@{
+      /// default constructor
+      SimpleTSG();
+
+      /// copy constructor (the cached ladders are not copied)
+      SimpleTSG(const SimpleTSG& source);
+
+      /// destructor
+      ~SimpleTSG() override;
+      //@}
+
+      /// assignment operator (the cached ladders are not copied)
+      SimpleTSG& operator=(const SimpleTSG& source);
+
+      /**
+        @brief Generates the fragment ions of @p peptide for all charges from @p min_charge to @p max_charge
+
+        @param fragments Fragments sorted by m/z (the previous content is replaced)
+        @param peptide The peptide to fragment
+        @param min_charge Minimal fragment charge
+        @param max_charge Maximal fragment charge
+
+        @exception Exception::InvalidSize is thrown if c- or x-ions are requested for a peptide with less than two residues
+      */
+      void getSpectrum(std::vector<Fragment>& fragments, const AASequence& peptide, Int min_charge, Int max_charge);
+
+      /**
+        @brief Generates the fragment m/z values of @p peptide for all charges from @p min_charge to @p max_charge
+
+        @param mzs Fragment m/z values in ascending order (the previous content is replaced)
+        @param peptide The peptide to fragment
+        @param min_charge Minimal fragment charge
+        @param max_charge Maximal fragment charge
+
+        @exception Exception::InvalidSize is thrown if c- or x-ions are requested for a peptide with less than two residues
+      */
+      void getSpectrum(std::vector<double>& mzs, const AASequence& peptide, Int min_charge, Int max_charge);
+
+      /// number of residue masses added up by the last call (less than twice the peptide length per charge if residues were shared)
+      Size getComputedResidueMasses() const;
+
+    protected:
+
+      void updateMembers_() override;
+
+      /// forget the cached ladders
+      void clearCache_();
+
+      /// updates the cumulative masses for @p peptide, reusing those of the residues it shares with the previous peptide
+      void updateLadders_(const AASequence& peptide, Int min_charge, Int max_charge);
+
+      /// generates the ions of all enabled types and charges into unsorted_ (each type and charge is one ascending run starting at run_starts_)
+      void generate_(const AASequence& peptide, Int min_charge, Int max_charge);
+
+      /// merges the runs of unsorted_ in ascending m/z order; @p emit is called for each fragment
+      template <typename EMIT>
+      void mergeRuns_(EMIT emit);
+
+      /// appends the ions of one type and charge to unsorted_ (in ascending m/z order) using the current ladders
+      void addIons_(Residue::ResidueType res_type, Int charge);
+
+      bool add_b_ions_;
+      bool add_y_ions_;
+      bool add_a_ions_;
+      bool add_c_ions_;
+      bool add_x_ions_;
+      bool add_z_ions_;
+      bool add_first_prefix_ion_;
+
+      double a_intensity_;
+      double b_intensity_;
+      double c_intensity_;
+      double x_intensity_;
+      double y_intensity_;
+      double z_intensity_;
+
+      /// residues of the last peptide
+      std::vector<const Residue*> residues_;
+      /// terminal modifications of the last peptide
+      const ResidueModification* n_term_mod_ = nullptr;
+      const ResidueModification* c_term_mod_ = nullptr;
+      /// charge range of the last peptide
+      Int min_charge_ = 0;
+      Int max_charge_ = -1;
+      /// per charge: proton masses plus N-terminal modification plus the residues 0..i (in this order of summation)
+      std::vector<std::vector<double> > prefix_masses_;
+      /// per charge: proton masses plus C-terminal modification plus the last i + 1 residues (in this order of summation)
+      std::vector<std::vector<double> > suffix_masses_;
+      /// number of residue masses added up by the last call
+      Size computed_residue_masses_ = 0;
+      /// ions before sorting (reused between calls)
+      std::vector<Fragment> unsorted_;
+      /// start of each ascending run in unsorted_ (followed by the end of the last run)
+      std::vector<Size> run_starts_;
+      /// current position in each run while merging
+      std::vector<Size> run_heads_;
+  };
+}
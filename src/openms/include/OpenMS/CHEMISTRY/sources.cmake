@@ -33,6 +33,7 @@ RNaseDB.h
 RNaseDigestion.h
 Ribonucleotide.h
 RibonucleotideDB.h
+SimpleTSG.h
 SimpleTSGXLMS.h
 SpectrumAnnotator.h
 SvmTheoreticalSpectrumGenerator.h
@@ -39,6 +39,7 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <OpenMS/DATASTRUCTURES/StringUtilsSimple.h>
+#include <OpenMS/FORMAT/FASTAArena.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
 
 #include <functional>
@@ -55,6 +56,7 @@ namespace OpenMS
 
   struct TFI_File; ///< template parameter for file-based FASTA access
   struct TFI_Vector; ///< template parameter for vector-based FASTA access
+  struct TFI_Arena; ///< template parameter for arena-based FASTA access (see FASTAArena)
 
   /**
   @brief This class allows for a chunk-wise single linear read over a (large) FASTA file, 
@@ -63,7 +65,7 @@ namespace OpenMS
   
   Internally uses FASTAFile class to read single sequences.
 
-  FASTAContainer supports two template specializations FASTAContainer<TFI_File> and FASTAContainer<TFI_Vector>.
+  FASTAContainer supports three template specializations FASTAContainer<TFI_File>, FASTAContainer<TFI_Vector> and FASTAContainer<TFI_Arena>.
   
   FASTAContainer<TFI_File> will make FASTA entries available chunk-wise from start to end by loading it from a FASTA file.
   This avoids having to load the full file into memory. While loading, the container will
@@ -73,6 +75,9 @@ namespace OpenMS
   FASTAContainer<TFI_Vector> simply takes an existing vector of FASTAEntries and provides the same interface
   (with a potentially huge speed benefit over FASTAContainer<TFI_File> since it does not need disk access, but at the cost of memory).
 
+  FASTAContainer<TFI_Arena> loads a FASTA file in parallel into a FASTAArena and provides the same interface. Only the
+  entries of the active chunk are copied to FASTAEntry objects; all entries can be read at any time.
+
   If an algorithm searches through a FASTA file linearly, you can use FASTAContainer<TFI_File> to pre-load a small chunk
   and start working, while loading the next chunk in a background thread and swap it in when the active chunk 
   was processed.
@@ -337,6 +342,122 @@ private:
   int cache_count_ = 0;
 };
 
+/**
+  @brief FASTAContainer<TFI_Arena> loads a FASTA file in parallel into a FASTAArena (requiring about as much memory as the file)
+  and makes its entries available chunk-wise, with the same interface as FASTAContainer<TFI_File>.
+
+  Chunks are copied from the arena instead of being parsed from disk, and readAt() is fast for all entries
+  (also those beyond the active chunk). The total number of entries is known after construction.
+*/
+template<>
+class FASTAContainer<TFI_Arena>
+{
+public:
+  FASTAContainer() = delete;
+
+  /// C'tor with FASTA filename (loads the whole file)
+  FASTAContainer(const String& FASTA_file)
+  {
+    arena_.load(FASTA_file);
+  }
+
+  /// how many entries were read and got swapped out already
+  size_t getChunkOffset() const
+  {
+    return chunk_offset_;
+  }
+
+  /** @brief Swaps in the background cache of entries, read previously via @p cacheChunk()
+
+      @return true if cache contains data; false if empty
+      @note Should be invoked by a single thread, followed by a barrier to sync access of subsequent calls to chunkAt()
+  */
+  bool activateCache()
+  {
+    chunk_offset_ += data_fg_.size();
+    data_fg_.swap(data_bg_);
+    data_bg_.clear();
+    return !data_fg_.empty();
+  }
+
+  /** @brief Copies up to @p suggested_size entries following the last cached chunk from the arena to the background cache
+
+     Call @p activateCache() afterwards to make the data available via @p chunkAt().
+     @return true if new data is available; false if background data is empty
+  */
+  bool cacheChunk(int suggested_size)
+  {
+    const size_t first = std::min(chunk_offset_ + data_fg_.size(), arena_.size());
+    const size_t last = std::min(first + std::max(suggested_size, 0), arena_.size());
+    arena_.getEntries(first, last, data_bg_);
+    return !data_bg_.empty();
+  }
+
+  /// number of entries in active cache
+  size_t chunkSize() const
+  {
+    return data_fg_.size();
+  }
+
+  /** @brief Retrieve a FASTA entry at cache position @p pos (fast)
+
+      Requires prior call to activateCache().
+      Index @p pos must be smaller than chunkSize().
+
+      @note: can be used by multiple threads at a time (until activateCache() is called)
+  */
+  const FASTAFile::FASTAEntry& chunkAt(size_t pos) const
+  {
+    return data_fg_[pos];
+  }
+
+  /** @brief Retrieve a FASTA entry at global position @p pos (fast for all entries)
+
+    @return true if reading was successful; false if @p pos is beyond the last entry
+  */
+  bool readAt(FASTAFile::FASTAEntry& protein, size_t pos) const
+  {
+    if (pos >= arena_.size())
+    {
+      return false;
+    }
+    arena_.getEntry(pos, protein);
+    return true;
+  }
+
+  /// is the FASTA file empty?
+  bool empty() const
+  {
+    return arena_.empty();
+  }
+
+  /// resets reading of the FASTA file, enables fresh reading of the entries from the beginning
+  void reset()
+  {
+    data_fg_.clear();
+    data_bg_.clear();
+    chunk_offset_ = 0;
+  }
+
+  /// number of entries in the FASTA file
+  size_t size() const
+  {
+    return arena_.size();
+  }
+
+  /// the underlying arena (for direct access to identifiers, descriptions and sequences)
+  const FASTAArena& getArena() const
+  {
+    return arena_;
+  }
+
+private:
+  FASTAArena arena_; ///< all entries of the FASTA file
+  std::vector<FASTAFile::FASTAEntry> data_fg_; ///< active (foreground) data
+  std::vector<FASTAFile::FASTAEntry> data_bg_; ///< prefetched (background) data; will become the next active data
+  size_t chunk_offset_ = 0; ///< number of entries before the current chunk
+};
+
 /**
   @brief Helper class for calculations on decoy proteins
 */
@@ -70,6 +70,11 @@ namespace OpenMS
     {
     }
 
+    // create view on a character range (e.g. in a memory-mapped file)
+    StringView(const char* begin, Size size) : begin_(begin), size_(size)
+    {
+    }
+
     /// less operator
     bool operator<(const StringView other) const
     {
@@ -47,6 +47,7 @@ struct svm_model;
 
 namespace OpenMS
 {
+  class IsotopeDistributionCache;
 
   /**
     @brief Internal structure used in @ref FeatureFindingMetabo that keeps
@@ -172,6 +173,11 @@ public:
     metabolites with only a monoisotopic mass trace to observe are left in the
     resulting @ref FeatureMap as singletons with the undefined charge state of 0.
 
+    Candidate traces of a hypothesis are looked up on a coarse RT grid (bins of
+    local_rt_range width), in which every bin keeps its traces in m/z order.
+    Hypotheses are collected per trace in parallel and concatenated in trace
+    order, so the result does not depend on the number of threads.
+
     Reference: Kenar et al., doi: 10.1074/mcp.M113.031278
 
     @htmlinclude OpenMS_FeatureFindingMetabo.parameters
@@ -300,8 +306,11 @@ private:
      * Compare the isotopic intensity distribution with the theoretical one
      * expected for peptides, using the averagine model. Compute the cosine
      * similarity between the two values.
+     *
+     * The averagine distributions are taken from @p averagine, which holds
+     * them precomputed per mass bin.
     */
-    double computeAveragineSimScore_(const std::vector<double>& intensities, const double& molecular_weight) const;
+    double computeAveragineSimScore_(const std::vector<double>& intensities, const double& molecular_weight, const IsotopeDistributionCache& averagine) const;
 
     /** @brief Identify groupings of mass traces based on a set of reasonable candidates
      *
@@ -310,8 +319,9 @@ private:
      * is assumed that candidates[0] is the monoisotopic trace.
      *
      * The resulting possible groupings are appended to output_hypotheses.
+     * @p averagine_cache must be provided if the 'peptides' isotope model is used.
     */
-    void findLocalFeatures_(const std::vector<const MassTrace*>& candidates, double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses) const;
+    void findLocalFeatures_(const std::vector<const MassTrace*>& candidates, double total_intensity, const IsotopeDistributionCache* averagine_cache, std::vector<FeatureHypothesis>& output_hypotheses) const;
 
     /// SVM parameters
     svm_model* isotope_filt_svm_ = nullptr;
@@ -65,6 +65,17 @@ namespace OpenMS
       length as well as having the minimal sample rate criterion fulfilled) get
       added to the result.
 
+      With OpenMP, the extension phase runs concurrently on strips of the m/z
+      axis (see the advanced parameter mz_strips). Every strip owns the apices
+      falling into its m/z range and extends them speculatively, while the
+      traces themselves may reach into neighbouring strips. A subsequent serial
+      pass walks through all apices in the original order of decreasing
+      intensity and accepts a speculative trace only if every peak it tested
+      still has the same visited state as in the serial algorithm; traces that
+      conflict with a trace from another strip are recomputed. The result is
+      therefore identical to the serial algorithm, independent of the number of
+      strips and threads.
+
       @htmlinclude OpenMS_MassTraceDetection.parameters
 
       @ingroup Quantitation
@@ -110,6 +121,34 @@ namespace OpenMS
           Size peak_idx;
         };
 
+        /// A mass trace grown from a single apex (see extendTrace_)
+        struct TraceCandidate
+        {
+          bool accepted = false; ///< passes the length and sample rate filters
+          std::vector<PeakType> peaks; ///< gathered peaks, ordered by RT (only kept for accepted traces)
+          std::vector<double> fwhms_mz; ///< peak-FWHM meta values of the gathered peaks
+          std::vector<Size> gathered; ///< global indices (see spec_offsets) of the gathered peaks
+          std::vector<Size> seen_free; ///< tested peaks that were not visited yet (recorded for speculative extension only)
+          std::vector<Size> seen_visited; ///< tested peaks that were already visited (recorded for speculative extension only)
+          std::vector<PeakType> down_; ///< scratch buffer for peaks gathered towards lower RT
+        };
+
+        /**
+          @brief Extends a mass trace from @p apex in both RT directions
+
+          Peaks whose bit is set in @p peak_visited are not gathered. If @p record_tests is set, every visited test
+          and its outcome is stored in @p trace, so that the extension can later be validated against a different visited state.
+          Only instantiated in the translation unit.
+        */
+        template <typename VisitedSet>
+        void extendTrace_(const Apex& apex,
+                          const PeakMap& work_exp,
+                          const std::vector<Size>& spec_offsets,
+                          const int fwhm_meta_idx,
+                          const VisitedSet& peak_visited,
+                          const bool record_tests,
+                          TraceCandidate& trace);
+
         /// The internal run method
         void run_(const std::vector<Apex>& chrom_apices,
                   const Size peak_count,
@@ -131,5 +170,7 @@ namespace OpenMS
         double max_trace_length_;
 
         bool reestimate_mt_sd_;
+
+        Size mz_strips_;
     };
 }
@@ -46,8 +46,10 @@
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <algorithm>
+#include <cctype>
 #include <iterator>
 #include <cmath>
+#include <type_traits>
 #include <vector>
 
 #include <QByteArray>
@@ -165,8 +167,30 @@ private:
       UInt32 i;
     };
 
-    static const char encoder_[];
-    static const char decoder_[];
+    /**
+        @brief Decodes Base64 characters into raw bytes
+
+        Characters outside of the Base64 alphabet (e.g. whitespace and the
+        padding character '=') are skipped. On x86 CPUs, an AVX2 or SSSE3
+        kernel is selected at runtime, other platforms use a table-driven
+        scalar loop.
+
+        @param in Pointer to the Base64 characters
+        @param in_size Number of characters
+        @param out Output buffer
+        @param out_size Size of the output buffer (decoding stops when it is full)
+
+        @return The number of bytes written to @p out
+    */
+    static Size decodeBytes_(const char* in, Size in_size, Byte* out, Size out_size);
+
+    /// Encodes @p in_size bytes into the 4 * ceil(@p in_size / 3) Base64 characters (including padding) at @p out
+    static void encodeBytes_(const Byte* in, Size in_size, char* out);
+
+    /// Decodes a Base64 string into a vector of 32 or 64 bit elements (swapping the byte order if necessary)
+    template <typename ToType>
+    static void decodeRaw_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
+
     /// Decodes a Base64 string to a vector of floating point numbers
     template <typename ToType>
     static void decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
@@ -280,57 +304,17 @@ private:
       String(compressed).swap(compressed);
       it = reinterpret_cast<Byte *>(&compressed[0]);
       end = it + compressed_length;
-      out.resize((Size)ceil(compressed_length / 3.) * 4);     //resize output array in order to have enough space for all characters
+      out.resize((compressed_length + 2) / 3 * 4);     //resize output array in order to have enough space for all characters
     }
     //encode without compression
     else
     {
-      out.resize((Size)ceil(input_bytes / 3.) * 4);     //resize output array in order to have enough space for all characters
+      out.resize((input_bytes + 2) / 3 * 4);     //resize output array in order to have enough space for all characters
       it = reinterpret_cast<Byte *>(&in[0]);
       end = it + input_bytes;
     }
 
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
-    out.resize(written);         //no more space is needed
+    encodeBytes_(it, end - it, &out[0]);
   }
 
   template <typename ToType>
@@ -356,8 +340,9 @@ private:
 
     String decompressed;
 
-    QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
+    QByteArray bazip;
+    bazip.resize((int) (in.size() / 4 * 3 + 3));
+    bazip.resize((int) decodeBytes_(in.c_str(), in.size(), reinterpret_cast<Byte *>(bazip.data()), bazip.size()));
     QByteArray czip;
     czip.resize(4);
     czip[0] = (bazip.size() & 0xff000000) >> 24;
@@ -406,119 +391,61 @@ private:
   }
 
   template <typename ToType>
-  void Base64::decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
+  void Base64::decodeRaw_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
   {
-    out.clear();
-
-    // The length of a base64 string is a always a multiple of 4 (always 3
-    // bytes are encoded as 4 characters)
-    if (in.size() < 4)
-    {
-      return;
-    }
-    if (in.size() % 4 != 0)
-    {
-      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Malformed base64 input, length is not a multiple of 4.");
-    }
-
-    Size src_size = in.size();
-    // last one or two '=' are skipped if contained
-    int padding = 0;
-    if (in[src_size - 1] == '=') padding++;
-    if (in[src_size - 2] == '=') padding++;
-
-    src_size -= padding;
-
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
+    static_assert(sizeof(ToType) == 4 || sizeof(ToType) == 8, "Only 32 and 64 bit types are supported");
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
+    // decode directly into the memory of the output vector
+    const Size max_bytes = in.size() / 4 * 3 + 3;
+    out.resize((max_bytes + element_size - 1) / element_size);
+    Size written = decodeBytes_(in.c_str(), in.size(), reinterpret_cast<Byte *>(out.data()), out.size() * element_size);
 
-    // Parse little endian data in big endian OpenMS (or other way round)
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || 
-       (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
+    // a padded last group stands for zero bytes (as in the original byte-wise decoder), which completes truncated elements
+    Size padding = 0;
+    for (Size i = in.size(); i > 0 && padding < 2; --i)
     {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
+      if (in[i - 1] == '=') ++padding;
+      else if (!std::isspace(static_cast<unsigned char>(in[i - 1]))) break;
     }
-    else
-    {
-      offset = 0;
-      inc = 1;
-    }
-
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
+    const Size padded = std::min(written + padding, out.size() * element_size);
+    std::fill(reinterpret_cast<Byte *>(out.data()) + written, reinterpret_cast<Byte *>(out.data()) + padded, Byte(0));
+    written = padded;
+    out.resize(written / element_size);
 
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
+    // change endianness if necessary
+    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
+      if (element_size == 4) // 32 bit
       {
-        a = 0;
+        UInt32 * p = reinterpret_cast<UInt32 *>(out.data());
+        std::transform(p, p + out.size(), p, endianize32);
       }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
+      else // 64 bit
       {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
+        UInt64 * p = reinterpret_cast<UInt64 *>(out.data());
+        std::transform(p, p + out.size(), p, endianize64);
       }
+    }
+  }
 
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
+  template <typename ToType>
+  void Base64::decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
+  {
+    out.clear();
 
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
+    // The length of a base64 string is a always a multiple of 4 (always 3
+    // bytes are encoded as 4 characters)
+    if (in.size() < 4)
+    {
+      return;
+    }
+    if (in.size() % 4 != 0)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Malformed base64 input, length is not a multiple of 4.");
     }
+
+    decodeRaw_(in, from_byte_order, out);
   }
 
   template <typename FromType>
@@ -575,57 +502,17 @@ private:
       String(compressed).swap(compressed);
       it = reinterpret_cast<Byte *>(&compressed[0]);
       end = it + compressed_length;
-      out.resize((Size)ceil(compressed_length / 3.) * 4);     //resize output array in order to have enough space for all characters
+      out.resize((compressed_length + 2) / 3 * 4);     //resize output array in order to have enough space for all characters
     }
     //encode without compression
     else
     {
-      out.resize((Size)ceil(input_bytes / 3.) * 4);     //resize output array in order to have enough space for all characters
+      out.resize((input_bytes + 2) / 3 * 4);     //resize output array in order to have enough space for all characters
       it = reinterpret_cast<Byte *>(&in[0]);
       end = it + input_bytes;
     }
 
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
-    out.resize(written);         //no more space is needed
+    encodeBytes_(it, end - it, &out[0]);
   }
 
   template <typename ToType>
@@ -654,8 +541,9 @@ private:
 
     String decompressed;
 
-    QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
+    QByteArray bazip;
+    bazip.resize((int) (in.size() / 4 * 3 + 3));
+    bazip.resize((int) decodeBytes_(in.c_str(), in.size(), reinterpret_cast<Byte *>(bazip.data()), bazip.size()));
     QByteArray czip;
     czip.resize(4);
     czip[0] = (bazip.size() & 0xff000000) >> 24;
@@ -765,131 +653,20 @@ private:
       return;
     }
 
-    Size src_size = in.size();
-    // last one or two '=' are skipped if contained
-    int padding = 0;
-    if (in[src_size - 1] == '=') padding++;
-    if (in[src_size - 2] == '=') padding++;
-
-    src_size -= padding;
-
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
-    const Size element_size = sizeof(ToType);
-
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
-
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
+    if constexpr (std::is_integral<ToType>::value && (sizeof(ToType) == 4 || sizeof(ToType) == 8))
     {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
+      decodeRaw_(in, from_byte_order, out);
     }
     else
     {
-      offset = 0;
-      inc = 1;
-    }
-
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
-    {
-
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
+      typedef typename std::conditional<sizeof(ToType) == 4, Int32, Int64>::type IntType;
+      std::vector<IntType> tmp;
+      decodeRaw_(in, from_byte_order, tmp);
+      out.resize(tmp.size());
+      // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
+      for (Size i = 0; i < tmp.size(); ++i)
       {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
+        out[i] = (ToType) tmp[i];
       }
     }
   }
@@ -0,0 +1,123 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+namespace OpenMS
+{
+
+  /**
+    @brief File adapter for the columnar, chunk-compressed colMass format
+
+    The colMass format stores the peaks of groups of spectra (same MS level
+    and isolation window) column-wise in zlib compressed chunks, each
+    covering a block of consecutive spectra and a contiguous m/z range. An
+    index of the RT and m/z ranges of all chunks allows loading the peaks in
+    a given RT and m/z range (e.g. an extraction window) without
+    decompressing the complete file, see loadArea() and
+    Internal::ColMassHandler for the details of the format.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI ColMassFile :
+    public ProgressLogger
+  {
+public:
+
+  /**
+    @brief Configuration class for ColMassFile
+
+    Contains the parameters used for writing colMass files
+  */
+    struct OPENMS_DLLAPI ColMassConfig
+    {
+      Size peaks_per_chunk{4096}; ///< number of peaks per column chunk
+      Size spectra_per_block{32}; ///< maximal number of consecutive spectra per block
+      int compression_level{1}; ///< zlib compression level (0 to 9)
+    };
+
+    typedef MSExperiment MapType;
+
+    /** @name Constructors and Destructor
+    */
+    //@{
+    /// Default constructor
+    ColMassFile();
+
+    /// Default destructor
+    ~ColMassFile() override;
+    //@}
+
+    /**
+      @brief Loads a complete map from a colMass file
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid colMass file
+    */
+    void load(const String& filename, MapType& map) const;
+
+    /**
+      @brief Loads the peaks in an RT and m/z range of all spectra of one MS level
+
+      Only spectra with @p min_rt <= RT <= @p max_rt are loaded and only their
+      peaks with @p min_mz <= m/z <= @p max_mz (spectra without such peaks are
+      loaded empty). Spectra only carry RT, MS level, peaks and ion mobility
+      data, the meta data of the file is not loaded.
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid colMass file
+    */
+    void loadArea(const String& filename, double min_rt, double max_rt, double min_mz, double max_mz, UInt ms_level, MapType& map) const;
+
+    /**
+      @brief Stores a map in a colMass file
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be created
+    */
+    void store(const String& filename, const MapType& map) const;
+
+    /// Set the parameters used for writing
+    void setConfig(const ColMassConfig& config);
+
+    /// Get the parameters used for writing
+    const ColMassConfig& getConfig() const;
+
+protected:
+    ColMassConfig config_;
+  };
+}
+
@@ -0,0 +1,111 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief In-memory protein database that stores all FASTA entries in a single character arena
+
+    Reading a FASTA file with FASTAFile::readNext() parses it character by
+    character and allocates three strings per entry. For large databases
+    this takes a noticeable amount of time. This class memory-maps the
+    file, finds the record boundaries in parallel and parses all records
+    in parallel into a single character buffer (the arena). Identifiers,
+    descriptions and sequences are then accessed as views into the arena
+    without further allocations.
+
+    Parsing follows the rules of FASTAFile: PEFF header lines (starting
+    with '#') at the beginning of the file are skipped, the identifier
+    ends at the first whitespace of the header line, tabs and carriage
+    returns are removed from descriptions, and whitespace is removed from
+    sequences. Records with an empty identifier or an empty sequence are
+    reported as errors.
+
+    The arena requires about as much memory as the FASTA file. Use
+    FASTAContainer<TFI_Arena> to pass it to algorithms that read FASTA
+    entries chunk-wise (e.g. PeptideIndexing).
+  */
+  class OPENMS_DLLAPI FASTAArena
+  {
+  public:
+    /// Default constructor (empty database)
+    FASTAArena() = default;
+
+    /**
+      @brief Loads all entries of the FASTA file @p filename
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::FileNotReadable is thrown if the file cannot be read
+      @exception Exception::ParseError is thrown if a record is invalid (or the file contains no records)
+    */
+    void load(const String& filename);
+
+    /// Number of entries
+    Size size() const;
+
+    /// Are there no entries?
+    bool empty() const;
+
+    /// Identifier of entry @p index
+    StringView getIdentifier(Size index) const;
+
+    /// Description of entry @p index
+    StringView getDescription(Size index) const;
+
+    /// Sequence of entry @p index
+    StringView getSequence(Size index) const;
+
+    /// Copies entry @p index to @p entry
+    void getEntry(Size index, FASTAFile::FASTAEntry& entry) const;
+
+    /// Copies the entries [@p first, @p last) to @p entries (in parallel)
+    void getEntries(Size first, Size last, std::vector<FASTAFile::FASTAEntry>& entries) const;
+
+  protected:
+    /// characters of all identifiers, descriptions and sequences
+    std::vector<char> arena_;
+
+    /// start of the identifier, description and sequence and end of the sequence of each entry in the arena (4 values per entry)
+    std::vector<UInt64> bounds_;
+  };
+
+} // namespace OpenMS
@@ -168,6 +168,7 @@ namespace OpenMS
         /**
           @brief loads a FASTA file given by 'filename' and stores the information in 'data'
           This uses more RAM than readStart() and readNext().
+          The file is parsed in parallel (see FASTAArena).
           @exception Exception::FileNotFound is thrown if the file does not exists.
           @exception Exception::ParseError is thrown if the file does not suit to the standard.
         */
@@ -116,6 +116,8 @@ namespace OpenMS
       XML,                ///< any XML format
       BZ2,                ///< any BZ2 compressed file
       GZ,                 ///< any Gzipped file
+      COLMASS,            ///< Columnar chunk-compressed format for mass spectra and chromatograms, see ColMassFile
+      TLIB,               ///< OpenSWATH memory-mappable binary transition library, see MappedTransitionLibrary
       SIZE_OF_TYPE        ///< No file type. Simply stores the number of types
     };
 
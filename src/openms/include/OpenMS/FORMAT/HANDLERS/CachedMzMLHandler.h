@@ -47,6 +47,8 @@
 #include <fstream>
 
 #define CACHED_MZML_FILE_IDENTIFIER 8094
+#define CACHED_MZML_FILE_IDENTIFIER_VERSIONED 8095
+#define CACHED_MZML_FILE_VERSION 2
 
 namespace OpenMS
 {
@@ -62,6 +64,17 @@ namespace Internal
     be very fast and done in random order (once the in-memory index is built
     for the file).
 
+    All values are stored in native byte order. Files of version 1 only start
+    with the magic number CACHED_MZML_FILE_IDENTIFIER. Files of version 2 and
+    later start with a 16 byte header (CACHED_MZML_FILE_IDENTIFIER_VERSIONED,
+    the format version, a byte order mark and a reserved field) and insert
+    zero bytes before each record and after each data array name such that
+    all data arrays start at an 8 byte boundary of the file. This allows
+    mapping the file into memory and accessing the data arrays in place (see
+    MappedCachedMzML). The layout of the records themselves is identical in
+    both versions, so that the functions reading a single spectrum or
+    chromatogram from a positioned stream work for both versions.
+
   */
   class OPENMS_DLLAPI CachedMzMLHandler :
     public ProgressLogger
@@ -121,6 +134,46 @@ public:
 
     /// Access to a constant copy of the binary chromatogram index
     const std::vector<std::streampos>& getChromatogramIndex() const;
+
+    /// Format version of the file the index was created from (see createMemdumpIndex())
+    UInt32 getFileVersion() const;
+    //@}
+
+    /** @name Versioned file header
+    */
+    //@{
+    /**
+      @brief Parses the file header from a buffer holding (at least) the first bytes of a cached file
+
+      @param data Start of the file content
+      @param size Number of valid bytes at @p data
+      @param filename Name of the file (used for error messages)
+
+      @return The format version of the file (1 for files without versioned header)
+
+      @throws Exception::ParseError is thrown if the data is not a cached mzML file, was written by a
+      newer version or on a machine with a different byte order
+    */
+    static UInt32 parseHeader(const char* data, Size size, const String& filename);
+
+    /**
+      @brief Reads the file header from the start of @p ifs (see parseHeader())
+
+      The stream is left positioned at the first record.
+    */
+    static UInt32 readHeader(std::ifstream& ifs, const String& filename);
+
+    /// Writes the file header of the current format version to @p ofs
+    static void writeHeader(std::ofstream& ofs);
+
+    /// Size of the file header in bytes for format version @p version
+    static Size getHeaderSize(UInt32 version);
+
+    /// Number of padding bytes preceding a spectrum record which would otherwise start at @p pos
+    static Size getSpectrumPadding(Size pos, UInt32 version);
+
+    /// Number of padding bytes preceding a chromatogram record which would otherwise start at @p pos
+    static Size getChromatogramPadding(Size pos, UInt32 version);
     //@}
 
     /** @name Direct access to a single Spectrum or Chromatogram
@@ -213,6 +266,12 @@ protected:
     /// write a single chromatogram to filestream
     void writeChromatogram_(const ChromatogramType& chromatogram, std::ofstream& ofs) const;
 
+    /// write the name of a data array (padded for alignment) to filestream
+    static void writeDataArrayName_(const String& name, std::ofstream& ofs);
+
+    /// write @p count zero bytes to filestream
+    static void writePadding_(Size count, std::ofstream& ofs);
+
     /// helper method for fast reading of spectra and chromatograms
     static inline void readDataFast_(std::ifstream& ifs, std::vector<OpenSwath::BinaryDataArrayPtr>& data, const Size& data_size, 
       const Size& nr_float_arrays);
@@ -220,6 +279,7 @@ protected:
     /// Members
     std::vector<std::streampos> spectra_index_;
     std::vector<std::streampos> chrom_index_;
+    UInt32 file_version_;
 
   };
 }
@@ -0,0 +1,309 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/DataStructures.h>
+
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+
+namespace Internal
+{
+
+  /**
+    @brief Reads and writes spectra and chromatograms in the columnar, chunk-compressed colMass format
+
+    Spectra are grouped by MS level and precursor isolation window (e.g. all
+    MS1 spectra, or all spectra of one SWATH window). Consecutive spectra of
+    a group are combined into blocks of (at most) spectra_per_block spectra
+    and the peaks of a block are split into column chunks by m/z, such that
+    each chunk holds (about) peaks_per_chunk peaks of a contiguous m/z range
+    across all spectra of the block. A chunk stores the columns m/z,
+    intensity and (if present) ion mobility separately, ordered by spectrum
+    and m/z. The m/z column is delta encoded and all columns are
+    byte-shuffled before the chunk is compressed with zlib; the codec is
+    lossless.
+
+    An index at the end of the file stores the RT range of every block and
+    the m/z range and maximal intensity of every chunk. Queries for the peaks
+    in an RT and m/z range (see getArea()) only decompress the chunks which
+    overlap the requested range. The file is accessed through a read-only
+    memory mapping and all const member functions are thread-safe.
+
+    The meta data of the experiment (spectrum and chromatogram settings
+    without data) is stored as zlib compressed mzML. Float data arrays other
+    than the ion mobility array as well as integer and string data arrays are
+    not stored.
+
+    @note All values are stored in native byte order, a byte order mark in the
+    header prevents reading files written on machines with a different byte
+    order.
+  */
+  class OPENMS_DLLAPI ColMassHandler :
+    public ProgressLogger
+  {
+public:
+
+    /// A series of spectra with the same MS level and precursor isolation window (e.g. the spectra of one SWATH window)
+    struct SpectrumGroup
+    {
+      Int32 ms_level = 0; ///< MS level of the spectra
+      double isolation_lower = 0.0; ///< lower end of the precursor isolation window (absolute m/z, 0 for spectra without precursor)
+      double isolation_upper = 0.0; ///< upper end of the precursor isolation window (absolute m/z, 0 for spectra without precursor)
+      UInt32 first_block = 0; ///< index of the first block of the group
+      UInt32 nr_blocks = 0; ///< number of blocks of the group
+    };
+
+    /** @name Constructors and Destructor
+    */
+    //@{
+    /// Default constructor
+    ColMassHandler();
+
+    /// Default destructor
+    ~ColMassHandler() override;
+    //@}
+
+    /**
+      @brief Set the parameters used for writing
+
+      @param peaks_per_chunk Number of peaks per column chunk (the chunks of a block may hold slightly more or less peaks)
+      @param spectra_per_block Maximal number of spectra per block
+      @param compression_level zlib compression level (from 0 for no compression over 1 for fastest to 9 for smallest files)
+    */
+    void setConfig(Size peaks_per_chunk, Size spectra_per_block, int compression_level);
+
+    /** @name Writing
+    */
+    //@{
+    /**
+      @brief Write a complete experiment to disk
+
+      Peaks of spectra which are not sorted by m/z are stored sorted by m/z.
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void writeExperiment(const String& filename, const MSExperiment& exp) const;
+    //@}
+
+    /** @name Reading
+    */
+    //@{
+    /**
+      @brief Open a file and read its index
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::FileNotReadable is thrown if the file cannot be mapped into memory
+      @exception Exception::ParseError is thrown if the file is not a valid colMass file
+    */
+    void open(const String& filename);
+
+    /// Whether a file is open
+    bool isOpen() const;
+
+    /// Close the file (releases the memory mapping)
+    void close();
+
+    /// Whether @p filename starts with the magic bytes of a colMass file
+    static bool isColMassFile(const String& filename);
+
+    /// Read the meta data of all spectra and chromatograms (without peaks)
+    void readMetaData(MSExperiment& exp) const;
+
+    /// Read the complete experiment (meta data and peaks)
+    void readExperiment(MSExperiment& exp) const;
+
+    /// Number of spectra in the file
+    Size getNrSpectra() const;
+
+    /// Number of chromatograms in the file
+    Size getNrChromatograms() const;
+
+    /// Spectrum groups of the file (see SpectrumGroup)
+    const std::vector<SpectrumGroup>& getSpectrumGroups() const;
+
+    /// Index of the spectrum group containing spectrum @p index
+    Size getSpectrumGroupIndex(Size index) const;
+
+    /// Retention time of spectrum @p index
+    double getSpectrumRT(Size index) const;
+
+    /// Number of peaks of spectrum @p index
+    Size getSpectrumSize(Size index) const;
+
+    /**
+      @brief Read the peaks (and ion mobility array) of spectrum @p index
+
+      Only the peaks, the RT, the MS level and the ion mobility array of @p spectrum are set.
+
+      @exception Exception::IndexOverflow is thrown if @p index is out of range
+    */
+    void getSpectrum(Size index, MSSpectrum& spectrum) const;
+
+    /**
+      @brief Read the peaks of chromatogram @p index
+
+      Only the peaks of @p chromatogram are set.
+
+      @exception Exception::IndexOverflow is thrown if @p index is out of range
+    */
+    void getChromatogram(Size index, MSChromatogram& chromatogram) const;
+
+    /**
+      @brief Read all peaks of a spectrum group within an RT range and a set of m/z ranges
+
+      For each spectrum of @p group with @p min_rt <= RT <= @p max_rt, one
+      spectrum holding all peaks within any of the (closed) m/z ranges is
+      appended to @p spectra (with an "Ion Mobility" array if the spectra
+      contain ion mobility data) and its meta data (index, RT and MS level) to
+      @p spectra_meta. Spectra without peaks in the m/z ranges are reported as
+      well. Only the chunks overlapping the requested ranges are decompressed.
+
+      @param group Index of the spectrum group (see getSpectrumGroups())
+      @param min_rt Lower end of the RT range
+      @param max_rt Upper end of the RT range
+      @param mz_ranges m/z ranges (may be unsorted and overlapping)
+      @param spectra Output spectra (sorted by index)
+      @param spectra_meta Output spectrum meta data (same order as @p spectra)
+
+      @exception Exception::IndexOverflow is thrown if @p group is out of range
+    */
+    void getArea(Size group, double min_rt, double max_rt, const std::vector<std::pair<double, double> >& mz_ranges,
+                 std::vector<OpenSwath::SpectrumPtr>& spectra, std::vector<OpenSwath::SpectrumMeta>& spectra_meta) const;
+
+    /**
+      @brief Read all peaks within an RT and m/z range (see MSExperiment::areaBeginConst())
+
+      For each spectrum of MS level @p ms_level with @p min_rt <= RT <= @p
+      max_rt, a spectrum with the peaks in the (closed) m/z range is added to
+      @p exp. Only RT, MS level, peaks and ion mobility array of the spectra
+      are set.
+    */
+    void getArea(double min_rt, double max_rt, double min_mz, double max_mz, UInt ms_level, MSExperiment& exp) const;
+    //@}
+
+protected:
+
+    /// A block of spectra of one spectrum group
+    struct Block_
+    {
+      UInt32 group = 0;
+      double rt_min = 0.0;
+      double rt_max = 0.0;
+      double mz_min = 0.0;
+      double mz_max = 0.0;
+      UInt32 first_member = 0; ///< index of the first spectrum of the block in block_members_
+      UInt32 nr_members = 0;
+      UInt32 first_chunk = 0;
+      UInt32 nr_chunks = 0;
+      UInt32 has_im = 0;
+    };
+
+    /// A column chunk of a block
+    struct Chunk_
+    {
+      UInt64 offset = 0; ///< file offset of the compressed data
+      UInt64 size = 0; ///< size of the compressed data in bytes
+      UInt32 nr_peaks = 0;
+      double mz_min = 0.0;
+      double mz_max = 0.0;
+      float intensity_max = 0.0f;
+    };
+
+    /// Position of a spectrum in the file
+    struct SpectrumEntry_
+    {
+      double rt = 0.0;
+      UInt32 block = 0;
+      UInt32 position = 0; ///< position of the spectrum within its block
+      UInt32 nr_peaks = 0;
+      Int32 im_name = -1; ///< index of the name of the ion mobility array in im_names_ (-1 if there is none)
+    };
+
+    /// Position of a chromatogram in the file
+    struct ChromatogramEntry_
+    {
+      UInt64 offset = 0;
+      UInt64 size = 0;
+      UInt32 nr_peaks = 0;
+    };
+
+    /// Decompressed columns of a chunk
+    struct ChunkData_
+    {
+      std::vector<UInt32> counts; ///< number of peaks of each spectrum of the block
+      std::vector<double> mz;
+      std::vector<float> intensity;
+      std::vector<float> im;
+    };
+
+    /// Decompress a chunk of block @p block
+    void decodeChunk_(const Block_& block, const Chunk_& chunk, ChunkData_& data) const;
+
+    /// Remove peaks and data arrays of @p spectrum and set RT, MS level and the (empty) ion mobility array of spectrum @p index
+    void prepareSpectrum_(Size index, MSSpectrum& spectrum) const;
+
+    /// Append @p count peaks of @p data starting at @p start to @p spectrum (and its ion mobility array, if any)
+    static void appendPeaks_(const ChunkData_& data, Size start, Size count, MSSpectrum& spectrum);
+
+    /// Throws a ParseError for the open file
+    void throwParseError_(const String& message) const;
+
+    Size peaks_per_chunk_;
+    Size spectra_per_block_;
+    int compression_level_;
+
+    MemoryMappedFile file_;
+    UInt64 meta_offset_;
+    UInt64 meta_size_;
+    std::vector<SpectrumGroup> groups_;
+    std::vector<Block_> blocks_;
+    std::vector<UInt32> block_members_;
+    std::vector<Chunk_> chunks_;
+    std::vector<SpectrumEntry_> spectra_;
+    std::vector<ChromatogramEntry_> chromatograms_;
+    std::vector<String> im_names_;
+  };
+
+} // namespace Internal
+} // namespace OpenMS
+
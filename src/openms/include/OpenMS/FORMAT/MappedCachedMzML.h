@@ -0,0 +1,263 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/DataStructures.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Read-only access to a cached mzML file through a memory mapping
+
+    Provides the same data as CachedmzML, but instead of reading each spectrum
+    and chromatogram through a file stream, the cached file is mapped into
+    memory once. Spectra and chromatograms can then be accessed as views
+    pointing directly into the mapped file (getSpectrumView(),
+    getChromatogramView()), which requires neither system calls nor memory
+    allocations. Pages of the file are loaded on demand by the operating
+    system.
+
+    The cached file is validated completely when it is loaded, so all views
+    handed out afterwards are guaranteed to lie within the mapped file. All
+    data (mapping, index and meta data) is shared between copies of an object
+    and all member functions are const, so a single object can be used from
+    multiple threads concurrently. Views remain valid as long as any copy of
+    the object exists.
+
+    Views can only be provided for files of version 2 and later (see
+    CachedMzMLHandler), where all data arrays are aligned. Files written by
+    earlier versions can still be read through the copying accessors
+    (getSpectrum(), getChromatogram(), getSpectrumData(),
+    getChromatogramData()); providesViews() reports whether views are
+    available.
+  */
+  class OPENMS_DLLAPI MappedCachedMzML
+  {
+
+public:
+
+    /**
+      @brief A read-only, non-owning view on a contiguous array of doubles
+
+      Similar to a (const) std::span, the view only holds a pointer and a size.
+    */
+    class DataArrayView
+    {
+public:
+      typedef const double* const_iterator;
+
+      DataArrayView() = default;
+
+      DataArrayView(const double* data, Size size) :
+        data_(data),
+        size_(size)
+      {
+      }
+
+      const double* data() const
+      {
+        return data_;
+      }
+
+      Size size() const
+      {
+        return size_;
+      }
+
+      bool empty() const
+      {
+        return size_ == 0;
+      }
+
+      const double& operator[](Size i) const
+      {
+        OPENMS_PRECONDITION(i < size_, "Index out of range")
+        return data_[i];
+      }
+
+      const_iterator begin() const
+      {
+        return data_;
+      }
+
+      const_iterator end() const
+      {
+        return data_ + size_;
+      }
+
+private:
+      const double* data_ = nullptr;
+      Size size_ = 0;
+    };
+
+    /// A view on an additional (named) data array of a spectrum or chromatogram
+    struct NamedDataArrayView
+    {
+      std::string_view name;
+      DataArrayView data;
+    };
+
+    /// A view on the data of a single spectrum
+    struct SpectrumView
+    {
+      int ms_level = 0;
+      double rt = -1.0;
+      DataArrayView mz;
+      DataArrayView intensity;
+      /// Float and integer data arrays (only allocated if present)
+      std::vector<NamedDataArrayView> extra_arrays;
+    };
+
+    /// A view on the data of a single chromatogram
+    struct ChromatogramView
+    {
+      DataArrayView rt;
+      DataArrayView intensity;
+      /// Float and integer data arrays (only allocated if present)
+      std::vector<NamedDataArrayView> extra_arrays;
+    };
+
+    /** @name Constructors and Destructor
+    */
+    //@{
+    /// Default constructor
+    MappedCachedMzML();
+
+    /**
+      @brief Constructor, maps the cached file and loads the meta data
+
+      @param filename The filename of the .mzML file (it is assumed a second
+      file .mzML.cached exists).
+
+      @throws Exception::FileNotFound is thrown if a file is not found
+      @throws Exception::ParseError is thrown if a file cannot be parsed
+    */
+    explicit MappedCachedMzML(const String& filename);
+
+    /// Copy constructor (shares the mapping, index and meta data)
+    MappedCachedMzML(const MappedCachedMzML& rhs);
+
+    /// Assignment operator (shares the mapping, index and meta data)
+    MappedCachedMzML& operator=(const MappedCachedMzML& rhs);
+
+    /// Destructor
+    virtual ~MappedCachedMzML();
+    //@}
+
+    /**
+      @brief Loads a cached mzML file
+
+      @p filename The data location (ends in .mzML, expects an adjacent .mzML.cached file)
+      @p map The result object
+
+      @exception Exception::FileNotFound is thrown if a file could not be opened
+      @exception Exception::ParseError is thrown if an error occurs during parsing
+    */
+    static void load(const String& filename, MappedCachedMzML& map);
+
+    size_t getNrSpectra() const;
+
+    size_t getNrChromatograms() const;
+
+    const MSExperiment& getMetaData() const;
+
+    /// Format version of the cached file (see CachedMzMLHandler)
+    UInt32 getFileVersion() const;
+
+    /// Whether views on the data can be provided (i.e. whether the file has aligned data arrays)
+    bool providesViews() const;
+
+    /**
+      @brief Zero-copy access to the data of spectrum @p id
+
+      The views point into the mapped file; memory is only allocated for the
+      list of additional data arrays (if the spectrum has any).
+
+      @throws Exception::IllegalArgument is thrown if the file does not provide views (see providesViews())
+    */
+    SpectrumView getSpectrumView(Size id) const;
+
+    /**
+      @brief Zero-copy access to the data of chromatogram @p id
+
+      @throws Exception::IllegalArgument is thrown if the file does not provide views (see providesViews())
+    */
+    ChromatogramView getChromatogramView(Size id) const;
+
+    /// Copy of spectrum @p id including its meta data
+    MSSpectrum getSpectrum(Size id) const;
+
+    /// Copy of chromatogram @p id including its meta data
+    MSChromatogram getChromatogram(Size id) const;
+
+    /// Copy of the data arrays of spectrum @p id (m/z, intensity and additional arrays)
+    std::vector<OpenSwath::BinaryDataArrayPtr> getSpectrumData(Size id) const;
+
+    /// Copy of the data arrays of chromatogram @p id (RT, intensity and additional arrays)
+    std::vector<OpenSwath::BinaryDataArrayPtr> getChromatogramData(Size id) const;
+
+protected:
+
+    /// Data shared between all copies
+    struct SharedData_
+    {
+      MemoryMappedFile file;
+      MSExperiment meta_ms_experiment;
+      UInt32 version = 0;
+      std::vector<Size> spectra_index;
+      std::vector<Size> chrom_index;
+    };
+
+    void load_(const String& filename);
+
+    /// Throws if no views are available
+    void checkViews_() const;
+
+    /// Shared data
+    std::shared_ptr<const SharedData_> data_;
+
+    /// Name of the mzML file
+    String filename_;
+
+    /// Name of the cached mzML file
+    String filename_cached_;
+  };
+}
@@ -43,6 +43,7 @@
 #include <OpenMS/DATASTRUCTURES/ListUtils.h> // StringList
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 
+#include <fstream>
 #include <map>
 
 namespace OpenMS
@@ -159,6 +160,36 @@ public:
     */
     void transform(const String& filename_in, Interfaces::IMSDataConsumer * consumer, PeakMap& map, bool skip_full_count = false, bool skip_first_pass = false);
 
+    /**
+      @brief Transforms a map while loading using the supplied MSDataConsumer, parsing the file on multiple threads.
+
+      For indexed mzML files, the offsets stored in the \<indexList\> are used
+      to split the spectrum and chromatogram lists into byte ranges of
+      getOptions().getMaxDataPoolSize() elements each. Every range is wrapped
+      into a minimal mzML document (sharing the header of the input file) and
+      tokenized and decoded by its own parser, so XML parsing, base64
+      decoding, zlib and numpress decompression of different ranges run
+      concurrently. At most two ranges per thread are held in memory at any
+      time and the decoded spectra and chromatograms are handed to the
+      consumer in file order. The expected number of spectra and chromatograms
+      is taken from the index and the meta-data from the file header, so no
+      serial pass through the file precedes the parallel parsing.
+
+      If the input is not an indexed mzML file (or its index cannot be used,
+      e.g. for compressed files), this function falls back to transform().
+
+      @note The consumer is only ever called from a single thread.
+
+      @param filename_in Filename of input mzML file to transform
+      @param consumer Consumer class to operate on the input filename (implementing a transformation)
+      @param skip_full_count Whether to skip computing the correct number of spectra and chromatograms in the input file (only used by the fallback to transform())
+      @param skip_first_pass Whether to skip handing the meta-data to the consumer before consuming any data
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if an error occurs during parsing
+    */
+    void transformParallel(const String& filename_in, Interfaces::IMSDataConsumer * consumer, bool skip_full_count = false, bool skip_first_pass = false);
+
     /**
       @brief Checks if a file validates against the XML schema.
 
@@ -212,6 +243,31 @@ protected:
     /// Safe parse that catches exceptions and handles them accordingly
     void safeParse_(const String & filename, Internal::XMLHandler * handler);
 
+    /**
+      @brief Parse all spectra (or chromatograms) of one list of an indexed mzML file in parallel and hand them to the consumer
+
+      @param ifs Open input stream of the file
+      @param filename Name of the file (used for error messages)
+      @param offsets Start offsets of all elements of the list (in file order)
+      @param list_end Offset where the data of the last element ends at the latest
+      @param header Raw XML of the file preceding the first list
+      @param footer Raw XML closing the document after the list
+      @param list_tag Raw XML start tag of the list (e.g. \<spectrumList count="..." ...\>)
+      @param is_spectrum Whether the list is a spectrum list (otherwise a chromatogram list)
+      @param consumer The consumer for the decoded data
+      @param progress Progress counter (updated after each batch)
+    */
+    void transformListParallel_(std::ifstream& ifs,
+                                const String& filename,
+                                const std::vector<std::streampos>& offsets,
+                                std::streampos list_end,
+                                const std::string& header,
+                                const std::string& footer,
+                                const std::string& list_tag,
+                                bool is_spectrum,
+                                Interfaces::IMSDataConsumer* consumer,
+                                SignedSize& progress);
+
 private:
 
     /// Options for loading / storing
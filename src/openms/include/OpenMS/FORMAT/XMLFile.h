@@ -87,9 +87,21 @@ protected:
 
         @note Currently the buffer needs to be plain text, gzip buffer is not supported.
 
+        @param buffer The XML document
+        @param handler The handler for the document
+        @param initialize_parser Whether to initialize the Xerces platform. Initialization is not thread-safe, so callers
+               parsing several buffers concurrently call initializeParser_() once beforehand and pass false.
+
         @exception Exception::ParseError is thrown if an error occurred during the parsing
       */
-      void parseBuffer_(const std::string & buffer, XMLHandler * handler);
+      void parseBuffer_(const std::string & buffer, XMLHandler * handler, bool initialize_parser = true);
+
+      /**
+        @brief Initializes the Xerces platform (see parseBuffer_)
+
+        @exception Exception::ParseError is thrown if the initialization fails
+      */
+      static void initializeParser_();
 
       /**
         @brief Stores the contents of the XML handler given by @p handler in the file given by @p filename.
@@ -94,6 +94,33 @@ public:
     */
     static void uncompressString(const QByteArray& compressed_data, QByteArray& raw_data);
 
+    /**
+      * @brief Compresses data using zlib directly with a given compression level
+      *
+      * @param raw_data Data to be compressed
+      * @param nr_bytes Number of bytes in @p raw_data
+      * @param compressed_data Compressed result data
+      * @param level zlib compression level, from 0 (no compression) over 1 (fastest) to 9 (smallest result)
+      * 
+    */
+    static void compressData(const void * raw_data, size_t nr_bytes, std::string& compressed_data, int level);
+
+    /**
+      * @brief Uncompresses data using zlib directly into a buffer of known size
+      *
+      * No intermediate copies are made, which makes this considerably faster than
+      * uncompressString() if the size of the uncompressed data is known (e.g.
+      * because it was stored alongside the compressed data).
+      *
+      * @param compressed_data Compressed data (as created by compressData() or compressString(std::string&, std::string&))
+      * @param nr_bytes Number of bytes in compressed data
+      * @param raw_data Buffer for the uncompressed result data (at least @p raw_size bytes)
+      * @param raw_size Number of bytes of the uncompressed data
+      *
+      * @exception Exception::ConversionError is thrown if the data cannot be uncompressed into exactly @p raw_size bytes
+    */
+    static void uncompressData(const void * compressed_data, size_t nr_bytes, void * raw_data, size_t raw_size);
+
   };
 
 } // namespace OpenMS
@@ -24,6 +24,7 @@ Bzip2Ifstream.h
 Bzip2InputStream.h
 CachedMzML.h
 ChromeleonFile.h
+ColMassFile.h
 CompressedInputSource.h
 CVMappingFile.h
 ConsensusXMLFile.h
@@ -33,6 +34,7 @@ DTA2DFile.h
 DTAFile.h
 EDTAFile.h
 ExperimentalDesignFile.h
+FASTAArena.h
 FASTAFile.h
 FeatureXMLFile.h
 FileHandler.h
@@ -52,6 +54,7 @@ KroenikFile.h
 LibSVMEncoder.h
 MRMFeaturePickerFile.h
 MRMFeatureQCFile.h
+MappedCachedMzML.h
 MS2File.h
 MSNumpressCoder.h
 MSPFile.h
@@ -0,0 +1,651 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <iterator>
+#include <vector>
+
+namespace OpenMS
+{
+  enum class DriftTimeUnit;
+
+  /**
+    @brief A spectrum which stores its peaks as a structure of arrays.
+
+    Instead of a vector of Peak1D (which needs 16 bytes per peak due to
+    padding), the m/z and intensity values are kept in two contiguous
+    columns. This reduces the memory footprint to 12 bytes per peak and
+    allows binary searches and range scans to run over tightly packed
+    arrays, which the compiler can vectorize.
+
+    Optionally, the m/z column can be stored as single precision offsets
+    relative to a common double precision base value
+    (MZStorage::FLOAT_OFFSET), which reduces the footprint to 8 bytes per
+    peak. The base value is the center of the m/z range, so the absolute
+    error is bounded by half the m/z range times the float precision (about
+    0.06 ppm at m/z 2000 for a spectrum spanning 4000 Th).
+
+    For reading, the class provides the same interface as MSSpectrum: the
+    peaks can be accessed through operator[] and random access iterators,
+    which yield Peak1D objects by value. Therefore, templated algorithms
+    which only read peaks (e.g. SignalToNoiseEstimatorMedian,
+    ChromatogramExtractor::extract_value_tophat) can be used unchanged and
+    dedicated overloads exist for PeakPickerHiRes and HyperScore. Peaks can
+    not be modified through references; use setMZ() and setIntensity()
+    instead.
+
+    Meta data (SpectrumSettings, RT, MS level, drift time and the data
+    arrays) is kept as in MSSpectrum, so conversion from and to MSSpectrum is
+    lossless unless FLOAT_OFFSET storage is used.
+
+    @ingroup Kernel
+  */
+  class OPENMS_DLLAPI ColumnarSpectrum :
+    public SpectrumSettings
+  {
+public:
+
+    ///@name Base type definitions
+    //@{
+    /// Peak type
+    typedef OpenMS::Peak1D PeakType;
+    /// Coordinate (m/z) type
+    typedef PeakType::CoordinateType CoordinateType;
+    /// Intensity type
+    typedef PeakType::IntensityType IntensityType;
+
+    typedef MSSpectrum::FloatDataArray FloatDataArray;
+    typedef MSSpectrum::FloatDataArrays FloatDataArrays;
+    typedef MSSpectrum::StringDataArray StringDataArray;
+    typedef MSSpectrum::StringDataArrays StringDataArrays;
+    typedef MSSpectrum::IntegerDataArray IntegerDataArray;
+    typedef MSSpectrum::IntegerDataArrays IntegerDataArrays;
+    //@}
+
+    /// Storage mode of the m/z column
+    enum class MZStorage
+    {
+      DOUBLE,      ///< m/z values are stored in double precision
+      FLOAT_OFFSET ///< m/z values are stored as single precision offsets to a double precision base value
+    };
+
+    /**
+      @brief Random access iterator over the peaks of a ColumnarSpectrum
+
+      Dereferencing yields a Peak1D by value, assembled from the columns.
+    */
+    class ConstIterator
+    {
+public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef PeakType value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef PeakType reference;
+
+      /// Holds a peak by value to support operator->
+      struct PeakPointer
+      {
+        PeakType peak;
+        const PeakType* operator->() const
+        {
+          return &peak;
+        }
+      };
+      typedef PeakPointer pointer;
+
+      ConstIterator() = default;
+
+      ConstIterator(const ColumnarSpectrum* spectrum, Size pos) :
+        spectrum_(spectrum),
+        pos_(pos)
+      {
+      }
+
+      reference operator*() const
+      {
+        return (*spectrum_)[pos_];
+      }
+
+      pointer operator->() const
+      {
+        return PeakPointer{(*spectrum_)[pos_]};
+      }
+
+      reference operator[](difference_type n) const
+      {
+        return (*spectrum_)[pos_ + n];
+      }
+
+      ConstIterator& operator++()
+      {
+        ++pos_;
+        return *this;
+      }
+
+      ConstIterator operator++(int)
+      {
+        ConstIterator tmp(*this);
+        ++pos_;
+        return tmp;
+      }
+
+      ConstIterator& operator--()
+      {
+        --pos_;
+        return *this;
+      }
+
+      ConstIterator operator--(int)
+      {
+        ConstIterator tmp(*this);
+        --pos_;
+        return tmp;
+      }
+
+      ConstIterator& operator+=(difference_type n)
+      {
+        pos_ += n;
+        return *this;
+      }
+
+      ConstIterator& operator-=(difference_type n)
+      {
+        pos_ -= n;
+        return *this;
+      }
+
+      ConstIterator operator+(difference_type n) const
+      {
+        return ConstIterator(spectrum_, pos_ + n);
+      }
+
+      friend ConstIterator operator+(difference_type n, const ConstIterator& it)
+      {
+        return it + n;
+      }
+
+      ConstIterator operator-(difference_type n) const
+      {
+        return ConstIterator(spectrum_, pos_ - n);
+      }
+
+      difference_type operator-(const ConstIterator& rhs) const
+      {
+        return difference_type(pos_) - difference_type(rhs.pos_);
+      }
+
+      bool operator==(const ConstIterator& rhs) const
+      {
+        return pos_ == rhs.pos_ && spectrum_ == rhs.spectrum_;
+      }
+
+      bool operator!=(const ConstIterator& rhs) const
+      {
+        return !(*this == rhs);
+      }
+
+      bool operator<(const ConstIterator& rhs) const
+      {
+        return pos_ < rhs.pos_;
+      }
+
+      bool operator>(const ConstIterator& rhs) const
+      {
+        return pos_ > rhs.pos_;
+      }
+
+      bool operator<=(const ConstIterator& rhs) const
+      {
+        return pos_ <= rhs.pos_;
+      }
+
+      bool operator>=(const ConstIterator& rhs) const
+      {
+        return pos_ >= rhs.pos_;
+      }
+
+      /// Returns the index of the peak the iterator points to
+      Size getIndex() const
+      {
+        return pos_;
+      }
+
+private:
+      const ColumnarSpectrum* spectrum_ = nullptr;
+      Size pos_ = 0;
+    };
+
+    ///@name STL compliance type definitions
+    //@{
+    typedef ConstIterator const_iterator;
+    typedef PeakType value_type;
+    typedef Size size_type;
+    typedef std::ptrdiff_t difference_type;
+    //@}
+
+    /// Constructor
+    ColumnarSpectrum();
+
+    /**
+      @brief Converting constructor
+
+      Copies peaks and meta data of @p spectrum.
+
+      @param spectrum The spectrum to convert
+      @param mz_storage Storage mode of the m/z column
+    */
+    explicit ColumnarSpectrum(const MSSpectrum& spectrum, MZStorage mz_storage = MZStorage::DOUBLE);
+
+    /// Copy constructor
+    ColumnarSpectrum(const ColumnarSpectrum& source) = default;
+
+    /// Move constructor
+    ColumnarSpectrum(ColumnarSpectrum&&) = default;
+
+    /// Destructor
+    ~ColumnarSpectrum() = default;
+
+    /// Assignment operator
+    ColumnarSpectrum& operator=(const ColumnarSpectrum& source) = default;
+
+    /// Move assignment operator
+    ColumnarSpectrum& operator=(ColumnarSpectrum&&) & = default;
+
+    /// Equality operator (the m/z values are compared, not their storage)
+    bool operator==(const ColumnarSpectrum& rhs) const;
+
+    /// Equality operator
+    bool operator!=(const ColumnarSpectrum& rhs) const
+    {
+      return !(operator==(rhs));
+    }
+
+    /// Converts to an MSSpectrum (including all meta data)
+    MSSpectrum toMSSpectrum() const;
+
+    ///@name Accessors for meta information
+    ///@{
+    /// Returns the absolute retention time (in seconds)
+    double getRT() const;
+
+    /// Sets the absolute retention time (in seconds)
+    void setRT(double rt);
+
+    /// Returns the ion mobility drift time (IMTypes::DRIFTTIME_NOT_SET means it is not set)
+    double getDriftTime() const;
+
+    /// Sets the ion mobility drift time
+    void setDriftTime(double dt);
+
+    /// Returns the ion mobility drift time unit
+    DriftTimeUnit getDriftTimeUnit() const;
+
+    /// Sets the ion mobility drift time unit
+    void setDriftTimeUnit(DriftTimeUnit dt);
+
+    /// Returns the MS level
+    UInt getMSLevel() const;
+
+    /// Sets the MS level
+    void setMSLevel(UInt ms_level);
+
+    /// Returns the name
+    const String& getName() const;
+
+    /// Sets the name
+    void setName(const String& name);
+    ///@}
+
+    ///@name Peak data array methods (see MSSpectrum)
+    //@{
+    /// Returns a const reference to the float meta data arrays
+    const FloatDataArrays& getFloatDataArrays() const
+    {
+      return float_data_arrays_;
+    }
+
+    /// Returns a mutable reference to the float meta data arrays
+    FloatDataArrays& getFloatDataArrays()
+    {
+      return float_data_arrays_;
+    }
+
+    /// Returns a const reference to the string meta data arrays
+    const StringDataArrays& getStringDataArrays() const
+    {
+      return string_data_arrays_;
+    }
+
+    /// Returns a mutable reference to the string meta data arrays
+    StringDataArrays& getStringDataArrays()
+    {
+      return string_data_arrays_;
+    }
+
+    /// Returns a const reference to the integer meta data arrays
+    const IntegerDataArrays& getIntegerDataArrays() const
+    {
+      return integer_data_arrays_;
+    }
+
+    /// Returns a mutable reference to the integer meta data arrays
+    IntegerDataArrays& getIntegerDataArrays()
+    {
+      return integer_data_arrays_;
+    }
+
+    /// do the names of the float data arrays contain ion mobility data? (see MSSpectrum::containsIMData())
+    bool containsIMData() const;
+
+    /**
+      @brief Get the Ion mobility data array's @p index and its associated @p unit (see MSSpectrum::getIMData())
+
+      @throws Exception::MissingInformation if IM data is not present
+    */
+    std::pair<Size, DriftTimeUnit> getIMData() const;
+    //@}
+
+    ///@name Peak access
+    //@{
+    /// Returns the number of peaks
+    Size size() const
+    {
+      return intensity_.size();
+    }
+
+    /// Returns true if the spectrum contains no peaks
+    bool empty() const
+    {
+      return intensity_.empty();
+    }
+
+    /// Reserves memory for @p n peaks
+    void reserve(Size n);
+
+    /// Appends a peak
+    void push_back(const PeakType& peak)
+    {
+      emplace_back(peak.getMZ(), peak.getIntensity());
+    }
+
+    /// Appends a peak with the given m/z and intensity
+    void emplace_back(CoordinateType mz, IntensityType intensity)
+    {
+      if (mz_storage_ == MZStorage::DOUBLE)
+      {
+        mz_.push_back(mz);
+      }
+      else
+      {
+        mz_float_.push_back(float(mz - mz_offset_));
+      }
+      intensity_.push_back(intensity);
+    }
+
+    /// Returns the m/z of the peak at @p index
+    CoordinateType getMZ(Size index) const
+    {
+      return mz_storage_ == MZStorage::DOUBLE ? mz_[index] : mz_offset_ + mz_float_[index];
+    }
+
+    /// Sets the m/z of the peak at @p index
+    void setMZ(Size index, CoordinateType mz)
+    {
+      if (mz_storage_ == MZStorage::DOUBLE)
+      {
+        mz_[index] = mz;
+      }
+      else
+      {
+        mz_float_[index] = float(mz - mz_offset_);
+      }
+    }
+
+    /// Returns the intensity of the peak at @p index
+    IntensityType getIntensity(Size index) const
+    {
+      return intensity_[index];
+    }
+
+    /// Sets the intensity of the peak at @p index
+    void setIntensity(Size index, IntensityType intensity)
+    {
+      intensity_[index] = intensity;
+    }
+
+    /// Returns the peak at @p index (by value)
+    PeakType operator[](Size index) const
+    {
+      return PeakType(getMZ(index), getIntensity(index));
+    }
+
+    /// Returns an iterator to the first peak
+    ConstIterator begin() const
+    {
+      return ConstIterator(this, 0);
+    }
+
+    /// Returns an iterator past the last peak
+    ConstIterator end() const
+    {
+      return ConstIterator(this, size());
+    }
+
+    /// Returns an iterator to the first peak
+    ConstIterator cbegin() const
+    {
+      return begin();
+    }
+
+    /// Returns an iterator past the last peak
+    ConstIterator cend() const
+    {
+      return end();
+    }
+    //@}
+
+    ///@name Column access
+    //@{
+    /// Returns the storage mode of the m/z column
+    MZStorage getMZStorage() const
+    {
+      return mz_storage_;
+    }
+
+    /// Returns the base value of the m/z offsets (only used in FLOAT_OFFSET mode)
+    double getMZOffset() const
+    {
+      return mz_offset_;
+    }
+
+    /**
+      @brief Changes the storage mode of the m/z column and converts the present peaks
+
+      When switching to FLOAT_OFFSET, the center of the present m/z range is used as base value.
+    */
+    void setMZStorage(MZStorage mz_storage);
+
+    /**
+      @brief Changes the storage mode of the m/z column to FLOAT_OFFSET using the base value @p mz_offset
+
+      Use this overload if peaks are added afterwards and their m/z range is known.
+    */
+    void setMZStorage(MZStorage mz_storage, double mz_offset);
+
+    /// Returns the m/z column (empty unless getMZStorage() is MZStorage::DOUBLE)
+    const std::vector<double>& getMZArray() const
+    {
+      return mz_;
+    }
+
+    /// Returns the m/z offset column (empty unless getMZStorage() is MZStorage::FLOAT_OFFSET)
+    const std::vector<float>& getMZOffsetArray() const
+    {
+      return mz_float_;
+    }
+
+    /// Returns the intensity column
+    const std::vector<float>& getIntensityArray() const
+    {
+      return intensity_;
+    }
+
+    /// Returns the intensity column
+    std::vector<float>& getIntensityArray()
+    {
+      return intensity_;
+    }
+
+    /// Returns the number of bytes used by the peak columns
+    Size getPeakMemoryUsage() const;
+    //@}
+
+    ///@name Sorting peaks
+    //@{
+    /// Sorts the peaks by ascending m/z. Meta data arrays will be sorted accordingly.
+    void sortByPosition();
+
+    /// Checks if all peaks are sorted with respect to ascending m/z
+    bool isSorted() const;
+    //@}
+
+    ///@name Searching a peak or peak range
+    ///@{
+    /**
+      @brief Binary search for the peak nearest to a specific m/z
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+
+      @exception Exception::Precondition is thrown if the spectrum is empty (not only in debug mode)
+    */
+    Size findNearest(CoordinateType mz) const;
+
+    /**
+      @brief Binary search for the peak nearest to a specific m/z given a +/- tolerance windows in Th
+
+      @return Returns the index of the peak or -1 if no peak present in tolerance window or if spectrum is empty
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+      @note Peaks exactly on borders are considered in tolerance window.
+    */
+    Int findNearest(CoordinateType mz, CoordinateType tolerance) const;
+
+    /**
+      @brief Binary search for peak range begin
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+    */
+    ConstIterator MZBegin(CoordinateType mz) const;
+
+    /**
+      @brief Binary search for peak range end (returns the past-the-end iterator)
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+    */
+    ConstIterator MZEnd(CoordinateType mz) const;
+
+    /**
+      @brief Sums up the intensities of all peaks in the m/z range [@p mz_min, @p mz_max]
+
+      The borders are found by binary search, the summation is a linear scan over the intensity column.
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+    */
+    double sumIntensity(CoordinateType mz_min, CoordinateType mz_max) const;
+
+    /// compute the total ion count (sum of all peak intensities)
+    double calculateTIC() const;
+    ///@}
+
+    /**
+      @brief Clears all data and meta data
+
+      @param clear_meta_data If @em true, all meta data is cleared in addition to the data.
+    */
+    void clear(bool clear_meta_data);
+
+protected:
+    /// Returns the index of the first peak with m/z not less than @p mz
+    Size lowerBound_(CoordinateType mz) const;
+
+    /// Returns the index of the first peak with m/z greater than @p mz
+    Size upperBound_(CoordinateType mz) const;
+
+    /// Only retains the peaks (and data array entries) given in @p indices, in that order
+    void select_(const std::vector<Size>& indices);
+
+    /// m/z column (MZStorage::DOUBLE)
+    std::vector<double> mz_;
+
+    /// m/z offset column (MZStorage::FLOAT_OFFSET)
+    std::vector<float> mz_float_;
+
+    /// intensity column
+    std::vector<float> intensity_;
+
+    /// storage mode of the m/z column
+    MZStorage mz_storage_;
+
+    /// base value of the m/z offsets
+    double mz_offset_;
+
+    /// Retention time
+    double retention_time_;
+
+    /// Drift time
+    double drift_time_;
+
+    /// Drift time unit
+    DriftTimeUnit drift_time_unit_;
+
+    /// MS level
+    UInt ms_level_;
+
+    /// Name
+    String name_;
+
+    /// Float data arrays
+    FloatDataArrays float_data_arrays_;
+
+    /// String data arrays
+    StringDataArrays string_data_arrays_;
+
+    /// Integer data arrays
+    IntegerDataArrays integer_data_arrays_;
+  };
+
+} // namespace OpenMS
@@ -0,0 +1,145 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/config.h>
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Read-only memory mapping of a complete file
+
+    The file content is mapped into the address space of the process and can
+    be accessed through data() without any explicit read calls; pages are
+    loaded on demand by the operating system and shared between all threads
+    (and processes) mapping the same file. The mapping is released when the
+    object is destroyed or close() is called, after which all pointers into
+    the mapped region are invalid.
+
+    Access to the mapped memory is thread-safe as long as the file is not
+    modified on disk while it is mapped.
+
+    @note Empty files can be opened but do not provide any data (data() returns
+    nullptr and size() returns zero).
+  */
+  class OPENMS_DLLAPI MemoryMappedFile
+  {
+public:
+
+    /// Expected access pattern (a hint for the operating system, see advise())
+    enum class AccessPattern
+    {
+      NORMAL,      ///< no special treatment
+      SEQUENTIAL,  ///< the file is read front to back (aggressive read-ahead)
+      RANDOM       ///< the file is read at random positions (no read-ahead)
+    };
+
+    /// Default constructor (no file is mapped)
+    MemoryMappedFile();
+
+    /**
+      @brief Constructor, maps the file @p filename
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::FileNotReadable is thrown if the file cannot be mapped
+    */
+    explicit MemoryMappedFile(const String& filename);
+
+    /// Destructor, releases the mapping
+    ~MemoryMappedFile();
+
+    /// Copying is not allowed (the mapping has a single owner)
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    /// Move constructor
+    MemoryMappedFile(MemoryMappedFile&& rhs) noexcept;
+
+    /// Move assignment operator
+    MemoryMappedFile& operator=(MemoryMappedFile&& rhs) noexcept;
+
+    /**
+      @brief Maps the file @p filename (an existing mapping is released first)
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::FileNotReadable is thrown if the file cannot be mapped
+    */
+    void open(const String& filename);
+
+    /// Releases the mapping (nothing happens if no file is mapped)
+    void close();
+
+    /// Whether a file is currently mapped
+    bool isOpen() const;
+
+    /// Start of the mapped file content (nullptr for closed or empty files)
+    const char* data() const;
+
+    /// Size of the mapped file in bytes
+    Size size() const;
+
+    /// Name of the mapped file
+    const String& getFilename() const;
+
+    /// Tells the operating system how the mapping will be accessed (ignored where not supported)
+    void advise(AccessPattern pattern) const;
+
+    /**
+      @brief Asks the operating system to load the given byte range into memory in the background
+
+      The call returns immediately. Ranges exceeding the file are clipped and
+      the call is ignored where not supported.
+    */
+    void prefetch(Size offset, Size length) const;
+
+protected:
+
+    /// Start of the mapping
+    char* data_;
+
+    /// Size of the mapping in bytes
+    Size size_;
+
+    /// Whether a file is mapped
+    bool is_open_;
+
+    /// Name of the mapped file
+    String filename_;
+  };
+
+} // namespace OpenMS
@@ -24,6 +24,7 @@ ExternalProcess.h
 File.h
 FileWatcher.h
 JavaInfo.h
+MemoryMappedFile.h
 NetworkGetRequest.h
 PythonInfo.h
 RWrapper.h
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
@@ -138,9 +139,33 @@ public:
     void pick(const MSChromatogram& input, MSChromatogram& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = false) const;
 
     /**
-      @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      @brief Applies the peak-picking algorithm to a single spectrum stored
+      as structure of arrays (ColumnarSpectrum). The resulting picked peaks
+      are written to the output spectrum. The result is identical to picking
+      the corresponding MSSpectrum.
+
+      @param input  input spectrum in profile mode
+      @param output  output spectrum with picked peaks
+     */
+    void pick(const ColumnarSpectrum& input, ColumnarSpectrum& output) const;
+
+    /**
+      @brief Applies the peak-picking algorithm to a single spectrum stored
+      as structure of arrays (ColumnarSpectrum). The resulting picked peaks
+      are written to the output spectrum. Peak boundaries are written to a
+      separate structure.
+
+      @param input  input spectrum in profile mode
+      @param output  output spectrum with picked peaks
+      @param boundaries  boundaries of the picked peaks
+      @param check_spacings  check spacing constraints?
+     */
+    void pick(const ColumnarSpectrum& input, ColumnarSpectrum& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = true) const;
+
+    /**
+      @brief Applies the peak-picking algorithm to a map (MSExperiment). The
+      resulting picked peaks are written to the output map. Spectra and
+      chromatograms are picked in parallel (OpenMP).
      
       @param input  input map in profile mode
       @param output  output map with picked peaks
@@ -149,9 +174,12 @@ public:
     void pickExperiment(const PeakMap& input, PeakMap& output, const bool check_spectrum_type = true) const;
 
     /**
-      @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      @brief Applies the peak-picking algorithm to a map (MSExperiment). The
+      resulting picked peaks are written to the output map.
+
+      Spectra and chromatograms are picked in parallel (OpenMP). The output
+      is identical to picking each scan consecutively; if picking fails for
+      several scans, the exception of the first one is rethrown.
      
       @param input  input map in profile mode
       @param output  output map with picked peaks
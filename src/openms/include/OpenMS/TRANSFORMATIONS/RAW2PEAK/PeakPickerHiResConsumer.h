@@ -0,0 +1,110 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Consumer that centroids spectra and chromatograms on the fly using PeakPickerHiRes
+
+    Allows peak picking while the data is read (e.g. by MzMLFile::transform()),
+    without loading the whole experiment into memory. Spectra and
+    chromatograms are collected into batches which are picked in parallel
+    (OpenMP) and then passed on to the next consumer in their original order.
+
+    Spectra are selected for picking as in PeakPickerHiRes::pickExperiment():
+    if the parameter 'ms_levels' is empty, all spectra that are not centroided
+    are picked, otherwise all spectra of the given MS levels. Other spectra are
+    passed on unchanged. All chromatograms are picked.
+
+    Data of an incomplete batch is passed on by flush() or when the consumer is
+    destroyed.
+
+    @note This does not transfer ownership of the next consumer. It is
+    essential to not delete the next consumer before this object (see
+    MSDataAggregatingConsumer).
+  */
+  class OPENMS_DLLAPI PeakPickerHiResConsumer :
+    public Interfaces::IMSDataConsumer
+  {
+  public:
+
+    /**
+      @brief Constructor
+
+      @param next_consumer  consumer receiving the picked data
+      @param pp  configured peak picker (copied)
+      @param batch_size  number of spectra (or chromatograms) picked together (0: 16 per thread)
+    */
+    PeakPickerHiResConsumer(Interfaces::IMSDataConsumer* next_consumer, const PeakPickerHiRes& pp, Size batch_size = 0);
+
+    /// Destructor, flushes the remaining data to the next consumer
+    ~PeakPickerHiResConsumer() override;
+
+    void setExpectedSize(Size expected_spectra, Size expected_chromatograms) override;
+
+    void setExperimentalSettings(const ExperimentalSettings& exp) override;
+
+    void consumeSpectrum(SpectrumType& s) override;
+
+    void consumeChromatogram(ChromatogramType& c) override;
+
+    /// Picks all collected spectra and chromatograms and passes them on to the next consumer
+    void flush();
+
+  protected:
+
+    /// Picks and passes on the collected spectra
+    void flushSpectra_();
+
+    /// Picks and passes on the collected chromatograms
+    void flushChromatograms_();
+
+    Interfaces::IMSDataConsumer* next_consumer_;
+    PeakPickerHiRes pp_;
+    std::vector<Int> ms_levels_;
+    Size batch_size_;
+    std::vector<SpectrumType> spectra_;
+    std::vector<ChromatogramType> chromatograms_;
+  };
+
+} // namespace OpenMS
+
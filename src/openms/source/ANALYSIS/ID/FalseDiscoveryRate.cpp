@@ -43,6 +43,11 @@
 #include <OpenMS/METADATA/ProteinIdentification.h>
 
 #include <algorithm>
+#include <unordered_map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // #define FALSE_DISCOVERY_RATE_DEBUG
 // #undef  FALSE_DISCOVERY_RATE_DEBUG
@@ -74,6 +79,248 @@ namespace OpenMS
     defaultsToParam_();
   }
 
+  namespace
+  {
+    /**
+      @brief Sorts [@p first, @p last) like std::sort, but on all OpenMP threads
+
+      Each thread sorts one contiguous chunk, the sorted chunks are then merged pairwise. Falls back to std::sort
+      for small ranges and when called from within a parallel region.
+    */
+    template <typename RandomIt, typename Compare>
+    void parallelSort_(RandomIt first, RandomIt last, Compare comp)
+    {
+#ifdef _OPENMP
+      const SignedSize n = last - first;
+      const SignedSize chunks = omp_get_max_threads();
+      if (chunks > 1 && n >= 100000 && !omp_in_parallel())
+      {
+        vector<SignedSize> bounds(chunks + 1);
+        for (SignedSize c = 0; c <= chunks; ++c)
+        {
+          bounds[c] = n * c / chunks;
+        }
+        #pragma omp parallel for schedule(static, 1)
+        for (SignedSize c = 0; c < chunks; ++c)
+        {
+          std::sort(first + bounds[c], first + bounds[c + 1], comp);
+        }
+        for (SignedSize width = 1; width < chunks; width *= 2)
+        {
+          #pragma omp parallel for schedule(static, 1)
+          for (SignedSize c = 0; c < chunks; c += 2 * width)
+          {
+            if (c + width < chunks)
+            {
+              std::inplace_merge(first + bounds[c], first + bounds[c + width], first + bounds[std::min(c + 2 * width, chunks)], comp);
+            }
+          }
+        }
+        return;
+      }
+#endif
+      std::sort(first, last, comp);
+    }
+
+    /**
+      @brief Flat replacement for a std::map<double, double> from scores to FDRs
+
+      All scores are known up front, so they are stored once (sorted and unique) and looked up by binary search.
+    */
+    class ScoreToFDRTable_
+    {
+    public:
+      /// Sets the keys to the union of @p target_scores and @p decoy_scores; all FDRs are 0
+      void setScores(const vector<double>& target_scores, const vector<double>& decoy_scores)
+      {
+        scores_.clear();
+        scores_.reserve(target_scores.size() + decoy_scores.size());
+        scores_.insert(scores_.end(), target_scores.begin(), target_scores.end());
+        scores_.insert(scores_.end(), decoy_scores.begin(), decoy_scores.end());
+        parallelSort_(scores_.begin(), scores_.end(), std::less<double>());
+        scores_.erase(std::unique(scores_.begin(), scores_.end()), scores_.end());
+        fdrs_.assign(scores_.size(), 0.0);
+      }
+
+      /// FDR of @p score, which must be one of the keys
+      double& operator[](double score)
+      {
+        return fdrs_[std::lower_bound(scores_.begin(), scores_.end(), score) - scores_.begin()];
+      }
+
+      /// FDR of @p score, or 0 if @p score is not a key (matching std::map::operator[] on a fresh map)
+      double get(double score) const
+      {
+        auto it = std::lower_bound(scores_.begin(), scores_.end(), score);
+        return (it != scores_.end() && !(score < *it)) ? fdrs_[it - scores_.begin()] : 0.0;
+      }
+
+      /// Copies all entries into @p score_to_fdr (existing entries with the same score are overwritten)
+      void copyTo(map<double, double>& score_to_fdr) const
+      {
+        for (Size i = 0; i < scores_.size(); ++i)
+        {
+          score_to_fdr.insert_or_assign(score_to_fdr.end(), scores_[i], fdrs_[i]);
+        }
+      }
+
+    private:
+      vector<double> scores_;
+      vector<double> fdrs_;
+    };
+
+    /// Target/decoy state of a peptide hit, as given by its 'target_decoy' meta value
+    enum TargetDecoyLabel_ : unsigned char
+    {
+      TDL_TARGET,  ///< "target" or "target+decoy"
+      TDL_DECOY,   ///< "decoy"
+      TDL_EMPTY,   ///< empty string (hit is ignored for the FDR calculation)
+      TDL_MISSING, ///< no 'target_decoy' meta value
+      TDL_UNKNOWN  ///< any other value
+    };
+
+    /**
+      @brief Calculates the FDRs (or q-values) of all target and decoy scores
+
+      Implementation behind FalseDiscoveryRate::calculateFDRs_. The decoy scores are assigned the FDR of the closest
+      target score, which is found by binary search.
+    */
+    void calculateFDRTable_(ScoreToFDRTable_& score_to_fdr, vector<double>& target_scores, vector<double>& decoy_scores, bool q_value, bool higher_score_better)
+    {
+      score_to_fdr.setScores(target_scores, decoy_scores);
+
+      Size number_of_target_scores = target_scores.size();
+      // sort the scores
+      if (higher_score_better && !q_value)
+      {
+        parallelSort_(target_scores.rbegin(), target_scores.rend(), std::less<double>());
+        parallelSort_(decoy_scores.rbegin(), decoy_scores.rend(), std::less<double>());
+      }
+      else if (!higher_score_better && !q_value)
+      {
+        parallelSort_(target_scores.begin(), target_scores.end(), std::less<double>());
+        parallelSort_(decoy_scores.begin(), decoy_scores.end(), std::less<double>());
+      }
+      else if (higher_score_better)
+      {
+        parallelSort_(target_scores.begin(), target_scores.end(), std::less<double>());
+        parallelSort_(decoy_scores.rbegin(), decoy_scores.rend(), std::less<double>());
+      }
+      else
+      {
+        parallelSort_(target_scores.rbegin(), target_scores.rend(), std::less<double>());
+        parallelSort_(decoy_scores.begin(), decoy_scores.end(), std::less<double>());
+      }
+
+      Size j = 0;
+
+      if (q_value)
+      {
+        double minimal_fdr = 1.;
+        for (Size i = 0; i != target_scores.size(); ++i)
+        {
+          if (decoy_scores.empty())
+          {
+            // set FDR to 0 (done below automatically)
+          }
+          else if (i == 0 && j == 0)
+          {
+            while (j != decoy_scores.size()
+                  && ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
+                      (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
+            {
+              ++j;
+            }
+          }
+          else
+          {
+            if (j == decoy_scores.size())
+            {
+              j--;
+            }
+            while (j != 0
+                  && ((target_scores[i] > decoy_scores[j] && higher_score_better) ||
+                      (target_scores[i] < decoy_scores[j] && !higher_score_better)))
+            {
+              --j;
+            }
+            // Since j has to be equal to the number of fps above the threshold we add one
+            if ((target_scores[i] <= decoy_scores[j] && higher_score_better)
+               || (target_scores[i] >= decoy_scores[j] && !higher_score_better))
+            {
+              ++j;
+            }
+          }
+
+#ifdef FALSE_DISCOVERY_RATE_DEBUG
+          cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " ";
+#endif
+
+          if (minimal_fdr >= (double)j / (number_of_target_scores - i))
+          {
+            minimal_fdr = (double)j / (number_of_target_scores - i);
+          }
+
+#ifdef FALSE_DISCOVERY_RATE_DEBUG
+          cerr << minimal_fdr << endl;
+#endif
+          score_to_fdr[target_scores[i]] = minimal_fdr;
+        }
+      }
+      else
+      {
+        for (Size i = 0; i != target_scores.size(); ++i)
+        {
+          while (j != decoy_scores.size() &&
+                 ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
+                  (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
+          {
+            ++j;
+          }
+
+          double fdr = (double)j / (double)(i + 1);
+
+#ifdef FALSE_DISCOVERY_RATE_DEBUG
+          cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " " << fdr << endl;
+#endif
+          score_to_fdr[target_scores[i]] = fdr;
+        }
+      }
+
+      // assign q-value of decoy_score to closest target_score
+      for (Size i = 0; i != decoy_scores.size(); ++i)
+      {
+        const double& ds = decoy_scores[i];
+
+        // first target score that is better than the decoy score (or 0 if the first one already is)
+        auto not_better = [&ds, higher_score_better](double ts) { return (ts <= ds && higher_score_better) || (ts >= ds && !higher_score_better); };
+        Size k = 0;
+        if (!target_scores.empty() && not_better(target_scores[0]))
+        {
+          k = std::partition_point(target_scores.begin(), target_scores.end(), not_better) - target_scores.begin();
+        }
+
+        // corner cases
+        if (k == 0)
+        {
+          score_to_fdr[ds] = target_scores.empty() ? 1.0 : score_to_fdr[target_scores[0]];
+        }
+        else if (k == target_scores.size())
+        {
+          score_to_fdr[ds] = score_to_fdr[target_scores.back()];
+        }
+        else if (fabs(target_scores[k] - ds) < fabs(target_scores[k - 1] - ds))
+        {
+          score_to_fdr[ds] = score_to_fdr[target_scores[k]];
+        }
+        else
+        {
+          score_to_fdr[ds] = score_to_fdr[target_scores[k - 1]];
+        }
+      }
+    }
+  }
+
   bool isFirstBetterScore(double first, double second, bool isHigherBetter)
   {
     if (isHigherBetter) return first > second; else return first < second;
@@ -98,126 +345,132 @@ namespace OpenMS
 
     bool higher_score_better = ids.begin()->isHigherScoreBetter();
 
-    // first search for all identifiers and charge variants
-    set<String> identifiers;
-    set<SignedSize> charge_variants;
-    for (auto it = ids.begin(); it != ids.end(); ++it)
+    #pragma omp parallel for schedule(dynamic, 1000)
+    for (SignedSize i = 0; i < SignedSize(ids.size()); ++i)
     {
-      identifiers.insert(it->getIdentifier());
-      it->sort();
-
-      if (!use_all_hits && it->getHits().size() > 1)
+      ids[i].sort();
+      if (!use_all_hits && ids[i].getHits().size() > 1)
       {
-        it->getHits().resize(1);
+        ids[i].getHits().resize(1);
       }
+    }
 
-      for (auto pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
+    // extract all hits into flat columns: hit 'k' of identification 'i' is stored at index 'hit_offsets[i] + k'
+    vector<Size> hit_offsets(ids.size() + 1, 0);
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      hit_offsets[i + 1] = hit_offsets[i] + ids[i].getHits().size();
+    }
+    const Size n_hits = hit_offsets.back();
+    const UInt target_decoy_index = MetaInfoInterface::metaRegistry().registerName("target_decoy");
+
+    vector<double> scores(n_hits);
+    vector<Int> charges(n_hits);
+    vector<unsigned char> labels(n_hits);
+    vector<String> sequences(annotate_peptide_fdr ? n_hits : 0); // unmodified sequences
+    #pragma omp parallel for schedule(dynamic, 1000)
+    for (SignedSize i = 0; i < SignedSize(ids.size()); ++i)
+    {
+      const vector<PeptideHit>& hits = ids[i].getHits();
+      for (Size k = 0; k < hits.size(); ++k)
       {
-        charge_variants.insert(pit->getCharge());
+        const Size h = hit_offsets[i] + k;
+        scores[h] = hits[k].getScore();
+        charges[h] = hits[k].getCharge();
+        if (!hits[k].metaValueExists(target_decoy_index))
+        {
+          labels[h] = TDL_MISSING;
+        }
+        else
+        {
+          const String target_decoy(hits[k].getMetaValue(target_decoy_index));
+          if (target_decoy == "target" || target_decoy == "target+decoy")
+          {
+            labels[h] = TDL_TARGET;
+          }
+          else if (target_decoy == "decoy")
+          {
+            labels[h] = TDL_DECOY;
+          }
+          else
+          {
+            labels[h] = target_decoy.empty() ? TDL_EMPTY : TDL_UNKNOWN;
+          }
+        }
+        if (annotate_peptide_fdr)
+        {
+          sequences[h] = hits[k].getSequence().toUnmodifiedString();
+        }
       }
     }
 
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-    cerr << "#id-runs: " << identifiers.size() << " ";
-    for (auto it = identifiers.begin(); it != identifiers.end(); ++it)
+    // group the identifications by run (if runs are treated separately) and collect all charge variants
+    map<String, vector<Size>> run_to_ids;
+    for (Size i = 0; i < ids.size(); ++i)
     {
-      cerr << "," << *it;
+      run_to_ids[treat_runs_separately ? ids[i].getIdentifier() : String()].push_back(i);
     }
-    cerr << endl;
-
-
-    cerr << "#of charge states: " << charge_variants.size() << " ";
-    for (auto it = charge_variants.begin(); it != charge_variants.end(); ++it)
+    set<SignedSize> charge_variants(charges.begin(), charges.end());
+    if (!split_charge_variants && !charge_variants.empty())
     {
-      cerr << "," << *it;
+      charge_variants.erase(std::next(charge_variants.begin()), charge_variants.end()); // only a single pass
     }
-    cerr << endl;
-#endif
 
-    for (auto zit = charge_variants.begin(); zit != charge_variants.end(); ++zit)
+    vector<UInt> score_type_indices(ids.size(), 0); // index of meta value "<score type>_score"
+    vector<unsigned char> removed(n_hits, 0);
+
+    for (SignedSize charge : charge_variants)
     {
 #ifdef FALSE_DISCOVERY_RATE_DEBUG
-      cerr << "Charge variant=" << *zit << endl;
+      cerr << "Charge variant=" << charge << endl;
 #endif
-
-      // for all identifiers
-      for (auto iit = identifiers.begin(); iit != identifiers.end(); ++iit)
+      for (const auto& run : run_to_ids)
       {
-        if (!treat_runs_separately && iit != identifiers.begin())
-        {
-          continue; //only take the first run
-        }
+        const vector<Size>& group_ids = run.second;
+        auto in_group = [&](Size h) { return !split_charge_variants || charges[h] == charge; };
 
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << "Id-run: " << *iit << endl;
-#endif
         // get the scores of all peptide hits
         vector<double> target_scores, decoy_scores;
-        map<String, double> peptide_to_best_decoy_score, peptide_to_best_target_score;
-        for (auto it = ids.begin(); it != ids.end(); ++it)
+        unordered_map<String, double> peptide_to_best_decoy_score, peptide_to_best_target_score;
+        for (Size i : group_ids)
         {
-          // if runs should be treated separately, the identifiers must be the same
-          if (treat_runs_separately && it->getIdentifier() != *iit)
+          for (Size h = hit_offsets[i]; h != hit_offsets[i + 1]; ++h)
           {
-            continue;
-          }
-
-          for (Size i = 0; i < it->getHits().size(); ++i)
-          {
-            if (split_charge_variants && it->getHits()[i].getCharge() != *zit)
+            if (!in_group(h))
             {
               continue;
             }
-
-            if (!it->getHits()[i].metaValueExists("target_decoy"))
+            const double score = scores[h];
+            unordered_map<String, double>* peptide_to_best_score = nullptr;
+            switch (labels[h])
             {
-              OPENMS_LOG_FATAL_ERROR << "Meta value 'target_decoy' does not exists, reindex the idXML file with 'PeptideIndexer' first (run-id='" << it->getIdentifier() << ", rank=" << i + 1 << " of " << it->getHits().size() << ")!" << endl;
-              throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Meta value 'target_decoy' does not exist!");
-            }
+              case TDL_TARGET:
+                target_scores.push_back(score);
+                peptide_to_best_score = &peptide_to_best_target_score;
+                break;
 
-            String target_decoy(it->getHits()[i].getMetaValue("target_decoy"));
-            const String peptide_sequence = it->getHits()[i].getSequence().toUnmodifiedString();
-            const double score = it->getHits()[i].getScore();
+              case TDL_DECOY:
+                decoy_scores.push_back(score);
+                peptide_to_best_score = &peptide_to_best_decoy_score;
+                break;
 
-            if (target_decoy == "target" || target_decoy == "target+decoy")
-            {
-              target_scores.push_back(score);
+              case TDL_EMPTY:
+                break;
 
-              if (annotate_peptide_fdr)
-              {
-                // store best score for peptide (unmodified sequence)              
-                auto [entry_it, success] = peptide_to_best_target_score.emplace(peptide_sequence, score); // try to construct in place (performance)
-
-                if (!success && // emplace failed because key was already present -> replace if current score is better?
-                    isFirstBetterScore(score, entry_it->second, higher_score_better)) 
-                {
-                  entry_it->second = score;
-                }                           
-              }
+              case TDL_MISSING:
+                OPENMS_LOG_FATAL_ERROR << "Meta value 'target_decoy' does not exists, reindex the idXML file with 'PeptideIndexer' first (run-id='" << ids[i].getIdentifier() << ", rank=" << h - hit_offsets[i] + 1 << " of " << ids[i].getHits().size() << ")!" << endl;
+                throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Meta value 'target_decoy' does not exist!");
+
+              default:
+                throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown value of meta value 'target_decoy'", String(ids[i].getHits()[h - hit_offsets[i]].getMetaValue(target_decoy_index)));
             }
-            else
+            if (annotate_peptide_fdr && peptide_to_best_score != nullptr)
             {
-              if (target_decoy == "decoy")
-              {
-                decoy_scores.push_back(score);
-
-                if (annotate_peptide_fdr)
-                {
-                  auto [entry_it, success] = peptide_to_best_decoy_score.emplace(peptide_sequence, score); // try to construct in place (performance)
-
-                  if (!success && // emplace failed because key was already present -> replace if current score is better?
-                      isFirstBetterScore(score, entry_it->second, higher_score_better)) 
-                  {
-                    entry_it->second = score;
-                  }
-                }
-              }
-              else
+              // store best score for peptide (unmodified sequence)
+              auto [entry_it, success] = peptide_to_best_score->emplace(sequences[h], score);
+              if (!success && isFirstBetterScore(score, entry_it->second, higher_score_better))
               {
-                if (!target_decoy.empty())
-                {
-                  throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown value of meta value 'target_decoy'", target_decoy);
-                }
+                entry_it->second = score;
               }
             }
           }
@@ -227,97 +480,105 @@ namespace OpenMS
         cerr << "#target-scores=" << target_scores.size() << ", #decoy-scores=" << decoy_scores.size() << endl;
 #endif
 
-        // check decoy scores
+        String group_string;
+        if (split_charge_variants || treat_runs_separately)
+        {
+          group_string += "(";
+          if (split_charge_variants)
+          {
+            group_string += "charge_variant=" + String(charge) + " ";
+          }
+          if (treat_runs_separately)
+          {
+            group_string += "run-id=" + run.first;
+          }
+          group_string += ")";
+        }
         if (decoy_scores.empty())
         {
-          String error_string = "FalseDiscoveryRate: #decoy sequences is zero! Setting all target sequences to q-value/FDR 0! ";
-          if (split_charge_variants || treat_runs_separately)
+          OPENMS_LOG_ERROR << "FalseDiscoveryRate: #decoy sequences is zero! Setting all target sequences to q-value/FDR 0! " << group_string << std::endl;
+        }
+        if (target_scores.empty())
+        {
+          OPENMS_LOG_ERROR << "FalseDiscoveryRate: #target sequences is zero! Ignoring. " << group_string << std::endl;
+        }
+        const bool pseudo_scores = target_scores.empty() || decoy_scores.empty();
+
+        if (pseudo_scores)
+        {
+          for (Size i : group_ids)
           {
-            error_string += "(";
-            if (split_charge_variants)
+            for (Size h = hit_offsets[i]; h != hit_offsets[i + 1]; ++h)
             {
-              error_string += "charge_variant=" + String(*zit) + " ";
-            }
-            if (treat_runs_separately)
-            {
-              error_string += "run-id=" + *iit;
+              if (in_group(h) && labels[h] == TDL_EMPTY)
+              {
+                throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown value of meta value 'target_decoy'", String());
+              }
             }
-            error_string += ")";
           }
-          OPENMS_LOG_ERROR << error_string << std::endl;
         }
 
-        // check target scores
-        if (target_scores.empty())
+        // register the meta values in order of their first use by the hits (as the serial implementation did),
+        // so the meta value indices do not depend on the number of threads
+        String last_score_type;
+        UInt last_score_type_index = 0, peptide_fdr_index = 0;
+        bool first_written = true;
+        for (Size i : group_ids)
         {
-          String error_string = "FalseDiscoveryRate: #target sequences is zero! Ignoring. ";
-          if (split_charge_variants || treat_runs_separately)
+          for (Size h = hit_offsets[i]; h != hit_offsets[i + 1]; ++h)
           {
-            error_string += "(";
-            if (split_charge_variants)
+            if (!in_group(h) || (pseudo_scores && labels[h] != TDL_TARGET) || (labels[h] == TDL_DECOY && !add_decoy_peptides))
+            {
+              continue;
+            }
+            if (!pseudo_scores && annotate_peptide_fdr && first_written)
             {
-              error_string += "charge_variant=" + String(*zit) + " ";
+              peptide_fdr_index = MetaInfoInterface::metaRegistry().registerName(q_value ? "peptide q-value" : "peptide FDR");
             }
-            if (treat_runs_separately)
+            if (first_written || ids[i].getScoreType() != last_score_type)
             {
-              error_string += "run-id=" + *iit;
+              last_score_type = ids[i].getScoreType();
+              last_score_type_index = MetaInfoInterface::metaRegistry().registerName(last_score_type + "_score");
             }
-            error_string += ")";
+            first_written = false;
+            score_type_indices[i] = last_score_type_index;
+            break; // all hits of an identification share its score type
           }
-          OPENMS_LOG_ERROR << error_string << std::endl;
         }
 
-        if (target_scores.empty() || decoy_scores.empty())
+        if (pseudo_scores)
         {
           // now remove the relevant entries, or put 'pseudo-scores' in
-          for (auto it = ids.begin(); it != ids.end(); ++it)
+          #pragma omp parallel for schedule(dynamic, 100)
+          for (SignedSize gi = 0; gi < SignedSize(group_ids.size()); ++gi)
           {
-            // if runs should be treated separately, the identifiers must be the same
-            if (treat_runs_separately && it->getIdentifier() != *iit)
+            const Size i = group_ids[gi];
+            vector<PeptideHit>& hits = ids[i].getHits();
+            for (Size h = hit_offsets[i]; h != hit_offsets[i + 1]; ++h)
             {
-              continue;
-            }
-
-            vector<PeptideHit> hits(it->getHits()), new_hits;
-            for (Size i = 0; i < hits.size(); ++i)
-            {
-              if (split_charge_variants && hits[i].getCharge() != *zit)
+              if (!in_group(h))
               {
-                new_hits.push_back(hits[i]);
                 continue;
               }
-
-              if (!hits[i].metaValueExists("target_decoy"))
-              {
-                OPENMS_LOG_FATAL_ERROR << "Meta value 'target_decoy' does not exists, reindex the idXML file with 'PeptideIndexer' (run-id='" << it->getIdentifier() << ", rank=" << i + 1 << " of " << hits.size() << ")!" << endl;
-                throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Meta value 'target_decoy' does not exist!");
-              }
-
-              String target_decoy(hits[i].getMetaValue("target_decoy"));
-              if (target_decoy == "target" || target_decoy == "target+decoy")
+              if (labels[h] == TDL_TARGET)
               {
                 // if it is a target hit, there are no decoys, fdr/q-value should be zero then
-                new_hits.push_back(hits[i]);
-                String score_type = it->getScoreType() + "_score";
-                new_hits.back().setMetaValue(score_type, new_hits.back().getScore());
-                new_hits.back().setScore(0);
+                PeptideHit& hit = hits[h - hit_offsets[i]];
+                hit.setMetaValue(score_type_indices[i], scores[h]);
+                hit.setScore(0);
               }
               else
               {
-                if (target_decoy != "decoy")
-                {
-                  throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown value of meta value 'target_decoy'", target_decoy);
-                }
+                removed[h] = 1;
               }
             }
-            it->setHits(new_hits);
           }
           continue;
         }
 
         // calculate fdr for the forward scores
-        map<double, double> score_to_fdr;
-        calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+        ScoreToFDRTable_ score_to_fdr;
+        calculateFDRTable_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
 
         // calculate peptide FDR
         if (annotate_peptide_fdr)
@@ -330,105 +591,88 @@ namespace OpenMS
           for (const auto& ps : peptide_to_best_target_score)
           {
             target_peptide_scores.push_back(ps.second);
-          }      
-          map<double, double> score_to_peptide_fdr;
-          calculateFDRs_(score_to_peptide_fdr, target_peptide_scores, decoy_peptide_scores, q_value, higher_score_better);
+          }
+          ScoreToFDRTable_ score_to_peptide_fdr;
+          calculateFDRTable_(score_to_peptide_fdr, target_peptide_scores, decoy_peptide_scores, q_value, higher_score_better);
           // overwrite best peptide score with peptide q-value
           for (auto& ps : peptide_to_best_decoy_score)
           {
-            ps.second = score_to_peptide_fdr[ps.second];
+            ps.second = score_to_peptide_fdr.get(ps.second);
           }
           for (auto& ps : peptide_to_best_target_score)
           {
-            ps.second = score_to_peptide_fdr[ps.second];
+            ps.second = score_to_peptide_fdr.get(ps.second);
           }
         }
 
         // annotate fdr
-        for (auto it = ids.begin(); it != ids.end(); ++it)
+        #pragma omp parallel for schedule(dynamic, 100)
+        for (SignedSize gi = 0; gi < SignedSize(group_ids.size()); ++gi)
         {
-          // if runs should be treated separately, the identifiers must be the same
-          if (treat_runs_separately && it->getIdentifier() != *iit)
+          const Size i = group_ids[gi];
+          vector<PeptideHit>& hits = ids[i].getHits();
+          for (Size h = hit_offsets[i]; h != hit_offsets[i + 1]; ++h)
           {
-            continue;
-          }
-
-          String score_type = it->getScoreType() + "_score";
-          vector<PeptideHit> hits;
-          for (vector<PeptideHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
-          {
-            PeptideHit hit = *pit;
-
-            if (split_charge_variants && pit->getCharge() != *zit)
+            if (!in_group(h))
             {
-              hits.push_back(*pit);
               continue;
             }
-            if (hit.metaValueExists("target_decoy"))
+            if (labels[h] == TDL_DECOY && !add_decoy_peptides)
             {
-              String meta_value = (String)hit.getMetaValue("target_decoy");
-              if (meta_value == "decoy" && !add_decoy_peptides)
-              {
-                continue;
-              }
-
-              if (annotate_peptide_fdr)
-              {
-                const String peptide_sequence = hit.getSequence().toUnmodifiedString();
-                double peptide_fdr;
-                if (meta_value == "decoy")
-                {
-                  peptide_fdr = peptide_to_best_decoy_score[peptide_sequence];
-                }
-                else
-                {
-                  peptide_fdr = peptide_to_best_target_score[peptide_sequence];
-                }
-                if (q_value)
-                {
-                  hit.setMetaValue("peptide q-value", peptide_fdr);
-                }
-                else
-                {
-                  hit.setMetaValue("peptide FDR", peptide_fdr);
-                }
-              }              
+              removed[h] = 1;
+              continue;
+            }
+            PeptideHit& hit = hits[h - hit_offsets[i]];
+            if (annotate_peptide_fdr)
+            {
+              const unordered_map<String, double>& peptide_fdrs = (labels[h] == TDL_DECOY ? peptide_to_best_decoy_score : peptide_to_best_target_score);
+              auto entry_it = peptide_fdrs.find(sequences[h]);
+              hit.setMetaValue(peptide_fdr_index, entry_it == peptide_fdrs.end() ? 0.0 : entry_it->second);
             }
-            hit.setMetaValue(score_type, pit->getScore());
-            hit.setScore(score_to_fdr[pit->getScore()]);
-            hits.push_back(hit);
+            hit.setMetaValue(score_type_indices[i], scores[h]);
+            hit.setScore(score_to_fdr.get(scores[h]));
           }
-          it->getHits().swap(hits);
         }
       }
-      if (!split_charge_variants)
-      {
-        break;
-      }
     }
 
-    // higher-score-better can be set now, calculations are finished
-    for (vector<PeptideIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
+    // remove the dropped hits; higher-score-better can be set now, calculations are finished
+    #pragma omp parallel for schedule(dynamic, 1000)
+    for (SignedSize i = 0; i < SignedSize(ids.size()); ++i)
     {
+      vector<PeptideHit>& hits = ids[i].getHits();
+      Size kept = 0;
+      for (Size k = 0; k < hits.size(); ++k)
+      {
+        if (removed[hit_offsets[i] + k])
+        {
+          continue;
+        }
+        if (kept != k)
+        {
+          hits[kept] = std::move(hits[k]);
+        }
+        ++kept;
+      }
+      hits.resize(kept);
+
       if (q_value)
       {
-        if (it->getScoreType() != "q-value")
+        if (ids[i].getScoreType() != "q-value")
         {
-          it->setScoreType("q-value");
+          ids[i].setScoreType("q-value");
         }
       }
       else
       {
-        if (it->getScoreType() != "FDR")
+        if (ids[i].getScoreType() != "FDR")
         {
-          it->setScoreType("FDR");
+          ids[i].setScoreType("FDR");
         }
       }
-      it->setHigherScoreBetter(false);
-      it->assignRanks();
+      ids[i].setHigherScoreBetter(false);
+      ids[i].assignRanks();
     }
-
-    return;
   }
 
   void FalseDiscoveryRate::apply(vector<PeptideIdentification>& fwd_ids, vector<PeptideIdentification>& rev_ids) const
@@ -758,153 +1002,9 @@ namespace OpenMS
 
   void FalseDiscoveryRate::calculateFDRs_(map<double, double>& score_to_fdr, vector<double>& target_scores, vector<double>& decoy_scores, bool q_value, bool higher_score_better) const
   {
-    Size number_of_target_scores = target_scores.size();
-    // sort the scores
-    if (higher_score_better && !q_value)
-    {
-      sort(target_scores.rbegin(), target_scores.rend());
-      sort(decoy_scores.rbegin(), decoy_scores.rend());
-    }
-    else if (!higher_score_better && !q_value)
-    {
-      sort(target_scores.begin(), target_scores.end());
-      sort(decoy_scores.begin(), decoy_scores.end());
-    }
-    else if (higher_score_better)
-    {
-      sort(target_scores.begin(), target_scores.end());
-      sort(decoy_scores.rbegin(), decoy_scores.rend());
-    }
-    else
-    {
-      sort(target_scores.rbegin(), target_scores.rend());
-      sort(decoy_scores.begin(), decoy_scores.end());
-    }
-
-    Size j = 0;
-
-    if (q_value)
-    {
-      double minimal_fdr = 1.;
-      for (Size i = 0; i != target_scores.size(); ++i)
-      {
-        if (decoy_scores.empty())
-        {
-          // set FDR to 0 (done below automatically)
-        }
-        else if (i == 0 && j == 0)
-        {
-          while (j != decoy_scores.size()
-                && ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
-                    (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
-          {
-            ++j;
-          }
-        }
-        else
-        {
-          if (j == decoy_scores.size())
-          {
-            j--;
-          }
-          while (j != 0
-                && ((target_scores[i] > decoy_scores[j] && higher_score_better) ||
-                    (target_scores[i] < decoy_scores[j] && !higher_score_better)))
-          {
-            --j;
-          }
-          // Since j has to be equal to the number of fps above the threshold we add one
-          if ((target_scores[i] <= decoy_scores[j] && higher_score_better)
-             || (target_scores[i] >= decoy_scores[j] && !higher_score_better))
-          {
-            ++j;
-          }
-        }
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " ";
-#endif
-
-        double fdr = 0.;
-
-        if (minimal_fdr >= (double)j / (number_of_target_scores - i))
-        {
-          minimal_fdr = (double)j / (number_of_target_scores - i);
-        }
-        fdr = minimal_fdr;
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << fdr << endl;
-#endif
-        score_to_fdr[target_scores[i]] = fdr;
-
-      }
-    }
-    else
-    {
-      for (Size i = 0; i != target_scores.size(); ++i)
-      {
-        while (j != decoy_scores.size() &&
-               ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
-                (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
-        {
-          ++j;
-        }
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " ";
-#endif
-        double fdr(0);
-
-        fdr = (double)j / (double)(i + 1);
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << fdr << endl;
-#endif
-        score_to_fdr[target_scores[i]] = fdr;
-      }
-    }
-
-    // assign q-value of decoy_score to closest target_score
-    for (Size i = 0; i != decoy_scores.size(); ++i)
-    {
-      const double& ds = decoy_scores[i];
-
-      // advance target index until score is better than decoy score
-      size_t k{0};
-      while (k != target_scores.size() &&
-             ((target_scores[k] <= ds && higher_score_better) ||
-              (target_scores[k] >= ds && !higher_score_better)))
-      {
-        ++k;
-      }
-
-      // corner cases
-      if (k == 0)
-      {
-        if (!target_scores.empty())
-        {
-          score_to_fdr[ds] = score_to_fdr[target_scores[0]];
-          continue;
-        }
-        else
-        {
-          score_to_fdr[ds] = 1.0;
-          continue;
-        }
-      }
-
-      if (k == target_scores.size()) { score_to_fdr[ds] = score_to_fdr[target_scores.back()]; continue; }
-
-      if (fabs(target_scores[k] - ds) < fabs(target_scores[k - 1] - ds))
-      {
-        score_to_fdr[ds] = score_to_fdr[target_scores[k]];
-      }
-      else
-      {
-        score_to_fdr[ds] = score_to_fdr[target_scores[k - 1]];
-      }
-    }
+    ScoreToFDRTable_ table;
+    calculateFDRTable_(table, target_scores, decoy_scores, q_value, higher_score_better);
+    table.copyTo(score_to_fdr);
   }
 
   //TODO does not support "by run" and/or "by charge"
@@ -1599,13 +1699,20 @@ namespace OpenMS
 
     if (higher_score_better)
     { // decreasing
-      std::sort(scores_labels.rbegin(), scores_labels.rend());
+      parallelSort_(scores_labels.rbegin(), scores_labels.rend(), std::less<ScoreToTgtDecLabelPair>());
     }
     else
     { // increasing
-      std::sort(scores_labels.begin(), scores_labels.end());
+      parallelSort_(scores_labels.begin(), scores_labels.end(), std::less<ScoreToTgtDecLabelPair>());
     }
 
+    // scores are recorded in sorted order, so every insertion happens right next to the previous one
+    auto hint = scores_to_FDR.end();
+    auto record = [&scores_to_FDR, &hint, higher_score_better](double score, double fdr)
+    {
+      hint = scores_to_FDR.insert_or_assign(higher_score_better ? hint : scores_to_FDR.end(), score, fdr);
+    };
+
     //uniquify scores and add decoy proportions
     double decoys = 0.; // double to account for "partial" decoys
     double last_score = scores_labels[0].first;
@@ -1622,11 +1729,11 @@ namespace OpenMS
         //we are using the conservative formula (Decoy + 1) / (Tgts)
         if (conservative)
         {
-          scores_to_FDR[last_score] = (decoys+1.0)/(double(j)+1.0-decoys);
+          record(last_score, (decoys+1.0)/(double(j)+1.0-decoys));
         }
         else
         {
-          scores_to_FDR[last_score] = (decoys+1.0)/(double(j)+1.0);
+          record(last_score, (decoys+1.0)/(double(j)+1.0));
         }
 
         last_score = scores_labels[j].first;
@@ -1645,11 +1752,11 @@ namespace OpenMS
     // in case there is only one score and generally to include the last score, I guess we need to do this
     if (conservative)
     {
-      scores_to_FDR[last_score] = (decoys+1.0)/(double(j)+1.0-decoys);
+      record(last_score, (decoys+1.0)/(double(j)+1.0-decoys));
     }
     else
     {
-      scores_to_FDR[last_score] = (decoys+1.0)/(double(j)+1.0);
+      record(last_score, (decoys+1.0)/(double(j)+1.0));
     }
 
     if (qvalue) //apply a cumulative minimum on the map (from low to high fdrs)
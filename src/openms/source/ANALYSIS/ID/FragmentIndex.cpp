@@ -0,0 +1,454 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char FRAGMENT_INDEX_MAGIC[8] = {'O', 'M', 'S', 'F', 'I', 'D', 'X', '\0'};
+    const UInt32 FRAGMENT_INDEX_VERSION = 1;
+    const UInt32 FRAGMENT_INDEX_BOM = 0x01020304;
+
+    template <typename T>
+    void writeValue_(ofstream& ofs, const T& value)
+    {
+      ofs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void writeVector_(ofstream& ofs, const vector<T>& v)
+    {
+      writeValue_(ofs, UInt64(v.size()));
+      if (!v.empty())
+      {
+        ofs.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+      }
+    }
+
+    void writeString_(ofstream& ofs, const String& s)
+    {
+      writeValue_(ofs, UInt64(s.size()));
+      ofs.write(s.data(), s.size());
+    }
+
+    template <typename T>
+    void readValue_(ifstream& ifs, T& value, const String& filename)
+    {
+      if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(T)))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unexpected end of fragment index file.");
+      }
+    }
+
+    UInt64 readSize_(ifstream& ifs, UInt64 element_size, UInt64 remaining, const String& filename)
+    {
+      UInt64 size;
+      readValue_(ifs, size, filename);
+      // refuse sizes which cannot be satisfied by the remaining bytes (e.g. corrupt files)
+      if (element_size > 0 && size > remaining / element_size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt fragment index file.");
+      }
+      return size;
+    }
+
+    template <typename T>
+    void readVector_(ifstream& ifs, vector<T>& v, UInt64 remaining, const String& filename)
+    {
+      v.resize(readSize_(ifs, sizeof(T), remaining, filename));
+      if (!v.empty() && !ifs.read(reinterpret_cast<char*>(v.data()), v.size() * sizeof(T)))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unexpected end of fragment index file.");
+      }
+    }
+
+    void readString_(ifstream& ifs, String& s, UInt64 remaining, const String& filename)
+    {
+      s.resize(readSize_(ifs, 1, remaining, filename));
+      if (!s.empty() && !ifs.read(&s[0], s.size()))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unexpected end of fragment index file.");
+      }
+    }
+  }
+
+  FragmentIndex::FragmentIndex() :
+    FragmentIndex(0.02)
+  {
+  }
+
+  FragmentIndex::FragmentIndex(double bin_width) :
+    bin_width_(bin_width)
+  {
+    if (!(bin_width > 0.0))
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "The bin width must be positive.", String(bin_width));
+    }
+  }
+
+  void FragmentIndex::build(vector<Peptide> peptides, const vector<vector<Fragment>>& fragments)
+  {
+    if (peptides.size() != fragments.size())
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, fragments.size());
+    }
+    if (peptides.size() >= Size(numeric_limits<UInt32>::max()))
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, peptides.size());
+    }
+    clear();
+
+    // sort peptides by mass (ties are broken deterministically, independent of the input order)
+    vector<Size> order(peptides.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&peptides](Size a, Size b)
+    {
+      const Peptide& pa = peptides[a];
+      const Peptide& pb = peptides[b];
+      if (pa.mass != pb.mass) return pa.mass < pb.mass;
+      if (pa.sequence != pb.sequence) return pa.sequence < pb.sequence;
+      return pa.modification_index < pb.modification_index;
+    });
+
+    peptides_.reserve(peptides.size());
+    masses_.reserve(peptides.size());
+    fragment_offsets_.reserve(peptides.size() + 1);
+    fragment_offsets_.push_back(0);
+    double max_mz = 0.0;
+    vector<Fragment> sorted_fragments;
+    for (Size i : order)
+    {
+      masses_.push_back(peptides[i].mass);
+      peptides_.push_back(std::move(peptides[i]));
+
+      sorted_fragments = fragments[i];
+      stable_sort(sorted_fragments.begin(), sorted_fragments.end(), [](const Fragment& a, const Fragment& b) { return a.mz < b.mz; });
+      for (const Fragment& f : sorted_fragments)
+      {
+        fragment_mz_.push_back(f.mz);
+        fragment_intensity_.push_back(f.intensity);
+        fragment_type_.push_back(f.ion_type);
+        max_mz = max(max_mz, f.mz);
+      }
+      fragment_offsets_.push_back(fragment_mz_.size());
+    }
+
+    if (fragment_mz_.empty())
+    {
+      return;
+    }
+
+    // counting sort of the (peptide, bin) pairs; since peptides are visited
+    // in id order, the ids of each bin end up sorted
+    const Size n_bins = Size(max_mz / bin_width_) + 1;
+    auto bin_of = [this](double mz) { return mz <= 0.0 ? Size(0) : Size(mz / bin_width_); };
+    bin_offsets_.assign(n_bins + 1, 0);
+    for (Size id = 0; id < peptides_.size(); ++id)
+    {
+      Size previous_bin = numeric_limits<Size>::max();
+      for (UInt64 f = fragment_offsets_[id]; f < fragment_offsets_[id + 1]; ++f)
+      {
+        const Size bin = bin_of(fragment_mz_[f]);
+        if (bin != previous_bin) // fragments are sorted, so duplicates are adjacent
+        {
+          ++bin_offsets_[bin + 1];
+          previous_bin = bin;
+        }
+      }
+    }
+    partial_sum(bin_offsets_.begin(), bin_offsets_.end(), bin_offsets_.begin());
+
+    bin_peptides_.resize(bin_offsets_.back());
+    vector<UInt64> fill(bin_offsets_.begin(), bin_offsets_.end() - 1);
+    for (Size id = 0; id < peptides_.size(); ++id)
+    {
+      Size previous_bin = numeric_limits<Size>::max();
+      for (UInt64 f = fragment_offsets_[id]; f < fragment_offsets_[id + 1]; ++f)
+      {
+        const Size bin = bin_of(fragment_mz_[f]);
+        if (bin != previous_bin)
+        {
+          bin_peptides_[fill[bin]++] = UInt32(id);
+          previous_bin = bin;
+        }
+      }
+    }
+  }
+
+  void FragmentIndex::clear()
+  {
+    peptides_.clear();
+    masses_.clear();
+    fragment_offsets_.clear();
+    fragment_mz_.clear();
+    fragment_intensity_.clear();
+    fragment_type_.clear();
+    bin_offsets_.clear();
+    bin_peptides_.clear();
+  }
+
+  Size FragmentIndex::size() const
+  {
+    return peptides_.size();
+  }
+
+  bool FragmentIndex::empty() const
+  {
+    return peptides_.empty();
+  }
+
+  double FragmentIndex::getBinWidth() const
+  {
+    return bin_width_;
+  }
+
+  const vector<FragmentIndex::Peptide>& FragmentIndex::getPeptides() const
+  {
+    return peptides_;
+  }
+
+  const FragmentIndex::Peptide& FragmentIndex::getPeptide(Size id) const
+  {
+    return peptides_[id];
+  }
+
+  const String& FragmentIndex::getSignature() const
+  {
+    return signature_;
+  }
+
+  void FragmentIndex::setSignature(const String& signature)
+  {
+    signature_ = signature;
+  }
+
+  pair<Size, Size> FragmentIndex::getPeptideRange(double min_mass, double max_mass) const
+  {
+    const Size first = lower_bound(masses_.begin(), masses_.end(), min_mass) - masses_.begin();
+    const Size last = upper_bound(masses_.begin(), masses_.end(), max_mass) - masses_.begin();
+    return {first, max(first, last)};
+  }
+
+  void FragmentIndex::getSpectrum(Size id, PeakSpectrum& spectrum) const
+  {
+    spectrum.clear(true);
+    const UInt64 begin = fragment_offsets_[id];
+    const UInt64 end = fragment_offsets_[id + 1];
+    spectrum.reserve(end - begin);
+    spectrum.getStringDataArrays().resize(1);
+    spectrum.getStringDataArrays()[0].setName("IonNames");
+    spectrum.getStringDataArrays()[0].reserve(end - begin);
+    for (UInt64 f = begin; f < end; ++f)
+    {
+      spectrum.emplace_back(fragment_mz_[f], fragment_intensity_[f]);
+      spectrum.getStringDataArrays()[0].push_back(String(fragment_type_[f]));
+    }
+  }
+
+  void FragmentIndex::query(const PeakSpectrum& spectrum,
+                            double min_mass,
+                            double max_mass,
+                            double fragment_tolerance,
+                            bool fragment_tolerance_ppm,
+                            Size min_shared_peaks,
+                            vector<pair<Size, Size>>& candidates) const
+  {
+    const auto [first, last] = getPeptideRange(min_mass, max_mass);
+    if (first == last)
+    {
+      return;
+    }
+
+    vector<UInt32> shared(last - first, 0);
+    vector<UInt32> last_peak(last - first, 0); // (1-based) index of the peak counted last for each peptide
+    const Size n_bins = bin_offsets_.empty() ? 0 : bin_offsets_.size() - 1;
+    for (Size p = 0; p < spectrum.size() && n_bins > 0; ++p)
+    {
+      const double mz = spectrum[p].getMZ();
+      const double tolerance = fragment_tolerance_ppm ? mz * fragment_tolerance * 1e-6 : fragment_tolerance;
+      if (mz + tolerance < 0.0)
+      {
+        continue;
+      }
+      const Size bin_first = mz - tolerance <= 0.0 ? 0 : Size((mz - tolerance) / bin_width_);
+      if (bin_first >= n_bins)
+      {
+        continue;
+      }
+      const Size bin_last = min(Size((mz + tolerance) / bin_width_), n_bins - 1);
+      const UInt32 peak_marker = UInt32(p + 1);
+      for (Size bin = bin_first; bin <= bin_last; ++bin)
+      {
+        const auto bin_end = bin_peptides_.begin() + bin_offsets_[bin + 1];
+        for (auto it = lower_bound(bin_peptides_.begin() + bin_offsets_[bin], bin_end, UInt32(first));
+             it != bin_end && *it < last; ++it)
+        {
+          const Size i = *it - first;
+          if (last_peak[i] != peak_marker)
+          {
+            last_peak[i] = peak_marker;
+            ++shared[i];
+          }
+        }
+      }
+    }
+
+    for (Size i = 0; i < shared.size(); ++i)
+    {
+      if (shared[i] >= min_shared_peaks)
+      {
+        candidates.emplace_back(first + i, shared[i]);
+      }
+    }
+  }
+
+  void FragmentIndex::store(const String& filename) const
+  {
+    ofstream ofs(filename.c_str(), ios::out | ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ofs.write(FRAGMENT_INDEX_MAGIC, sizeof(FRAGMENT_INDEX_MAGIC));
+    writeValue_(ofs, FRAGMENT_INDEX_VERSION);
+    writeValue_(ofs, FRAGMENT_INDEX_BOM);
+    writeValue_(ofs, bin_width_);
+    writeString_(ofs, signature_);
+
+    writeValue_(ofs, UInt64(peptides_.size()));
+    for (const Peptide& p : peptides_)
+    {
+      writeString_(ofs, p.sequence);
+      writeValue_(ofs, UInt64(p.modification_index));
+      writeValue_(ofs, p.mass);
+    }
+    writeVector_(ofs, fragment_offsets_);
+    writeVector_(ofs, fragment_mz_);
+    writeVector_(ofs, fragment_intensity_);
+    writeVector_(ofs, fragment_type_);
+    writeVector_(ofs, bin_offsets_);
+    writeVector_(ofs, bin_peptides_);
+
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error writing fragment index.");
+    }
+  }
+
+  void FragmentIndex::load(const String& filename)
+  {
+    ifstream ifs(filename.c_str(), ios::in | ios::binary);
+    if (!ifs)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ifs.seekg(0, ios::end);
+    const UInt64 file_size = UInt64(ifs.tellg());
+    ifs.seekg(0, ios::beg);
+
+    char magic[sizeof(FRAGMENT_INDEX_MAGIC)];
+    UInt32 version, bom;
+    if (!ifs.read(magic, sizeof(magic)) || memcmp(magic, FRAGMENT_INDEX_MAGIC, sizeof(magic)) != 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File is not a fragment index.");
+    }
+    readValue_(ifs, version, filename);
+    readValue_(ifs, bom, filename);
+    if (version != FRAGMENT_INDEX_VERSION || bom != FRAGMENT_INDEX_BOM)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+                                  "Unsupported fragment index version or byte order (version " + String(version) + ").");
+    }
+
+    FragmentIndex index;
+    readValue_(ifs, index.bin_width_, filename);
+    readString_(ifs, index.signature_, file_size, filename);
+
+    index.peptides_.resize(readSize_(ifs, 2 * sizeof(UInt64) + sizeof(double), file_size, filename));
+    index.masses_.reserve(index.peptides_.size());
+    for (Peptide& p : index.peptides_)
+    {
+      UInt64 modification_index;
+      readString_(ifs, p.sequence, file_size, filename);
+      readValue_(ifs, modification_index, filename);
+      readValue_(ifs, p.mass, filename);
+      p.modification_index = Size(modification_index);
+      index.masses_.push_back(p.mass);
+    }
+    readVector_(ifs, index.fragment_offsets_, file_size, filename);
+    readVector_(ifs, index.fragment_mz_, file_size, filename);
+    readVector_(ifs, index.fragment_intensity_, file_size, filename);
+    readVector_(ifs, index.fragment_type_, file_size, filename);
+    readVector_(ifs, index.bin_offsets_, file_size, filename);
+    readVector_(ifs, index.bin_peptides_, file_size, filename);
+
+    // check consistency, so queries can rely on the offsets
+    const bool consistent =
+      index.bin_width_ > 0.0 &&
+      (index.fragment_offsets_.empty() ? // empty index
+        index.peptides_.empty() && index.fragment_mz_.empty() :
+        (index.fragment_offsets_.size() == index.peptides_.size() + 1 &&
+         index.fragment_offsets_.front() == 0 &&
+         index.fragment_offsets_.back() == index.fragment_mz_.size() &&
+         is_sorted(index.fragment_offsets_.begin(), index.fragment_offsets_.end()))) &&
+      index.fragment_intensity_.size() == index.fragment_mz_.size() &&
+      index.fragment_type_.size() == index.fragment_mz_.size() &&
+      is_sorted(index.masses_.begin(), index.masses_.end()) &&
+      (index.bin_offsets_.empty() ||
+        (index.bin_offsets_.front() == 0 &&
+         index.bin_offsets_.back() == index.bin_peptides_.size() &&
+         is_sorted(index.bin_offsets_.begin(), index.bin_offsets_.end()))) &&
+      all_of(index.bin_peptides_.begin(), index.bin_peptides_.end(), [&index](UInt32 id) { return id < index.peptides_.size(); });
+    if (!consistent)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt fragment index file.");
+    }
+    *this = std::move(index);
+  }
+
+} // namespace OpenMS
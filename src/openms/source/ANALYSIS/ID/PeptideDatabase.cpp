@@ -0,0 +1,558 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
+
+#include <OpenMS/ANALYSIS/ID/FNVHash.h>
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
+#include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QDir>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char PEPTIDE_DATABASE_MAGIC[8] = {'O', 'M', 'S', 'P', 'E', 'P', 'D', 'B'};
+    const UInt32 PEPTIDE_DATABASE_VERSION = 1;
+    const UInt32 PEPTIDE_DATABASE_BOM = 0x01020304;
+
+    /// Appends 8 byte aligned sections to a table image
+    class ImageWriter_
+    {
+    public:
+      explicit ImageWriter_(vector<char>& image) :
+        image_(image)
+      {
+      }
+
+      void append(const void* data, Size size)
+      {
+        const char* begin = static_cast<const char*>(data);
+        image_.insert(image_.end(), begin, begin + size);
+      }
+
+      template <typename T>
+      void section(const T* data, Size count)
+      {
+        const UInt64 bytes = count * sizeof(T);
+        append(&bytes, sizeof(bytes));
+        if (bytes > 0)
+        {
+          append(data, bytes);
+        }
+        image_.resize((image_.size() + 7) / 8 * 8, 0);
+      }
+
+    private:
+      vector<char>& image_;
+    };
+
+    /// Reads the sections of a table image (with bounds checks)
+    class ImageReader_
+    {
+    public:
+      ImageReader_(const char* data, Size size, const String& filename) :
+        data_(data), size_(size), filename_(filename)
+      {
+      }
+
+      void read(void* target, Size size)
+      {
+        check_(size);
+        memcpy(target, data_ + pos_, size);
+        pos_ += size;
+      }
+
+      /// returns the start of the next section and sets @p count to the number of elements in it
+      template <typename T>
+      const T* section(Size& count)
+      {
+        UInt64 bytes;
+        read(&bytes, sizeof(bytes));
+        check_(bytes);
+        if (bytes % sizeof(T) != 0)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Corrupt peptide database (invalid section size).");
+        }
+        const char* begin = data_ + pos_;
+        pos_ = min(size_, Size((pos_ + bytes + 7) / 8 * 8));
+        count = bytes / sizeof(T);
+        return reinterpret_cast<const T*>(begin);
+      }
+
+      /// returns the start of the next section, which must contain @p expected_count elements
+      template <typename T>
+      const T* section(Size expected_count, const char* name)
+      {
+        Size count;
+        const T* begin = section<T>(count);
+        if (count != expected_count)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, String("Corrupt peptide database (unexpected size of section '") + name + "').");
+        }
+        return begin;
+      }
+
+    private:
+      void check_(Size size) const
+      {
+        if (size > size_ - pos_)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Unexpected end of peptide database.");
+        }
+      }
+
+      const char* data_;
+      Size size_;
+      Size pos_ = 0;
+      const String& filename_;
+    };
+
+    /// Content of the sections of a table image
+    struct Sections_
+    {
+      UInt64 n_entries = 0;
+      UInt64 n_proteins = 0;
+      String key;
+      vector<double> masses;
+      vector<UInt64> sequence_offsets = {0};
+      String sequences;
+      vector<UInt64> modified_offsets = {0};
+      String modified_sequences;
+      vector<UInt32> modification_indices;
+      vector<UInt64> protein_offsets = {0};
+      vector<UInt32> protein_indices;
+      vector<UInt64> accession_offsets = {0};
+      String accessions;
+    };
+
+    vector<char> createImage_(const Sections_& s)
+    {
+      vector<char> image;
+      ImageWriter_ writer(image);
+      writer.append(PEPTIDE_DATABASE_MAGIC, sizeof(PEPTIDE_DATABASE_MAGIC));
+      writer.append(&PEPTIDE_DATABASE_VERSION, sizeof(PEPTIDE_DATABASE_VERSION));
+      writer.append(&PEPTIDE_DATABASE_BOM, sizeof(PEPTIDE_DATABASE_BOM));
+      writer.append(&s.n_entries, sizeof(s.n_entries));
+      writer.append(&s.n_proteins, sizeof(s.n_proteins));
+      writer.section(s.key.data(), s.key.size());
+      writer.section(s.masses.data(), s.masses.size());
+      writer.section(s.sequence_offsets.data(), s.sequence_offsets.size());
+      writer.section(s.sequences.data(), s.sequences.size());
+      writer.section(s.modified_offsets.data(), s.modified_offsets.size());
+      writer.section(s.modified_sequences.data(), s.modified_sequences.size());
+      writer.section(s.modification_indices.data(), s.modification_indices.size());
+      writer.section(s.protein_offsets.data(), s.protein_offsets.size());
+      writer.section(s.protein_indices.data(), s.protein_indices.size());
+      writer.section(s.accession_offsets.data(), s.accession_offsets.size());
+      writer.section(s.accessions.data(), s.accessions.size());
+      return image;
+    }
+
+    /// checks that @p offsets (n + 1 values) start at zero, are non-decreasing and end at @p arena_size
+    bool validOffsets_(const UInt64* offsets, Size n, Size arena_size)
+    {
+      return offsets[0] == 0 && offsets[n] == arena_size && is_sorted(offsets, offsets + n + 1);
+    }
+  }
+
+  String PeptideDatabase::Settings::toString() const
+  {
+    return "enzyme=" + enzyme
+      + ";missed_cleavages=" + String(missed_cleavages)
+      + ";min_size=" + String(min_size)
+      + ";max_size=" + String(max_size)
+      + ";fixed=" + ListUtils::concatenate(fixed_modifications, ",")
+      + ";variable=" + ListUtils::concatenate(variable_modifications, ",")
+      + ";max_variable_mods_per_peptide=" + String(max_variable_mods_per_peptide);
+  }
+
+  PeptideDatabase::PeptideDatabase() :
+    buffer_(createImage_(Sections_()))
+  {
+    attach_(buffer_.data(), buffer_.size(), "");
+  }
+
+  String PeptideDatabase::getCacheKey(const vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings)
+  {
+    Internal::FNVHash hash;
+    for (const FASTAFile::FASTAEntry& e : proteins)
+    {
+      hash.add(e.identifier);
+      hash.add(e.sequence);
+    }
+    return settings.toString() + ";proteins=" + String(proteins.size()) + ";hash=" + hash.toHex();
+  }
+
+  String PeptideDatabase::getCacheFilename(const String& cache_dir, const String& key)
+  {
+    Internal::FNVHash hash;
+    hash.add(key);
+    return cache_dir + "/" + hash.toHex() + ".pepdb";
+  }
+
+  void PeptideDatabase::build(const vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings)
+  {
+    if (proteins.size() >= Size(numeric_limits<UInt32>::max()))
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, proteins.size());
+    }
+
+    ProteaseDigestion digestor;
+    digestor.setEnzyme(settings.enzyme);
+    digestor.setMissedCleavages(settings.missed_cleavages);
+
+    const ModifiedPeptideGenerator::MapToResidueType fixed_modifications = ModifiedPeptideGenerator::getModifications(settings.fixed_modifications);
+    const ModifiedPeptideGenerator::MapToResidueType variable_modifications = ModifiedPeptideGenerator::getModifications(settings.variable_modifications);
+
+    // digest all proteins
+    vector<pair<StringView, UInt32> > occurrences;
+    vector<StringView> current_digest;
+    for (Size protein_index = 0; protein_index < proteins.size(); ++protein_index)
+    {
+      current_digest.clear();
+      digestor.digestUnmodified(proteins[protein_index].sequence, current_digest, settings.min_size, settings.max_size);
+      for (const StringView& c : current_digest)
+      {
+        if (c.getString().find_first_of("XBZ") != std::string::npos)
+        {
+          continue;
+        }
+        occurrences.emplace_back(c, UInt32(protein_index));
+      }
+    }
+    sort(occurrences.begin(), occurrences.end());
+
+    // unique peptides with the (sorted, unique) proteins containing them
+    vector<StringView> peptides;
+    vector<UInt64> peptide_protein_offsets(1, 0);
+    vector<UInt32> peptide_proteins;
+    for (Size i = 0; i < occurrences.size(); ++i)
+    {
+      if (i == 0 || !(occurrences[i].first == occurrences[i - 1].first))
+      {
+        if (i != 0)
+        {
+          peptide_protein_offsets.push_back(peptide_proteins.size());
+        }
+        peptides.push_back(occurrences[i].first);
+        peptide_proteins.push_back(occurrences[i].second);
+      }
+      else if (occurrences[i].second != peptide_proteins.back())
+      {
+        peptide_proteins.push_back(occurrences[i].second);
+      }
+    }
+    if (!peptides.empty())
+    {
+      peptide_protein_offsets.push_back(peptide_proteins.size());
+    }
+    occurrences.clear();
+    occurrences.shrink_to_fit();
+
+    // enumerate the modified variants of all peptides
+    struct Entry
+    {
+      double mass;
+      UInt32 peptide;
+      UInt32 modification_index;
+      String modified_sequence;
+    };
+    vector<Entry> entries;
+
+#pragma omp parallel default(none) shared(peptides, fixed_modifications, variable_modifications, settings, entries)
+    {
+      vector<Entry> local_entries;
+
+#pragma omp for schedule(dynamic, 100) nowait
+      for (SignedSize peptide_index = 0; peptide_index < (SignedSize)peptides.size(); ++peptide_index)
+      {
+        vector<AASequence> all_modified_peptides;
+
+        // this critical section is because ResidueDB is not thread safe and new residues are created based on the PTMs
+        #pragma omp critical (residuedb_access)
+        {
+          AASequence aas = AASequence::fromString(peptides[peptide_index].getString());
+          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, settings.max_variable_mods_per_peptide, all_modified_peptides);
+        }
+
+        for (Size mod_pep_idx = 0; mod_pep_idx < all_modified_peptides.size(); ++mod_pep_idx)
+        {
+          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+          local_entries.push_back({candidate.getMonoWeight(), UInt32(peptide_index), UInt32(mod_pep_idx), candidate.toString()});
+        }
+      }
+
+      #pragma omp critical (peptide_database_merge)
+      {
+        std::move(local_entries.begin(), local_entries.end(), back_inserter(entries));
+      }
+    }
+
+    // sort by mass (ties are broken deterministically, independent of the thread scheduling)
+    sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+    {
+      if (a.mass != b.mass) return a.mass < b.mass;
+      if (a.peptide != b.peptide) return a.peptide < b.peptide;
+      return a.modification_index < b.modification_index;
+    });
+
+    // assemble the sections of the image
+    Sections_ sections;
+    sections.n_entries = entries.size();
+    sections.n_proteins = proteins.size();
+    sections.key = getCacheKey(proteins, settings);
+    sections.masses.reserve(entries.size());
+    sections.modification_indices.reserve(entries.size());
+    for (const Entry& e : entries)
+    {
+      sections.masses.push_back(e.mass);
+      sections.sequences += peptides[e.peptide].getString();
+      sections.sequence_offsets.push_back(sections.sequences.size());
+      sections.modified_sequences += e.modified_sequence;
+      sections.modified_offsets.push_back(sections.modified_sequences.size());
+      sections.modification_indices.push_back(e.modification_index);
+      sections.protein_indices.insert(sections.protein_indices.end(),
+                                      peptide_proteins.begin() + peptide_protein_offsets[e.peptide],
+                                      peptide_proteins.begin() + peptide_protein_offsets[e.peptide + 1]);
+      sections.protein_offsets.push_back(sections.protein_indices.size());
+    }
+    for (const FASTAFile::FASTAEntry& protein : proteins)
+    {
+      sections.accessions += protein.identifier;
+      sections.accession_offsets.push_back(sections.accessions.size());
+    }
+
+    PeptideDatabase db;
+    db.buffer_ = createImage_(sections);
+    db.attach_(db.buffer_.data(), db.buffer_.size(), "");
+    *this = std::move(db);
+  }
+
+  void PeptideDatabase::store(const String& filename) const
+  {
+    ofstream ofs(filename.c_str(), ios::out | ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ofs.write(image_, image_size_);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error writing peptide database.");
+    }
+  }
+
+  void PeptideDatabase::load(const String& filename)
+  {
+    PeptideDatabase db;
+    db.file_.open(filename);
+    db.attach_(db.file_.data(), db.file_.size(), filename);
+    *this = std::move(db);
+  }
+
+  bool PeptideDatabase::loadOrBuild(const String& cache_dir, const vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings)
+  {
+    const String key = getCacheKey(proteins, settings);
+    const String filename = getCacheFilename(cache_dir, key);
+    if (File::exists(filename))
+    {
+      try
+      {
+        load(filename);
+        if (key_ == key)
+        {
+          return true;
+        }
+        OPENMS_LOG_WARN << "Peptide database '" << filename << "' was built for different settings. Rebuilding it." << endl;
+      }
+      catch (Exception::ParseError&)
+      {
+        OPENMS_LOG_WARN << "Peptide database '" << filename << "' is invalid. Rebuilding it." << endl;
+      }
+    }
+
+    build(proteins, settings);
+
+    if (!File::isDirectory(cache_dir))
+    {
+      QDir().mkpath(cache_dir.toQString());
+    }
+    // write under a temporary name first, so concurrent runs never map a partially written file
+    const String tmp_filename = filename + "." + File::getUniqueName() + ".tmp";
+    store(tmp_filename);
+    if (!File::rename(tmp_filename, filename, true, false))
+    {
+      File::remove(tmp_filename);
+      OPENMS_LOG_WARN << "Could not store peptide database '" << filename << "'." << endl;
+    }
+    return false;
+  }
+
+  void PeptideDatabase::attach_(const char* data, Size size, const String& filename)
+  {
+    ImageReader_ reader(data, size, filename);
+
+    char magic[sizeof(PEPTIDE_DATABASE_MAGIC)];
+    UInt32 version, bom;
+    UInt64 n_entries, n_proteins;
+    reader.read(magic, sizeof(magic));
+    if (memcmp(magic, PEPTIDE_DATABASE_MAGIC, sizeof(magic)) != 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File is not a peptide database.");
+    }
+    reader.read(&version, sizeof(version));
+    reader.read(&bom, sizeof(bom));
+    if (version != PEPTIDE_DATABASE_VERSION || bom != PEPTIDE_DATABASE_BOM)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+                                  "Unsupported peptide database version or byte order (version " + String(version) + ").");
+    }
+    reader.read(&n_entries, sizeof(n_entries));
+    reader.read(&n_proteins, sizeof(n_proteins));
+    // every entry and protein needs at least one offset in the image
+    if (n_entries > size / sizeof(UInt64) || n_proteins > size / sizeof(UInt64))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt peptide database.");
+    }
+
+    Size key_size, sequences_size, modified_size, protein_indices_size, accessions_size;
+    const char* key = reader.section<char>(key_size);
+    masses_ = reader.section<double>(n_entries, "masses");
+    sequence_offsets_ = reader.section<UInt64>(n_entries + 1, "sequence offsets");
+    sequences_ = reader.section<char>(sequences_size);
+    modified_offsets_ = reader.section<UInt64>(n_entries + 1, "modified sequence offsets");
+    modified_sequences_ = reader.section<char>(modified_size);
+    modification_indices_ = reader.section<UInt32>(n_entries, "modification indices");
+    protein_offsets_ = reader.section<UInt64>(n_entries + 1, "protein offsets");
+    protein_indices_ = reader.section<UInt32>(protein_indices_size);
+    accession_offsets_ = reader.section<UInt64>(n_proteins + 1, "accession offsets");
+    accessions_ = reader.section<char>(accessions_size);
+
+    const bool consistent =
+      validOffsets_(sequence_offsets_, n_entries, sequences_size) &&
+      validOffsets_(modified_offsets_, n_entries, modified_size) &&
+      validOffsets_(protein_offsets_, n_entries, protein_indices_size) &&
+      validOffsets_(accession_offsets_, n_proteins, accessions_size) &&
+      is_sorted(masses_, masses_ + n_entries) &&
+      all_of(protein_indices_, protein_indices_ + protein_indices_size, [n_proteins](UInt32 p) { return p < n_proteins; });
+    if (!consistent)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt peptide database.");
+    }
+
+    key_ = String(key, key + key_size);
+    image_ = data;
+    image_size_ = size;
+    n_entries_ = n_entries;
+    n_proteins_ = n_proteins;
+  }
+
+  const String& PeptideDatabase::getKey() const
+  {
+    return key_;
+  }
+
+  bool PeptideDatabase::isMapped() const
+  {
+    return file_.isOpen();
+  }
+
+  Size PeptideDatabase::size() const
+  {
+    return n_entries_;
+  }
+
+  bool PeptideDatabase::empty() const
+  {
+    return n_entries_ == 0;
+  }
+
+  Size PeptideDatabase::getNumberOfProteins() const
+  {
+    return n_proteins_;
+  }
+
+  StringView PeptideDatabase::getProteinAccession(Size protein_index) const
+  {
+    return StringView(accessions_ + accession_offsets_[protein_index], accession_offsets_[protein_index + 1] - accession_offsets_[protein_index]);
+  }
+
+  double PeptideDatabase::getMass(Size index) const
+  {
+    return masses_[index];
+  }
+
+  StringView PeptideDatabase::getSequence(Size index) const
+  {
+    return StringView(sequences_ + sequence_offsets_[index], sequence_offsets_[index + 1] - sequence_offsets_[index]);
+  }
+
+  StringView PeptideDatabase::getModifiedSequence(Size index) const
+  {
+    return StringView(modified_sequences_ + modified_offsets_[index], modified_offsets_[index + 1] - modified_offsets_[index]);
+  }
+
+  Size PeptideDatabase::getModificationIndex(Size index) const
+  {
+    return modification_indices_[index];
+  }
+
+  pair<const UInt32*, const UInt32*> PeptideDatabase::getProteinIndices(Size index) const
+  {
+    return {protein_indices_ + protein_offsets_[index], protein_indices_ + protein_offsets_[index + 1]};
+  }
+
+  pair<Size, Size> PeptideDatabase::getMassRange(double min_mass, double max_mass) const
+  {
+    const Size first = lower_bound(masses_, masses_ + n_entries_, min_mass) - masses_;
+    const Size last = upper_bound(masses_, masses_ + n_entries_, max_mass) - masses_;
+    return {first, max(first, last)};
+  }
+
+} // namespace OpenMS
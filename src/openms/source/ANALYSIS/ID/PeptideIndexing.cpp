@@ -35,9 +35,11 @@
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
 
 #include <OpenMS/ANALYSIS/ID/AhoCorasickAmbiguous.h>
+#include <OpenMS/ANALYSIS/ID/ProteinSuffixArray.h>
 #include <OpenMS/CHEMISTRY/ProteaseDB.h>
 #include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
 #include <OpenMS/CONCEPT/EnumHelpers.h>
+#include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/SYSTEM/StopWatch.h>
 #include <OpenMS/SYSTEM/SysInfo.h>
 
@@ -249,6 +251,13 @@ using namespace std;
     defaults_.setValue("allow_nterm_protein_cleavage", "true", "Allow the protein N-terminus amino acid to clip.");
     defaults_.setValidStrings("allow_nterm_protein_cleavage", { "true", "false" });
 
+    defaults_.setValue("backend", "aho_corasick", "Search algorithm: 'aho_corasick' streams the database through a trie of the peptides;"
+                                                  " 'suffix_array' looks up the peptides in a suffix array of the database, which can be stored (see 'suffix_array_file') and reused for many identification files.");
+    defaults_.setValidStrings("backend", { "aho_corasick", "suffix_array" });
+
+    defaults_.setValue("suffix_array_file", "", "Protein index for the 'suffix_array' backend. If the file exists and was built from the same database (and 'IL_equivalent' setting), it is used;"
+                                                " otherwise the index is built and written to this file. If empty, the index is built in memory for every run.");
+
     defaultsToParam_();
   }
 
@@ -271,6 +280,8 @@ using namespace std;
     aaa_max_ = static_cast<Int>(param_.getValue("aaa_max"));
     mm_max_ = static_cast<Int>(param_.getValue("mismatches_max"));
     allow_nterm_protein_cleavage_ = param_.getValue("allow_nterm_protein_cleavage").toBool();
+    use_suffix_array_ = (param_.getValue("backend") == "suffix_array");
+    suffix_array_file_ = param_.getValue("suffix_array_file").toString();
   }
 
 PeptideIndexing::ExitCodes PeptideIndexing::run(std::vector<FASTAFile::FASTAEntry>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids)
@@ -289,6 +300,11 @@ PeptideIndexing::ExitCodes PeptideIndexing::run(FASTAContainer<TFI_Vector>& prot
   return run_<TFI_Vector>(proteins, prot_ids, pep_ids);
 }
 
+PeptideIndexing::ExitCodes PeptideIndexing::run(FASTAContainer<TFI_Arena>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids)
+{
+  return run_<TFI_Arena>(proteins, prot_ids, pep_ids);
+}
+
 const String& PeptideIndexing::getDecoyString() const
 {
   return decoy_string_;
@@ -424,7 +440,144 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
   std::vector<std::string> protein_accessions; // protein index -> accession
 
   bool invalid_protein_sequence = false; // check for proteins with modifications, i.e. '[' or '(', and throw an exception
+  uint16_t count_j_proteins(0);
+  Size needle_count(0); // number of peptide sequences searched
 
+  if (use_suffix_array_)
+  { // new scope - forget data after search
+    /*
+        Suffix array (persistent index over the whole database)
+    */
+    SysInfo::MemUsage mu;
+    StopWatch s;
+    s.start();
+    // the index needs all proteins at once
+    StringList sequences;
+    while (proteins.activateCache())
+    {
+      for (Size i = 0; i < proteins.chunkSize(); ++i)
+      {
+        const FASTAFile::FASTAEntry& entry = proteins.chunkAt(i);
+        protein_accessions.push_back(entry.identifier);
+        protein_is_decoy.push_back(prefix_ ? entry.identifier.hasPrefix(decoy_string_) : entry.identifier.hasSuffix(decoy_string_));
+        invalid_protein_sequence |= (entry.sequence.has('[') || entry.sequence.has('('));
+        if (!IL_equivalent_ && entry.sequence.has('J'))
+        {
+          ++count_j_proteins;
+        }
+        sequences.push_back(entry.sequence);
+      }
+      proteins.cacheChunk(PROTEIN_CACHE_SIZE);
+    }
+
+    ProteinSuffixArray index;
+    bool index_loaded = false;
+    if (!suffix_array_file_.empty() && File::exists(suffix_array_file_))
+    {
+      OPENMS_LOG_INFO << "Loading protein index from '" << suffix_array_file_ << "' ..." << std::endl;
+      index.load(suffix_array_file_);
+      index_loaded = index.isIndexOf(sequences, IL_equivalent_);
+      if (!index_loaded)
+      {
+        OPENMS_LOG_WARN << "Warning: The protein index '" << suffix_array_file_ << "' does not match the database (or 'IL_equivalent' setting). Rebuilding it." << std::endl;
+      }
+    }
+    if (!index_loaded)
+    {
+      OPENMS_LOG_INFO << "Building protein index ...";
+      index.build(sequences, IL_equivalent_);
+      OPENMS_LOG_INFO << " done (" << int(s.getClockTime()) << "s)" << std::endl;
+      if (!suffix_array_file_.empty())
+      {
+        index.store(suffix_array_file_);
+      }
+    }
+    // normalized sequences (as searched) are used for checking the enzyme cutting rules
+    for (Size i = 0; i < sequences.size(); ++i)
+    {
+      sequences[i] = index.getSequence(i).getString();
+    }
+
+    // the peptides (in order of their hits)
+    StringList peptides;
+    for (const auto& pep : pep_ids)
+    {
+      for (const auto& hit : pep.getHits())
+      {
+        String seq = hit.getSequence().toUnmodifiedString().remove('*');
+        for (const char c : seq)
+        {
+          if (!AA(c).isValidForPeptide())
+          {
+            throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, std::string("Invalid amino acid"), std::string(1, c));
+          }
+        }
+        peptides.push_back(seq);
+      }
+    }
+    needle_count = peptides.size();
+    if (needle_count == 0)
+    {
+      OPENMS_LOG_WARN << "Warning: Peptide identifications have no hits inside! Output will be empty as well." << std::endl;
+      return PEPTIDE_IDS_EMPTY;
+    }
+    OPENMS_LOG_INFO << "Mapping " << needle_count << " peptides to " << index.size() << " proteins." << std::endl;
+    OPENMS_LOG_INFO << "Searching with up to " << aaa_max_ << " ambiguous amino acid(s) and " << mm_max_ << " mismatch(es)!" << std::endl;
+
+    std::vector<bool> protein_found(index.size(), false);
+    this->startProgress(0, needle_count, "Suffix array");
+    std::atomic<int> progress_peps(0);
+    #pragma omp parallel
+    {
+      FoundProteinFunctor func_threads(enzyme, xtandem_fix_parameters);
+      std::vector<ProteinSuffixArray::Match> matches;
+      std::vector<Hit::T> found_thread; // proteins with hits (valid or not)
+
+      #pragma omp for schedule(dynamic, 100) nowait
+      for (SignedSize i = 0; i < (SignedSize)needle_count; ++i)
+      {
+        ++progress_peps; // atomic
+        #ifdef _OPENMP // without OMP, we always set progress
+        if (omp_get_thread_num() == 0)
+        #endif
+        {
+          this->setProgress(progress_peps);
+        }
+
+        const Hit::T len = Hit::T(peptides[i].size());
+        index.findAll(peptides[i], aaa_max_, mm_max_, matches);
+        for (const auto& m : matches)
+        {
+          const String& prot = sequences[m.protein];
+          func_threads.addHit(func_threads.validate(prot, m.position, len, allow_nterm_protein_cleavage_), Hit::T(i), m.protein, len, prot, m.position);
+          found_thread.push_back(m.protein);
+        }
+      }
+
+      #pragma omp critical(PeptideIndexer_joinSA)
+      {
+        func.merge(func_threads);
+        for (const Hit::T prot_idx : found_thread)
+        {
+          protein_found[prot_idx] = true;
+        }
+      }
+    } // OMP end parallel
+    this->endProgress();
+    std::sort(func.pep_to_prot.begin(), func.pep_to_prot.end());
+    for (Size i = 0; i < protein_found.size(); ++i)
+    {
+      if (protein_found[i])
+      {
+        acc_to_prot[protein_accessions[i]] = i;
+      }
+    }
+    s.stop();
+    OPENMS_LOG_INFO << "Suffix array search took: " << s.toString() << "\n";
+    mu.after();
+    OPENMS_LOG_INFO << mu.delta("Suffix array") << "\n\n";
+  } // end local scope
+  else
   { // new scope - forget data after search
     /*
         Aho Corasick (fast)
@@ -454,6 +607,7 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
     }
     s.stop();
     OPENMS_LOG_INFO << " done (" << int(s.getClockTime()) << "s)" << std::endl;
+    needle_count = ac_trie.getNeedleCount();
     if (ac_trie.getNeedleCount() == 0)
     { // Aho-Corasick will crash if given empty needles as input
       OPENMS_LOG_WARN << "Warning: Peptide identifications have no hits inside! Output will be empty as well." << std::endl;
@@ -470,7 +624,6 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
 
     OPENMS_LOG_INFO << "Searching with up to " << aaa_max_ << " ambiguous amino acid(s) and " << mm_max_ << " mismatch(es)!" << std::endl;
 
-    uint16_t count_j_proteins(0);
     bool has_active_data = true; // becomes false if end of FASTA file is reached
     const std::string jumpX(aaa_max_ + mm_max_ + 1, 'X'); // jump over stretches of 'X' which cost a lot of time; +1 because AXXA is a valid hit for aaa_max == 2 (cannot split it)
     // use very large target value for progress if DB size is unknown (did not fit into first chunk)
@@ -601,37 +754,36 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
     std::cout << "Merge took: " << s.toString() << "\n";
     mu.after();
     std::cout << mu.delta("Aho-Corasick") << "\n\n";
-    
+  } // end local scope
+
+  {
+    // count number of peptides found
+    // the vector 'pep_to_prot' is sorted by peptide_index, and then by protein_index 
+    size_t found_peptide_count{0};
+    Hit::T last_peptide_idx = -1;
+    for (const auto& hit : func.pep_to_prot)
     {
-      // count number of peptides found
-      // the vector 'pep_to_prot' is sorted by peptide_index, and then by protein_index 
-      size_t found_peptide_count{0};
-      Hit::T last_peptide_idx = -1;
-      for (const auto& hit : func.pep_to_prot)
+      if (hit.peptide_index != last_peptide_idx)
       {
-        if (hit.peptide_index != last_peptide_idx)
-        {
-          last_peptide_idx = hit.peptide_index;
-          ++found_peptide_count;
-        }
+        last_peptide_idx = hit.peptide_index;
+        ++found_peptide_count;
       }
-
-      OPENMS_LOG_INFO << "\nAho-Corasick done:\n  found " << func.filter_passed << " hits for " << found_peptide_count << " of " << ac_trie.getNeedleCount() << " peptides.\n";
     }
-    
-    // write some stats
-    OPENMS_LOG_INFO << "Peptide hits passing enzyme filter: " << func.filter_passed << "\n"
-                    << "     ... rejected by enzyme filter: " << func.filter_rejected << std::endl;
 
-    if (count_j_proteins)
-    {
-      OPENMS_LOG_WARN << "PeptideIndexer found " << count_j_proteins << " protein sequences in your database containing the amino acid 'J'."
-        << "To match 'J' in a protein, an ambiguous amino acid placeholder for I/L will be used.\n"
-        << "This costs runtime and eats into the 'aaa_max' limit, leaving less opportunity for B/Z/X matches.\n"
-        << "If you want 'J' to be treated as unambiguous, enable '-IL_equivalent'!" << std::endl;
-    }
+    OPENMS_LOG_INFO << "\n" << (use_suffix_array_ ? "Suffix array" : "Aho-Corasick") << " done:\n  found " << func.filter_passed << " hits for " << found_peptide_count << " of " << needle_count << " peptides.\n";
+  }
+  
+  // write some stats
+  OPENMS_LOG_INFO << "Peptide hits passing enzyme filter: " << func.filter_passed << "\n"
+                  << "     ... rejected by enzyme filter: " << func.filter_rejected << std::endl;
 
-  } // end local scope
+  if (count_j_proteins)
+  {
+    OPENMS_LOG_WARN << "PeptideIndexer found " << count_j_proteins << " protein sequences in your database containing the amino acid 'J'."
+      << "To match 'J' in a protein, an ambiguous amino acid placeholder for I/L will be used.\n"
+      << "This costs runtime and eats into the 'aaa_max' limit, leaving less opportunity for B/Z/X matches.\n"
+      << "If you want 'J' to be treated as unambiguous, enable '-IL_equivalent'!" << std::endl;
+  }
 
   //
   //   do mapping 
@@ -0,0 +1,511 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/ProteinSuffixArray.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char SUFFIX_ARRAY_MAGIC[8] = {'O', 'M', 'S', 'P', 'R', 'T', 'S', 'A'};
+    const UInt32 SUFFIX_ARRAY_VERSION = 1;
+    const UInt32 SUFFIX_ARRAY_BOM = 0x01020304;
+
+    /// separates the proteins in the text
+    const char TERMINATOR = '\0';
+
+    /// Appends 8 byte aligned sections to an index image
+    class ImageWriter_
+    {
+    public:
+      explicit ImageWriter_(vector<char>& image) :
+        image_(image)
+      {
+      }
+
+      void append(const void* data, Size size)
+      {
+        const char* begin = static_cast<const char*>(data);
+        image_.insert(image_.end(), begin, begin + size);
+      }
+
+      template <typename T>
+      void section(const T* data, Size count)
+      {
+        const UInt64 bytes = count * sizeof(T);
+        append(&bytes, sizeof(bytes));
+        if (bytes > 0)
+        {
+          append(data, bytes);
+        }
+        image_.resize((image_.size() + 7) / 8 * 8, 0);
+      }
+
+    private:
+      vector<char>& image_;
+    };
+
+    /// Reads the sections of an index image (with bounds checks)
+    class ImageReader_
+    {
+    public:
+      ImageReader_(const char* data, Size size, const String& filename) :
+        data_(data), size_(size), filename_(filename)
+      {
+      }
+
+      void read(void* target, Size size)
+      {
+        check_(size);
+        memcpy(target, data_ + pos_, size);
+        pos_ += size;
+      }
+
+      /// returns the start of the next section, which must contain @p expected_count elements
+      template <typename T>
+      const T* section(Size expected_count, const char* name)
+      {
+        UInt64 bytes;
+        read(&bytes, sizeof(bytes));
+        check_(bytes);
+        if (bytes != expected_count * sizeof(T))
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, String("Corrupt protein index (unexpected size of section '") + name + "').");
+        }
+        const char* begin = data_ + pos_;
+        pos_ = min(size_, Size((pos_ + bytes + 7) / 8 * 8));
+        return reinterpret_cast<const T*>(begin);
+      }
+
+    private:
+      void check_(Size size) const
+      {
+        if (size > size_ - pos_)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Unexpected end of protein index.");
+        }
+      }
+
+      const char* data_;
+      Size size_;
+      Size pos_ = 0;
+      const String& filename_;
+    };
+
+    vector<char> createImage_(bool IL_equivalent, const vector<UInt64>& protein_offsets, const string& text, const vector<UInt32>& suffix_array)
+    {
+      vector<char> image;
+      image.reserve(64 + protein_offsets.size() * sizeof(UInt64) + text.size() + suffix_array.size() * sizeof(UInt32));
+      ImageWriter_ writer(image);
+      const UInt32 flags = IL_equivalent ? 1 : 0;
+      const UInt32 reserved = 0;
+      const UInt64 n_proteins = protein_offsets.size() - 1;
+      writer.append(SUFFIX_ARRAY_MAGIC, sizeof(SUFFIX_ARRAY_MAGIC));
+      writer.append(&SUFFIX_ARRAY_VERSION, sizeof(SUFFIX_ARRAY_VERSION));
+      writer.append(&SUFFIX_ARRAY_BOM, sizeof(SUFFIX_ARRAY_BOM));
+      writer.append(&flags, sizeof(flags));
+      writer.append(&reserved, sizeof(reserved));
+      writer.append(&n_proteins, sizeof(n_proteins));
+      writer.section(protein_offsets.data(), protein_offsets.size());
+      writer.section(text.data(), text.size());
+      writer.section(suffix_array.data(), suffix_array.size());
+      return image;
+    }
+
+    /**
+      @brief Sorts the suffixes of @p text by prefix doubling (with counting sort in each round)
+
+      Each terminator is given its own rank (in order of occurrence), so
+      suffixes are only compared up to the end of their protein and the number
+      of rounds is logarithmic in the length of the longest protein (not in the
+      length of the longest repeat, e.g. duplicated proteins).
+    */
+    vector<UInt32> buildSuffixArray_(const string& text, Size n_terminators)
+    {
+      const Size n = text.size();
+      vector<UInt32> sa(n), rank(n), tmp(n), new_rank(n), count;
+      if (n == 0)
+      {
+        return sa;
+      }
+
+      // initial ranks: terminators first (by position), then all other characters
+      Size terminator = 0;
+      for (Size i = 0; i < n; ++i)
+      {
+        rank[i] = UInt32(text[i] == TERMINATOR ? terminator++ : n_terminators + (unsigned char)text[i]);
+      }
+      count.assign(n_terminators + 256, 0);
+      for (Size i = 0; i < n; ++i)
+      {
+        ++count[rank[i]];
+      }
+      for (Size i = 1; i < count.size(); ++i)
+      {
+        count[i] += count[i - 1];
+      }
+      for (Size i = n; i > 0; --i)
+      {
+        sa[--count[rank[i - 1]]] = UInt32(i - 1);
+      }
+      Size classes = 1;
+      new_rank[sa[0]] = 0;
+      for (Size i = 1; i < n; ++i)
+      {
+        if (rank[sa[i]] != rank[sa[i - 1]])
+        {
+          ++classes;
+        }
+        new_rank[sa[i]] = UInt32(classes - 1);
+      }
+      rank.swap(new_rank);
+
+      // double the length of the sorted prefixes until all ranks are unique
+      for (Size h = 1; classes < n; h <<= 1)
+      {
+        // sort by the rank of the second half (the order of sa) ...
+        for (Size i = 0; i < n; ++i)
+        {
+          tmp[i] = UInt32(sa[i] >= h ? sa[i] - h : sa[i] + n - h);
+        }
+        // ... then (stable) by the rank of the first half
+        count.assign(classes, 0);
+        for (Size i = 0; i < n; ++i)
+        {
+          ++count[rank[tmp[i]]];
+        }
+        for (Size i = 1; i < classes; ++i)
+        {
+          count[i] += count[i - 1];
+        }
+        for (Size i = n; i > 0; --i)
+        {
+          sa[--count[rank[tmp[i - 1]]]] = tmp[i - 1];
+        }
+        classes = 1;
+        new_rank[sa[0]] = 0;
+        for (Size i = 1; i < n; ++i)
+        {
+          const Size cur = sa[i], prev = sa[i - 1];
+          if (rank[cur] != rank[prev] || rank[(cur + h) % n] != rank[(prev + h) % n])
+          {
+            ++classes;
+          }
+          new_rank[sa[i]] = UInt32(classes - 1);
+        }
+        rank.swap(new_rank);
+      }
+      return sa;
+    }
+
+    /// is the (upper case) protein residue @p ambiguous an ambiguous amino acid which stands for @p aa?
+    bool ambiguousMatch_(char ambiguous, char aa)
+    {
+      switch (ambiguous)
+      {
+        case 'B': return aa == 'D' || aa == 'N';
+        case 'J': return aa == 'I' || aa == 'L';
+        case 'Z': return aa == 'E' || aa == 'Q';
+        case 'X': return aa >= 'A' && aa <= 'Z' && aa != 'B' && aa != 'J' && aa != 'Z' && aa != 'X';
+        default: return false;
+      }
+    }
+  }
+
+  ProteinSuffixArray::ProteinSuffixArray() :
+    buffer_(createImage_(false, vector<UInt64>(1, 0), string(), vector<UInt32>()))
+  {
+    attach_(buffer_.data(), buffer_.size(), "");
+  }
+
+  String ProteinSuffixArray::normalize(const String& protein, bool IL_equivalent)
+  {
+    String result;
+    result.reserve(protein.size());
+    for (char c : protein)
+    {
+      if (c == '*')
+      {
+        continue;
+      }
+      c = char(toupper((unsigned char)c));
+      if (IL_equivalent && (c == 'L' || c == 'J'))
+      {
+        c = 'I';
+      }
+      result.push_back(c);
+    }
+    return result;
+  }
+
+  void ProteinSuffixArray::build(const StringList& proteins, bool IL_equivalent)
+  {
+    string text;
+    vector<UInt64> protein_offsets(1, 0);
+    protein_offsets.reserve(proteins.size() + 1);
+    for (const String& protein : proteins)
+    {
+      text += normalize(protein, IL_equivalent);
+      text.push_back(TERMINATOR);
+      protein_offsets.push_back(text.size());
+      if (text.size() >= Size(numeric_limits<UInt32>::max()))
+      {
+        throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, text.size());
+      }
+    }
+
+    vector<char> image;
+    {
+      const vector<UInt32> suffix_array = buildSuffixArray_(text, proteins.size());
+      image = createImage_(IL_equivalent, protein_offsets, text, suffix_array);
+    }
+    ProteinSuffixArray index;
+    index.buffer_.swap(image);
+    index.attach_(index.buffer_.data(), index.buffer_.size(), "");
+    *this = std::move(index);
+  }
+
+  void ProteinSuffixArray::store(const String& filename) const
+  {
+    ofstream ofs(filename.c_str(), ios::out | ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ofs.write(image_, image_size_);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error writing protein index.");
+    }
+  }
+
+  void ProteinSuffixArray::load(const String& filename)
+  {
+    ProteinSuffixArray index;
+    index.file_.open(filename);
+    index.attach_(index.file_.data(), index.file_.size(), filename);
+    *this = std::move(index);
+  }
+
+  void ProteinSuffixArray::attach_(const char* data, Size size, const String& filename)
+  {
+    ImageReader_ reader(data, size, filename);
+
+    char magic[sizeof(SUFFIX_ARRAY_MAGIC)];
+    UInt32 version, bom, flags, reserved;
+    UInt64 n_proteins;
+    reader.read(magic, sizeof(magic));
+    if (memcmp(magic, SUFFIX_ARRAY_MAGIC, sizeof(magic)) != 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File is not a protein index.");
+    }
+    reader.read(&version, sizeof(version));
+    reader.read(&bom, sizeof(bom));
+    if (version != SUFFIX_ARRAY_VERSION || bom != SUFFIX_ARRAY_BOM)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+                                  "Unsupported protein index version or byte order (version " + String(version) + ").");
+    }
+    reader.read(&flags, sizeof(flags));
+    reader.read(&reserved, sizeof(reserved));
+    reader.read(&n_proteins, sizeof(n_proteins));
+    if (flags > 1 || n_proteins >= size / sizeof(UInt64))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt protein index.");
+    }
+    const UInt64* protein_offsets = reader.section<UInt64>(n_proteins + 1, "protein offsets");
+    const Size text_size = protein_offsets[n_proteins];
+    if (text_size >= Size(numeric_limits<UInt32>::max()) || text_size > size)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt protein index.");
+    }
+    const char* text = reader.section<char>(text_size, "text");
+    const UInt32* suffix_array = reader.section<UInt32>(text_size, "suffix array");
+
+    // every protein must end with a terminator, and the suffix array must point into the text
+    bool consistent = protein_offsets[0] == 0;
+    for (Size i = 0; consistent && i < n_proteins; ++i)
+    {
+      consistent = protein_offsets[i] < protein_offsets[i + 1] && text[protein_offsets[i + 1] - 1] == TERMINATOR;
+    }
+    consistent = consistent && all_of(suffix_array, suffix_array + text_size, [text_size](UInt32 i) { return i < text_size; });
+    if (!consistent)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt protein index.");
+    }
+
+    image_ = data;
+    image_size_ = size;
+    IL_equivalent_ = flags == 1;
+    n_proteins_ = n_proteins;
+    text_size_ = text_size;
+    protein_offsets_ = protein_offsets;
+    text_ = text;
+    suffix_array_ = suffix_array;
+  }
+
+  bool ProteinSuffixArray::isILEquivalent() const
+  {
+    return IL_equivalent_;
+  }
+
+  Size ProteinSuffixArray::size() const
+  {
+    return n_proteins_;
+  }
+
+  StringView ProteinSuffixArray::getSequence(Size index) const
+  {
+    return StringView(text_ + protein_offsets_[index], protein_offsets_[index + 1] - protein_offsets_[index] - 1);
+  }
+
+  bool ProteinSuffixArray::isIndexOf(const StringList& proteins, bool IL_equivalent) const
+  {
+    if (IL_equivalent != IL_equivalent_ || proteins.size() != n_proteins_)
+    {
+      return false;
+    }
+    for (Size i = 0; i < n_proteins_; ++i)
+    {
+      const String seq = normalize(proteins[i], IL_equivalent);
+      const StringView indexed = getSequence(i);
+      if (seq.size() != indexed.size() || memcmp(seq.data(), text_ + protein_offsets_[i], seq.size()) != 0)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void ProteinSuffixArray::findAll(const String& peptide, UInt32 max_aaa, UInt32 max_mm, vector<Match>& matches) const
+  {
+    matches.clear();
+    if (peptide.empty())
+    {
+      return;
+    }
+    if (IL_equivalent_)
+    {
+      String pep(peptide);
+      pep.substitute('L', 'I');
+      search_(pep, 0, 0, text_size_, max_aaa, max_mm, matches);
+    }
+    else
+    {
+      search_(peptide, 0, 0, text_size_, max_aaa, max_mm, matches);
+    }
+    sort(matches.begin(), matches.end());
+  }
+
+  void ProteinSuffixArray::search_(const String& peptide, Size depth, Size lo, Size hi, UInt32 aaa_left, UInt32 mm_left, vector<Match>& matches) const
+  {
+    if (lo >= hi)
+    {
+      return;
+    }
+    if (depth == peptide.size())
+    {
+      for (Size k = lo; k < hi; ++k)
+      {
+        const UInt64 pos = suffix_array_[k];
+        const UInt64* protein = upper_bound(protein_offsets_, protein_offsets_ + n_proteins_ + 1, pos) - 1;
+        matches.push_back({UInt32(protein - protein_offsets_), UInt32(pos - *protein)});
+      }
+      return;
+    }
+
+    const char aa = peptide[depth];
+    // exact match
+    {
+      Size l = lo, h = hi;
+      narrow_(depth, aa, l, h);
+      search_(peptide, depth + 1, l, h, aaa_left, mm_left, matches);
+    }
+    if (aaa_left == 0 && mm_left == 0)
+    {
+      return;
+    }
+    // ambiguous amino acids in the protein (cost an AAA, or a mismatch if no AAA's are left) and mismatches
+    static const char ambiguous[] = "BJZX";
+    static const char residues[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    for (const char* it = (mm_left > 0 ? residues : ambiguous); *it != 0; ++it)
+    {
+      const char residue = *it;
+      if (residue == aa)
+      {
+        continue;
+      }
+      UInt32 aaa = aaa_left, mm = mm_left;
+      if (ambiguousMatch_(residue, aa) && aaa > 0)
+      {
+        --aaa;
+      }
+      else if (mm > 0)
+      {
+        --mm;
+      }
+      else
+      {
+        continue;
+      }
+      Size l = lo, h = hi;
+      narrow_(depth, residue, l, h);
+      search_(peptide, depth + 1, l, h, aaa, mm, matches);
+    }
+  }
+
+  void ProteinSuffixArray::narrow_(Size depth, char aa, Size& lo, Size& hi) const
+  {
+    // residue at offset 'depth' of suffix 'pos' (all suffixes in [lo, hi) share their first 'depth' residues, which are not terminators)
+    auto residue = [this, depth](UInt32 pos) -> unsigned char
+    {
+      return pos + depth < text_size_ ? (unsigned char)text_[pos + depth] : 0;
+    };
+    const unsigned char c = (unsigned char)aa;
+    const UInt32* first = lower_bound(suffix_array_ + lo, suffix_array_ + hi, c, [&residue](UInt32 pos, unsigned char value) { return residue(pos) < value; });
+    const UInt32* last = upper_bound(first, suffix_array_ + hi, c, [&residue](unsigned char value, UInt32 pos) { return value < residue(pos); });
+    lo = first - suffix_array_;
+    hi = last - suffix_array_;
+  }
+
+} // namespace OpenMS
@@ -34,12 +34,16 @@
 
 #include <OpenMS/ANALYSIS/ID/SimpleSearchEngineAlgorithm.h>
 
+#include <OpenMS/ANALYSIS/ID/FNVHash.h>
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
 #include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
 #include <OpenMS/CHEMISTRY/DecoyGenerator.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CHEMISTRY/ProteaseDB.h>
 #include <OpenMS/CHEMISTRY/ResidueModification.h>
+#include <OpenMS/CHEMISTRY/SimpleTSG.h>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
 #include <OpenMS/COMPARISON/SPECTRA/SpectrumAlignment.h>
 #include <OpenMS/CONCEPT/Constants.h>
@@ -61,6 +65,7 @@
 #include <OpenMS/MATH/MISC/MathFunctions.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
 #include <OpenMS/METADATA/SpectrumSettings.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include <algorithm>
 #include <map>
@@ -146,6 +151,22 @@ namespace OpenMS
     defaults_.setValue("report:top_hits", 1, "Maximum number of top scoring hits per spectrum that are reported.");
     defaults_.setSectionDescription("report", "Reporting Options");
 
+    defaults_.setValue("fragment_index:enabled", "false", "Use a fragment ion index to preselect, for each spectrum, the candidate peptides sharing most fragments with it. Only these candidates are scored, which makes searches with wide precursor windows (e.g. open searches) feasible.");
+    defaults_.setValidStrings("fragment_index:enabled", {"true","false"} );
+    defaults_.setValue("fragment_index:file", "", "If set, the fragment index is loaded from this file (if it exists and matches database and search settings) or otherwise built and stored there for reuse.");
+    defaults_.setValue("fragment_index:bin_width", 0.02, "Width of the fragment m/z bins of the index (in Th).");
+    defaults_.setMinFloat("fragment_index:bin_width", 0.0001);
+    defaults_.setValue("fragment_index:candidates", 50, "Maximum number of candidates (with most shared fragments) scored per spectrum.");
+    defaults_.setMinInt("fragment_index:candidates", 1);
+    defaults_.setValue("fragment_index:min_shared_peaks", 3, "Minimum number of fragments a candidate must share with the spectrum.");
+    defaults_.setMinInt("fragment_index:min_shared_peaks", 0);
+    defaults_.setValue("fragment_index:semi_specific", "false", "Also index semi-specific peptides, i.e. peptides with only one terminus at a cleavage site of the enzyme (or a protein terminus). This enlarges the index considerably.");
+    defaults_.setValidStrings("fragment_index:semi_specific", {"true","false"} );
+    defaults_.setSectionDescription("fragment_index", "Fragment Index Options");
+
+    defaults_.setValue("peptide_db:cache_dir", "", "If set, the digested and modified peptides of the database are stored in this directory and reused by later searches with the same database and digestion settings (see PeptideDatabaseBuilder). Not used with the fragment index.");
+    defaults_.setSectionDescription("peptide_db", "Peptide Database Options");
+
     defaultsToParam_();
   }
 
@@ -192,6 +213,15 @@ namespace OpenMS
 
     decoys_ = param_.getValue("decoys") == "true";
     annotate_psm_ = ListUtils::toStringList<std::string>(param_.getValue("annotate:PSM"));
+
+    fragment_index_enabled_ = param_.getValue("fragment_index:enabled") == "true";
+    fragment_index_file_ = param_.getValue("fragment_index:file").toString();
+    fragment_index_bin_width_ = param_.getValue("fragment_index:bin_width");
+    fragment_index_candidates_ = param_.getValue("fragment_index:candidates");
+    fragment_index_min_shared_peaks_ = param_.getValue("fragment_index:min_shared_peaks");
+    fragment_index_semi_specific_ = param_.getValue("fragment_index:semi_specific") == "true";
+
+    peptide_db_cache_dir_ = param_.getValue("peptide_db:cache_dir").toString();
   }
 
   // static
@@ -414,10 +444,383 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     // note: precursor error is calculated by percolator itself
     search_parameters.setMetaValue("extra_features", ListUtils::concatenate(feature_set, ","));
 
-    search_parameters.enzyme_term_specificity = EnzymaticDigestion::SPEC_FULL;
+    search_parameters.enzyme_term_specificity = (fragment_index_enabled_ && fragment_index_semi_specific_) ? EnzymaticDigestion::SPEC_SEMI : EnzymaticDigestion::SPEC_FULL;
     protein_ids[0].setSearchParameters(std::move(search_parameters));
   }
 
+  String SimpleSearchEngineAlgorithm::getFragmentIndexSignature_(const vector<FASTAFile::FASTAEntry>& fasta_db, const ProteaseDigestion& digestor) const
+  {
+    // FNV-1a hash of the protein sequences (in database order, i.e. including the decoys)
+    Internal::FNVHash hash;
+    for (const FASTAFile::FASTAEntry& e : fasta_db)
+    {
+      hash.add(e.sequence.data(), e.sequence.size());
+      hash.add('\n');
+    }
+
+    return "proteins=" + String(fasta_db.size())
+      + ";hash=" + String(hash.getHash())
+      + ";enzyme=" + digestor.getEnzymeName()
+      + ";missed_cleavages=" + String(digestor.getMissedCleavages())
+      + ";min_size=" + String(peptide_min_size_)
+      + ";max_size=" + String(peptide_max_size_)
+      + ";specificity=" + (fragment_index_semi_specific_ ? "semi" : "full")
+      + ";motif=" + peptide_motif_
+      + ";fixed=" + ListUtils::concatenate(modifications_fixed_, ",")
+      + ";variable=" + ListUtils::concatenate(modifications_variable_, ",")
+      + ";max_variable=" + String(modifications_max_variable_mods_per_peptide_)
+      + ";bin_width=" + String(fragment_index_bin_width_);
+  }
+
+  void SimpleSearchEngineAlgorithm::addHit_(vector<AnnotatedHit_>& hits, AnnotatedHit_&& hit, Size top_hits)
+  {
+    hits.push_back(std::move(hit));
+
+    // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
+    if (hits.size() >= 2 * top_hits)
+    {
+      std::partial_sort(hits.begin(), hits.begin() + top_hits, hits.end(), AnnotatedHit_::hasBetterScore);
+      hits.resize(top_hits);
+    }
+  }
+
+  void SimpleSearchEngineAlgorithm::mergeHits_(LocalHits_& local_hits, vector<vector<AnnotatedHit_> >& annotated_hits, Size top_hits)
+  {
+    for (auto& scan_hits : local_hits)
+    {
+      vector<AnnotatedHit_>& hits = annotated_hits[scan_hits.first];
+      std::move(scan_hits.second.begin(), scan_hits.second.end(), back_inserter(hits));
+
+      // hasBetterScore is a total order, so the retained hits don't depend on the merge order of the threads
+      if (hits.size() > top_hits)
+      {
+        std::partial_sort(hits.begin(), hits.begin() + top_hits, hits.end(), AnnotatedHit_::hasBetterScore);
+        hits.resize(top_hits);
+      }
+    }
+    local_hits.clear();
+  }
+
+  SimpleSearchEngineAlgorithm::ModificationTable_::ModificationTable_(const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+    const ModifiedPeptideGenerator::MapToResidueType& variable_modifications)
+  {
+    for (const ModifiedPeptideGenerator::MapToResidueType* mods : {&fixed_modifications, &variable_modifications})
+    {
+      for (const auto& mr : mods->val)
+      {
+        // the text of a residue modification starts with the residue, that of a terminal modification with '.'
+        if (mr.first->getTermSpecificity() == ResidueModification::ANYWHERE)
+        {
+          residues_[mr.first->toString()] = mr.second;
+        }
+        else
+        {
+          terminal_modifications_[mr.first->toString()] = mr.first;
+        }
+      }
+    }
+  }
+
+  AASequence SimpleSearchEngineAlgorithm::ModificationTable_::getCandidate(const String& unmodified_sequence, const String& modified_sequence) const
+  {
+    AASequence candidate = AASequence::fromString(unmodified_sequence);
+    if (modified_sequence.size() == unmodified_sequence.size())
+    {
+      return candidate;
+    }
+
+    Size residue_index = 0;
+    for (Size i = 0; i < modified_sequence.size(); )
+    {
+      // a token is a one letter code or '.', optionally followed by a modification in (nested) brackets
+      Size token_end = i + 1;
+      if (token_end < modified_sequence.size() && (modified_sequence[token_end] == '(' || modified_sequence[token_end] == '['))
+      {
+        const char open = modified_sequence[token_end];
+        const char close = open == '(' ? ')' : ']';
+        Size depth = 0;
+        for (; token_end < modified_sequence.size(); ++token_end)
+        {
+          if (modified_sequence[token_end] == open)
+          {
+            ++depth;
+          }
+          else if (modified_sequence[token_end] == close && --depth == 0)
+          {
+            break;
+          }
+        }
+        ++token_end;
+      }
+
+      if (modified_sequence[i] == '.')
+      {
+        auto it = terminal_modifications_.find(modified_sequence.substr(i, token_end - i));
+        if (it == terminal_modifications_.end())
+        {
+          return AASequence::fromString(modified_sequence);
+        }
+        if (residue_index == 0)
+        {
+          candidate.setNTerminalModification(it->second);
+        }
+        else
+        {
+          candidate.setCTerminalModification(it->second);
+        }
+      }
+      else
+      {
+        if (token_end - i > 1)
+        {
+          auto it = residues_.find(modified_sequence.substr(i, token_end - i));
+          if (it == residues_.end() || residue_index >= candidate.size())
+          {
+            return AASequence::fromString(modified_sequence);
+          }
+          candidate.setModification(residue_index, it->second);
+        }
+        ++residue_index;
+      }
+      i = token_end;
+    }
+    return candidate;
+  }
+
+  void SimpleSearchEngineAlgorithm::digestDatabase_(const vector<FASTAFile::FASTAEntry>& fasta_db,
+    const ProteaseDigestion& digestor,
+    bool semi_specific,
+    const boost::regex& peptide_motif_regex,
+    vector<StringView>& peptides) const
+  {
+    peptides.clear();
+
+#pragma omp parallel default(none) shared(fasta_db, digestor, semi_specific, peptide_motif_regex, peptides)
+    {
+      vector<StringView> local_peptides;
+
+#pragma omp for schedule(dynamic, 100) nowait
+      for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+      {
+        vector<StringView> current_digest;
+        if (!semi_specific)
+        {
+          digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
+        }
+        else
+        {
+          // a semi-specific peptide starts (or ends) at a cleavage site and contains at most as many missed cleavages as
+          // the fully specific peptide ending (or starting) at the next cleavage site: it is a prefix (or suffix) of that peptide
+          vector<StringView> specific_digest;
+          digestor.digestUnmodified(fasta_db[fasta_index].sequence, specific_digest, peptide_min_size_, 0);
+          for (const StringView& c : specific_digest)
+          {
+            const Size max_size = peptide_max_size_ == 0 ? c.size() : std::min(c.size(), peptide_max_size_);
+            for (Size size = peptide_min_size_; size <= max_size; ++size)
+            {
+              current_digest.push_back(c.substr(0, size));
+              if (size != c.size())
+              {
+                current_digest.push_back(c.substr(c.size() - size, size));
+              }
+            }
+          }
+        }
+        for (const StringView& c : current_digest)
+        {
+          const String current_peptide = c.getString();
+          if (current_peptide.find_first_of("XBZ") != std::string::npos)
+          {
+            continue;
+          }
+
+          // if a peptide motif is provided skip all peptides without match
+          if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
+          {
+            continue;
+          }
+          local_peptides.push_back(c);
+        }
+      }
+
+      #pragma omp critical (digest_database_merge)
+      {
+        peptides.insert(peptides.end(), local_peptides.begin(), local_peptides.end());
+      }
+    }
+
+    // peptides occurring in several proteins are scored only once (PeptideIndexing maps them back to all proteins)
+    sort(peptides.begin(), peptides.end());
+    peptides.erase(unique(peptides.begin(), peptides.end()), peptides.end());
+  }
+
+  void SimpleSearchEngineAlgorithm::buildFragmentIndex_(const vector<FASTAFile::FASTAEntry>& fasta_db,
+    const ProteaseDigestion& digestor,
+    const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+    const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+    const boost::regex& peptide_motif_regex,
+    FragmentIndex& index) const
+  {
+    // collect the unique peptides of all proteins
+    vector<StringView> peptides;
+    digestDatabase_(fasta_db, digestor, fragment_index_semi_specific_, peptide_motif_regex, peptides);
+
+    // same ions as the regular search, but generated without annotations
+    Param param(SimpleTSG().getParameters());
+    param.setValue("add_first_prefix_ion", "true");
+
+    vector<FragmentIndex::Peptide> indexed_peptides;
+    vector<vector<FragmentIndex::Fragment> > fragments;
+
+#pragma omp parallel default(none) shared(peptides, param, fixed_modifications, variable_modifications, indexed_peptides, fragments)
+    {
+      vector<FragmentIndex::Peptide> local_peptides;
+      vector<vector<FragmentIndex::Fragment> > local_fragments;
+
+      // one generator per thread: peptides are sorted, so consecutive candidates often share their prefix masses
+      SimpleTSG spectrum_generator;
+      spectrum_generator.setParameters(param);
+      vector<SimpleTSG::Fragment> theo_fragments;
+
+#pragma omp for schedule(dynamic, 100) nowait
+      for (SignedSize peptide_index = 0; peptide_index < (SignedSize)peptides.size(); ++peptide_index)
+      {
+        const String current_peptide = peptides[peptide_index].getString();
+        vector<AASequence> all_modified_peptides;
+
+        // no database lookups: unmodified residues come from ResidueDB's read-only one letter code table and
+        // the modified residues were resolved by getModifications() before the parallel region
+        AASequence aas = AASequence::fromString(current_peptide);
+        ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+        ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
+
+        for (Size mod_pep_idx = 0; mod_pep_idx < all_modified_peptides.size(); ++mod_pep_idx)
+        {
+          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+
+          // add peaks for b and y ions with charge 1
+          spectrum_generator.getSpectrum(theo_fragments, candidate, 1, 1);
+
+          vector<FragmentIndex::Fragment> current_fragments(theo_fragments.size());
+          for (Size i = 0; i != theo_fragments.size(); ++i)
+          {
+            current_fragments[i].mz = theo_fragments[i].mz;
+            current_fragments[i].intensity = theo_fragments[i].intensity;
+            current_fragments[i].ion_type = theo_fragments[i].ion_type;
+          }
+
+          FragmentIndex::Peptide p;
+          p.sequence = current_peptide;
+          p.modification_index = mod_pep_idx;
+          p.mass = candidate.getMonoWeight();
+          local_peptides.push_back(std::move(p));
+          local_fragments.push_back(std::move(current_fragments));
+        }
+      }
+
+      // the index orders peptides by mass, so the merge order does not matter
+      #pragma omp critical (fragment_index_merge)
+      {
+        std::move(local_peptides.begin(), local_peptides.end(), back_inserter(indexed_peptides));
+        std::move(local_fragments.begin(), local_fragments.end(), back_inserter(fragments));
+      }
+    }
+
+    index.build(std::move(indexed_peptides), fragments);
+  }
+
+  void SimpleSearchEngineAlgorithm::searchFragmentIndex_(const PeakMap& spectra,
+    const vector<HyperScore::PreparedSpectrum>& prepared_spectra,
+    const vector<vector<double> >& precursor_masses,
+    const FragmentIndex& index,
+    vector<vector<AnnotatedHit_> >& annotated_hits) const
+  {
+    bool precursor_mass_tolerance_unit_ppm = (precursor_mass_tolerance_unit_ == "ppm");
+    bool fragment_mass_tolerance_unit_ppm = (fragment_mass_tolerance_unit_ == "ppm");
+
+    // each thread processes whole spectra, so no locking of the hits is required
+#pragma omp parallel for schedule(dynamic, 10) default(none) shared(spectra, prepared_spectra, precursor_masses, index, annotated_hits, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm)
+    for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
+    {
+      const PeakSpectrum& exp_spectrum = spectra[scan_index];
+
+      // count shared fragments of all peptides in the precursor windows (one per isotope)
+      vector<pair<Size, Size> > candidates;
+      for (const double precursor_mass : precursor_masses[scan_index])
+      {
+        // peptide masses m with |precursor_mass - m| <= tolerance(m), as in the peptide-centric search
+        double min_mass, max_mass;
+        if (precursor_mass_tolerance_unit_ppm)
+        {
+          min_mass = precursor_mass / (1.0 + precursor_mass_tolerance_ * 1e-6);
+          max_mass = precursor_mass / (1.0 - precursor_mass_tolerance_ * 1e-6);
+        }
+        else
+        {
+          min_mass = precursor_mass - precursor_mass_tolerance_;
+          max_mass = precursor_mass + precursor_mass_tolerance_;
+        }
+        index.query(exp_spectrum, min_mass, max_mass, fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, fragment_index_min_shared_peaks_, candidates);
+      }
+      if (candidates.empty())
+      {
+        continue;
+      }
+
+      // overlapping isotope windows may report a peptide twice: keep its highest count
+      sort(candidates.begin(), candidates.end(),
+        [](const pair<Size, Size>& a, const pair<Size, Size>& b) { return a.first != b.first ? a.first < b.first : a.second > b.second; });
+      candidates.erase(unique(candidates.begin(), candidates.end(),
+        [](const pair<Size, Size>& a, const pair<Size, Size>& b) { return a.first == b.first; }), candidates.end());
+
+      // only score the candidates with most shared fragments (ties broken by id to stay deterministic)
+      if (candidates.size() > fragment_index_candidates_)
+      {
+        auto more_shared = [](const pair<Size, Size>& a, const pair<Size, Size>& b)
+        {
+          return a.second != b.second ? a.second > b.second : a.first < b.first;
+        };
+        nth_element(candidates.begin(), candidates.begin() + fragment_index_candidates_, candidates.end(), more_shared);
+        candidates.resize(fragment_index_candidates_);
+        sort(candidates.begin(), candidates.end());
+      }
+
+      // score all candidates of this spectrum in one batch
+      vector<PeakSpectrum> theo_spectra(candidates.size());
+      for (Size i = 0; i != candidates.size(); ++i)
+      {
+        index.getSpectrum(candidates[i].first, theo_spectra[i]);
+      }
+      vector<double> scores;
+      vector<HyperScore::PSMDetail> details;
+      HyperScore::computeBatch(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, prepared_spectra[scan_index], theo_spectra, scores, details);
+
+      for (Size i = 0; i != candidates.size(); ++i)
+      {
+        const double score = scores[i];
+        const HyperScore::PSMDetail& detail = details[i];
+
+        if (score == 0)
+        {
+          continue; // no hit?
+        }
+
+        const FragmentIndex::Peptide& peptide = index.getPeptide(candidates[i].first);
+
+        // add peptide hit
+        AnnotatedHit_ ah;
+        ah.sequence = StringView(peptide.sequence);
+        ah.peptide_mod_index = peptide.modification_index;
+        ah.score = score;
+        ah.prefix_fraction = (double)detail.matched_b_ions/(double)peptide.sequence.size();
+        ah.suffix_fraction = (double)detail.matched_y_ions/(double)peptide.sequence.size();
+        ah.mean_error = detail.mean_error;
+
+        addHit_(annotated_hits[scan_index], std::move(ah), report_top_hits_);
+      }
+    }
+  }
+
   SimpleSearchEngineAlgorithm::ExitCodes SimpleSearchEngineAlgorithm::search(const String& in_mzML, const String& in_db, vector<ProteinIdentification>& protein_ids, vector<PeptideIdentification>& peptide_ids) const
   {
     boost::regex peptide_motif_regex(peptide_motif_);
@@ -477,26 +880,22 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
       }
     }
 
-    // create spectrum generator
-    TheoreticalSpectrumGenerator spectrum_generator;
-    Param param(spectrum_generator.getParameters());
-    param.setValue("add_first_prefix_ion", "true");
-    param.setValue("add_metainfo", "true");
-    spectrum_generator.setParameters(param);
+    // fragment ions of the candidates: b and y ions as generated by TheoreticalSpectrumGenerator, but without building annotated spectra
+    Param spectrum_generator_param(SimpleTSG().getParameters());
+    spectrum_generator_param.setValue("add_first_prefix_ion", "true");
+
+    // bin the peaks of each spectrum once, so scoring against all candidates only needs table lookups
+    vector<HyperScore::PreparedSpectrum> prepared_spectra(spectra.size());
+#pragma omp parallel for default(none) shared(spectra, prepared_spectra)
+    for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
+    {
+      prepared_spectra[scan_index] = HyperScore::PreparedSpectrum(spectra[scan_index]);
+    }
 
     // preallocate storage for PSMs
     vector<vector<AnnotatedHit_> > annotated_hits(spectra.size(), vector<AnnotatedHit_>());
     for (auto & a : annotated_hits) { a.reserve(2 * report_top_hits_); }
 
-#ifdef _OPENMP
-    // we want to do locking at the spectrum level so we get good parallelization
-    vector<omp_lock_t> annotated_hits_lock(annotated_hits.size());
-    for (size_t i = 0; i != annotated_hits_lock.size(); i++)
-    { 
-      omp_init_lock(&(annotated_hits_lock[i]));
-    }
-#endif
-
     vector<FASTAFile::FASTAEntry> fasta_db;
     FASTAFile().load(in_db, fasta_db);
 
@@ -526,153 +925,276 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
       endProgress();
       digestor.setMissedCleavages(peptide_missed_cleavages_);
     }
-    startProgress(0, fasta_db.size(), "Scoring peptide models against spectra...");
-
-    // lookup for processed peptides. must be defined outside of omp section and synchronized
-    set<StringView> processed_petides;
-
-    Size count_proteins(0), count_peptides(0);
-
-#pragma omp parallel for schedule(static) default(none) shared(annotated_hits, spectrum_generator, multimap_mass_2_scan_index, fixed_modifications, variable_modifications, fasta_db, digestor, processed_petides, count_proteins, count_peptides, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm, peptide_motif_regex, spectra, annotated_hits_lock)
-      for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
-      {
-
-      #pragma omp atomic
-      ++count_proteins;
-
-      IF_MASTERTHREAD
+    // the fragment index and the peptide database own the peptide sequences referenced by the hits, so they must outlive post-processing
+    FragmentIndex fragment_index(fragment_index_bin_width_);
+    PeptideDatabase peptide_db;
+    if (fragment_index_enabled_)
+    {
+      const String signature = getFragmentIndexSignature_(fasta_db, digestor);
+      bool loaded = false;
+      if (!fragment_index_file_.empty() && File::exists(fragment_index_file_))
       {
-        setProgress(count_proteins);
-      }
-
-      vector<StringView> current_digest;
-      digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
-
-      for (auto const & c : current_digest)
-      { 
-        const String current_peptide = c.getString();
-        if (current_peptide.find_first_of("XBZ") != std::string::npos)
+        try
         {
-          continue;
+          fragment_index.load(fragment_index_file_);
+          loaded = fragment_index.getSignature() == signature;
         }
-
-        // if a peptide motif is provided skip all peptides without match
-        if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
+        catch (Exception::ParseError&)
         {
-          continue;
-        }          
-      
-        bool already_processed = false;
-        #pragma omp critical (processed_peptides_access)
+          // not a valid index file: rebuild and overwrite it below
+        }
+        if (!loaded)
         {
-          // peptide (and all modified variants) already processed so skip it
-          if (processed_petides.find(c) != processed_petides.end())
-          {
-            already_processed = true;
-          }
-          else
-          {
-            processed_petides.insert(c);
-          }
+          OPENMS_LOG_WARN << "Fragment index '" << fragment_index_file_ << "' does not match the database or search settings. Rebuilding it." << endl;
         }
+      }
 
-        // skip peptides that have already been processed
-        if (already_processed) { continue; }
+      if (!loaded)
+      {
+        startProgress(0, 1, "Building fragment index...");
+        fragment_index = FragmentIndex(fragment_index_bin_width_);
+        buildFragmentIndex_(fasta_db, digestor, fixed_modifications, variable_modifications, peptide_motif_regex, fragment_index);
+        fragment_index.setSignature(signature);
+        endProgress();
+        if (!fragment_index_file_.empty())
+        {
+          fragment_index.store(fragment_index_file_);
+        }
+      }
+      OPENMS_LOG_INFO << "Indexed peptides: " << fragment_index.size() << endl;
 
-        #pragma omp atomic
-        ++count_peptides;
+      // all (isotope corrected) precursor masses of each scan
+      vector<vector<double> > precursor_masses(spectra.size());
+      for (const auto& m : multimap_mass_2_scan_index)
+      {
+        precursor_masses[m.second].push_back(m.first);
+      }
 
-        vector<AASequence> all_modified_peptides;
+      startProgress(0, 1, "Scoring index candidates against spectra...");
+      searchFragmentIndex_(spectra, prepared_spectra, precursor_masses, fragment_index, annotated_hits);
+      endProgress();
+    }
+    else if (!peptide_db_cache_dir_.empty())
+    {
+      // the digested and modified peptides are reused from (or stored to) the cache directory
+      PeptideDatabase::Settings settings;
+      settings.enzyme = digestor.getEnzymeName();
+      settings.missed_cleavages = digestor.getMissedCleavages();
+      settings.min_size = peptide_min_size_;
+      settings.max_size = peptide_max_size_;
+      settings.fixed_modifications = modifications_fixed_;
+      settings.variable_modifications = modifications_variable_;
+      settings.max_variable_mods_per_peptide = modifications_max_variable_mods_per_peptide_;
+
+      startProgress(0, 1, "Loading peptide database...");
+      const bool cached = peptide_db.loadOrBuild(peptide_db_cache_dir_, fasta_db, settings);
+      endProgress();
+      OPENMS_LOG_INFO << (cached ? "Reusing" : "Created") << " peptide database '" << PeptideDatabase::getCacheFilename(peptide_db_cache_dir_, peptide_db.getKey()) << "'." << endl;
+      OPENMS_LOG_INFO << "Peptides: " << peptide_db.size() << endl;
 
-        // this critical section is because ResidueDB is not thread safe and new residues are created based on the PTMs
-        #pragma omp critical (residuedb_access)
-        {
-          AASequence aas = AASequence::fromString(current_peptide);
-          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
-          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
-        }
+      // resolved before the parallel region: rebuilding the candidates must not look up their modifications by name
+      const ModificationTable_ modification_table(fixed_modifications, variable_modifications);
 
-        for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
-        {
-          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
-          double current_peptide_mass = candidate.getMonoWeight();
+      startProgress(0, peptide_db.size(), "Scoring peptide models against spectra...");
+      Size count_peptides(0);
 
-          // determine MS2 precursors that match to the current peptide mass
-          multimap<double, Size>::const_iterator low_it;
-          multimap<double, Size>::const_iterator up_it;
+#pragma omp parallel default(none) shared(annotated_hits, spectrum_generator_param, multimap_mass_2_scan_index, peptide_db, modification_table, count_peptides, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm, peptide_motif_regex, prepared_spectra)
+      {
+        // best hits of this thread, merged into annotated_hits whenever they cover too many spectra and once all peptides are scored
+        LocalHits_ local_hits;
 
-          if (precursor_mass_tolerance_unit_ppm) // ppm
-          {
-            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
-            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
-          }
-          else // Dalton
+        // one generator per thread: it caches the ladders of the last candidate
+        SimpleTSG spectrum_generator;
+        spectrum_generator.setParameters(spectrum_generator_param);
+        vector<SimpleTSG::Fragment> theo_fragments;
+
+#pragma omp for schedule(dynamic, 1000) nowait
+        for (SignedSize db_index = 0; db_index < (SignedSize)peptide_db.size(); ++db_index)
+        {
+          #pragma omp atomic
+          ++count_peptides;
+
+          IF_MASTERTHREAD
           {
-            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - precursor_mass_tolerance_);
-            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + precursor_mass_tolerance_);
+            setProgress(count_peptides);
           }
 
+          // determine MS2 precursors that match to the current peptide mass (before creating any sequence objects)
+          const double current_peptide_mass = peptide_db.getMass(db_index);
+          const double tolerance = precursor_mass_tolerance_unit_ppm ? current_peptide_mass * precursor_mass_tolerance_ * 1e-6 : precursor_mass_tolerance_;
+          multimap<double, Size>::const_iterator low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - tolerance);
+          multimap<double, Size>::const_iterator up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + tolerance);
+
           // no matching precursor in data
           if (low_it == up_it)
-          { 
+          {
             continue;
           }
 
-          // create theoretical spectrum
-          PeakSpectrum theo_spectrum;
+          const StringView c = peptide_db.getSequence(db_index);
 
-          // add peaks for b and y ions with charge 1
-          spectrum_generator.getSpectrum(theo_spectrum, candidate, 1, 1);
+          // if a peptide motif is provided skip all peptides without match
+          if (!peptide_motif_.empty() && !boost::regex_match(c.getString(), peptide_motif_regex))
+          {
+            continue;
+          }
 
-          // sort by mz
-          theo_spectrum.sortByPosition();
+          const AASequence candidate = modification_table.getCandidate(c.getString(), peptide_db.getModifiedSequence(db_index).getString());
+
+          // b and y ions with charge 1, sorted by m/z
+          spectrum_generator.getSpectrum(theo_fragments, candidate, 1, 1);
 
           for (; low_it != up_it; ++low_it)
           {
             const Size& scan_index = low_it->second;
-            const PeakSpectrum& exp_spectrum = spectra[scan_index];
-            // const int& charge = exp_spectrum.getPrecursors()[0].getCharge();
             HyperScore::PSMDetail detail;
-            const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum, detail);
+            const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, prepared_spectra[scan_index], theo_fragments, detail);
 
             if (score == 0)
-            { 
+            {
               continue; // no hit?
             }
             // add peptide hit
             AnnotatedHit_ ah;
             ah.sequence = c;
-            ah.peptide_mod_index = mod_pep_idx;
+            ah.peptide_mod_index = peptide_db.getModificationIndex(db_index);
             ah.score = score;
             ah.prefix_fraction = (double)detail.matched_b_ions/(double)c.size();
             ah.suffix_fraction = (double)detail.matched_y_ions/(double)c.size();
-            ah.mean_error = detail.mean_error;            
+            ah.mean_error = detail.mean_error;
 
-#ifdef _OPENMP
-            omp_set_lock(&(annotated_hits_lock[scan_index]));
+            addHit_(local_hits[scan_index], std::move(ah), report_top_hits_);
+          }
+
+          if (local_hits.size() >= max_local_hit_spectra_)
+          {
+            #pragma omp critical (annotated_hits_merge)
             {
-#endif
-              annotated_hits[scan_index].push_back(ah);
+              mergeHits_(local_hits, annotated_hits, report_top_hits_);
+            }
+          }
+        }
+
+        #pragma omp critical (annotated_hits_merge)
+        {
+          mergeHits_(local_hits, annotated_hits, report_top_hits_);
+        }
+      }
+      endProgress();
+    }
+    else
+    {
+      // digest all proteins first: every unique peptide is then scored exactly once without tracking processed peptides across threads
+      startProgress(0, 1, "Digesting proteins...");
+      vector<StringView> peptides;
+      digestDatabase_(fasta_db, digestor, false, peptide_motif_regex, peptides);
+      endProgress();
+
+      startProgress(0, peptides.size(), "Scoring peptide models against spectra...");
+
+      Size count_peptides(0);
+
+#pragma omp parallel default(none) shared(annotated_hits, spectrum_generator_param, multimap_mass_2_scan_index, fixed_modifications, variable_modifications, peptides, count_peptides, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm, prepared_spectra)
+      {
+        // best hits of this thread, merged into annotated_hits whenever they cover too many spectra and once all peptides are scored
+        LocalHits_ local_hits;
 
-              // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
-              if (annotated_hits[scan_index].size() >= 2 * report_top_hits_)
+        // one generator per thread: modified variants of a peptide are generated in a row and share most residue masses
+        SimpleTSG spectrum_generator;
+        spectrum_generator.setParameters(spectrum_generator_param);
+        vector<SimpleTSG::Fragment> theo_fragments;
+
+#pragma omp for schedule(dynamic, 100) nowait
+        for (SignedSize peptide_index = 0; peptide_index < (SignedSize)peptides.size(); ++peptide_index)
+        {
+          #pragma omp atomic
+          ++count_peptides;
+
+          IF_MASTERTHREAD
+          {
+            setProgress(count_peptides);
+          }
+
+          const StringView& c = peptides[peptide_index];
+
+          // no database lookups: unmodified residues come from ResidueDB's read-only one letter code table and
+          // the modified residues were resolved by getModifications() before the parallel region
+          vector<AASequence> all_modified_peptides;
+          AASequence aas = AASequence::fromString(c.getString());
+          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
+
+          for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
+          {
+            const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+            double current_peptide_mass = candidate.getMonoWeight();
+
+            // determine MS2 precursors that match to the current peptide mass
+            multimap<double, Size>::const_iterator low_it;
+            multimap<double, Size>::const_iterator up_it;
+
+            if (precursor_mass_tolerance_unit_ppm) // ppm
+            {
+              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
+              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
+            }
+            else // Dalton
+            {
+              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - precursor_mass_tolerance_);
+              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + precursor_mass_tolerance_);
+            }
+
+            // no matching precursor in data
+            if (low_it == up_it)
+            {
+              continue;
+            }
+
+            // b and y ions with charge 1, sorted by m/z
+            spectrum_generator.getSpectrum(theo_fragments, candidate, 1, 1);
+
+            for (; low_it != up_it; ++low_it)
+            {
+              const Size& scan_index = low_it->second;
+              HyperScore::PSMDetail detail;
+              const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, prepared_spectra[scan_index], theo_fragments, detail);
+
+              if (score == 0)
               {
-                std::partial_sort(annotated_hits[scan_index].begin(), annotated_hits[scan_index].begin() + report_top_hits_, annotated_hits[scan_index].end(), AnnotatedHit_::hasBetterScore);
-                annotated_hits[scan_index].resize(report_top_hits_); 
+                continue; // no hit?
               }
-#ifdef _OPENMP
+              // add peptide hit
+              AnnotatedHit_ ah;
+              ah.sequence = c;
+              ah.peptide_mod_index = mod_pep_idx;
+              ah.score = score;
+              ah.prefix_fraction = (double)detail.matched_b_ions/(double)c.size();
+              ah.suffix_fraction = (double)detail.matched_y_ions/(double)c.size();
+              ah.mean_error = detail.mean_error;
+
+              addHit_(local_hits[scan_index], std::move(ah), report_top_hits_);
+            }
+          }
+
+          if (local_hits.size() >= max_local_hit_spectra_)
+          {
+            #pragma omp critical (annotated_hits_merge)
+            {
+              mergeHits_(local_hits, annotated_hits, report_top_hits_);
             }
-            omp_unset_lock(&(annotated_hits_lock[scan_index]));
-#endif
           }
         }
+
+        #pragma omp critical (annotated_hits_merge)
+        {
+          mergeHits_(local_hits, annotated_hits, report_top_hits_);
+        }
       }
-    }
-    endProgress();
+      endProgress();
 
-    OPENMS_LOG_INFO << "Proteins: " << count_proteins << endl;
-    OPENMS_LOG_INFO << "Peptides: " << count_peptides << endl;
-    OPENMS_LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
+      OPENMS_LOG_INFO << "Proteins: " << fasta_db.size() << endl;
+      OPENMS_LOG_INFO << "Peptides: " << peptides.size() << endl;
+    }
 
     startProgress(0, 1, "Post-processing PSMs...");
     SimpleSearchEngineAlgorithm::postProcessHits_(spectra, 
@@ -706,7 +1228,7 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     param_pi.setValue("decoy_string", "DECOY_");
     param_pi.setValue("decoy_string_position", "prefix");
     param_pi.setValue("enzyme:name", enzyme_);
-    param_pi.setValue("enzyme:specificity", "full");
+    param_pi.setValue("enzyme:specificity", (fragment_index_enabled_ && fragment_index_semi_specific_) ? "semi" : "full");
     param_pi.setValue("missing_decoy_action", "silent");
     indexer.setParameters(param_pi);
 
@@ -729,14 +1251,6 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
       }
     } 
 
-#ifdef _OPENMP
-    // free locks
-    for (size_t i = 0; i != annotated_hits_lock.size(); i++) 
-    {
-      omp_destroy_lock(&(annotated_hits_lock[i]));
-    }
-#endif
-
     return ExitCodes::EXECUTION_OK;
   }
 
@@ -21,6 +21,7 @@ ConsensusMapMergerAlgorithm.cpp
 FalseDiscoveryRate.cpp
 FIAMSDataProcessor.cpp
 FIAMSScheduler.cpp
+FragmentIndex.cpp
 HiddenMarkovModel.cpp
 IDBoostGraph.cpp
 IDConflictResolverAlgorithm.cpp
@@ -36,7 +37,9 @@ MetaboliteSpectralMatching.cpp
 PeptideProteinResolution.cpp
 PrecursorPurity.cpp
 ProtonDistributionModel.cpp
+PeptideDatabase.cpp
 PeptideIndexing.cpp
+ProteinSuffixArray.cpp
 PercolatorFeatureSetHelper.cpp
 SimpleSearchEngineAlgorithm.cpp
 SiriusAdapterAlgorithm.cpp
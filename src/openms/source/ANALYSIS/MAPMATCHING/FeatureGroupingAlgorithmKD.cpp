@@ -33,6 +33,7 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureGroupingAlgorithmKD.h>
+#include <OpenMS/ANALYSIS/MAPMATCHING/LinkingFeatureStore.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/MapAlignmentAlgorithmKD.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureGroupingAlgorithm.h>
 #include <OpenMS/ANALYSIS/ID/IonIdentityMolecularNetworking.h>
@@ -42,6 +43,12 @@
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 namespace OpenMS
@@ -112,9 +119,71 @@ namespace OpenMS
   {
   }
 
-  template <typename MapType>
-  void FeatureGroupingAlgorithmKD::group_(const vector<MapType>& input_maps,
-                                          ConsensusMap& out)
+  namespace
+  {
+    /**
+        @brief Computes the m/z partition boundaries from all m/z values of the input, passed in ascending order
+
+        Boundaries are placed in gaps larger than the m/z tolerance, so no
+        cluster can reach across them, after at least (number of features /
+        number of partitions) features.
+    */
+    class PartitionBoundaries
+    {
+    public:
+      PartitionBoundaries(Size num_features, Size nr_partitions, double max_mz_tol, bool mz_ppm) :
+        pts_per_partition_(num_features / nr_partitions),
+        max_mz_tol_(max_mz_tol),
+        mz_ppm_(mz_ppm)
+      {
+      }
+
+      void add(double mz)
+      {
+        if (count_ == 0)
+        {
+          boundaries_.push_back(mz);
+        }
+        else
+        {
+          // minimal differences between two m/z values
+          double massrange_diff = mz_ppm_ ? max_mz_tol_ * 1e-6 * mz : max_mz_tol_;
+
+          if (fabs(last_mz_ - mz) > massrange_diff)
+          {
+            if (count_ - 1 >= boundaries_.size() * pts_per_partition_)
+            {
+              boundaries_.push_back((last_mz_ + mz) / 2.0);
+            }
+          }
+        }
+        last_mz_ = mz;
+        ++count_;
+      }
+
+      /// Returns the boundaries (including the first m/z value and the end of the last partition)
+      vector<double> get() const
+      {
+        vector<double> boundaries = boundaries_;
+        if (count_ > 0)
+        {
+          // add last partition (a bit more since we use "smaller than" below)
+          boundaries.push_back(last_mz_ + 1.0);
+        }
+        return boundaries;
+      }
+
+    private:
+      Size pts_per_partition_;
+      double max_mz_tol_;
+      bool mz_ppm_;
+      Size count_ = 0;
+      double last_mz_ = 0.0;
+      vector<double> boundaries_;
+    };
+  }
+
+  void FeatureGroupingAlgorithmKD::setUp_(Size num_maps, ConsensusMap& out)
   {
     // set parameters
     String mz_unit(param_.getValue("mz_unit").toString());
@@ -123,13 +192,34 @@ namespace OpenMS
     rt_tol_secs_ = (double)(param_.getValue("link:rt_tol"));
 
     // check that the number of maps is ok:
-    if (input_maps.size() < 2)
+    if (num_maps < 2)
     {
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
                                        "At least two maps must be given!");
     }
 
     out.clear(false);
+  }
+
+  void FeatureGroupingAlgorithmKD::setUpDistance_(double max_intensity)
+  {
+    // set up distance functor
+    Param distance_params;
+    distance_params.insert("", param_.copy("distance_RT:"));
+    distance_params.insert("", param_.copy("distance_MZ:"));
+    distance_params.insert("", param_.copy("distance_intensity:"));
+    distance_params.setValue("distance_RT:max_difference", rt_tol_secs_);
+    distance_params.setValue("distance_MZ:max_difference", mz_tol_);
+    distance_params.setValue("distance_MZ:unit", (mz_ppm_ ? "ppm" : "Da"));
+    feature_distance_ = FeatureDistance(max_intensity, false);
+    feature_distance_.setParameters(distance_params);
+  }
+
+  template <typename MapType>
+  void FeatureGroupingAlgorithmKD::group_(const vector<MapType>& input_maps,
+                                          ConsensusMap& out)
+  {
+    setUp_(input_maps.size(), out);
 
     // collect all m/z values for partitioning, find intensity maximum
     vector<double> massrange;
@@ -149,80 +239,140 @@ namespace OpenMS
       }
     }
 
-    // set up distance functor
-    Param distance_params;
-    distance_params.insert("", param_.copy("distance_RT:"));
-    distance_params.insert("", param_.copy("distance_MZ:"));
-    distance_params.insert("", param_.copy("distance_intensity:"));
-    distance_params.setValue("distance_RT:max_difference", rt_tol_secs_);
-    distance_params.setValue("distance_MZ:max_difference", mz_tol_);
-    distance_params.setValue("distance_MZ:unit", (mz_ppm_ ? "ppm" : "Da"));
-    feature_distance_ = FeatureDistance(max_intensity, false);
-    feature_distance_.setParameters(distance_params);
+    setUpDistance_(max_intensity);
 
     // partition at boundaries -> this should be safe because there cannot be
     // any cluster reaching across boundaries
 
     sort(massrange.begin(), massrange.end());
-    int pts_per_partition = massrange.size() / (int)(param_.getValue("nr_partitions"));
+    double warp_mz_tol = (double)(param_.getValue("warp:mz_tol"));
+    PartitionBoundaries boundaries(massrange.size(), (int)(param_.getValue("nr_partitions")), max(mz_tol_, warp_mz_tol), mz_ppm_);
+    for (double mz : massrange)
+    {
+      boundaries.add(mz);
+    }
+    const vector<double> partition_boundaries = boundaries.get();
 
+    // features of all maps within [partition_start, partition_end)
+    auto collectPartition = [&input_maps, &partition_boundaries](Size j, std::vector<MapType>& tmp_input_maps)
+    {
+      const double partition_start = partition_boundaries[j];
+      const double partition_end = partition_boundaries[j + 1];
+      tmp_input_maps.resize(input_maps.size());
+      for (size_t k = 0; k < input_maps.size(); k++)
+      {
+        // iterate over all features in the current input map and append
+        // matching features (within the current partition) to the temporary
+        // map
+        for (size_t m = 0; m < input_maps[k].size(); m++)
+        {
+          if (input_maps[k][m].getMZ() >= partition_start &&
+              input_maps[k][m].getMZ() < partition_end)
+          {
+            tmp_input_maps[k].push_back(input_maps[k][m]);
+          }
+        }
+        tmp_input_maps[k].updateRanges();
+      }
+    };
+
+    if (linkPartitions_<MapType>(input_maps.size(), partition_boundaries, collectPartition, out))
+    {
+      postprocess_(input_maps, out);
+    }
+  }
+
+  void FeatureGroupingAlgorithmKD::group(LinkingFeatureStore& store, ConsensusMap& out)
+  {
+    setUp_(store.size(), out);
+    setUpDistance_(store.getMaxIntensity());
+
+    // m/z values are merged from the store, so the partitions are the same as for the maps in memory
     double warp_mz_tol = (double)(param_.getValue("warp:mz_tol"));
-    double max_mz_tol = max(mz_tol_, warp_mz_tol);
+    PartitionBoundaries boundaries(store.getNumberOfFeatures(), (int)(param_.getValue("nr_partitions")), max(mz_tol_, warp_mz_tol), mz_ppm_);
+    store.forEachMZ([&boundaries](double mz) { boundaries.add(mz); });
+    const vector<double> partition_boundaries = boundaries.get();
+    store.setPartitions(partition_boundaries);
 
-    // compute partition boundaries
-    vector<double> partition_boundaries;
-    partition_boundaries.push_back(massrange.front());
-    for (size_t j = 0; j < massrange.size()-1; j++)
+    auto loadPartition = [&store](Size j, std::vector<FeatureMap>& tmp_input_maps)
+    {
+      store.loadPartition(j, tmp_input_maps);
+    };
+    if (linkPartitions_<FeatureMap>(store.size(), partition_boundaries, loadPartition, out))
     {
-      // minimal differences between two m/z values
-      double massrange_diff = mz_ppm_ ? max_mz_tol * 1e-6 * massrange[j+1] : max_mz_tol;
+      // identifications are not part of the store (see LinkingFeatureStore::restoreIdentifications()),
+      // only the canonical ordering applies
+      postprocess_(std::vector<FeatureMap>(), out);
+    }
+  }
 
-      if (fabs(massrange[j] - massrange[j+1]) > massrange_diff)
+  template <typename MapType, typename PartitionLoader>
+  bool FeatureGroupingAlgorithmKD::linkPartitions_(Size num_maps, const std::vector<double>& partition_boundaries,
+                                                   const PartitionLoader& load_partition, ConsensusMap& out)
+  {
+    // partitions are independent and processed concurrently; the first
+    // error (in partition order) is rethrown after the parallel loop
+    const SignedSize num_partitions = max(SignedSize(partition_boundaries.size()) - 1, SignedSize(0));
+    std::exception_ptr first_error;
+    SignedSize first_error_partition = num_partitions;
+    auto storeError = [&first_error, &first_error_partition](SignedSize j)
+    {
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_FeatureGroupingAlgorithmKD_error)
+#endif
       {
-        if (j >= (partition_boundaries.size() ) * pts_per_partition  )
+        if (j < first_error_partition)
         {
-          partition_boundaries.push_back((massrange[j] + massrange[j+1])/2.0);
+          first_error_partition = j;
+          first_error = std::current_exception();
         }
       }
-    }
-    // add last partition (a bit more since we use "smaller than" below)
-    partition_boundaries.push_back(massrange.back() + 1.0);
+    };
 
     // ------------ compute RT transformation models ------------
 
-    MapAlignmentAlgorithmKD aligner(input_maps.size(), param_);
+    MapAlignmentAlgorithmKD aligner(num_maps, param_);
     bool align = param_.getValue("warp:enabled").toString() == "true";
     if (align)
     {
       Size progress = 0;
       startProgress(0, partition_boundaries.size(), "computing RT transformations");
-      for (size_t j = 0; j < partition_boundaries.size()-1; j++)
+
+      // fit data of each partition, added to the aligner in partition order
+      std::vector<std::vector<TransformationModel::DataPoints> > partition_fit_data(num_partitions);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize j = 0; j < num_partitions; j++)
       {
-        double partition_start = partition_boundaries[j];
-        double partition_end = partition_boundaries[j+1];
+        try
+        {
+          std::vector<MapType> tmp_input_maps;
+          load_partition(j, tmp_input_maps);
 
-        std::vector<MapType> tmp_input_maps(input_maps.size());
-        for (size_t k = 0; k < input_maps.size(); k++)
+          // set up kd-tree
+          KDTreeFeatureMaps kd_data(tmp_input_maps, param_);
+          aligner.computeRTFitData(kd_data, partition_fit_data[j]);
+        }
+        catch (...)
         {
-          // iterate over all features in the current input map and append
-          // matching features (within the current partition) to the temporary
-          // map
-          for (size_t m = 0; m < input_maps[k].size(); m++)
-          {
-            if (input_maps[k][m].getMZ() >= partition_start &&
-                input_maps[k][m].getMZ() < partition_end)
-            {
-              tmp_input_maps[k].push_back(input_maps[k][m]);
-            }
-          }
-          tmp_input_maps[k].updateRanges();
+          storeError(j);
         }
-
-        // set up kd-tree
-        KDTreeFeatureMaps kd_data(tmp_input_maps, param_);
-        aligner.addRTFitData(kd_data);
-        setProgress(progress++);
+        IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++progress;
+      }
+      if (first_error)
+      {
+        std::rethrow_exception(first_error);
+      }
+      for (const std::vector<TransformationModel::DataPoints>& fit_data : partition_fit_data)
+      {
+        aligner.addRTFitData(fit_data);
       }
+      partition_fit_data.clear();
 
       // fit LOWESS on RT fit data collected across all partitions
       try
@@ -232,53 +382,79 @@ namespace OpenMS
       catch (Exception::BaseException& e)
       {
         OPENMS_LOG_ERROR << "Error: " << e.what() << endl;
-        return;
+        return false;
       }
 
       endProgress();
     }
 
     // ------------ run alignment + feature linking on individual partitions ------------
-    Size progress = 0;
-    startProgress(0, partition_boundaries.size(), "linking features");
-    for (size_t j = 0; j < partition_boundaries.size()-1; j++)
     {
-      double partition_start = partition_boundaries[j];
-      double partition_end = partition_boundaries[j+1];
-
-      std::vector<MapType> tmp_input_maps(input_maps.size());
-      for (size_t k = 0; k < input_maps.size(); k++)
+      // consensus features of each partition, appended to 'out' in partition order
+      std::vector<ConsensusMap> fragments(num_partitions);
+      Size progress = 0;
+      startProgress(0, partition_boundaries.size(), "linking features");
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
       {
-        // iterate over all features in the current input map and append
-        // matching features (within the current partition) to the temporary
-        // map
-        for (size_t m = 0; m < input_maps[k].size(); m++)
+        // FeatureDistance updates its normalization on the fly, so every thread needs its own
+        FeatureDistance distance(feature_distance_);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (SignedSize j = 0; j < num_partitions; j++)
         {
-          if (input_maps[k][m].getMZ() >= partition_start &&
-              input_maps[k][m].getMZ() < partition_end)
+          try
           {
-            tmp_input_maps[k].push_back(input_maps[k][m]);
+            std::vector<MapType> tmp_input_maps;
+            load_partition(j, tmp_input_maps);
+
+            // set up kd-tree
+            KDTreeFeatureMaps kd_data(tmp_input_maps, param_);
+
+            // alignment
+            if (align)
+            {
+              aligner.transform(kd_data);
+            }
+
+            // link features
+            runClustering_(kd_data, distance, fragments[j]);
           }
+          catch (...)
+          {
+            storeError(j);
+          }
+          IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+          ++progress;
         }
-        tmp_input_maps[k].updateRanges();
       }
-
-      // set up kd-tree
-      KDTreeFeatureMaps kd_data(tmp_input_maps, param_);
-
-      // alignment
-      if (align)
+      if (first_error)
       {
-        aligner.transform(kd_data);
+        std::rethrow_exception(first_error);
       }
 
-      // link features
-      runClustering_(kd_data, out);
-      setProgress(progress++);
+      Size cf_count = out.size();
+      for (const ConsensusMap& fragment : fragments)
+      {
+        cf_count += fragment.size();
+      }
+      out.reserve(cf_count);
+      for (ConsensusMap& fragment : fragments)
+      {
+        for (ConsensusFeature& cf : fragment)
+        {
+          out.push_back(std::move(cf));
+        }
+        fragment.clear();
+      }
+      endProgress();
     }
-    endProgress();
-    
-    postprocess_(input_maps, out);
+    return true;
   }
 
   void FeatureGroupingAlgorithmKD::group(const std::vector<FeatureMap>& maps,
@@ -293,7 +469,7 @@ namespace OpenMS
     group_(maps, out);
   }
 
-  void FeatureGroupingAlgorithmKD::runClustering_(const KDTreeFeatureMaps& kd_data, ConsensusMap& out)
+  void FeatureGroupingAlgorithmKD::runClustering_(const KDTreeFeatureMaps& kd_data, FeatureDistance& distance, ConsensusMap& out) const
   {
     Size n = kd_data.size();
 
@@ -306,7 +482,7 @@ namespace OpenMS
     set<ClusterProxyKD> potential_clusters;
     vector<ClusterProxyKD> cluster_for_idx(n);
     vector<Int> assigned(n, false);
-    updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data);
+    updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data, distance);
 
     // pass 2: construct consensus features until all points assigned.
     while (!potential_clusters.empty())
@@ -316,7 +492,7 @@ namespace OpenMS
 
       // compile the actual list of sub feature indices for cluster with center i
       vector<Size> cf_indices;
-      computeBestClusterForCenter_(i, cf_indices, assigned, kd_data);
+      computeBestClusterForCenter_(i, cf_indices, assigned, kd_data, distance);
 
       // add consensus feature
       addConsensusFeature_(cf_indices, kd_data, out);
@@ -344,7 +520,7 @@ namespace OpenMS
       }
 
       // now that the points are marked assigned, update the neighborhoods of their neighbors
-      updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data);
+      updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data, distance);
     }
   }
 
@@ -354,14 +530,15 @@ namespace OpenMS
                                                          vector<ClusterProxyKD>& cluster_for_idx,
                                                          const set<Size>& update_these,
                                                          const vector<Int>& assigned,
-                                                         const KDTreeFeatureMaps& kd_data)
+                                                         const KDTreeFeatureMaps& kd_data,
+                                                         FeatureDistance& distance) const
   {
     for (set<Size>::const_iterator it = update_these.begin(); it != update_these.end(); ++it)
     {
       Size i = *it;
       const ClusterProxyKD& old_proxy = cluster_for_idx[i];
       vector<Size> unused;
-      ClusterProxyKD new_proxy = computeBestClusterForCenter_(i, unused, assigned, kd_data);
+      ClusterProxyKD new_proxy = computeBestClusterForCenter_(i, unused, assigned, kd_data, distance);
 
       // only need to update if size and/or average distance have changed
       if (new_proxy != old_proxy)
@@ -373,7 +550,7 @@ namespace OpenMS
     }
   }
 
-  ClusterProxyKD FeatureGroupingAlgorithmKD::computeBestClusterForCenter_(Size i, vector<Size>& cf_indices, const vector<Int>& assigned, const KDTreeFeatureMaps& kd_data) const
+  ClusterProxyKD FeatureGroupingAlgorithmKD::computeBestClusterForCenter_(Size i, vector<Size>& cf_indices, const vector<Int>& assigned, const KDTreeFeatureMaps& kd_data, FeatureDistance& distance) const
   {
     //Parameters how to use charge/adduct information
     String merge_charge(param_.getValue("link:charge_merging").toString());
@@ -475,8 +652,7 @@ namespace OpenMS
       Size best_index = numeric_limits<Size>::max();
       for (vector<Size>::const_iterator c_it = candidates.begin(); c_it != candidates.end(); ++c_it)
       {
-        double dist = const_cast<FeatureDistance&>(feature_distance_)(*(kd_data.feature(*c_it)),
-                                                                      *(kd_data.feature(i))).second;
+        double dist = distance(*(kd_data.feature(*c_it)), *(kd_data.feature(i))).second;
 
         if (dist < min_dist)
         {
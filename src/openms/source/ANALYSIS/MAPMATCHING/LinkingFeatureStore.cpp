@@ -0,0 +1,449 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/MAPMATCHING/LinkingFeatureStore.h>
+
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// columns of a map in the file, in this order; followed by the adduct and group string heaps
+    enum Column
+    {
+      MZ, RT, INTENSITY, QUALITY, WIDTH, CHARGE, UNIQUE_ID, INDEX, ADDUCT_END, GROUP_END, NUMBER_OF_COLUMNS
+    };
+
+    const Size column_width[NUMBER_OF_COLUMNS] =
+    {
+      sizeof(double), sizeof(double), sizeof(float), sizeof(float), sizeof(float),
+      sizeof(Int32), sizeof(UInt64), sizeof(UInt32), sizeof(UInt64), sizeof(UInt64)
+    };
+
+    /// number of m/z values buffered per map in forEachMZ() and setPartitions()
+    const Size MZ_BUFFER_SIZE = 4096;
+
+    /// bytes of all columns of one feature
+    Size rowWidth()
+    {
+      return accumulate(column_width, column_width + NUMBER_OF_COLUMNS, Size(0));
+    }
+
+    template <typename T>
+    void writeColumn(ofstream& ofs, const vector<T>& values)
+    {
+      ofs.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+  }
+
+  LinkingFeatureStore::LinkingFeatureStore(const String& filename) :
+    filename_(filename),
+    ofs_(filename.c_str(), ios::out | ios::binary | ios::trunc)
+  {
+    if (!ofs_)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+  }
+
+  LinkingFeatureStore::~LinkingFeatureStore()
+  {
+    ofs_.close();
+    File::remove(filename_);
+  }
+
+  void LinkingFeatureStore::addMap(const FeatureMap& map)
+  {
+    const Size n = map.size();
+    if (n >= Size(numeric_limits<UInt32>::max()))
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, n);
+    }
+
+    // features are found again by their unique id in restoreIdentifications()
+    vector<UInt64> ids;
+    ids.reserve(n);
+    for (const Feature& f : map)
+    {
+      ids.push_back(f.getUniqueId());
+    }
+    sort(ids.begin(), ids.end());
+    vector<UInt64>::const_iterator duplicate = adjacent_find(ids.begin(), ids.end());
+    if (duplicate != ids.end())
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                    "Feature unique ids must be unique within a map.", String(*duplicate));
+    }
+    ids.clear();
+
+    vector<Size> order(n);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&map](Size a, Size b) { return map[a].getMZ() < map[b].getMZ(); });
+
+    vector<double> mz(n), rt(n);
+    vector<float> intensity(n), quality(n), width(n);
+    vector<Int32> charge(n);
+    vector<UInt64> unique_id(n), adduct_end(n), group_end(n);
+    vector<UInt32> index(n);
+    String adducts, groups;
+    for (Size i = 0; i < n; ++i)
+    {
+      const Feature& f = map[order[i]];
+      mz[i] = f.getMZ();
+      rt[i] = f.getRT();
+      intensity[i] = f.getIntensity();
+      quality[i] = f.getOverallQuality();
+      width[i] = f.getWidth();
+      charge[i] = f.getCharge();
+      unique_id[i] = f.getUniqueId();
+      index[i] = UInt32(order[i]);
+      if (f.metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS))
+      {
+        adducts += f.getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS).toString();
+      }
+      adduct_end[i] = adducts.size();
+      if (f.metaValueExists(Constants::UserParam::ADDUCT_GROUP))
+      {
+        groups += f.getMetaValue(Constants::UserParam::ADDUCT_GROUP).toString();
+      }
+      group_end[i] = groups.size();
+      max_intensity_ = max(max_intensity_, double(f.getIntensity()));
+    }
+
+    writeColumn(ofs_, mz);
+    writeColumn(ofs_, rt);
+    writeColumn(ofs_, intensity);
+    writeColumn(ofs_, quality);
+    writeColumn(ofs_, width);
+    writeColumn(ofs_, charge);
+    writeColumn(ofs_, unique_id);
+    writeColumn(ofs_, index);
+    writeColumn(ofs_, adduct_end);
+    writeColumn(ofs_, group_end);
+    ofs_.write(adducts.data(), adducts.size());
+    ofs_.write(groups.data(), groups.size());
+    ofs_.flush();
+    if (!ofs_)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Error writing feature data.");
+    }
+
+    MapEntry_ entry;
+    entry.size = n;
+    entry.offset = file_size_;
+    entry.adduct_chars = adducts.size();
+    file_size_ += n * rowWidth() + adducts.size() + groups.size();
+    maps_.push_back(entry);
+    num_features_ += n;
+    num_partitions_ = 0;
+  }
+
+  Size LinkingFeatureStore::size() const
+  {
+    return maps_.size();
+  }
+
+  Size LinkingFeatureStore::getNumberOfFeatures() const
+  {
+    return num_features_;
+  }
+
+  double LinkingFeatureStore::getMaxIntensity() const
+  {
+    return max_intensity_;
+  }
+
+  void LinkingFeatureStore::forEachMZ(const std::function<void(double)>& f) const
+  {
+    ifstream ifs;
+    openForReading_(ifs);
+
+    // k-way merge of the sorted m/z columns
+    vector<vector<double> > buffers(maps_.size());
+    vector<Size> next(maps_.size(), 0), buffer_begin(maps_.size(), 0);
+    auto refill = [&](Size k)
+    {
+      buffer_begin[k] = next[k];
+      readColumn_(ifs, maps_[k], MZ, next[k], min(next[k] + MZ_BUFFER_SIZE, maps_[k].size), buffers[k]);
+    };
+
+    typedef pair<double, Size> Item;
+    priority_queue<Item, vector<Item>, greater<Item> > queue;
+    for (Size k = 0; k < maps_.size(); ++k)
+    {
+      if (maps_[k].size > 0)
+      {
+        refill(k);
+        queue.emplace(buffers[k][0], k);
+      }
+    }
+    while (!queue.empty())
+    {
+      const Item top = queue.top();
+      queue.pop();
+      f(top.first);
+
+      const Size k = top.second;
+      if (++next[k] < maps_[k].size)
+      {
+        if (next[k] - buffer_begin[k] == buffers[k].size())
+        {
+          refill(k);
+        }
+        queue.emplace(buffers[k][next[k] - buffer_begin[k]], k);
+      }
+    }
+  }
+
+  void LinkingFeatureStore::setPartitions(const std::vector<double>& boundaries)
+  {
+    ifstream ifs;
+    openForReading_(ifs);
+
+    vector<double> buffer;
+    for (MapEntry_& entry : maps_)
+    {
+      // partition_offsets[p] is the first feature with m/z >= boundaries[p]
+      entry.partition_offsets.assign(boundaries.size(), entry.size);
+      Size p = 0;
+      for (Size begin = 0; begin < entry.size && p < boundaries.size(); begin += MZ_BUFFER_SIZE)
+      {
+        readColumn_(ifs, entry, MZ, begin, min(begin + MZ_BUFFER_SIZE, entry.size), buffer);
+        for (Size i = 0; i < buffer.size(); ++i)
+        {
+          while (p < boundaries.size() && boundaries[p] <= buffer[i])
+          {
+            entry.partition_offsets[p++] = begin + i;
+          }
+        }
+      }
+    }
+    num_partitions_ = boundaries.size() < 2 ? 0 : boundaries.size() - 1;
+  }
+
+  Size LinkingFeatureStore::getNumberOfPartitions() const
+  {
+    return num_partitions_;
+  }
+
+  void LinkingFeatureStore::loadPartition(Size j, std::vector<FeatureMap>& maps) const
+  {
+    if (j >= num_partitions_)
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, j, num_partitions_);
+    }
+
+    ifstream ifs;
+    openForReading_(ifs);
+
+    maps.clear();
+    maps.resize(maps_.size());
+
+    vector<double> mz, rt;
+    vector<float> intensity, quality, width;
+    vector<Int32> charge;
+    vector<UInt64> unique_id;
+    vector<UInt32> index;
+    vector<String> adducts, groups;
+    vector<Size> order;
+    for (Size k = 0; k < maps_.size(); ++k)
+    {
+      const MapEntry_& entry = maps_[k];
+      const Size begin = entry.partition_offsets[j], end = entry.partition_offsets[j + 1];
+      if (begin < end)
+      {
+        readColumn_(ifs, entry, MZ, begin, end, mz);
+        readColumn_(ifs, entry, RT, begin, end, rt);
+        readColumn_(ifs, entry, INTENSITY, begin, end, intensity);
+        readColumn_(ifs, entry, QUALITY, begin, end, quality);
+        readColumn_(ifs, entry, WIDTH, begin, end, width);
+        readColumn_(ifs, entry, CHARGE, begin, end, charge);
+        readColumn_(ifs, entry, UNIQUE_ID, begin, end, unique_id);
+        readColumn_(ifs, entry, INDEX, begin, end, index);
+        readStrings_(ifs, entry, ADDUCT_END, begin, end, adducts);
+        readStrings_(ifs, entry, GROUP_END, begin, end, groups);
+
+        // restore the order of the input map
+        order.resize(end - begin);
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&index](Size a, Size b) { return index[a] < index[b]; });
+
+        FeatureMap& map = maps[k];
+        map.reserve(order.size());
+        for (Size i : order)
+        {
+          Feature f;
+          f.setMZ(mz[i]);
+          f.setRT(rt[i]);
+          f.setIntensity(intensity[i]);
+          f.setOverallQuality(quality[i]);
+          f.setWidth(width[i]);
+          f.setCharge(charge[i]);
+          f.setUniqueId(unique_id[i]);
+          if (!adducts[i].empty())
+          {
+            f.setMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS, adducts[i]);
+          }
+          if (!groups[i].empty())
+          {
+            f.setMetaValue(Constants::UserParam::ADDUCT_GROUP, groups[i]);
+          }
+          map.push_back(std::move(f));
+        }
+      }
+      maps[k].updateRanges();
+    }
+  }
+
+  void LinkingFeatureStore::restoreIdentifications(Size map_index, const FeatureMap& map, ConsensusMap& out)
+  {
+    if (map_index >= maps_.size() || map.size() != maps_[map_index].size)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                    "Feature map does not match the stored map.", String(map_index));
+    }
+
+    // index the handles of all maps once
+    if (map_index == 0 || handle_index_.size() != maps_.size())
+    {
+      handle_index_.assign(maps_.size(), vector<pair<UInt64, Size> >());
+      for (Size i = 0; i < out.size(); ++i)
+      {
+        for (const FeatureHandle& handle : out[i])
+        {
+          if (handle.getMapIndex() < maps_.size())
+          {
+            handle_index_[handle.getMapIndex()].emplace_back(handle.getUniqueId(), i);
+          }
+        }
+      }
+      for (vector<pair<UInt64, Size> >& handles : handle_index_)
+      {
+        sort(handles.begin(), handles.end());
+      }
+    }
+
+    const vector<pair<UInt64, Size> >& handles = handle_index_[map_index];
+    for (const Feature& f : map)
+    {
+      if (f.getPeptideIdentifications().empty())
+      {
+        continue;
+      }
+      vector<pair<UInt64, Size> >::const_iterator it =
+        lower_bound(handles.begin(), handles.end(), make_pair(f.getUniqueId(), Size(0)));
+      if (it == handles.end() || it->first != f.getUniqueId())
+      {
+        continue;
+      }
+      vector<PeptideIdentification>& ids = out[it->second].getPeptideIdentifications();
+      for (const PeptideIdentification& id : f.getPeptideIdentifications())
+      {
+        ids.push_back(id);
+        ids.back().setMetaValue("map_index", map_index);
+      }
+    }
+    vector<pair<UInt64, Size> >().swap(handle_index_[map_index]);
+
+    out.getProteinIdentifications().insert(out.getProteinIdentifications().end(),
+                                           map.getProteinIdentifications().begin(),
+                                           map.getProteinIdentifications().end());
+    for (const PeptideIdentification& id : map.getUnassignedPeptideIdentifications())
+    {
+      out.getUnassignedPeptideIdentifications().push_back(id);
+      out.getUnassignedPeptideIdentifications().back().setMetaValue("map_index", map_index);
+    }
+  }
+
+  template <typename T>
+  void LinkingFeatureStore::readColumn_(std::ifstream& ifs, const MapEntry_& entry, Size column, Size begin, Size end, std::vector<T>& values) const
+  {
+    const Size column_offset = entry.size * accumulate(column_width, column_width + column, Size(0));
+    values.resize(end - begin);
+    ifs.seekg(entry.offset + column_offset + begin * sizeof(T));
+    ifs.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+    if (!ifs)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_);
+    }
+  }
+
+  void LinkingFeatureStore::readStrings_(std::ifstream& ifs, const MapEntry_& entry, Size column, Size begin, Size end, std::vector<String>& values) const
+  {
+    // the string ends are cumulative, so read one more to get the start of the first string
+    vector<UInt64> ends;
+    readColumn_(ifs, entry, column, begin == 0 ? 0 : begin - 1, end, ends);
+    const UInt64 first = begin == 0 ? 0 : ends.front();
+    const UInt64 heap = entry.offset + entry.size * rowWidth() + (column == GROUP_END ? entry.adduct_chars : 0);
+
+    String chars(ends.back() - first, '\0');
+    if (!chars.empty())
+    {
+      ifs.seekg(heap + first);
+      ifs.read(&chars[0], chars.size());
+      if (!ifs)
+      {
+        throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_);
+      }
+    }
+
+    values.resize(end - begin);
+    UInt64 start = first;
+    for (Size i = 0; i < values.size(); ++i)
+    {
+      const UInt64 stop = ends[i + (begin == 0 ? 0 : 1)];
+      values[i] = chars.substr(start - first, stop - start);
+      start = stop;
+    }
+  }
+
+  void LinkingFeatureStore::openForReading_(std::ifstream& ifs) const
+  {
+    ifs.open(filename_.c_str(), ios::in | ios::binary);
+    if (!ifs)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_);
+    }
+  }
+
+} // namespace OpenMS
@@ -61,6 +61,24 @@ MapAlignmentAlgorithmKD::~MapAlignmentAlgorithmKD()
 
 void MapAlignmentAlgorithmKD::addRTFitData(const KDTreeFeatureMaps& kd_data)
 {
+  vector<TransformationModel::DataPoints> fit_data;
+  computeRTFitData(kd_data, fit_data);
+  addRTFitData(fit_data);
+}
+
+void MapAlignmentAlgorithmKD::addRTFitData(const vector<TransformationModel::DataPoints>& fit_data)
+{
+  for (Size i = 0; i < fit_data.size(); ++i)
+  {
+    fit_data_[i].insert(fit_data_[i].end(), fit_data[i].begin(), fit_data[i].end());
+  }
+}
+
+void MapAlignmentAlgorithmKD::computeRTFitData(const KDTreeFeatureMaps& kd_data, vector<TransformationModel::DataPoints>& fit_data) const
+{
+  fit_data.clear();
+  fit_data.resize(fit_data_.size());
+
   // compute connected components
   map<Size, vector<Size> > ccs;
   getCCs_(kd_data, ccs);
@@ -87,7 +105,7 @@ void MapAlignmentAlgorithmKD::addRTFitData(const KDTreeFeatureMaps& kd_data)
     avg_rts[cc_index] = avg_rt;
   }
 
-  // generate fit data for each map, add to fit_data_
+  // generate fit data for each map
   for (map<Size, vector<Size> >::const_iterator it = filtered_ccs.begin(); it != filtered_ccs.end(); ++it)
   {
     Size cc_index = it->first;
@@ -97,7 +115,7 @@ void MapAlignmentAlgorithmKD::addRTFitData(const KDTreeFeatureMaps& kd_data)
       Size i = *cc_it;
       double rt = kd_data.rt(i);
       double avg_rt = avg_rts[cc_index];
-      fit_data_[kd_data.mapIndex(i)].push_back(make_pair(rt, avg_rt));
+      fit_data[kd_data.mapIndex(i)].push_back(make_pair(rt, avg_rt));
     }
   }
 }
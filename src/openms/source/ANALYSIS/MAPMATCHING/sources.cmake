@@ -16,6 +16,7 @@ FeatureGroupingAlgorithmQT.cpp
 FeatureGroupingAlgorithmUnlabeled.cpp
 FeatureMapping.cpp
 LabeledPairFinder.cpp
+LinkingFeatureStore.cpp
 MapAlignmentAlgorithmIdentification.cpp
 MapAlignmentAlgorithmKD.cpp
 MapAlignmentAlgorithmPoseClustering.cpp
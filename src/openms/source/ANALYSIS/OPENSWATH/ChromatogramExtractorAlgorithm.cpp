@@ -37,7 +37,10 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 
 #include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/FORMAT/HANDLERS/ColMassHandler.h>
+
 #include <iostream>
+#include <limits>
 
 namespace OpenMS
 {
@@ -305,76 +308,167 @@ namespace OpenMS
       OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
       OpenSwath::SpectrumMeta s_meta = input->getSpectrumMetaById(scan_idx);
 
-      OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
-      OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
-      std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
-      std::vector<double>::const_iterator mz_end = mz_arr->data.end();
-      std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
-      std::vector<double>::const_iterator int_it = int_arr->data.begin();
-      std::vector<double>::const_iterator im_it;
-
       if (sptr->getMZArray()->data.empty())
       {
         continue;
       }
+      extractSpectrum_(sptr, s_meta.RT, output, extraction_coordinates, mz_extraction_window, ppm, im_extraction_window, used_filter);
+    }
+    endProgress();
+  }
+
+  void ChromatogramExtractorAlgorithm::extractChromatograms(const Internal::ColMassHandler& input,
+      Size group,
+      std::vector< OpenSwath::ChromatogramPtr >& output,
+      const std::vector<ExtractionCoordinates>& extraction_coordinates,
+      double mz_extraction_window,
+      bool ppm,
+      double im_extraction_window,
+      const String& filter)
+  {
+    if (output.size() != extraction_coordinates.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Output and extraction coordinates need to have the same size: "+ String(output.size()) + " != " + String(extraction_coordinates.size()) );
+    }
+
+    int used_filter = getFilterNr_(filter);
+    // assert that they are sorted!
+    if (std::adjacent_find(extraction_coordinates.begin(), extraction_coordinates.end(),
+          ExtractionCoordinates::SortExtractionCoordinatesReverseByMZ) != extraction_coordinates.end())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Input to extractChromatogram needs to be sorted by m/z");
+    }
+    if (extraction_coordinates.empty())
+    {
+      return;
+    }
 
-      // Look for ion mobility array
-      bool has_im = (im_extraction_window > 0.0);
-      if (has_im)
+    // The RT range covers all coordinates (the whole run if any coordinate
+    // has no RT range) and the m/z ranges cover all extraction windows.
+    // Peaks outside of the windows never contribute to an extracted
+    // intensity, so only the chunks overlapping the windows are decompressed.
+    double min_rt = std::numeric_limits<double>::max();
+    double max_rt = -std::numeric_limits<double>::max();
+    std::vector<std::pair<double, double> > mz_ranges;
+    mz_ranges.reserve(extraction_coordinates.size());
+    for (const ExtractionCoordinates& coord : extraction_coordinates)
+    {
+      if (coord.rt_end - coord.rt_start > 0)
       {
-        OpenSwath::BinaryDataArrayPtr im_arr = sptr->getDriftTimeArray();
-        if (im_arr != nullptr)
-        {
-          im_it = im_arr->data.begin();
-        }
-        else
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-            "Requested ion mobility extraction but no ion mobility array found.");
-        }
+        min_rt = std::min(min_rt, coord.rt_start);
+        max_rt = std::max(max_rt, coord.rt_end);
+      }
+      else
+      {
+        min_rt = -std::numeric_limits<double>::max();
+        max_rt = std::numeric_limits<double>::max();
+      }
+      double half_window = ppm ? coord.mz * mz_extraction_window / 2.0 * 1.0e-6 : mz_extraction_window / 2.0;
+      mz_ranges.emplace_back(coord.mz - half_window, coord.mz + half_window);
+    }
+
+    std::vector<OpenSwath::SpectrumPtr> spectra;
+    std::vector<OpenSwath::SpectrumMeta> spectra_meta;
+    input.getArea(group, min_rt, max_rt, mz_ranges, spectra, spectra_meta);
+
+    startProgress(0, spectra.size(), "Extracting chromatograms");
+    for (Size k = 0; k < spectra.size(); ++k)
+    {
+      setProgress(k);
+
+      // skip empty spectra like above (but not those without peaks in the extraction windows)
+      if (input.getSpectrumSize(spectra_meta[k].index) == 0)
+      {
+        continue;
       }
+      // extract_value_tophat treats the first and the last peak of a
+      // spectrum differently from all others, enclose the peaks within the
+      // windows by a peak below and above all windows such that they are
+      // treated like in the complete spectrum
+      for (const OpenSwath::BinaryDataArrayPtr& arr : spectra[k]->getDataArrays())
+      {
+        bool is_mz = (arr == spectra[k]->getMZArray());
+        arr->data.insert(arr->data.begin(), is_mz ? std::numeric_limits<double>::lowest() : 0.0);
+        arr->data.push_back(is_mz ? std::numeric_limits<double>::max() : 0.0);
+      }
+      extractSpectrum_(spectra[k], spectra_meta[k].RT, output, extraction_coordinates, mz_extraction_window, ppm, im_extraction_window, used_filter);
+    }
+    endProgress();
+  }
 
-      // go through all transitions / chromatograms which are sorted by
-      // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
-      for (Size k = 0; k < extraction_coordinates.size(); ++k)
+  void ChromatogramExtractorAlgorithm::extractSpectrum_(const OpenSwath::SpectrumPtr& sptr,
+      double current_rt,
+      std::vector< OpenSwath::ChromatogramPtr >& output,
+      const std::vector<ExtractionCoordinates>& extraction_coordinates,
+      double mz_extraction_window,
+      bool ppm,
+      double im_extraction_window,
+      int used_filter)
+  {
+    OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
+    OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
+    std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
+    std::vector<double>::const_iterator mz_end = mz_arr->data.end();
+    std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
+    std::vector<double>::const_iterator int_it = int_arr->data.begin();
+    std::vector<double>::const_iterator im_it;
+
+    // Look for ion mobility array
+    bool has_im = (im_extraction_window > 0.0);
+    if (has_im)
+    {
+      OpenSwath::BinaryDataArrayPtr im_arr = sptr->getDriftTimeArray();
+      if (im_arr != nullptr)
       {
-        double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
-        if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 &&
-             (current_rt < extraction_coordinates[k].rt_start ||
-              current_rt > extraction_coordinates[k].rt_end) )
-        {
-          continue;
-        }
+        im_it = im_arr->data.begin();
+      }
+      else
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Requested ion mobility extraction but no ion mobility array found.");
+      }
+    }
 
-        const bool use_im = (extraction_coordinates[k].ion_mobility >= 0.0 && has_im);
-        if (!use_im && used_filter == 1)
-        {
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it,
-                               extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
-        }
-        else if (use_im && used_filter == 1)
-        {
-          if (extraction_coordinates[k].ion_mobility < 0)
-          {
-            std::cerr << "WARNING : Drift time of ion is negative!" << std::endl;
-          }
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it, im_it,
-                               extraction_coordinates[k].mz, extraction_coordinates[k].ion_mobility,
-                               integrated_intensity, mz_extraction_window, im_extraction_window, ppm);
-        }
-        else if (used_filter == 2)
+    // go through all transitions / chromatograms which are sorted by
+    // ProductMZ. We can use this to step through the spectrum and at the
+    // same time step through the transitions. We increase the peak counter
+    // until we hit the next transition and then extract the signal.
+    for (Size k = 0; k < extraction_coordinates.size(); ++k)
+    {
+      double integrated_intensity = 0;
+      if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 &&
+           (current_rt < extraction_coordinates[k].rt_start ||
+            current_rt > extraction_coordinates[k].rt_end) )
+      {
+        continue;
+      }
+
+      const bool use_im = (extraction_coordinates[k].ion_mobility >= 0.0 && has_im);
+      if (!use_im && used_filter == 1)
+      {
+        extract_value_tophat(mz_start, mz_it, mz_end, int_it,
+                             extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+      }
+      else if (use_im && used_filter == 1)
+      {
+        if (extraction_coordinates[k].ion_mobility < 0)
         {
-          throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+          std::cerr << "WARNING : Drift time of ion is negative!" << std::endl;
         }
-
-        output[k]->getTimeArray()->data.push_back(current_rt);
-        output[k]->getIntensityArray()->data.push_back(integrated_intensity);
+        extract_value_tophat(mz_start, mz_it, mz_end, int_it, im_it,
+                             extraction_coordinates[k].mz, extraction_coordinates[k].ion_mobility,
+                             integrated_intensity, mz_extraction_window, im_extraction_window, ppm);
+      }
+      else if (used_filter == 2)
+      {
+        throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
       }
+
+      output[k]->getTimeArray()->data.push_back(current_rt);
+      output[k]->getIntensityArray()->data.push_back(integrated_intensity);
     }
-    endProgress();
   }
 
   int ChromatogramExtractorAlgorithm::getFilterNr_(const String& filter)
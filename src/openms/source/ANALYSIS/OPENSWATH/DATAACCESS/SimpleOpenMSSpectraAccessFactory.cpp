@@ -34,7 +34,7 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
-#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMapped.h>
 
 namespace OpenMS
 {
@@ -69,7 +69,8 @@ namespace OpenMS
     bool is_cached = SimpleOpenMSSpectraFactory::isExperimentCached(exp);
     if (is_cached)
     {
-      OpenSwath::SpectrumAccessPtr experiment(new OpenMS::SpectrumAccessOpenMSCached(exp->getLoadedFilePath()));
+      // the mapped cache is thread-safe and its light clones do not open new file streams
+      OpenSwath::SpectrumAccessPtr experiment(new OpenMS::SpectrumAccessOpenMSCachedMapped(exp->getLoadedFilePath()));
       return experiment;
     }
     else
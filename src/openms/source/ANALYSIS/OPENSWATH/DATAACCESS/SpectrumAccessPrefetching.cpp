@@ -0,0 +1,224 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessPrefetching.h>
+
+#include <algorithm>
+
+namespace OpenMS
+{
+
+  SpectrumAccessPrefetching::SpectrumAccessPrefetching(OpenSwath::SpectrumAccessPtr sptr, Size cache_size, Size read_ahead,
+                                                       StatisticsPtr statistics) :
+    SpectrumAccessTransforming(sptr),
+    cache_size_(std::max(cache_size, Size(1))),
+    read_ahead_(std::min(read_ahead, cache_size_ / 2)),
+    statistics_(statistics),
+    io_sptr_(sptr->lightClone()),
+    last_id_(-1),
+    read_ahead_end_(0),
+    in_flight_(-1),
+    stop_(false)
+  {
+    if (!statistics_)
+    {
+      statistics_ = StatisticsPtr(new Statistics);
+    }
+  }
+
+  SpectrumAccessPrefetching::~SpectrumAccessPrefetching()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_cv_.notify_all();
+    if (io_thread_.joinable())
+    {
+      io_thread_.join();
+    }
+  }
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessPrefetching::lightClone() const
+  {
+    return boost::shared_ptr<SpectrumAccessPrefetching>(new SpectrumAccessPrefetching(sptr_->lightClone(), cache_size_, read_ahead_, statistics_));
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessPrefetching::getSpectrumById(int id)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // sequential access: keep the next read_ahead_ spectra queued
+    if (read_ahead_ > 0 && id == last_id_ + 1)
+    {
+      const int end = std::min(id + 1 + int(read_ahead_), int(sptr_->getNrSpectra()));
+      read_ahead_end_ = std::max(read_ahead_end_, id + 1);
+      while (read_ahead_end_ < end && enqueue_(read_ahead_end_))
+      {
+        ++read_ahead_end_;
+      }
+    }
+    last_id_ = id;
+
+    // wait if the background thread is currently reading this spectrum
+    bool late = false;
+    if (in_flight_ == id)
+    {
+      loaded_cv_.wait(lock, [this, id]() { return in_flight_ != id; });
+      late = true;
+    }
+
+    auto it = cache_index_.find(id);
+    if (it != cache_index_.end())
+    {
+      cache_.splice(cache_.begin(), cache_, it->second);
+      if (late)
+      {
+        ++statistics_->late_hits;
+      }
+      else
+      {
+        ++statistics_->hits;
+      }
+      return it->second->second;
+    }
+
+    // not available (yet): read it ourselves and make sure the background thread skips it
+    queued_.erase(id);
+    lock.unlock();
+    OpenSwath::SpectrumPtr spectrum = sptr_->getSpectrumById(id);
+    ++statistics_->misses;
+    lock.lock();
+    insert_(id, spectrum);
+    return spectrum;
+  }
+
+  std::vector<std::size_t> SpectrumAccessPrefetching::getSpectraByRT(double RT, double deltaRT) const
+  {
+    std::vector<std::size_t> ids = sptr_->getSpectraByRT(RT, deltaRT);
+    prefetch(ids);
+    return ids;
+  }
+
+  void SpectrumAccessPrefetching::prefetch(const std::vector<std::size_t>& ids) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t id : ids)
+    {
+      if (!enqueue_(int(id))) break;
+    }
+  }
+
+  const SpectrumAccessPrefetching::StatisticsPtr& SpectrumAccessPrefetching::getStatistics() const
+  {
+    return statistics_;
+  }
+
+  bool SpectrumAccessPrefetching::enqueue_(int id) const
+  {
+    // do not queue more than fits into the cache, otherwise prefetched spectra get evicted before use
+    if (queued_.size() > cache_size_ / 2)
+    {
+      return false;
+    }
+    if (cache_index_.count(id) > 0 || in_flight_ == id || !queued_.insert(id).second)
+    {
+      return true;
+    }
+    queue_.push_back(id);
+    if (!io_thread_.joinable())
+    {
+      io_thread_ = std::thread(&SpectrumAccessPrefetching::ioLoop_, this);
+    }
+    work_cv_.notify_one();
+    return true;
+  }
+
+  void SpectrumAccessPrefetching::insert_(int id, const OpenSwath::SpectrumPtr& spectrum) const
+  {
+    auto it = cache_index_.find(id);
+    if (it != cache_index_.end())
+    {
+      cache_.splice(cache_.begin(), cache_, it->second);
+      return;
+    }
+    cache_.emplace_front(id, spectrum);
+    cache_index_[id] = cache_.begin();
+    if (cache_.size() > cache_size_)
+    {
+      cache_index_.erase(cache_.back().first);
+      cache_.pop_back();
+    }
+  }
+
+  void SpectrumAccessPrefetching::ioLoop_() const
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      work_cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (stop_)
+      {
+        return;
+      }
+      const int id = queue_.front();
+      queue_.pop_front();
+      if (queued_.erase(id) == 0 || cache_index_.count(id) > 0)
+      {
+        continue; // already read by the calling thread
+      }
+
+      in_flight_ = id;
+      lock.unlock();
+      OpenSwath::SpectrumPtr spectrum;
+      try
+      {
+        spectrum = io_sptr_->getSpectrumById(id);
+      }
+      catch (...)
+      {
+        // leave it to the calling thread to read (and report) it
+      }
+      lock.lock();
+      in_flight_ = -1;
+      if (spectrum)
+      {
+        insert_(id, spectrum);
+        ++statistics_->prefetched;
+      }
+      loaded_cv_.notify_all();
+    }
+  }
+
+}
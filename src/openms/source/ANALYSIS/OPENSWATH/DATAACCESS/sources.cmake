@@ -6,7 +6,9 @@ set(sources_list
 MRMFeatureAccessOpenMS.cpp
 SpectrumAccessOpenMS.cpp
 SpectrumAccessOpenMSCached.cpp
+SpectrumAccessOpenMSCachedMapped.cpp
 SpectrumAccessOpenMSInMemory.cpp
+SpectrumAccessPrefetching.cpp
 SpectrumAccessSqMass.cpp
 SpectrumAccessTransforming.cpp
 SpectrumAccessQuadMZTransforming.cpp
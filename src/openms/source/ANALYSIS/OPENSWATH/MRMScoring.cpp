@@ -50,31 +50,54 @@ namespace OpenSwath
       return xcorr_matrix_;
     }
 
-    void MRMScoring::initializeXCorrMatrix(const std::vector< std::vector< double > >& data)
+    /// standardize all traces (zero mean, unit standard deviation)
+    void standardizeTraces(std::vector<std::vector<double>>& data)
     {
-      xcorr_matrix_.resize(data.size(), data.size());
-      xcorr_matrix_max_peak_.resize(data.size(), data.size());
-      xcorr_matrix_max_peak_sec_.resize(data.size(), data.size());
-
-      std::vector< std::vector< double > > tmp_data = data;
-      for (std::size_t i = 0; i < tmp_data.size(); i++)
+      for (std::size_t i = 0; i < data.size(); i++)
       {
-        Scoring::standardize_data(tmp_data[i]);
+        Scoring::standardize_data(data[i]);
       }
+    }
 
-      for (std::size_t i = 0; i < data.size(); i++)
+    /// cross-correlate all (standardized) traces of data1 with all traces of data2, only the upper triangle (j >= i) if symmetric
+    void fillXCorrMatrix(std::vector<std::vector<double>>& data1, std::vector<std::vector<double>>& data2,
+                         bool symmetric, MRMScoring::XCorrMatrixType& matrix)
+    {
+      matrix.resize(data1.size(), data2.size());
+      for (std::size_t i = 0; i < data1.size(); i++)
       {
-        for (std::size_t j = i; j < data.size(); j++)
+        for (std::size_t j = (symmetric ? i : 0); j < data2.size(); j++)
         {
           // compute normalized cross correlation
-          xcorr_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(tmp_data[i], tmp_data[j], static_cast<int>(data[i].size()), 1));
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_.getValue(i, j));
-          xcorr_matrix_max_peak_.setValue(i, j, std::abs(x->first));
-          xcorr_matrix_max_peak_sec_.setValue(i, j, x->second);
+          matrix.getValue(i, j) = Scoring::normalizedCrossCorrelationPost(data1[i], data2[j], static_cast<int>(data1[i].size()), 1);
         }
       }
     }
 
+    /// compute the position and height of the maximum of each cross-correlation in the upper triangle
+    void fillXCorrMaxPeaks(const MRMScoring::XCorrMatrixType& matrix, OpenMS::Matrix<int>& max_peak, OpenMS::Matrix<double>& max_peak_sec)
+    {
+      max_peak.resize(matrix.rows(), matrix.cols());
+      max_peak_sec.resize(matrix.rows(), matrix.cols());
+      for (std::size_t i = 0; i < matrix.rows(); i++)
+      {
+        for (std::size_t j = i; j < matrix.cols(); j++)
+        {
+          auto x = Scoring::xcorrArrayGetMaxPeak(matrix.getValue(i, j));
+          max_peak.setValue(i, j, std::abs(x->first));
+          max_peak_sec.setValue(i, j, x->second);
+        }
+      }
+    }
+
+    void MRMScoring::initializeXCorrMatrix(const std::vector< std::vector< double > >& data)
+    {
+      std::vector< std::vector< double > > tmp_data = data;
+      standardizeTraces(tmp_data);
+      fillXCorrMatrix(tmp_data, tmp_data, true, xcorr_matrix_);
+      fillXCorrMaxPeaks(xcorr_matrix_, xcorr_matrix_max_peak_, xcorr_matrix_max_peak_sec_);
+    }
+
     const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrContrastMatrix() const
     {
       return xcorr_contrast_matrix_;
@@ -114,49 +137,25 @@ namespace OpenSwath
     {
       std::vector<std::vector<double>> intensity;
       fillIntensityFromFeature(mrmfeature, native_ids, intensity);
-      for (std::size_t i = 0; i < intensity.size(); i++)
-      {
-        Scoring::standardize_data(intensity[i]);
-      }
-
-      xcorr_matrix_.resize(native_ids.size(), native_ids.size());
-      xcorr_matrix_max_peak_.resize(native_ids.size(), native_ids.size());
-      xcorr_matrix_max_peak_sec_.resize(native_ids.size(), native_ids.size());
-      for (std::size_t i = 0; i < native_ids.size(); i++)
-      {
-        for (std::size_t j = i; j < native_ids.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensity[i], intensity[j], static_cast<int>(intensity[i].size()), 1));
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_.getValue(i, j));
-          xcorr_matrix_max_peak_.setValue(i, j, std::abs(x->first));
-          xcorr_matrix_max_peak_sec_.setValue(i, j, x->second);
-        }
-      }
+      standardizeTraces(intensity);
+      fillXCorrMatrix(intensity, intensity, true, xcorr_matrix_);
+      fillXCorrMaxPeaks(xcorr_matrix_, xcorr_matrix_max_peak_, xcorr_matrix_max_peak_sec_);
     }
 
     void MRMScoring::initializeXCorrContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2)
     {
       std::vector<std::vector<double>> intensityi, intensityj;
       fillIntensityFromFeature(mrmfeature, native_ids_set1, intensityi);
-      for (std::size_t i = 0; i < intensityi.size(); i++)
-      {
-        Scoring::standardize_data(intensityi[i]);
-      }
+      standardizeTraces(intensityi);
       fillIntensityFromFeature(mrmfeature, native_ids_set2, intensityj);
-      for (std::size_t i = 0; i < intensityj.size(); i++)
-      {
-        Scoring::standardize_data(intensityj[i]);
-      }
+      standardizeTraces(intensityj);
+      fillXCorrMatrix(intensityi, intensityj, false, xcorr_contrast_matrix_);
 
-      xcorr_contrast_matrix_.resize(native_ids_set1.size(), native_ids_set2.size());
       xcorr_contrast_matrix_max_peak_sec_.resize(native_ids_set1.size(), native_ids_set2.size());
       for (std::size_t i = 0; i < native_ids_set1.size(); i++)
       {
         for (std::size_t j = 0; j < native_ids_set2.size(); j++)
         {
-          // compute normalized cross correlation
-          xcorr_contrast_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensityi[i], intensityj[j], static_cast<int>(intensityi[i].size()), 1));
           auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_contrast_matrix_.getValue(i, j));
           xcorr_contrast_matrix_max_peak_sec_.setValue(i, j, x->second);
         }
@@ -167,100 +166,74 @@ namespace OpenSwath
     {
       std::vector<std::vector<double>> intensity;
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensity);
-      for (std::size_t i = 0; i < intensity.size(); i++)
-      {
-        Scoring::standardize_data(intensity[i]);
-      }
-
-      xcorr_precursor_matrix_.resize(precursor_ids.size(), precursor_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = i; j < precursor_ids.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_precursor_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensity[i], intensity[j], static_cast<int>(intensity[i].size()), 1));
-        }
-      }
+      standardizeTraces(intensity);
+      fillXCorrMatrix(intensity, intensity, true, xcorr_precursor_matrix_);
     }
 
     void MRMScoring::initializeXCorrPrecursorContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
     {
       std::vector<std::vector<double>> intensityi, intensityj;
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensityi);
-      for (std::size_t i = 0; i < intensityi.size(); i++)
-      {
-        Scoring::standardize_data(intensityi[i]);
-      }
+      standardizeTraces(intensityi);
       fillIntensityFromFeature(mrmfeature, native_ids, intensityj);
-      for (std::size_t i = 0; i < intensityj.size(); i++)
-      {
-        Scoring::standardize_data(intensityj[i]);
-      }
-
-      xcorr_precursor_contrast_matrix_.resize(precursor_ids.size(), native_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = 0; j < native_ids.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_precursor_contrast_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensityi[i], intensityj[j], static_cast<int>(intensityi[i].size()), 1));
-        }
-      }
+      standardizeTraces(intensityj);
+      fillXCorrMatrix(intensityi, intensityj, false, xcorr_precursor_contrast_matrix_);
     }
 
     void MRMScoring::initializeXCorrPrecursorContrastMatrix(const std::vector< std::vector< double > >& data_precursor, const std::vector< std::vector< double > >& data_fragments)
     {
-      xcorr_precursor_contrast_matrix_.resize(data_precursor.size(), data_fragments.size());
       std::vector< std::vector< double > > tmp_data_precursor = data_precursor;
       std::vector< std::vector< double > > tmp_data_fragments = data_fragments;
-      for (std::size_t i = 0; i < tmp_data_precursor.size(); i++)
-      {
-        Scoring::standardize_data(tmp_data_precursor[i]);
-      }
-      for (std::size_t i = 0; i < tmp_data_fragments.size(); i++)
-      {
-        Scoring::standardize_data(tmp_data_fragments[i]);
-      }
-
-      for (std::size_t i = 0; i < data_precursor.size(); i++)
-      {
-        for (std::size_t j = 0; j < data_fragments.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_precursor_contrast_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(tmp_data_precursor[i], tmp_data_fragments[j], static_cast<int>(tmp_data_precursor[i].size()), 1));
-#ifdef MRMSCORING_TESTING
-          std::cout << " fill xcorr_precursor_contrast_matrix_ "<< tmp_data_precursor[i].size() << " / " << tmp_data_fragments[j].size() << " : " << xcorr_precursor_contrast_matrix_[i][j].data.size() << std::endl;
-#endif
-        }
-      }
+      standardizeTraces(tmp_data_precursor);
+      standardizeTraces(tmp_data_fragments);
+      fillXCorrMatrix(tmp_data_precursor, tmp_data_fragments, false, xcorr_precursor_contrast_matrix_);
     }
 
     void MRMScoring::initializeXCorrPrecursorCombinedMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
     {
-      std::vector<std::vector<double>> intensityi, intensityj;
-      fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensityi);
+      std::vector<std::vector<double>> combined_intensity, intensityj;
+      fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, combined_intensity);
       fillIntensityFromFeature(mrmfeature, native_ids, intensityj);
-      std::vector<std::vector<double>> combined_intensity;
-      for (std::size_t i = 0; i < intensityi.size(); i++)
-      {
-        combined_intensity.push_back(intensityi[i]);
-      }
-      for (std::size_t j = 0; j < intensityj.size(); j++)
-      {
-        combined_intensity.push_back(intensityj[j]);
-      }
-      for (std::size_t i = 0; i < combined_intensity.size(); i++)
-      {
-        Scoring::standardize_data(combined_intensity[i]);
-      }
+      combined_intensity.insert(combined_intensity.end(), intensityj.begin(), intensityj.end());
+      standardizeTraces(combined_intensity);
+      fillXCorrMatrix(combined_intensity, combined_intensity, true, xcorr_precursor_combined_matrix_);
+    }
 
-      xcorr_precursor_combined_matrix_.resize(combined_intensity.size(), combined_intensity.size());
-      for (std::size_t i = 0; i < combined_intensity.size(); i++)
+    void MRMScoring::initializeXCorrMatrices(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids, const std::vector<std::string>& precursor_ids)
+    {
+      // fragment traces (standardized only once for all matrices)
+      std::vector<std::vector<double>> fragments;
+      fillIntensityFromFeature(mrmfeature, native_ids, fragments);
+      standardizeTraces(fragments);
+      fillXCorrMatrix(fragments, fragments, true, xcorr_matrix_);
+      fillXCorrMaxPeaks(xcorr_matrix_, xcorr_matrix_max_peak_, xcorr_matrix_max_peak_sec_);
+
+      std::vector<std::vector<double>> precursors;
+      fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, precursors);
+      standardizeTraces(precursors);
+      fillXCorrMatrix(precursors, precursors, true, xcorr_precursor_matrix_);
+      fillXCorrMatrix(precursors, fragments, false, xcorr_precursor_contrast_matrix_);
+
+      // the combined matrix (precursors followed by fragments) consists of the blocks computed above
+      const std::size_t nr_precursors = precursors.size();
+      const std::size_t nr_traces = nr_precursors + fragments.size();
+      xcorr_precursor_combined_matrix_.resize(nr_traces, nr_traces);
+      for (std::size_t i = 0; i < nr_traces; i++)
       {
-        for (std::size_t j = i; j < combined_intensity.size(); j++)
+        for (std::size_t j = i; j < nr_traces; j++)
         {
-          // compute normalized cross correlation
-          xcorr_precursor_combined_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(combined_intensity[i], combined_intensity[j], static_cast<int>(combined_intensity[i].size()), 1));
+          if (i >= nr_precursors)
+          {
+            xcorr_precursor_combined_matrix_.setValue(i, j, xcorr_matrix_.getValue(i - nr_precursors, j - nr_precursors));
+          }
+          else if (j >= nr_precursors)
+          {
+            xcorr_precursor_combined_matrix_.setValue(i, j, xcorr_precursor_contrast_matrix_.getValue(i, j - nr_precursors));
+          }
+          else
+          {
+            xcorr_precursor_combined_matrix_.setValue(i, j, xcorr_precursor_matrix_.getValue(i, j));
+          }
         }
       }
     }
@@ -754,23 +727,31 @@ namespace OpenSwath
       return mi_precursor_combined_matrix_;
     }
 
-    void MRMScoring::initializeMIMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids)
+    /// compute the ranked mutual information of all traces of ranks1 with all traces of ranks2, only the upper triangle (j >= i) if symmetric
+    void fillMIMatrix(std::vector<std::vector<unsigned int>>& ranks1, const std::vector<unsigned int>& max_ranks1,
+                      std::vector<std::vector<unsigned int>>& ranks2, const std::vector<unsigned int>& max_ranks2,
+                      bool symmetric, OpenMS::Matrix<double>& matrix)
     {
-      std::vector<std::vector<double>> intensity;
-      std::vector<std::vector<unsigned int>> rank_vec{};
-      fillIntensityFromFeature(mrmfeature, native_ids, intensity);
-      std::vector<unsigned int> max_rank_vec = Scoring::computeRankVector(intensity, rank_vec);
-
-      mi_matrix_.resize(native_ids.size(),native_ids.size());  
-      for (std::size_t i = 0; i < native_ids.size(); i++)
+      matrix.resize(ranks1.size(), ranks2.size());
+      for (std::size_t i = 0; i < ranks1.size(); i++)
       {
-        for (std::size_t j = i; j < native_ids.size(); j++)
+        for (std::size_t j = (symmetric ? i : 0); j < ranks2.size(); j++)
         {
           // compute ranked mutual information
-          mi_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec[i], rank_vec[j], max_rank_vec[i], max_rank_vec[j]));
+          matrix.setValue(i, j, Scoring::rankedMutualInformation(ranks1[i], ranks2[j], max_ranks1[i], max_ranks2[j]));
         }
       }
     }
+
+    void MRMScoring::initializeMIMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids)
+    {
+      std::vector<std::vector<double>> intensity;
+      std::vector<std::vector<unsigned int>> rank_vec{};
+      fillIntensityFromFeature(mrmfeature, native_ids, intensity);
+      std::vector<unsigned int> max_rank_vec = Scoring::computeRankVector(intensity, rank_vec);
+      fillMIMatrix(rank_vec, max_rank_vec, rank_vec, max_rank_vec, true, mi_matrix_);
+    }
+
     void MRMScoring::initializeMIContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2)
     { 
       std::vector<std::vector<double>> intensityi, intensityj;
@@ -779,16 +760,7 @@ namespace OpenSwath
       fillIntensityFromFeature(mrmfeature, native_ids_set2, intensityj);
       std::vector<unsigned int> max_rank_vec1 = Scoring::computeRankVector(intensityi, rank_vec1);
       std::vector<unsigned int> max_rank_vec2 = Scoring::computeRankVector(intensityj, rank_vec2);
-
-      mi_contrast_matrix_.resize(native_ids_set1.size(), native_ids_set2.size());
-      for (std::size_t i = 0; i < native_ids_set1.size(); i++)
-      {
-        for (std::size_t j = 0; j < native_ids_set2.size(); j++)
-        {
-          // compute ranked mutual information
-          mi_contrast_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec1[i], rank_vec2[j], max_rank_vec1[i], max_rank_vec2[j]));
-        }
-      }
+      fillMIMatrix(rank_vec1, max_rank_vec1, rank_vec2, max_rank_vec2, false, mi_contrast_matrix_);
     }
 
     void MRMScoring::initializeMIPrecursorMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids)
@@ -797,16 +769,7 @@ namespace OpenSwath
       std::vector<std::vector<unsigned int>> rank_vec{};
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensity);
       std::vector<unsigned int> max_rank_vec = Scoring::computeRankVector(intensity, rank_vec);
-
-      mi_precursor_matrix_.resize(precursor_ids.size(),precursor_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = i; j < precursor_ids.size(); j++)
-        {
-          // compute ranked mutual information
-          mi_precursor_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec[i], rank_vec[j], max_rank_vec[i], max_rank_vec[j]));
-        }
-      }
+      fillMIMatrix(rank_vec, max_rank_vec, rank_vec, max_rank_vec, true, mi_precursor_matrix_);
     }
 
     void MRMScoring::initializeMIPrecursorContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
@@ -817,16 +780,7 @@ namespace OpenSwath
       fillIntensityFromFeature(mrmfeature, native_ids, intensityj);
       std::vector<unsigned int> max_rank_vec1 = Scoring::computeRankVector(intensityi, rank_vec1);
       std::vector<unsigned int> max_rank_vec2 = Scoring::computeRankVector(intensityj, rank_vec2);
-
-      mi_precursor_contrast_matrix_.resize(precursor_ids.size(), native_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = 0; j < native_ids.size(); j++)
-        {
-          // compute ranked mutual information
-          mi_precursor_contrast_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec1[i], rank_vec2[j], max_rank_vec1[i], max_rank_vec2[j]));
-        }
-      }
+      fillMIMatrix(rank_vec1, max_rank_vec1, rank_vec2, max_rank_vec2, false, mi_precursor_contrast_matrix_);
     }
 
     void MRMScoring::initializeMIPrecursorCombinedMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
@@ -840,19 +794,61 @@ namespace OpenSwath
       std::vector<unsigned int> max_rank_vec_tmp = Scoring::computeRankVector(intensity, rank_vec);
       max_rank_vec.reserve(max_rank_vec.size() + native_ids.size());
       max_rank_vec.insert(max_rank_vec.end(), max_rank_vec_tmp.begin(), max_rank_vec_tmp.end());
-      
-      mi_precursor_combined_matrix_.resize(rank_vec.size(), rank_vec.size());
+
+      fillMIMatrix(rank_vec, max_rank_vec, rank_vec, max_rank_vec, true, mi_precursor_combined_matrix_);
       for (std::size_t i = 0; i < rank_vec.size(); i++)
-      { 
-        for (std::size_t j = i; j < rank_vec.size(); j++)
+      {
+        for (std::size_t j = i + 1; j < rank_vec.size(); j++)
         {
-          // compute ranked mutual information
-          double curr_mutual_score = Scoring::rankedMutualInformation(rank_vec[i], rank_vec[j], max_rank_vec[i], max_rank_vec[j]);
-          mi_precursor_combined_matrix_.setValue(i ,j, curr_mutual_score);
-          mi_precursor_combined_matrix_.setValue(j ,i, curr_mutual_score);
+          mi_precursor_combined_matrix_.setValue(j, i, mi_precursor_combined_matrix_.getValue(i, j));
+        }
+      }
+    }
+
+    void MRMScoring::initializeMIMatrices(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids, const std::vector<std::string>& precursor_ids)
+    {
+      // fragment ranks (computed only once for all matrices)
+      std::vector<std::vector<double>> intensity;
+      std::vector<std::vector<unsigned int>> fragment_ranks{};
+      fillIntensityFromFeature(mrmfeature, native_ids, intensity);
+      std::vector<unsigned int> max_fragment_ranks = Scoring::computeRankVector(intensity, fragment_ranks);
+      fillMIMatrix(fragment_ranks, max_fragment_ranks, fragment_ranks, max_fragment_ranks, true, mi_matrix_);
+
+      std::vector<std::vector<unsigned int>> precursor_ranks{};
+      // fillIntensityFrom*() only resize the outer vector and the features append their points, so start from an empty buffer
+      intensity.clear();
+      fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensity);
+      std::vector<unsigned int> max_precursor_ranks = Scoring::computeRankVector(intensity, precursor_ranks);
+      fillMIMatrix(precursor_ranks, max_precursor_ranks, precursor_ranks, max_precursor_ranks, true, mi_precursor_matrix_);
+      fillMIMatrix(precursor_ranks, max_precursor_ranks, fragment_ranks, max_fragment_ranks, false, mi_precursor_contrast_matrix_);
+
+      // the (symmetric) combined matrix (precursors followed by fragments) consists of the blocks computed above
+      const std::size_t nr_precursors = precursor_ranks.size();
+      const std::size_t nr_traces = nr_precursors + fragment_ranks.size();
+      mi_precursor_combined_matrix_.resize(nr_traces, nr_traces);
+      for (std::size_t i = 0; i < nr_traces; i++)
+      {
+        for (std::size_t j = i; j < nr_traces; j++)
+        {
+          double mutual_score;
+          if (i >= nr_precursors)
+          {
+            mutual_score = mi_matrix_.getValue(i - nr_precursors, j - nr_precursors);
+          }
+          else if (j >= nr_precursors)
+          {
+            mutual_score = mi_precursor_contrast_matrix_.getValue(i, j - nr_precursors);
+          }
+          else
+          {
+            mutual_score = mi_precursor_matrix_.getValue(i, j);
+          }
+          mi_precursor_combined_matrix_.setValue(i, j, mutual_score);
+          mi_precursor_combined_matrix_.setValue(j, i, mutual_score);
         }
       }
     }
+
     double MRMScoring::calcMIScore()
     {
       OPENSWATH_PRECONDITION(mi_matrix_.rows() > 1, "Expect mutual information matrix of at least 2x2");
@@ -0,0 +1,711 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/MappedTransitionLibrary.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char TRANSITION_LIBRARY_MAGIC[8] = {'O', 'M', 'S', 'T', 'R', 'L', 'I', 'B'};
+    const UInt32 TRANSITION_LIBRARY_VERSION = 1;
+    const UInt32 TRANSITION_LIBRARY_BOM = 0x01020304;
+
+    /// number of strings stored per compound and per protein
+    const Size COMPOUND_STRINGS = 6;
+    const Size PROTEIN_STRINGS = 2;
+
+    /// bits of the transition flags
+    enum TransitionFlag_
+    {
+      DECOY = 1,
+      DETECTING = 2,
+      QUANTIFYING = 4,
+      IDENTIFYING = 8
+    };
+
+    /// Appends 8 byte aligned sections to a library image
+    class ImageWriter_
+    {
+    public:
+      explicit ImageWriter_(vector<char>& image) :
+        image_(image)
+      {
+      }
+
+      void append(const void* data, Size size)
+      {
+        const char* begin = static_cast<const char*>(data);
+        image_.insert(image_.end(), begin, begin + size);
+      }
+
+      template <typename T>
+      void section(const vector<T>& data)
+      {
+        const UInt64 bytes = data.size() * sizeof(T);
+        append(&bytes, sizeof(bytes));
+        if (bytes > 0)
+        {
+          append(data.data(), bytes);
+        }
+        image_.resize((image_.size() + 7) / 8 * 8, 0);
+      }
+
+    private:
+      vector<char>& image_;
+    };
+
+    /// Reads the sections of a library image (with bounds checks)
+    class ImageReader_
+    {
+    public:
+      ImageReader_(const char* data, Size size, const String& filename) :
+        data_(data), size_(size), filename_(filename)
+      {
+      }
+
+      void read(void* target, Size size)
+      {
+        check_(size);
+        memcpy(target, data_ + pos_, size);
+        pos_ += size;
+      }
+
+      /// returns the start of the next section and sets @p count to the number of elements in it
+      template <typename T>
+      const T* section(Size& count)
+      {
+        UInt64 bytes;
+        read(&bytes, sizeof(bytes));
+        check_(bytes);
+        if (bytes % sizeof(T) != 0)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Corrupt transition library (invalid section size).");
+        }
+        const char* begin = data_ + pos_;
+        pos_ = min(size_, Size((pos_ + bytes + 7) / 8 * 8));
+        count = bytes / sizeof(T);
+        return reinterpret_cast<const T*>(begin);
+      }
+
+      /// returns the start of the next section, which must contain @p expected_count elements
+      template <typename T>
+      const T* section(Size expected_count, const char* name)
+      {
+        Size count;
+        const T* begin = section<T>(count);
+        if (count != expected_count)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, String("Corrupt transition library (unexpected size of section '") + name + "').");
+        }
+        return begin;
+      }
+
+    private:
+      void check_(Size size) const
+      {
+        if (size > size_ - pos_)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Unexpected end of transition library.");
+        }
+      }
+
+      const char* data_;
+      Size size_;
+      Size pos_ = 0;
+      const String& filename_;
+    };
+
+    /// Content of the sections of a library image
+    struct Sections_
+    {
+      UInt64 n_compounds = 0;
+      UInt64 n_transitions = 0;
+      UInt64 n_proteins = 0;
+
+      vector<UInt64> string_offsets = {0};
+      vector<char> strings;
+
+      vector<double> compound_mz;
+      vector<double> compound_rt;
+      vector<double> compound_drift_time;
+      vector<Int32> compound_charge;
+      vector<UInt32> compound_strings;
+      vector<UInt64> transition_offsets = {0};
+      vector<UInt64> protein_ref_offsets = {0};
+      vector<UInt32> protein_refs;
+      vector<UInt64> modification_offsets = {0};
+      vector<Int32> modifications;
+      vector<UInt32> rt_order;
+      vector<UInt32> id_order;
+
+      vector<UInt32> transition_names;
+      vector<double> transition_product_mz;
+      vector<double> transition_precursor_mz;
+      vector<double> transition_precursor_im;
+      vector<double> transition_intensity;
+      vector<Int32> transition_charge;
+      vector<unsigned char> transition_flags;
+
+      vector<UInt32> protein_strings;
+    };
+
+    /// Interns strings into the string pool of a library image
+    class StringPool_
+    {
+    public:
+      explicit StringPool_(Sections_& sections) :
+        sections_(sections)
+      {
+        add("");
+      }
+
+      UInt32 add(const std::string& s)
+      {
+        auto it = ids_.find(s);
+        if (it != ids_.end())
+        {
+          return it->second;
+        }
+        if (sections_.string_offsets.size() >= Size(numeric_limits<UInt32>::max()))
+        {
+          throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sections_.string_offsets.size());
+        }
+        const UInt32 id = UInt32(sections_.string_offsets.size() - 1);
+        sections_.strings.insert(sections_.strings.end(), s.begin(), s.end());
+        sections_.string_offsets.push_back(sections_.strings.size());
+        ids_.emplace(s, id);
+        return id;
+      }
+
+    private:
+      Sections_& sections_;
+      unordered_map<std::string, UInt32> ids_;
+    };
+
+    vector<char> createImage_(const Sections_& s)
+    {
+      vector<char> image;
+      ImageWriter_ writer(image);
+      writer.append(TRANSITION_LIBRARY_MAGIC, sizeof(TRANSITION_LIBRARY_MAGIC));
+      writer.append(&TRANSITION_LIBRARY_VERSION, sizeof(TRANSITION_LIBRARY_VERSION));
+      writer.append(&TRANSITION_LIBRARY_BOM, sizeof(TRANSITION_LIBRARY_BOM));
+      writer.append(&s.n_compounds, sizeof(s.n_compounds));
+      writer.append(&s.n_transitions, sizeof(s.n_transitions));
+      writer.append(&s.n_proteins, sizeof(s.n_proteins));
+      writer.section(s.string_offsets);
+      writer.section(s.strings);
+      writer.section(s.compound_mz);
+      writer.section(s.compound_rt);
+      writer.section(s.compound_drift_time);
+      writer.section(s.compound_charge);
+      writer.section(s.compound_strings);
+      writer.section(s.transition_offsets);
+      writer.section(s.protein_ref_offsets);
+      writer.section(s.protein_refs);
+      writer.section(s.modification_offsets);
+      writer.section(s.modifications);
+      writer.section(s.rt_order);
+      writer.section(s.id_order);
+      writer.section(s.transition_names);
+      writer.section(s.transition_product_mz);
+      writer.section(s.transition_precursor_mz);
+      writer.section(s.transition_precursor_im);
+      writer.section(s.transition_intensity);
+      writer.section(s.transition_charge);
+      writer.section(s.transition_flags);
+      writer.section(s.protein_strings);
+      return image;
+    }
+
+    /// checks that @p offsets (n + 1 values) start at zero, are non-decreasing and end at @p arena_size
+    bool validOffsets_(const UInt64* offsets, Size n, Size arena_size)
+    {
+      return offsets[0] == 0 && offsets[n] == arena_size && is_sorted(offsets, offsets + n + 1);
+    }
+
+    /// checks that all @p n values in @p indices are smaller than @p max_index
+    bool validIndices_(const UInt32* indices, Size n, Size max_index)
+    {
+      return all_of(indices, indices + n, [max_index](UInt32 i) { return i < max_index; });
+    }
+  }
+
+  MappedTransitionLibrary::MappedTransitionLibrary() :
+    buffer_(createImage_(Sections_()))
+  {
+    attach_(buffer_.data(), buffer_.size(), "");
+  }
+
+  void MappedTransitionLibrary::build(const OpenSwath::LightTargetedExperiment& exp)
+  {
+    const vector<OpenSwath::LightCompound>& compounds = exp.getCompounds();
+    const vector<OpenSwath::LightTransition>& transitions = exp.getTransitions();
+    const vector<OpenSwath::LightProtein>& proteins = exp.getProteins();
+    const Size max_size = numeric_limits<UInt32>::max();
+    if (compounds.size() >= max_size || transitions.size() >= max_size || proteins.size() >= max_size)
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, max(compounds.size(), transitions.size()));
+    }
+
+    // group the transitions by compound (keeping their order)
+    unordered_map<std::string, UInt32> compound_index;
+    compound_index.reserve(compounds.size());
+    for (Size i = 0; i < compounds.size(); ++i)
+    {
+      compound_index.emplace(compounds[i].id, UInt32(i));
+    }
+    vector<UInt64> group_offsets(compounds.size() + 1, 0);
+    vector<UInt32> transition_compound(transitions.size());
+    for (Size i = 0; i < transitions.size(); ++i)
+    {
+      auto it = compound_index.find(transitions[i].peptide_ref);
+      if (it == compound_index.end())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                         "Transition '" + transitions[i].transition_name + "' references unknown compound '" + transitions[i].peptide_ref + "'.");
+      }
+      transition_compound[i] = it->second;
+      ++group_offsets[it->second + 1];
+    }
+    partial_sum(group_offsets.begin(), group_offsets.end(), group_offsets.begin());
+    vector<UInt32> grouped_transitions(transitions.size());
+    {
+      vector<UInt64> next(group_offsets.begin(), group_offsets.end() - 1);
+      for (Size i = 0; i < transitions.size(); ++i)
+      {
+        grouped_transitions[next[transition_compound[i]]++] = UInt32(i);
+      }
+    }
+    compound_index.clear();
+    transition_compound.clear();
+    transition_compound.shrink_to_fit();
+
+    // sort the compounds by precursor m/z (ties are broken by the original order)
+    vector<double> precursor_mz(compounds.size(), 0.0);
+    for (Size i = 0; i < compounds.size(); ++i)
+    {
+      if (group_offsets[i] != group_offsets[i + 1])
+      {
+        precursor_mz[i] = transitions[grouped_transitions[group_offsets[i]]].precursor_mz;
+      }
+    }
+    vector<UInt32> mz_order(compounds.size());
+    iota(mz_order.begin(), mz_order.end(), 0);
+    stable_sort(mz_order.begin(), mz_order.end(), [&precursor_mz](UInt32 a, UInt32 b) { return precursor_mz[a] < precursor_mz[b]; });
+
+    // assemble the sections of the image
+    Sections_ s;
+    StringPool_ pool(s);
+    s.n_compounds = compounds.size();
+    s.n_transitions = transitions.size();
+    s.n_proteins = proteins.size();
+
+    for (UInt32 c : mz_order)
+    {
+      const OpenSwath::LightCompound& compound = compounds[c];
+      s.compound_mz.push_back(precursor_mz[c]);
+      s.compound_rt.push_back(compound.rt);
+      s.compound_drift_time.push_back(compound.drift_time);
+      s.compound_charge.push_back(compound.charge);
+      for (const std::string* str : {&compound.id, &compound.sequence, &compound.peptide_group_label,
+                                     &compound.gene_name, &compound.sum_formula, &compound.compound_name})
+      {
+        s.compound_strings.push_back(pool.add(*str));
+      }
+      for (const std::string& protein_ref : compound.protein_refs)
+      {
+        s.protein_refs.push_back(pool.add(protein_ref));
+      }
+      s.protein_ref_offsets.push_back(s.protein_refs.size());
+      for (const OpenSwath::LightModification& mod : compound.modifications)
+      {
+        s.modifications.push_back(mod.location);
+        s.modifications.push_back(mod.unimod_id);
+      }
+      s.modification_offsets.push_back(s.modifications.size() / 2);
+
+      for (Size k = group_offsets[c]; k < group_offsets[c + 1]; ++k)
+      {
+        const OpenSwath::LightTransition& tr = transitions[grouped_transitions[k]];
+        s.transition_names.push_back(pool.add(tr.transition_name));
+        s.transition_product_mz.push_back(tr.product_mz);
+        s.transition_precursor_mz.push_back(tr.precursor_mz);
+        s.transition_precursor_im.push_back(tr.precursor_im);
+        s.transition_intensity.push_back(tr.library_intensity);
+        s.transition_charge.push_back(tr.fragment_charge);
+        s.transition_flags.push_back(static_cast<unsigned char>((tr.decoy ? DECOY : 0) |
+                                                                (tr.detecting_transition ? DETECTING : 0) |
+                                                                (tr.quantifying_transition ? QUANTIFYING : 0) |
+                                                                (tr.identifying_transition ? IDENTIFYING : 0)));
+      }
+      s.transition_offsets.push_back(s.transition_names.size());
+    }
+    for (const OpenSwath::LightProtein& protein : proteins)
+    {
+      s.protein_strings.push_back(pool.add(protein.id));
+      s.protein_strings.push_back(pool.add(protein.sequence));
+    }
+
+    // secondary indices (by retention time and by compound id)
+    auto pooled = [&s](UInt32 id) { return StringView(s.strings.data() + s.string_offsets[id], s.string_offsets[id + 1] - s.string_offsets[id]); };
+    s.rt_order.resize(compounds.size());
+    iota(s.rt_order.begin(), s.rt_order.end(), 0);
+    stable_sort(s.rt_order.begin(), s.rt_order.end(), [&s](UInt32 a, UInt32 b) { return s.compound_rt[a] < s.compound_rt[b]; });
+    s.id_order.resize(compounds.size());
+    iota(s.id_order.begin(), s.id_order.end(), 0);
+    stable_sort(s.id_order.begin(), s.id_order.end(), [&s, &pooled](UInt32 a, UInt32 b)
+    {
+      return pooled(s.compound_strings[a * COMPOUND_STRINGS]) < pooled(s.compound_strings[b * COMPOUND_STRINGS]);
+    });
+
+    MappedTransitionLibrary lib;
+    lib.buffer_ = createImage_(s);
+    lib.attach_(lib.buffer_.data(), lib.buffer_.size(), "");
+    *this = std::move(lib);
+  }
+
+  void MappedTransitionLibrary::store(const String& filename) const
+  {
+    ofstream ofs(filename.c_str(), ios::out | ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ofs.write(image_, image_size_);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error writing transition library.");
+    }
+  }
+
+  void MappedTransitionLibrary::load(const String& filename)
+  {
+    MappedTransitionLibrary lib;
+    lib.file_.open(filename);
+    lib.attach_(lib.file_.data(), lib.file_.size(), filename);
+    *this = std::move(lib);
+  }
+
+  bool MappedTransitionLibrary::isMappedTransitionLibrary(const String& filename)
+  {
+    ifstream ifs(filename.c_str(), ios::binary);
+    char magic[sizeof(TRANSITION_LIBRARY_MAGIC)];
+    return ifs.read(magic, sizeof(magic)) && memcmp(magic, TRANSITION_LIBRARY_MAGIC, sizeof(magic)) == 0;
+  }
+
+  void MappedTransitionLibrary::attach_(const char* data, Size size, const String& filename)
+  {
+    ImageReader_ reader(data, size, filename);
+
+    char magic[sizeof(TRANSITION_LIBRARY_MAGIC)];
+    UInt32 version, bom;
+    UInt64 n_compounds, n_transitions, n_proteins;
+    reader.read(magic, sizeof(magic));
+    if (memcmp(magic, TRANSITION_LIBRARY_MAGIC, sizeof(magic)) != 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File is not a transition library.");
+    }
+    reader.read(&version, sizeof(version));
+    reader.read(&bom, sizeof(bom));
+    if (version != TRANSITION_LIBRARY_VERSION || bom != TRANSITION_LIBRARY_BOM)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+                                  "Unsupported transition library version or byte order (version " + String(version) + ").");
+    }
+    reader.read(&n_compounds, sizeof(n_compounds));
+    reader.read(&n_transitions, sizeof(n_transitions));
+    reader.read(&n_proteins, sizeof(n_proteins));
+    // every compound, transition and protein needs at least one value in the image
+    if (n_compounds > size / sizeof(UInt64) || n_transitions > size / sizeof(UInt64) || n_proteins > size / sizeof(UInt64))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt transition library.");
+    }
+
+    Size n_string_offsets, strings_size, n_protein_refs, n_modification_values;
+    string_offsets_ = reader.section<UInt64>(n_string_offsets);
+    strings_ = reader.section<char>(strings_size);
+    compound_mz_ = reader.section<double>(n_compounds, "compound m/z");
+    compound_rt_ = reader.section<double>(n_compounds, "compound RT");
+    compound_drift_time_ = reader.section<double>(n_compounds, "compound drift time");
+    compound_charge_ = reader.section<Int32>(n_compounds, "compound charge");
+    compound_strings_ = reader.section<UInt32>(n_compounds * COMPOUND_STRINGS, "compound strings");
+    transition_offsets_ = reader.section<UInt64>(n_compounds + 1, "transition offsets");
+    protein_ref_offsets_ = reader.section<UInt64>(n_compounds + 1, "protein reference offsets");
+    protein_refs_ = reader.section<UInt32>(n_protein_refs);
+    modification_offsets_ = reader.section<UInt64>(n_compounds + 1, "modification offsets");
+    modifications_ = reader.section<Int32>(n_modification_values);
+    rt_order_ = reader.section<UInt32>(n_compounds, "RT index");
+    id_order_ = reader.section<UInt32>(n_compounds, "id index");
+    transition_names_ = reader.section<UInt32>(n_transitions, "transition names");
+    transition_product_mz_ = reader.section<double>(n_transitions, "product m/z");
+    transition_precursor_mz_ = reader.section<double>(n_transitions, "precursor m/z");
+    transition_precursor_im_ = reader.section<double>(n_transitions, "precursor ion mobility");
+    transition_intensity_ = reader.section<double>(n_transitions, "library intensity");
+    transition_charge_ = reader.section<Int32>(n_transitions, "fragment charge");
+    transition_flags_ = reader.section<unsigned char>(n_transitions, "transition flags");
+    protein_strings_ = reader.section<UInt32>(n_proteins * PROTEIN_STRINGS, "protein strings");
+
+    const bool consistent =
+      n_string_offsets >= 1 && n_string_offsets <= numeric_limits<UInt32>::max() &&
+      validOffsets_(string_offsets_, n_string_offsets - 1, strings_size) &&
+      n_modification_values % 2 == 0 &&
+      validOffsets_(transition_offsets_, n_compounds, n_transitions) &&
+      validOffsets_(protein_ref_offsets_, n_compounds, n_protein_refs) &&
+      validOffsets_(modification_offsets_, n_compounds, n_modification_values / 2) &&
+      validIndices_(compound_strings_, n_compounds * COMPOUND_STRINGS, n_string_offsets - 1) &&
+      validIndices_(protein_refs_, n_protein_refs, n_string_offsets - 1) &&
+      validIndices_(transition_names_, n_transitions, n_string_offsets - 1) &&
+      validIndices_(protein_strings_, n_proteins * PROTEIN_STRINGS, n_string_offsets - 1) &&
+      validIndices_(rt_order_, n_compounds, n_compounds) &&
+      validIndices_(id_order_, n_compounds, n_compounds) &&
+      is_sorted(compound_mz_, compound_mz_ + n_compounds);
+    if (!consistent)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt transition library.");
+    }
+
+    image_ = data;
+    image_size_ = size;
+    n_compounds_ = n_compounds;
+    n_transitions_ = n_transitions;
+    n_proteins_ = n_proteins;
+    n_strings_ = n_string_offsets - 1;
+  }
+
+  bool MappedTransitionLibrary::isMapped() const
+  {
+    return file_.isOpen();
+  }
+
+  Size MappedTransitionLibrary::getNumberOfCompounds() const
+  {
+    return n_compounds_;
+  }
+
+  Size MappedTransitionLibrary::getNumberOfTransitions() const
+  {
+    return n_transitions_;
+  }
+
+  Size MappedTransitionLibrary::getNumberOfProteins() const
+  {
+    return n_proteins_;
+  }
+
+  StringView MappedTransitionLibrary::getString_(UInt32 id) const
+  {
+    return StringView(strings_ + string_offsets_[id], string_offsets_[id + 1] - string_offsets_[id]);
+  }
+
+  double MappedTransitionLibrary::getPrecursorMZ(Size index) const
+  {
+    return compound_mz_[index];
+  }
+
+  double MappedTransitionLibrary::getRT(Size index) const
+  {
+    return compound_rt_[index];
+  }
+
+  double MappedTransitionLibrary::getDriftTime(Size index) const
+  {
+    return compound_drift_time_[index];
+  }
+
+  Int MappedTransitionLibrary::getCharge(Size index) const
+  {
+    return compound_charge_[index];
+  }
+
+  StringView MappedTransitionLibrary::getCompoundId(Size index) const
+  {
+    return getString_(compound_strings_[index * COMPOUND_STRINGS]);
+  }
+
+  StringView MappedTransitionLibrary::getSequence(Size index) const
+  {
+    return getString_(compound_strings_[index * COMPOUND_STRINGS + 1]);
+  }
+
+  pair<Size, Size> MappedTransitionLibrary::getTransitionRange(Size index) const
+  {
+    return {transition_offsets_[index], transition_offsets_[index + 1]};
+  }
+
+  OpenSwath::LightCompound MappedTransitionLibrary::getCompound(Size index) const
+  {
+    OpenSwath::LightCompound compound;
+    const UInt32* str = compound_strings_ + index * COMPOUND_STRINGS;
+    compound.id = getString_(str[0]).getString();
+    compound.sequence = getString_(str[1]).getString();
+    compound.peptide_group_label = getString_(str[2]).getString();
+    compound.gene_name = getString_(str[3]).getString();
+    compound.sum_formula = getString_(str[4]).getString();
+    compound.compound_name = getString_(str[5]).getString();
+    compound.rt = compound_rt_[index];
+    compound.drift_time = compound_drift_time_[index];
+    compound.charge = compound_charge_[index];
+    compound.protein_refs.reserve(protein_ref_offsets_[index + 1] - protein_ref_offsets_[index]);
+    for (UInt64 k = protein_ref_offsets_[index]; k < protein_ref_offsets_[index + 1]; ++k)
+    {
+      compound.protein_refs.push_back(getString_(protein_refs_[k]).getString());
+    }
+    compound.modifications.reserve(modification_offsets_[index + 1] - modification_offsets_[index]);
+    for (UInt64 k = modification_offsets_[index]; k < modification_offsets_[index + 1]; ++k)
+    {
+      OpenSwath::LightModification mod;
+      mod.location = modifications_[2 * k];
+      mod.unimod_id = modifications_[2 * k + 1];
+      compound.modifications.push_back(mod);
+    }
+    return compound;
+  }
+
+  OpenSwath::LightTransition MappedTransitionLibrary::getTransition(Size index) const
+  {
+    // the compound of the transition is the last one whose transitions start at or before it
+    const Size compound = upper_bound(transition_offsets_, transition_offsets_ + n_compounds_ + 1, UInt64(index)) - transition_offsets_ - 1;
+
+    OpenSwath::LightTransition tr;
+    tr.transition_name = getString_(transition_names_[index]).getString();
+    tr.peptide_ref = getCompoundId(compound).getString();
+    tr.library_intensity = transition_intensity_[index];
+    tr.product_mz = transition_product_mz_[index];
+    tr.precursor_mz = transition_precursor_mz_[index];
+    tr.precursor_im = transition_precursor_im_[index];
+    tr.fragment_charge = transition_charge_[index];
+    const unsigned char flags = transition_flags_[index];
+    tr.decoy = (flags & DECOY) != 0;
+    tr.detecting_transition = (flags & DETECTING) != 0;
+    tr.quantifying_transition = (flags & QUANTIFYING) != 0;
+    tr.identifying_transition = (flags & IDENTIFYING) != 0;
+    return tr;
+  }
+
+  OpenSwath::LightProtein MappedTransitionLibrary::getProtein(Size index) const
+  {
+    OpenSwath::LightProtein protein;
+    protein.id = getString_(protein_strings_[index * PROTEIN_STRINGS]).getString();
+    protein.sequence = getString_(protein_strings_[index * PROTEIN_STRINGS + 1]).getString();
+    return protein;
+  }
+
+  pair<Size, Size> MappedTransitionLibrary::getMZRange(double min_mz, double max_mz) const
+  {
+    const Size first = lower_bound(compound_mz_, compound_mz_ + n_compounds_, min_mz) - compound_mz_;
+    const Size last = upper_bound(compound_mz_, compound_mz_ + n_compounds_, max_mz) - compound_mz_;
+    return {first, max(first, last)};
+  }
+
+  pair<const UInt32*, const UInt32*> MappedTransitionLibrary::getRTRange(double min_rt, double max_rt) const
+  {
+    const double* rt = compound_rt_;
+    const UInt32* first = lower_bound(rt_order_, rt_order_ + n_compounds_, min_rt, [rt](UInt32 c, double v) { return rt[c] < v; });
+    const UInt32* last = upper_bound(rt_order_, rt_order_ + n_compounds_, max_rt, [rt](double v, UInt32 c) { return v < rt[c]; });
+    return {first, max(first, last)};
+  }
+
+  Size MappedTransitionLibrary::findCompound(const String& id) const
+  {
+    const StringView key(id);
+    const UInt32* it = lower_bound(id_order_, id_order_ + n_compounds_, key, [this](UInt32 c, const StringView& v) { return getCompoundId(c) < v; });
+    if (it != id_order_ + n_compounds_ && getCompoundId(*it) == key)
+    {
+      return *it;
+    }
+    return n_compounds_;
+  }
+
+  void MappedTransitionLibrary::toLightTargetedExperiment(OpenSwath::LightTargetedExperiment& exp) const
+  {
+    toLightTargetedExperiment_(0, n_compounds_, exp);
+  }
+
+  void MappedTransitionLibrary::toLightTargetedExperiment(double min_mz, double max_mz, OpenSwath::LightTargetedExperiment& exp) const
+  {
+    const pair<Size, Size> range = getMZRange(min_mz, max_mz);
+    toLightTargetedExperiment_(range.first, range.second, exp);
+  }
+
+  void MappedTransitionLibrary::toLightTargetedExperiment_(Size first, Size last, OpenSwath::LightTargetedExperiment& exp) const
+  {
+    exp = OpenSwath::LightTargetedExperiment();
+    exp.compounds.reserve(last - first);
+    exp.transitions.reserve(transition_offsets_[last] - transition_offsets_[first]);
+    for (Size c = first; c < last; ++c)
+    {
+      exp.compounds.push_back(getCompound(c));
+      for (Size t = transition_offsets_[c]; t < transition_offsets_[c + 1]; ++t)
+      {
+        exp.transitions.push_back(getTransition(t));
+      }
+    }
+
+    // proteins (all of them, or only those referenced by the selected compounds)
+    if (first == 0 && last == n_compounds_)
+    {
+      exp.proteins.reserve(n_proteins_);
+      for (Size p = 0; p < n_proteins_; ++p)
+      {
+        exp.proteins.push_back(getProtein(p));
+      }
+      return;
+    }
+    vector<bool> referenced(n_strings_, false);
+    for (UInt64 k = protein_ref_offsets_[first]; k < protein_ref_offsets_[last]; ++k)
+    {
+      referenced[protein_refs_[k]] = true;
+    }
+    for (Size p = 0; p < n_proteins_; ++p)
+    {
+      if (referenced[protein_strings_[p * PROTEIN_STRINGS]])
+      {
+        exp.proteins.push_back(getProtein(p));
+      }
+    }
+  }
+
+} // namespace OpenMS
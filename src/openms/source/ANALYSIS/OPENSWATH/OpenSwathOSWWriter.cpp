@@ -38,8 +38,194 @@
 
 #include <sqlite3.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 namespace OpenMS
 {
+
+  /**
+    @brief Multi-producer, single-consumer queue of statement batches drained by a writer thread
+
+    Producers push onto an intrusive stack with a single compare-and-swap; the
+    writer thread takes the whole stack at once, restores insertion order and
+    commits it in one transaction. The condition variable is only used to put
+    the idle writer thread to sleep, producers never take its mutex (a missed
+    notification is caught by the timed wait).
+
+    The number of statements which are queued or being written is bounded:
+    producers that find the queue full wait until the writer thread has
+    committed its current batch (the bound is checked before pushing, so
+    concurrent producers may exceed it by one batch each).
+  */
+  struct OpenSwathOSWWriter::AsyncWriter
+  {
+    struct Node
+    {
+      std::vector<String> statements;
+      Node* next;
+    };
+
+    AsyncWriter(const String& filename, Size max_queued) :
+      filename_(filename),
+      max_queued_(std::max(max_queued, Size(1)))
+    {
+      thread_ = std::thread(&AsyncWriter::run_, this);
+    }
+
+    ~AsyncWriter()
+    {
+      stop();
+      deleteNodes_(head_.exchange(nullptr));
+    }
+
+    void push(std::vector<String>&& statements)
+    {
+      if (statements.empty() || hasFailed()) return;
+      if (queued_.load(std::memory_order_relaxed) >= max_queued_)
+      {
+        std::unique_lock<std::mutex> lock(space_mutex_);
+        space_.wait(lock, [this]
+            { return queued_.load(std::memory_order_relaxed) < max_queued_ || hasFailed() || isStopped(); });
+        if (hasFailed()) return;
+      }
+      queued_.fetch_add(statements.size(), std::memory_order_relaxed);
+      Node* node = new Node{std::move(statements), head_.load(std::memory_order_relaxed)};
+      while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+      wake_.notify_one();
+    }
+
+    /// Signal the writer thread to drain the queue and wait for it to finish
+    void stop()
+    {
+      if (!thread_.joinable()) return;
+      done_.store(true, std::memory_order_release);
+      wake_.notify_one();
+      thread_.join();
+      wakeProducers_();
+    }
+
+    bool isStopped() const
+    {
+      return done_.load(std::memory_order_acquire);
+    }
+
+    /// True once a statement failed on the writer thread (the error is in @p error)
+    bool hasFailed() const
+    {
+      return failed_.load(std::memory_order_acquire);
+    }
+
+    std::exception_ptr error;
+
+  private:
+    /// Take all queued batches, oldest first
+    Node* popAll_()
+    {
+      Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+      Node* reversed = nullptr;
+      while (node != nullptr)
+      {
+        Node* next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+      }
+      return reversed;
+    }
+
+    static void deleteNodes_(Node* node)
+    {
+      while (node != nullptr)
+      {
+        Node* next = node->next;
+        delete node;
+        node = next;
+      }
+    }
+
+    void run_()
+    {
+      try
+      {
+        SqliteConnector conn(filename_);
+        conn.executeStatement("PRAGMA journal_mode=WAL");
+        conn.executeStatement("PRAGMA synchronous=NORMAL");
+        while (true)
+        {
+          // read the flag before draining: anything pushed before stop() is in this or an earlier batch
+          bool finishing = done_.load(std::memory_order_acquire);
+          batch_ = popAll_();
+          if (batch_ != nullptr)
+          {
+            Size written = 0;
+            conn.executeStatement("BEGIN TRANSACTION");
+            for (Node* node = batch_; node != nullptr; node = node->next)
+            {
+              for (const auto& statement : node->statements)
+              {
+                conn.executeStatement(statement);
+              }
+              written += node->statements.size();
+            }
+            conn.executeStatement("END TRANSACTION");
+            deleteNodes_(batch_);
+            batch_ = nullptr;
+            queued_.fetch_sub(written, std::memory_order_relaxed);
+            wakeProducers_();
+          }
+          else if (finishing)
+          {
+            break;
+          }
+          else
+          {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(10), [this]
+                { return head_.load(std::memory_order_relaxed) != nullptr || done_.load(std::memory_order_relaxed); });
+          }
+        }
+        // checkpoint and remove the WAL file, leaving a plain SQLite database behind
+        conn.executeStatement("PRAGMA journal_mode=DELETE");
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+        failed_.store(true, std::memory_order_release);
+        deleteNodes_(batch_);
+        batch_ = nullptr;
+        wakeProducers_();
+      }
+    }
+
+    void wakeProducers_()
+    {
+      // taking the mutex orders the notification after a waiting producer's predicate check
+      {
+        std::lock_guard<std::mutex> lock(space_mutex_);
+      }
+      space_.notify_all();
+    }
+
+    String filename_;
+    std::atomic<Node*> head_{nullptr};
+    Node* batch_ = nullptr; ///< batch currently being written (owned by the writer thread)
+    std::atomic<bool> done_{false};
+    std::atomic<bool> failed_{false};
+    const Size max_queued_;
+    std::atomic<Size> queued_{0}; ///< statements queued or being written
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::mutex space_mutex_;
+    std::condition_variable space_;
+    std::thread thread_;
+  };
+
   OpenSwathOSWWriter::OpenSwathOSWWriter(const String& output_filename, const UInt64 run_id, const String& input_filename, bool ms1_scores, bool sonar, bool uis_scores) :
     output_filename_(output_filename),
     input_filename_(input_filename),
@@ -47,7 +233,9 @@ namespace OpenMS
     doWrite_(!output_filename.empty()),
     use_ms1_traces_(ms1_scores),
     sonar_(sonar),
-    enable_uis_scoring_(uis_scores)
+    enable_uis_scoring_(uis_scores),
+    sync_write_mutex_(std::make_shared<std::mutex>()),
+    resume_(false)
   {}
 
   bool OpenSwathOSWWriter::isActive() const
@@ -57,6 +245,9 @@ namespace OpenMS
 
   void OpenSwathOSWWriter::writeHeader()
   {
+    // the tables of an interrupted run are kept (see enableCheckpointing)
+    if (resume_) return;
+
     // Open database
     SqliteConnector conn(output_filename_);
 
@@ -177,6 +368,12 @@ namespace OpenMS
 
     // Execute SQL insert statement
     conn.executeStatement(sql_run.str());
+
+    if (!checkpoint_fingerprint_.empty())
+    {
+      conn.executeStatement("CREATE TABLE CHECKPOINT(WINDOW INT NOT NULL, FINGERPRINT TEXT); "
+                            "INSERT INTO CHECKPOINT (WINDOW, FINGERPRINT) VALUES (-1, '" + checkpoint_fingerprint_ + "');");
+    }
   }
 
   String OpenSwathOSWWriter::getScore(const Feature& feature, std::string score_name) const
@@ -479,6 +676,13 @@ namespace OpenMS
 
   void OpenSwathOSWWriter::writeLines(const std::vector<String>& to_osw_output)
   {
+    if (async_writer_ && !async_writer_->isStopped())
+    {
+      async_writer_->push(std::vector<String>(to_osw_output));
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(*sync_write_mutex_);
     SqliteConnector conn(output_filename_);
     conn.executeStatement("BEGIN TRANSACTION");
     for (Size i = 0; i < to_osw_output.size(); i++)
@@ -487,5 +691,121 @@ namespace OpenMS
     }
     conn.executeStatement("END TRANSACTION");
   }
-}
 
+  void OpenSwathOSWWriter::writeLines(std::vector<String>&& to_osw_output)
+  {
+    if (async_writer_ && !async_writer_->isStopped())
+    {
+      async_writer_->push(std::move(to_osw_output));
+      return;
+    }
+    writeLines(static_cast<const std::vector<String>&>(to_osw_output));
+  }
+
+  void OpenSwathOSWWriter::startWriterThread(Size max_queued_statements)
+  {
+    if (!doWrite_ || (async_writer_ && !async_writer_->isStopped())) return;
+    async_writer_ = std::make_shared<AsyncWriter>(output_filename_, max_queued_statements);
+  }
+
+  void OpenSwathOSWWriter::flush()
+  {
+    if (!async_writer_) return;
+    std::shared_ptr<AsyncWriter> writer;
+    writer.swap(async_writer_);
+    writer->stop();
+    if (writer->error)
+    {
+      std::rethrow_exception(writer->error);
+    }
+  }
+
+  bool OpenSwathOSWWriter::hasCheckpoint(const String& filename, const String& fingerprint)
+  {
+    if (filename.empty() || !std::ifstream(filename.c_str()).good()) return false;
+
+    SqliteConnector conn(filename, SqliteConnector::SqlOpenMode::READONLY);
+    if (!conn.tableExists("CHECKPOINT")) return false;
+
+    sqlite3_stmt* stmt;
+    conn.prepareStatement(&stmt, "SELECT FINGERPRINT FROM CHECKPOINT WHERE WINDOW = -1;");
+    String stored;
+    if (Internal::SqliteHelper::nextRow(stmt) == Internal::SqliteHelper::SqlState::SQL_ROW)
+    {
+      stored = Internal::SqliteHelper::extractString(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return stored == fingerprint;
+  }
+
+  void OpenSwathOSWWriter::enableCheckpointing(const String& fingerprint)
+  {
+    if (!doWrite_) return;
+
+    checkpoint_fingerprint_ = fingerprint;
+    resume_ = false;
+    completed_windows_.clear();
+    if (!std::ifstream(output_filename_.c_str()).good()) return;
+
+    SqliteConnector conn(output_filename_, SqliteConnector::SqlOpenMode::READONLY);
+    if (!conn.tableExists("CHECKPOINT"))
+    {
+      return; // no run was started on this file yet
+    }
+    if (!hasCheckpoint(output_filename_, fingerprint))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "The checkpoint in '" + output_filename_ + "' was created from different input files or parameters.");
+    }
+    resume_ = true;
+
+    sqlite3_stmt* stmt;
+    conn.prepareStatement(&stmt, "SELECT ID FROM RUN;");
+    if (Internal::SqliteHelper::nextRow(stmt) == Internal::SqliteHelper::SqlState::SQL_ROW)
+    {
+      run_id_ = Internal::SqliteHelper::extractInt64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    conn.prepareStatement(&stmt, "SELECT WINDOW FROM CHECKPOINT WHERE WINDOW >= 0;");
+    Internal::SqliteHelper::SqlState state = Internal::SqliteHelper::nextRow(stmt);
+    while (state == Internal::SqliteHelper::SqlState::SQL_ROW)
+    {
+      completed_windows_.insert(Internal::SqliteHelper::extractInt64(stmt, 0));
+      state = Internal::SqliteHelper::nextRow(stmt, state);
+    }
+    sqlite3_finalize(stmt);
+  }
+
+  bool OpenSwathOSWWriter::isCheckpointing() const
+  {
+    return doWrite_ && !checkpoint_fingerprint_.empty();
+  }
+
+  bool OpenSwathOSWWriter::isResuming() const
+  {
+    return resume_;
+  }
+
+  const std::set<Size>& OpenSwathOSWWriter::getCompletedWindows() const
+  {
+    return completed_windows_;
+  }
+
+  String OpenSwathOSWWriter::prepareCheckpoint(Size window) const
+  {
+    if (!isCheckpointing()) return "";
+    return "INSERT INTO CHECKPOINT (WINDOW) VALUES (" + String(window) + "); ";
+  }
+
+  void OpenSwathOSWWriter::finishCheckpointing()
+  {
+    if (!isCheckpointing()) return;
+
+    SqliteConnector conn(output_filename_);
+    conn.executeStatement("DROP TABLE IF EXISTS CHECKPOINT;");
+    checkpoint_fingerprint_.clear();
+    resume_ = false;
+    completed_windows_.clear();
+  }
+}
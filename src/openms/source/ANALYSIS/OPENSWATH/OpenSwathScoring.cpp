@@ -359,8 +359,16 @@ namespace OpenMS
   {
     OPENMS_PRECONDITION(imrmfeature != nullptr, "Feature to be scored cannot be null");
     OpenSwath::MRMScoring mrmscore_;
-    if (su_.use_coelution_score_ || su_.use_shape_score_ || (!imrmfeature->getPrecursorIDs().empty() && su_.use_ms1_correlation))
+    const bool use_ms1_correlation = !imrmfeature->getPrecursorIDs().empty() && su_.use_ms1_correlation;
+    if (use_ms1_correlation)
+    {
+      // all cross-correlation matrices at once, sharing the standardized traces and correlations
+      mrmscore_.initializeXCorrMatrices(imrmfeature, native_ids, precursor_ids);
+    }
+    else if (su_.use_coelution_score_ || su_.use_shape_score_)
+    {
       mrmscore_.initializeXCorrMatrix(imrmfeature, native_ids);
+    }
 
     // XCorr score (coelution)
     if (su_.use_coelution_score_)
@@ -380,20 +388,18 @@ namespace OpenMS
     }
 
     // check that the MS1 feature is present and that the MS1 correlation should be calculated
-    if (!imrmfeature->getPrecursorIDs().empty() && su_.use_ms1_correlation)
+    if (use_ms1_correlation)
     {
       // we need at least two precursor isotopes
       if (precursor_ids.size() > 1)
       {
-        mrmscore_.initializeXCorrPrecursorMatrix(imrmfeature, precursor_ids);
         scores.ms1_xcorr_coelution_score = mrmscore_.calcXcorrPrecursorCoelutionScore();
         scores.ms1_xcorr_shape_score = mrmscore_.calcXcorrPrecursorShapeScore();
       }
-      mrmscore_.initializeXCorrPrecursorContrastMatrix(imrmfeature, precursor_ids, native_ids); // perform cross-correlation on monoisotopic precursor
+      // cross-correlation on monoisotopic precursor
       scores.ms1_xcorr_coelution_contrast_score = mrmscore_.calcXcorrPrecursorContrastCoelutionScore();
       scores.ms1_xcorr_shape_contrast_score = mrmscore_.calcXcorrPrecursorContrastShapeScore();
 
-      mrmscore_.initializeXCorrPrecursorCombinedMatrix(imrmfeature, precursor_ids, native_ids); // perform cross-correlation on monoisotopic precursor
       scores.ms1_xcorr_coelution_combined_score = mrmscore_.calcXcorrPrecursorCombinedCoelutionScore();
       scores.ms1_xcorr_shape_combined_score = mrmscore_.calcXcorrPrecursorCombinedShapeScore();
     }
@@ -419,26 +425,32 @@ namespace OpenMS
     }
 
     // Mutual information scoring
-    if (su_.use_mi_score_)
+    const bool use_ms1_mi = !imrmfeature->getPrecursorIDs().empty() && su_.use_ms1_mi;
+    if (use_ms1_mi)
+    {
+      // all mutual information matrices at once, sharing the rank vectors
+      mrmscore_.initializeMIMatrices(imrmfeature, native_ids, precursor_ids);
+    }
+    else if (su_.use_mi_score_)
     {
       mrmscore_.initializeMIMatrix(imrmfeature, native_ids);
+    }
+    if (su_.use_mi_score_)
+    {
       scores.mi_score = mrmscore_.calcMIScore();
       scores.weighted_mi_score = mrmscore_.calcMIWeightedScore(normalized_library_intensity);
     }
 
     // check that the MS1 feature is present and that the MS1 MI should be calculated
-    if (!imrmfeature->getPrecursorIDs().empty() && su_.use_ms1_mi)
+    if (use_ms1_mi)
     {
       // we need at least two precursor isotopes
       if (precursor_ids.size() > 1)
       {
-        mrmscore_.initializeMIPrecursorMatrix(imrmfeature, precursor_ids);
         scores.ms1_mi_score = mrmscore_.calcMIPrecursorScore();
       }
-      mrmscore_.initializeMIPrecursorContrastMatrix(imrmfeature, precursor_ids, native_ids);
       scores.ms1_mi_contrast_score = mrmscore_.calcMIPrecursorContrastScore();
 
-      mrmscore_.initializeMIPrecursorCombinedMatrix(imrmfeature, precursor_ids, native_ids);
       scores.ms1_mi_combined_score = mrmscore_.calcMIPrecursorCombinedScore();
     }
   }
@@ -34,6 +34,19 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
 
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMapped.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessPrefetching.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessSqMass.h>
+
+#include <algorithm>
+#include <numeric>
+
+// task-based scheduling of performExtraction() requires task dependencies (OpenMP 4.0)
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define OPENSWATH_WORKFLOW_TASKS
+#endif
+
 // OpenSwathCalibrationWorkflow
 namespace OpenMS
 {
@@ -60,6 +73,19 @@ namespace OpenMS
     return ms1_map;
   }
 
+  /// Read spectra ahead on a background thread if the map is read from disk (cached or sqMass input)
+  OpenSwath::SpectrumAccessPtr addPrefetching(const OpenSwath::SpectrumAccessPtr& sptr,
+                                              const SpectrumAccessPrefetching::StatisticsPtr& statistics)
+  {
+    if (boost::dynamic_pointer_cast<SpectrumAccessOpenMSCached>(sptr) ||
+        boost::dynamic_pointer_cast<SpectrumAccessOpenMSCachedMapped>(sptr) ||
+        boost::dynamic_pointer_cast<SpectrumAccessSqMass>(sptr))
+    {
+      return boost::shared_ptr<SpectrumAccessPrefetching>(new SpectrumAccessPrefetching(sptr, 128, 32, statistics));
+    }
+    return sptr;
+  }
+
   TransformationDescription OpenSwathCalibrationWorkflow::performRTNormalization(
     const OpenSwath::LightTargetedExperiment& irt_transitions,
     std::vector< OpenSwath::SwathMap > & swath_maps,
@@ -456,6 +482,15 @@ namespace OpenMS
   {
     tsv_writer.writeHeader();
     osw_writer.writeHeader();
+    osw_writer.startWriterThread();
+
+    // windows which were completely written by an interrupted previous run
+    const std::set<Size>& completed_windows = osw_writer.getCompletedWindows();
+    const bool checkpointing = osw_writer.isCheckpointing();
+    if (!completed_windows.empty())
+    {
+      OPENMS_LOG_INFO << "Resuming from checkpoint, skipping " << completed_windows.size() << " completed SWATH windows." << std::endl;
+    }
 
     bool ms1_only = (swath_maps.size() == 1 && swath_maps[0].ms1);
 
@@ -480,10 +515,15 @@ namespace OpenMS
           "Error, you need to enable use_ms1_traces when run in MS1 mode." );
     }
 
-    if (use_ms1_traces_) ms1_map_ = loadMS1Map(swath_maps, load_into_memory);
+    SpectrumAccessPrefetching::StatisticsPtr prefetch_statistics(new SpectrumAccessPrefetching::Statistics);
+    if (use_ms1_traces_)
+    {
+      ms1_map_ = loadMS1Map(swath_maps, load_into_memory);
+      if (!load_into_memory) ms1_map_ = addPrefetching(ms1_map_, prefetch_statistics);
+    }
 
     // (ii) Precursor extraction only
-    if (ms1_only)
+    if (ms1_only && completed_windows.count(0) == 0)
     {
       std::vector< MSChromatogram > ms1_chromatograms;
       MS1Extraction_(ms1_map_, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
@@ -493,9 +533,16 @@ namespace OpenMS
       boost::shared_ptr<MSExperiment> empty_exp = boost::shared_ptr<MSExperiment>(new MSExperiment);
 
       OpenSwath::LightTargetedExperiment transition_exp_used = transition_exp;
+      std::vector<String> osw_output;
       scoreAllChromatograms_(std::vector<MSChromatogram>(), ms1_chromatograms, swath_maps, transition_exp_used,
                             feature_finder_param, trafo,
-                            cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes, true);
+                            cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes, true,
+                            checkpointing ? &osw_output : nullptr);
+      if (checkpointing)
+      {
+        osw_output.push_back(osw_writer.prepareCheckpoint(0));
+        osw_writer.writeLines(std::move(osw_output));
+      }
 
       // write features to output if so desired
       std::vector< OpenMS::MSChromatogram > chromatograms;
@@ -586,136 +633,102 @@ namespace OpenMS
     };
 
     // (iv) Perform extraction and scoring of fragment ion chromatograms (MS2)
-    // We set dynamic scheduling such that the maps are worked on in the order
-    // in which they were given to the program / acquired. This gives much
-    // better load balancing than static allocation.
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    int total_nr_threads = omp_get_max_threads(); // store total number of threads we are allowed to use
-    if (threads_outer_loop_ > -1)
-    {
-      std::cout << "Setting up nested loop with " << std::min(threads_outer_loop_, omp_get_max_threads()) << " threads out of "<< omp_get_max_threads() << std::endl;
-      omp_set_nested(1);
-      omp_set_dynamic(0);
-      omp_set_num_threads(std::min(threads_outer_loop_, omp_get_max_threads()) ); // use at most threads_outer_loop_ threads here
-    }
-    else
+    //
+    // Step 1: count the transitions of each window, so that the windows with
+    // the most assays can be started first. The transitions themselves are
+    // only selected once the task of a window starts (see below), so at most
+    // the windows currently being processed hold a copy of their assays.
+    StopWatch total_time;
+    total_time.start();
+    double stage_times[SIZE_OF_EXTRACTIONSTAGE] = {};
+
+    std::vector<Size> window_sizes(swath_maps.size(), 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
     {
-      std::cout << "Use non-nested loop with " << total_nr_threads << " threads." << std::endl;
+      if (swath_maps[i].ms1) continue; // skip MS1
+      if (completed_windows.count(i) > 0) continue; // already written by a previous run
+
+      window_sizes[i] = countTransitionsForWindow_(swath_maps, i, transition_exp, tr_win_map, cp);
     }
-#endif
-#pragma omp parallel for schedule(dynamic,1)
-#endif
-    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
+
+    // with checkpointing, the features of a window are collected here and written at once
+    std::vector< std::vector<String> > window_osw_output(checkpointing ? swath_maps.size() : 0);
+
+    std::vector<Size> window_order(swath_maps.size());
+    std::iota(window_order.begin(), window_order.end(), 0);
+    std::stable_sort(window_order.begin(), window_order.end(), [&window_sizes](Size a, Size b)
+      {
+        return window_sizes[a] > window_sizes[b];
+      });
+
+    // Step 2: select, extract, score and write all batches of all windows.
+    // Each window becomes one task which selects its transitions,
+    // (optionally) loads the window into memory and then creates one task
+    // per batch. Idle threads pick up pending batches of any window, so all
+    // cores are kept busy until the last batch is done, even if windows
+    // contain very different numbers of assays. At most
+    // getWindowSlotCount_() windows are processed (and held in memory) at
+    // the same time, see runWindowTasks_().
+    std::vector<Size> windows_to_process;
+    for (Size i : window_order)
     {
-      if (!swath_maps[i].ms1) // skip MS1
+      if (window_sizes[i] == 0) // skip if no transitions found
       {
+        this->setProgress(++progress);
+        continue;
+      }
+      windows_to_process.push_back(i);
+    }
 
-        // Step 1: select which transitions to extract (proceed in batches)
+    runWindowTasks_(windows_to_process, getWindowSlotCount_(windows_to_process.size()), [&](Size i)
+      {
+        StopWatch stage_time;
+        stage_time.start();
         OpenSwath::LightTargetedExperiment transition_exp_used_all;
-        if (!(prm_ || pasef_))
+        selectTransitionsForWindow_(swath_maps, i, transition_exp, tr_win_map, cp, transition_exp_used_all);
+        addStageTime_(stage_times[STAGE_SELECTION], stage_time);
+
+        OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
+        if (load_into_memory)
         {
-          // Step 1.1: select transitions matching the window
-          OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-              cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+          // This creates an InMemory object that keeps all data in memory
+          current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
         }
         else
         {
-          // Step 1.2: select transitions based on matching PRM/PASEF window (best window)
-          std::set<std::string> matching_compounds;
-          for (Size k = 0; k < tr_win_map.size(); k++)
-          {
-            if (tr_win_map[k] == i)
-            {
-               const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
-               transition_exp_used_all.transitions.push_back(tr);
-               matching_compounds.insert(tr.getPeptideRef());
-               OPENMS_LOG_DEBUG << "Adding Precursor with m/z " << tr.getPrecursorMZ() << " and IM of " << tr.getPrecursorIM() <<  " to swath with mz upper of " << swath_maps[i].upper << " im lower of " << swath_maps[i].imLower << " and im upper of " << swath_maps[i].imUpper << std::endl;
-            }
-          }
-
-          std::set<std::string> matching_proteins;
-          for (Size i = 0; i < transition_exp.compounds.size(); i++)
-          {
-            if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
-            {
-              transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
-              for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
-              {
-                matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
-              }
-            }
-          }
-          for (Size i = 0; i < transition_exp.proteins.size(); i++)
-          {
-            if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
-            {
-              transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
-            }
-          }
+          current_swath_map = addPrefetching(current_swath_map, prefetch_statistics);
         }
+        addStageTime_(stage_times[STAGE_LOADING], stage_time);
 
-        if (!transition_exp_used_all.getTransitions().empty()) // skip if no transitions found
+        int batch_size;
+        if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
         {
+          batch_size = transition_exp_used_all.getCompounds().size();
+        }
+        else
+        {
+          batch_size = batchSize;
+        }
 
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-          if (load_into_memory)
-          {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-          }
-
-          int batch_size;
-          if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
-          {
-            batch_size = transition_exp_used_all.getCompounds().size();
-          }
-          else
-          {
-            batch_size = batchSize;
-          }
-
-          SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
+        SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-          // If we have a multiple of threads_outer_loop_ here, then use nested
-          // parallelization here. E.g. if we use 8 threads for the outer loop,
-          // but we have a total of 24 cores available, each of the 8 threads
-          // will then create a team of 3 threads to work on the batches
-          // individually.
-          //
-          // We should avoid oversubscribing the CPUs, therefore we use integer division.
-          // -- see https://docs.oracle.com/cd/E19059-01/stud.10/819-0501/2_nested.html
-          int outer_thread_nr = omp_get_thread_num();
-          omp_set_num_threads(std::max(1, total_nr_threads / threads_outer_loop_) );
-#pragma omp parallel for schedule(dynamic, 1)
-#endif
+        for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
+        {
+#ifdef OPENSWATH_WORKFLOW_TASKS
+#pragma omp task untied default(shared) firstprivate(pep_idx, batch_size, current_swath_map)
 #endif
-          for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
           {
-            OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map;
-
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
             // To ensure multi-threading safe access to the individual spectra, we
             // need to use a light clone of the spectrum access (if multiple threads
             // share a single filestream and call seek on it, chaos will ensue).
-            if (total_nr_threads / threads_outer_loop_ > 1)
-            {
-              current_swath_map_inner = current_swath_map->lightClone();
-            }
-#endif
+            OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map->lightClone();
+
 #pragma omp critical (osw_write_stdout)
-#endif
             {
               std::cout << "Thread " <<
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-              outer_thread_nr << "_" << omp_get_thread_num() << " " <<
-#else
               omp_get_thread_num() << "_0 " <<
-#endif
 #else
               "0" <<
 #endif
@@ -725,8 +738,11 @@ namespace OpenMS
             }
 
             // Create the new, batch-size transition experiment
+            StopWatch batch_stage_time;
+            batch_stage_time.start();
             OpenSwath::LightTargetedExperiment transition_exp_used;
             selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
+            addStageTime_(stage_times[STAGE_SELECTION], batch_stage_time);
 
             // Extract MS1 chromatograms for this batch
             std::vector< MSChromatogram > ms1_chromatograms;
@@ -736,6 +752,7 @@ namespace OpenMS
               MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
                   transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
             }
+            addStageTime_(stage_times[STAGE_MS1_EXTRACTION], batch_stage_time);
 
             // Step 2.1: extract these transitions
             ChromatogramExtractor extractor;
@@ -752,14 +769,22 @@ namespace OpenMS
             PeakMap chrom_exp;
             extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
                                           chrom_exp.getChromatograms(), false, cp.im_extraction_window);
-
+            addStageTime_(stage_times[STAGE_MS2_EXTRACTION], batch_stage_time);
 
             // Step 3: score these extracted transitions
             FeatureMap featureFile;
             std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
             tmp.back().sptr = current_swath_map_inner;
+            std::vector<String> osw_output;
             scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
-                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
+                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes,
+                false, checkpointing ? &osw_output : nullptr);
+            if (checkpointing)
+            {
+#pragma omp critical (osw_window_output)
+              std::move(osw_output.begin(), osw_output.end(), std::back_inserter(window_osw_output[i]));
+            }
+            addStageTime_(stage_times[STAGE_SCORING], batch_stage_time);
 
             // Step 4: write all chromatograms and features out into an output object / file
             // (this needs to be done in a critical section since we only have one
@@ -768,25 +793,143 @@ namespace OpenMS
             {
               writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
             }
+            addStageTime_(stage_times[STAGE_WRITING], batch_stage_time);
           }
+        }
 
-        } // continue 2 (no continue due to OpenMP)
-      } // continue 1 (no continue due to OpenMP)
+#ifdef OPENSWATH_WORKFLOW_TASKS
+        // the window (its transitions and memory) is only released once all of its batches are done
+#pragma omp taskwait
+#endif
 
-      #pragma omp critical (progress)
-      this->setProgress(++progress);
+        // all batches are done: write the features of the window together with its checkpoint entry
+        if (checkpointing)
+        {
+          window_osw_output[i].push_back(osw_writer.prepareCheckpoint(i));
+          osw_writer.writeLines(std::move(window_osw_output[i]));
+          window_osw_output[i] = std::vector<String>();
+        }
 
-    }
+        #pragma omp critical (progress)
+        this->setProgress(++progress);
+      });
     this->endProgress();
+    osw_writer.flush();
+    osw_writer.finishCheckpointing();
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    if (threads_outer_loop_ > -1)
+    total_time.stop();
+    reportStageTimes_(stage_times, total_time.getClockTime());
+
+    const Size nr_accesses = prefetch_statistics->hits + prefetch_statistics->late_hits + prefetch_statistics->misses;
+    if (nr_accesses > 0)
     {
-      omp_set_num_threads(total_nr_threads); // set number of available threads back to initial value
+      OPENMS_LOG_INFO << "Spectrum prefetching: " << prefetch_statistics->hits << " cache hits, "
+        << prefetch_statistics->late_hits << " hits while loading and " << prefetch_statistics->misses
+        << " misses out of " << nr_accesses << " spectrum accesses (" << prefetch_statistics->prefetched
+        << " spectra read ahead)" << std::endl;
     }
+  }
+
+  void OpenSwathWorkflow::addStageTime_(double& stage_total, StopWatch& stage_time)
+  {
+    double elapsed = stage_time.getClockTime();
+#pragma omp atomic
+    stage_total += elapsed;
+    stage_time.reset();
+  }
+
+  void OpenSwathWorkflow::reportStageTimes_(const double (&stage_times)[SIZE_OF_EXTRACTIONSTAGE], double wall_time) const
+  {
+    static const char* const stage_names[SIZE_OF_EXTRACTIONSTAGE] =
+      {"transition selection", "window loading", "MS1 extraction", "MS2 extraction", "scoring", "writing"};
+
+    int nr_threads = 1;
+#ifdef _OPENMP
+    nr_threads = omp_get_max_threads();
 #endif
-#endif
+
+    double busy_time = 0.0;
+    std::cout << "Extraction and scoring took " << StopWatch::toString(wall_time) << " (wall time) with " << nr_threads << " thread(s). Time spent per stage (summed over all threads):" << std::endl;
+    for (Size stage = 0; stage < SIZE_OF_EXTRACTIONSTAGE; ++stage)
+    {
+      std::cout << "  " << stage_names[stage] << ": " << StopWatch::toString(stage_times[stage]) << std::endl;
+      busy_time += stage_times[stage];
+    }
+    if (wall_time > 0.0)
+    {
+      std::cout << "Core utilization: " << String::number(100.0 * busy_time / (wall_time * nr_threads), 1) << "%" << std::endl;
+    }
+  }
+
+  void OpenSwathWorkflow::selectTransitionsForWindow_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+    SignedSize map_idx,
+    const OpenSwath::LightTargetedExperiment& transition_exp,
+    const std::vector<int>& tr_win_map,
+    const ChromExtractParams & cp,
+    OpenSwath::LightTargetedExperiment& transition_exp_used_all) const
+  {
+    if (!(prm_ || pasef_))
+    {
+      // select transitions matching the window
+      OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
+          cp.min_upper_edge_dist, swath_maps[map_idx].lower, swath_maps[map_idx].upper);
+      return;
+    }
+
+    // select transitions based on matching PRM/PASEF window (best window)
+    std::set<std::string> matching_compounds;
+    for (Size k = 0; k < tr_win_map.size(); k++)
+    {
+      if (tr_win_map[k] == map_idx)
+      {
+         const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
+         transition_exp_used_all.transitions.push_back(tr);
+         matching_compounds.insert(tr.getPeptideRef());
+         OPENMS_LOG_DEBUG << "Adding Precursor with m/z " << tr.getPrecursorMZ() << " and IM of " << tr.getPrecursorIM() <<  " to swath with mz upper of " << swath_maps[map_idx].upper << " im lower of " << swath_maps[map_idx].imLower << " and im upper of " << swath_maps[map_idx].imUpper << std::endl;
+      }
+    }
+
+    std::set<std::string> matching_proteins;
+    for (Size i = 0; i < transition_exp.compounds.size(); i++)
+    {
+      if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
+      {
+        transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
+        for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
+        {
+          matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
+        }
+      }
+    }
+    for (Size i = 0; i < transition_exp.proteins.size(); i++)
+    {
+      if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
+      {
+        transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
+      }
+    }
+  }
+
+  Size OpenSwathWorkflow::countTransitionsForWindow_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+    SignedSize map_idx,
+    const OpenSwath::LightTargetedExperiment& transition_exp,
+    const std::vector<int>& tr_win_map,
+    const ChromExtractParams & cp) const
+  {
+    if (prm_ || pasef_)
+    {
+      return std::count(tr_win_map.begin(), tr_win_map.end(), map_idx);
+    }
+
+    // same criterion as OpenSwathHelper::selectSwathTransitions
+    const double lower = swath_maps[map_idx].lower;
+    const double upper = swath_maps[map_idx].upper;
+    return std::count_if(transition_exp.transitions.begin(), transition_exp.transitions.end(),
+      [&](const OpenSwath::LightTransition& tr)
+      {
+        return lower < tr.getPrecursorMZ() && tr.getPrecursorMZ() < upper &&
+               std::fabs(upper - tr.getPrecursorMZ()) >= cp.min_upper_edge_dist;
+      });
   }
 
   void OpenSwathWorkflow::writeOutFeaturesAndChroms_(
@@ -823,6 +966,44 @@ namespace OpenMS
     }
   }
 
+  Size OpenSwathWorkflowBase::getWindowSlotCount_(Size nr_windows) const
+  {
+    if (threads_outer_loop_ > 0)
+    {
+      return Size(threads_outer_loop_);
+    }
+    Size nr_threads = 1;
+#ifdef _OPENMP
+    nr_threads = omp_get_max_threads();
+#endif
+    return std::max(Size(1), std::min(nr_windows, nr_threads));
+  }
+
+  void OpenSwathWorkflowBase::runWindowTasks_(const std::vector<Size>& windows,
+                                              Size nr_slots,
+                                              const std::function<void(Size)>& process_window)
+  {
+    nr_slots = std::max(Size(1), nr_slots);
+#ifdef OPENSWATH_WORKFLOW_TASKS
+    std::vector<char> window_slots(nr_slots);
+
+#pragma omp parallel
+#pragma omp single
+    for (Size k = 0; k < windows.size(); ++k)
+    {
+      char* window_slot = &window_slots[k % nr_slots];
+#pragma omp task untied default(shared) firstprivate(k) depend(inout: *window_slot)
+      process_window(windows[k]);
+    }
+#else
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_slots)
+    for (SignedSize k = 0; k < boost::numeric_cast<SignedSize>(windows.size()); ++k)
+    {
+      process_window(windows[k]);
+    }
+#endif
+  }
+
   void OpenSwathWorkflowBase::MS1Extraction_(const OpenSwath::SpectrumAccessPtr ms1_map,
                                              const std::vector< OpenSwath::SwathMap > & /* swath_maps */,
                                              std::vector< MSChromatogram >& ms1_chromatograms,
@@ -872,7 +1053,8 @@ namespace OpenMS
     OpenSwathTSVWriter & tsv_writer,
     OpenSwathOSWWriter & osw_writer,
     int nr_ms1_isotopes,
-    bool ms1only) const
+    bool ms1only,
+    std::vector<String>* osw_output) const
   {
     TransformationDescription trafo_inv = trafo;
     trafo_inv.invert();
@@ -1046,15 +1228,14 @@ namespace OpenMS
       }
     }
 
-    // Only write at the very end since this is a step that needs a barrier
-    if (osw_writer.isActive())
+    // The inserts are queued for the writer thread (see performExtraction), without it writeLines serializes the writes itself
+    if (osw_writer.isActive() && osw_output != nullptr)
     {
-#ifdef _OPENMP
-#pragma omp critical (osw_write_tsv)
-#endif
-      {
-        osw_writer.writeLines(to_osw_output);
-      }
+      std::move(to_osw_output.begin(), to_osw_output.end(), std::back_inserter(*osw_output));
+    }
+    else if (osw_writer.isActive())
+    {
+      osw_writer.writeLines(std::move(to_osw_output));
     }
   }
 
@@ -1143,6 +1324,7 @@ namespace OpenMS
     {
       tsv_writer.writeHeader();
       osw_writer.writeHeader();
+      osw_writer.startWriterThread();
 
       // Compute inversion of the transformation
       TransformationDescription trafo_inverse = trafo;
@@ -1305,6 +1487,7 @@ namespace OpenMS
         this->setProgress(++progress);
       }
       this->endProgress();
+      osw_writer.flush();
     }
 
 
@@ -0,0 +1,322 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/StreamingChromatogramExtractor.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace OpenMS
+{
+
+  StreamingChromatogramExtractor::StreamingChromatogramExtractor(double mz_extraction_window, bool ppm, double im_extraction_window, const String& filter) :
+    mz_extraction_window_(mz_extraction_window),
+    ppm_(ppm),
+    im_extraction_window_(im_extraction_window),
+    bartlett_(false)
+  {
+    if (filter == "bartlett")
+    {
+      bartlett_ = true;
+    }
+    else if (filter != "tophat")
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "Filter either needs to be tophat or bartlett");
+    }
+  }
+
+  StreamingChromatogramExtractor::~StreamingChromatogramExtractor() = default;
+
+  StreamingChromatogramExtractor::Target_ StreamingChromatogramExtractor::makeTarget_(const ExtractionCoordinates& coordinate,
+                                                                                      const OpenSwath::ChromatogramPtr& output) const
+  {
+    // same window as in ChromatogramExtractorAlgorithm::extract_value_tophat
+    Target_ target;
+    target.mz = coordinate.mz;
+    if (ppm_)
+    {
+      target.left  = coordinate.mz - coordinate.mz * mz_extraction_window_ / 2.0 * 1.0e-6;
+      target.right = coordinate.mz + coordinate.mz * mz_extraction_window_ / 2.0 * 1.0e-6;
+    }
+    else
+    {
+      target.left  = coordinate.mz - mz_extraction_window_ / 2.0;
+      target.right = coordinate.mz + mz_extraction_window_ / 2.0;
+    }
+    target.ion_mobility = coordinate.ion_mobility;
+    target.rt_start = coordinate.rt_start;
+    target.rt_end = coordinate.rt_end;
+    target.output = output;
+    return target;
+  }
+
+  void StreamingChromatogramExtractor::sortTargets_(std::vector<Target_>& targets)
+  {
+    std::stable_sort(targets.begin(), targets.end(), [](const Target_& a, const Target_& b) { return a.mz < b.mz; });
+  }
+
+  void StreamingChromatogramExtractor::addMS1Coordinates(const std::vector<ExtractionCoordinates>& coordinates,
+                                                         const std::vector<OpenSwath::ChromatogramPtr>& output)
+  {
+    if (output.size() != coordinates.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Output and extraction coordinates need to have the same size: "+ String(output.size()) + " != " + String(coordinates.size()) );
+    }
+    if (nr_spectra_ > 0)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Coordinates need to be added before the first spectrum is consumed");
+    }
+    for (Size k = 0; k < coordinates.size(); ++k)
+    {
+      ms1_targets_.push_back(makeTarget_(coordinates[k], output[k]));
+    }
+    sortTargets_(ms1_targets_);
+  }
+
+  void StreamingChromatogramExtractor::addMS2Coordinates(const std::vector<ExtractionCoordinates>& coordinates,
+                                                         const std::vector<OpenSwath::ChromatogramPtr>& output,
+                                                         double min_upper_edge_dist)
+  {
+    if (output.size() != coordinates.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Output and extraction coordinates need to have the same size: "+ String(output.size()) + " != " + String(coordinates.size()) );
+    }
+    if (nr_spectra_ > 0)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Coordinates need to be added before the first spectrum is consumed");
+    }
+    for (Size k = 0; k < coordinates.size(); ++k)
+    {
+      ms2_targets_.push_back(makeTarget_(coordinates[k], output[k]));
+      ms2_precursor_mz_.push_back(coordinates[k].mz_precursor);
+      ms2_min_upper_edge_dist_.push_back(min_upper_edge_dist);
+      ms2_window_.push_back(-1);
+    }
+  }
+
+  const std::vector<OpenSwath::SwathMap>& StreamingChromatogramExtractor::getSwathWindows() const
+  {
+    return windows_;
+  }
+
+  int StreamingChromatogramExtractor::getWindowIndex(Size index) const
+  {
+    if (index >= ms2_window_.size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, index, ms2_window_.size());
+    }
+    return ms2_window_[index];
+  }
+
+  Size StreamingChromatogramExtractor::getNrSpectra() const
+  {
+    return nr_spectra_;
+  }
+
+  void StreamingChromatogramExtractor::setExpectedSize(Size, Size)
+  {
+  }
+
+  void StreamingChromatogramExtractor::consumeChromatogram(ChromatogramType&)
+  {
+  }
+
+  void StreamingChromatogramExtractor::setExperimentalSettings(const ExperimentalSettings&)
+  {
+  }
+
+  Size StreamingChromatogramExtractor::findOrAddWindow_(const SpectrumType& s)
+  {
+    if (s.getPrecursors().empty())
+    {
+      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Swath scan does not provide a precursor.");
+    }
+
+    const Precursor& prec = s.getPrecursors()[0];
+    double center = prec.getMZ();
+    double im_lower = -1; // these initial values assume IM is not present
+    double im_upper = -1;
+    if (s.metaValueExists("ion mobility lower limit"))
+    {
+      im_lower = s.getMetaValue("ion mobility lower limit");
+      im_upper = s.getMetaValue("ion mobility upper limit");
+    }
+
+    // windows are identified like in FullSwathFileConsumer
+    for (Size i = 0; i < windows_.size(); ++i)
+    {
+      if (std::fabs(center - windows_[i].center) < 1e-6 &&
+          std::fabs(im_lower - windows_[i].imLower) < 1e-6 &&
+          std::fabs(im_upper - windows_[i].imUpper) < 1e-6)
+      {
+        return i;
+      }
+    }
+
+    OpenSwath::SwathMap window;
+    window.center = center;
+    window.lower = center - prec.getIsolationWindowLowerOffset();
+    window.upper = center + prec.getIsolationWindowUpperOffset();
+    window.imLower = im_lower;
+    window.imUpper = im_upper;
+    window.ms1 = false;
+    windows_.push_back(window);
+
+    // assign all coordinates not yet assigned to another window (same criterion as OpenSwathHelper::selectSwathTransitions)
+    std::vector<Target_> targets;
+    for (Size k = 0; k < ms2_targets_.size(); ++k)
+    {
+      const double precursor_mz = ms2_precursor_mz_[k];
+      if (ms2_window_[k] == -1 &&
+          window.lower < precursor_mz && precursor_mz < window.upper &&
+          std::fabs(window.upper - precursor_mz) >= ms2_min_upper_edge_dist_[k])
+      {
+        ms2_window_[k] = int(windows_.size() - 1);
+        targets.push_back(ms2_targets_[k]);
+      }
+    }
+    sortTargets_(targets);
+    window_targets_.push_back(std::move(targets));
+    return windows_.size() - 1;
+  }
+
+  bool StreamingChromatogramExtractor::loadSpectrum_(const SpectrumType& s)
+  {
+    mz_.resize(s.size());
+    intensity_.resize(s.size());
+    for (Size p = 0; p < s.size(); ++p)
+    {
+      mz_[p] = s[p].getMZ();
+      intensity_[p] = s[p].getIntensity();
+    }
+
+    if (im_extraction_window_ <= 0.0)
+    {
+      return false;
+    }
+
+    // same array names as in OpenSwath::Spectrum::getDriftTimeArray
+    for (const auto& fda : s.getFloatDataArrays())
+    {
+      if (fda.getName().find("Ion Mobility") == 0 || fda.getName().find("mean inverse reduced ion mobility array") == 0)
+      {
+        im_.assign(fda.begin(), fda.end());
+        return true;
+      }
+    }
+    throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+      "Requested ion mobility extraction but no ion mobility array found.");
+  }
+
+  void StreamingChromatogramExtractor::extractTargets_(const std::vector<Target_>& targets, double rt, bool has_im) const
+  {
+    const Size n = mz_.size();
+    const double half_im_window = im_extraction_window_ / 2.0;
+
+    // the targets are sorted by m/z, so both window borders only move right
+    Size lo = 0;
+    Size hi = 0;
+    for (const Target_& t : targets)
+    {
+      if (t.rt_end - t.rt_start > 0 && (rt < t.rt_start || rt > t.rt_end))
+      {
+        continue;
+      }
+
+      while (lo < n && mz_[lo] <= t.left) ++lo;
+      if (hi < lo) hi = lo;
+      while (hi < n && mz_[hi] < t.right) ++hi;
+
+      // sum over the contiguous range [lo, hi), loops without branches
+      double integrated_intensity = 0.0;
+      const bool use_im = has_im && t.ion_mobility >= 0.0;
+      if (!bartlett_ && !use_im)
+      {
+        for (Size p = lo; p < hi; ++p)
+        {
+          integrated_intensity += intensity_[p];
+        }
+      }
+      else
+      {
+        const double inv_half_width = bartlett_ ? 2.0 / (t.right - t.left) : 0.0;
+        const double left_im = t.ion_mobility - half_im_window;
+        const double right_im = t.ion_mobility + half_im_window;
+        for (Size p = lo; p < hi; ++p)
+        {
+          double weight = 1.0 - std::fabs(mz_[p] - t.mz) * inv_half_width;
+          if (use_im)
+          {
+            weight *= double(im_[p] > left_im && im_[p] < right_im);
+          }
+          integrated_intensity += weight * intensity_[p];
+        }
+      }
+
+      t.output->getTimeArray()->data.push_back(rt);
+      t.output->getIntensityArray()->data.push_back(integrated_intensity);
+    }
+  }
+
+  void StreamingChromatogramExtractor::consumeSpectrum(SpectrumType& s)
+  {
+    ++nr_spectra_;
+
+    const std::vector<Target_>* targets = &ms1_targets_;
+    if (s.getMSLevel() != 1)
+    {
+      targets = &window_targets_[findOrAddWindow_(s)];
+    }
+
+    // like ChromatogramExtractorAlgorithm, empty spectra do not add a data point
+    if (targets->empty() || s.empty())
+    {
+      return;
+    }
+
+    bool has_im = loadSpectrum_(s);
+    extractTargets_(*targets, s.getRT(), has_im);
+  }
+
+}
@@ -10,6 +10,7 @@ set(sources_list
   DIAPrescoring.cpp
   DIAScoring.cpp
   IonMobilityScoring.cpp
+  MappedTransitionLibrary.cpp
   MasstraceCorrelator.cpp
   MRMAssay.cpp
   MRMDecoy.cpp
@@ -36,6 +37,7 @@ set(sources_list
   SwathWindowLoader.cpp
   SwathQC.cpp
   SpectrumAddition.cpp
+  StreamingChromatogramExtractor.cpp
   TargetedSpectraExtractor.cpp
   TransitionTSVFile.cpp
   TransitionPQPFile.cpp
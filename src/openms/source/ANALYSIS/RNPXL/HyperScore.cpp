@@ -35,8 +35,11 @@
 #include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
 
 #include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 #include <OpenMS/DATASTRUCTURES/MatchedIterator.h>
 #include <OpenMS/DATASTRUCTURES/StringUtils.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/LogStream.h>
 
 
 using std::vector;
@@ -55,74 +58,133 @@ namespace OpenMS
   }
 
 
-  double HyperScore::compute(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const PeakSpectrum& exp_spectrum, const PeakSpectrum& theo_spectrum)
+  template <typename MATCHER>
+  double HyperScore::computeFromMatches_(const PeakSpectrum& theo_spectrum, MATCHER for_each_match)
   {
-    if (exp_spectrum.empty() || theo_spectrum.empty())
+    if (theo_spectrum.empty())
     {
-      std::cout << "Warning: HyperScore: One of the given spectra is empty." << std::endl;
       return 0.0;
     }
 
     // TODO this assumes only one StringDataArray is present and it is the right one
-    const PeakSpectrum::StringDataArray* ion_names;
-    if (!theo_spectrum.getStringDataArrays().empty())
-    {
-      ion_names = &theo_spectrum.getStringDataArrays()[0];
-    }
-    else
+    if (theo_spectrum.getStringDataArrays().empty())
     {
-      std::cout << "Error: HyperScore: Theoretical spectrum without StringDataArray (\"IonNames\" annotation) provided." << std::endl;
+      OPENMS_LOG_ERROR << "Error: HyperScore: Theoretical spectrum without StringDataArray (\"IonNames\" annotation) provided." << std::endl;
       return 0.0;
     }
+    const PeakSpectrum::StringDataArray& ion_names = theo_spectrum.getStringDataArrays()[0];
 
     int y_ion_count = 0;
     int b_ion_count = 0;
     double dot_product = 0.0;
-    if (fragment_mass_tolerance_unit_ppm) 
+    for_each_match([&](Size theo_idx, float exp_intensity)
     {
-      MatchedIterator<PeakSpectrum, PpmTrait, true> it(theo_spectrum, exp_spectrum, fragment_mass_tolerance);
-      for (; it != it.end(); ++it)
+      dot_product += exp_intensity * theo_spectrum[theo_idx].getIntensity(); /* * mass_error */;
+      // fragment annotations in XL-MS data are more complex and do not start with the ion type, but the ion type always follows after a $
+      if (ion_names[theo_idx][0] == 'y' || ion_names[theo_idx].hasSubstring("$y"))
       {
-        dot_product += (*it).getIntensity() * it.ref().getIntensity(); /* * mass_error */;
-        // fragment annotations in XL-MS data are more complex and do not start with the ion type, but the ion type always follows after a $
-        auto i = it.refIdx();
-        if ((*ion_names)[i][0] == 'y' || (*ion_names)[i].hasSubstring("$y"))
+        ++y_ion_count;
+      }
+      else if (ion_names[theo_idx][0] == 'b' || ion_names[theo_idx].hasSubstring("$b"))
+      {
+        ++b_ion_count;
+      }
+    });
+    // inefficient: calculates logs repeatedly
+    //const double yFact = logfactorial_(y_ion_count);
+    //const double bFact = logfactorial_(b_ion_count);
+    //const double hyperScore = log1p(dot_product) + yFact + bFact;
+
+    const int i_min = std::min(y_ion_count, b_ion_count);
+    const int i_max = std::max(y_ion_count, b_ion_count);
+    const double hyperScore = log1p(dot_product) + 2*logfactorial_(i_min) + logfactorial_(i_max, i_min + 1);
+    return hyperScore;
+  }
+
+  double HyperScore::compute(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const PeakSpectrum& exp_spectrum, const PeakSpectrum& theo_spectrum)
+  {
+    if (exp_spectrum.empty())
+    {
+      return 0.0;
+    }
+    return computeFromMatches_(theo_spectrum, [&](auto visit)
+    {
+      if (fragment_mass_tolerance_unit_ppm)
+      {
+        for (MatchedIterator<PeakSpectrum, PpmTrait, true> it(theo_spectrum, exp_spectrum, fragment_mass_tolerance); it != it.end(); ++it)
         {
-          ++y_ion_count;
+          visit(it.refIdx(), (*it).getIntensity());
         }
-        else if ((*ion_names)[i][0] == 'b' || (*ion_names)[i].hasSubstring("$b"))
+      }
+      else
+      {
+        for (MatchedIterator<PeakSpectrum, DaTrait, true> it(theo_spectrum, exp_spectrum, fragment_mass_tolerance); it != it.end(); ++it)
         {
-          ++b_ion_count;
+          visit(it.refIdx(), (*it).getIntensity());
         }
       }
-    }
-    else
+    });
+  }
+
+  namespace
+  {
+    /// calls @p visit(theo_index, exp_index) for each pair found by MatchedIterator<PeakSpectrum, TRAIT>(theo_spectrum, exp_spectrum, tolerance)
+    template <typename TRAIT, typename VISITOR>
+    void forEachMatch_(const PeakSpectrum& theo_spectrum, const ColumnarSpectrum& exp_spectrum, float tolerance, VISITOR visit)
     {
-      MatchedIterator<PeakSpectrum, DaTrait, true> it(theo_spectrum, exp_spectrum, fragment_mass_tolerance);
-      for (; it != it.end(); ++it)
+      const Size exp_size = exp_spectrum.size();
+      if (exp_size == 0) return;
+      Size t = 0;
+      for (Size r = 0; r < theo_spectrum.size(); ++r)
       {
-        dot_product += (*it).getIntensity() * it.ref().getIntensity(); /* * mass_error */;
-        // fragment annotations in XL-MS data are more complex and do not start with the ion type, but the ion type always follows after a $
-        auto i = it.refIdx();
-        if ((*ion_names)[i][0] == 'y' || (*ion_names)[i].hasSubstring("$y"))
+        const Peak1D& theo_peak = theo_spectrum[r];
+        const double max_dist = TRAIT::allowedTol(tolerance, theo_peak);
+        float diff = std::numeric_limits<float>::max();
+        do
         {
-          ++y_ion_count;
+          auto d = TRAIT::getDiffAbsolute(theo_peak, exp_spectrum[t]);
+          if (diff > d) // getting better
+          {
+            diff = d;
+          }
+          else // getting worse (overshot)
+          {
+            --t;
+            break;
+          }
+          ++t;
+        } while (t != exp_size);
+
+        if (t == exp_size)
+        { // reset to last valid entry
+          --t;
         }
-        else if ((*ion_names)[i][0] == 'b' || (*ion_names)[i].hasSubstring("$b"))
+        if (diff <= max_dist)
         {
-          ++b_ion_count;
+          visit(r, t);
         }
       }
     }
-    // inefficient: calculates logs repeatedly
-    //const double yFact = logfactorial_(y_ion_count);
-    //const double bFact = logfactorial_(b_ion_count);
-    //const double hyperScore = log1p(dot_product) + yFact + bFact;
+  }
 
-    const int i_min = std::min(y_ion_count, b_ion_count);
-    const int i_max = std::max(y_ion_count, b_ion_count);
-    const double hyperScore = log1p(dot_product) + 2*logfactorial_(i_min) + logfactorial_(i_max, i_min + 1);
-    return hyperScore;
+  double HyperScore::compute(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const ColumnarSpectrum& exp_spectrum, const PeakSpectrum& theo_spectrum)
+  {
+    if (exp_spectrum.empty())
+    {
+      return 0.0;
+    }
+    return computeFromMatches_(theo_spectrum, [&](auto visit)
+    {
+      auto visit_peak = [&](Size theo_idx, Size exp_idx) { visit(theo_idx, exp_spectrum.getIntensity(exp_idx)); };
+      if (fragment_mass_tolerance_unit_ppm)
+      {
+        forEachMatch_<PpmTrait>(theo_spectrum, exp_spectrum, fragment_mass_tolerance, visit_peak);
+      }
+      else
+      {
+        forEachMatch_<DaTrait>(theo_spectrum, exp_spectrum, fragment_mass_tolerance, visit_peak);
+      }
+    });
   }
 
   double HyperScore::computeWithDetail(double fragment_mass_tolerance, 
@@ -209,5 +271,271 @@ namespace OpenMS
     return hyperScore;
   }
 
+  HyperScore::PreparedSpectrum::PreparedSpectrum(const PeakSpectrum& exp_spectrum, double bin_width)
+  {
+    if (!(bin_width > 0.0))
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "The bin width must be positive.", String(bin_width));
+    }
+
+    mz_.reserve(exp_spectrum.size());
+    intensity_.reserve(exp_spectrum.size());
+    for (const Peak1D& p : exp_spectrum)
+    {
+      mz_.push_back(p.getMZ());
+      intensity_.push_back(p.getIntensity());
+    }
+    if (mz_.empty())
+    {
+      return;
+    }
+
+    min_mz_ = mz_.front();
+    inv_bin_width_ = 1.0 / bin_width;
+
+    // the bin of a peak is computed exactly as in lowerBound(), so no peak before bin_begin_[b] can have an m/z in bin b or above
+    const Size bin_count = Size((mz_.back() - min_mz_) * inv_bin_width_) + 1;
+    bin_begin_.resize(bin_count);
+    Size peak = 0;
+    for (Size bin = 0; bin != bin_count; ++bin)
+    {
+      while (peak != mz_.size() && Size((mz_[peak] - min_mz_) * inv_bin_width_) < bin)
+      {
+        ++peak;
+      }
+      bin_begin_[bin] = (UInt32)peak;
+    }
+  }
+
+  Size HyperScore::PreparedSpectrum::lowerBound(double mz) const
+  {
+    if (mz_.empty() || mz <= min_mz_)
+    {
+      return 0;
+    }
+    const Size bin = Size((mz - min_mz_) * inv_bin_width_);
+    if (bin >= bin_begin_.size())
+    {
+      return mz_.size();
+    }
+    Size peak = bin_begin_[bin];
+    while (peak != mz_.size() && mz_[peak] < mz)
+    {
+      ++peak;
+    }
+    return peak;
+  }
+
+  Size HyperScore::PreparedSpectrum::findNearest(double mz) const
+  {
+    OPENMS_PRECONDITION(!mz_.empty(), "Cannot find the nearest peak in an empty spectrum.");
+
+    // distances are compared in single precision, as in MatchedIterator
+    Size peak = lowerBound(mz);
+    if (peak == mz_.size())
+    {
+      --peak;
+    }
+    else if (peak != 0 && float(std::fabs(mz - mz_[peak - 1])) <= float(std::fabs(mz - mz_[peak])))
+    {
+      --peak;
+    }
+    while (peak != 0 && float(std::fabs(mz - mz_[peak - 1])) == float(std::fabs(mz - mz_[peak])))
+    {
+      --peak;
+    }
+    return peak;
+  }
+
+  namespace
+  {
+    /// m/z and intensity of theoretical peaks and fragments
+    inline double theoMZ_(const Peak1D& p) { return p.getMZ(); }
+    inline double theoMZ_(const SimpleTSG::Fragment& f) { return f.mz; }
+    inline float theoIntensity_(const Peak1D& p) { return p.getIntensity(); }
+    inline float theoIntensity_(const SimpleTSG::Fragment& f) { return f.intensity; }
+
+    /// an m/z value as expected by the allowedTol() of the MatchedIterator traits
+    struct TheoMZ_
+    {
+      double mz;
+      double getMZ() const { return mz; }
+    };
+
+    /// calls @p visit(theo_index, exp_index) for each pair found by MatchedIterator<PeakSpectrum, TRAIT>(theo_spectrum, exp_spectrum, tolerance)
+    template <typename TRAIT, typename THEO, typename VISITOR>
+    void forEachMatch_(const THEO& theo_spectrum, const HyperScore::PreparedSpectrum& exp_spectrum, float tolerance, VISITOR visit)
+    {
+      if (exp_spectrum.empty()) return;
+      for (Size r = 0; r < theo_spectrum.size(); ++r)
+      {
+        const double theo_mz = theoMZ_(theo_spectrum[r]);
+        const Size t = exp_spectrum.findNearest(theo_mz);
+        const float diff = std::fabs(theo_mz - exp_spectrum.getMZ(t));
+        const double max_dist = TRAIT::allowedTol(tolerance, TheoMZ_{theo_mz});
+        if (diff <= max_dist)
+        {
+          visit(r, t);
+        }
+      }
+    }
+
+    /**
+      @brief matches @p theo_spectrum against @p exp_spectrum and accumulates the quantities of HyperScore::computeWithDetail
+
+      @p ion_type(theo_index) returns 'b', 'y' or another character for the ion type of a theoretical peak.
+      Errors and products are accumulated with the same precision as in the PeakSpectrum overload.
+    */
+    template <typename THEO, typename ION_TYPE>
+    void matchWithDetail_(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const HyperScore::PreparedSpectrum& exp_spectrum,
+      const THEO& theo_spectrum, ION_TYPE ion_type, int& y_ion_count, int& b_ion_count, double& dot_product, double& abs_error)
+    {
+      auto count_ion = [&](Size theo_idx)
+      {
+        const char type = ion_type(theo_idx);
+        if (type == 'y')
+        {
+          ++y_ion_count;
+        }
+        else if (type == 'b')
+        {
+          ++b_ion_count;
+        }
+      };
+      if (fragment_mass_tolerance_unit_ppm)
+      {
+        forEachMatch_<PpmTrait>(theo_spectrum, exp_spectrum, fragment_mass_tolerance, [&](Size theo_idx, Size exp_idx)
+        {
+          const double exp_int{exp_spectrum.getIntensity(exp_idx)};
+          const double theo_int{theoIntensity_(theo_spectrum[theo_idx])};
+          abs_error += Math::getPPMAbs(exp_spectrum.getMZ(exp_idx), theoMZ_(theo_spectrum[theo_idx]));
+          dot_product += theo_int * exp_int;
+          count_ion(theo_idx);
+        });
+      }
+      else
+      {
+        forEachMatch_<DaTrait>(theo_spectrum, exp_spectrum, fragment_mass_tolerance, [&](Size theo_idx, Size exp_idx)
+        {
+          abs_error += std::fabs(exp_spectrum.getMZ(exp_idx) - theoMZ_(theo_spectrum[theo_idx]));
+          dot_product += exp_spectrum.getIntensity(exp_idx) * theoIntensity_(theo_spectrum[theo_idx]);
+          count_ion(theo_idx);
+        });
+      }
+    }
+  }
+
+  double HyperScore::compute(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const PreparedSpectrum& exp_spectrum, const PeakSpectrum& theo_spectrum)
+  {
+    if (exp_spectrum.empty())
+    {
+      return 0.0;
+    }
+    return computeFromMatches_(theo_spectrum, [&](auto visit)
+    {
+      auto visit_peak = [&](Size theo_idx, Size exp_idx) { visit(theo_idx, exp_spectrum.getIntensity(exp_idx)); };
+      if (fragment_mass_tolerance_unit_ppm)
+      {
+        forEachMatch_<PpmTrait>(theo_spectrum, exp_spectrum, fragment_mass_tolerance, visit_peak);
+      }
+      else
+      {
+        forEachMatch_<DaTrait>(theo_spectrum, exp_spectrum, fragment_mass_tolerance, visit_peak);
+      }
+    });
+  }
+
+  double HyperScore::computeWithDetail(double fragment_mass_tolerance,
+    bool fragment_mass_tolerance_unit_ppm,
+    const PreparedSpectrum& exp_spectrum,
+    const PeakSpectrum& theo_spectrum,
+    PSMDetail& d)
+  {
+    if (exp_spectrum.empty() || theo_spectrum.empty())
+    {
+      std::cout << "Warning: HyperScore: One of the given spectra is empty." << std::endl;
+      return 0.0;
+    }
+
+    // TODO this assumes only one StringDataArray is present and it is the right one
+    if (theo_spectrum.getStringDataArrays().empty())
+    {
+      std::cout << "Error: HyperScore: Theoretical spectrum without StringDataArray (\"IonNames\" annotation) provided." << std::endl;
+      return 0.0;
+    }
+    const PeakSpectrum::StringDataArray& ion_names = theo_spectrum.getStringDataArrays()[0];
+
+    int y_ion_count = 0;
+    int b_ion_count = 0;
+    double dot_product = 0.0;
+    double abs_error = 0.0;
+    matchWithDetail_(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum, [&](Size theo_idx)
+    {
+      // fragment annotations in XL-MS data are more complex and do not start with the ion type, but the ion type always follows after a $
+      if (ion_names[theo_idx][0] == 'y' || ion_names[theo_idx].hasSubstring("$y"))
+      {
+        return 'y';
+      }
+      if (ion_names[theo_idx][0] == 'b' || ion_names[theo_idx].hasSubstring("$b"))
+      {
+        return 'b';
+      }
+      return ' ';
+    }, y_ion_count, b_ion_count, dot_product, abs_error);
+
+    const int i_min = std::min(y_ion_count, b_ion_count);
+    const int i_max = std::max(y_ion_count, b_ion_count);
+    const double hyperScore = log1p(dot_product) + 2*logfactorial_(i_min) + logfactorial_(i_max, i_min + 1);
+    d.matched_b_ions = b_ion_count;
+    d.matched_y_ions = y_ion_count;
+    d.mean_error = (b_ion_count + y_ion_count) > 0 ? abs_error / (double)(b_ion_count + y_ion_count) : 0.0;
+    return hyperScore;
+  }
+
+  double HyperScore::computeWithDetail(double fragment_mass_tolerance,
+    bool fragment_mass_tolerance_unit_ppm,
+    const PreparedSpectrum& exp_spectrum,
+    const vector<SimpleTSG::Fragment>& theo_fragments,
+    PSMDetail& d)
+  {
+    if (exp_spectrum.empty() || theo_fragments.empty())
+    {
+      std::cout << "Warning: HyperScore: One of the given spectra is empty." << std::endl;
+      return 0.0;
+    }
+
+    int y_ion_count = 0;
+    int b_ion_count = 0;
+    double dot_product = 0.0;
+    double abs_error = 0.0;
+    matchWithDetail_(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_fragments, [&](Size theo_idx)
+    {
+      return theo_fragments[theo_idx].ion_type;
+    }, y_ion_count, b_ion_count, dot_product, abs_error);
+
+    const int i_min = std::min(y_ion_count, b_ion_count);
+    const int i_max = std::max(y_ion_count, b_ion_count);
+    const double hyperScore = log1p(dot_product) + 2*logfactorial_(i_min) + logfactorial_(i_max, i_min + 1);
+    d.matched_b_ions = b_ion_count;
+    d.matched_y_ions = y_ion_count;
+    d.mean_error = (b_ion_count + y_ion_count) > 0 ? abs_error / (double)(b_ion_count + y_ion_count) : 0.0;
+    return hyperScore;
+  }
+
+  void HyperScore::computeBatch(double fragment_mass_tolerance,
+    bool fragment_mass_tolerance_unit_ppm,
+    const PreparedSpectrum& exp_spectrum,
+    const vector<PeakSpectrum>& theo_spectra,
+    vector<double>& scores,
+    vector<PSMDetail>& details)
+  {
+    scores.assign(theo_spectra.size(), 0.0);
+    details.assign(theo_spectra.size(), PSMDetail());
+    for (Size i = 0; i != theo_spectra.size(); ++i)
+    {
+      scores[i] = computeWithDetail(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectra[i], details[i]);
+    }
+  }
+
 }
 
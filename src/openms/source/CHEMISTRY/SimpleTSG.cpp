@@ -0,0 +1,339 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CHEMISTRY/SimpleTSG.h>
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/ResidueModification.h>
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/Exception.h>
+
+using namespace std;
+
+namespace OpenMS
+{
+
+  SimpleTSG::SimpleTSG() :
+    DefaultParamHandler("SimpleTSG")
+  {
+    defaults_.setValue("add_first_prefix_ion", "false", "If set to true e.g. b1 ions are added");
+    defaults_.setValidStrings("add_first_prefix_ion", {"true","false"});
+
+    defaults_.setValue("add_y_ions", "true", "Add peaks of y-ions to the spectrum");
+    defaults_.setValidStrings("add_y_ions", {"true","false"});
+
+    defaults_.setValue("add_b_ions", "true", "Add peaks of b-ions to the spectrum");
+    defaults_.setValidStrings("add_b_ions", {"true","false"});
+
+    defaults_.setValue("add_a_ions", "false", "Add peaks of a-ions to the spectrum");
+    defaults_.setValidStrings("add_a_ions", {"true","false"});
+
+    defaults_.setValue("add_c_ions", "false", "Add peaks of c-ions to the spectrum");
+    defaults_.setValidStrings("add_c_ions", {"true","false"});
+
+    defaults_.setValue("add_x_ions", "false", "Add peaks of  x-ions to the spectrum");
+    defaults_.setValidStrings("add_x_ions", {"true","false"});
+
+    defaults_.setValue("add_z_ions", "false", "Add peaks of z-ions to the spectrum");
+    defaults_.setValidStrings("add_z_ions", {"true","false"});
+
+    // intensity options of the ions
+    defaults_.setValue("y_intensity", 1.0, "Intensity of the y-ions");
+    defaults_.setMinFloat("y_intensity", 0.0);
+    defaults_.setValue("b_intensity", 1.0, "Intensity of the b-ions");
+    defaults_.setMinFloat("b_intensity", 0.0);
+    defaults_.setValue("a_intensity", 1.0, "Intensity of the a-ions");
+    defaults_.setMinFloat("a_intensity", 0.0);
+    defaults_.setValue("c_intensity", 1.0, "Intensity of the c-ions");
+    defaults_.setMinFloat("c_intensity", 0.0);
+    defaults_.setValue("x_intensity", 1.0, "Intensity of the x-ions");
+    defaults_.setMinFloat("x_intensity", 0.0);
+    defaults_.setValue("z_intensity", 1.0, "Intensity of the z-ions");
+    defaults_.setMinFloat("z_intensity", 0.0);
+
+    defaultsToParam_();
+  }
+
+  SimpleTSG::SimpleTSG(const SimpleTSG& source) :
+    DefaultParamHandler(source)
+  {
+    updateMembers_();
+  }
+
+  SimpleTSG& SimpleTSG::operator=(const SimpleTSG& source)
+  {
+    if (this != &source)
+    {
+      DefaultParamHandler::operator=(source);
+      updateMembers_();
+    }
+    return *this;
+  }
+
+  SimpleTSG::~SimpleTSG() = default;
+
+  void SimpleTSG::updateMembers_()
+  {
+    add_b_ions_ = param_.getValue("add_b_ions").toBool();
+    add_y_ions_ = param_.getValue("add_y_ions").toBool();
+    add_a_ions_ = param_.getValue("add_a_ions").toBool();
+    add_c_ions_ = param_.getValue("add_c_ions").toBool();
+    add_x_ions_ = param_.getValue("add_x_ions").toBool();
+    add_z_ions_ = param_.getValue("add_z_ions").toBool();
+    add_first_prefix_ion_ = param_.getValue("add_first_prefix_ion").toBool();
+    a_intensity_ = (double)param_.getValue("a_intensity");
+    b_intensity_ = (double)param_.getValue("b_intensity");
+    c_intensity_ = (double)param_.getValue("c_intensity");
+    x_intensity_ = (double)param_.getValue("x_intensity");
+    y_intensity_ = (double)param_.getValue("y_intensity");
+    z_intensity_ = (double)param_.getValue("z_intensity");
+    clearCache_();
+  }
+
+  void SimpleTSG::clearCache_()
+  {
+    residues_.clear();
+    n_term_mod_ = nullptr;
+    c_term_mod_ = nullptr;
+    min_charge_ = 0;
+    max_charge_ = -1;
+    prefix_masses_.clear();
+    suffix_masses_.clear();
+  }
+
+  Size SimpleTSG::getComputedResidueMasses() const
+  {
+    return computed_residue_masses_;
+  }
+
+  void SimpleTSG::updateLadders_(const AASequence& peptide, Int min_charge, Int max_charge)
+  {
+    const Size n = peptide.size();
+    const ResidueModification* n_term_mod = peptide.hasNTerminalModification() ? peptide.getNTerminalModification() : nullptr;
+    const ResidueModification* c_term_mod = peptide.hasCTerminalModification() ? peptide.getCTerminalModification() : nullptr;
+
+    // number of leading and trailing residues shared with the previous peptide (whose sums can be kept)
+    Size common_prefix = 0;
+    Size common_suffix = 0;
+    if (min_charge == min_charge_ && max_charge == max_charge_)
+    {
+      const Size common_size = std::min(n, residues_.size());
+      if (n_term_mod == n_term_mod_)
+      {
+        while (common_prefix < common_size && residues_[common_prefix] == &peptide[common_prefix])
+        {
+          ++common_prefix;
+        }
+      }
+      if (c_term_mod == c_term_mod_)
+      {
+        while (common_suffix < common_size && residues_[residues_.size() - 1 - common_suffix] == &peptide[n - 1 - common_suffix])
+        {
+          ++common_suffix;
+        }
+      }
+    }
+    else
+    {
+      min_charge_ = min_charge;
+      max_charge_ = max_charge;
+      prefix_masses_.resize(max_charge - min_charge + 1);
+      suffix_masses_.resize(max_charge - min_charge + 1);
+    }
+
+    residues_.resize(n);
+    for (Size i = 0; i != n; ++i)
+    {
+      residues_[i] = &peptide[i];
+    }
+    n_term_mod_ = n_term_mod;
+    c_term_mod_ = c_term_mod;
+
+    // sums are accumulated in the same order as in TheoreticalSpectrumGenerator, so the m/z values are identical
+    for (Int z = min_charge; z <= max_charge; ++z)
+    {
+      vector<double>& prefix = prefix_masses_[z - min_charge];
+      prefix.resize(n);
+      double mono_weight = Constants::PROTON_MASS_U * z;
+      if (n_term_mod != nullptr)
+      {
+        mono_weight += n_term_mod->getDiffMonoMass();
+      }
+      if (common_prefix != 0)
+      {
+        mono_weight = prefix[common_prefix - 1];
+      }
+      for (Size i = common_prefix; i < n; ++i)
+      {
+        mono_weight += residues_[i]->getMonoWeight(Residue::Internal);
+        prefix[i] = mono_weight;
+      }
+
+      vector<double>& suffix = suffix_masses_[z - min_charge];
+      suffix.resize(n);
+      mono_weight = Constants::PROTON_MASS_U * z;
+      if (c_term_mod != nullptr)
+      {
+        mono_weight += c_term_mod->getDiffMonoMass();
+      }
+      if (common_suffix != 0)
+      {
+        mono_weight = suffix[common_suffix - 1];
+      }
+      for (Size k = common_suffix; k < n; ++k)
+      {
+        mono_weight += residues_[n - 1 - k]->getMonoWeight(Residue::Internal);
+        suffix[k] = mono_weight;
+      }
+    }
+    computed_residue_masses_ = (max_charge - min_charge + 1) * ((n - common_prefix) + (n - common_suffix));
+  }
+
+  void SimpleTSG::addIons_(Residue::ResidueType res_type, Int charge)
+  {
+    static const double a_offset = Residue::getInternalToAIon().getMonoWeight();
+    static const double b_offset = Residue::getInternalToBIon().getMonoWeight();
+    static const double c_offset = Residue::getInternalToCIon().getMonoWeight();
+    static const double x_offset = Residue::getInternalToXIon().getMonoWeight();
+    static const double y_offset = Residue::getInternalToYIon().getMonoWeight();
+    static const double z_offset = Residue::getInternalToZIon().getMonoWeight();
+
+    Fragment f;
+    f.ion_type = Residue::residueTypeToIonLetter(res_type);
+    f.charge = charge;
+    double ion_offset = 0.0;
+    switch (res_type)
+    {
+      case Residue::AIon: ion_offset = a_offset; f.intensity = a_intensity_; break;
+      case Residue::BIon: ion_offset = b_offset; f.intensity = b_intensity_; break;
+      case Residue::CIon: ion_offset = c_offset; f.intensity = c_intensity_; break;
+      case Residue::XIon: ion_offset = x_offset; f.intensity = x_intensity_; break;
+      case Residue::YIon: ion_offset = y_offset; f.intensity = y_intensity_; break;
+      case Residue::ZIon: ion_offset = z_offset; f.intensity = z_intensity_; break;
+      default: break;
+    }
+
+    // as in TheoreticalSpectrumGenerator, the ions of the full peptide are not generated
+    const Size n = residues_.size();
+    if (res_type == Residue::AIon || res_type == Residue::BIon || res_type == Residue::CIon)
+    {
+      const vector<double>& prefix = prefix_masses_[charge - min_charge_];
+      for (Size i = Size(!add_first_prefix_ion_); i + 1 < n; ++i)
+      {
+        f.mz = (prefix[i] + ion_offset) / charge;
+        unsorted_.push_back(f);
+      }
+    }
+    else
+    {
+      const vector<double>& suffix = suffix_masses_[charge - min_charge_];
+      for (Size k = 0; k + 1 < n; ++k)
+      {
+        f.mz = (suffix[k] + ion_offset) / charge;
+        unsorted_.push_back(f);
+      }
+    }
+  }
+
+  void SimpleTSG::generate_(const AASequence& peptide, Int min_charge, Int max_charge)
+  {
+    unsorted_.clear();
+    run_starts_.clear();
+    computed_residue_masses_ = 0;
+    if (peptide.empty() || min_charge > max_charge)
+    {
+      run_starts_.push_back(0);
+      return;
+    }
+    if ((add_c_ions_ || add_x_ions_) && peptide.size() < 2)
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 1);
+    }
+
+    updateLadders_(peptide, min_charge, max_charge);
+
+    for (Int z = min_charge; z <= max_charge; ++z)
+    {
+      for (const pair<bool, Residue::ResidueType>& ion : { make_pair(add_b_ions_, Residue::BIon), make_pair(add_y_ions_, Residue::YIon),
+                                                           make_pair(add_a_ions_, Residue::AIon), make_pair(add_c_ions_, Residue::CIon),
+                                                           make_pair(add_x_ions_, Residue::XIon), make_pair(add_z_ions_, Residue::ZIon) })
+      {
+        if (ion.first)
+        {
+          run_starts_.push_back(unsorted_.size());
+          addIons_(ion.second, z);
+        }
+      }
+    }
+    run_starts_.push_back(unsorted_.size());
+  }
+
+  template <typename EMIT>
+  void SimpleTSG::mergeRuns_(EMIT emit)
+  {
+    // k-way merge of the (few) ascending runs; on equal m/z the earlier run comes first
+    const Size runs = run_starts_.size() - 1;
+    run_heads_.assign(run_starts_.begin(), run_starts_.end() - 1);
+    for (Size remaining = unsorted_.size(); remaining != 0; --remaining)
+    {
+      Size best_run = runs;
+      for (Size r = 0; r != runs; ++r)
+      {
+        if (run_heads_[r] != run_starts_[r + 1] &&
+            (best_run == runs || unsorted_[run_heads_[r]].mz < unsorted_[run_heads_[best_run]].mz))
+        {
+          best_run = r;
+        }
+      }
+      emit(unsorted_[run_heads_[best_run]++]);
+    }
+  }
+
+  void SimpleTSG::getSpectrum(vector<Fragment>& fragments, const AASequence& peptide, Int min_charge, Int max_charge)
+  {
+    generate_(peptide, min_charge, max_charge);
+    fragments.clear();
+    fragments.reserve(unsorted_.size());
+    mergeRuns_([&fragments](const Fragment& f) { fragments.push_back(f); });
+  }
+
+  void SimpleTSG::getSpectrum(vector<double>& mzs, const AASequence& peptide, Int min_charge, Int max_charge)
+  {
+    generate_(peptide, min_charge, max_charge);
+    mzs.clear();
+    mzs.reserve(unsorted_.size());
+    mergeRuns_([&mzs](const Fragment& f) { mzs.push_back(f.mz); });
+  }
+
+} // namespace OpenMS
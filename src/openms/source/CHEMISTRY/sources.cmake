@@ -33,6 +33,7 @@ RNaseDigestion.cpp
 Ribonucleotide.cpp
 RibonucleotideDB.cpp
 SpectrumAnnotator.cpp
+SimpleTSG.cpp
 SimpleTSGXLMS.cpp
 SvmTheoreticalSpectrumGenerator.cpp
 SvmTheoreticalSpectrumGeneratorTrainer.cpp
@@ -35,13 +35,14 @@
 #include <OpenMS/FILTERING/DATAREDUCTION/FeatureFindingMetabo.h>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
-#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/CONCEPT/UniqueIdGenerator.h>
+#include <OpenMS/FILTERING/DATAREDUCTION/IsotopeDistributionCache.h>
 #include <OpenMS/SYSTEM/File.h>
 
 #include <fstream>
+#include <memory>
 
 #include <boost/dynamic_bitset.hpp>
 
@@ -356,13 +357,12 @@ namespace OpenMS
     return elements;
   }
 
-  double FeatureFindingMetabo::computeAveragineSimScore_(const std::vector<double>& hypo_ints, const double& mol_weight) const
+  double FeatureFindingMetabo::computeAveragineSimScore_(const std::vector<double>& hypo_ints, const double& mol_weight, const IsotopeDistributionCache& averagine) const
   {
-    CoarseIsotopePatternGenerator solver(hypo_ints.size());
-    auto isodist = solver.estimateFromPeptideWeight(mol_weight);
-    // isodist.renormalize();
+    // cached distributions are not trimmed on the left (see run()) and hold more isotopes than any hypothesis
+    const std::vector<double>& averagine_dist = averagine.getIsotopeDistribution(mol_weight).intensity;
+    auto theoInt = [&averagine_dist](Size i) { return i < averagine_dist.size() ? averagine_dist[i] : 0.0; };
 
-    IsotopeDistribution::ContainerType averagine_dist = isodist.getContainer();
     double max_int(0.0), theo_max_int(0.0);
     for (Size i = 0; i < hypo_ints.size(); ++i)
     {
@@ -371,9 +371,9 @@ namespace OpenMS
         max_int = hypo_ints[i];
       }
 
-      if (averagine_dist[i].getIntensity() > theo_max_int)
+      if (theoInt(i) > theo_max_int)
       {
-        theo_max_int = averagine_dist[i].getIntensity();
+        theo_max_int = theoInt(i);
       }
     }
 
@@ -381,7 +381,7 @@ namespace OpenMS
     std::vector<double> averagine_ratios, hypo_isos;
     for (Size i = 0; i < hypo_ints.size(); ++i)
     {
-      averagine_ratios.push_back(averagine_dist[i].getIntensity() / theo_max_int);
+      averagine_ratios.push_back(theoInt(i) / theo_max_int);
       hypo_isos.push_back(hypo_ints[i] / max_int);
     }
 
@@ -750,20 +750,13 @@ namespace OpenMS
   }
 
 
-  void FeatureFindingMetabo::findLocalFeatures_(const std::vector<const MassTrace*>& candidates, const double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses) const
+  void FeatureFindingMetabo::findLocalFeatures_(const std::vector<const MassTrace*>& candidates, const double total_intensity, const IsotopeDistributionCache* averagine_cache, std::vector<FeatureHypothesis>& output_hypotheses) const
   {
     // single Mass trace hypothesis
     FeatureHypothesis tmp_hypo;
     tmp_hypo.addMassTrace(*candidates[0]);
     tmp_hypo.setScore((candidates[0]->getIntensity(use_smoothed_intensities_)) / total_intensity);
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-    {
-      // pushing back to shared vector needs to be synchronized
-      output_hypotheses.push_back(tmp_hypo);
-    }
+    output_hypotheses.push_back(tmp_hypo);
 
     for (Size charge = charge_lower_bound_; charge <= charge_upper_bound_; ++charge)
     {
@@ -808,7 +801,7 @@ namespace OpenMS
           {
             std::vector<double> tmp_ints(fh_tmp.getAllIntensities());
             tmp_ints.push_back(candidates[mt_idx]->getIntensity(use_smoothed_intensities_));
-            int_score = computeAveragineSimScore_(tmp_ints, candidates[mt_idx]->getCentroidMZ() * charge);
+            int_score = computeAveragineSimScore_(tmp_ints, candidates[mt_idx]->getCentroidMZ() * charge, *averagine_cache);
           }
 
 #ifdef FFM_DEBUG
@@ -839,14 +832,7 @@ namespace OpenMS
           fh_tmp.setScore(fh_tmp.getScore() + weighted_score);
           fh_tmp.setCharge(charge);
           last_iso_idx = best_idx;
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-          {
-            // pushing back to shared vector needs to be synchronized
-            output_hypotheses.push_back(fh_tmp);
-          }
+          output_hypotheses.push_back(fh_tmp);
         }
         else
         {
@@ -909,12 +895,49 @@ namespace OpenMS
     // and generate isotopic / charge hypotheses
     // *********************************************************** //
 
-    std::vector<FeatureHypothesis> feat_hypos;
+    // averagine isotope distributions for the 'peptides' model, precomputed in 1 Da bins up to the
+    // largest mass a hypothesis can have
+    std::unique_ptr<IsotopeDistributionCache> averagine_cache;
+    if (isotope_filtering_model_ == "peptides")
+    {
+      double max_mass = input_mtraces.back().getCentroidMZ() * charge_upper_bound_;
+      averagine_cache = std::make_unique<IsotopeDistributionCache>(max_mass + 1.0, 1.0);
+    }
+
+    // Coarse RT grid over the (m/z sorted) traces: every bin lists its traces
+    // in m/z order, so candidates of a trace are collected from the
+    // neighbouring RT bins only, stopping in each bin at the m/z window.
+    const Size trace_count(input_mtraces.size());
+    std::vector<double> trace_mzs(trace_count), trace_rts(trace_count);
+    for (Size i = 0; i < trace_count; ++i)
+    {
+      trace_mzs[i] = input_mtraces[i].getCentroidMZ();
+      trace_rts[i] = input_mtraces[i].getCentroidRT();
+    }
+    const double rt_min = *std::min_element(trace_rts.begin(), trace_rts.end());
+    const double rt_max = *std::max_element(trace_rts.begin(), trace_rts.end());
+    double rt_bin_width = std::max(local_rt_range_, (rt_max - rt_min) / trace_count);
+    if (!(rt_bin_width > 0.0))
+    {
+      rt_bin_width = 1.0;
+    }
+    auto rtBin = [&](double rt) -> SignedSize
+    {
+      return static_cast<SignedSize>(std::floor((rt - rt_min) / rt_bin_width));
+    };
+    std::vector<std::vector<Size> > rt_bins(rtBin(rt_max) + 1);
+    for (Size i = 0; i < trace_count; ++i)
+    {
+      rt_bins[rtBin(trace_rts[i])].push_back(i);
+    }
+
+    // hypotheses are collected per trace (no synchronization needed) and concatenated in trace order
+    std::vector<std::vector<FeatureHypothesis> > hypos_per_trace(trace_count);
     Size progress(0);
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 64)
 #endif
-    for (SignedSize i = 0; i < (SignedSize)input_mtraces.size(); ++i)
+    for (SignedSize i = 0; i < (SignedSize)trace_count; ++i)
     {
       IF_MASTERTHREAD this->setProgress(progress);
 #ifdef _OPENMP
@@ -922,31 +945,59 @@ namespace OpenMS
 #endif
       ++progress;
 
-      std::vector<const MassTrace*> local_traces;
-      double ref_trace_mz(input_mtraces[i].getCentroidMZ());
-      double ref_trace_rt(input_mtraces[i].getCentroidRT());
+      const double ref_trace_mz(trace_mzs[i]);
+      const double ref_trace_rt(trace_rts[i]);
 
-      local_traces.push_back(&input_mtraces[i]);
+      // one extra bin on both sides guards against rounding at the bin borders
+      const SignedSize first_bin = std::max(SignedSize(0), rtBin(ref_trace_rt - local_rt_range_) - 1);
+      const SignedSize last_bin = std::min(SignedSize(rt_bins.size()) - 1, rtBin(ref_trace_rt + local_rt_range_) + 1);
 
-      for (Size ext_idx = i + 1; ext_idx < input_mtraces.size(); ++ext_idx)
+      std::vector<Size> local_idx;
+      for (SignedSize b = first_bin; b <= last_bin; ++b)
       {
-        // traces are sorted by m/z, so we can break when we leave the allowed window
-        double diff_mz = std::fabs(input_mtraces[ext_idx].getCentroidMZ() - ref_trace_mz);
-        if (diff_mz > local_mz_range_)
-        {
-          break;
-        }
-        double diff_rt = std::fabs(input_mtraces[ext_idx].getCentroidRT() - ref_trace_rt);
-        if (diff_rt <= local_rt_range_)
+        const std::vector<Size>& bin = rt_bins[b];
+        for (auto it = std::upper_bound(bin.begin(), bin.end(), (Size)i); it != bin.end(); ++it)
         {
-          // std::cout << " accepted!" << std::endl;
-          local_traces.push_back(&input_mtraces[ext_idx]);
+          // traces are sorted by m/z, so we can break when we leave the allowed window
+          double diff_mz = std::fabs(trace_mzs[*it] - ref_trace_mz);
+          if (diff_mz > local_mz_range_)
+          {
+            break;
+          }
+          double diff_rt = std::fabs(trace_rts[*it] - ref_trace_rt);
+          if (diff_rt <= local_rt_range_)
+          {
+            local_idx.push_back(*it);
+          }
         }
       }
-      findLocalFeatures_(local_traces, total_intensity, feat_hypos);
+      // restore the m/z order of the candidates
+      std::sort(local_idx.begin(), local_idx.end());
+
+      std::vector<const MassTrace*> local_traces;
+      local_traces.reserve(local_idx.size() + 1);
+      local_traces.push_back(&input_mtraces[i]);
+      for (Size idx : local_idx)
+      {
+        local_traces.push_back(&input_mtraces[idx]);
+      }
+      findLocalFeatures_(local_traces, total_intensity, averagine_cache.get(), hypos_per_trace[i]);
     }
     this->endProgress();
 
+    std::vector<FeatureHypothesis> feat_hypos;
+    Size hypo_count(0);
+    for (const std::vector<FeatureHypothesis>& hypos : hypos_per_trace)
+    {
+      hypo_count += hypos.size();
+    }
+    feat_hypos.reserve(hypo_count);
+    for (std::vector<FeatureHypothesis>& hypos : hypos_per_trace)
+    {
+      std::move(hypos.begin(), hypos.end(), std::back_inserter(feat_hypos));
+      std::vector<FeatureHypothesis>().swap(hypos);
+    }
+
     // sort feature candidates by their score
     std::sort(feat_hypos.begin(), feat_hypos.end(), CmpHypothesesByScore());
 
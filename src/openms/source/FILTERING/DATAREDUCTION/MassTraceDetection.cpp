@@ -38,6 +38,10 @@
 
 #include <boost/dynamic_bitset.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
     MassTraceDetection::MassTraceDetection() :
@@ -61,6 +65,8 @@ namespace OpenMS
       defaults_.setValue("min_sample_rate", 0.5, "Minimum fraction of scans along the mass trace that must contain a peak.", {"advanced"});
       defaults_.setValue("min_trace_length", 5.0, "Minimum expected length of a mass trace (in seconds).", {"advanced"});
       defaults_.setValue("max_trace_length", -1.0, "Maximum expected length of a mass trace (in seconds). Set to a negative value to disable maximal length check during mass trace detection.", {"advanced"});
+      defaults_.setValue("mz_strips", 0, "Number of m/z strips whose mass traces are extended in parallel. Traces crossing strip borders are resolved afterwards, so the result is identical to the serial extension. '0' chooses the number based on the available threads, '1' disables the parallel extension.", {"advanced"});
+      defaults_.setMinInt("mz_strips", 0);
 
       defaultsToParam_();
 
@@ -267,284 +273,440 @@ namespace OpenMS
       return;
     } // end of MassTraceDetection::run
 
-    void MassTraceDetection::run_(const std::vector<Apex>& chrom_apices,
-                                  const Size total_peak_count,
-                                  const PeakMap& work_exp,
-                                  const std::vector<Size>& spec_offsets,
-                                  std::vector<MassTrace>& found_masstraces,
-                                  const Size max_traces)
+    template <typename VisitedSet>
+    void MassTraceDetection::extendTrace_(const Apex& apex,
+                                          const PeakMap& work_exp,
+                                          const std::vector<Size>& spec_offsets,
+                                          const int fwhm_meta_idx,
+                                          const VisitedSet& peak_visited,
+                                          const bool record_tests,
+                                          TraceCandidate& trace)
     {
-      boost::dynamic_bitset<> peak_visited(total_peak_count);
-      Size trace_number(1);
-
-      // check presence of FWHM meta data
-      int fwhm_meta_idx(-1);
-      Size fwhm_meta_count(0);
-      for (Size i = 0; i < work_exp.size(); ++i)
+      Size apex_scan_idx(apex.scan_idx);
+      Size apex_peak_idx(apex.peak_idx);
+
+      trace.accepted = false;
+      trace.peaks.clear();
+      trace.down_.clear();
+      trace.fwhms_mz.clear();
+      trace.gathered.clear();
+      trace.seen_free.clear();
+      trace.seen_visited.clear();
+
+      // tests whether a peak may still be gathered (and remembers the outcome if requested)
+      auto isFree = [&](Size global_idx) -> bool
       {
-        if (!work_exp[i].getFloatDataArrays().empty() &&
-            work_exp[i].getFloatDataArrays()[0].getName() == "FWHM_ppm")
+        bool visited = peak_visited[global_idx];
+        if (record_tests)
         {
-          if (work_exp[i].getFloatDataArrays()[0].size() != work_exp[i].size())
-          { // float data should always have the same size as the corresponding array
-            throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, work_exp[i].size());
-          }
-          fwhm_meta_idx = 0;
-          ++fwhm_meta_count;
+          (visited ? trace.seen_visited : trace.seen_free).push_back(global_idx);
         }
-      }
-      if (fwhm_meta_count > 0 && fwhm_meta_count != work_exp.size())
-      {
-        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                      String("FWHM meta arrays are expected to be missing or present for all MS spectra [") + fwhm_meta_count + "/" + work_exp.size() + "].");
-      }
+        return !visited;
+      };
 
+      Peak2D apex_peak;
+      apex_peak.setRT(work_exp[apex_scan_idx].getRT());
+      apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
+      apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
 
-      this->startProgress(0, total_peak_count, "mass trace detection");
-      Size peaks_detected(0);
+      Size trace_up_idx(apex_scan_idx);
+      Size trace_down_idx(apex_scan_idx);
+
+      // peaks towards higher RT are appended to 'peaks' (starting with the apex), peaks towards
+      // lower RT to 'down_' in reverse order; both are joined once the trace is accepted
+      trace.peaks.push_back(apex_peak);
+
+      // Initialization for the iterative version of weighted m/z mean calculation
+      double centroid_mz(apex_peak.getMZ());
+      double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
+      double prev_denom(apex_peak.getIntensity());
 
-      for (auto m_it = chrom_apices.crbegin(); m_it != chrom_apices.crend(); ++m_it)
+      updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
+
+      trace.gathered.push_back(spec_offsets[apex_scan_idx] + apex_peak_idx);
+      if (fwhm_meta_idx != -1)
       {
-        Size apex_scan_idx(m_it->scan_idx);
-        Size apex_peak_idx(m_it->peak_idx);
+        trace.fwhms_mz.push_back(work_exp[apex_scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex_peak_idx]);
+      }
 
-        if (peak_visited[spec_offsets[apex_scan_idx] + apex_peak_idx])
-        {
-          continue;
-        }
+      Size up_hitting_peak(0), down_hitting_peak(0);
+      Size up_scan_counter(0), down_scan_counter(0);
 
-        Peak2D apex_peak;
-        apex_peak.setRT(work_exp[apex_scan_idx].getRT());
-        apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
-        apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
+      bool toggle_up = true, toggle_down = true;
 
-        Size trace_up_idx(apex_scan_idx);
-        Size trace_down_idx(apex_scan_idx);
+      Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
+      Size max_consecutive_missing(trace_termination_outliers_);
 
-        std::list<PeakType> current_trace;
-        current_trace.push_back(apex_peak);
-        std::vector<double> fwhms_mz; // peak-FWHM meta values of collected peaks
+      double current_sample_rate(1.0);
+      // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
+      Size min_scans_to_consider(5);
 
-        // Initialization for the iterative version of weighted m/z mean calculation
-        double centroid_mz(apex_peak.getMZ());
-        double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
-        double prev_denom(apex_peak.getIntensity());
+      // double outlier_ratio(0.3);
 
-        updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
+      // double ftl_mean(centroid_mz);
+      double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
+      double intensity_so_far(apex_peak.getIntensity());
 
-        std::vector<std::pair<Size, Size> > gathered_idx;
-        gathered_idx.emplace_back(apex_scan_idx, apex_peak_idx);
-        if (fwhm_meta_idx != -1)
+      while (((trace_down_idx > 0) && toggle_down) ||
+             ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+              )
+      {
+        // *********************************************************** //
+        // Step 2.1 MOVE DOWN in RT dim
+        // *********************************************************** //
+        if ((trace_down_idx > 0) && toggle_down)
         {
-          fwhms_mz.push_back(work_exp[apex_scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex_peak_idx]);
-        }
+          const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
+          if (!spec_trace_down.empty())
+          {
+            Size next_down_peak_idx = spec_trace_down.findNearest(centroid_mz);
+            double next_down_peak_mz = spec_trace_down[next_down_peak_idx].getMZ();
+            double next_down_peak_int = spec_trace_down[next_down_peak_idx].getIntensity();
 
-        Size up_hitting_peak(0), down_hitting_peak(0);
-        Size up_scan_counter(0), down_scan_counter(0);
+            double right_bound = centroid_mz + 3 * ftl_sd;
+            double left_bound = centroid_mz - 3 * ftl_sd;
 
-        bool toggle_up = true, toggle_down = true;
+            if ((next_down_peak_mz <= right_bound) &&
+                (next_down_peak_mz >= left_bound) &&
+                isFree(spec_offsets[trace_down_idx - 1] + next_down_peak_idx)
+                    )
+            {
+              Peak2D next_peak;
+              next_peak.setRT(spec_trace_down.getRT());
+              next_peak.setMZ(next_down_peak_mz);
+              next_peak.setIntensity(next_down_peak_int);
+
+              trace.down_.push_back(next_peak);
+              // FWHM average
+              if (fwhm_meta_idx != -1)
+              {
+                trace.fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
+              }
+              // Update the m/z mean of the current trace as we added a new peak
+              updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
+              trace.gathered.push_back(spec_offsets[trace_down_idx - 1] + next_down_peak_idx);
 
-        Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
-        Size max_consecutive_missing(trace_termination_outliers_);
+              // Update the m/z variance dynamically
+              if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+              {
+                // if (ftl_t > min_fwhm_scans)
+                {
+                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
+                }
+              }
 
-        double current_sample_rate(1.0);
-        // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
-        Size min_scans_to_consider(5);
+              ++down_hitting_peak;
+              conseq_missed_peak_down = 0;
+            }
+            else
+            {
+              ++conseq_missed_peak_down;
+            }
 
-        // double outlier_ratio(0.3);
+          }
+          --trace_down_idx;
+          ++down_scan_counter;
 
-        // double ftl_mean(centroid_mz);
-        double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
-        double intensity_so_far(apex_peak.getIntensity());
+          // trace termination criterion: max allowed number of
+          // consecutive outliers reached OR cancel extension if
+          // sampling_rate falls below min_sample_rate_
+          if (trace_termination_criterion_ == "outlier")
+          {
+            if (conseq_missed_peak_down > max_consecutive_missing)
+            {
+              toggle_down = false;
+            }
+          }
+          else if (trace_termination_criterion_ == "sample_rate")
+          {
+            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
+                                  (double)(down_scan_counter + up_scan_counter + 1);
+            if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+            {
+              // std::cout << "stopping down..." << std::endl;
+              toggle_down = false;
+            }
+          }
+        }
 
-        while (((trace_down_idx > 0) && toggle_down) ||
-               ((trace_up_idx < work_exp.size() - 1) && toggle_up)
-                )
+        // *********************************************************** //
+        // Step 2.2 MOVE UP in RT dim
+        // *********************************************************** //
+        if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
         {
-          // *********************************************************** //
-          // Step 2.1 MOVE DOWN in RT dim
-          // *********************************************************** //
-          if ((trace_down_idx > 0) && toggle_down)
+          const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
+          if (!spec_trace_up.empty())
           {
-            const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
-            if (!spec_trace_down.empty())
-            {
-              Size next_down_peak_idx = spec_trace_down.findNearest(centroid_mz);
-              double next_down_peak_mz = spec_trace_down[next_down_peak_idx].getMZ();
-              double next_down_peak_int = spec_trace_down[next_down_peak_idx].getIntensity();
+            Size next_up_peak_idx = spec_trace_up.findNearest(centroid_mz);
+            double next_up_peak_mz = spec_trace_up[next_up_peak_idx].getMZ();
+            double next_up_peak_int = spec_trace_up[next_up_peak_idx].getIntensity();
+
+            double right_bound = centroid_mz + 3 * ftl_sd;
+            double left_bound = centroid_mz - 3 * ftl_sd;
 
-              double right_bound = centroid_mz + 3 * ftl_sd;
-              double left_bound = centroid_mz - 3 * ftl_sd;
+            if ((next_up_peak_mz <= right_bound) &&
+                (next_up_peak_mz >= left_bound) &&
+                isFree(spec_offsets[trace_up_idx + 1] + next_up_peak_idx))
+            {
+              Peak2D next_peak;
+              next_peak.setRT(spec_trace_up.getRT());
+              next_peak.setMZ(next_up_peak_mz);
+              next_peak.setIntensity(next_up_peak_int);
 
-              if ((next_down_peak_mz <= right_bound) &&
-                  (next_down_peak_mz >= left_bound) &&
-                  !peak_visited[spec_offsets[trace_down_idx - 1] + next_down_peak_idx]
-                      )
+              trace.peaks.push_back(next_peak);
+              if (fwhm_meta_idx != -1)
               {
-                Peak2D next_peak;
-                next_peak.setRT(spec_trace_down.getRT());
-                next_peak.setMZ(next_down_peak_mz);
-                next_peak.setIntensity(next_down_peak_int);
-
-                current_trace.push_front(next_peak);
-                // FWHM average
-                if (fwhm_meta_idx != -1)
-                {
-                  fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
-                }
-                // Update the m/z mean of the current trace as we added a new peak
-                updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
-                gathered_idx.emplace_back(trace_down_idx - 1, next_down_peak_idx);
+                trace.fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
+              }
+              // Update the m/z mean of the current trace as we added a new peak
+              updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
+              trace.gathered.push_back(spec_offsets[trace_up_idx + 1] + next_up_peak_idx);
 
-                // Update the m/z variance dynamically
-                if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+              // Update the m/z variance dynamically
+              if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
+              {
+                // if (ftl_t > min_fwhm_scans)
                 {
-                  // if (ftl_t > min_fwhm_scans)
-                  {
-                    updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                  }
+                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
                 }
-
-                ++down_hitting_peak;
-                conseq_missed_peak_down = 0;
-              }
-              else
-              {
-                ++conseq_missed_peak_down;
               }
 
-            }
-            --trace_down_idx;
-            ++down_scan_counter;
+              ++up_hitting_peak;
+              conseq_missed_peak_up = 0;
 
-            // trace termination criterion: max allowed number of
-            // consecutive outliers reached OR cancel extension if
-            // sampling_rate falls below min_sample_rate_
-            if (trace_termination_criterion_ == "outlier")
-            {
-              if (conseq_missed_peak_down > max_consecutive_missing)
-              {
-                toggle_down = false;
-              }
             }
-            else if (trace_termination_criterion_ == "sample_rate")
+            else
             {
-              current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
-                                    (double)(down_scan_counter + up_scan_counter + 1);
-              if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-              {
-                // std::cout << "stopping down..." << std::endl;
-                toggle_down = false;
-              }
+              ++conseq_missed_peak_up;
             }
+
           }
 
-          // *********************************************************** //
-          // Step 2.2 MOVE UP in RT dim
-          // *********************************************************** //
-          if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+          ++trace_up_idx;
+          ++up_scan_counter;
+
+          if (trace_termination_criterion_ == "outlier")
           {
-            const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
-            if (!spec_trace_up.empty())
+            if (conseq_missed_peak_up > max_consecutive_missing)
             {
-              Size next_up_peak_idx = spec_trace_up.findNearest(centroid_mz);
-              double next_up_peak_mz = spec_trace_up[next_up_peak_idx].getMZ();
-              double next_up_peak_int = spec_trace_up[next_up_peak_idx].getIntensity();
+              toggle_up = false;
+            }
+          }
+          else if (trace_termination_criterion_ == "sample_rate")
+          {
+            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
 
-              double right_bound = centroid_mz + 3 * ftl_sd;
-              double left_bound = centroid_mz - 3 * ftl_sd;
+            if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+            {
+              // std::cout << "stopping up" << std::endl;
+              toggle_up = false;
+            }
+          }
 
-              if ((next_up_peak_mz <= right_bound) &&
-                  (next_up_peak_mz >= left_bound) &&
-                  !peak_visited[spec_offsets[trace_up_idx + 1] + next_up_peak_idx])
-              {
-                Peak2D next_peak;
-                next_peak.setRT(spec_trace_up.getRT());
-                next_peak.setMZ(next_up_peak_mz);
-                next_peak.setIntensity(next_up_peak_int);
 
-                current_trace.push_back(next_peak);
-                if (fwhm_meta_idx != -1)
-                {
-                  fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
-                }
-                // Update the m/z mean of the current trace as we added a new peak
-                updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
-                gathered_idx.emplace_back(trace_up_idx + 1, next_up_peak_idx);
+        }
 
-                // Update the m/z variance dynamically
-                if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
-                {
-                  // if (ftl_t > min_fwhm_scans)
-                  {
-                    updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                  }
-                }
+      }
 
-                ++up_hitting_peak;
-                conseq_missed_peak_up = 0;
+      // std::cout << "current sr: " << current_sample_rate << std::endl;
+      double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
 
-              }
-              else
-              {
-                ++conseq_missed_peak_up;
-              }
+      double mt_quality((double)(trace.down_.size() + trace.peaks.size()) / (double)num_scans);
+      // std::cout << "mt quality: " << mt_quality << std::endl;
+      const PeakType& first_peak = trace.down_.empty() ? trace.peaks.front() : trace.down_.back();
+      double rt_range(std::fabs(trace.peaks.back().getRT() - first_peak.getRT()));
 
-            }
+      // *********************************************************** //
+      // Step 2.3 check if minimum length and quality of mass trace criteria are met
+      // *********************************************************** //
+      bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
+      trace.accepted = (rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_);
+      if (trace.accepted)
+      {
+        trace.peaks.insert(trace.peaks.begin(), trace.down_.rbegin(), trace.down_.rend());
+      }
+      trace.down_.clear();
+    }
+
+    void MassTraceDetection::run_(const std::vector<Apex>& chrom_apices,
+                                  const Size total_peak_count,
+                                  const PeakMap& work_exp,
+                                  const std::vector<Size>& spec_offsets,
+                                  std::vector<MassTrace>& found_masstraces,
+                                  const Size max_traces)
+    {
+      boost::dynamic_bitset<> peak_visited(total_peak_count);
+      Size trace_number(1);
 
-            ++trace_up_idx;
-            ++up_scan_counter;
+      // check presence of FWHM meta data
+      int fwhm_meta_idx(-1);
+      Size fwhm_meta_count(0);
+      for (Size i = 0; i < work_exp.size(); ++i)
+      {
+        if (!work_exp[i].getFloatDataArrays().empty() &&
+            work_exp[i].getFloatDataArrays()[0].getName() == "FWHM_ppm")
+        {
+          if (work_exp[i].getFloatDataArrays()[0].size() != work_exp[i].size())
+          { // float data should always have the same size as the corresponding array
+            throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, work_exp[i].size());
+          }
+          fwhm_meta_idx = 0;
+          ++fwhm_meta_count;
+        }
+      }
+      if (fwhm_meta_count > 0 && fwhm_meta_count != work_exp.size())
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                      String("FWHM meta arrays are expected to be missing or present for all MS spectra [") + fwhm_meta_count + "/" + work_exp.size() + "].");
+      }
 
-            if (trace_termination_criterion_ == "outlier")
+      // number of m/z strips for the speculative parallel extension (1: plain serial extension)
+      Size strip_count(mz_strips_);
+      if (strip_count == 0)
+      {
+#ifdef _OPENMP
+        strip_count = omp_get_max_threads() > 1 ? 4 * (Size)omp_get_max_threads() : 1;
+#else
+        strip_count = 1;
+#endif
+      }
+      strip_count = std::max(Size(1), std::min(strip_count, chrom_apices.size()));
+
+      // *********************************************************** //
+      // Speculative extension: every strip extends its own apices (in order of
+      // decreasing intensity) against a strip-local visited state
+      // *********************************************************** //
+      const Size no_candidate(std::numeric_limits<Size>::max());
+      std::vector<Size> candidate_slot; // per apex: index into strip_candidates of its strip
+      std::vector<Size> apex_strip;
+      std::vector<std::vector<TraceCandidate> > strip_candidates;
+      if (strip_count > 1)
+      {
+        // strip borders at the m/z quantiles of the apices, so that every strip owns a similar number of apices
+        std::vector<double> apex_mzs;
+        apex_mzs.reserve(chrom_apices.size());
+        for (const Apex& a : chrom_apices)
+        {
+          apex_mzs.push_back(work_exp[a.scan_idx][a.peak_idx].getMZ());
+        }
+        std::vector<double> sorted_mzs(apex_mzs);
+        std::sort(sorted_mzs.begin(), sorted_mzs.end());
+        std::vector<double> strip_borders;
+        for (Size s = 1; s < strip_count; ++s)
+        {
+          strip_borders.push_back(sorted_mzs[s * sorted_mzs.size() / strip_count]);
+        }
+
+        // apices of each strip in processing order (i.e. decreasing intensity)
+        std::vector<std::vector<Size> > strip_apices(strip_count);
+        apex_strip.resize(chrom_apices.size());
+        for (Size i = chrom_apices.size(); i > 0; --i)
+        {
+          Size strip = std::upper_bound(strip_borders.begin(), strip_borders.end(), apex_mzs[i - 1]) - strip_borders.begin();
+          apex_strip[i - 1] = strip;
+          strip_apices[strip].push_back(i - 1);
+        }
+
+        candidate_slot.assign(chrom_apices.size(), no_candidate);
+        strip_candidates.resize(strip_count);
+
+#pragma omp parallel
+        {
+          boost::dynamic_bitset<> strip_visited(total_peak_count);
+          TraceCandidate scratch;
+
+#pragma omp for schedule(dynamic, 1)
+          for (SignedSize s = 0; s < (SignedSize)strip_count; ++s)
+          {
+            std::vector<TraceCandidate>& candidates = strip_candidates[s];
+            for (Size apex_idx : strip_apices[s])
             {
-              if (conseq_missed_peak_up > max_consecutive_missing)
+              const Apex& apex = chrom_apices[apex_idx];
+              if (strip_visited[spec_offsets[apex.scan_idx] + apex.peak_idx])
               {
-                toggle_up = false;
+                continue;
+              }
+              extendTrace_(apex, work_exp, spec_offsets, fwhm_meta_idx, strip_visited, true, scratch);
+              if (scratch.accepted)
+              {
+                for (Size idx : scratch.gathered)
+                {
+                  strip_visited[idx] = true;
+                }
+              }
+              else
+              { // only the tests are needed to validate a rejected trace
+                scratch.peaks.clear();
+                scratch.fwhms_mz.clear();
+                scratch.gathered.clear();
               }
+              candidate_slot[apex_idx] = candidates.size();
+              candidates.push_back(scratch);
             }
-            else if (trace_termination_criterion_ == "sample_rate")
+            // reset the visited state for the next strip of this thread
+            for (const TraceCandidate& c : candidates)
             {
-              current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
-
-              if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+              for (Size idx : c.gathered)
               {
-                // std::cout << "stopping up" << std::endl;
-                toggle_up = false;
+                strip_visited[idx] = false;
               }
             }
-
-
           }
-
         }
+      }
 
-        // std::cout << "current sr: " << current_sample_rate << std::endl;
-        double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
+      // *********************************************************** //
+      // Collect mass traces in order of decreasing apex intensity. With m/z strips,
+      // a speculative trace is taken over only if all peaks it tested still have
+      // the visited state it saw; otherwise it is extended again.
+      // *********************************************************** //
+      this->startProgress(0, total_peak_count, "mass trace detection");
+      Size peaks_detected(0);
+      TraceCandidate serial_trace;
 
-        double mt_quality((double)current_trace.size() / (double)num_scans);
-        // std::cout << "mt quality: " << mt_quality << std::endl;
-        double rt_range(std::fabs(current_trace.rbegin()->getRT() - current_trace.begin()->getRT()));
+      for (Size i = chrom_apices.size(); i > 0; --i)
+      {
+        const Apex& apex = chrom_apices[i - 1];
 
-        // *********************************************************** //
-        // Step 2.3 check if minimum length and quality of mass trace criteria are met
-        // *********************************************************** //
-        bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
-        if (rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_)
+        if (peak_visited[spec_offsets[apex.scan_idx] + apex.peak_idx])
         {
-          // std::cout << "T" << trace_number << "\t" << mt_quality << std::endl;
+          continue;
+        }
 
+        const TraceCandidate* trace = nullptr;
+        if (strip_count > 1 && candidate_slot[i - 1] != no_candidate)
+        {
+          const TraceCandidate& candidate = strip_candidates[apex_strip[i - 1]][candidate_slot[i - 1]];
+          bool valid = std::none_of(candidate.seen_free.begin(), candidate.seen_free.end(),
+                                    [&peak_visited](Size idx) { return peak_visited[idx]; }) &&
+                       std::all_of(candidate.seen_visited.begin(), candidate.seen_visited.end(),
+                                   [&peak_visited](Size idx) { return peak_visited[idx]; });
+          if (valid)
+          {
+            trace = &candidate;
+          }
+        }
+        if (trace == nullptr)
+        {
+          extendTrace_(apex, work_exp, spec_offsets, fwhm_meta_idx, peak_visited, false, serial_trace);
+          trace = &serial_trace;
+        }
+
+        if (trace->accepted)
+        {
           // mark all peaks as visited
-          for (Size i = 0; i < gathered_idx.size(); ++i)
+          for (Size idx : trace->gathered)
           {
-            peak_visited[spec_offsets[gathered_idx[i].first] +  gathered_idx[i].second] = true;
+            peak_visited[idx] = true;
           }
 
-          // create new MassTrace object and store collected peaks from list current_trace
-          MassTrace new_trace(current_trace);
+          // create new MassTrace object and store collected peaks
+          MassTrace new_trace(trace->peaks);
           new_trace.updateWeightedMeanRT();
           new_trace.updateWeightedMeanMZ();
-          if (!fwhms_mz.empty())
+          if (!trace->fwhms_mz.empty())
           {
+            std::vector<double> fwhms_mz(trace->fwhms_mz);
             new_trace.fwhm_mz_avg = Math::median(fwhms_mz.begin(), fwhms_mz.end());
           }
           new_trace.setQuantMethod(quant_method_);
@@ -583,6 +745,7 @@ namespace OpenMS
       min_trace_length_ = (double)param_.getValue("min_trace_length");
       max_trace_length_ = (double)param_.getValue("max_trace_length");
       reestimate_mt_sd_ = param_.getValue("reestimate_mt_sd").toBool();
+      mz_strips_ = (Size)param_.getValue("mz_strips");
     }
 
 }
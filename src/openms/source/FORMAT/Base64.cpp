@@ -37,92 +37,345 @@
 #include <QtCore/QList>
 #include <QtCore/QString>
 
+#include <array>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OPENMS_BASE64_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace OpenMS
 {
 
-  /*
-
-   Background in the following two encoding / decoding mapping arrays.
-
-   While encoding we have to map a binary value to its character value using
-   the base 64 mapping:
-
-    binary  ->    char = val
-
-       0    ->     A   = 65  
-                   ...     
-      25    ->     Z   = 90  
-      26    ->     a   = 97  
-                   ...     
-      51    ->     z   = 122 
-      52    ->     0   = 48  
-                   ...     
-      61    ->     9   = 57  
-      62    ->     +   = 43  
-      63    ->     /   = 47  
-      
-   
-   While decoding we have to map a character to its base 64 target using the
-   base 64 mapping:
-
-    char = val      ->      target 
-   
-     A   = 65       ->        0
-     ...     
-     Z   = 90       ->       25
-     a   = 97       ->       26
-     ...     
-     z   = 122      ->       51
-     0   = 48       ->       52
-     ...     
-     9   = 57       ->       61
-     +   = 43       ->       62
-     /   = 47       ->       63
-
-
-  this can be done by first subtracting 43 from each value
-  and then looking up a value in a table as found in the code,
-  e.g. lookup[char - 43] - 62
-
-  The following string can be produced by this Python snippet:
-
-offset = 62
-s = ""
-s += chr(62 + offset)
-s += '$' * 3
-s += "".join([ chr(52 + i + offset) for i in range(10) ])
-s += '$' * 7
-s += "".join([ chr(i + offset) for i in range(26) ])
-s += '$' * 6
-s += "".join([ chr(26 + i + offset) for i in range(26) ])
-print s
-
-"|$$$rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\]^_`abcdefghijklmnopq"
-
-  however, this is basically just convenience to produce printable characters.
-  We could also go for a direct mapping:
-
-s = '$' * 42
-s += hex(62)
-s += '$' * 3
-s += "".join([ hex(52 + i) for i in range(10) ])
-s += '$' * 7
-s += "".join([ hex(i) for i in range(26) ])
-s += '$' * 6
-s += "".join([ hex(26 + i) for i in range(26) ])
-print s
-
-"$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$0x3e$$$0x340x350x360x370x380x390x3a0x3b0x3c0x3d$$$$$$$0x00x10x20x30x40x50x60x70x80x90xa0xb0xc0xd0xe0xf0x100x110x120x130x140x150x160x170x180x19$$$$$$0x1a0x1b0x1c0x1d0x1e0x1f0x200x210x220x230x240x250x260x270x280x290x2a0x2b0x2c0x2d0x2e0x2f0x300x310x320x33"
-
-  which would allow lookup[char] without any adding or subtraction step (but
-  needs a 42 byte extra memory in the local cache).
-
-  */
-
-  const char Base64::encoder_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-  const char Base64::decoder_[] = "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+  namespace
+  {
+    const char Base64Alphabet_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    /// Lookup table mapping characters to their 6 bit value (0x80 marks characters outside of the Base64 alphabet)
+    const unsigned char* decodeTable_()
+    {
+      static const std::array<unsigned char, 256> table = []()
+      {
+        std::array<unsigned char, 256> t;
+        t.fill(0x80);
+        for (unsigned char i = 0; i < 64; ++i)
+        {
+          t[static_cast<unsigned char>(Base64Alphabet_[i])] = i;
+        }
+        return t;
+      }();
+      return table.data();
+    }
+
+    /// Scalar decoder, skips characters outside of the Base64 alphabet (whitespace, padding)
+    Size decodeScalar_(const char* in, Size in_size, Byte* out, Size out_size)
+    {
+      const unsigned char* table = decodeTable_();
+      Size i = 0;
+      Size o = 0;
+      UInt32 bits = 0;
+      int nr_bits = 0;
+      while (i < in_size && o < out_size)
+      {
+        if (nr_bits == 0)
+        {
+          // aligned to a group of four characters: decode whole groups as long as they are valid
+          while (i + 4 <= in_size && o + 3 <= out_size)
+          {
+            const UInt32 a = table[static_cast<unsigned char>(in[i])];
+            const UInt32 b = table[static_cast<unsigned char>(in[i + 1])];
+            const UInt32 c = table[static_cast<unsigned char>(in[i + 2])];
+            const UInt32 d = table[static_cast<unsigned char>(in[i + 3])];
+            if ((a | b | c | d) & 0x80)
+            {
+              break;
+            }
+            const UInt32 v = (a << 18) | (b << 12) | (c << 6) | d;
+            out[o] = static_cast<Byte>(v >> 16);
+            out[o + 1] = static_cast<Byte>(v >> 8);
+            out[o + 2] = static_cast<Byte>(v);
+            i += 4;
+            o += 3;
+          }
+          if (i >= in_size || o >= out_size)
+          {
+            break;
+          }
+        }
+        // single character step
+        const UInt32 v = table[static_cast<unsigned char>(in[i++])];
+        if (v & 0x80)
+        {
+          continue;
+        }
+        bits = ((bits << 6) | v) & 0xFFFFFF;
+        nr_bits += 6;
+        if (nr_bits >= 8)
+        {
+          nr_bits -= 8;
+          out[o++] = static_cast<Byte>(bits >> nr_bits);
+        }
+      }
+      return o;
+    }
+
+    /// Scalar encoder, writes 4 * ceil(in_size / 3) characters (including padding)
+    void encodeScalar_(const Byte* in, Size in_size, char* out)
+    {
+      Size i = 0;
+      for (; i + 3 <= in_size; i += 3)
+      {
+        const UInt32 v = (UInt32(in[i]) << 16) | (UInt32(in[i + 1]) << 8) | UInt32(in[i + 2]);
+        out[0] = Base64Alphabet_[(v >> 18) & 0x3F];
+        out[1] = Base64Alphabet_[(v >> 12) & 0x3F];
+        out[2] = Base64Alphabet_[(v >> 6) & 0x3F];
+        out[3] = Base64Alphabet_[v & 0x3F];
+        out += 4;
+      }
+      if (i < in_size)
+      {
+        const bool two = (i + 1 < in_size);
+        const UInt32 v = (UInt32(in[i]) << 16) | (two ? (UInt32(in[i + 1]) << 8) : 0);
+        out[0] = Base64Alphabet_[(v >> 18) & 0x3F];
+        out[1] = Base64Alphabet_[(v >> 12) & 0x3F];
+        out[2] = two ? Base64Alphabet_[(v >> 6) & 0x3F] : '=';
+        out[3] = '=';
+      }
+    }
+
+#ifdef OPENMS_BASE64_X86_DISPATCH
+    /*
+      Vectorized kernels following W. Mula and D. Lemire, "Faster Base64
+      Encoding and Decoding Using AVX2 Instructions" (ACM TOW 2018). Each
+      kernel processes as many whole blocks as possible and returns the
+      number of consumed input elements; the caller finishes with the scalar
+      code. Decoding stops at the first block containing a character outside
+      of the alphabet (e.g. whitespace or padding).
+    */
+
+    __attribute__((target("ssse3")))
+    inline __m128i decodeTranslate128_(const __m128i input, __m128i& invalid)
+    {
+      const __m128i higher_nibble = _mm_and_si128(_mm_srli_epi32(input, 4), _mm_set1_epi8(0x0f));
+      const __m128i lower_bound_lut = _mm_setr_epi8(1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1);
+      const __m128i upper_bound_lut = _mm_setr_epi8(0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m128i shift_lut = _mm_setr_epi8(0, 0, 0x3e - 0x2b, 0x34 - 0x30, 0x00 - 0x41, 0x0f - 0x50, 0x1a - 0x61, 0x29 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0);
+
+      const __m128i upper_bound = _mm_shuffle_epi8(upper_bound_lut, higher_nibble);
+      const __m128i lower_bound = _mm_shuffle_epi8(lower_bound_lut, higher_nibble);
+      const __m128i below = _mm_cmplt_epi8(input, lower_bound);
+      const __m128i above = _mm_cmpgt_epi8(input, upper_bound);
+      const __m128i eq_2f = _mm_cmpeq_epi8(input, _mm_set1_epi8(0x2f));
+      invalid = _mm_andnot_si128(eq_2f, _mm_or_si128(above, below));
+
+      const __m128i shift = _mm_shuffle_epi8(shift_lut, higher_nibble);
+      const __m128i t0 = _mm_add_epi8(input, shift);
+      return _mm_add_epi8(t0, _mm_and_si128(eq_2f, _mm_set1_epi8(-3)));
+    }
+
+    __attribute__((target("ssse3")))
+    inline __m128i decodePack128_(const __m128i values)
+    {
+      const __m128i merge_ab_bc = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+      const __m128i merged = _mm_madd_epi16(merge_ab_bc, _mm_set1_epi32(0x00011000));
+      return _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    }
+
+    __attribute__((target("ssse3")))
+    void decodeSSSE3_(const char* in, Size in_size, Byte* out, Size out_size, Size& i, Size& o)
+    {
+      // each block reads 16 characters and stores 16 bytes (of which 12 are valid)
+      while (i + 16 <= in_size && o + 16 <= out_size)
+      {
+        __m128i invalid;
+        const __m128i values = decodeTranslate128_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), invalid);
+        if (_mm_movemask_epi8(invalid) != 0)
+        {
+          break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), decodePack128_(values));
+        i += 16;
+        o += 12;
+      }
+    }
+
+    __attribute__((target("avx2")))
+    void decodeAVX2_(const char* in, Size in_size, Byte* out, Size out_size, Size& i, Size& o)
+    {
+      const __m256i lower_bound_lut = _mm256_setr_epi8(1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1,
+                                                       1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1);
+      const __m256i upper_bound_lut = _mm256_setr_epi8(0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                       0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m256i shift_lut = _mm256_setr_epi8(0, 0, 0x3e - 0x2b, 0x34 - 0x30, 0x00 - 0x41, 0x0f - 0x50, 0x1a - 0x61, 0x29 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                 0, 0, 0x3e - 0x2b, 0x34 - 0x30, 0x00 - 0x41, 0x0f - 0x50, 0x1a - 0x61, 0x29 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m256i pack_shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+      // each block reads 32 characters and stores 28 bytes (of which 24 are valid)
+      while (i + 32 <= in_size && o + 28 <= out_size)
+      {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i higher_nibble = _mm256_and_si256(_mm256_srli_epi32(input, 4), _mm256_set1_epi8(0x0f));
+        const __m256i upper_bound = _mm256_shuffle_epi8(upper_bound_lut, higher_nibble);
+        const __m256i lower_bound = _mm256_shuffle_epi8(lower_bound_lut, higher_nibble);
+        const __m256i below = _mm256_cmpgt_epi8(lower_bound, input);
+        const __m256i above = _mm256_cmpgt_epi8(input, upper_bound);
+        const __m256i eq_2f = _mm256_cmpeq_epi8(input, _mm256_set1_epi8(0x2f));
+        const __m256i invalid = _mm256_andnot_si256(eq_2f, _mm256_or_si256(above, below));
+        if (_mm256_movemask_epi8(invalid) != 0)
+        {
+          break;
+        }
+        const __m256i shift = _mm256_shuffle_epi8(shift_lut, higher_nibble);
+        const __m256i values = _mm256_add_epi8(_mm256_add_epi8(input, shift), _mm256_and_si256(eq_2f, _mm256_set1_epi8(-3)));
+
+        const __m256i merge_ab_bc = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const __m256i merged = _mm256_madd_epi16(merge_ab_bc, _mm256_set1_epi32(0x00011000));
+        const __m256i packed = _mm256_shuffle_epi8(merged, pack_shuffle);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm256_castsi256_si128(packed));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o + 12), _mm256_extracti128_si256(packed, 1));
+        i += 32;
+        o += 24;
+      }
+      decodeSSSE3_(in, in_size, out, out_size, i, o);
+    }
+
+    __attribute__((target("ssse3")))
+    inline __m128i encodeBlock128_(const __m128i input)
+    {
+      // distribute 3 input bytes over 4 output bytes, then extract the 6 bit values
+      const __m128i in = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+      const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+      const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+      const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+      const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+      const __m128i indices = _mm_or_si128(t1, t3);
+
+      // map the 6 bit values to ASCII
+      const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+      result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+      result = _mm_shuffle_epi8(shift_lut, result);
+      return _mm_add_epi8(result, indices);
+    }
+
+    __attribute__((target("ssse3")))
+    void encodeSSSE3_(const Byte* in, Size in_size, char* out, Size& i, Size& o)
+    {
+      // each block reads 16 bytes (of which 12 are used) and writes 16 characters
+      while (i + 16 <= in_size)
+      {
+        const __m128i chars = encodeBlock128_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), chars);
+        i += 12;
+        o += 16;
+      }
+    }
+
+    __attribute__((target("avx2")))
+    void encodeAVX2_(const Byte* in, Size in_size, char* out, Size& i, Size& o)
+    {
+      const __m256i reshuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+      const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      // each block reads 28 bytes (of which 24 are used) and writes 32 characters
+      while (i + 28 <= in_size)
+      {
+        const __m256i input = _mm256_inserti128_si256(
+          _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+        const __m256i shuffled = _mm256_shuffle_epi8(input, reshuffle);
+        const __m256i t0 = _mm256_and_si256(shuffled, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(shuffled, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_shuffle_epi8(shift_lut, result);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), _mm256_add_epi8(result, indices));
+        i += 24;
+        o += 32;
+      }
+      encodeSSSE3_(in, in_size, out, i, o);
+    }
+
+    enum class SIMDLevel_
+    {
+      NONE,
+      SSSE3,
+      AVX2
+    };
+
+    /// Instruction set supported by the CPU we are running on (detected once)
+    SIMDLevel_ simdLevel_()
+    {
+      static const SIMDLevel_ level = []()
+      {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+          return SIMDLevel_::AVX2;
+        }
+        if (__builtin_cpu_supports("ssse3"))
+        {
+          return SIMDLevel_::SSSE3;
+        }
+        return SIMDLevel_::NONE;
+      }();
+      return level;
+    }
+#endif
+  }
+
+  Size Base64::decodeBytes_(const char* in, Size in_size, Byte* out, Size out_size)
+  {
+    Size i = 0;
+    Size o = 0;
+#ifdef OPENMS_BASE64_X86_DISPATCH
+    switch (simdLevel_())
+    {
+      case SIMDLevel_::AVX2:
+        decodeAVX2_(in, in_size, out, out_size, i, o);
+        break;
+      case SIMDLevel_::SSSE3:
+        decodeSSSE3_(in, in_size, out, out_size, i, o);
+        break;
+      case SIMDLevel_::NONE:
+        break;
+    }
+#endif
+    return o + decodeScalar_(in + i, in_size - i, out + o, out_size - o);
+  }
+
+  void Base64::encodeBytes_(const Byte* in, Size in_size, char* out)
+  {
+    Size i = 0;
+    Size o = 0;
+#ifdef OPENMS_BASE64_X86_DISPATCH
+    switch (simdLevel_())
+    {
+      case SIMDLevel_::AVX2:
+        encodeAVX2_(in, in_size, out, i, o);
+        break;
+      case SIMDLevel_::SSSE3:
+        encodeSSSE3_(in, in_size, out, i, o);
+        break;
+      case SIMDLevel_::NONE:
+        break;
+    }
+#endif
+    encodeScalar_(in + i, in_size - i, out + o);
+  }
 
   void Base64::encodeStrings(const std::vector<String>& in, String& out, bool zlib_compression, bool append_null_byte)
   {
@@ -183,48 +436,7 @@ print s
       it = reinterpret_cast<Byte*>(&str[0]);
       end = it + str.size();
     }
-    Byte* to = reinterpret_cast<Byte*>(&out[0]);
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-      {
-        to[3] = '=';
-      }
-      if (padding_count > 1)
-      {
-        to[2] = '=';
-      }
-      to += 4;
-      written += 4;
-    }
-
-    out.resize(written); //no more space is needed
+    encodeBytes_(it, end - it, &out[0]);
   }
 
   void Base64::decodeStrings(const String& in, std::vector<String>& out, bool zlib_compression)
@@ -259,8 +471,8 @@ print s
       return;
     }
 
-    QByteArray herewego = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    base64_uncompressed = QByteArray::fromBase64(herewego);
+    base64_uncompressed.resize((int) (in.size() / 4 * 3 + 3));
+    base64_uncompressed.resize((int) decodeBytes_(in.c_str(), in.size(), reinterpret_cast<Byte*>(base64_uncompressed.data()), base64_uncompressed.size()));
     if (zlib_compression)
     {
       QByteArray czip;
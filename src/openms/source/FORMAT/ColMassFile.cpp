@@ -0,0 +1,81 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/ColMassFile.h>
+
+#include <OpenMS/FORMAT/HANDLERS/ColMassHandler.h>
+
+namespace OpenMS
+{
+
+  ColMassFile::ColMassFile() = default;
+
+  ColMassFile::~ColMassFile() = default;
+
+  void ColMassFile::load(const String& filename, MapType& map) const
+  {
+    Internal::ColMassHandler handler;
+    handler.setLogType(getLogType());
+    handler.open(filename);
+    handler.readExperiment(map);
+    map.setLoadedFilePath(filename);
+    map.setLoadedFileType(filename);
+  }
+
+  void ColMassFile::loadArea(const String& filename, double min_rt, double max_rt, double min_mz, double max_mz, UInt ms_level, MapType& map) const
+  {
+    Internal::ColMassHandler handler;
+    handler.open(filename);
+    handler.getArea(min_rt, max_rt, min_mz, max_mz, ms_level, map);
+  }
+
+  void ColMassFile::store(const String& filename, const MapType& map) const
+  {
+    Internal::ColMassHandler handler;
+    handler.setLogType(getLogType());
+    handler.setConfig(config_.peaks_per_chunk, config_.spectra_per_block, config_.compression_level);
+    handler.writeExperiment(filename, map);
+  }
+
+  void ColMassFile::setConfig(const ColMassConfig& config)
+  {
+    config_ = config;
+  }
+
+  const ColMassFile::ColMassConfig& ColMassFile::getConfig() const
+  {
+    return config_;
+  }
+
+}
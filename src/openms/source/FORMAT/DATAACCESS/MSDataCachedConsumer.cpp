@@ -47,8 +47,7 @@ namespace OpenMS
     spectra_written_(0),
     chromatograms_written_(0)
   {
-    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
-    ofs_.write((char*)&file_identifier, sizeof(file_identifier));
+    writeHeader(ofs_);
   }
 
   MSDataCachedConsumer::~MSDataCachedConsumer()
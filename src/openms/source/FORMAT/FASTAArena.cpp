@@ -0,0 +1,267 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/FASTAArena.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    /**
+      @brief Parses the record [@p begin, @p end) (starting with '>') into @p out
+
+      Follows the rules of FASTAFile::readEntry_(). @p end is either the
+      start of the next record (i.e. follows a newline) or the end of the
+      file. @p bounds receives the offsets (relative to @p out_start) of the
+      identifier, description and sequence and the end of the sequence.
+
+      @return false if the record is invalid
+    */
+    bool parseRecord_(const char* begin, const char* end, char* out, UInt64 out_start, UInt64* bounds)
+    {
+      char* w = out;
+      const char* p = begin + 1; // skip '>'
+
+      // identifier (ends at the first whitespace after a non-empty identifier or at the end of the line)
+      bool description_exists = true;
+      bounds[0] = out_start;
+      while (true)
+      {
+        if (p == end)
+        {
+          return false; // end of file within the header
+        }
+        const char c = *p++;
+        if (c == ' ' || c == '\t')
+        {
+          if (w != out)
+          {
+            break;
+          }
+        }
+        else if (c == '\n')
+        {
+          description_exists = false;
+          break;
+        }
+        else if (c != '\r')
+        {
+          *w++ = c;
+        }
+      }
+      if (w == out)
+      {
+        return false; // empty identifier
+      }
+
+      // description (remainder of the header line, without tabs and carriage returns)
+      bounds[1] = out_start + (w - out);
+      while (description_exists)
+      {
+        if (p == end)
+        {
+          return false; // end of file within the header
+        }
+        const char c = *p++;
+        if (c == '\n')
+        {
+          break;
+        }
+        if (c != '\r' && c != '\t')
+        {
+          *w++ = c;
+        }
+      }
+
+      // sequence (all following lines, without whitespace)
+      bounds[2] = out_start + (w - out);
+      for (; p != end; ++p)
+      {
+        const char c = *p;
+        if (c != '\n' && c != '\r' && c != ' ' && c != '\t')
+        {
+          *w++ = c;
+        }
+      }
+      bounds[3] = out_start + (w - out);
+      return bounds[3] != bounds[2];
+    }
+  }
+
+  void FASTAArena::load(const String& filename)
+  {
+    MemoryMappedFile file(filename);
+    file.advise(MemoryMappedFile::AccessPattern::SEQUENTIAL);
+    const char* data = file.data();
+    const Size size = file.size();
+
+    // skip the header of PEFF files (http://www.psidev.info/peff)
+    Size begin = 0;
+    while (begin < size && data[begin] == '#')
+    {
+      const char* eol = static_cast<const char*>(memchr(data + begin, '\n', size - begin));
+      begin = (eol == nullptr) ? size : Size(eol - data) + 1;
+    }
+    if (begin == size || data[begin] != '>')
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+                                  "Error while parsing FASTA file! The first entry could not be read! Please check the file!");
+    }
+
+    // find the record starts ('>' at the beginning of a line) in parallel blocks
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    const Size block_size = max(Size(1) << 20, (size - begin) / (Size(threads) * 8) + 1);
+    const SignedSize n_blocks = SignedSize((size - begin + block_size - 1) / block_size);
+    vector<vector<UInt64> > block_starts(n_blocks);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize b = 0; b < n_blocks; ++b)
+    {
+      const Size from = begin + Size(b) * block_size;
+      const Size to = min(size, from + block_size);
+      // a newline at position q starts a record at q + 1 if followed by '>'; q + 1 must be in [from, to)
+      Size q = (b == 0) ? begin : from - 1;
+      while (q + 1 < to)
+      {
+        const char* eol = static_cast<const char*>(memchr(data + q, '\n', to - 1 - q));
+        if (eol == nullptr)
+        {
+          break;
+        }
+        q = Size(eol - data);
+        if (data[q + 1] == '>')
+        {
+          block_starts[b].push_back(q + 1);
+        }
+        ++q;
+      }
+    }
+    vector<UInt64> starts(1, begin);
+    for (const vector<UInt64>& s : block_starts)
+    {
+      starts.insert(starts.end(), s.begin(), s.end());
+    }
+    block_starts.clear();
+    starts.push_back(size);
+
+    // parse all records in parallel; each record is written to the arena at
+    // its offset in the file (parsing only removes characters)
+    const SignedSize n_records = SignedSize(starts.size() - 1);
+    vector<char> arena(size - begin);
+    vector<UInt64> bounds(4 * n_records);
+    SignedSize first_error = n_records;
+#pragma omp parallel for schedule(dynamic, 1000)
+    for (SignedSize i = 0; i < n_records; ++i)
+    {
+      const UInt64 out_start = starts[i] - begin;
+      if (!parseRecord_(data + starts[i], data + starts[i + 1], arena.data() + out_start, out_start, &bounds[4 * i]))
+      {
+#pragma omp critical (FASTAArena_error)
+        first_error = min(first_error, i);
+      }
+    }
+    if (first_error != n_records)
+    {
+      const String reason = (first_error == 0) ? String("The first entry could not be read!") :
+        "Only " + String(first_error) + " proteins could be read. Parsing next record failed.";
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+                                  "Error while parsing FASTA file! " + reason + " Please check the file!");
+    }
+
+    arena_.swap(arena);
+    bounds_.swap(bounds);
+  }
+
+  Size FASTAArena::size() const
+  {
+    return bounds_.size() / 4;
+  }
+
+  bool FASTAArena::empty() const
+  {
+    return bounds_.empty();
+  }
+
+  StringView FASTAArena::getIdentifier(Size index) const
+  {
+    const UInt64* b = &bounds_[4 * index];
+    return StringView(arena_.data() + b[0], b[1] - b[0]);
+  }
+
+  StringView FASTAArena::getDescription(Size index) const
+  {
+    const UInt64* b = &bounds_[4 * index];
+    return StringView(arena_.data() + b[1], b[2] - b[1]);
+  }
+
+  StringView FASTAArena::getSequence(Size index) const
+  {
+    const UInt64* b = &bounds_[4 * index];
+    return StringView(arena_.data() + b[2], b[3] - b[2]);
+  }
+
+  void FASTAArena::getEntry(Size index, FASTAFile::FASTAEntry& entry) const
+  {
+    const UInt64* b = &bounds_[4 * index];
+    const char* a = arena_.data();
+    entry.identifier.assign(a + b[0], a + b[1]);
+    entry.description.assign(a + b[1], a + b[2]);
+    entry.sequence.assign(a + b[2], a + b[3]);
+  }
+
+  void FASTAArena::getEntries(Size first, Size last, vector<FASTAFile::FASTAEntry>& entries) const
+  {
+    entries.resize(last - first);
+#pragma omp parallel for schedule(dynamic, 1000)
+    for (SignedSize i = 0; i < SignedSize(entries.size()); ++i)
+    {
+      getEntry(first + i, entries[i]);
+    }
+  }
+
+} // namespace OpenMS
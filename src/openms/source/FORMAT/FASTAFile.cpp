@@ -34,6 +34,7 @@
 
 #include <OpenMS/FORMAT/FASTAFile.h>
 
+#include <OpenMS/FORMAT/FASTAArena.h>
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/TextFile.h>
 #include <OpenMS/SYSTEM/File.h>
@@ -229,14 +230,10 @@ namespace OpenMS
   void FASTAFile::load(const String &filename, vector<FASTAEntry> &data) const
   {
     startProgress(0, 1, "Loading FASTA file");
-    data.clear();
-    FASTAEntry p;
-    FASTAFile f;
-    f.readStart(filename);
-    while (f.readNext(p))
-    {
-      data.push_back(std::move(p));
-    }
+    // parse in parallel into a single buffer, then copy out the entries
+    FASTAArena arena;
+    arena.load(filename);
+    arena.getEntries(0, arena.size(), data);
     endProgress();
   }
 
@@ -46,10 +46,14 @@
 #include <OpenMS/FORMAT/MSPFile.h>
 #include <OpenMS/FORMAT/MSPGenericFile.h>
 #include <OpenMS/FORMAT/SqMassFile.h>
+#include <OpenMS/FORMAT/ColMassFile.h>
+#include <OpenMS/FORMAT/HANDLERS/ColMassHandler.h>
 #include <OpenMS/FORMAT/XMassFile.h>
 #include <OpenMS/FORMAT/TraMLFile.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 
+#include <OpenMS/ANALYSIS/OPENSWATH/MappedTransitionLibrary.h>
+
 #include <OpenMS/FORMAT/MsInspectFile.h>
 #include <OpenMS/FORMAT/SpecArrayFile.h>
 #include <OpenMS/FORMAT/KroenikFile.h>
@@ -255,6 +259,14 @@ namespace OpenMS
       complete_file = split;
     }
     //else {} // TODO: ZIP
+    else if (Internal::ColMassHandler::isColMassFile(filename)) // binary, identified by its magic bytes
+    {
+      return FileTypes::COLMASS;
+    }
+    else if (MappedTransitionLibrary::isMappedTransitionLibrary(filename)) // binary, identified by its magic bytes
+    {
+      return FileTypes::TLIB;
+    }
     else // uncompressed
     {
       //load first 5 lines
@@ -783,6 +795,14 @@ if (first_line.hasSubstring("File	First Scan	Last Scan	Num of Scans	Charge	Monoi
       SqMassFile().load(filename, exp);
       break;
 
+    case FileTypes::COLMASS:
+      {
+        ColMassFile f;
+        f.setLogType(log);
+        f.load(filename, exp);
+      }
+      break;
+
     case FileTypes::XMASS:
       exp.reset();
       exp.resize(1);
@@ -887,6 +907,14 @@ if (first_line.hasSubstring("File	First Scan	Last Scan	Num of Scans	Charge	Monoi
     }
     break;
 
+    case FileTypes::COLMASS:
+    {
+      ColMassFile f;
+      f.setLogType(log);
+      f.store(filename, exp);
+    }
+    break;
+
     default:
     {
       MzMLFile f;
@@ -117,6 +117,8 @@ namespace OpenMS
     TypeNameBinding(FileTypes::EXE, "exe", "Windows executable"),
     TypeNameBinding(FileTypes::BZ2, "bz2", "bzip2 compressed file"),
     TypeNameBinding(FileTypes::GZ, "gz", "gzip compressed file"),
+    TypeNameBinding(FileTypes::COLMASS, "colMass", "columnar chunk-compressed format for mass spectra and chromatograms"),
+    TypeNameBinding(FileTypes::TLIB, "tlib", "OpenSWATH binary transition library"),
     TypeNameBinding(FileTypes::XML, "xml", "any XML file")  // make sure this comes last, since the name is a suffix of other formats and should only be matched last
   };
 
@@ -37,9 +37,33 @@
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 
+#include <cstring>
+
 namespace OpenMS::Internal
 {
-  CachedMzMLHandler::CachedMzMLHandler()
+  namespace
+  {
+    /// byte order mark of the versioned header (reads as 0x04030201 if the byte order differs)
+    const UInt32 byte_order_mark = 0x01020304;
+
+    /// alignment of all data arrays in files of version 2 and later
+    const Size data_alignment = 8;
+
+    /// number of bytes to add to @p pos to reach the next aligned position
+    Size alignmentPadding(Size pos)
+    {
+      return (data_alignment - pos % data_alignment) % data_alignment;
+    }
+
+    UInt32 byteSwap(UInt32 value)
+    {
+      return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8) |
+             ((value & 0x00FF0000u) >> 8) | ((value & 0xFF000000u) >> 24);
+    }
+  }
+
+  CachedMzMLHandler::CachedMzMLHandler() :
+    file_version_(CACHED_MZML_FILE_VERSION)
   {
   }
 
@@ -55,6 +79,7 @@ namespace OpenMS::Internal
     }
     spectra_index_ = rhs.spectra_index_;
     chrom_index_ = rhs.chrom_index_;
+    file_version_ = rhs.file_version_;
 
     return *this;
   }
@@ -64,8 +89,7 @@ namespace OpenMS::Internal
     std::ofstream ofs(out.c_str(), std::ios::binary);
     Size exp_size = exp.size();
     Size chrom_size = exp.getChromatograms().size();
-    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
-    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    writeHeader(ofs);
 
     startProgress(0, exp.size() + exp.getChromatograms().size(), "storing binary data");
     for (Size i = 0; i < exp.size(); i++)
@@ -97,20 +121,14 @@ namespace OpenMS::Internal
     Size exp_size, chrom_size;
     Peak1D current_peak;
 
-    int file_identifier;
-    ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
-    {
-      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-        "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
-    }
+    UInt32 version = readHeader(ifs, filename);
 
     ifs.seekg(0, ifs.end); // set file pointer to end
     ifs.seekg(ifs.tellg(), ifs.beg); // set file pointer to end, in forward direction
     ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
     ifs.read((char*)&exp_size, sizeof(exp_size));
     ifs.read((char*)&chrom_size, sizeof(chrom_size));
-    ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
+    ifs.seekg(getHeaderSize(version), ifs.beg); // set file pointer to beginning (after header), start reading
 
     exp_reading.reserve(exp_size);
     startProgress(0, exp_size + chrom_size, "reading binary data");
@@ -118,6 +136,7 @@ namespace OpenMS::Internal
     {
       setProgress(i);
       SpectrumType spectrum;
+      ifs.seekg(getSpectrumPadding(static_cast<Size>(ifs.tellg()), version), ifs.cur);
       readSpectrum(spectrum, ifs);
       exp_reading.addSpectrum(spectrum);
     }
@@ -126,6 +145,7 @@ namespace OpenMS::Internal
     {
       setProgress(i);
       ChromatogramType chromatogram;
+      ifs.seekg(getChromatogramPadding(static_cast<Size>(ifs.tellg()), version), ifs.cur);
       readChromatogram(chromatogram, ifs);
       chromatograms.push_back(chromatogram);
     }
@@ -145,6 +165,91 @@ namespace OpenMS::Internal
     return chrom_index_;
   }
 
+  UInt32 CachedMzMLHandler::getFileVersion() const
+  {
+    return file_version_;
+  }
+
+  UInt32 CachedMzMLHandler::parseHeader(const char* data, Size size, const String& filename)
+  {
+    Int32 file_identifier = 0;
+    if (size >= sizeof(file_identifier))
+    {
+      std::memcpy(&file_identifier, data, sizeof(file_identifier));
+    }
+    if (file_identifier == CACHED_MZML_FILE_IDENTIFIER)
+    {
+      return 1; // legacy file without versioned header
+    }
+    if (static_cast<UInt32>(file_identifier) == byteSwap(CACHED_MZML_FILE_IDENTIFIER_VERSIONED))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached mzML file was written on a machine with a different byte order. Aborting!", filename);
+    }
+    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER_VERSIONED || size < getHeaderSize(CACHED_MZML_FILE_VERSION))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
+    }
+
+    UInt32 version, bom;
+    std::memcpy(&version, data + sizeof(Int32), sizeof(version));
+    std::memcpy(&bom, data + sizeof(Int32) + sizeof(UInt32), sizeof(bom));
+    if (bom != byte_order_mark)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached mzML file was written on a machine with a different byte order. Aborting!", filename);
+    }
+    if (version < 2 || version > CACHED_MZML_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached mzML file has unsupported format version " + String(version) + ". Aborting!", filename);
+    }
+    return version;
+  }
+
+  UInt32 CachedMzMLHandler::readHeader(std::ifstream& ifs, const String& filename)
+  {
+    char header[4 * sizeof(UInt32)] = {0};
+    ifs.seekg(0, ifs.beg);
+    ifs.read(header, sizeof(header));
+    Size header_read = static_cast<Size>(ifs.gcount());
+    ifs.clear(); // files shorter than the header set the eof bit
+
+    UInt32 version = parseHeader(header, header_read, filename);
+    ifs.seekg(getHeaderSize(version), ifs.beg);
+    return version;
+  }
+
+  void CachedMzMLHandler::writeHeader(std::ofstream& ofs)
+  {
+    Int32 file_identifier = CACHED_MZML_FILE_IDENTIFIER_VERSIONED;
+    UInt32 version = CACHED_MZML_FILE_VERSION;
+    UInt32 bom = byte_order_mark;
+    UInt32 reserved = 0;
+    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    ofs.write((char*)&version, sizeof(version));
+    ofs.write((char*)&bom, sizeof(bom));
+    ofs.write((char*)&reserved, sizeof(reserved));
+  }
+
+  Size CachedMzMLHandler::getHeaderSize(UInt32 version)
+  {
+    return version < 2 ? sizeof(Int32) : sizeof(Int32) + 3 * sizeof(UInt32);
+  }
+
+  Size CachedMzMLHandler::getSpectrumPadding(Size pos, UInt32 version)
+  {
+    // the data arrays follow directly after size, number of arrays, MS level and RT
+    return version < 2 ? 0 : alignmentPadding(pos + 2 * sizeof(Size) + sizeof(IntType) + sizeof(DoubleType));
+  }
+
+  Size CachedMzMLHandler::getChromatogramPadding(Size pos, UInt32 version)
+  {
+    // the data arrays follow directly after size and number of arrays
+    return version < 2 ? 0 : alignmentPadding(pos + 2 * sizeof(Size));
+  }
+
   void CachedMzMLHandler::createMemdumpIndex(String filename)
   {
     std::ifstream ifs(filename.c_str(), std::ios::binary);
@@ -156,19 +261,12 @@ namespace OpenMS::Internal
     Size exp_size, chrom_size;
     Peak1D current_peak;
 
-    ifs.seekg(0, ifs.beg); // set file pointer to beginning, start reading
     spectra_index_.clear();
     chrom_index_.clear();
-    int file_identifier;
     int extra_offset = sizeof(DoubleType) + sizeof(IntType);
     int chrom_offset = 0;
 
-    ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
-    {
-      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-          "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
-    }
+    file_version_ = readHeader(ifs, filename);
 
     // For spectra and chromatograms go through file, read the size of the
     // spectrum/chromatogram and record the starting index of the element, then
@@ -179,7 +277,7 @@ namespace OpenMS::Internal
     ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
     ifs.read((char*)&exp_size, sizeof(exp_size));
     ifs.read((char*)&chrom_size, sizeof(chrom_size));
-    ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
+    ifs.seekg(getHeaderSize(file_version_), ifs.beg); // set file pointer to beginning (after header), start reading
 
     startProgress(0, exp_size + chrom_size, "Creating index for binary spectra");
     for (Size i = 0; i < exp_size; i++)
@@ -188,6 +286,7 @@ namespace OpenMS::Internal
 
       Size spec_size;
       Size float_arr;
+      ifs.seekg(getSpectrumPadding(static_cast<Size>(ifs.tellg()), file_version_), ifs.cur);
       spectra_index_.push_back(ifs.tellg());
       ifs.read((char*)&spec_size, sizeof(spec_size));
       ifs.read((char*)&float_arr, sizeof(float_arr));
@@ -210,6 +309,7 @@ namespace OpenMS::Internal
 
       Size ch_size;
       Size float_arr;
+      ifs.seekg(getChromatogramPadding(static_cast<Size>(ifs.tellg()), file_version_), ifs.cur);
       chrom_index_.push_back(ifs.tellg());
       ifs.read((char*)&ch_size, sizeof(ch_size));
       ifs.read((char*)&float_arr, sizeof(float_arr));
@@ -354,7 +454,7 @@ namespace OpenMS::Internal
     {
       return;
     }
-    char* buffer = new(std::nothrow) char[1024];
+    std::string name;
     for (Size k = 0; k < nr_float_arrays; k++)
     {
       data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
@@ -362,22 +462,17 @@ namespace OpenMS::Internal
       ifs.read((char*)&len, sizeof(len));
       ifs.read((char*)&len_name, sizeof(len_name));
 
-      // We will not read data longer than 1024 bytes as this will not fit into
-      // our buffer (and is user-generated input data)
-      if (len_name > 1023)
-      {
-        ifs.seekg(len_name * sizeof(char), ifs.cur);
-      }
-      else
+      // read the complete stored name (including alignment padding) so the
+      // stream stays in sync, the name itself ends at the first zero byte
+      name.resize(len_name);
+      if (len_name > 0)
       {
-        ifs.read(buffer, len_name);
-        buffer[len_name] = '\0';
+        ifs.read(&name[0], len_name);
       }
+      data.back()->description = name.substr(0, name.find('\0'));
       data.back()->data.resize(len);
-      data.back()->description = buffer;
       ifs.read((char*)&(data.back()->data)[0], len * sizeof(DatumSingleton));
     }
-    delete[] buffer;
     return;
   }
 
@@ -455,6 +550,8 @@ namespace OpenMS::Internal
 
   void CachedMzMLHandler::writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs) const
   {
+    writePadding_(getSpectrumPadding(static_cast<Size>(ofs.tellp()), CACHED_MZML_FILE_VERSION), ofs);
+
     Size exp_size = spectrum.size();
     ofs.write((char*)&exp_size, sizeof(exp_size));
     Size arr_s = spectrum.getFloatDataArrays().size() + spectrum.getIntegerDataArrays().size();
@@ -489,9 +586,7 @@ namespace OpenMS::Internal
     {
       Size len = fda.size();
       ofs.write((char*)&len, sizeof(len));
-      Size len_name = fda.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&fda.getName().front(), len_name * sizeof(fda.getName().front()));
+      writeDataArrayName_(fda.getName(), ofs);
       // now go to the actual data
       tmp.clear();
       tmp.reserve(fda.size());
@@ -502,9 +597,7 @@ namespace OpenMS::Internal
     {
       Size len = ida.size();
       ofs.write((char*)&len, sizeof(len));
-      Size len_name = ida.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&ida.getName().front(), len_name * sizeof(ida.getName().front()));
+      writeDataArrayName_(ida.getName(), ofs);
       // now go to the actual data
       tmp.clear();
       tmp.reserve(ida.size());
@@ -515,6 +608,8 @@ namespace OpenMS::Internal
 
   void CachedMzMLHandler::writeChromatogram_(const ChromatogramType& chromatogram, std::ofstream& ofs) const
   {
+    writePadding_(getChromatogramPadding(static_cast<Size>(ofs.tellp()), CACHED_MZML_FILE_VERSION), ofs);
+
     Size exp_size = chromatogram.size();
     ofs.write((char*)&exp_size, sizeof(exp_size));
     Size arr_s = chromatogram.getFloatDataArrays().size() + chromatogram.getIntegerDataArrays().size();
@@ -544,9 +639,7 @@ namespace OpenMS::Internal
     {
       Size len = fda.size();
       ofs.write((char*)&len, sizeof(len));
-      Size len_name = fda.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&fda.getName().front(), len_name * sizeof(fda.getName().front()));
+      writeDataArrayName_(fda.getName(), ofs);
       // now go to the actual data
       tmp.clear();
       tmp.reserve(fda.size());
@@ -560,9 +653,7 @@ namespace OpenMS::Internal
     {
       Size len = ida.size();
       ofs.write((char*)&len, sizeof(len));
-      Size len_name = ida.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&ida.getName().front(), len_name * sizeof(ida.getName().front()));
+      writeDataArrayName_(ida.getName(), ofs);
       // now go to the actual data
       tmp.clear();
       tmp.reserve(ida.size());
@@ -574,5 +665,22 @@ namespace OpenMS::Internal
     }
   }
 
+  void CachedMzMLHandler::writeDataArrayName_(const String& name, std::ofstream& ofs)
+  {
+    // pad the name with zero bytes such that the data array starts aligned:
+    // readers treat the name as zero-terminated and ignore the padding
+    Size padding = alignmentPadding(name.size());
+    Size len_name = name.size() + padding;
+    ofs.write((char*)&len_name, sizeof(len_name));
+    ofs.write(name.c_str(), name.size());
+    writePadding_(padding, ofs);
+  }
+
+  void CachedMzMLHandler::writePadding_(Size count, std::ofstream& ofs)
+  {
+    const char zeros[data_alignment] = {0};
+    ofs.write(zeros, count);
+  }
+
 }//namespace OpenMS  //namespace Internal
 
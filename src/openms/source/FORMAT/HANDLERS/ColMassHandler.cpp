@@ -0,0 +1,1160 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/HANDLERS/ColMassHandler.h>
+
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/ZlibCompression.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <tuple>
+
+namespace OpenMS::Internal
+{
+  namespace
+  {
+    /// magic bytes at the start and the end of each file
+    const char colmass_magic[8] = {'C', 'O', 'L', 'M', 'A', 'S', 'S', '\0'};
+
+    /// current format version
+    const UInt32 colmass_version = 1;
+
+    /// byte order mark of the header (reads as 0x04030201 if the byte order differs)
+    const UInt32 byte_order_mark = 0x01020304;
+
+    /// magic bytes, format version and byte order mark
+    const Size header_size = 16;
+
+    /// offset of the index, offset and size of the meta data, magic bytes
+    const Size trailer_size = 32;
+
+    template <typename T>
+    void append(std::string& buffer, const T& value)
+    {
+      buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /// Appends @p n values of @p element_size bytes, ordered by byte position (all first bytes, then all second bytes ...)
+    void appendShuffled(std::string& buffer, const void* values, Size n, Size element_size)
+    {
+      const char* in = static_cast<const char*>(values);
+      Size start = buffer.size();
+      buffer.resize(start + n * element_size);
+      char* out = &buffer[start];
+      for (Size b = 0; b < element_size; ++b)
+      {
+        for (Size i = 0; i < n; ++i)
+        {
+          out[b * n + i] = in[i * element_size + b];
+        }
+      }
+    }
+
+    /// Reverts appendShuffled()
+    void unshuffle(const char* in, Size n, Size element_size, void* values)
+    {
+      char* out = static_cast<char*>(values);
+      for (Size b = 0; b < element_size; ++b)
+      {
+        for (Size i = 0; i < n; ++i)
+        {
+          out[i * element_size + b] = in[b * n + i];
+        }
+      }
+    }
+
+    /// Sequential reading of values from a bounded memory region
+    class BoundedReader
+    {
+    public:
+      BoundedReader(const char* begin, const char* end, const String& filename) :
+        pos_(begin),
+        end_(end),
+        filename_(filename)
+      {
+      }
+
+      template <typename T>
+      T read()
+      {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+      }
+
+      String readString()
+      {
+        UInt32 length = read<UInt32>();
+        require(length);
+        String result(std::string(pos_, length));
+        pos_ += length;
+        return result;
+      }
+
+      /// Number of entries of a table with records of at least @p min_record_size bytes (checked against the remaining size)
+      Size readCount(Size min_record_size)
+      {
+        UInt64 count = read<UInt64>();
+        if (count > static_cast<UInt64>(end_ - pos_) / min_record_size)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_,
+            "Invalid number of index entries: " + String(count));
+        }
+        return count;
+      }
+
+    private:
+      void require(Size bytes) const
+      {
+        if (static_cast<Size>(end_ - pos_) < bytes)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Unexpected end of the index");
+        }
+      }
+
+      const char* pos_;
+      const char* end_;
+      const String& filename_;
+    };
+
+    /// Peaks of a spectrum sorted by m/z, in the types used for storage
+    struct SortedPeaks
+    {
+      std::vector<double> mz;
+      std::vector<float> intensity;
+      std::vector<float> im; ///< empty if the spectrum has no ion mobility data
+    };
+
+    void sortedPeaks(const MSSpectrum& spectrum, Int32 im_index, SortedPeaks& peaks)
+    {
+      std::vector<Size> order(spectrum.size());
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        order[i] = i;
+      }
+      if (!spectrum.isSorted())
+      {
+        std::stable_sort(order.begin(), order.end(), [&spectrum](Size a, Size b) { return spectrum[a].getMZ() < spectrum[b].getMZ(); });
+      }
+      peaks.mz.resize(order.size());
+      peaks.intensity.resize(order.size());
+      peaks.im.clear();
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        peaks.mz[i] = spectrum[order[i]].getMZ();
+        peaks.intensity[i] = spectrum[order[i]].getIntensity();
+      }
+      if (im_index >= 0)
+      {
+        const MSSpectrum::FloatDataArray& im = spectrum.getFloatDataArrays()[im_index];
+        peaks.im.resize(order.size());
+        for (Size i = 0; i < order.size(); ++i)
+        {
+          peaks.im[i] = im[order[i]];
+        }
+      }
+    }
+  }
+
+  ColMassHandler::ColMassHandler() :
+    peaks_per_chunk_(4096),
+    spectra_per_block_(32),
+    compression_level_(1),
+    meta_offset_(0),
+    meta_size_(0)
+  {
+  }
+
+  ColMassHandler::~ColMassHandler() = default;
+
+  void ColMassHandler::setConfig(Size peaks_per_chunk, Size spectra_per_block, int compression_level)
+  {
+    if (peaks_per_chunk == 0 || spectra_per_block == 0)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Peaks per chunk and spectra per block need to be positive");
+    }
+    if (compression_level < 0 || compression_level > 9)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Compression level needs to be between 0 and 9, not " + String(compression_level));
+    }
+    peaks_per_chunk_ = peaks_per_chunk;
+    spectra_per_block_ = spectra_per_block;
+    compression_level_ = compression_level;
+  }
+
+  void ColMassHandler::writeExperiment(const String& filename, const MSExperiment& exp) const
+  {
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    UInt64 offset = 0;
+    auto write = [&ofs, &offset](const std::string& data)
+    {
+      ofs.write(data.data(), data.size());
+      offset += data.size();
+    };
+
+    std::string buffer;
+    buffer.append(colmass_magic, sizeof(colmass_magic));
+    append(buffer, colmass_version);
+    append(buffer, byte_order_mark);
+    write(buffer);
+
+    // group the spectra by MS level and isolation window, find ion mobility arrays
+    std::vector<SpectrumGroup> groups;
+    std::vector<std::vector<Size> > group_spectra;
+    std::map<std::tuple<Int32, double, double>, Size> group_lookup;
+    std::vector<SpectrumEntry_> spectra(exp.size());
+    std::vector<Int32> im_index(exp.size(), -1);
+    std::vector<String> im_names;
+    Size dropped_arrays = 0;
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      const MSSpectrum& spectrum = exp[i];
+      SpectrumGroup group;
+      group.ms_level = spectrum.getMSLevel();
+      if (!spectrum.getPrecursors().empty())
+      {
+        const Precursor& prec = spectrum.getPrecursors()[0];
+        group.isolation_lower = prec.getMZ() - prec.getIsolationWindowLowerOffset();
+        group.isolation_upper = prec.getMZ() + prec.getIsolationWindowUpperOffset();
+      }
+      auto key = std::make_tuple(group.ms_level, group.isolation_lower, group.isolation_upper);
+      auto it = group_lookup.find(key);
+      if (it == group_lookup.end())
+      {
+        it = group_lookup.emplace(key, groups.size()).first;
+        groups.push_back(group);
+        group_spectra.emplace_back();
+      }
+      group_spectra[it->second].push_back(i);
+
+      spectra[i].rt = spectrum.getRT();
+      spectra[i].nr_peaks = spectrum.size();
+
+      Size nr_arrays = spectrum.getFloatDataArrays().size() + spectrum.getIntegerDataArrays().size() + spectrum.getStringDataArrays().size();
+      if (spectrum.containsIMData())
+      {
+        Size index = spectrum.getIMData().first;
+        const MSSpectrum::FloatDataArray& im = spectrum.getFloatDataArrays()[index];
+        if (im.size() == spectrum.size())
+        {
+          auto name = std::find(im_names.begin(), im_names.end(), im.getName());
+          spectra[i].im_name = name - im_names.begin();
+          if (name == im_names.end())
+          {
+            im_names.push_back(im.getName());
+          }
+          im_index[i] = index;
+          --nr_arrays;
+        }
+      }
+      if (nr_arrays > 0)
+      {
+        ++dropped_arrays;
+      }
+    }
+    if (dropped_arrays > 0)
+    {
+      OPENMS_LOG_WARN << "Warning: Data arrays of " << dropped_arrays << " spectra cannot be stored in colMass format"
+                      << " (only ion mobility arrays are supported) and are omitted." << std::endl;
+    }
+
+    // write blocks of spectra as column chunks split by m/z
+    std::vector<Block_> blocks;
+    std::vector<UInt32> block_members;
+    std::vector<Chunk_> chunks;
+    std::vector<SortedPeaks> peaks;
+    std::string raw;
+    std::string compressed;
+    std::vector<UInt64> mz_bits;
+    std::vector<float> intensities;
+    std::vector<float> ims;
+    Size progress = 0;
+    startProgress(0, exp.size(), "Writing colMass file");
+    for (Size g = 0; g < groups.size(); ++g)
+    {
+      groups[g].first_block = blocks.size();
+      const std::vector<Size>& ids = group_spectra[g];
+      for (Size start = 0; start < ids.size(); start += spectra_per_block_)
+      {
+        Block_ block;
+        block.group = g;
+        block.first_member = block_members.size();
+        block.nr_members = std::min(spectra_per_block_, ids.size() - start);
+        block.first_chunk = chunks.size();
+        block.rt_min = std::numeric_limits<double>::max();
+        block.rt_max = -std::numeric_limits<double>::max();
+
+        peaks.resize(block.nr_members);
+        std::vector<double> all_mz;
+        for (Size m = 0; m < block.nr_members; ++m)
+        {
+          Size id = ids[start + m];
+          block_members.push_back(id);
+          spectra[id].block = blocks.size();
+          spectra[id].position = m;
+          block.rt_min = std::min(block.rt_min, spectra[id].rt);
+          block.rt_max = std::max(block.rt_max, spectra[id].rt);
+          sortedPeaks(exp[id], im_index[id], peaks[m]);
+          if (!peaks[m].im.empty())
+          {
+            block.has_im = 1;
+          }
+          all_mz.insert(all_mz.end(), peaks[m].mz.begin(), peaks[m].mz.end());
+        }
+
+        // m/z boundaries between the chunks such that all chunks hold about the same number of peaks
+        std::vector<double> bounds;
+        if (all_mz.size() > peaks_per_chunk_)
+        {
+          std::sort(all_mz.begin(), all_mz.end());
+          Size nr_chunks = (all_mz.size() + peaks_per_chunk_ - 1) / peaks_per_chunk_;
+          for (Size k = 1; k < nr_chunks; ++k)
+          {
+            double bound = all_mz[k * all_mz.size() / nr_chunks];
+            if (bounds.empty() || bound > bounds.back())
+            {
+              bounds.push_back(bound);
+            }
+          }
+        }
+
+        block.mz_min = std::numeric_limits<double>::max();
+        block.mz_max = -std::numeric_limits<double>::max();
+        std::vector<UInt32> counts(block.nr_members);
+        std::vector<Size> pos(block.nr_members, 0);
+        for (Size k = 0; k <= bounds.size(); ++k)
+        {
+          Size n = 0;
+          for (Size m = 0; m < block.nr_members; ++m)
+          {
+            const std::vector<double>& mz = peaks[m].mz;
+            Size end = k < bounds.size() ? std::lower_bound(mz.begin() + pos[m], mz.end(), bounds[k]) - mz.begin() : mz.size();
+            counts[m] = end - pos[m];
+            n += counts[m];
+          }
+          if (n == 0)
+          {
+            continue;
+          }
+
+          Chunk_ chunk;
+          chunk.nr_peaks = n;
+          chunk.mz_min = std::numeric_limits<double>::max();
+          chunk.mz_max = -std::numeric_limits<double>::max();
+          chunk.intensity_max = -std::numeric_limits<float>::max();
+          mz_bits.resize(n);
+          intensities.resize(n);
+          ims.assign(block.has_im ? n : 0, 0.0f);
+          UInt64 previous = 0;
+          Size j = 0;
+          for (Size m = 0; m < block.nr_members; ++m)
+          {
+            const SortedPeaks& p = peaks[m];
+            if (counts[m] > 0)
+            {
+              chunk.mz_min = std::min(chunk.mz_min, p.mz[pos[m]]);
+              chunk.mz_max = std::max(chunk.mz_max, p.mz[pos[m] + counts[m] - 1]);
+            }
+            for (Size i = pos[m]; i < pos[m] + counts[m]; ++i, ++j)
+            {
+              // m/z values are sorted within each spectrum, the bit patterns of positive doubles are ordered the same
+              // way, so the differences between consecutive bit patterns are small (wrap-around keeps it lossless)
+              UInt64 bits;
+              std::memcpy(&bits, &p.mz[i], sizeof(bits));
+              mz_bits[j] = bits - previous;
+              previous = bits;
+              intensities[j] = p.intensity[i];
+              chunk.intensity_max = std::max(chunk.intensity_max, p.intensity[i]);
+              if (!p.im.empty())
+              {
+                ims[j] = p.im[i];
+              }
+            }
+            pos[m] += counts[m];
+          }
+
+          raw.clear();
+          raw.append(reinterpret_cast<const char*>(counts.data()), counts.size() * sizeof(UInt32));
+          appendShuffled(raw, mz_bits.data(), n, sizeof(UInt64));
+          appendShuffled(raw, intensities.data(), n, sizeof(float));
+          if (block.has_im)
+          {
+            appendShuffled(raw, ims.data(), n, sizeof(float));
+          }
+          ZlibCompression::compressData(raw.data(), raw.size(), compressed, compression_level_);
+
+          chunk.offset = offset;
+          chunk.size = compressed.size();
+          write(compressed);
+          chunks.push_back(chunk);
+          block.mz_min = std::min(block.mz_min, chunk.mz_min);
+          block.mz_max = std::max(block.mz_max, chunk.mz_max);
+        }
+        block.nr_chunks = chunks.size() - block.first_chunk;
+        if (block.nr_chunks == 0)
+        {
+          block.mz_min = 0.0;
+          block.mz_max = 0.0;
+        }
+        blocks.push_back(block);
+
+        progress += block.nr_members;
+        setProgress(progress);
+      }
+      groups[g].nr_blocks = blocks.size() - groups[g].first_block;
+    }
+    endProgress();
+
+    // write chromatograms (RT delta encoded as above)
+    std::vector<ChromatogramEntry_> chromatograms(exp.getNrChromatograms());
+    std::vector<double> chrom_intensities;
+    for (Size c = 0; c < exp.getNrChromatograms(); ++c)
+    {
+      const MSChromatogram& chrom = exp.getChromatograms()[c];
+      Size n = chrom.size();
+      chromatograms[c].nr_peaks = n;
+      chromatograms[c].offset = offset;
+      if (n == 0)
+      {
+        continue;
+      }
+      mz_bits.resize(n);
+      chrom_intensities.resize(n);
+      UInt64 previous = 0;
+      for (Size i = 0; i < n; ++i)
+      {
+        UInt64 bits;
+        double rt = chrom[i].getRT();
+        std::memcpy(&bits, &rt, sizeof(bits));
+        mz_bits[i] = bits - previous;
+        previous = bits;
+        chrom_intensities[i] = chrom[i].getIntensity();
+      }
+      raw.clear();
+      appendShuffled(raw, mz_bits.data(), n, sizeof(UInt64));
+      appendShuffled(raw, chrom_intensities.data(), n, sizeof(double));
+      ZlibCompression::compressData(raw.data(), raw.size(), compressed, compression_level_);
+      chromatograms[c].size = compressed.size();
+      write(compressed);
+    }
+
+    // write the index
+    UInt64 index_offset = offset;
+    buffer.clear();
+    append(buffer, UInt64(groups.size()));
+    for (const SpectrumGroup& group : groups)
+    {
+      append(buffer, group.ms_level);
+      append(buffer, group.isolation_lower);
+      append(buffer, group.isolation_upper);
+      append(buffer, group.first_block);
+      append(buffer, group.nr_blocks);
+    }
+    append(buffer, UInt64(blocks.size()));
+    for (const Block_& block : blocks)
+    {
+      append(buffer, block.group);
+      append(buffer, block.rt_min);
+      append(buffer, block.rt_max);
+      append(buffer, block.mz_min);
+      append(buffer, block.mz_max);
+      append(buffer, block.first_member);
+      append(buffer, block.nr_members);
+      append(buffer, block.first_chunk);
+      append(buffer, block.nr_chunks);
+      append(buffer, block.has_im);
+    }
+    append(buffer, UInt64(block_members.size()));
+    buffer.append(reinterpret_cast<const char*>(block_members.data()), block_members.size() * sizeof(UInt32));
+    append(buffer, UInt64(chunks.size()));
+    for (const Chunk_& chunk : chunks)
+    {
+      append(buffer, chunk.offset);
+      append(buffer, chunk.size);
+      append(buffer, chunk.nr_peaks);
+      append(buffer, chunk.mz_min);
+      append(buffer, chunk.mz_max);
+      append(buffer, chunk.intensity_max);
+    }
+    append(buffer, UInt64(spectra.size()));
+    for (const SpectrumEntry_& entry : spectra)
+    {
+      append(buffer, entry.rt);
+      append(buffer, entry.block);
+      append(buffer, entry.position);
+      append(buffer, entry.nr_peaks);
+      append(buffer, entry.im_name);
+    }
+    append(buffer, UInt64(chromatograms.size()));
+    for (const ChromatogramEntry_& entry : chromatograms)
+    {
+      append(buffer, entry.offset);
+      append(buffer, entry.size);
+      append(buffer, entry.nr_peaks);
+    }
+    append(buffer, UInt64(im_names.size()));
+    for (const String& name : im_names)
+    {
+      append(buffer, UInt32(name.size()));
+      buffer.append(name);
+    }
+    write(buffer);
+
+    // write the meta data as mzML without peaks and data arrays
+    MSExperiment meta;
+    meta.ExperimentalSettings::operator=(exp);
+    meta.reserveSpaceSpectra(exp.size());
+    for (const MSSpectrum& spectrum : exp)
+    {
+      MSSpectrum s = spectrum;
+      s.clear(false);
+      meta.addSpectrum(std::move(s));
+    }
+    for (const MSChromatogram& chromatogram : exp.getChromatograms())
+    {
+      MSChromatogram c = chromatogram;
+      c.clear(false);
+      c.getFloatDataArrays().clear();
+      c.getIntegerDataArrays().clear();
+      c.getStringDataArrays().clear();
+      meta.addChromatogram(std::move(c));
+    }
+    std::string meta_mzml;
+    MzMLFile().storeBuffer(meta_mzml, meta);
+    ZlibCompression::compressData(meta_mzml.data(), meta_mzml.size(), compressed, compression_level_);
+    UInt64 meta_offset = offset;
+    write(compressed);
+
+    buffer.clear();
+    append(buffer, index_offset);
+    append(buffer, meta_offset);
+    append(buffer, UInt64(compressed.size()));
+    buffer.append(colmass_magic, sizeof(colmass_magic));
+    write(buffer);
+
+    ofs.close();
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error while writing the file");
+    }
+  }
+
+  void ColMassHandler::open(const String& filename)
+  {
+    close();
+    file_.open(filename);
+    try
+    {
+      const char* data = file_.data();
+      Size size = file_.size();
+      if (size < header_size + trailer_size || std::memcmp(data, colmass_magic, sizeof(colmass_magic)) != 0)
+      {
+        throwParseError_("Not a colMass file");
+      }
+      BoundedReader header(data + sizeof(colmass_magic), data + header_size, filename);
+      UInt32 version = header.read<UInt32>();
+      if (header.read<UInt32>() != byte_order_mark)
+      {
+        throwParseError_("The file was written on a machine with a different byte order");
+      }
+      if (version == 0 || version > colmass_version)
+      {
+        throwParseError_("Unsupported format version " + String(version) + " (supported: up to " + String(colmass_version) + ")");
+      }
+
+      const char* trailer_data = data + size - trailer_size;
+      if (std::memcmp(trailer_data + trailer_size - sizeof(colmass_magic), colmass_magic, sizeof(colmass_magic)) != 0)
+      {
+        throwParseError_("The file is truncated (no trailer found)");
+      }
+      BoundedReader trailer(trailer_data, data + size, filename);
+      UInt64 index_offset = trailer.read<UInt64>();
+      meta_offset_ = trailer.read<UInt64>();
+      meta_size_ = trailer.read<UInt64>();
+      if (index_offset < header_size || index_offset > meta_offset_ || meta_offset_ > size - trailer_size || meta_size_ > size - trailer_size - meta_offset_)
+      {
+        throwParseError_("Invalid position of index or meta data");
+      }
+
+      BoundedReader index(data + index_offset, data + meta_offset_, filename);
+      groups_.resize(index.readCount(28));
+      for (SpectrumGroup& group : groups_)
+      {
+        group.ms_level = index.read<Int32>();
+        group.isolation_lower = index.read<double>();
+        group.isolation_upper = index.read<double>();
+        group.first_block = index.read<UInt32>();
+        group.nr_blocks = index.read<UInt32>();
+      }
+      blocks_.resize(index.readCount(56));
+      for (Block_& block : blocks_)
+      {
+        block.group = index.read<UInt32>();
+        block.rt_min = index.read<double>();
+        block.rt_max = index.read<double>();
+        block.mz_min = index.read<double>();
+        block.mz_max = index.read<double>();
+        block.first_member = index.read<UInt32>();
+        block.nr_members = index.read<UInt32>();
+        block.first_chunk = index.read<UInt32>();
+        block.nr_chunks = index.read<UInt32>();
+        block.has_im = index.read<UInt32>();
+      }
+      block_members_.resize(index.readCount(sizeof(UInt32)));
+      for (UInt32& member : block_members_)
+      {
+        member = index.read<UInt32>();
+      }
+      chunks_.resize(index.readCount(40));
+      for (Chunk_& chunk : chunks_)
+      {
+        chunk.offset = index.read<UInt64>();
+        chunk.size = index.read<UInt64>();
+        chunk.nr_peaks = index.read<UInt32>();
+        chunk.mz_min = index.read<double>();
+        chunk.mz_max = index.read<double>();
+        chunk.intensity_max = index.read<float>();
+      }
+      spectra_.resize(index.readCount(24));
+      for (SpectrumEntry_& entry : spectra_)
+      {
+        entry.rt = index.read<double>();
+        entry.block = index.read<UInt32>();
+        entry.position = index.read<UInt32>();
+        entry.nr_peaks = index.read<UInt32>();
+        entry.im_name = index.read<Int32>();
+      }
+      chromatograms_.resize(index.readCount(20));
+      for (ChromatogramEntry_& entry : chromatograms_)
+      {
+        entry.offset = index.read<UInt64>();
+        entry.size = index.read<UInt64>();
+        entry.nr_peaks = index.read<UInt32>();
+      }
+      im_names_.resize(index.readCount(sizeof(UInt32)));
+      for (String& name : im_names_)
+      {
+        name = index.readString();
+      }
+
+      // consistency of the index (all later accesses rely on it)
+      for (const SpectrumGroup& group : groups_)
+      {
+        if (UInt64(group.first_block) + group.nr_blocks > blocks_.size())
+        {
+          throwParseError_("Invalid spectrum group in index");
+        }
+      }
+      for (const Block_& block : blocks_)
+      {
+        if (block.group >= groups_.size() || UInt64(block.first_member) + block.nr_members > block_members_.size() ||
+            UInt64(block.first_chunk) + block.nr_chunks > chunks_.size())
+        {
+          throwParseError_("Invalid block in index");
+        }
+      }
+      for (UInt32 member : block_members_)
+      {
+        if (member >= spectra_.size())
+        {
+          throwParseError_("Invalid block in index");
+        }
+      }
+      for (const Chunk_& chunk : chunks_)
+      {
+        if (chunk.offset < header_size || chunk.offset > index_offset || chunk.size > index_offset - chunk.offset)
+        {
+          throwParseError_("Invalid chunk in index");
+        }
+      }
+      for (const SpectrumEntry_& entry : spectra_)
+      {
+        if (entry.block >= blocks_.size() || entry.position >= blocks_[entry.block].nr_members ||
+            entry.im_name >= static_cast<Int32>(im_names_.size()))
+        {
+          throwParseError_("Invalid spectrum in index");
+        }
+      }
+      for (const ChromatogramEntry_& entry : chromatograms_)
+      {
+        if (entry.offset > index_offset || entry.size > index_offset - entry.offset)
+        {
+          throwParseError_("Invalid chromatogram in index");
+        }
+      }
+    }
+    catch (...)
+    {
+      close();
+      throw;
+    }
+    file_.advise(MemoryMappedFile::AccessPattern::RANDOM);
+  }
+
+  bool ColMassHandler::isOpen() const
+  {
+    return file_.isOpen();
+  }
+
+  void ColMassHandler::close()
+  {
+    file_.close();
+    meta_offset_ = 0;
+    meta_size_ = 0;
+    groups_.clear();
+    blocks_.clear();
+    block_members_.clear();
+    chunks_.clear();
+    spectra_.clear();
+    chromatograms_.clear();
+    im_names_.clear();
+  }
+
+  bool ColMassHandler::isColMassFile(const String& filename)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    char magic[sizeof(colmass_magic)];
+    return ifs.read(magic, sizeof(magic)) && std::memcmp(magic, colmass_magic, sizeof(magic)) == 0;
+  }
+
+  void ColMassHandler::readMetaData(MSExperiment& exp) const
+  {
+    std::string meta_mzml;
+    ZlibCompression::uncompressString(file_.data() + meta_offset_, meta_size_, meta_mzml);
+    MzMLFile().loadBuffer(meta_mzml, exp);
+    if (exp.size() != spectra_.size() || exp.getNrChromatograms() != chromatograms_.size())
+    {
+      throwParseError_("The meta data does not match the index (" + String(exp.size()) + " spectra and " + String(exp.getNrChromatograms()) +
+        " chromatograms instead of " + String(spectra_.size()) + " and " + String(chromatograms_.size()) + ")");
+    }
+  }
+
+  void ColMassHandler::readExperiment(MSExperiment& exp) const
+  {
+    readMetaData(exp);
+
+    bool failed = false;
+    String error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize b = 0; b < (SignedSize)blocks_.size(); ++b)
+    {
+      try
+      {
+        const Block_& block = blocks_[b];
+        for (Size m = 0; m < block.nr_members; ++m)
+        {
+          prepareSpectrum_(block_members_[block.first_member + m], exp[block_members_[block.first_member + m]]);
+        }
+        ChunkData_ data;
+        for (Size c = block.first_chunk; c < block.first_chunk + block.nr_chunks; ++c)
+        {
+          decodeChunk_(block, chunks_[c], data);
+          Size start = 0;
+          for (Size m = 0; m < block.nr_members; ++m)
+          {
+            appendPeaks_(data, start, data.counts[m], exp[block_members_[block.first_member + m]]);
+            start += data.counts[m];
+          }
+        }
+      }
+      catch (Exception::BaseException& e)
+      {
+#ifdef _OPENMP
+#pragma omp critical (ColMassHandler_readExperiment)
+#endif
+        {
+          failed = true;
+          error = e.what();
+        }
+      }
+    }
+    if (failed)
+    {
+      throwParseError_(error);
+    }
+
+    for (Size c = 0; c < chromatograms_.size(); ++c)
+    {
+      getChromatogram(c, exp.getChromatogram(c));
+    }
+    exp.updateRanges();
+  }
+
+  Size ColMassHandler::getNrSpectra() const
+  {
+    return spectra_.size();
+  }
+
+  Size ColMassHandler::getNrChromatograms() const
+  {
+    return chromatograms_.size();
+  }
+
+  const std::vector<ColMassHandler::SpectrumGroup>& ColMassHandler::getSpectrumGroups() const
+  {
+    return groups_;
+  }
+
+  Size ColMassHandler::getSpectrumGroupIndex(Size index) const
+  {
+    return blocks_[spectra_.at(index).block].group;
+  }
+
+  double ColMassHandler::getSpectrumRT(Size index) const
+  {
+    return spectra_.at(index).rt;
+  }
+
+  Size ColMassHandler::getSpectrumSize(Size index) const
+  {
+    return spectra_.at(index).nr_peaks;
+  }
+
+  void ColMassHandler::getSpectrum(Size index, MSSpectrum& spectrum) const
+  {
+    if (index >= spectra_.size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, index, spectra_.size());
+    }
+    prepareSpectrum_(index, spectrum);
+
+    const SpectrumEntry_& entry = spectra_[index];
+    const Block_& block = blocks_[entry.block];
+    ChunkData_ data;
+    for (Size c = block.first_chunk; c < block.first_chunk + block.nr_chunks; ++c)
+    {
+      decodeChunk_(block, chunks_[c], data);
+      Size start = 0;
+      for (Size m = 0; m < entry.position; ++m)
+      {
+        start += data.counts[m];
+      }
+      appendPeaks_(data, start, data.counts[entry.position], spectrum);
+    }
+  }
+
+  void ColMassHandler::getChromatogram(Size index, MSChromatogram& chromatogram) const
+  {
+    if (index >= chromatograms_.size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, index, chromatograms_.size());
+    }
+    const ChromatogramEntry_& entry = chromatograms_[index];
+    chromatogram.clear(false);
+    if (entry.nr_peaks == 0)
+    {
+      return;
+    }
+
+    Size n = entry.nr_peaks;
+    std::vector<char> raw(n * (sizeof(UInt64) + sizeof(double)));
+    ZlibCompression::uncompressData(file_.data() + entry.offset, entry.size, raw.data(), raw.size());
+    std::vector<UInt64> rt_bits(n);
+    std::vector<double> intensities(n);
+    unshuffle(raw.data(), n, sizeof(UInt64), rt_bits.data());
+    unshuffle(raw.data() + n * sizeof(UInt64), n, sizeof(double), intensities.data());
+
+    chromatogram.reserve(n);
+    UInt64 bits = 0;
+    for (Size i = 0; i < n; ++i)
+    {
+      bits += rt_bits[i];
+      double rt;
+      std::memcpy(&rt, &bits, sizeof(rt));
+      chromatogram.push_back(ChromatogramPeak(rt, intensities[i]));
+    }
+  }
+
+  void ColMassHandler::getArea(Size group, double min_rt, double max_rt, const std::vector<std::pair<double, double> >& mz_ranges,
+                               std::vector<OpenSwath::SpectrumPtr>& spectra, std::vector<OpenSwath::SpectrumMeta>& spectra_meta) const
+  {
+    if (group >= groups_.size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, group, groups_.size());
+    }
+
+    // sort and merge the m/z ranges
+    std::vector<std::pair<double, double> > ranges;
+    for (const auto& range : mz_ranges)
+    {
+      if (range.first <= range.second)
+      {
+        ranges.push_back(range);
+      }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    Size nr_ranges = 0;
+    for (const auto& range : ranges)
+    {
+      if (nr_ranges > 0 && range.first <= ranges[nr_ranges - 1].second)
+      {
+        ranges[nr_ranges - 1].second = std::max(ranges[nr_ranges - 1].second, range.second);
+      }
+      else
+      {
+        ranges[nr_ranges++] = range;
+      }
+    }
+    ranges.resize(nr_ranges);
+    // first range whose upper end is not below @p mz
+    auto firstRange = [&ranges](double mz)
+    {
+      return std::lower_bound(ranges.begin(), ranges.end(), mz,
+        [](const std::pair<double, double>& range, double value) { return range.second < value; });
+    };
+
+    const SpectrumGroup& g = groups_[group];
+    ChunkData_ data;
+    std::vector<OpenSwath::SpectrumPtr> members;
+    for (Size b = g.first_block; b < g.first_block + g.nr_blocks; ++b)
+    {
+      const Block_& block = blocks_[b];
+      if (block.rt_max < min_rt || block.rt_min > max_rt)
+      {
+        continue;
+      }
+
+      members.assign(block.nr_members, OpenSwath::SpectrumPtr());
+      bool any_member = false;
+      for (Size m = 0; m < block.nr_members; ++m)
+      {
+        Size index = block_members_[block.first_member + m];
+        const SpectrumEntry_& entry = spectra_[index];
+        if (entry.rt < min_rt || entry.rt > max_rt)
+        {
+          continue;
+        }
+        OpenSwath::SpectrumPtr spectrum(new OpenSwath::Spectrum);
+        if (entry.im_name >= 0)
+        {
+          OpenSwath::BinaryDataArrayPtr im(new OpenSwath::BinaryDataArray);
+          im->description = "Ion Mobility";
+          spectrum->getDataArrays().push_back(im);
+        }
+        OpenSwath::SpectrumMeta meta;
+        meta.index = index;
+        meta.RT = entry.rt;
+        meta.ms_level = g.ms_level;
+        spectra.push_back(spectrum);
+        spectra_meta.push_back(meta);
+        members[m] = spectrum;
+        any_member = true;
+      }
+      if (!any_member)
+      {
+        continue;
+      }
+
+      for (Size c = block.first_chunk; c < block.first_chunk + block.nr_chunks; ++c)
+      {
+        const Chunk_& chunk = chunks_[c];
+        auto range = firstRange(chunk.mz_min);
+        if (range == ranges.end() || range->first > chunk.mz_max)
+        {
+          continue; // chunk does not overlap with any m/z range
+        }
+        decodeChunk_(block, chunk, data);
+
+        Size start = 0;
+        for (Size m = 0; m < block.nr_members; ++m)
+        {
+          Size end = start + data.counts[m];
+          if (members[m] != nullptr && end > start)
+          {
+            std::vector<double>& mz = members[m]->getMZArray()->data;
+            std::vector<double>& intensity = members[m]->getIntensityArray()->data;
+            OpenSwath::BinaryDataArrayPtr im = members[m]->getDriftTimeArray();
+            auto r = firstRange(data.mz[start]);
+            for (Size i = start; i < end && r != ranges.end(); ++i)
+            {
+              while (r != ranges.end() && r->second < data.mz[i])
+              {
+                ++r;
+              }
+              if (r != ranges.end() && data.mz[i] >= r->first)
+              {
+                mz.push_back(data.mz[i]);
+                intensity.push_back(data.intensity[i]);
+                if (im != nullptr)
+                {
+                  im->data.push_back(data.im[i]);
+                }
+              }
+            }
+          }
+          start = end;
+        }
+      }
+    }
+  }
+
+  void ColMassHandler::getArea(double min_rt, double max_rt, double min_mz, double max_mz, UInt ms_level, MSExperiment& exp) const
+  {
+    std::vector<OpenSwath::SpectrumPtr> spectra;
+    std::vector<OpenSwath::SpectrumMeta> spectra_meta;
+    std::vector<std::pair<double, double> > mz_ranges(1, std::make_pair(min_mz, max_mz));
+    for (Size g = 0; g < groups_.size(); ++g)
+    {
+      if (groups_[g].ms_level == static_cast<Int32>(ms_level))
+      {
+        getArea(g, min_rt, max_rt, mz_ranges, spectra, spectra_meta);
+      }
+    }
+
+    std::vector<Size> order(spectra.size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&spectra_meta](Size a, Size b) { return spectra_meta[a].index < spectra_meta[b].index; });
+
+    exp.clear(true);
+    exp.reserveSpaceSpectra(order.size());
+    for (Size i : order)
+    {
+      const std::vector<double>& mz = spectra[i]->getMZArray()->data;
+      const std::vector<double>& intensity = spectra[i]->getIntensityArray()->data;
+      MSSpectrum spectrum;
+      spectrum.setRT(spectra_meta[i].RT);
+      spectrum.setMSLevel(spectra_meta[i].ms_level);
+      spectrum.reserve(mz.size());
+      for (Size k = 0; k < mz.size(); ++k)
+      {
+        spectrum.push_back(Peak1D(mz[k], intensity[k]));
+      }
+      OpenSwath::BinaryDataArrayPtr im = spectra[i]->getDriftTimeArray();
+      if (im != nullptr)
+      {
+        MSSpectrum::FloatDataArray fda;
+        fda.setName(im_names_[spectra_[spectra_meta[i].index].im_name]);
+        fda.assign(im->data.begin(), im->data.end());
+        spectrum.getFloatDataArrays().push_back(std::move(fda));
+      }
+      exp.addSpectrum(std::move(spectrum));
+    }
+    exp.updateRanges();
+  }
+
+  void ColMassHandler::decodeChunk_(const Block_& block, const Chunk_& chunk, ChunkData_& data) const
+  {
+    Size n = chunk.nr_peaks;
+    Size column_size = n * (sizeof(UInt64) + sizeof(float) + (block.has_im ? sizeof(float) : 0));
+    std::vector<char> raw(block.nr_members * sizeof(UInt32) + column_size);
+    ZlibCompression::uncompressData(file_.data() + chunk.offset, chunk.size, raw.data(), raw.size());
+
+    const char* pos = raw.data();
+    data.counts.resize(block.nr_members);
+    std::memcpy(data.counts.data(), pos, block.nr_members * sizeof(UInt32));
+    pos += block.nr_members * sizeof(UInt32);
+    Size total = 0;
+    for (UInt32 count : data.counts)
+    {
+      total += count;
+    }
+    if (total != n)
+    {
+      throwParseError_("Corrupt chunk at offset " + String(chunk.offset));
+    }
+
+    std::vector<UInt64> mz_bits(n);
+    unshuffle(pos, n, sizeof(UInt64), mz_bits.data());
+    pos += n * sizeof(UInt64);
+    data.mz.resize(n);
+    UInt64 bits = 0;
+    for (Size i = 0; i < n; ++i)
+    {
+      bits += mz_bits[i];
+      std::memcpy(&data.mz[i], &bits, sizeof(double));
+    }
+
+    data.intensity.resize(n);
+    unshuffle(pos, n, sizeof(float), data.intensity.data());
+    pos += n * sizeof(float);
+
+    data.im.resize(block.has_im ? n : 0);
+    if (block.has_im)
+    {
+      unshuffle(pos, n, sizeof(float), data.im.data());
+    }
+  }
+
+  void ColMassHandler::prepareSpectrum_(Size index, MSSpectrum& spectrum) const
+  {
+    const SpectrumEntry_& entry = spectra_[index];
+    spectrum.clear(false);
+    spectrum.setRT(entry.rt);
+    spectrum.setMSLevel(groups_[blocks_[entry.block].group].ms_level);
+    spectrum.reserve(entry.nr_peaks);
+    if (entry.im_name >= 0)
+    {
+      spectrum.getFloatDataArrays().resize(1);
+      spectrum.getFloatDataArrays()[0].setName(im_names_[entry.im_name]);
+      spectrum.getFloatDataArrays()[0].reserve(entry.nr_peaks);
+    }
+  }
+
+  void ColMassHandler::appendPeaks_(const ChunkData_& data, Size start, Size count, MSSpectrum& spectrum)
+  {
+    for (Size i = start; i < start + count; ++i)
+    {
+      spectrum.push_back(Peak1D(data.mz[i], data.intensity[i]));
+    }
+    if (!spectrum.getFloatDataArrays().empty() && !data.im.empty())
+    {
+      MSSpectrum::FloatDataArray& im = spectrum.getFloatDataArrays()[0];
+      im.insert(im.end(), data.im.begin() + start, data.im.begin() + start + count);
+    }
+  }
+
+  void ColMassHandler::throwParseError_(const String& message) const
+  {
+    throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_.getFilename(), message);
+  }
+
+} // namespace OpenMS::Internal
@@ -0,0 +1,399 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/MappedCachedMzML.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+#include <cstring>
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// bytes preceding the data arrays of a spectrum record (size, number of extra arrays, MS level, RT)
+    const Size spectrum_header_size = 2 * sizeof(Size) + sizeof(int) + sizeof(double);
+
+    /// bytes preceding the data arrays of a chromatogram record (size, number of extra arrays)
+    const Size chromatogram_header_size = 2 * sizeof(Size);
+
+    /// Position of a single data array in the mapped file
+    struct ArrayLocation
+    {
+      const char* name = nullptr;
+      Size name_length = 0;
+      const char* data = nullptr;
+      Size size = 0;
+    };
+
+    template <typename T>
+    T readValue(const char* pos)
+    {
+      T value;
+      std::memcpy(&value, pos, sizeof(T));
+      return value;
+    }
+
+    /**
+      @brief Parses the record starting at @p offset and returns the offset past its end
+
+      All sizes are checked against @p end, so corrupt files result in an
+      exception instead of an access outside of the mapping. If @p arrays is
+      given, the locations of all data arrays are stored there.
+    */
+    Size parseRecord(const char* base, Size offset, Size end, Size header_size,
+                     std::vector<ArrayLocation>* arrays, const String& filename)
+    {
+      // make sure that @p count elements of @p element_size bytes fit between offset and end
+      auto require = [&](Size count, Size element_size)
+      {
+        if (offset > end || count > (end - offset) / element_size)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Cached mzML file is truncated or corrupt (record at offset " + String(offset) + " exceeds the file). Aborting!", filename);
+        }
+      };
+
+      require(header_size, 1);
+      Size data_size = readValue<Size>(base + offset);
+      Size nr_extra_arrays = readValue<Size>(base + offset + sizeof(Size));
+      offset += header_size;
+
+      // the two main arrays follow directly
+      require(data_size, 2 * sizeof(double));
+      if (arrays != nullptr)
+      {
+        arrays->resize(2);
+        (*arrays)[0].data = base + offset;
+        (*arrays)[0].size = data_size;
+        (*arrays)[1].data = base + offset + data_size * sizeof(double);
+        (*arrays)[1].size = data_size;
+      }
+      offset += 2 * data_size * sizeof(double);
+      // empty records do not store their additional arrays (see CachedMzMLHandler)
+      if (data_size == 0)
+      {
+        return offset;
+      }
+
+      for (Size k = 0; k < nr_extra_arrays; ++k)
+      {
+        require(2, sizeof(Size));
+        ArrayLocation array;
+        array.size = readValue<Size>(base + offset);
+        array.name_length = readValue<Size>(base + offset + sizeof(Size));
+        offset += 2 * sizeof(Size);
+
+        require(array.name_length, 1);
+        array.name = base + offset;
+        offset += array.name_length;
+
+        require(array.size, sizeof(double));
+        array.data = base + offset;
+        offset += array.size * sizeof(double);
+        if (arrays != nullptr)
+        {
+          arrays->push_back(array);
+        }
+      }
+      return offset;
+    }
+
+    /// Name of an additional data array (names are zero-padded in the file)
+    std::string_view arrayName(const ArrayLocation& array)
+    {
+      const void* terminator = std::memchr(array.name, '\0', array.name_length);
+      Size length = terminator == nullptr ? array.name_length : static_cast<const char*>(terminator) - array.name;
+      return std::string_view(array.name, length);
+    }
+
+    MappedCachedMzML::DataArrayView toView(const ArrayLocation& array)
+    {
+      return MappedCachedMzML::DataArrayView(reinterpret_cast<const double*>(array.data), array.size);
+    }
+
+    /**
+      @brief Sets views on the data arrays of the (validated) record at @p offset
+
+      The two main arrays directly follow the record header, so they are
+      located without parsing the record. Only records with additional
+      arrays are parsed (and only then memory is allocated).
+    */
+    void recordViews(const char* base, Size offset, Size end, Size header_size,
+                     MappedCachedMzML::DataArrayView& first,
+                     MappedCachedMzML::DataArrayView& second,
+                     std::vector<MappedCachedMzML::NamedDataArrayView>& extra,
+                     const String& filename)
+    {
+      const Size data_size = readValue<Size>(base + offset);
+      const Size nr_extra_arrays = readValue<Size>(base + offset + sizeof(Size));
+      const double* data = reinterpret_cast<const double*>(base + offset + header_size);
+      first = MappedCachedMzML::DataArrayView(data, data_size);
+      second = MappedCachedMzML::DataArrayView(data + data_size, data_size);
+
+      // empty records do not store their additional arrays (see CachedMzMLHandler)
+      if (data_size == 0 || nr_extra_arrays == 0)
+      {
+        return;
+      }
+      std::vector<ArrayLocation> arrays;
+      parseRecord(base, offset, end, header_size, &arrays, filename);
+      extra.reserve(arrays.size() - 2);
+      for (Size k = 2; k < arrays.size(); ++k)
+      {
+        extra.push_back({arrayName(arrays[k]), toView(arrays[k])});
+      }
+    }
+
+    std::vector<OpenSwath::BinaryDataArrayPtr> toDataArrays(const std::vector<ArrayLocation>& arrays)
+    {
+      std::vector<OpenSwath::BinaryDataArrayPtr> data;
+      data.reserve(arrays.size());
+      for (Size k = 0; k < arrays.size(); ++k)
+      {
+        OpenSwath::BinaryDataArrayPtr array(new OpenSwath::BinaryDataArray);
+        // memcpy works independent of the alignment (legacy files)
+        array->data.resize(arrays[k].size);
+        if (arrays[k].size > 0)
+        {
+          std::memcpy(&array->data[0], arrays[k].data, arrays[k].size * sizeof(double));
+        }
+        if (k >= 2)
+        {
+          array->description = std::string(arrayName(arrays[k]));
+        }
+        data.push_back(array);
+      }
+      return data;
+    }
+  }
+
+  MappedCachedMzML::MappedCachedMzML() :
+    data_(std::make_shared<SharedData_>())
+  {
+  }
+
+  MappedCachedMzML::MappedCachedMzML(const String& filename) :
+    MappedCachedMzML()
+  {
+    load_(filename);
+  }
+
+  MappedCachedMzML::MappedCachedMzML(const MappedCachedMzML& rhs) = default;
+
+  MappedCachedMzML& MappedCachedMzML::operator=(const MappedCachedMzML& rhs) = default;
+
+  MappedCachedMzML::~MappedCachedMzML() = default;
+
+  void MappedCachedMzML::load(const String& filename, MappedCachedMzML& map)
+  {
+    map.load_(filename);
+  }
+
+  void MappedCachedMzML::load_(const String& filename)
+  {
+    filename_cached_ = filename + ".cached";
+    filename_ = filename;
+
+    auto data = std::make_shared<SharedData_>();
+    data->file.open(filename_cached_);
+    data->version = Internal::CachedMzMLHandler::parseHeader(data->file.data(), data->file.size(), filename_cached_);
+
+    // the number of spectra and chromatograms is stored at the end of the file
+    const char* base = data->file.data();
+    const Size header_size = Internal::CachedMzMLHandler::getHeaderSize(data->version);
+    if (data->file.size() < header_size + 2 * sizeof(Size))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached mzML file is truncated (no trailer found). Aborting!", filename_cached_);
+    }
+    const Size end = data->file.size() - 2 * sizeof(Size);
+    const Size nr_spectra = readValue<Size>(base + end);
+    const Size nr_chromatograms = readValue<Size>(base + end + sizeof(Size));
+
+    // walk through all records once to build the index and to make sure that
+    // all records lie within the file
+    Size offset = header_size;
+    data->spectra_index.reserve(std::min(nr_spectra, end / spectrum_header_size));
+    for (Size i = 0; i < nr_spectra; ++i)
+    {
+      offset += Internal::CachedMzMLHandler::getSpectrumPadding(offset, data->version);
+      data->spectra_index.push_back(offset);
+      offset = parseRecord(base, offset, end, spectrum_header_size, nullptr, filename_cached_);
+    }
+    data->chrom_index.reserve(std::min(nr_chromatograms, end / chromatogram_header_size));
+    for (Size i = 0; i < nr_chromatograms; ++i)
+    {
+      offset += Internal::CachedMzMLHandler::getChromatogramPadding(offset, data->version);
+      data->chrom_index.push_back(offset);
+      offset = parseRecord(base, offset, end, chromatogram_header_size, nullptr, filename_cached_);
+    }
+
+    // load the meta data from disk
+    MzMLFile().load(filename, data->meta_ms_experiment);
+    if (data->meta_ms_experiment.size() != nr_spectra ||
+        data->meta_ms_experiment.getChromatograms().size() != nr_chromatograms)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Number of spectra or chromatograms in the meta data does not match the cached file. Aborting!", filename_);
+    }
+
+    // spectra are accessed in random order (OpenSWATH)
+    data->file.advise(MemoryMappedFile::AccessPattern::RANDOM);
+    data_ = data;
+  }
+
+  size_t MappedCachedMzML::getNrSpectra() const
+  {
+    return data_->spectra_index.size();
+  }
+
+  size_t MappedCachedMzML::getNrChromatograms() const
+  {
+    return data_->chrom_index.size();
+  }
+
+  const MSExperiment& MappedCachedMzML::getMetaData() const
+  {
+    return data_->meta_ms_experiment;
+  }
+
+  UInt32 MappedCachedMzML::getFileVersion() const
+  {
+    return data_->version;
+  }
+
+  bool MappedCachedMzML::providesViews() const
+  {
+    return data_->version >= 2;
+  }
+
+  void MappedCachedMzML::checkViews_() const
+  {
+    if (!providesViews())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached file '" + filename_cached_ + "' was written by an older version (" + String(data_->version) +
+        ") without aligned data arrays and cannot be accessed without copying. Re-create the cached file to enable views.");
+    }
+  }
+
+  MappedCachedMzML::SpectrumView MappedCachedMzML::getSpectrumView(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+    checkViews_();
+
+    const char* base = data_->file.data();
+    const Size offset = data_->spectra_index[id];
+
+    SpectrumView view;
+    view.ms_level = readValue<int>(base + offset + 2 * sizeof(Size));
+    view.rt = readValue<double>(base + offset + 2 * sizeof(Size) + sizeof(int));
+    recordViews(base, offset, data_->file.size(), spectrum_header_size, view.mz, view.intensity, view.extra_arrays, filename_cached_);
+    return view;
+  }
+
+  MappedCachedMzML::ChromatogramView MappedCachedMzML::getChromatogramView(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    checkViews_();
+
+    ChromatogramView view;
+    recordViews(data_->file.data(), data_->chrom_index[id], data_->file.size(), chromatogram_header_size,
+                view.rt, view.intensity, view.extra_arrays, filename_cached_);
+    return view;
+  }
+
+  std::vector<OpenSwath::BinaryDataArrayPtr> MappedCachedMzML::getSpectrumData(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    std::vector<ArrayLocation> arrays;
+    parseRecord(data_->file.data(), data_->spectra_index[id], data_->file.size(), spectrum_header_size, &arrays, filename_cached_);
+    return toDataArrays(arrays);
+  }
+
+  std::vector<OpenSwath::BinaryDataArrayPtr> MappedCachedMzML::getChromatogramData(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    std::vector<ArrayLocation> arrays;
+    parseRecord(data_->file.data(), data_->chrom_index[id], data_->file.size(), chromatogram_header_size, &arrays, filename_cached_);
+    return toDataArrays(arrays);
+  }
+
+  MSSpectrum MappedCachedMzML::getSpectrum(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    std::vector<OpenSwath::BinaryDataArrayPtr> data = getSpectrumData(id);
+    MSSpectrum spectrum = data_->meta_ms_experiment[id];
+    spectrum.reserve(data[0]->data.size());
+    for (Size j = 0; j < data[0]->data.size(); ++j)
+    {
+      spectrum.emplace_back(data[0]->data[j], data[1]->data[j]);
+    }
+    for (Size j = 2; j < data.size(); ++j)
+    {
+      spectrum.getFloatDataArrays().push_back(MSSpectrum::FloatDataArray());
+      spectrum.getFloatDataArrays().back().setName(data[j]->description);
+      spectrum.getFloatDataArrays().back().assign(data[j]->data.begin(), data[j]->data.end());
+    }
+    return spectrum;
+  }
+
+  MSChromatogram MappedCachedMzML::getChromatogram(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    std::vector<OpenSwath::BinaryDataArrayPtr> data = getChromatogramData(id);
+    MSChromatogram chromatogram = data_->meta_ms_experiment.getChromatograms()[id];
+    chromatogram.reserve(data[0]->data.size());
+    for (Size j = 0; j < data[0]->data.size(); ++j)
+    {
+      chromatogram.push_back(ChromatogramPeak(data[0]->data[j], data[1]->data[j]));
+    }
+    for (Size j = 2; j < data.size(); ++j)
+    {
+      chromatogram.getFloatDataArrays().push_back(MSChromatogram::FloatDataArray());
+      chromatogram.getFloatDataArrays().back().setName(data[j]->description);
+      chromatogram.getFloatDataArrays().back().assign(data[j]->data.begin(), data[j]->data.end());
+    }
+    return chromatogram;
+  }
+
+}
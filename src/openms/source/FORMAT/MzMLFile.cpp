@@ -34,6 +34,7 @@
 
 #include <OpenMS/FORMAT/MzMLFile.h>
 
+#include <OpenMS/FORMAT/HANDLERS/IndexedMzMLDecoder.h>
 #include <OpenMS/FORMAT/HANDLERS/MzMLHandler.h>
 #include <OpenMS/FORMAT/HANDLERS/XMLHandler.h>
 #include <OpenMS/FORMAT/CVMappingFile.h>
@@ -42,12 +43,48 @@
 #include <OpenMS/FORMAT/TextFile.h>
 #include <OpenMS/FORMAT/DATAACCESS/MSDataTransformingConsumer.h>
 #include <OpenMS/SYSTEM/File.h>
+#include <OpenMS/CONCEPT/LogStream.h>
 
+#include <algorithm>
 #include <sstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// Read the bytes [begin, end) of a file
+    std::string readFileRange_(std::ifstream& ifs, std::streampos begin, std::streampos end)
+    {
+      std::string buffer(static_cast<Size>(end - begin), '\0');
+      ifs.seekg(begin, ifs.beg);
+      ifs.read(&buffer[0], end - begin);
+      if (!ifs)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "",
+          "Could not read bytes " + String(static_cast<long long>(begin)) + " to " + String(static_cast<long long>(end)));
+      }
+      return buffer;
+    }
+
+    /// Replace the value of the count="..." attribute in an XML start tag
+    std::string setCountAttribute_(const std::string& tag, Size count)
+    {
+      Size start = tag.find(" count=\"");
+      if (start == std::string::npos)
+      {
+        return tag;
+      }
+      start += 8;
+      Size end = tag.find('"', start);
+      return tag.substr(0, start) + String(count) + tag.substr(end);
+    }
+  }
+
   MzMLFile::MzMLFile() :
     XMLFile("/SCHEMAS/mzML_1_10.xsd", "1.1.0"),
     indexed_schema_location_("/SCHEMAS/mzML_idx_1_10.xsd")
@@ -227,6 +264,219 @@ namespace OpenMS
     }
   }
 
+  void MzMLFile::transformParallel(const String& filename_in, Interfaces::IMSDataConsumer* consumer, bool skip_full_count, bool skip_first_pass)
+  {
+    if (!File::exists(filename_in))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_in);
+    }
+
+    // try to retrieve the offsets of all spectra and chromatograms from the index
+    IndexedMzMLDecoder decoder;
+    IndexedMzMLDecoder::OffsetVector spectra_index, chromatograms_index;
+    std::streampos index_offset = -1;
+    try
+    {
+      index_offset = decoder.findIndexListOffset(filename_in);
+    }
+    catch (Exception::ParseError&)
+    {
+      index_offset = -1;
+    }
+    bool use_index = index_offset != std::streampos(-1) &&
+                     decoder.parseOffsets(filename_in, index_offset, spectra_index, chromatograms_index) == 0 &&
+                     !(spectra_index.empty() && chromatograms_index.empty());
+
+    std::vector<std::streampos> spectra_offsets, chromatograms_offsets;
+    for (const auto& off : spectra_index) spectra_offsets.push_back(off.second);
+    for (const auto& off : chromatograms_index) chromatograms_offsets.push_back(off.second);
+    use_index = use_index &&
+                std::is_sorted(spectra_offsets.begin(), spectra_offsets.end()) &&
+                std::is_sorted(chromatograms_offsets.begin(), chromatograms_offsets.end());
+
+    if (!use_index)
+    {
+      OPENMS_LOG_DEBUG << "No usable index found in '" << filename_in << "', falling back to serial parsing." << std::endl;
+      transform(filename_in, consumer, skip_full_count, skip_first_pass);
+      return;
+    }
+
+    std::ifstream ifs(filename_in.c_str(), std::ios::binary);
+    const bool spectra_first = chromatograms_offsets.empty() ||
+                               (!spectra_offsets.empty() && spectra_offsets.front() < chromatograms_offsets.front());
+    const std::vector<std::streampos>& first_list = spectra_first ? spectra_offsets : chromatograms_offsets;
+    const std::vector<std::streampos>& second_list = spectra_first ? chromatograms_offsets : spectra_offsets;
+    const std::string first_name = spectra_first ? "spectrumList" : "chromatogramList";
+    const std::string second_name = spectra_first ? "chromatogramList" : "spectrumList";
+
+    // the start tag of the first list is located between the start of the file and its first element
+    std::string preamble = readFileRange_(ifs, 0, first_list.front());
+    Size first_tag_pos = preamble.rfind("<" + first_name);
+    if (first_tag_pos == std::string::npos)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_in, "Could not find <" + first_name + "> tag");
+    }
+    const std::string header = preamble.substr(0, first_tag_pos);
+    const std::string first_tag = preamble.substr(first_tag_pos);
+    preamble.clear();
+
+    std::string document_end = "</run>\n</mzML>\n";
+    if (header.find("<indexedmzML") != std::string::npos)
+    {
+      document_end += "</indexedmzML>\n";
+    }
+
+    // the start tag of the second list is located between the last element of the first list and its own first element
+    std::string second_tag;
+    if (!second_list.empty())
+    {
+      std::string between = readFileRange_(ifs, first_list.back(), second_list.front());
+      Size second_tag_pos = between.rfind("<" + second_name);
+      if (second_tag_pos == std::string::npos)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_in, "Could not find <" + second_name + "> tag");
+      }
+      second_tag = between.substr(second_tag_pos);
+    }
+
+    // the index holds the exact number of spectra and chromatograms and the header holds the meta-data,
+    // so the consumer is initialized without a serial pass through the file
+    if (!skip_first_pass)
+    {
+      PeakMap experimental_settings;
+      PeakFileOptions tmp_options(options_);
+      tmp_options.setMetadataOnly(true);
+      Internal::MzMLHandler handler(experimental_settings, filename_in, getVersion(), *this);
+      handler.setOptions(tmp_options);
+      parseBuffer_(header + document_end, &handler);
+      consumer->setExpectedSize(spectra_offsets.size(), chromatograms_offsets.size());
+      consumer->setExperimentalSettings(experimental_settings);
+    }
+
+    // Xerces must not be initialized concurrently by the parsers of the individual chunks
+    initializeParser_();
+
+    SignedSize progress = 0;
+    startProgress(0, spectra_offsets.size() + chromatograms_offsets.size(), "loading mzML");
+    transformListParallel_(ifs, filename_in, first_list, second_list.empty() ? index_offset : second_list.front(),
+      header, "</" + first_name + ">\n" + document_end, first_tag, spectra_first, consumer, progress);
+    if (!second_list.empty())
+    {
+      transformListParallel_(ifs, filename_in, second_list, index_offset,
+        header, "</" + second_name + ">\n" + document_end, second_tag, !spectra_first, consumer, progress);
+    }
+    endProgress();
+  }
+
+  void MzMLFile::transformListParallel_(std::ifstream& ifs,
+                                        const String& filename,
+                                        const std::vector<std::streampos>& offsets,
+                                        std::streampos list_end,
+                                        const std::string& header,
+                                        const std::string& footer,
+                                        const std::string& list_tag,
+                                        bool is_spectrum,
+                                        Interfaces::IMSDataConsumer* consumer,
+                                        SignedSize& progress)
+  {
+    const std::string element_end = is_spectrum ? "</spectrum>" : "</chromatogram>";
+    const Size chunk_size = std::max(Size(1), options_.getMaxDataPoolSize());
+    const Size nr_chunks = (offsets.size() + chunk_size - 1) / chunk_size;
+
+    Size nr_threads = 1;
+#ifdef _OPENMP
+    nr_threads = omp_get_max_threads();
+#endif
+    // keep a bounded number of chunks in flight
+    const Size batch_size = 2 * nr_threads;
+
+    for (Size batch_start = 0; batch_start < nr_chunks; batch_start += batch_size)
+    {
+      const Size batch_end = std::min(nr_chunks, batch_start + batch_size);
+
+      // read the raw XML of all chunks of this batch sequentially
+      std::vector<std::string> documents(batch_end - batch_start);
+      for (Size chunk = batch_start; chunk < batch_end; ++chunk)
+      {
+        const Size first = chunk * chunk_size;
+        const Size last = std::min(offsets.size(), first + chunk_size); // exclusive
+        const bool is_last_chunk = (last == offsets.size());
+        std::string data = readFileRange_(ifs, offsets[first], is_last_chunk ? list_end : offsets[last]);
+        if (is_last_chunk)
+        {
+          // cut off the end of the list (and everything that follows)
+          Size pos = data.rfind(element_end);
+          if (pos == std::string::npos)
+          {
+            throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Could not find " + element_end + " tag");
+          }
+          data.resize(pos + element_end.size());
+        }
+        std::string& doc = documents[chunk - batch_start];
+        doc.reserve(header.size() + list_tag.size() + data.size() + footer.size() + 1);
+        doc.append(header).append(setCountAttribute_(list_tag, last - first)).append(data).append("\n").append(footer);
+      }
+
+      // tokenize and decode all chunks concurrently
+      std::vector<PeakMap> maps(documents.size());
+      Size err_count = 0;
+      String error_message;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)documents.size(); ++i)
+      {
+        if (err_count) continue; // no need to parse further if already an error was encountered
+        try
+        {
+          ProgressLogger chunk_logger;
+          Internal::MzMLHandler handler(maps[i], filename, getVersion(), chunk_logger);
+          handler.setOptions(options_);
+          parseBuffer_(documents[i], &handler, false);
+          std::string().swap(documents[i]);
+        }
+        catch (Exception::BaseException& e)
+        {
+#pragma omp critical(MzMLFileParallelErrorHandling)
+          {
+            ++err_count;
+            error_message = e.what();
+          }
+        }
+        catch (...)
+        {
+#pragma omp atomic
+          ++err_count;
+        }
+      }
+      if (err_count != 0)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error during parallel parsing: '" + error_message + "'");
+      }
+
+      // hand the data to the consumer in file order
+      for (PeakMap& map : maps)
+      {
+        if (is_spectrum)
+        {
+          for (MSSpectrum& s : map)
+          {
+            consumer->consumeSpectrum(s);
+          }
+        }
+        else
+        {
+          for (MSChromatogram& c : map.getChromatograms())
+          {
+            consumer->consumeChromatogram(c);
+          }
+        }
+      }
+      progress += std::min(offsets.size(), batch_end * chunk_size) - std::min(offsets.size(), batch_start * chunk_size);
+      setProgress(progress);
+    }
+  }
+
   void MzMLFile::transformFirstPass_(const String& filename_in, Interfaces::IMSDataConsumer* consumer, bool skip_full_count)
   {
     // Create temporary objects and counters
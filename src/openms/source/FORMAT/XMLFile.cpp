@@ -187,15 +187,8 @@ private:
       }
     }
 
-    void XMLFile::parseBuffer_(const std::string & buffer, XMLHandler * handler)
+    void XMLFile::initializeParser_()
     {
-      // ensure handler->reset() is called to save memory (in case the XMLFile
-      // reader, e.g. FeatureXMLFile, is used again)
-      XMLCleaner_ clean(handler);
-
-      StringManager sm;
-
-      // initialize parser
       try
       {
         xercesc::XMLPlatformUtils::Initialize();
@@ -205,6 +198,21 @@ private:
         throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
             "", String("Error during initialization: ") + StringManager().convert(toCatch.getMessage()));
       }
+    }
+
+    void XMLFile::parseBuffer_(const std::string & buffer, XMLHandler * handler, bool initialize_parser)
+    {
+      // ensure handler->reset() is called to save memory (in case the XMLFile
+      // reader, e.g. FeatureXMLFile, is used again)
+      XMLCleaner_ clean(handler);
+
+      // initialize parser
+      if (initialize_parser)
+      {
+        initializeParser_();
+      }
+
+      StringManager sm;
 
       boost::shared_ptr< xercesc::SAX2XMLReader > parser(xercesc::XMLReaderFactory::createXMLReader());
       parser->setFeature(xercesc::XMLUni::fgSAX2CoreNameSpaces, false);
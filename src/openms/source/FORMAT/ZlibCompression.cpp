@@ -72,6 +72,51 @@ namespace OpenMS
     compressed.resize(compressed_length);
   }
 
+  void ZlibCompression::compressData(const void * raw_data, size_t nr_bytes, std::string& compressed, int level)
+  {
+    compressed.clear();
+
+    unsigned long sourceLen =   (unsigned long)nr_bytes;
+    unsigned long compressed_length = sourceLen + (sourceLen >> 12) + (sourceLen >> 14) + 11; // see compressString()
+
+    int zlib_error;
+    do
+    {
+      compressed.resize(compressed_length);
+      zlib_error = compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_length, reinterpret_cast<const Bytef*>(raw_data), sourceLen, level);
+
+      switch (zlib_error)
+      {
+      case Z_MEM_ERROR:
+        throw Exception::OutOfMemory(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, compressed_length);
+
+      case Z_BUF_ERROR:
+        compressed_length *= 2;
+      }
+    } while (zlib_error == Z_BUF_ERROR);
+
+    if (zlib_error != Z_OK)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Compression error?");
+    }
+    compressed.resize(compressed_length);
+  }
+
+  void ZlibCompression::uncompressData(const void * compressed_data, size_t nr_bytes, void * raw_data, size_t raw_size)
+  {
+    unsigned long uncompressed_length = (unsigned long)raw_size;
+    int zlib_error = uncompress(reinterpret_cast<Bytef*>(raw_data), &uncompressed_length, reinterpret_cast<const Bytef*>(compressed_data), (unsigned long)nr_bytes);
+
+    if (zlib_error == Z_MEM_ERROR)
+    {
+      throw Exception::OutOfMemory(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, raw_size);
+    }
+    if (zlib_error != Z_OK || uncompressed_length != raw_size)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+    }
+  }
+
   void ZlibCompression::compressString(const QByteArray& raw_data, QByteArray& compressed_data)
   {
     compressed_data = qCompress(raw_data);
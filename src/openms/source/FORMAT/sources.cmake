@@ -10,6 +10,7 @@ Bzip2Ifstream.cpp
 Bzip2InputStream.cpp
 CachedMzML.cpp
 ChromeleonFile.cpp
+ColMassFile.cpp
 CompressedInputSource.cpp
 CVMappingFile.cpp
 ConsensusXMLFile.cpp
@@ -19,6 +20,7 @@ DTA2DFile.cpp
 DTAFile.cpp
 EDTAFile.cpp
 ExperimentalDesignFile.cpp
+FASTAArena.cpp
 FASTAFile.cpp
 FeatureXMLFile.cpp
 FileHandler.cpp
@@ -39,6 +41,7 @@ KroenikFile.cpp
 LibSVMEncoder.cpp
 MRMFeaturePickerFile.cpp
 MRMFeatureQCFile.cpp
+MappedCachedMzML.cpp
 MS2File.cpp
 MSNumpressCoder.cpp
 MSPFile.cpp
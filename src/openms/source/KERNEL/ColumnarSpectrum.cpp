@@ -0,0 +1,519 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
+
+#include <OpenMS/IONMOBILITY/IMDataConverter.h>
+#include <OpenMS/IONMOBILITY/IMTypes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace OpenMS
+{
+  ColumnarSpectrum::ColumnarSpectrum() :
+    SpectrumSettings(),
+    mz_(),
+    mz_float_(),
+    intensity_(),
+    mz_storage_(MZStorage::DOUBLE),
+    mz_offset_(0.0),
+    retention_time_(-1),
+    drift_time_(IMTypes::DRIFTTIME_NOT_SET),
+    drift_time_unit_(DriftTimeUnit::NONE),
+    ms_level_(1),
+    name_(),
+    float_data_arrays_(),
+    string_data_arrays_(),
+    integer_data_arrays_()
+  {
+  }
+
+  ColumnarSpectrum::ColumnarSpectrum(const MSSpectrum& spectrum, MZStorage mz_storage) :
+    SpectrumSettings(spectrum),
+    mz_(),
+    mz_float_(),
+    intensity_(),
+    mz_storage_(MZStorage::DOUBLE),
+    mz_offset_(0.0),
+    retention_time_(spectrum.getRT()),
+    drift_time_(spectrum.getDriftTime()),
+    drift_time_unit_(spectrum.getDriftTimeUnit()),
+    ms_level_(spectrum.getMSLevel()),
+    name_(spectrum.getName()),
+    float_data_arrays_(spectrum.getFloatDataArrays()),
+    string_data_arrays_(spectrum.getStringDataArrays()),
+    integer_data_arrays_(spectrum.getIntegerDataArrays())
+  {
+    mz_.resize(spectrum.size());
+    intensity_.resize(spectrum.size());
+    for (Size i = 0; i < spectrum.size(); ++i)
+    {
+      mz_[i] = spectrum[i].getMZ();
+      intensity_[i] = spectrum[i].getIntensity();
+    }
+    if (mz_storage != MZStorage::DOUBLE)
+    {
+      setMZStorage(mz_storage);
+    }
+  }
+
+  bool ColumnarSpectrum::operator==(const ColumnarSpectrum& rhs) const
+  {
+    if (size() != rhs.size())
+    {
+      return false;
+    }
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+    for (Size i = 0; i < size(); ++i)
+    {
+      if (getMZ(i) != rhs.getMZ(i))
+      {
+        return false;
+      }
+    }
+    //name_ can differ => it is not checked
+    return intensity_ == rhs.intensity_ &&
+           SpectrumSettings::operator==(rhs) &&
+           retention_time_ == rhs.retention_time_ &&
+           drift_time_ == rhs.drift_time_ &&
+           drift_time_unit_ == rhs.drift_time_unit_ &&
+           ms_level_ == rhs.ms_level_ &&
+           float_data_arrays_ == rhs.float_data_arrays_ &&
+           string_data_arrays_ == rhs.string_data_arrays_ &&
+           integer_data_arrays_ == rhs.integer_data_arrays_;
+#pragma clang diagnostic pop
+  }
+
+  MSSpectrum ColumnarSpectrum::toMSSpectrum() const
+  {
+    MSSpectrum spectrum;
+    spectrum.SpectrumSettings::operator=(*this);
+    spectrum.setRT(retention_time_);
+    spectrum.setDriftTime(drift_time_);
+    spectrum.setDriftTimeUnit(drift_time_unit_);
+    spectrum.setMSLevel(ms_level_);
+    spectrum.setName(name_);
+    spectrum.setFloatDataArrays(float_data_arrays_);
+    spectrum.setStringDataArrays(string_data_arrays_);
+    spectrum.setIntegerDataArrays(integer_data_arrays_);
+
+    spectrum.resize(size());
+    for (Size i = 0; i < size(); ++i)
+    {
+      spectrum[i].setMZ(getMZ(i));
+      spectrum[i].setIntensity(intensity_[i]);
+    }
+    return spectrum;
+  }
+
+  double ColumnarSpectrum::getRT() const
+  {
+    return retention_time_;
+  }
+
+  void ColumnarSpectrum::setRT(double rt)
+  {
+    retention_time_ = rt;
+  }
+
+  double ColumnarSpectrum::getDriftTime() const
+  {
+    return drift_time_;
+  }
+
+  void ColumnarSpectrum::setDriftTime(double dt)
+  {
+    drift_time_ = dt;
+  }
+
+  DriftTimeUnit ColumnarSpectrum::getDriftTimeUnit() const
+  {
+    return drift_time_unit_;
+  }
+
+  void ColumnarSpectrum::setDriftTimeUnit(DriftTimeUnit dt)
+  {
+    drift_time_unit_ = dt;
+  }
+
+  UInt ColumnarSpectrum::getMSLevel() const
+  {
+    return ms_level_;
+  }
+
+  void ColumnarSpectrum::setMSLevel(UInt ms_level)
+  {
+    ms_level_ = ms_level;
+  }
+
+  const String& ColumnarSpectrum::getName() const
+  {
+    return name_;
+  }
+
+  void ColumnarSpectrum::setName(const String& name)
+  {
+    name_ = name;
+  }
+
+  bool ColumnarSpectrum::containsIMData() const
+  {
+    DriftTimeUnit unit;
+    for (const auto& fda : float_data_arrays_)
+    {
+      if (IMDataConverter::getIMUnit(fda, unit))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::pair<Size, DriftTimeUnit> ColumnarSpectrum::getIMData() const
+  {
+    DriftTimeUnit unit;
+    for (Size index = 0; index < float_data_arrays_.size(); ++index)
+    {
+      if (IMDataConverter::getIMUnit(float_data_arrays_[index], unit))
+      {
+        return {index, unit};
+      }
+    }
+    throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                        "Cannot get ion mobility data. No float array with the correct name available."
+                                        " Number of float arrays: " +
+                                            String(float_data_arrays_.size()));
+  }
+
+  void ColumnarSpectrum::reserve(Size n)
+  {
+    if (mz_storage_ == MZStorage::DOUBLE)
+    {
+      mz_.reserve(n);
+    }
+    else
+    {
+      mz_float_.reserve(n);
+    }
+    intensity_.reserve(n);
+  }
+
+  void ColumnarSpectrum::setMZStorage(MZStorage mz_storage)
+  {
+    double offset = 0.0;
+    if (mz_storage == MZStorage::FLOAT_OFFSET && !empty())
+    {
+      double min_mz = getMZ(0), max_mz = getMZ(0);
+      for (Size i = 1; i < size(); ++i)
+      {
+        min_mz = std::min(min_mz, getMZ(i));
+        max_mz = std::max(max_mz, getMZ(i));
+      }
+      offset = (min_mz + max_mz) / 2;
+    }
+    setMZStorage(mz_storage, offset);
+  }
+
+  void ColumnarSpectrum::setMZStorage(MZStorage mz_storage, double mz_offset)
+  {
+    if (mz_storage == MZStorage::DOUBLE)
+    {
+      if (mz_storage_ == MZStorage::DOUBLE)
+      {
+        return;
+      }
+      mz_.resize(mz_float_.size());
+      for (Size i = 0; i < mz_float_.size(); ++i)
+      {
+        mz_[i] = mz_offset_ + mz_float_[i];
+      }
+      mz_float_.clear();
+      mz_float_.shrink_to_fit();
+      mz_offset_ = 0.0;
+    }
+    else
+    {
+      // convert to double first, then to the new base value
+      std::vector<double> mz;
+      if (mz_storage_ == MZStorage::DOUBLE)
+      {
+        mz.swap(mz_);
+      }
+      else
+      {
+        mz.resize(mz_float_.size());
+        for (Size i = 0; i < mz_float_.size(); ++i)
+        {
+          mz[i] = mz_offset_ + mz_float_[i];
+        }
+      }
+      mz_.clear();
+      mz_.shrink_to_fit();
+      mz_float_.resize(mz.size());
+      for (Size i = 0; i < mz.size(); ++i)
+      {
+        mz_float_[i] = float(mz[i] - mz_offset);
+      }
+      mz_offset_ = mz_offset;
+    }
+    mz_storage_ = mz_storage;
+  }
+
+  Size ColumnarSpectrum::getPeakMemoryUsage() const
+  {
+    return mz_.capacity() * sizeof(double) + mz_float_.capacity() * sizeof(float) + intensity_.capacity() * sizeof(float);
+  }
+
+  void ColumnarSpectrum::sortByPosition()
+  {
+    if (isSorted())
+    {
+      return;
+    }
+    std::vector<Size> indices(size());
+    std::iota(indices.begin(), indices.end(), 0);
+    if (mz_storage_ == MZStorage::DOUBLE)
+    {
+      std::stable_sort(indices.begin(), indices.end(), [this](Size a, Size b) { return mz_[a] < mz_[b]; });
+    }
+    else
+    {
+      std::stable_sort(indices.begin(), indices.end(), [this](Size a, Size b) { return mz_float_[a] < mz_float_[b]; });
+    }
+    select_(indices);
+  }
+
+  bool ColumnarSpectrum::isSorted() const
+  {
+    if (mz_storage_ == MZStorage::DOUBLE)
+    {
+      return std::is_sorted(mz_.begin(), mz_.end());
+    }
+    return std::is_sorted(mz_float_.begin(), mz_float_.end());
+  }
+
+  Size ColumnarSpectrum::lowerBound_(CoordinateType mz) const
+  {
+    if (mz_storage_ == MZStorage::DOUBLE)
+    {
+      return std::lower_bound(mz_.begin(), mz_.end(), mz) - mz_.begin();
+    }
+    // compare the reconstructed values, the offsets are monotonic in them
+    const double offset = mz_offset_;
+    return std::lower_bound(mz_float_.begin(), mz_float_.end(), mz,
+                            [offset](float stored, double value) { return offset + stored < value; }) - mz_float_.begin();
+  }
+
+  Size ColumnarSpectrum::upperBound_(CoordinateType mz) const
+  {
+    if (mz_storage_ == MZStorage::DOUBLE)
+    {
+      return std::upper_bound(mz_.begin(), mz_.end(), mz) - mz_.begin();
+    }
+    const double offset = mz_offset_;
+    return std::upper_bound(mz_float_.begin(), mz_float_.end(), mz,
+                            [offset](double value, float stored) { return value < offset + stored; }) - mz_float_.begin();
+  }
+
+  Size ColumnarSpectrum::findNearest(CoordinateType mz) const
+  {
+    // no peak => no search
+    if (empty())
+    {
+      throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "There must be at least one peak to determine the nearest peak!");
+    }
+    // search for position for inserting
+    Size i = lowerBound_(mz);
+    // border cases
+    if (i == 0)
+    {
+      return 0;
+    }
+    if (i == size())
+    {
+      return size() - 1;
+    }
+    // the peak before or the current peak are closest
+    if (std::fabs(getMZ(i) - mz) < std::fabs(getMZ(i - 1) - mz))
+    {
+      return i;
+    }
+    return i - 1;
+  }
+
+  Int ColumnarSpectrum::findNearest(CoordinateType mz, CoordinateType tolerance) const
+  {
+    if (empty())
+    {
+      return -1;
+    }
+    Size i = findNearest(mz);
+    const double found_mz = getMZ(i);
+    if (found_mz >= mz - tolerance && found_mz <= mz + tolerance)
+    {
+      return static_cast<Int>(i);
+    }
+    return -1;
+  }
+
+  ColumnarSpectrum::ConstIterator ColumnarSpectrum::MZBegin(CoordinateType mz) const
+  {
+    return ConstIterator(this, lowerBound_(mz));
+  }
+
+  ColumnarSpectrum::ConstIterator ColumnarSpectrum::MZEnd(CoordinateType mz) const
+  {
+    return ConstIterator(this, upperBound_(mz));
+  }
+
+  double ColumnarSpectrum::sumIntensity(CoordinateType mz_min, CoordinateType mz_max) const
+  {
+    const Size first = lowerBound_(mz_min);
+    const Size last = upperBound_(mz_max);
+    double sum = 0.0;
+    for (Size i = first; i < last; ++i)
+    {
+      sum += intensity_[i];
+    }
+    return sum;
+  }
+
+  double ColumnarSpectrum::calculateTIC() const
+  {
+    return std::accumulate(intensity_.begin(), intensity_.end(), 0.0);
+  }
+
+  void ColumnarSpectrum::clear(bool clear_meta_data)
+  {
+    mz_.clear();
+    mz_float_.clear();
+    intensity_.clear();
+    float_data_arrays_.clear();
+    string_data_arrays_.clear();
+    integer_data_arrays_.clear();
+
+    if (clear_meta_data)
+    {
+      mz_.shrink_to_fit();
+      mz_float_.shrink_to_fit();
+      intensity_.shrink_to_fit();
+      float_data_arrays_.shrink_to_fit();
+      string_data_arrays_.shrink_to_fit();
+      integer_data_arrays_.shrink_to_fit();
+
+      this->SpectrumSettings::operator=(SpectrumSettings()); // no "clear" method
+      mz_storage_ = MZStorage::DOUBLE;
+      mz_offset_ = 0.0;
+      retention_time_ = -1.0;
+      drift_time_ = IMTypes::DRIFTTIME_NOT_SET;
+      drift_time_unit_ = DriftTimeUnit::NONE;
+      ms_level_ = 1;
+      name_.clear();
+      name_.shrink_to_fit();
+    }
+  }
+
+  void ColumnarSpectrum::select_(const std::vector<Size>& indices)
+  {
+    const Size peaks_old = size();
+
+    auto apply = [&indices](auto& column)
+    {
+      typename std::decay<decltype(column)>::type tmp;
+      tmp.reserve(indices.size());
+      for (Size i : indices)
+      {
+        tmp.push_back(std::move(column[i]));
+      }
+      column.swap(tmp);
+    };
+
+    if (mz_storage_ == MZStorage::DOUBLE)
+    {
+      apply(mz_);
+    }
+    else
+    {
+      apply(mz_float_);
+    }
+    apply(intensity_);
+
+    for (Size i = 0; i < float_data_arrays_.size(); ++i)
+    {
+      if (float_data_arrays_[i].empty())
+      {
+        continue;
+      }
+      if (float_data_arrays_[i].size() != peaks_old)
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FloatDataArray[" + String(i) + "] size (" +
+                                      String(float_data_arrays_[i].size()) + ") does not match spectrum size (" + String(peaks_old) + ")");
+      }
+      std::vector<float>& column = float_data_arrays_[i];
+      apply(column);
+    }
+    for (Size i = 0; i < string_data_arrays_.size(); ++i)
+    {
+      if (string_data_arrays_[i].empty())
+      {
+        continue;
+      }
+      if (string_data_arrays_[i].size() != peaks_old)
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "StringDataArray[" + String(i) + "] size (" +
+                                      String(string_data_arrays_[i].size()) + ") does not match spectrum size (" + String(peaks_old) + ")");
+      }
+      std::vector<String>& column = string_data_arrays_[i];
+      apply(column);
+    }
+    for (Size i = 0; i < integer_data_arrays_.size(); ++i)
+    {
+      if (integer_data_arrays_[i].empty())
+      {
+        continue;
+      }
+      if (integer_data_arrays_[i].size() != peaks_old)
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "IntegerDataArray[" + String(i) + "] size (" +
+                                      String(integer_data_arrays_[i].size()) + ") does not match spectrum size (" + String(peaks_old) + ")");
+      }
+      std::vector<Int>& column = integer_data_arrays_[i];
+      apply(column);
+    }
+  }
+
+} // namespace OpenMS
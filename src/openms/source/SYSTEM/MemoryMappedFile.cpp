@@ -0,0 +1,245 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+
+#ifdef OPENMS_WINDOWSPLATFORM
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace OpenMS
+{
+
+  MemoryMappedFile::MemoryMappedFile() :
+    data_(nullptr),
+    size_(0),
+    is_open_(false)
+  {
+  }
+
+  MemoryMappedFile::MemoryMappedFile(const String& filename) :
+    MemoryMappedFile()
+  {
+    open(filename);
+  }
+
+  MemoryMappedFile::~MemoryMappedFile()
+  {
+    close();
+  }
+
+  MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& rhs) noexcept :
+    data_(rhs.data_),
+    size_(rhs.size_),
+    is_open_(rhs.is_open_),
+    filename_(std::move(rhs.filename_))
+  {
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+    rhs.is_open_ = false;
+  }
+
+  MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& rhs) noexcept
+  {
+    if (&rhs == this)
+    {
+      return *this;
+    }
+    close();
+    data_ = rhs.data_;
+    size_ = rhs.size_;
+    is_open_ = rhs.is_open_;
+    filename_ = std::move(rhs.filename_);
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+    rhs.is_open_ = false;
+    return *this;
+  }
+
+  void MemoryMappedFile::open(const String& filename)
+  {
+    close();
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+#ifdef OPENMS_WINDOWSPLATFORM
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+      CloseHandle(file);
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    if (file_size.QuadPart > 0)
+    {
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping == nullptr)
+      {
+        CloseHandle(file);
+        throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+      }
+      // the view keeps the mapping alive, both handles can be closed right away
+      void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+      if (view == nullptr)
+      {
+        CloseHandle(file);
+        throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+      }
+      data_ = static_cast<char*>(view);
+    }
+    CloseHandle(file);
+    size_ = static_cast<Size>(file_size.QuadPart);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0)
+    {
+      ::close(fd);
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    if (file_stat.st_size > 0)
+    {
+      // the mapping keeps its own reference to the file, the descriptor can be closed right away
+      void* view = ::mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (view == MAP_FAILED)
+      {
+        ::close(fd);
+        throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+      }
+      data_ = static_cast<char*>(view);
+    }
+    ::close(fd);
+    size_ = static_cast<Size>(file_stat.st_size);
+#endif
+
+    is_open_ = true;
+    filename_ = filename;
+  }
+
+  void MemoryMappedFile::close()
+  {
+    if (data_ != nullptr)
+    {
+#ifdef OPENMS_WINDOWSPLATFORM
+      UnmapViewOfFile(data_);
+#else
+      ::munmap(data_, size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+    filename_.clear();
+  }
+
+  bool MemoryMappedFile::isOpen() const
+  {
+    return is_open_;
+  }
+
+  const char* MemoryMappedFile::data() const
+  {
+    return data_;
+  }
+
+  Size MemoryMappedFile::size() const
+  {
+    return size_;
+  }
+
+  const String& MemoryMappedFile::getFilename() const
+  {
+    return filename_;
+  }
+
+  void MemoryMappedFile::advise(AccessPattern pattern) const
+  {
+    if (data_ == nullptr)
+    {
+      return;
+    }
+#ifndef OPENMS_WINDOWSPLATFORM
+    int advice = MADV_NORMAL;
+    if (pattern == AccessPattern::SEQUENTIAL)
+    {
+      advice = MADV_SEQUENTIAL;
+    }
+    else if (pattern == AccessPattern::RANDOM)
+    {
+      advice = MADV_RANDOM;
+    }
+    ::madvise(data_, size_, advice);
+#else
+    (void)pattern;
+#endif
+  }
+
+  void MemoryMappedFile::prefetch(Size offset, Size length) const
+  {
+    if (data_ == nullptr || offset >= size_)
+    {
+      return;
+    }
+    length = std::min(length, size_ - offset);
+#ifndef OPENMS_WINDOWSPLATFORM
+    // madvise requires a page-aligned start address
+    const Size page_size = static_cast<Size>(::sysconf(_SC_PAGESIZE));
+    const Size aligned_offset = offset - (offset % page_size);
+    ::madvise(data_ + aligned_offset, length + (offset - aligned_offset), MADV_WILLNEED);
+#endif
+  }
+
+} // namespace OpenMS
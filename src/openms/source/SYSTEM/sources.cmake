@@ -7,6 +7,7 @@ ExternalProcess.cpp
 File.cpp
 FileWatcher.cpp
 JavaInfo.cpp
+MemoryMappedFile.cpp
 NetworkGetRequest.cpp
 PythonInfo.cpp
 RWrapper.cpp
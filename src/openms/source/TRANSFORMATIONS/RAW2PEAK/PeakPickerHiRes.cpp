@@ -43,10 +43,51 @@
 #include <OpenMS/KERNEL/SpectrumHelper.h>
 
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 namespace OpenMS
 {
+  namespace
+  {
+    /**
+      @brief Sets the intensity of the raw data point at @p mz (inserting it if needed)
+
+      The raw data points of a peak are kept as two parallel vectors sorted by m/z; an existing point with the
+      same m/z is overwritten, just like with std::map::operator[].
+    */
+    void setRawDataPoint_(std::vector<double>& raw_mz, std::vector<double>& raw_int, double mz, double intensity)
+    {
+      auto it = std::lower_bound(raw_mz.begin(), raw_mz.end(), mz);
+      const Size pos = it - raw_mz.begin();
+      if (it != raw_mz.end() && *it == mz)
+      {
+        raw_int[pos] = intensity;
+        return;
+      }
+      raw_mz.insert(it, mz);
+      raw_int.insert(raw_int.begin() + pos, intensity);
+    }
+
+    /// Remembers the exception thrown while processing element @p index, unless an earlier element failed already
+    void storeFirstError_(std::exception_ptr& error, Size& error_index, Size index)
+    {
+      #pragma omp critical (PeakPickerHiRes_error)
+      {
+        if (!error || index < error_index)
+        {
+          error = std::current_exception();
+          error_index = index;
+        }
+      }
+    }
+  }
+
   PeakPickerHiRes::PeakPickerHiRes() :
     DefaultParamHandler("PeakPickerHiRes"),
     ProgressLogger()
@@ -124,6 +165,35 @@ namespace OpenMS
     pick_(input, output, boundaries, check_spacings);
   }
 
+  void PeakPickerHiRes::pick(const ColumnarSpectrum& input, ColumnarSpectrum& output) const
+  {
+    std::vector<PeakBoundary> boundaries;
+    pick(input, output, boundaries);
+  }
+
+  void PeakPickerHiRes::pick(const ColumnarSpectrum& input, ColumnarSpectrum& output, std::vector<PeakBoundary>& boundaries, bool check_spacings) const
+  {
+    // copy meta data of the input spectrum
+    output.clear(true);
+    output.SpectrumSettings::operator=(input);
+    output.setRT(input.getRT());
+    output.setDriftTime(input.getDriftTime());
+    output.setDriftTimeUnit(input.getDriftTimeUnit());
+    output.setMSLevel(input.getMSLevel());
+    output.setName(input.getName());
+    output.setType(SpectrumSettings::CENTROID);
+
+    int im_data_index = -1;
+    if (input.containsIMData())
+    {
+      // will throw if IM float data array is missing
+      const auto [tmp_index, im_unit] = input.getIMData();
+      im_data_index = tmp_index;
+    }
+
+    pick_(input, output, boundaries, check_spacings, im_data_index);
+  }
+
   template <typename ContainerType>
   void PeakPickerHiRes::pick_(const ContainerType& input,
                               ContainerType& output,
@@ -172,6 +242,9 @@ namespace OpenMS
       snt.init(input);
     }
 
+    // raw data points of the current peak, sorted by m/z (reused for all peaks of the spectrum)
+    std::vector<double> raw_mz, raw_int;
+
     // find local maxima in profile data
     for (Size i = 2; i < input.size() - 2; ++i)
     {
@@ -242,12 +315,13 @@ namespace OpenMS
           continue;
         }
 
-        std::map<double, double> peak_raw_data;
+        raw_mz.clear();
+        raw_int.clear();
         double weighted_im = 0;
 
-        peak_raw_data[central_peak_mz] = central_peak_int;
-        peak_raw_data[left_neighbor_mz] = left_neighbor_int;
-        peak_raw_data[right_neighbor_mz] = right_neighbor_int;
+        setRawDataPoint_(raw_mz, raw_int, central_peak_mz, central_peak_int);
+        setRawDataPoint_(raw_mz, raw_int, left_neighbor_mz, left_neighbor_int);
+        setRawDataPoint_(raw_mz, raw_int, right_neighbor_mz, right_neighbor_int);
 
         if (has_im)
         {
@@ -268,9 +342,9 @@ namespace OpenMS
           (i - k + 1 > 0) && 
           !previous_zero_left && 
           (missing_left <= missing_) && 
-          (input[i - k].getIntensity() <= peak_raw_data.begin()->second) &&
+          (input[i - k].getIntensity() <= raw_int.front()) &&
           (!check_spacings || 
-          (peak_raw_data.begin()->first - input[i - k].getMZ() < spacing_difference_gap_ * min_spacing)))
+          (raw_mz.front() - input[i - k].getMZ() < spacing_difference_gap_ * min_spacing)))
         {
           double act_snt_lk = 0.0;
 
@@ -281,9 +355,9 @@ namespace OpenMS
 
           if ((act_snt_lk >= signal_to_noise_) && 
             (!check_spacings ||
-            (peak_raw_data.begin()->first - input[i - k].getMZ() < spacing_difference_ * min_spacing)))
+            (raw_mz.front() - input[i - k].getMZ() < spacing_difference_ * min_spacing)))
           {
-            peak_raw_data[input[i - k].getMZ()] = input[i - k].getIntensity();
+            setRawDataPoint_(raw_mz, raw_int, input[i - k].getMZ(), input[i - k].getIntensity());
             if (has_im) weighted_im += input.getFloatDataArrays()[im_data_index][i - k] * input[i - k].getIntensity();
           }
           else
@@ -291,7 +365,7 @@ namespace OpenMS
             ++missing_left;
             if (missing_left <= missing_)
             {
-              peak_raw_data[input[i - k].getMZ()] = input[i - k].getIntensity();
+              setRawDataPoint_(raw_mz, raw_int, input[i - k].getMZ(), input[i - k].getIntensity());
               if (has_im) weighted_im += input.getFloatDataArrays()[im_data_index][i - k] * input[i - k].getIntensity();
             }
           }
@@ -311,9 +385,9 @@ namespace OpenMS
         while ((i + k < input.size()) && 
           !previous_zero_right && 
           (missing_right <= missing_) && 
-          (input[i + k].getIntensity() <= peak_raw_data.rbegin()->second) &&
+          (input[i + k].getIntensity() <= raw_int.back()) &&
           (!check_spacings ||
-          (input[i + k].getMZ() - peak_raw_data.rbegin()->first < spacing_difference_gap_ * min_spacing)))
+          (input[i + k].getMZ() - raw_mz.back() < spacing_difference_gap_ * min_spacing)))
         {
           double act_snt_rk = 0.0;
 
@@ -324,9 +398,9 @@ namespace OpenMS
 
           if ((act_snt_rk >= signal_to_noise_) && 
             (!check_spacings ||
-            (input[i + k].getMZ() - peak_raw_data.rbegin()->first < spacing_difference_ * min_spacing)))
+            (input[i + k].getMZ() - raw_mz.back() < spacing_difference_ * min_spacing)))
           {
-            peak_raw_data[input[i + k].getMZ()] = input[i + k].getIntensity();
+            setRawDataPoint_(raw_mz, raw_int, input[i + k].getMZ(), input[i + k].getIntensity());
             if (has_im) weighted_im += input.getFloatDataArrays()[im_data_index][i + k] * input[i + k].getIntensity();
           }
           else
@@ -334,7 +408,7 @@ namespace OpenMS
             ++missing_right;
             if (missing_right <= missing_)
             {
-              peak_raw_data[input[i + k].getMZ()] = input[i + k].getIntensity();
+              setRawDataPoint_(raw_mz, raw_int, input[i + k].getMZ(), input[i + k].getIntensity());
               if (has_im) weighted_im += input.getFloatDataArrays()[im_data_index][i + k] * input[i + k].getIntensity();
             }
           }
@@ -345,11 +419,11 @@ namespace OpenMS
         }
 
         // skip if the minimal number of 3 points for fitting is not reached
-        if (peak_raw_data.size() < 3)
+        if (raw_mz.size() < 3)
         {
           continue;
         }
-        CubicSpline2d peak_spline (peak_raw_data);
+        CubicSpline2d peak_spline (raw_mz, raw_int);
 
         // calculate maximum by evaluating the spline's 1st derivative
         // (bisection method)
@@ -367,7 +441,7 @@ namespace OpenMS
           threshold = 0.01 * fwhm_int;
           double mz_mid, int_mid; 
           // left:
-          double mz_left = peak_raw_data.begin()->first;
+          double mz_left = raw_mz.front();
           double mz_center = max_peak_mz;
           if (peak_spline.eval(mz_left) > fwhm_int)
           { // the spline ends before half max is reached -- take the leftmost point (probably an underestimation)
@@ -392,7 +466,7 @@ namespace OpenMS
           const double fwhm_left_mz = mz_mid;
 
           // right ...
-          double mz_right = peak_raw_data.rbegin()->first;
+          double mz_right = raw_mz.back();
           mz_center = max_peak_mz;
           if (peak_spline.eval(mz_right) > fwhm_int)
           { // the spline ends before half max is reached -- take the rightmost point (probably an underestimation)
@@ -424,7 +498,7 @@ namespace OpenMS
         if (has_im)
         {
           double total_intensity(0);
-          for (const auto& t : peak_raw_data) {total_intensity += t.second;}
+          for (double intensity : raw_int) {total_intensity += intensity;}
           output.getFloatDataArrays()[out_im_index].push_back(weighted_im / total_intensity);
         }
 
@@ -478,16 +552,20 @@ namespace OpenMS
     Size progress = 0;
     startProgress(0, input.size() + input.getChromatograms().size(), "picking peaks");
 
-    // MSLevel -> stats
-    map<int, SpectraPickInfo> pick_info;
+    // spectra and chromatograms are picked in parallel; boundaries are stored per scan first and appended in input
+    // order afterwards. The first exception (in input order) is rethrown after the parallel loop.
+    std::vector<std::vector<PeakBoundary> > scan_boundaries(input.size());
+    std::vector<char> scan_picked(input.size(), 0);
+    std::exception_ptr error;
+    Size error_index = 0;
 
-    if (input.getNrSpectra() > 0)
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize scan_idx = 0; scan_idx < SignedSize(input.size()); ++scan_idx)
     {
-      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      try
       {
-        bool was_picked{false};
         // auto mode
-        if (ms_levels_.empty()) 
+        if (ms_levels_.empty())
         {
           SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType(true); // uses meta-info and inspects data if needed
           if (spectrum_type == SpectrumSettings::CENTROID)
@@ -496,45 +574,77 @@ namespace OpenMS
           }
           else
           {
-            std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
-            pick(input[scan_idx], output[scan_idx], boundaries_s);
-            was_picked = true;
-            boundaries_spec.push_back(std::move(boundaries_s));
+            pick(input[scan_idx], output[scan_idx], scan_boundaries[scan_idx]);
+            scan_picked[scan_idx] = true;
           }
         }
         // manual mode
-        else if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel())) 
+        else if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()))
         {
           output[scan_idx] = input[scan_idx];
         }
         else
         {
-          std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
           SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType(true); // uses meta-info and inspects data if needed
           if (spectrum_type == SpectrumSettings::CENTROID && check_spectrum_type)
           {
             throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
           }
 
-          pick(input[scan_idx], output[scan_idx], boundaries_s);
-          was_picked = true;
-          boundaries_spec.push_back(std::move(boundaries_s));
+          pick(input[scan_idx], output[scan_idx], scan_boundaries[scan_idx]);
+          scan_picked[scan_idx] = true;
         }
-        pick_info[input[scan_idx].getMSLevel()].picked += was_picked;
-        ++pick_info[input[scan_idx].getMSLevel()].total;
-        setProgress(++progress);
       }
+      catch (...)
+      {
+        storeFirstError_(error, error_index, scan_idx);
+      }
+      #pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    }
+    if (error)
+    {
+      std::rethrow_exception(error);
     }
 
+    // MSLevel -> stats
+    map<int, SpectraPickInfo> pick_info;
+    for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+    {
+      if (scan_picked[scan_idx])
+      {
+        boundaries_spec.push_back(std::move(scan_boundaries[scan_idx]));
+      }
+      pick_info[input[scan_idx].getMSLevel()].picked += scan_picked[scan_idx];
+      ++pick_info[input[scan_idx].getMSLevel()].total;
+    }
 
-    for (Size i = 0; i < input.getChromatograms().size(); ++i)
+    std::vector<MSChromatogram> chromatograms(input.getChromatograms().size());
+    std::vector<std::vector<PeakBoundary> > chrom_boundaries(chromatograms.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize i = 0; i < SignedSize(chromatograms.size()); ++i)
     {
-      MSChromatogram chromatogram;
-      std::vector<PeakBoundary> boundaries_c; // peak boundaries of a single chromatogram
-      pick(input.getChromatograms()[i], chromatogram, boundaries_c);
-      output.addChromatogram(chromatogram);
-      boundaries_chrom.push_back(boundaries_c);
-      setProgress(++progress);
+      try
+      {
+        pick(input.getChromatograms()[i], chromatograms[i], chrom_boundaries[i]);
+      }
+      catch (...)
+      {
+        storeFirstError_(error, error_index, i);
+      }
+      #pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    }
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+    for (Size i = 0; i < chromatograms.size(); ++i)
+    {
+      output.addChromatogram(std::move(chromatograms[i]));
+      boundaries_chrom.push_back(std::move(chrom_boundaries[i]));
     }
     endProgress();
 
@@ -0,0 +1,202 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
+
+#include <OpenMS/CONCEPT/LogStream.h>
+
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenMS
+{
+  namespace
+  {
+    /**
+      @brief Applies @p func to all elements of @p data in parallel
+
+      Exceptions are caught inside the parallel region; the one of the first
+      failing element (in order) is rethrown afterwards.
+    */
+    template <typename ContainerType, typename FunctionType>
+    void parallelForEach_(ContainerType& data, const FunctionType& func)
+    {
+      std::exception_ptr error;
+      Size error_index = 0;
+      #pragma omp parallel for schedule(dynamic, 1)
+      for (SignedSize i = 0; i < SignedSize(data.size()); ++i)
+      {
+        try
+        {
+          func(data[i]);
+        }
+        catch (...)
+        {
+          #pragma omp critical (PeakPickerHiResConsumer_error)
+          {
+            if (!error || Size(i) < error_index)
+            {
+              error = std::current_exception();
+              error_index = i;
+            }
+          }
+        }
+      }
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  PeakPickerHiResConsumer::PeakPickerHiResConsumer(Interfaces::IMSDataConsumer* next_consumer, const PeakPickerHiRes& pp, Size batch_size) :
+    next_consumer_(next_consumer),
+    pp_(pp),
+    ms_levels_(pp.getParameters().getValue("ms_levels").toIntVector()),
+    batch_size_(batch_size)
+  {
+    if (batch_size_ == 0)
+    {
+#ifdef _OPENMP
+      batch_size_ = 16 * omp_get_max_threads();
+#else
+      batch_size_ = 16;
+#endif
+    }
+    spectra_.reserve(batch_size_);
+    chromatograms_.reserve(batch_size_);
+  }
+
+  PeakPickerHiResConsumer::~PeakPickerHiResConsumer()
+  {
+    try
+    {
+      flush();
+    }
+    catch (std::exception& e)
+    {
+      OPENMS_LOG_ERROR << "PeakPickerHiResConsumer: peak picking of the remaining data failed: " << e.what() << std::endl;
+    }
+  }
+
+  void PeakPickerHiResConsumer::setExpectedSize(Size expected_spectra, Size expected_chromatograms)
+  {
+    next_consumer_->setExpectedSize(expected_spectra, expected_chromatograms);
+  }
+
+  void PeakPickerHiResConsumer::setExperimentalSettings(const ExperimentalSettings& exp)
+  {
+    next_consumer_->setExperimentalSettings(exp);
+  }
+
+  void PeakPickerHiResConsumer::consumeSpectrum(SpectrumType& s)
+  {
+    // keep the order of spectra and chromatograms
+    flushChromatograms_();
+    spectra_.push_back(std::move(s));
+    if (spectra_.size() >= batch_size_)
+    {
+      flushSpectra_();
+    }
+  }
+
+  void PeakPickerHiResConsumer::consumeChromatogram(ChromatogramType& c)
+  {
+    flushSpectra_();
+    chromatograms_.push_back(std::move(c));
+    if (chromatograms_.size() >= batch_size_)
+    {
+      flushChromatograms_();
+    }
+  }
+
+  void PeakPickerHiResConsumer::flush()
+  {
+    flushSpectra_();
+    flushChromatograms_();
+  }
+
+  void PeakPickerHiResConsumer::flushSpectra_()
+  {
+    if (spectra_.empty())
+    {
+      return;
+    }
+    parallelForEach_(spectra_, [this](SpectrumType& s)
+    {
+      if (ms_levels_.empty()) // auto mode
+      {
+        if (s.getType(true) == SpectrumSettings::CENTROID)
+        {
+          return;
+        }
+      }
+      else if (!ListUtils::contains(ms_levels_, s.getMSLevel())) // manual mode
+      {
+        return;
+      }
+      SpectrumType picked;
+      pp_.pick(s, picked);
+      s = std::move(picked);
+    });
+    for (SpectrumType& s : spectra_)
+    {
+      next_consumer_->consumeSpectrum(s);
+    }
+    spectra_.clear();
+  }
+
+  void PeakPickerHiResConsumer::flushChromatograms_()
+  {
+    if (chromatograms_.empty())
+    {
+      return;
+    }
+    parallelForEach_(chromatograms_, [this](ChromatogramType& c)
+    {
+      ChromatogramType picked;
+      pp_.pick(c, picked);
+      c = std::move(picked);
+    });
+    for (ChromatogramType& c : chromatograms_)
+    {
+      next_consumer_->consumeChromatogram(c);
+    }
+    chromatograms_.clear();
+  }
+
+} // namespace OpenMS
@@ -9,6 +9,7 @@ OptimizePeakDeconvolution.cpp
 OptimizePick.cpp
 PeakPickerCWT.cpp
 PeakPickerHiRes.cpp
+PeakPickerHiResConsumer.cpp
 PeakPickerIterative.cpp
 PeakPickerMaxima.cpp
 PeakPickerSH.cpp
@@ -186,21 +186,21 @@ namespace OpenSwath::Scoring
       XCorrArrayType result;
       result.data.reserve( (size_t)std::ceil((2*maxdelay + 1) / lag));
       int datasize = static_cast<int>(data1.size());
-      int i, j, delay;
+      const double* d1 = data1.data();
+      const double* d2 = data2.data();
 
-      for (delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
+      for (int delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
       {
+        // only the overlapping part contributes, iterate over it directly
+        // (same summation order as checking each index, but no branch in the inner loop)
+        const int i_start = std::max(0, -delay);
+        const int i_end = std::min(datasize, datasize - delay);
         double sxy = 0;
-        for (i = 0; i < datasize; ++i)
+        for (int i = i_start; i < i_end; ++i)
         {
-          j = i + delay;
-          if (j < 0 || j >= datasize)
-          {
-            continue;
-          }
-          sxy += (data1[i]) * (data2[j]);
+          sxy += d1[i] * d2[i + delay];
         }
-        result.data.push_back(std::make_pair(delay, sxy));
+        result.data.emplace_back(delay, sxy);
       }
       return result;
     }
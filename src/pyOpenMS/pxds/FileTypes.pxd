@@ -70,4 +70,6 @@ cdef extern from "<OpenMS/FORMAT/FileTypes.h>" namespace "OpenMS::FileTypes":
           OSW,                # < OpenSWATH OpenSWATH report (OSW) SQLite DB
           PSMS,               # < Percolator tab-delimited output (PSM level)
           PARAMXML,           # < internal format for writing and reading parameters (also used as part of CTD)
+          COLMASS,            # < Columnar chunk-compressed format for mass spectra and chromatograms
+          TLIB,               # < OpenSWATH memory-mappable binary transition library
           SIZE_OF_TYPE        # < No file type. Simply stores the number of types
@@ -32,3 +32,28 @@ cdef extern from "<OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>" namespace "O
                 #   -----
                 #   :param to_osw_output: Statements generated by prepareLine
 
+
+        void startWriterThread() nogil except +
+            # wrap-doc:
+                #   Start a dedicated thread which performs all subsequent writes
+                #   -----
+                #   Statements passed to writeLines are queued and committed in batches by the writer thread. Call flush to wait until they are on disk
+
+        void startWriterThread(Size max_queued_statements) nogil except +
+            # wrap-doc:
+                #   Same as above, writeLines blocks while more than max_queued_statements statements wait to be committed
+
+        void flush() nogil except + # wrap-doc:Commit all queued statements and stop the writer thread
+
+        void enableCheckpointing(String fingerprint) nogil except +
+            # wrap-doc:
+                #   Record which SWATH windows are completely written to the file
+                #   -----
+                #   If the file already contains a checkpoint created with the same fingerprint, the interrupted run is resumed
+                #   -----
+                #   :param fingerprint: Hash of all inputs and parameters that influence the results
+
+        bool isCheckpointing() nogil except + # wrap-doc:Whether completed windows are recorded
+        bool isResuming() nogil except + # wrap-doc:Whether enableCheckpointing resumes a previous run
+        String prepareCheckpoint(Size window) nogil except + # wrap-doc:Prepare the statement which marks a SWATH window as completely written
+        void finishCheckpointing() nogil except + # wrap-doc:Remove the checkpoint once all windows are written
@@ -0,0 +1,6 @@
+### benchmark executables (built if OPENMS_BENCHMARK is enabled)
+set(BENCHMARK_executables
+  Base64_benchmark
+  MassTraceDetection_benchmark
+  SimpleSearchEngineAlgorithm_benchmark
+)
@@ -0,0 +1,106 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <BenchmarkHelper.h>
+
+#include <OpenMS/FORMAT/Base64.h>
+
+#include <cstring>
+#include <random>
+
+using namespace OpenMS;
+
+/// Baseline: decodes one character and emits one byte at a time
+void bytewiseDecode(const String& in, std::vector<double>& out)
+{
+  const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  out.clear();
+  UInt32 bits = 0;
+  int nr_bits = 0;
+  std::vector<unsigned char> element;
+  for (char c : in)
+  {
+    size_t v = alphabet.find(c);
+    if (v == std::string::npos) continue;
+    bits = ((bits << 6) | (UInt32)v) & 0xFFFFFF;
+    nr_bits += 6;
+    if (nr_bits >= 8)
+    {
+      nr_bits -= 8;
+      element.push_back((unsigned char)(bits >> nr_bits));
+      if (element.size() == sizeof(double))
+      {
+        double value;
+        std::memcpy(&value, element.data(), sizeof(double));
+        out.push_back(value);
+        element.clear();
+      }
+    }
+  }
+}
+
+/// Base64 encoding and decoding of (uncompressed) double arrays, compared to byte-wise decoding
+int main(int argc, const char** argv)
+{
+  const Size nr_values = argc > 1 ? String(argv[1]).toInt() : 100000;
+  const Size repeats = 20;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> mz_dist(200.0, 2000.0);
+  std::vector<double> mz(nr_values);
+  for (double& d : mz) d = mz_dist(rng);
+  std::vector<double> tmp = mz;
+  String encoded;
+  Base64::encode(tmp, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+
+  std::vector<double> out_reference, out;
+  const double time_reference = Benchmark::time([&]() { bytewiseDecode(encoded, out_reference); }, repeats);
+  const double time_decode = Benchmark::time([&]() { Base64::decode(encoded, Base64::BYTEORDER_LITTLEENDIAN, out); }, repeats);
+  const double time_encode = Benchmark::time([&]()
+    {
+      tmp = mz;
+      Base64::encode(tmp, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+    }, repeats);
+
+  std::cout << "Decoding " << nr_values << " doubles: byte-wise " << time_reference * 1000 << " ms, Base64::decode "
+            << time_decode * 1000 << " ms" << std::endl;
+  std::cout << "Encoding " << nr_values << " doubles: Base64::encode " << time_encode * 1000 << " ms" << std::endl;
+
+  if (out != out_reference || out != mz)
+  {
+    std::cerr << "Base64::decode differs from the byte-wise decoding." << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <BenchmarkHelper.h>
+
+#include <OpenMS/FILTERING/DATAREDUCTION/MassTraceDetection.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+using namespace OpenMS;
+
+/// Thread scaling of MassTraceDetection::run for different numbers of m/z strips (the traces must not depend on either)
+int main(int argc, const char** argv)
+{
+  const String in_mzML = argc > 1 ? String(argv[1]) : String(OPENMS_BENCHMARK_DATA_PATH) + "FeatureFinderMetabo_1_input.mzML";
+  PeakMap lcms;
+  MzMLFile().load(in_mzML, lcms);
+
+  MassTraceDetection mtd;
+  Param p = mtd.getParameters();
+  p.setValue("noise_threshold_int", 10.0);
+  p.setValue("mz_strips", 1);
+  mtd.setParameters(p);
+  mtd.setLogType(ProgressLogger::NONE);
+
+  // serial extension of all traces
+  std::vector<MassTrace> reference;
+  Benchmark::setThreadCount(1);
+  double seconds = Benchmark::time([&]() { mtd.run(lcms, reference); });
+  std::cout << "serial extension: " << reference.size() << " traces, wall time: " << seconds << " s" << std::endl;
+
+  for (int strips : {0, 3, 16})
+  {
+    p.setValue("mz_strips", strips);
+    mtd.setParameters(p);
+    for (int threads : Benchmark::getThreadCounts())
+    {
+      Benchmark::setThreadCount(threads);
+      std::vector<MassTrace> traces;
+      seconds = Benchmark::time([&]() { mtd.run(lcms, traces); });
+      std::cout << "mz_strips: " << strips << " threads: " << threads << " wall time: " << seconds << " s" << std::endl;
+
+      bool identical = traces.size() == reference.size();
+      for (Size i = 0; identical && i != traces.size(); ++i)
+      {
+        identical = traces[i].getLabel() == reference[i].getLabel() && traces[i].getSize() == reference[i].getSize() &&
+                    traces[i].getCentroidMZ() == reference[i].getCentroidMZ() && traces[i].getCentroidRT() == reference[i].getCentroidRT();
+      }
+      if (!identical)
+      {
+        std::cerr << "Traces with " << strips << " m/z strips and " << threads << " threads differ from the serial extension." << std::endl;
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <BenchmarkHelper.h>
+
+#include <OpenMS/ANALYSIS/ID/SimpleSearchEngineAlgorithm.h>
+
+using namespace OpenMS;
+
+/// Thread scaling of SimpleSearchEngineAlgorithm::search (the hits must not depend on the number of threads)
+int main(int argc, const char** argv)
+{
+  const String in_mzML = argc > 2 ? String(argv[1]) : String(OPENMS_BENCHMARK_DATA_PATH) + "SimpleSearchEngine_1.mzML";
+  const String in_db = argc > 2 ? String(argv[2]) : String(OPENMS_BENCHMARK_DATA_PATH) + "SimpleSearchEngine_1.fasta";
+
+  SimpleSearchEngineAlgorithm sse;
+  Param p = sse.getParameters();
+  p.setValue("precursor:mass_tolerance", 5.0);
+  p.setValue("fragment:mass_tolerance", 0.3);
+  p.setValue("fragment:mass_tolerance_unit", "Da");
+  p.setValue("decoys", "true");
+  p.setValue("report:top_hits", 5);
+  sse.setParameters(p);
+  sse.setLogType(ProgressLogger::NONE);
+
+  std::vector<PeptideIdentification> reference;
+  for (int threads : Benchmark::getThreadCounts())
+  {
+    Benchmark::setThreadCount(threads);
+    std::vector<ProteinIdentification> prot_ids;
+    std::vector<PeptideIdentification> pep_ids;
+    const double seconds = Benchmark::time([&]() { sse.search(in_mzML, in_db, prot_ids, pep_ids); });
+    std::cout << "threads: " << threads << " wall time: " << seconds << " s" << std::endl;
+
+    if (threads == 1)
+    {
+      reference = pep_ids;
+      continue;
+    }
+    bool identical = pep_ids.size() == reference.size();
+    for (Size i = 0; identical && i != pep_ids.size(); ++i)
+    {
+      const std::vector<PeptideHit>& hits = pep_ids[i].getHits();
+      const std::vector<PeptideHit>& ref_hits = reference[i].getHits();
+      identical = hits.size() == ref_hits.size();
+      for (Size j = 0; identical && j != hits.size(); ++j)
+      {
+        identical = hits[j].getSequence() == ref_hits[j].getSequence() && hits[j].getScore() == ref_hits[j].getScore();
+      }
+    }
+    if (!identical)
+    {
+      std::cerr << "Hits with " << threads << " threads differ from the single-threaded search." << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -134,6 +134,7 @@ set(system_executables_list
   File_test
   FileWatcher_test
   JavaInfo_test
+  MemoryMappedFile_test
   PythonInfo_test
   StopWatch_test
   SysInfo_test
@@ -144,6 +145,7 @@ set(kernel_executables_list
   BaseFeature_test
   ChromatogramPeak_test
   ChromatogramTools_test
+  ColumnarSpectrum_test
   ConsensusFeature_test
   ConsensusMap_test
   ConversionHelper_test
@@ -178,6 +180,8 @@ set(format_executables_list
   Bzip2Ifstream_test
   Bzip2InputStream_test
   ChromeleonFile_test
+  ColMassFile_test
+  ColMassHandler_test
   CVMappingFile_test
   CompressedInputSource_test
   ConsensusXMLFile_test
@@ -187,6 +191,7 @@ set(format_executables_list
   DTAFile_test
   EDTAFile_test
   ExperimentalDesignFile_test
+  FASTAArena_test
   FASTAFile_test
   FeatureFileOptions_test
   FeatureXMLFile_test
@@ -278,6 +283,7 @@ set(format_executables_list
   MSDataStoringConsumer_test
   MSDataAggregatingConsumer_test
   SpectrumAccessQuadMZTransforming_test
+  SpectrumAccessPrefetching_test
   SpectrumAccessSqMass_test
   SiriusFragmentAnnotation_test
 )
@@ -432,6 +438,7 @@ set(chemistry_executables_list
   Residue_test
   RibonucleotideDB_test
   Ribonucleotide_test
+  SimpleTSG_test
   SimpleTSGXLMS_test
   SpectrumAnnotator_test
   SvmTheoreticalSpectrumGeneratorSet_test
@@ -491,6 +498,8 @@ set(analysis_executables_list
   FeatureHandle_test
   FIAMSDataProcessor_test
   FIAMSScheduler_test
+  FNVHash_test
+  FragmentIndex_test
   HiddenMarkovModel_test
   IDBoostGraph_test
   IDMapper_test
@@ -516,6 +525,7 @@ set(analysis_executables_list
   KDTreeFeatureMaps_test
   KDTreeFeatureNode_test
   LabeledPairFinder_test
+  LinkingFeatureStore_test
   LocalLinearMap_test
   TargetedExperiment_test
   TargetedExperimentHelper_test
@@ -539,7 +549,9 @@ set(analysis_executables_list
   ModifiedPeptideGenerator_test
   NeedlemanWunsch_test
   OfflinePrecursorIonSelection_test
+  PeptideDatabase_test
   PeptideIndexing_test
+  ProteinSuffixArray_test
   PeptideAndProteinQuant_test
   PeptideProteinResolution_test
   PeakIntensityPredictor_test
@@ -627,6 +639,7 @@ set(transformations_executables_list
   OptimizePick_test
   PeakPickerCWT_test
   PeakPickerHiRes_test
+  PeakPickerHiResConsumer_test
   PeakPickerIterative_test
   PeakPickerMaxima_test
   PeakPickerSH_test
@@ -678,9 +691,13 @@ if(NOT DISABLE_OPENSWATH)
     TransitionPQPFile_test
     ChromatogramExtractor_test
     ChromatogramExtractorAlgorithm_test
+    StreamingChromatogramExtractor_test
     OpenSwathHelper_test
     OpenSwathScoring_test
     OpenSwathScores_test
+    OpenSwathOSWWriter_test
+    OpenSwathWorkflow_test
+    MappedTransitionLibrary_test
     PeakIntegrator_test
     PeakPickerMRM_test
     MRMTransitionGroupPicker_test
@@ -705,6 +722,8 @@ if(NOT DISABLE_OPENSWATH)
     IonMobilityScoring_test
     CachedMzML_test
     CachedMzMLHandler_test
+    MappedCachedMzML_test
+    SpectrumAccessOpenMSCachedMapped_test
     HDF5_test
   )
 endif(NOT DISABLE_OPENSWATH)
@@ -41,8 +41,41 @@
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/CONCEPT/UniqueIdGenerator.h>
 
+#include <cstring>
+#include <random>
+
 using namespace std;
 
+// byte-wise reference decoder (the implementation used before the vectorized kernels), little endian input only
+template <typename ToType>
+void referenceDecode(const OpenMS::String& in, std::vector<ToType>& out)
+{
+  const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  out.clear();
+  OpenMS::UInt32 bits = 0;
+  int nr_bits = 0;
+  std::vector<unsigned char> element;
+  for (char c : in)
+  {
+    size_t v = alphabet.find(c);
+    if (v == std::string::npos) continue;
+    bits = ((bits << 6) | (OpenMS::UInt32)v) & 0xFFFFFF;
+    nr_bits += 6;
+    if (nr_bits >= 8)
+    {
+      nr_bits -= 8;
+      element.push_back((unsigned char)(bits >> nr_bits));
+      if (element.size() == sizeof(ToType))
+      {
+        ToType value;
+        std::memcpy(&value, element.data(), sizeof(ToType));
+        out.push_back(value);
+        element.clear();
+      }
+    }
+  }
+}
+
 START_TEST(Base64, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -500,6 +533,68 @@ START_SECTION((template <typename FromType> void encodeIntegers(std::vector<From
 }
 END_SECTION
 
+START_SECTION([EXTRA] large arrays and whitespace)
+{
+  // a realistic 100k peak spectrum
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> mz_dist(200.0, 2000.0);
+  std::vector<double> mz(100000);
+  for (double& d : mz) d = mz_dist(rng);
+  std::vector<float> intensity(100001); // not a multiple of 3 bytes
+  for (float& f : intensity) f = (float)mz_dist(rng) * 1000.0f;
+
+  for (Base64::ByteOrder order : {Base64::BYTEORDER_LITTLEENDIAN, Base64::BYTEORDER_BIGENDIAN})
+  {
+    for (bool zlib : {false, true})
+    {
+      String encoded;
+      std::vector<double> mz_in = mz, mz_out;
+      Base64::encode(mz_in, order, encoded, zlib);
+      Base64::decode(encoded, order, mz_out, zlib);
+      TEST_EQUAL(mz_out == mz, true)
+
+      std::vector<float> int_in = intensity, int_out;
+      Base64::encode(int_in, order, encoded, zlib);
+      Base64::decode(encoded, order, int_out, zlib);
+      TEST_EQUAL(int_out == intensity, true)
+    }
+  }
+
+  // line breaks and indentation inside the Base64 data are skipped
+  String encoded;
+  std::vector<double> mz_in(mz.begin(), mz.begin() + 999), mz_out;
+  Base64::encode(mz_in, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+  String wrapped;
+  for (Size i = 0; i < encoded.size(); i += 76)
+  {
+    wrapped += encoded.substr(i, 76) + "\n  ";
+  }
+  wrapped += "    ";
+  wrapped.resize(wrapped.size() - wrapped.size() % 4);
+  Base64::decode(wrapped, Base64::BYTEORDER_LITTLEENDIAN, mz_out);
+  TEST_EQUAL(mz_out.size(), 999)
+  TEST_EQUAL(std::equal(mz_out.begin(), mz_out.end(), mz.begin()), true)
+}
+END_SECTION
+
+START_SECTION([EXTRA] decoding matches byte-wise reference)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> mz_dist(200.0, 2000.0);
+  std::vector<double> mz(100000);
+  for (double& d : mz) d = mz_dist(rng);
+  std::vector<double> tmp = mz;
+  String encoded;
+  Base64::encode(tmp, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+
+  std::vector<double> out_reference, out;
+  referenceDecode(encoded, out_reference);
+  Base64::decode(encoded, Base64::BYTEORDER_LITTLEENDIAN, out);
+  TEST_EQUAL(out == out_reference, true)
+  TEST_EQUAL(out == mz, true)
+}
+END_SECTION
+
 ptr = new Base64;
 
 START_SECTION(inline UInt32 endianize32(const UInt32& n))
@@ -65,6 +65,54 @@ void cacheFile(CachedMzMLHandler& cache, std::string & tmp_filename, PeakMap& ex
   cache.createMemdumpIndex(tmp_filename);
 }
 
+// Write a cached file in the layout of format version 1 (no versioned header, no alignment)
+void writeLegacyCache(const PeakMap& exp, const std::string& filename)
+{
+  std::ofstream ofs(filename.c_str(), std::ios::binary);
+  int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+  ofs.write((char*)&file_identifier, sizeof(file_identifier));
+  auto writeArrays = [&ofs](const auto& first, const auto& second, const auto& fdas)
+  {
+    for (double v : first) ofs.write((char*)&v, sizeof(v));
+    for (double v : second) ofs.write((char*)&v, sizeof(v));
+    for (const auto& fda : fdas)
+    {
+      Size len = fda.size(), len_name = fda.getName().size();
+      ofs.write((char*)&len, sizeof(len));
+      ofs.write((char*)&len_name, sizeof(len_name));
+      ofs.write(fda.getName().c_str(), len_name);
+      for (double v : fda) ofs.write((char*)&v, sizeof(v));
+    }
+  };
+  for (const auto& s : exp)
+  {
+    Size size = s.size(), nr_arrays = s.getFloatDataArrays().size();
+    int ms_level = s.getMSLevel();
+    double rt = s.getRT();
+    ofs.write((char*)&size, sizeof(size));
+    ofs.write((char*)&nr_arrays, sizeof(nr_arrays));
+    ofs.write((char*)&ms_level, sizeof(ms_level));
+    ofs.write((char*)&rt, sizeof(rt));
+    if (s.empty()) continue;
+    std::vector<double> mz, intensity;
+    for (const auto& p : s) { mz.push_back(p.getMZ()); intensity.push_back(p.getIntensity()); }
+    writeArrays(mz, intensity, s.getFloatDataArrays());
+  }
+  for (const auto& c : exp.getChromatograms())
+  {
+    Size size = c.size(), nr_arrays = c.getFloatDataArrays().size();
+    ofs.write((char*)&size, sizeof(size));
+    ofs.write((char*)&nr_arrays, sizeof(nr_arrays));
+    if (c.empty()) continue;
+    std::vector<double> rt, intensity;
+    for (const auto& p : c) { rt.push_back(p.getRT()); intensity.push_back(p.getIntensity()); }
+    writeArrays(rt, intensity, c.getFloatDataArrays());
+  }
+  Size exp_size = exp.size(), chrom_size = exp.getChromatograms().size();
+  ofs.write((char*)&exp_size, sizeof(exp_size));
+  ofs.write((char*)&chrom_size, sizeof(chrom_size));
+}
+
 START_TEST(CachedMzMLHandler, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -412,6 +460,198 @@ START_SECTION( static inline void readChromatogramFast(OpenSwath::BinaryDataArra
 }
 END_SECTION
 
+START_SECTION(( UInt32 getFileVersion() const ))
+{
+  TEST_EQUAL(cache_.getFileVersion(), CACHED_MZML_FILE_VERSION)
+}
+END_SECTION
+
+START_SECTION(( static UInt32 parseHeader(const char* data, Size size, const String& filename) ))
+{
+  int legacy = CACHED_MZML_FILE_IDENTIFIER;
+  TEST_EQUAL(CachedMzMLHandler::parseHeader((const char*)&legacy, sizeof(legacy), "test"), 1)
+
+  UInt32 header[4] = {CACHED_MZML_FILE_IDENTIFIER_VERSIONED, CACHED_MZML_FILE_VERSION, 0x01020304, 0};
+  TEST_EQUAL(CachedMzMLHandler::parseHeader((const char*)header, sizeof(header), "test"), CACHED_MZML_FILE_VERSION)
+
+  // truncated header
+  TEST_EXCEPTION(Exception::ParseError, CachedMzMLHandler::parseHeader((const char*)header, 2 * sizeof(UInt32), "test"))
+  TEST_EXCEPTION(Exception::ParseError, CachedMzMLHandler::parseHeader((const char*)header, 0, "test"))
+  // not a cached file
+  TEST_EXCEPTION(Exception::ParseError, CachedMzMLHandler::parseHeader("<?xml version", 13, "test"))
+  // different byte order
+  header[2] = 0x04030201;
+  TEST_EXCEPTION(Exception::ParseError, CachedMzMLHandler::parseHeader((const char*)header, sizeof(header), "test"))
+  header[2] = 0x01020304;
+  // written by a newer version
+  header[1] = CACHED_MZML_FILE_VERSION + 1;
+  TEST_EXCEPTION(Exception::ParseError, CachedMzMLHandler::parseHeader((const char*)header, sizeof(header), "test"))
+}
+END_SECTION
+
+START_SECTION(( static UInt32 readHeader(std::ifstream& ifs, const String& filename) ))
+{
+  std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+  TEST_EQUAL(CachedMzMLHandler::readHeader(ifs, tmp_filename), CACHED_MZML_FILE_VERSION)
+  TEST_EQUAL(ifs.tellg(), std::streampos(CachedMzMLHandler::getHeaderSize(CACHED_MZML_FILE_VERSION)))
+
+  std::ifstream ifs_mzml(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), std::ios::binary);
+  TEST_EXCEPTION(Exception::ParseError, CachedMzMLHandler::readHeader(ifs_mzml, "MzMLFile_1.mzML"))
+}
+END_SECTION
+
+START_SECTION(( static void writeHeader(std::ofstream& ofs) ))
+{
+  std::string filename;
+  NEW_TMP_FILE(filename);
+  {
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    CachedMzMLHandler::writeHeader(ofs);
+    TEST_EQUAL(ofs.tellp(), std::streampos(CachedMzMLHandler::getHeaderSize(CACHED_MZML_FILE_VERSION)))
+  }
+  std::ifstream ifs(filename.c_str(), std::ios::binary);
+  TEST_EQUAL(CachedMzMLHandler::readHeader(ifs, filename), CACHED_MZML_FILE_VERSION)
+}
+END_SECTION
+
+START_SECTION(( static Size getHeaderSize(UInt32 version) ))
+{
+  TEST_EQUAL(CachedMzMLHandler::getHeaderSize(1), sizeof(int))
+  TEST_EQUAL(CachedMzMLHandler::getHeaderSize(2), 16)
+}
+END_SECTION
+
+START_SECTION(( static Size getSpectrumPadding(Size pos, UInt32 version) ))
+{
+  const Size header = 2 * sizeof(Size) + sizeof(int) + sizeof(double);
+  TEST_EQUAL(CachedMzMLHandler::getSpectrumPadding(16, 1), 0)
+  TEST_EQUAL(CachedMzMLHandler::getSpectrumPadding(17, 1), 0)
+  for (Size pos = 16; pos < 32; ++pos)
+  {
+    Size padding = CachedMzMLHandler::getSpectrumPadding(pos, 2);
+    TEST_EQUAL(padding < 8, true)
+    TEST_EQUAL((pos + padding + header) % 8, 0)
+  }
+}
+END_SECTION
+
+START_SECTION(( static Size getChromatogramPadding(Size pos, UInt32 version) ))
+{
+  TEST_EQUAL(CachedMzMLHandler::getChromatogramPadding(17, 1), 0)
+  TEST_EQUAL(CachedMzMLHandler::getChromatogramPadding(16, 2), 0)
+  TEST_EQUAL(CachedMzMLHandler::getChromatogramPadding(17, 2), 7)
+  TEST_EQUAL(CachedMzMLHandler::getChromatogramPadding(23, 2), 1)
+}
+END_SECTION
+
+START_SECTION(( [EXTRA] aligned data arrays ))
+{
+  // all data arrays in files of the current version start at an 8 byte boundary
+  std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+  for (Size i = 0; i < cache_.getSpectraIndex().size(); ++i)
+  {
+    Size pos = static_cast<Size>(cache_.getSpectraIndex()[i]);
+    TEST_EQUAL((pos + 2 * sizeof(Size) + sizeof(int) + sizeof(double)) % 8, 0)
+
+    // additional arrays: names are zero-padded, so the data following them is aligned as well
+    ifs.seekg(pos);
+    Size size, nr_arrays;
+    ifs.read((char*)&size, sizeof(size));
+    ifs.read((char*)&nr_arrays, sizeof(nr_arrays));
+    ifs.seekg(sizeof(int) + sizeof(double) + 2 * size * sizeof(double), ifs.cur);
+    for (Size k = 0; k < nr_arrays; ++k)
+    {
+      Size len, len_name;
+      ifs.read((char*)&len, sizeof(len));
+      ifs.read((char*)&len_name, sizeof(len_name));
+      ifs.seekg(len_name, ifs.cur);
+      TEST_EQUAL(static_cast<Size>(ifs.tellg()) % 8, 0)
+      ifs.seekg(len * sizeof(double), ifs.cur);
+    }
+  }
+  for (Size i = 0; i < cache_.getChromatogramIndex().size(); ++i)
+  {
+    TEST_EQUAL((static_cast<Size>(cache_.getChromatogramIndex()[i]) + 2 * sizeof(Size)) % 8, 0)
+  }
+}
+END_SECTION
+
+START_SECTION(( [EXTRA] data array names longer than 1024 bytes ))
+{
+  PeakMap long_exp = exp;
+  const String long_name(2000, 'x');
+  long_exp[1].getFloatDataArrays()[0].setName(long_name);
+
+  std::string long_filename;
+  NEW_TMP_FILE(long_filename);
+  CachedMzMLHandler cache;
+  cache.writeMemdump(long_exp, long_filename);
+  cache.createMemdumpIndex(long_filename);
+
+  std::ifstream ifs(long_filename.c_str(), std::ios::binary);
+  int ms_level = -1;
+  double rt = -1.0;
+  ifs.seekg(cache.getSpectraIndex()[1]);
+  std::vector<OpenSwath::BinaryDataArrayPtr> darray = CachedMzMLHandler::readSpectrumFast(ifs, ms_level, rt);
+  TEST_EQUAL(darray.size(), 4)
+  TEST_EQUAL(darray[2]->description, long_name)
+  TEST_EQUAL(darray[3]->description, "user-defined name")
+  TEST_EQUAL(darray[3]->data.size(), long_exp[1].getFloatDataArrays()[1].size())
+
+  // the index of the following spectrum is not affected by the long name
+  ifs.seekg(cache.getSpectraIndex()[2]);
+  darray = CachedMzMLHandler::readSpectrumFast(ifs, ms_level, rt);
+  TEST_EQUAL(darray[0]->data.size(), long_exp[2].size())
+  TEST_REAL_SIMILAR(rt, long_exp[2].getRT())
+}
+END_SECTION
+
+START_SECTION(( [EXTRA] reading files of format version 1 ))
+{
+  std::string legacy_filename;
+  NEW_TMP_FILE(legacy_filename);
+  writeLegacyCache(exp, legacy_filename);
+
+  CachedMzMLHandler cache;
+  cache.createMemdumpIndex(legacy_filename);
+  TEST_EQUAL(cache.getFileVersion(), 1)
+  TEST_EQUAL(cache.getSpectraIndex().size(), 4)
+  TEST_EQUAL(cache.getChromatogramIndex().size(), 2)
+  TEST_EQUAL(cache.getSpectraIndex()[0], std::streampos(sizeof(int)))
+
+  std::ifstream ifs(legacy_filename.c_str(), std::ios::binary);
+  for (Size i = 0; i < 4; ++i)
+  {
+    int ms_level = -1;
+    double rt = -1.0;
+    ifs.seekg(cache.getSpectraIndex()[i]);
+    std::vector<OpenSwath::BinaryDataArrayPtr> darray = CachedMzMLHandler::readSpectrumFast(ifs, ms_level, rt);
+    TEST_EQUAL(darray[0]->data.size(), exp.getSpectrum(i).size())
+    TEST_EQUAL(ms_level, exp.getSpectrum(i).getMSLevel())
+    TEST_REAL_SIMILAR(rt, exp.getSpectrum(i).getRT())
+    for (Size k = 0; k < darray[0]->data.size(); ++k)
+    {
+      TEST_REAL_SIMILAR(darray[0]->data[k], exp.getSpectrum(i)[k].getMZ())
+      TEST_REAL_SIMILAR(darray[1]->data[k], exp.getSpectrum(i)[k].getIntensity())
+    }
+  }
+  ifs.seekg(cache.getSpectraIndex()[1]);
+  int ms_level = -1;
+  double rt = -1.0;
+  std::vector<OpenSwath::BinaryDataArrayPtr> darray = CachedMzMLHandler::readSpectrumFast(ifs, ms_level, rt);
+  TEST_EQUAL(darray.size(), 4)
+  TEST_EQUAL(darray[2]->description, "signal to noise array")
+  TEST_EQUAL(darray[3]->description, "user-defined name")
+
+  PeakMap exp_new;
+  cache.readMemdump(exp_new, legacy_filename);
+  TEST_EQUAL(exp_new.size(), exp.size())
+  TEST_EQUAL(exp_new.getChromatograms().size(), exp.getChromatograms().size())
+  TEST_EQUAL(exp_new[3].size(), exp[3].size())
+  TEST_EQUAL(exp_new.getChromatograms()[1].size(), exp.getChromatograms()[1].size())
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
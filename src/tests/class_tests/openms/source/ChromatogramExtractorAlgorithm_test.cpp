@@ -37,6 +37,7 @@
 #include <OpenMS/CONCEPT/ClassTest.h>
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/HANDLERS/ColMassHandler.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 
 using namespace OpenMS;
@@ -260,6 +261,77 @@ START_SECTION([EXTRA] void extractChromatograms(const OpenSwath::SpectrumAccessP
 }
 END_SECTION
 
+START_SECTION(void extractChromatograms(const Internal::ColMassHandler& input, Size group, std::vector< OpenSwath::ChromatogramPtr >& output, const std::vector<ExtractionCoordinates>& extraction_coordinates, double mz_extraction_window, bool ppm, double im_extraction_window, const String& filter))
+{
+  boost::shared_ptr<PeakMap > exp(new PeakMap);
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.mzML"), *exp);
+  // one spectrum has a different isolation window, put all spectra into a single spectrum group
+  for (MSSpectrum& spectrum : *exp)
+  {
+    spectrum.getPrecursors().clear();
+  }
+  OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+  // small chunks and blocks, such that only parts of the file are decompressed
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  Internal::ColMassHandler writer;
+  writer.setConfig(256, 4, 1);
+  writer.writeExperiment(tmp_filename, *exp);
+  Internal::ColMassHandler handler;
+  handler.open(tmp_filename);
+  TEST_EQUAL(handler.getSpectrumGroups().size(), 1)
+
+  ChromatogramExtractorAlgorithm extractor;
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+  {
+    ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+    coord.mz = 618.31; coord.rt_start = 0; coord.rt_end = -1; coord.id = "tr1";
+    coordinates.push_back(coord);
+    coord.mz = 628.45; coord.rt_start = 3050; coord.rt_end = 3150; coord.id = "tr2";
+    coordinates.push_back(coord);
+    coord.mz = 654.38; coord.rt_start = 0; coord.rt_end = -1; coord.id = "tr3";
+    coordinates.push_back(coord);
+  }
+
+  // the same chromatograms as from the spectrum access (in Th and ppm)
+  for (Size ppm = 0; ppm < 2; ++ppm)
+  {
+    double extract_window = ppm ? 80.0 : 0.05;
+    std::vector< OpenSwath::ChromatogramPtr > expected, extracted;
+    for (Size i = 0; i < coordinates.size(); i++)
+    {
+      expected.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+      extracted.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    }
+    extractor.extractChromatograms(expptr, expected, coordinates, extract_window, ppm, -1, "tophat");
+    extractor.extractChromatograms(handler, 0, extracted, coordinates, extract_window, ppm, -1, "tophat");
+    for (Size i = 0; i < coordinates.size(); i++)
+    {
+      TEST_EQUAL(extracted[i]->getTimeArray()->data.size(), expected[i]->getTimeArray()->data.size())
+      TEST_EQUAL(extracted[i]->getTimeArray()->data == expected[i]->getTimeArray()->data, true)
+      TEST_EQUAL(extracted[i]->getIntensityArray()->data == expected[i]->getIntensityArray()->data, true)
+    }
+    TEST_EQUAL(extracted[0]->getTimeArray()->data.size(), 59)
+  }
+
+  double max_value = -1; double foundat = -1;
+  std::vector< OpenSwath::ChromatogramPtr > out_exp;
+  for (Size i = 0; i < coordinates.size(); i++)
+  {
+    out_exp.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+  }
+  extractor.extractChromatograms(handler, 0, out_exp, coordinates, 0.05, false, -1, "tophat");
+  find_max_helper(out_exp[2], max_value, foundat);
+  TEST_REAL_SIMILAR(max_value, 577.33);
+  TEST_REAL_SIMILAR(foundat, 3120.26);
+
+  // there is no ion mobility, so this should not work
+  TEST_EXCEPTION(Exception::IllegalArgument, extractor.extractChromatograms(handler, 0, out_exp, coordinates, 0.05, false, 1, "tophat"))
+  TEST_EXCEPTION(Exception::IndexOverflow, extractor.extractChromatograms(handler, 1, out_exp, coordinates, 0.05, false, -1, "tophat"))
+}
+END_SECTION
+
 ///////////////////////////////////////////////////////////////////////////
 /// Private functions
 ///////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,166 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/ColMassFile.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ColMassFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ColMassFile* ptr = nullptr;
+ColMassFile* nullPointer = nullptr;
+START_SECTION((ColMassFile()))
+{
+  ptr = new ColMassFile;
+  TEST_NOT_EQUAL(ptr, nullPointer)
+}
+END_SECTION
+
+START_SECTION((~ColMassFile()))
+{
+  delete ptr;
+}
+END_SECTION
+
+MSExperiment exp;
+for (Size i = 0; i < 10; ++i)
+{
+  MSSpectrum spectrum;
+  spectrum.setMSLevel(i % 2 + 1);
+  spectrum.setRT(100.0 + i);
+  spectrum.setNativeID("spectrum=" + String(i));
+  for (Size k = 0; k < 100; ++k)
+  {
+    spectrum.push_back(Peak1D(300.0 + k * 7.3 + i * 0.01, 500.0f * k + i));
+  }
+  exp.addSpectrum(spectrum);
+}
+MSChromatogram chromatogram;
+chromatogram.setNativeID("TIC");
+chromatogram.push_back(ChromatogramPeak(100.0, 5.0));
+chromatogram.push_back(ChromatogramPeak(101.0, 7.0));
+exp.addChromatogram(chromatogram);
+exp.updateRanges();
+
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+
+START_SECTION(void setConfig(const ColMassConfig& config))
+{
+  ColMassFile f;
+  ColMassFile::ColMassConfig config;
+  config.peaks_per_chunk = 64;
+  config.spectra_per_block = 2;
+  config.compression_level = 9;
+  f.setConfig(config);
+  TEST_EQUAL(f.getConfig().peaks_per_chunk, 64)
+  TEST_EQUAL(f.getConfig().spectra_per_block, 2)
+  TEST_EQUAL(f.getConfig().compression_level, 9)
+}
+END_SECTION
+
+START_SECTION(const ColMassConfig& getConfig() const)
+{
+  ColMassFile f;
+  TEST_EQUAL(f.getConfig().peaks_per_chunk, 4096)
+  TEST_EQUAL(f.getConfig().spectra_per_block, 32)
+  TEST_EQUAL(f.getConfig().compression_level, 1)
+}
+END_SECTION
+
+START_SECTION(void store(const String& filename, const MapType& map) const)
+{
+  ColMassFile f;
+  ColMassFile::ColMassConfig config;
+  config.peaks_per_chunk = 64;
+  config.spectra_per_block = 2;
+  f.setConfig(config);
+  f.store(tmp_filename, exp);
+  TEST_EQUAL(FileHandler::getTypeByContent(tmp_filename), FileTypes::COLMASS)
+
+  config.compression_level = 12;
+  f.setConfig(config);
+  TEST_EXCEPTION(Exception::IllegalArgument, f.store(tmp_filename, exp))
+}
+END_SECTION
+
+START_SECTION(void load(const String& filename, MapType& map) const)
+{
+  MSExperiment loaded;
+  ColMassFile().load(tmp_filename, loaded);
+  TEST_EQUAL(loaded.size(), 10)
+  TEST_EQUAL(loaded.getNrChromatograms(), 1)
+  bool all_equal = true;
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    all_equal &= loaded[i] == exp[i];
+  }
+  TEST_EQUAL(all_equal, true)
+  TEST_EQUAL(loaded.getChromatograms()[0] == exp.getChromatograms()[0], true)
+  TEST_EQUAL(loaded[3].getNativeID(), "spectrum=3")
+
+  TEST_EXCEPTION(Exception::FileNotFound, ColMassFile().load("this_file_does_not_exist.colMass", loaded))
+}
+END_SECTION
+
+START_SECTION(void loadArea(const String& filename, double min_rt, double max_rt, double min_mz, double max_mz, UInt ms_level, MapType& map) const)
+{
+  MSExperiment area;
+  ColMassFile().loadArea(tmp_filename, 102.5, 106.5, 500.0, 520.0, 2, area);
+  // spectra 3 and 5 with peaks at m/z 504.4, 511.7 and 519.0
+  TEST_EQUAL(area.size(), 2)
+  TEST_REAL_SIMILAR(area[0].getRT(), 103.0)
+  TEST_REAL_SIMILAR(area[1].getRT(), 105.0)
+  TEST_EQUAL(area[0].size(), 3)
+  TEST_REAL_SIMILAR(area[0][0].getMZ(), 504.43)
+  TEST_REAL_SIMILAR(area[0][0].getIntensity(), 14003.0)
+  TEST_EQUAL(area[0].getMSLevel(), 2)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,457 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/HANDLERS/ColMassHandler.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace OpenMS::Internal;
+using namespace std;
+
+// 12 MS1 spectra, 2 x 12 MS2 spectra of two isolation windows (with ion
+// mobility, unsorted peaks and one empty spectrum) and 2 chromatograms
+MSExperiment createExperiment()
+{
+  MSExperiment exp;
+  for (Size i = 0; i < 12; ++i)
+  {
+    MSSpectrum ms1;
+    ms1.setMSLevel(1);
+    ms1.setRT(10.0 + i * 3.0);
+    ms1.setNativeID("scan=" + String(3 * i));
+    for (Size k = 0; k < 20; ++k)
+    {
+      ms1.push_back(Peak1D(400.0 + k * 25.0 + i * 0.1, 100.0f + k + i));
+    }
+    exp.addSpectrum(ms1);
+
+    for (Size w = 0; w < 2; ++w)
+    {
+      MSSpectrum ms2;
+      ms2.setMSLevel(2);
+      ms2.setRT(11.0 + i * 3.0 + w);
+      ms2.setNativeID("scan=" + String(3 * i + 1 + w));
+      Precursor prec;
+      prec.setMZ(450.0 + w * 100.0);
+      prec.setIsolationWindowLowerOffset(50.0);
+      prec.setIsolationWindowUpperOffset(50.0);
+      ms2.getPrecursors().push_back(prec);
+      if (w == 1 && i == 5)
+      {
+        exp.addSpectrum(ms2); // empty spectrum
+        continue;
+      }
+      MSSpectrum::FloatDataArray im;
+      im.setName("Ion Mobility");
+      for (Size k = 0; k < 15; ++k)
+      {
+        // peaks are in descending m/z order for one spectrum
+        double mz = (i == 3 && w == 0) ? 1000.0 - k * 40.0 : 200.0 + k * 40.0 + w * 0.5;
+        ms2.push_back(Peak1D(mz, 10.0f * (k + 1) + i));
+        im.push_back(0.8f + k * 0.01f);
+      }
+      if (w == 0)
+      {
+        ms2.getFloatDataArrays().push_back(im);
+      }
+      exp.addSpectrum(ms2);
+    }
+  }
+
+  for (Size c = 0; c < 2; ++c)
+  {
+    MSChromatogram chrom;
+    chrom.setNativeID("chrom" + String(c));
+    for (Size k = 0; k < 30; ++k)
+    {
+      chrom.push_back(ChromatogramPeak(k * 1.5 + c, 1000.0 + k * 0.123456789));
+    }
+    exp.addChromatogram(chrom);
+  }
+  return exp;
+}
+
+// sorted peaks of a spectrum as stored in the file (with ion mobility)
+MSSpectrum sortedSpectrum(const MSSpectrum& spectrum)
+{
+  MSSpectrum sorted = spectrum;
+  sorted.sortByPosition();
+  return sorted;
+}
+
+START_TEST(ColMassHandler, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ColMassHandler* ptr = nullptr;
+ColMassHandler* nullPointer = nullptr;
+START_SECTION(ColMassHandler())
+{
+  ptr = new ColMassHandler();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(~ColMassHandler())
+{
+  delete ptr;
+}
+END_SECTION
+
+MSExperiment exp = createExperiment();
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+
+START_SECTION(void setConfig(Size peaks_per_chunk, Size spectra_per_block, int compression_level))
+{
+  ColMassHandler handler;
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.setConfig(0, 32, 1))
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.setConfig(4096, 0, 1))
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.setConfig(4096, 32, 10))
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.setConfig(4096, 32, -1))
+  handler.setConfig(4096, 32, 0);
+}
+END_SECTION
+
+START_SECTION(void writeExperiment(const String& filename, const MSExperiment& exp) const)
+{
+  ColMassHandler handler;
+  // small blocks and chunks to test the splitting
+  handler.setConfig(50, 5, 6);
+  handler.writeExperiment(tmp_filename, exp);
+  TEST_EQUAL(ColMassHandler::isColMassFile(tmp_filename), true)
+  TEST_EXCEPTION(Exception::UnableToCreateFile, handler.writeExperiment("/this/directory/does/not/exist/file.colMass", exp))
+
+  // empty experiment
+  std::string empty_filename;
+  NEW_TMP_FILE(empty_filename);
+  handler.writeExperiment(empty_filename, MSExperiment());
+  handler.open(empty_filename);
+  TEST_EQUAL(handler.getNrSpectra(), 0)
+  TEST_EQUAL(handler.getNrChromatograms(), 0)
+  MSExperiment loaded;
+  handler.readExperiment(loaded);
+  TEST_EQUAL(loaded.size(), 0)
+}
+END_SECTION
+
+START_SECTION(static bool isColMassFile(const String& filename))
+{
+  TEST_EQUAL(ColMassHandler::isColMassFile(tmp_filename), true)
+  TEST_EQUAL(ColMassHandler::isColMassFile(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")), false)
+  TEST_EQUAL(ColMassHandler::isColMassFile("this_file_does_not_exist.colMass"), false)
+}
+END_SECTION
+
+START_SECTION(void open(const String& filename))
+{
+  ColMassHandler handler;
+  handler.open(tmp_filename);
+  TEST_EQUAL(handler.isOpen(), true)
+  TEST_EXCEPTION(Exception::FileNotFound, handler.open("this_file_does_not_exist.colMass"))
+  TEST_EQUAL(handler.isOpen(), false)
+  TEST_EXCEPTION(Exception::ParseError, handler.open(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")))
+  TEST_EQUAL(handler.isOpen(), false)
+
+  // truncated file
+  std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  std::string truncated_filename;
+  NEW_TMP_FILE(truncated_filename);
+  std::ofstream ofs(truncated_filename.c_str(), std::ios::binary);
+  ofs << content.substr(0, content.size() - 10);
+  ofs.close();
+  TEST_EXCEPTION(Exception::ParseError, handler.open(truncated_filename))
+
+  // corrupt index
+  std::string corrupt = content;
+  UInt64 index_offset;
+  memcpy(&index_offset, &corrupt[corrupt.size() - 32], sizeof(index_offset));
+  index_offset = corrupt.size();
+  memcpy(&corrupt[corrupt.size() - 32], &index_offset, sizeof(index_offset));
+  std::string corrupt_filename;
+  NEW_TMP_FILE(corrupt_filename);
+  std::ofstream ofs2(corrupt_filename.c_str(), std::ios::binary);
+  ofs2 << corrupt;
+  ofs2.close();
+  TEST_EXCEPTION(Exception::ParseError, handler.open(corrupt_filename))
+  TEST_EQUAL(handler.isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(bool isOpen() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  ColMassHandler handler;
+  handler.open(tmp_filename);
+  TEST_EQUAL(handler.getNrSpectra(), 36)
+  handler.close();
+  TEST_EQUAL(handler.isOpen(), false)
+  TEST_EQUAL(handler.getNrSpectra(), 0)
+  TEST_EQUAL(handler.getSpectrumGroups().size(), 0)
+}
+END_SECTION
+
+ColMassHandler handler;
+handler.open(tmp_filename);
+
+START_SECTION(Size getNrSpectra() const)
+{
+  TEST_EQUAL(handler.getNrSpectra(), 36)
+}
+END_SECTION
+
+START_SECTION(Size getNrChromatograms() const)
+{
+  TEST_EQUAL(handler.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(const std::vector<SpectrumGroup>& getSpectrumGroups() const)
+{
+  const std::vector<ColMassHandler::SpectrumGroup>& groups = handler.getSpectrumGroups();
+  TEST_EQUAL(groups.size(), 3)
+  TEST_EQUAL(groups[0].ms_level, 1)
+  TEST_REAL_SIMILAR(groups[0].isolation_lower, 0.0)
+  TEST_REAL_SIMILAR(groups[0].isolation_upper, 0.0)
+  TEST_EQUAL(groups[1].ms_level, 2)
+  TEST_REAL_SIMILAR(groups[1].isolation_lower, 400.0)
+  TEST_REAL_SIMILAR(groups[1].isolation_upper, 500.0)
+  TEST_EQUAL(groups[2].ms_level, 2)
+  TEST_REAL_SIMILAR(groups[2].isolation_lower, 500.0)
+  TEST_REAL_SIMILAR(groups[2].isolation_upper, 600.0)
+  // 12 spectra per group in blocks of 5
+  TEST_EQUAL(groups[0].nr_blocks, 3)
+  TEST_EQUAL(groups[1].first_block, 3)
+  TEST_EQUAL(groups[2].nr_blocks, 3)
+}
+END_SECTION
+
+START_SECTION(Size getSpectrumGroupIndex(Size index) const)
+{
+  TEST_EQUAL(handler.getSpectrumGroupIndex(0), 0)
+  TEST_EQUAL(handler.getSpectrumGroupIndex(1), 1)
+  TEST_EQUAL(handler.getSpectrumGroupIndex(35), 2)
+}
+END_SECTION
+
+START_SECTION(double getSpectrumRT(Size index) const)
+{
+  TEST_REAL_SIMILAR(handler.getSpectrumRT(0), 10.0)
+  TEST_REAL_SIMILAR(handler.getSpectrumRT(35), 45.0)
+}
+END_SECTION
+
+START_SECTION(Size getSpectrumSize(Size index) const)
+{
+  TEST_EQUAL(handler.getSpectrumSize(0), 20)
+  TEST_EQUAL(handler.getSpectrumSize(1), 15)
+  TEST_EQUAL(handler.getSpectrumSize(17), 0)
+}
+END_SECTION
+
+START_SECTION(void getSpectrum(Size index, MSSpectrum& spectrum) const)
+{
+  MSSpectrum spectrum;
+  bool all_equal = true;
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    handler.getSpectrum(i, spectrum);
+    MSSpectrum expected = sortedSpectrum(exp[i]);
+    TEST_EQUAL(spectrum.size(), expected.size())
+    TEST_REAL_SIMILAR(spectrum.getRT(), expected.getRT())
+    TEST_EQUAL(spectrum.getMSLevel(), expected.getMSLevel())
+    for (Size k = 0; k < spectrum.size(); ++k)
+    {
+      // lossless
+      all_equal &= spectrum[k].getMZ() == expected[k].getMZ() && spectrum[k].getIntensity() == expected[k].getIntensity();
+    }
+    TEST_EQUAL(spectrum.getFloatDataArrays().size(), expected.getFloatDataArrays().size())
+    if (!expected.getFloatDataArrays().empty())
+    {
+      TEST_EQUAL(spectrum.getFloatDataArrays()[0].getName(), "Ion Mobility")
+      TEST_EQUAL(spectrum.getFloatDataArrays()[0] == expected.getFloatDataArrays()[0], true)
+    }
+  }
+  TEST_EQUAL(all_equal, true)
+
+  // the unsorted spectrum is returned sorted
+  handler.getSpectrum(10, spectrum);
+  TEST_EQUAL(spectrum.isSorted(), true)
+  TEST_REAL_SIMILAR(spectrum[0].getMZ(), 440.0)
+  TEST_REAL_SIMILAR(spectrum[0].getIntensity(), 153.0)
+  TEST_REAL_SIMILAR(spectrum.getFloatDataArrays()[0][0], 0.94)
+
+  TEST_EXCEPTION(Exception::IndexOverflow, handler.getSpectrum(36, spectrum))
+}
+END_SECTION
+
+START_SECTION(void getChromatogram(Size index, MSChromatogram& chromatogram) const)
+{
+  MSChromatogram chromatogram;
+  handler.getChromatogram(1, chromatogram);
+  TEST_EQUAL(chromatogram.size(), 30)
+  TEST_EQUAL(chromatogram[7].getRT() == exp.getChromatograms()[1][7].getRT(), true)
+  TEST_EQUAL(chromatogram[7].getIntensity() == exp.getChromatograms()[1][7].getIntensity(), true)
+  TEST_EXCEPTION(Exception::IndexOverflow, handler.getChromatogram(2, chromatogram))
+}
+END_SECTION
+
+START_SECTION(void readMetaData(MSExperiment& exp) const)
+{
+  MSExperiment meta;
+  handler.readMetaData(meta);
+  TEST_EQUAL(meta.size(), 36)
+  TEST_EQUAL(meta.getNrChromatograms(), 2)
+  TEST_EQUAL(meta[4].getNativeID(), "scan=4")
+  TEST_EQUAL(meta[4].size(), 0)
+  TEST_EQUAL(meta[4].getPrecursors().size(), 1)
+  TEST_EQUAL(meta.getChromatograms()[1].getNativeID(), "chrom1")
+  TEST_EQUAL(meta.getChromatograms()[1].size(), 0)
+}
+END_SECTION
+
+START_SECTION(void readExperiment(MSExperiment& exp) const)
+{
+  MSExperiment loaded;
+  handler.readExperiment(loaded);
+  MSExperiment expected = exp;
+  for (MSSpectrum& spectrum : expected)
+  {
+    spectrum.sortByPosition();
+  }
+  expected.updateRanges();
+  TEST_EQUAL(loaded.size(), exp.size())
+  TEST_EQUAL(loaded.getNrChromatograms(), exp.getNrChromatograms())
+  bool all_equal = true;
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    all_equal &= loaded[i] == expected[i];
+  }
+  TEST_EQUAL(all_equal, true)
+  TEST_EQUAL(loaded.getChromatograms()[0] == expected.getChromatograms()[0], true)
+  TEST_EQUAL(loaded.getChromatograms()[1] == expected.getChromatograms()[1], true)
+}
+END_SECTION
+
+START_SECTION(void getArea(Size group, double min_rt, double max_rt, const std::vector<std::pair<double, double> >& mz_ranges, std::vector<OpenSwath::SpectrumPtr>& spectra, std::vector<OpenSwath::SpectrumMeta>& spectra_meta) const)
+{
+  std::vector<OpenSwath::SpectrumPtr> spectra;
+  std::vector<OpenSwath::SpectrumMeta> spectra_meta;
+  // overlapping and unsorted ranges
+  std::vector<std::pair<double, double> > ranges = {{590.0, 650.0}, {235.0, 245.0}, {600.0, 610.0}};
+  handler.getArea(1, 20.0, 30.0, ranges, spectra, spectra_meta);
+  // spectra 10 (RT 20), 13 (RT 23), 16 (RT 26) and 19 (RT 29) of the first isolation window
+  TEST_EQUAL(spectra.size(), 4)
+  TEST_EQUAL(spectra_meta.size(), 4)
+  TEST_EQUAL(spectra_meta[0].index, 10)
+  TEST_REAL_SIMILAR(spectra_meta[0].RT, 20.0)
+  TEST_EQUAL(spectra_meta[0].ms_level, 2)
+  TEST_EQUAL(spectra_meta[3].index, 19)
+
+  // m/z 240, 600 and 640
+  TEST_EQUAL(spectra[1]->getMZArray()->data.size(), 3)
+  TEST_REAL_SIMILAR(spectra[1]->getMZArray()->data[0], 240.0)
+  TEST_REAL_SIMILAR(spectra[1]->getMZArray()->data[1], 600.0)
+  TEST_REAL_SIMILAR(spectra[1]->getMZArray()->data[2], 640.0)
+  TEST_REAL_SIMILAR(spectra[1]->getIntensityArray()->data[1], 114.0)
+  TEST_EQUAL(spectra[1]->getDriftTimeArray() != nullptr, true)
+  TEST_REAL_SIMILAR(spectra[1]->getDriftTimeArray()->data[1], 0.9)
+
+  // m/z 600 and 640 from the unsorted spectrum (m/z 440 to 1000)
+  TEST_EQUAL(spectra[0]->getMZArray()->data.size(), 2)
+  TEST_REAL_SIMILAR(spectra[0]->getMZArray()->data[0], 600.0)
+
+  // results are appended, spectra without matching peaks are reported
+  ranges = {{1.0, 2.0}};
+  handler.getArea(0, 9.0, 11.0, ranges, spectra, spectra_meta);
+  TEST_EQUAL(spectra.size(), 5)
+  TEST_EQUAL(spectra_meta[4].index, 0)
+  TEST_EQUAL(spectra[4]->getMZArray()->data.size(), 0)
+  TEST_EQUAL(spectra[4]->getDriftTimeArray() == nullptr, true)
+
+  // peaks across all chunks
+  spectra.clear();
+  spectra_meta.clear();
+  ranges = {{0.0, 2000.0}};
+  handler.getArea(2, 0.0, 100.0, ranges, spectra, spectra_meta);
+  TEST_EQUAL(spectra.size(), 12)
+  TEST_EQUAL(spectra[0]->getMZArray()->data.size(), 15)
+  TEST_EQUAL(spectra[5]->getMZArray()->data.size(), 0)
+
+  TEST_EXCEPTION(Exception::IndexOverflow, handler.getArea(3, 0.0, 100.0, ranges, spectra, spectra_meta))
+}
+END_SECTION
+
+START_SECTION(void getArea(double min_rt, double max_rt, double min_mz, double max_mz, UInt ms_level, MSExperiment& exp) const)
+{
+  MSExperiment area;
+  handler.getArea(11.0, 15.0, 230.0, 285.0, 2, area);
+  // spectra 1, 2, 4 and 5
+  TEST_EQUAL(area.size(), 4)
+  TEST_REAL_SIMILAR(area[0].getRT(), 11.0)
+  TEST_REAL_SIMILAR(area[1].getRT(), 12.0)
+  TEST_REAL_SIMILAR(area[3].getRT(), 15.0)
+  TEST_EQUAL(area[0].size(), 2)
+  TEST_REAL_SIMILAR(area[0][0].getMZ(), 240.0)
+  TEST_REAL_SIMILAR(area[0][1].getMZ(), 280.0)
+  TEST_REAL_SIMILAR(area[1][0].getMZ(), 240.5)
+  TEST_EQUAL(area[0].getFloatDataArrays().size(), 1)
+  TEST_EQUAL(area[0].getFloatDataArrays()[0].getName(), "Ion Mobility")
+  TEST_EQUAL(area[1].getFloatDataArrays().size(), 0)
+
+  handler.getArea(0.0, 100.0, 0.0, 2000.0, 1, area);
+  TEST_EQUAL(area.size(), 12)
+  TEST_EQUAL(area[11].size(), 20)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,356 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
+///////////////////////////
+
+#include <OpenMS/IONMOBILITY/IMTypes.h>
+
+#include <algorithm>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ColumnarSpectrum, "$Id$")
+
+/////////////////////////////////////////////////////////////
+
+MSSpectrum spec;
+spec.setRT(12.5);
+spec.setMSLevel(2);
+spec.setName("spec");
+spec.setDriftTime(3.5);
+spec.setDriftTimeUnit(DriftTimeUnit::MILLISECOND);
+spec.getPrecursors().resize(1);
+spec.getPrecursors()[0].setMZ(500.25);
+for (Size i = 0; i < 10; ++i)
+{
+  spec.push_back(Peak1D(400.0 + 100.0 * i + 0.123456789, 10.0f * (i + 1)));
+}
+spec.getFloatDataArrays().resize(1);
+spec.getFloatDataArrays()[0].setName("f");
+spec.getStringDataArrays().resize(1);
+spec.getStringDataArrays()[0].setName("s");
+spec.getIntegerDataArrays().resize(1);
+spec.getIntegerDataArrays()[0].setName("i");
+for (Size i = 0; i < 10; ++i)
+{
+  spec.getFloatDataArrays()[0].push_back(i * 0.5f);
+  spec.getStringDataArrays()[0].push_back(String(i));
+  spec.getIntegerDataArrays()[0].push_back(Int(i));
+}
+
+ColumnarSpectrum* ptr = nullptr;
+ColumnarSpectrum* nullPointer = nullptr;
+START_SECTION((ColumnarSpectrum()))
+{
+  ptr = new ColumnarSpectrum();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_REAL_SIMILAR(ptr->getRT(), -1.0)
+  TEST_EQUAL(ptr->getMSLevel(), 1)
+  TEST_EQUAL(ptr->getMZStorage() == ColumnarSpectrum::MZStorage::DOUBLE, true)
+}
+END_SECTION
+
+START_SECTION((~ColumnarSpectrum()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((explicit ColumnarSpectrum(const MSSpectrum& spectrum, MZStorage mz_storage = MZStorage::DOUBLE)))
+{
+  ColumnarSpectrum cs(spec);
+  TEST_EQUAL(cs.size(), 10)
+  TEST_REAL_SIMILAR(cs.getRT(), 12.5)
+  TEST_EQUAL(cs.getMSLevel(), 2)
+  TEST_EQUAL(cs.getName(), "spec")
+  TEST_REAL_SIMILAR(cs.getDriftTime(), 3.5)
+  TEST_EQUAL(cs.getDriftTimeUnit() == DriftTimeUnit::MILLISECOND, true)
+  TEST_EQUAL(cs.getPrecursors().size(), 1)
+  TEST_EQUAL(cs.getFloatDataArrays().size(), 1)
+  TEST_EQUAL(cs.getStringDataArrays()[0][3], "3")
+  TEST_EQUAL(cs.getIntegerDataArrays()[0][4], 4)
+  TEST_EQUAL(cs.getMZArray().size(), 10)
+  TEST_EQUAL(cs.getMZOffsetArray().size(), 0)
+  for (Size i = 0; i < 10; ++i)
+  {
+    TEST_EQUAL(cs.getMZ(i), spec[i].getMZ())
+    TEST_EQUAL(cs.getIntensity(i), spec[i].getIntensity())
+  }
+
+  ColumnarSpectrum cf(spec, ColumnarSpectrum::MZStorage::FLOAT_OFFSET);
+  TEST_EQUAL(cf.getMZStorage() == ColumnarSpectrum::MZStorage::FLOAT_OFFSET, true)
+  TEST_EQUAL(cf.getMZArray().size(), 0)
+  TEST_EQUAL(cf.getMZOffsetArray().size(), 10)
+  TEST_REAL_SIMILAR(cf.getMZOffset(), (spec[0].getMZ() + spec[9].getMZ()) / 2)
+  for (Size i = 0; i < 10; ++i)
+  {
+    TEST_EQUAL(fabs(cf.getMZ(i) - spec[i].getMZ()) / spec[i].getMZ() < 1e-7, true)
+    TEST_EQUAL(cf.getIntensity(i), spec[i].getIntensity())
+  }
+}
+END_SECTION
+
+START_SECTION((MSSpectrum toMSSpectrum() const))
+{
+  ColumnarSpectrum cs(spec);
+  MSSpectrum back = cs.toMSSpectrum();
+  MSSpectrum expected = spec;
+  back.updateRanges();
+  expected.updateRanges();
+  TEST_EQUAL(back == expected, true)
+  TEST_EQUAL(back.getName(), "spec")
+}
+END_SECTION
+
+START_SECTION((bool operator==(const ColumnarSpectrum& rhs) const))
+{
+  ColumnarSpectrum cs(spec), cs2(spec);
+  TEST_EQUAL(cs == cs2, true)
+  cs2.setIntensity(3, 1.0f);
+  TEST_EQUAL(cs == cs2, false)
+  cs2 = cs;
+  cs2.setRT(1.0);
+  TEST_EQUAL(cs != cs2, true)
+}
+END_SECTION
+
+START_SECTION((void push_back(const PeakType& peak)))
+{
+  ColumnarSpectrum cs;
+  cs.push_back(Peak1D(100.0, 1.0f));
+  cs.emplace_back(200.0, 2.0f);
+  TEST_EQUAL(cs.size(), 2)
+  TEST_REAL_SIMILAR(cs[1].getMZ(), 200.0)
+  TEST_REAL_SIMILAR(cs[1].getIntensity(), 2.0)
+
+  cs.setMZStorage(ColumnarSpectrum::MZStorage::FLOAT_OFFSET, 150.0);
+  cs.push_back(Peak1D(300.0, 3.0f));
+  TEST_EQUAL(cs.size(), 3)
+  TEST_REAL_SIMILAR(cs.getMZ(0), 100.0)
+  TEST_REAL_SIMILAR(cs.getMZ(2), 300.0)
+  TEST_REAL_SIMILAR(cs.getMZOffsetArray()[2], 150.0)
+}
+END_SECTION
+
+START_SECTION((void setMZStorage(MZStorage mz_storage)))
+{
+  ColumnarSpectrum cs(spec);
+  cs.setMZStorage(ColumnarSpectrum::MZStorage::FLOAT_OFFSET);
+  TEST_REAL_SIMILAR(cs.getMZOffset(), 850.123456789)
+  cs.setMZStorage(ColumnarSpectrum::MZStorage::DOUBLE);
+  TEST_EQUAL(cs.getMZArray().size(), 10)
+  TEST_EQUAL(cs.getMZOffsetArray().size(), 0)
+  TOLERANCE_ABSOLUTE(1e-4)
+  for (Size i = 0; i < 10; ++i)
+  {
+    TEST_REAL_SIMILAR(cs.getMZ(i), spec[i].getMZ())
+  }
+  TOLERANCE_ABSOLUTE(1e-5)
+}
+END_SECTION
+
+START_SECTION((Size getPeakMemoryUsage() const))
+{
+  ColumnarSpectrum cs(spec);
+  TEST_EQUAL(cs.getPeakMemoryUsage(), 10 * (sizeof(double) + sizeof(float)))
+  TEST_EQUAL(cs.getPeakMemoryUsage() < spec.size() * sizeof(Peak1D), true)
+  ColumnarSpectrum cf(spec, ColumnarSpectrum::MZStorage::FLOAT_OFFSET);
+  TEST_EQUAL(cf.getPeakMemoryUsage(), 10 * (sizeof(float) + sizeof(float)))
+}
+END_SECTION
+
+START_SECTION((ConstIterator begin() const))
+{
+  ColumnarSpectrum cs(spec);
+  TEST_EQUAL(cs.end() - cs.begin(), 10)
+  Size count = 0;
+  for (const auto& p : cs)
+  {
+    TEST_EQUAL(p.getMZ(), spec[count].getMZ())
+    ++count;
+  }
+  TEST_EQUAL(count, 10)
+  ColumnarSpectrum::ConstIterator it = cs.begin() + 3;
+  TEST_REAL_SIMILAR(it->getIntensity(), 40.0)
+  TEST_REAL_SIMILAR(it[2].getIntensity(), 60.0)
+  auto max_it = std::max_element(cs.begin(), cs.end(), Peak1D::IntensityLess());
+  TEST_EQUAL(max_it.getIndex(), 9)
+}
+END_SECTION
+
+START_SECTION((void sortByPosition()))
+{
+  ColumnarSpectrum cs(spec);
+  TEST_EQUAL(cs.isSorted(), true)
+  // reverse the order of the peaks
+  ColumnarSpectrum rev;
+  rev.getFloatDataArrays().resize(1);
+  rev.getStringDataArrays().resize(1);
+  rev.getIntegerDataArrays().resize(1);
+  for (Size i = 10; i > 0; --i)
+  {
+    rev.push_back(cs[i - 1]);
+    rev.getFloatDataArrays()[0].push_back(cs.getFloatDataArrays()[0][i - 1]);
+    rev.getStringDataArrays()[0].push_back(cs.getStringDataArrays()[0][i - 1]);
+    rev.getIntegerDataArrays()[0].push_back(cs.getIntegerDataArrays()[0][i - 1]);
+  }
+  TEST_EQUAL(rev.isSorted(), false)
+  rev.sortByPosition();
+  TEST_EQUAL(rev.isSorted(), true)
+  for (Size i = 0; i < 10; ++i)
+  {
+    TEST_EQUAL(rev.getMZ(i), cs.getMZ(i))
+    TEST_EQUAL(rev.getIntensity(i), cs.getIntensity(i))
+    TEST_EQUAL(rev.getFloatDataArrays()[0][i], cs.getFloatDataArrays()[0][i])
+    TEST_EQUAL(rev.getStringDataArrays()[0][i], cs.getStringDataArrays()[0][i])
+    TEST_EQUAL(rev.getIntegerDataArrays()[0][i], cs.getIntegerDataArrays()[0][i])
+  }
+
+  // data arrays must match the number of peaks
+  rev.getFloatDataArrays()[0].pop_back();
+  rev.setIntensity(0, 500.0f);
+  rev.setMZ(0, 2000.0);
+  TEST_EXCEPTION(Exception::Precondition, rev.sortByPosition())
+}
+END_SECTION
+
+START_SECTION((Size findNearest(CoordinateType mz) const))
+{
+  for (auto storage : {ColumnarSpectrum::MZStorage::DOUBLE, ColumnarSpectrum::MZStorage::FLOAT_OFFSET})
+  {
+    ColumnarSpectrum cs(spec, storage);
+    TEST_EQUAL(cs.findNearest(0.0), 0)
+    TEST_EQUAL(cs.findNearest(449.0), 0)
+    TEST_EQUAL(cs.findNearest(451.0), 1)
+    TEST_EQUAL(cs.findNearest(700.1), 3)
+    TEST_EQUAL(cs.findNearest(5000.0), 9)
+  }
+  ColumnarSpectrum empty;
+  TEST_EXCEPTION(Exception::Precondition, empty.findNearest(1.0))
+}
+END_SECTION
+
+START_SECTION((Int findNearest(CoordinateType mz, CoordinateType tolerance) const))
+{
+  for (auto storage : {ColumnarSpectrum::MZStorage::DOUBLE, ColumnarSpectrum::MZStorage::FLOAT_OFFSET})
+  {
+    ColumnarSpectrum cs(spec, storage);
+    TEST_EQUAL(cs.findNearest(700.1, 0.1), 3)
+    TEST_EQUAL(cs.findNearest(700.1, 0.01), -1)
+    TEST_EQUAL(cs.findNearest(5000.0, 1.0), -1)
+  }
+  TEST_EQUAL(ColumnarSpectrum().findNearest(1.0, 1.0), -1)
+}
+END_SECTION
+
+START_SECTION((ConstIterator MZBegin(CoordinateType mz) const))
+{
+  for (auto storage : {ColumnarSpectrum::MZStorage::DOUBLE, ColumnarSpectrum::MZStorage::FLOAT_OFFSET})
+  {
+    ColumnarSpectrum cs(spec, storage);
+    TEST_EQUAL(cs.MZBegin(0.0).getIndex(), 0)
+    TEST_EQUAL(cs.MZBegin(500.0).getIndex(), 1)
+    TEST_EQUAL(cs.MZBegin(cs.getMZ(2)).getIndex(), 2)
+    TEST_EQUAL(cs.MZBegin(5000.0) == cs.end(), true)
+  }
+}
+END_SECTION
+
+START_SECTION((ConstIterator MZEnd(CoordinateType mz) const))
+{
+  for (auto storage : {ColumnarSpectrum::MZStorage::DOUBLE, ColumnarSpectrum::MZStorage::FLOAT_OFFSET})
+  {
+    ColumnarSpectrum cs(spec, storage);
+    TEST_EQUAL(cs.MZEnd(0.0).getIndex(), 0)
+    TEST_EQUAL(cs.MZEnd(500.0).getIndex(), 1)
+    TEST_EQUAL(cs.MZEnd(cs.getMZ(2)).getIndex(), 3)
+    TEST_EQUAL(cs.MZEnd(5000.0) == cs.end(), true)
+  }
+}
+END_SECTION
+
+START_SECTION((double sumIntensity(CoordinateType mz_min, CoordinateType mz_max) const))
+{
+  ColumnarSpectrum cs(spec);
+  TEST_REAL_SIMILAR(cs.sumIntensity(450.0, 750.0), 20.0 + 30.0 + 40.0)
+  TEST_REAL_SIMILAR(cs.sumIntensity(0.0, 10000.0), 550.0)
+  TEST_REAL_SIMILAR(cs.sumIntensity(410.0, 420.0), 0.0)
+}
+END_SECTION
+
+START_SECTION((double calculateTIC() const))
+{
+  ColumnarSpectrum cs(spec);
+  TEST_REAL_SIMILAR(cs.calculateTIC(), spec.calculateTIC())
+}
+END_SECTION
+
+START_SECTION((bool containsIMData() const))
+{
+  ColumnarSpectrum cs(spec);
+  TEST_EQUAL(cs.containsIMData(), false)
+  TEST_EXCEPTION(Exception::MissingInformation, cs.getIMData())
+  cs.getFloatDataArrays().resize(2);
+  cs.getFloatDataArrays()[1].setName("Ion Mobility");
+  TEST_EQUAL(cs.containsIMData(), true)
+  TEST_EQUAL(cs.getIMData().first, 1)
+}
+END_SECTION
+
+START_SECTION((void clear(bool clear_meta_data)))
+{
+  ColumnarSpectrum cs(spec, ColumnarSpectrum::MZStorage::FLOAT_OFFSET);
+  cs.clear(false);
+  TEST_EQUAL(cs.size(), 0)
+  TEST_EQUAL(cs.getFloatDataArrays().size(), 0)
+  TEST_REAL_SIMILAR(cs.getRT(), 12.5)
+  cs.clear(true);
+  TEST_REAL_SIMILAR(cs.getRT(), -1.0)
+  TEST_EQUAL(cs.getMSLevel(), 1)
+  TEST_EQUAL(cs.getPrecursors().size(), 0)
+  TEST_EQUAL(cs.getMZStorage() == ColumnarSpectrum::MZStorage::DOUBLE, true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
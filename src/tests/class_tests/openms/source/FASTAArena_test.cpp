@@ -0,0 +1,231 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/FASTAArena.h>
+///////////////////////////
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+// reads all entries of @p filename with the streaming reader of FASTAFile
+vector<FASTAFile::FASTAEntry> readStreaming(const String& filename)
+{
+  vector<FASTAFile::FASTAEntry> entries;
+  FASTAFile f;
+  f.readStart(filename);
+  FASTAFile::FASTAEntry e;
+  while (f.readNext(e))
+  {
+    entries.push_back(e);
+  }
+  return entries;
+}
+
+void writeFile(const String& filename, const String& content)
+{
+  ofstream ofs(filename.c_str(), ios::binary);
+  ofs << content;
+}
+
+START_TEST(FASTAArena, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+FASTAArena* ptr = nullptr;
+FASTAArena* null_ptr = nullptr;
+START_SECTION(FASTAArena())
+{
+  ptr = new FASTAArena();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+}
+END_SECTION
+
+START_SECTION(~FASTAArena())
+{
+  delete ptr;
+}
+END_SECTION
+
+FASTAArena arena;
+
+START_SECTION(void load(const String& filename))
+{
+  arena.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(arena.size(), 5)
+  vector<FASTAFile::FASTAEntry> expected = readStreaming(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  ABORT_IF(expected.size() != arena.size())
+  for (Size i = 0; i < arena.size(); ++i)
+  {
+    FASTAFile::FASTAEntry e;
+    arena.getEntry(i, e);
+    TEST_EQUAL(e == expected[i], true)
+  }
+
+  TEST_EXCEPTION(Exception::FileNotFound, FASTAArena().load("FASTAArena_test_this_file_does_not_exist"))
+
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+
+  // Windows line endings, tabs and spaces, no newline at the end of the file
+  writeFile(tmp_file, ">P1\tdesc\tription 1\r\nAC DE\r\nFG\r\n\r\n>P2\r\nKLM\r\n>  P3 \r\nNPQ");
+  FASTAArena a;
+  a.load(tmp_file);
+  vector<FASTAFile::FASTAEntry> streamed = readStreaming(tmp_file);
+  TEST_EQUAL(a.size(), 3)
+  ABORT_IF(streamed.size() != 3)
+  for (Size i = 0; i < a.size(); ++i)
+  {
+    FASTAFile::FASTAEntry e;
+    a.getEntry(i, e);
+    TEST_EQUAL(e == streamed[i], true)
+  }
+  TEST_EQUAL(a.getIdentifier(0).getString(), "P1")
+  TEST_EQUAL(a.getDescription(0).getString(), "description 1")
+  TEST_EQUAL(a.getSequence(0).getString(), "ACDEFG")
+  TEST_EQUAL(a.getDescription(1).getString(), "")
+  TEST_EQUAL(a.getIdentifier(2).getString(), "P3")
+  TEST_EQUAL(a.getSequence(2).getString(), "NPQ")
+
+  // invalid files
+  writeFile(tmp_file, "");
+  TEST_EXCEPTION(Exception::ParseError, a.load(tmp_file))
+  writeFile(tmp_file, "# PEFF header only\n");
+  TEST_EXCEPTION(Exception::ParseError, a.load(tmp_file))
+  writeFile(tmp_file, "ACDE\n>P1\nACDE\n");
+  TEST_EXCEPTION(Exception::ParseError, a.load(tmp_file))
+  writeFile(tmp_file, ">P1\nACDE\n>P2 header without sequence\n");
+  TEST_EXCEPTION(Exception::ParseError, a.load(tmp_file))
+  writeFile(tmp_file, ">P1\nACDE\n>\nACDE\n");
+  TEST_EXCEPTION(Exception::ParseError, a.load(tmp_file))
+  // a failed load does not change the content
+  TEST_EQUAL(a.size(), 3)
+
+  // a file large enough to be split into several blocks
+  String large_file;
+  NEW_TMP_FILE(large_file)
+  {
+    ofstream ofs(large_file.c_str(), ios::binary);
+    ofs << "# header\n";
+    for (Size i = 0; i < 40000; ++i)
+    {
+      ofs << ">sp|P" << i << "|PROT_" << i << " description of protein " << i << "\n";
+      for (Size line = 0; line < 1 + i % 4; ++line)
+      {
+        ofs << String(1 + (i * 7 + line * 13) % 60, char('A' + (i + line) % 26)) << "\n";
+      }
+    }
+  }
+  a.load(large_file);
+  streamed = readStreaming(large_file);
+  TEST_EQUAL(a.size(), 40000)
+  ABORT_IF(streamed.size() != a.size())
+  Size mismatches = 0;
+  for (Size i = 0; i < a.size(); ++i)
+  {
+    FASTAFile::FASTAEntry e;
+    a.getEntry(i, e);
+    mismatches += (e == streamed[i]) ? 0 : 1;
+  }
+  TEST_EQUAL(mismatches, 0)
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  TEST_EQUAL(arena.size(), 5)
+}
+END_SECTION
+
+START_SECTION(bool empty() const)
+{
+  TEST_EQUAL(arena.empty(), false)
+}
+END_SECTION
+
+START_SECTION(StringView getIdentifier(Size index) const)
+{
+  TEST_EQUAL(arena.getIdentifier(0).getString(), "P68509|1433F_BOVIN")
+  TEST_EQUAL(arena.getIdentifier(4).getString(), "test")
+}
+END_SECTION
+
+START_SECTION(StringView getDescription(Size index) const)
+{
+  TEST_EQUAL(arena.getDescription(0).getString(), "This is the description of the first protein")
+  TEST_EQUAL(arena.getDescription(4).getString(), " ##0")
+}
+END_SECTION
+
+START_SECTION(StringView getSequence(Size index) const)
+{
+  TEST_EQUAL(arena.getSequence(0).getString().hasPrefix("GDREQLLQRARLAEQAERYDDMASAMKAVTEL"), true)
+  TEST_EQUAL(arena.getSequence(0).getString().hasSuffix("LRDNLTLWTSDQQDEEAGEGN"), true)
+  TEST_EQUAL(arena.getSequence(3).getString().hasPrefix("(ICPL:13C(6))MTMDKSELVQ"), true)
+}
+END_SECTION
+
+START_SECTION(void getEntry(Size index, FASTAFile::FASTAEntry& entry) const)
+{
+  FASTAFile::FASTAEntry e;
+  arena.getEntry(1, e);
+  TEST_EQUAL(e.identifier, "Q9CQV8|1433B_MOUSE")
+  TEST_EQUAL(e.description, "This is the description of the second protein")
+  TEST_EQUAL(e.sequence.size(), arena.getSequence(1).size())
+}
+END_SECTION
+
+START_SECTION((void getEntries(Size first, Size last, std::vector<FASTAFile::FASTAEntry>& entries) const))
+{
+  vector<FASTAFile::FASTAEntry> entries;
+  arena.getEntries(1, 4, entries);
+  TEST_EQUAL(entries.size(), 3)
+  TEST_EQUAL(entries[0].identifier, "Q9CQV8|1433B_MOUSE")
+  TEST_EQUAL(entries[2].identifier, "sp|P00000|0000A_UNKNOWN")
+  arena.getEntries(5, 5, entries);
+  TEST_EQUAL(entries.empty(), true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -49,6 +49,7 @@ START_TEST(FASTAContainer, "$Id$")
 
 typedef FASTAContainer<TFI_Vector> FCVec;
 typedef FASTAContainer<TFI_File> FCFile;
+typedef FASTAContainer<TFI_Arena> FCArena;
 
 FCVec* ptr = nullptr;
 FCVec* nullPointer = nullptr;
@@ -220,6 +221,51 @@ START_SECTION(size_t size() const)
 
 END_SECTION
 
+START_SECTION([EXTRA] FASTAContainer<TFI_Arena>)
+{
+  FCArena a(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(a.size(), 5) // known right away
+  TEST_EQUAL(a.empty(), false)
+  TEST_EQUAL(a.getArena().getIdentifier(4).getString(), "test")
+
+  // same chunks as when reading from the file
+  FCFile f(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  for (int chunk_size : {2, 2, 2})
+  {
+    TEST_EQUAL(a.cacheChunk(chunk_size), f.cacheChunk(chunk_size))
+    TEST_EQUAL(a.activateCache(), f.activateCache())
+    TEST_EQUAL(a.getChunkOffset(), f.getChunkOffset())
+    TEST_EQUAL(a.chunkSize(), f.chunkSize())
+    for (size_t i = 0; i < a.chunkSize(); ++i)
+    {
+      TEST_EQUAL(a.chunkAt(i) == f.chunkAt(i), true)
+    }
+  }
+  TEST_EQUAL(a.chunkSize(), 1)
+  TEST_EQUAL(a.cacheChunk(2), false)
+  TEST_EQUAL(a.activateCache(), false)
+
+  // random access to all entries
+  FASTAFile::FASTAEntry pe;
+  TEST_EQUAL(a.readAt(pe, 1), true)
+  TEST_EQUAL(pe.identifier, "Q9CQV8|1433B_MOUSE")
+  TEST_EQUAL(a.readAt(pe, 5), false)
+
+  // start again
+  a.reset();
+  TEST_EQUAL(a.cacheChunk(10), true)
+  TEST_EQUAL(a.activateCache(), true)
+  TEST_EQUAL(a.getChunkOffset(), 0)
+  TEST_EQUAL(a.chunkSize(), 5)
+  TEST_EQUAL(a.chunkAt(0).description, "This is the description of the first protein")
+
+  // decoy detection works on all containers
+  FCArena a2(OPENMS_GET_TEST_DATA_PATH("FASTAContainer_test.fasta"));
+  DecoyHelper::Result r2 = {true, "DECOY_", true};
+  TEST_EQUAL(DecoyHelper::findDecoyString(a2) == r2, true);
+}
+END_SECTION
+
 START_SECTION(Result findDecoyString(FASTAContainer<T>& proteins))
 // test without decoys in input
   FASTAContainer<TFI_File> f1{OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta")};
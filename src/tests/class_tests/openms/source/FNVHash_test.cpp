@@ -0,0 +1,109 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/FNVHash.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(FNVHash, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+START_SECTION((UInt64 getHash() const))
+{
+  // offset basis and the reference value of the FNV-1a test suite
+  TEST_EQUAL(Internal::FNVHash().getHash(), 14695981039346656037ull)
+  Internal::FNVHash hash;
+  hash.add("a", 1);
+  TEST_EQUAL(hash.getHash(), 0xaf63dc4c8601ec8cull)
+}
+END_SECTION
+
+START_SECTION((void add(const char* data, Size size)))
+{
+  Internal::FNVHash whole, parts;
+  whole.add("foobar", 6);
+  parts.add("foo", 3);
+  parts.add("bar", 3);
+  TEST_EQUAL(whole.getHash(), parts.getHash())
+  TEST_EQUAL(whole.getHash(), 0x85944171f73967e8ull)
+}
+END_SECTION
+
+START_SECTION((void add(char c)))
+{
+  Internal::FNVHash chars, bytes;
+  chars.add('a');
+  chars.add('\n');
+  bytes.add("a\n", 2);
+  TEST_EQUAL(chars.getHash(), bytes.getHash())
+}
+END_SECTION
+
+START_SECTION((void add(const String& s)))
+{
+  // the terminating zero separates consecutive strings
+  Internal::FNVHash ab_c, a_bc;
+  ab_c.add(String("ab"));
+  ab_c.add(String("c"));
+  a_bc.add(String("a"));
+  a_bc.add(String("bc"));
+  TEST_NOT_EQUAL(ab_c.getHash(), a_bc.getHash())
+  Internal::FNVHash bytes;
+  bytes.add("ab", 3);
+  Internal::FNVHash string;
+  string.add(String("ab"));
+  TEST_EQUAL(string.getHash(), bytes.getHash())
+}
+END_SECTION
+
+START_SECTION((String toHex() const))
+{
+  TEST_EQUAL(Internal::FNVHash().toHex(), "cbf29ce484222325")
+  Internal::FNVHash hash;
+  hash.add("a", 1);
+  TEST_EQUAL(hash.toHex(), "af63dc4c8601ec8c")
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
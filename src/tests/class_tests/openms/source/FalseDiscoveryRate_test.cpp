@@ -177,6 +177,47 @@ START_SECTION((void apply(std::vector<PeptideIdentification> &id)))
 }
 END_SECTION
 
+START_SECTION([EXTRA] void apply(std::vector<PeptideIdentification> &id, bool annotate_peptide_fdr) with split charge variants)
+{
+  // charge 2: targets 10, 9, 7 and decoys 8, 5; charge 3: target only; charge 4: decoy only
+  vector<PeptideIdentification> pep_ids;
+  const double scores[] = {10.0, 8.0, 9.0, 5.0, 7.0, 99.0, 98.0};
+  const Int charges[] = {2, 2, 2, 2, 2, 3, 4};
+  const char* labels[] = {"target", "decoy", "target+decoy", "decoy", "target", "target", "decoy"};
+  for (Size i = 0; i < 7; ++i)
+  {
+    PeptideHit hit;
+    hit.setScore(scores[i]);
+    hit.setCharge(charges[i]);
+    hit.setMetaValue("target_decoy", labels[i]);
+    PeptideIdentification pep_id;
+    pep_id.setScoreType("XTandem");
+    pep_id.setHigherScoreBetter(true);
+    pep_id.insertHit(hit);
+    pep_ids.push_back(pep_id);
+  }
+
+  FalseDiscoveryRate fdr;
+  Param param = fdr.getParameters();
+  param.setValue("split_charge_variants", "true");
+  param.setValue("add_decoy_peptides", "true");
+  fdr.setParameters(param);
+  fdr.apply(pep_ids);
+
+  const double expected[] = {0.0, 1.0 / 3.0, 0.0, 1.0 / 3.0, 1.0 / 3.0, 0.0};
+  for (Size i = 0; i < 6; ++i)
+  {
+    TEST_EQUAL(pep_ids[i].getScoreType(), "q-value")
+    TEST_EQUAL(pep_ids[i].isHigherScoreBetter(), false)
+    TEST_EQUAL(pep_ids[i].getHits().size(), 1)
+    TEST_REAL_SIMILAR(pep_ids[i].getHits()[0].getScore(), expected[i])
+    TEST_REAL_SIMILAR(pep_ids[i].getHits()[0].getMetaValue("XTandem_score"), scores[i])
+  }
+  // decoys without any targets are removed
+  TEST_EQUAL(pep_ids[6].getHits().size(), 0)
+}
+END_SECTION
+
 START_SECTION((void apply(std::vector<ProteinIdentification>& ids)))
 {
   vector<ProteinIdentification> fwd_prot_ids, rev_prot_ids, prot_ids;
@@ -41,6 +41,10 @@
 #include <OpenMS/FILTERING/DATAREDUCTION/ElutionPeakDetection.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////
 #include <OpenMS/FILTERING/DATAREDUCTION/FeatureFindingMetabo.h>
 ///////////////////////////
@@ -129,6 +133,42 @@ START_SECTION((void run(std::vector< MassTrace > &, FeatureMap &, chromatograms
 }
 END_SECTION
 
+START_SECTION(([EXTRA] hypotheses are independent of the number of threads))
+{
+  // label, charge and quality of the features found in (a copy of) the traces, single-threaded if @p serial is set
+  auto findFeatures = [](FeatureFindingMetabo& ffm, std::vector<MassTrace> traces, bool serial)
+  {
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    if (serial) omp_set_num_threads(1);
+#endif
+    FeatureMap fm;
+    std::vector<std::vector<MSChromatogram> > chroms;
+    ffm.run(traces, fm, chroms);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    String summary;
+    for (const Feature& f : fm)
+    {
+      summary += f.getMetaValue("label").toString() + " " + String(f.getCharge()) + " " + String(f.getOverallQuality()) + "\n";
+    }
+    return summary;
+  };
+
+  FeatureFindingMetabo test_ffm;
+  for (const String model : {"metabolites (5% RMS)", "peptides"})
+  {
+    Param p = test_ffm.getParameters();
+    p.setValue("isotope_filtering_model", model);
+    test_ffm.setParameters(p);
+
+    const String serial = findFeatures(test_ffm, splitted_mt, true);
+    TEST_NOT_EQUAL(serial, "")
+    TEST_EQUAL(findFeatures(test_ffm, splitted_mt, false), serial)
+  }
+}
+END_SECTION
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -36,6 +36,16 @@
 #include <OpenMS/test_config.h>
 
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureGroupingAlgorithmKD.h>
+#include <OpenMS/ANALYSIS/MAPMATCHING/LinkingFeatureStore.h>
+
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/KERNEL/ConsensusMap.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace OpenMS;
 using namespace std;
@@ -78,6 +88,122 @@ START_SECTION((virtual void group(const std::vector<ConsensusMap>& maps, Consens
   NOT_TESTABLE;
 END_SECTION
 
+START_SECTION((void group(LinkingFeatureStore& store, ConsensusMap& out)))
+{
+  vector<FeatureMap> maps(4);
+  for (Size i = 0; i < maps.size(); ++i)
+  {
+    for (Size j = 0; j < 300; ++j)
+    {
+      if ((i * 3 + j) % 7 == 0) continue;
+      Feature f;
+      f.setMZ(300.0 + j * 2.11 + ((i + j) % 5 == 0 ? 0.04 : 0.0));
+      f.setRT(200.0 + (j * 29) % 1000 + i * 4.0);
+      f.setIntensity(500.0f + 3 * j + i);
+      f.setOverallQuality(0.1f * (j % 10));
+      f.setCharge(j % 3);
+      f.setUniqueId(i * 1000 + j + 1);
+      if (j % 11 == 0)
+      {
+        f.setMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS, "H1");
+      }
+      if (j % 4 == 0)
+      {
+        f.getPeptideIdentifications().resize(1);
+      }
+      maps[i].push_back(f);
+    }
+    maps[i].getUnassignedPeptideIdentifications().resize(1);
+    maps[i].updateRanges();
+  }
+
+  FeatureGroupingAlgorithmKD fga;
+  Param p = fga.getParameters();
+  p.setValue("nr_partitions", 10);
+  fga.setParameters(p);
+
+  ConsensusMap in_memory;
+  fga.group(maps, in_memory);
+
+  ConsensusMap out_of_core;
+  LinkingFeatureStore store(File::getTemporaryFile());
+  for (const FeatureMap& map : maps)
+  {
+    store.addMap(map);
+  }
+  fga.group(store, out_of_core);
+  for (Size i = 0; i < maps.size(); ++i)
+  {
+    store.restoreIdentifications(i, maps[i], out_of_core);
+  }
+  in_memory.sortPeptideIdentificationsByMapIndex();
+
+  ABORT_IF(in_memory.size() != out_of_core.size())
+  for (Size i = 0; i < in_memory.size(); ++i)
+  {
+    TEST_EQUAL(in_memory[i].getFeatures() == out_of_core[i].getFeatures(), true)
+    TEST_REAL_SIMILAR(in_memory[i].getRT(), out_of_core[i].getRT())
+    TEST_REAL_SIMILAR(in_memory[i].getMZ(), out_of_core[i].getMZ())
+    TEST_REAL_SIMILAR(in_memory[i].getQuality(), out_of_core[i].getQuality())
+    TEST_EQUAL(in_memory[i].getPeptideIdentifications() == out_of_core[i].getPeptideIdentifications(), true)
+  }
+  TEST_EQUAL(in_memory.getUnassignedPeptideIdentifications() == out_of_core.getUnassignedPeptideIdentifications(), true)
+}
+END_SECTION
+
+START_SECTION([EXTRA] partitions linked in parallel give the same result as serial linking)
+{
+  // several maps with features spread over many m/z partitions and a small RT shift per map
+  vector<FeatureMap> maps(6);
+  for (Size i = 0; i < maps.size(); ++i)
+  {
+    for (Size j = 0; j < 600; ++j)
+    {
+      // leave gaps and move some features out of the m/z tolerance
+      if ((i * 7 + j) % 5 == 0) continue;
+      Feature f;
+      f.setMZ(200.0 + j * 1.37 + (i % 3) * 0.0005 + ((i + j) % 9 == 0 ? 0.05 : 0.0));
+      f.setRT(100.0 + (j * 37) % 1500 + i * 2.5);
+      f.setIntensity(1000.0f + j + i);
+      f.setCharge(1 + j % 3);
+      f.setUniqueId(i * 1000 + j + 1);
+      maps[i].push_back(f);
+    }
+    maps[i].updateRanges();
+    maps[i].setUniqueId(i + 1);
+  }
+
+  FeatureGroupingAlgorithmKD fga;
+  Param p = fga.getParameters();
+  p.setValue("nr_partitions", 20);
+  fga.setParameters(p);
+
+  ConsensusMap serial, parallel;
+#ifdef _OPENMP
+  int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  fga.group(maps, serial);
+#ifdef _OPENMP
+  omp_set_num_threads(max(max_threads, 4));
+#endif
+  fga.group(maps, parallel);
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  TEST_EQUAL(serial.size() > 600, true)
+  ABORT_IF(serial.size() != parallel.size())
+  for (Size i = 0; i < serial.size(); ++i)
+  {
+    TEST_EQUAL(serial[i].size(), parallel[i].size())
+    TEST_REAL_SIMILAR(serial[i].getRT(), parallel[i].getRT())
+    TEST_REAL_SIMILAR(serial[i].getMZ(), parallel[i].getMZ())
+    TEST_REAL_SIMILAR(serial[i].getQuality(), parallel[i].getQuality())
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
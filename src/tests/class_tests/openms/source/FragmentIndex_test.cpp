@@ -0,0 +1,338 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(FragmentIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+FragmentIndex* ptr = nullptr;
+FragmentIndex* null_ptr = nullptr;
+
+// four peptides (not sorted by mass) with unsorted fragments
+vector<FragmentIndex::Peptide> peptides(4);
+vector<vector<FragmentIndex::Fragment> > fragments(4);
+peptides[0].sequence = "PEPA";
+peptides[0].mass = 1000.0;
+fragments[0] = { {300.0, 1.0f, 'y'}, {100.0, 1.0f, 'b'}, {200.0, 0.5f, 'b'} };
+peptides[1].sequence = "PEPB";
+peptides[1].mass = 800.0;
+fragments[1] = { {100.0, 1.0f, 'b'}, {250.0, 1.0f, 'y'} };
+peptides[2].sequence = "PEPC";
+peptides[2].modification_index = 1;
+peptides[2].mass = 1000.0;
+fragments[2] = { {400.0, 1.0f, 'y'}, {300.005, 1.0f, 'b'} };
+peptides[3].sequence = "PEPD";
+peptides[3].mass = 1200.0;
+fragments[3] = { {99.9, 1.0f, 'b'}, {100.1, 1.0f, 'y'} };
+
+START_SECTION(FragmentIndex())
+{
+  ptr = new FragmentIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_REAL_SIMILAR(ptr->getBinWidth(), 0.02)
+  TEST_EQUAL(ptr->empty(), true)
+}
+END_SECTION
+
+START_SECTION(~FragmentIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(explicit FragmentIndex(double bin_width))
+{
+  FragmentIndex index(0.5);
+  TEST_REAL_SIMILAR(index.getBinWidth(), 0.5)
+  TEST_EXCEPTION(Exception::InvalidValue, FragmentIndex(0.0))
+  TEST_EXCEPTION(Exception::InvalidValue, FragmentIndex(-1.0))
+}
+END_SECTION
+
+START_SECTION((void build(std::vector<Peptide> peptides, const std::vector<std::vector<Fragment>>& fragments)))
+{
+  FragmentIndex index(0.5);
+  index.build(peptides, fragments);
+  TEST_EQUAL(index.size(), 4)
+  TEST_EQUAL(index.empty(), false)
+
+  // sorted by mass, ties by sequence
+  TEST_EQUAL(index.getPeptide(0).sequence, "PEPB")
+  TEST_EQUAL(index.getPeptide(1).sequence, "PEPA")
+  TEST_EQUAL(index.getPeptide(2).sequence, "PEPC")
+  TEST_EQUAL(index.getPeptide(2).modification_index, 1)
+  TEST_EQUAL(index.getPeptide(3).sequence, "PEPD")
+  TEST_REAL_SIMILAR(index.getPeptide(3).mass, 1200.0)
+
+  vector<vector<FragmentIndex::Fragment> > too_few(3);
+  TEST_EXCEPTION(Exception::InvalidSize, index.build(peptides, too_few))
+}
+END_SECTION
+
+FragmentIndex index(0.5);
+index.build(peptides, fragments);
+
+START_SECTION(void clear())
+{
+  FragmentIndex tmp(index);
+  tmp.clear();
+  TEST_EQUAL(tmp.size(), 0)
+  TEST_EQUAL(tmp.empty(), true)
+  TEST_EQUAL(tmp.getPeptideRange(0.0, 10000.0).first, tmp.getPeptideRange(0.0, 10000.0).second)
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  TEST_EQUAL(index.size(), 4)
+}
+END_SECTION
+
+START_SECTION(bool empty() const)
+{
+  TEST_EQUAL(index.empty(), false)
+  TEST_EQUAL(FragmentIndex().empty(), true)
+}
+END_SECTION
+
+START_SECTION(double getBinWidth() const)
+{
+  TEST_REAL_SIMILAR(index.getBinWidth(), 0.5)
+}
+END_SECTION
+
+START_SECTION(const std::vector<Peptide>& getPeptides() const)
+{
+  TEST_EQUAL(index.getPeptides().size(), 4)
+  TEST_EQUAL(index.getPeptides()[1].sequence, "PEPA")
+}
+END_SECTION
+
+START_SECTION(const Peptide& getPeptide(Size id) const)
+{
+  TEST_EQUAL(index.getPeptide(0).sequence, "PEPB")
+  TEST_REAL_SIMILAR(index.getPeptide(0).mass, 800.0)
+}
+END_SECTION
+
+START_SECTION(const String& getSignature() const)
+{
+  TEST_EQUAL(index.getSignature(), "")
+}
+END_SECTION
+
+START_SECTION(void setSignature(const String& signature))
+{
+  FragmentIndex tmp;
+  tmp.setSignature("enzyme=Trypsin");
+  TEST_EQUAL(tmp.getSignature(), "enzyme=Trypsin")
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const))
+{
+  pair<Size, Size> range = index.getPeptideRange(900.0, 1100.0);
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 3)
+  range = index.getPeptideRange(800.0, 1000.0);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 3)
+  range = index.getPeptideRange(0.0, 10.0);
+  TEST_EQUAL(range.first, range.second)
+  range = index.getPeptideRange(2000.0, 3000.0);
+  TEST_EQUAL(range.first, 4)
+  TEST_EQUAL(range.second, 4)
+  range = index.getPeptideRange(1100.0, 900.0);
+  TEST_EQUAL(range.first, range.second)
+}
+END_SECTION
+
+START_SECTION((void getSpectrum(Size id, PeakSpectrum& spectrum) const))
+{
+  PeakSpectrum spec;
+  spec.emplace_back(1.0, 1.0f); // cleared
+  index.getSpectrum(1, spec);
+  TEST_EQUAL(spec.size(), 3)
+  TEST_EQUAL(spec.isSorted(), true)
+  TEST_REAL_SIMILAR(spec[0].getMZ(), 100.0)
+  TEST_REAL_SIMILAR(spec[1].getMZ(), 200.0)
+  TEST_REAL_SIMILAR(spec[1].getIntensity(), 0.5)
+  TEST_REAL_SIMILAR(spec[2].getMZ(), 300.0)
+  TEST_EQUAL(spec.getStringDataArrays().size(), 1)
+  TEST_EQUAL(spec.getStringDataArrays()[0].getName(), "IonNames")
+  TEST_EQUAL(spec.getStringDataArrays()[0][0], "b")
+  TEST_EQUAL(spec.getStringDataArrays()[0][1], "b")
+  TEST_EQUAL(spec.getStringDataArrays()[0][2], "y")
+}
+END_SECTION
+
+START_SECTION((void query(const PeakSpectrum& spectrum, double min_mass, double max_mass, double fragment_tolerance, bool fragment_tolerance_ppm, Size min_shared_peaks, std::vector<std::pair<Size, Size>>& candidates) const))
+{
+  PeakSpectrum spec;
+  spec.emplace_back(100.0, 1.0f);
+  spec.emplace_back(200.1, 1.0f);
+  spec.emplace_back(300.0, 1.0f);
+
+  vector<pair<Size, Size> > candidates;
+  index.query(spec, 900.0, 1100.0, 0.05, false, 1, candidates);
+  TEST_EQUAL(candidates.size(), 2)
+  ABORT_IF(candidates.size() != 2)
+  TEST_EQUAL(candidates[0].first, 1) // PEPA
+  TEST_EQUAL(candidates[0].second, 3)
+  TEST_EQUAL(candidates[1].first, 2) // PEPC
+  TEST_EQUAL(candidates[1].second, 1)
+
+  // results are appended
+  index.query(spec, 900.0, 1100.0, 0.05, false, 2, candidates);
+  TEST_EQUAL(candidates.size(), 3)
+  TEST_EQUAL(candidates[2].first, 1)
+
+  // all peptides: PEPB and PEPD share the peak at 100
+  candidates.clear();
+  index.query(spec, 0.0, 10000.0, 0.05, false, 1, candidates);
+  TEST_EQUAL(candidates.size(), 4)
+  ABORT_IF(candidates.size() != 4)
+  TEST_EQUAL(candidates[0].second, 1)
+  TEST_EQUAL(candidates[3].second, 1)
+
+  // the window of a peak overlaps two bins with fragments of PEPD: still counted once
+  candidates.clear();
+  index.query(spec, 1150.0, 1250.0, 0.2, false, 0, candidates);
+  TEST_EQUAL(candidates.size(), 1)
+  ABORT_IF(candidates.size() != 1)
+  TEST_EQUAL(candidates[0].first, 3)
+  TEST_EQUAL(candidates[0].second, 1)
+
+  // ppm tolerance (250 ppm of 200.1 = 0.05)
+  candidates.clear();
+  index.query(spec, 900.0, 1100.0, 250.0, true, 3, candidates);
+  TEST_EQUAL(candidates.size(), 1)
+
+  // no peptide in the mass range
+  candidates.clear();
+  index.query(spec, 2000.0, 3000.0, 0.05, false, 0, candidates);
+  TEST_EQUAL(candidates.size(), 0)
+
+  // empty spectrum
+  index.query(PeakSpectrum(), 900.0, 1100.0, 0.05, false, 1, candidates);
+  TEST_EQUAL(candidates.size(), 0)
+}
+END_SECTION
+
+START_SECTION(void store(const String& filename) const)
+{
+  NOT_TESTABLE // tested with load
+}
+END_SECTION
+
+START_SECTION(void load(const String& filename))
+{
+  FragmentIndex stored(index);
+  stored.setSignature("enzyme=Trypsin;bin_width=0.5");
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+  stored.store(tmp_file);
+
+  FragmentIndex loaded;
+  loaded.load(tmp_file);
+  TEST_EQUAL(loaded.getSignature(), "enzyme=Trypsin;bin_width=0.5")
+  TEST_REAL_SIMILAR(loaded.getBinWidth(), 0.5)
+  TEST_EQUAL(loaded.size(), 4)
+  for (Size i = 0; i < loaded.size(); ++i)
+  {
+    TEST_EQUAL(loaded.getPeptide(i).sequence, index.getPeptide(i).sequence)
+    TEST_EQUAL(loaded.getPeptide(i).modification_index, index.getPeptide(i).modification_index)
+    TEST_REAL_SIMILAR(loaded.getPeptide(i).mass, index.getPeptide(i).mass)
+
+    PeakSpectrum s1, s2;
+    index.getSpectrum(i, s1);
+    loaded.getSpectrum(i, s2);
+    TEST_EQUAL(s1 == s2, true)
+  }
+
+  PeakSpectrum spec;
+  spec.emplace_back(100.0, 1.0f);
+  spec.emplace_back(200.1, 1.0f);
+  spec.emplace_back(300.0, 1.0f);
+  vector<pair<Size, Size> > c1, c2;
+  index.query(spec, 0.0, 10000.0, 0.05, false, 0, c1);
+  loaded.query(spec, 0.0, 10000.0, 0.05, false, 0, c2);
+  TEST_EQUAL(c1 == c2, true)
+
+  // empty index
+  FragmentIndex().store(tmp_file);
+  loaded.load(tmp_file);
+  TEST_EQUAL(loaded.empty(), true)
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("this_file_does_not_exist.fidx"))
+
+  String invalid_file;
+  NEW_TMP_FILE(invalid_file)
+  {
+    ofstream ofs(invalid_file.c_str());
+    ofs << "not a fragment index";
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(invalid_file))
+
+  // truncated file
+  stored.store(tmp_file);
+  {
+    ifstream ifs(tmp_file.c_str(), ios::binary);
+    string content((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+    ifs.close();
+    ofstream ofs(tmp_file.c_str(), ios::binary | ios::trunc);
+    ofs.write(content.data(), content.size() / 2);
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(tmp_file))
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
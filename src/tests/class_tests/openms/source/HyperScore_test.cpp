@@ -39,8 +39,10 @@
 ///////////////////////////
 
 #include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/CHEMISTRY/SimpleTSG.h>
 
 using namespace OpenMS;
 using namespace std;
@@ -117,6 +119,264 @@ START_SECTION((static double compute(double fragment_mass_tolerance, bool fragme
 }
 END_SECTION
 
+START_SECTION((static double compute(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const ColumnarSpectrum& exp_spectrum, const PeakSpectrum& theo_spectrum)))
+{
+  PeakSpectrum exp_spectrum;
+  PeakSpectrum theo_spectrum;
+
+  AASequence peptide = AASequence::fromString("PEPTIDE");
+
+  // empty spectrum
+  tsg.getSpectrum(theo_spectrum, peptide, 1, 1);
+  TEST_REAL_SIMILAR(HyperScore::compute(0.1, false, ColumnarSpectrum(exp_spectrum), theo_spectrum), 0.0);
+
+  // full match, 11 identical masses, identical intensities (=1)
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 1);
+  TEST_REAL_SIMILAR(HyperScore::compute(0.1, false, ColumnarSpectrum(exp_spectrum), theo_spectrum), 13.8516496);
+  TEST_REAL_SIMILAR(HyperScore::compute(10, true, ColumnarSpectrum(exp_spectrum), theo_spectrum), 13.8516496);
+
+  exp_spectrum.clear(true);
+  theo_spectrum.clear(true);
+
+  // full match, 33 identical masses, identical intensities (=1)
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 3);
+  tsg.getSpectrum(theo_spectrum, peptide, 1, 3);
+
+  // full match if ppm tolerance and partial match for Da tolerance
+  for (Size i = 0; i < theo_spectrum.size(); ++i)
+  {
+    double mz = pow( theo_spectrum[i].getMZ(), 2);
+    exp_spectrum[i].setMZ(mz);
+    theo_spectrum[i].setMZ(mz + 9 * 1e-6 * mz); // +9 ppm error
+  }
+
+  ColumnarSpectrum exp_columnar(exp_spectrum);
+  TEST_REAL_SIMILAR(HyperScore::compute(0.1, false, exp_columnar, theo_spectrum), 3.401197);
+  TEST_REAL_SIMILAR(HyperScore::compute(10, true, exp_columnar, theo_spectrum), 67.8210771);
+
+  // identical to the PeakSpectrum overload, also with noise peaks and varying intensities
+  for (Size i = 0; i < exp_spectrum.size(); ++i)
+  {
+    exp_spectrum[i].setIntensity(float(i % 7 + 1));
+  }
+  for (Size i = 0; i < 20; ++i)
+  {
+    exp_spectrum.emplace_back(100.0 + i * 97.3, 5.0f);
+  }
+  exp_spectrum.sortByPosition();
+  for (double tol : {0.01, 0.1, 1.0, 10.0})
+  {
+    TEST_EQUAL(HyperScore::compute(tol, false, ColumnarSpectrum(exp_spectrum), theo_spectrum),
+               HyperScore::compute(tol, false, exp_spectrum, theo_spectrum))
+    TEST_EQUAL(HyperScore::compute(tol, true, ColumnarSpectrum(exp_spectrum), theo_spectrum),
+               HyperScore::compute(tol, true, exp_spectrum, theo_spectrum))
+  }
+}
+END_SECTION
+
+START_SECTION((PreparedSpectrum(const PeakSpectrum& exp_spectrum, double bin_width = 1.0)))
+{
+  PeakSpectrum exp_spectrum;
+  HyperScore::PreparedSpectrum empty(exp_spectrum);
+  TEST_EQUAL(empty.size(), 0)
+  TEST_EQUAL(empty.empty(), true)
+  TEST_EQUAL(empty.lowerBound(100.0), 0)
+
+  exp_spectrum.emplace_back(100.0, 1.0f);
+  exp_spectrum.emplace_back(100.5, 2.0f);
+  exp_spectrum.emplace_back(103.0, 3.0f);
+  exp_spectrum.emplace_back(250.0, 4.0f);
+  HyperScore::PreparedSpectrum prepared(exp_spectrum);
+  TEST_EQUAL(prepared.size(), 4)
+  TEST_EQUAL(prepared.empty(), false)
+  TEST_REAL_SIMILAR(prepared.getMZ(2), 103.0)
+  TEST_REAL_SIMILAR(prepared.getIntensity(3), 4.0)
+
+  TEST_EXCEPTION(Exception::InvalidValue, HyperScore::PreparedSpectrum(exp_spectrum, 0.0))
+}
+END_SECTION
+
+START_SECTION((Size lowerBound(double mz) const))
+{
+  PeakSpectrum exp_spectrum;
+  exp_spectrum.emplace_back(100.0, 1.0f);
+  exp_spectrum.emplace_back(100.5, 2.0f);
+  exp_spectrum.emplace_back(103.0, 3.0f);
+  exp_spectrum.emplace_back(250.0, 4.0f);
+  for (double bin_width : {0.01, 1.0, 1000.0})
+  {
+    HyperScore::PreparedSpectrum prepared(exp_spectrum, bin_width);
+    TEST_EQUAL(prepared.lowerBound(50.0), 0)
+    TEST_EQUAL(prepared.lowerBound(100.0), 0)
+    TEST_EQUAL(prepared.lowerBound(100.2), 1)
+    TEST_EQUAL(prepared.lowerBound(100.5), 1)
+    TEST_EQUAL(prepared.lowerBound(101.0), 2)
+    TEST_EQUAL(prepared.lowerBound(200.0), 3)
+    TEST_EQUAL(prepared.lowerBound(250.0), 3)
+    TEST_EQUAL(prepared.lowerBound(250.1), 4)
+  }
+}
+END_SECTION
+
+START_SECTION((Size findNearest(double mz) const))
+{
+  PeakSpectrum exp_spectrum;
+  exp_spectrum.emplace_back(100.0, 1.0f);
+  exp_spectrum.emplace_back(101.0, 2.0f);
+  exp_spectrum.emplace_back(103.0, 3.0f);
+  HyperScore::PreparedSpectrum prepared(exp_spectrum);
+  TEST_EQUAL(prepared.findNearest(10.0), 0)
+  TEST_EQUAL(prepared.findNearest(100.4), 0)
+  TEST_EQUAL(prepared.findNearest(100.5), 0) // tie: smaller m/z
+  TEST_EQUAL(prepared.findNearest(100.6), 1)
+  TEST_EQUAL(prepared.findNearest(102.0), 1) // tie: smaller m/z
+  TEST_EQUAL(prepared.findNearest(102.1), 2)
+  TEST_EQUAL(prepared.findNearest(1000.0), 2)
+}
+END_SECTION
+
+START_SECTION((static double computeWithDetail(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const PreparedSpectrum& exp_spectrum, const PeakSpectrum& theo_spectrum, PSMDetail& d)))
+{
+  PeakSpectrum exp_spectrum;
+  PeakSpectrum theo_spectrum;
+  AASequence peptide = AASequence::fromString("PEPTIDE");
+  HyperScore::PSMDetail detail;
+
+  // empty spectrum
+  tsg.getSpectrum(theo_spectrum, peptide, 1, 1);
+  TEST_REAL_SIMILAR(HyperScore::computeWithDetail(0.1, false, HyperScore::PreparedSpectrum(exp_spectrum), theo_spectrum, detail), 0.0);
+
+  // full match, 11 identical masses, identical intensities (=1)
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 1);
+  TEST_REAL_SIMILAR(HyperScore::computeWithDetail(0.1, false, HyperScore::PreparedSpectrum(exp_spectrum), theo_spectrum, detail), 13.8516496);
+  TEST_EQUAL(detail.matched_b_ions + detail.matched_y_ions, 11)
+  TEST_REAL_SIMILAR(HyperScore::compute(10, true, HyperScore::PreparedSpectrum(exp_spectrum), theo_spectrum), 13.8516496);
+
+  // identical to the PeakSpectrum overload, also with errors, noise peaks and varying intensities
+  exp_spectrum.clear(true);
+  theo_spectrum.clear(true);
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 3);
+  tsg.getSpectrum(theo_spectrum, peptide, 1, 3);
+  for (Size i = 0; i < exp_spectrum.size(); ++i)
+  {
+    exp_spectrum[i].setMZ(exp_spectrum[i].getMZ() + (double(i % 5) - 2.0) * 1e-3);
+    exp_spectrum[i].setIntensity(float(i % 7 + 1));
+  }
+  for (Size i = 0; i < 20; ++i)
+  {
+    exp_spectrum.emplace_back(100.0 + i * 37.3, 5.0f);
+  }
+  exp_spectrum.sortByPosition();
+  for (double bin_width : {0.05, 1.0, 100.0})
+  {
+    HyperScore::PreparedSpectrum prepared(exp_spectrum, bin_width);
+    for (double tol : {0.001, 0.002, 0.01, 1.0, 2.0, 5.0})
+    {
+      for (bool ppm : {false, true})
+      {
+        HyperScore::PSMDetail expected, result;
+        TEST_EQUAL(HyperScore::computeWithDetail(tol, ppm, prepared, theo_spectrum, result),
+                   HyperScore::computeWithDetail(tol, ppm, exp_spectrum, theo_spectrum, expected))
+        TEST_EQUAL(result.matched_b_ions, expected.matched_b_ions)
+        TEST_EQUAL(result.matched_y_ions, expected.matched_y_ions)
+        TEST_EQUAL(result.mean_error, expected.mean_error)
+        TEST_EQUAL(HyperScore::compute(tol, ppm, prepared, theo_spectrum),
+                   HyperScore::compute(tol, ppm, exp_spectrum, theo_spectrum))
+      }
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((static double computeWithDetail(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const PreparedSpectrum& exp_spectrum, const std::vector<SimpleTSG::Fragment>& theo_fragments, PSMDetail& d)))
+{
+  PeakSpectrum exp_spectrum;
+  PeakSpectrum theo_spectrum;
+  vector<SimpleTSG::Fragment> theo_fragments;
+  AASequence peptide = AASequence::fromString("PEPTIDEK");
+  HyperScore::PSMDetail detail;
+
+  SimpleTSG simple_tsg;
+  Param simple_param = simple_tsg.getParameters();
+  simple_param.setValue("add_first_prefix_ion", "true");
+  simple_tsg.setParameters(simple_param);
+  Param tsg_param = tsg.getParameters();
+  tsg_param.setValue("add_first_prefix_ion", "true");
+  tsg.setParameters(tsg_param);
+
+  // no fragments
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 1);
+  TEST_REAL_SIMILAR(HyperScore::computeWithDetail(0.1, false, HyperScore::PreparedSpectrum(exp_spectrum), theo_fragments, detail), 0.0);
+
+  // identical to the annotated spectrum of the same ions, also with errors, noise peaks and varying intensities
+  exp_spectrum.clear(true);
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 2);
+  tsg.getSpectrum(theo_spectrum, peptide, 1, 2);
+  theo_spectrum.sortByPosition();
+  simple_tsg.getSpectrum(theo_fragments, peptide, 1, 2);
+  TEST_EQUAL(theo_fragments.size(), theo_spectrum.size())
+  for (Size i = 0; i < exp_spectrum.size(); ++i)
+  {
+    exp_spectrum[i].setMZ(exp_spectrum[i].getMZ() + (double(i % 5) - 2.0) * 1e-3);
+    exp_spectrum[i].setIntensity(float(i % 7 + 1));
+  }
+  for (Size i = 0; i < 20; ++i)
+  {
+    exp_spectrum.emplace_back(100.0 + i * 37.3, 5.0f);
+  }
+  exp_spectrum.sortByPosition();
+  HyperScore::PreparedSpectrum prepared(exp_spectrum);
+  for (double tol : {0.001, 0.002, 0.01, 1.0, 5.0})
+  {
+    for (bool ppm : {false, true})
+    {
+      HyperScore::PSMDetail expected, result;
+      TEST_EQUAL(HyperScore::computeWithDetail(tol, ppm, prepared, theo_fragments, result),
+                 HyperScore::computeWithDetail(tol, ppm, prepared, theo_spectrum, expected))
+      TEST_EQUAL(result.matched_b_ions, expected.matched_b_ions)
+      TEST_EQUAL(result.matched_y_ions, expected.matched_y_ions)
+      TEST_EQUAL(result.mean_error, expected.mean_error)
+    }
+  }
+
+  tsg_param.setValue("add_first_prefix_ion", "false");
+  tsg.setParameters(tsg_param);
+}
+END_SECTION
+
+START_SECTION((static void computeBatch(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const PreparedSpectrum& exp_spectrum, const std::vector<PeakSpectrum>& theo_spectra, std::vector<double>& scores, std::vector<PSMDetail>& details)))
+{
+  PeakSpectrum exp_spectrum;
+  tsg.getSpectrum(exp_spectrum, AASequence::fromString("PEPTIDE"), 1, 2);
+  HyperScore::PreparedSpectrum prepared(exp_spectrum);
+
+  vector<PeakSpectrum> theo_spectra(4);
+  tsg.getSpectrum(theo_spectra[0], AASequence::fromString("PEPTIDE"), 1, 2);
+  tsg.getSpectrum(theo_spectra[1], AASequence::fromString("PEPTIDEK"), 1, 2);
+  tsg.getSpectrum(theo_spectra[2], AASequence::fromString("YYYYYY"), 1, 2);
+  tsg.getSpectrum(theo_spectra[3], AASequence::fromString("EPTIDE"), 1, 2);
+
+  vector<double> scores;
+  vector<HyperScore::PSMDetail> details;
+  HyperScore::computeBatch(0.05, false, prepared, theo_spectra, scores, details);
+  TEST_EQUAL(scores.size(), 4)
+  TEST_EQUAL(details.size(), 4)
+  for (Size i = 0; i != theo_spectra.size(); ++i)
+  {
+    HyperScore::PSMDetail expected;
+    TEST_EQUAL(scores[i], HyperScore::computeWithDetail(0.05, false, exp_spectrum, theo_spectra[i], expected))
+    TEST_EQUAL(details[i].matched_b_ions, expected.matched_b_ions)
+    TEST_EQUAL(details[i].matched_y_ions, expected.matched_y_ions)
+  }
+  TEST_EQUAL(scores[0] > scores[1], true)
+  TEST_EQUAL(scores[0] > scores[3], true)
+
+  HyperScore::computeBatch(0.05, false, prepared, vector<PeakSpectrum>(), scores, details);
+  TEST_EQUAL(scores.size(), 0)
+  TEST_EQUAL(details.size(), 0)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -0,0 +1,210 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+#include <OpenMS/ANALYSIS/MAPMATCHING/LinkingFeatureStore.h>
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/SYSTEM/File.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(LinkingFeatureStore, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// two small maps, not sorted by m/z
+FeatureMap map1, map2;
+{
+  double mzs[] = {500.0, 300.0, 700.0, 310.0};
+  for (Size i = 0; i < 4; ++i)
+  {
+    Feature f;
+    f.setMZ(mzs[i]);
+    f.setRT(100.0 * (i + 1));
+    f.setIntensity(1000.0f * (i + 1));
+    f.setOverallQuality(0.25f * i);
+    f.setWidth(2.5f);
+    f.setCharge(Int(i % 3));
+    f.setUniqueId(10 + i);
+    if (i == 1)
+    {
+      f.setMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS, "H1");
+      f.setMetaValue(Constants::UserParam::ADDUCT_GROUP, "group_1");
+    }
+    map1.push_back(f);
+  }
+  Feature f;
+  f.setMZ(305.0);
+  f.setRT(150.0);
+  f.setIntensity(7000.0f);
+  f.setUniqueId(20);
+  f.setMetaValue(Constants::UserParam::ADDUCT_GROUP, "group_2");
+  map2.push_back(f);
+}
+
+LinkingFeatureStore* ptr = nullptr;
+LinkingFeatureStore* null_ptr = nullptr;
+const String filename = File::getTemporaryFile();
+
+START_SECTION((explicit LinkingFeatureStore(const String& filename)))
+  ptr = new LinkingFeatureStore(filename);
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->getNumberOfPartitions(), 0)
+END_SECTION
+
+START_SECTION((~LinkingFeatureStore()))
+  delete ptr;
+  TEST_EQUAL(File::exists(filename), false)
+END_SECTION
+
+LinkingFeatureStore store(filename);
+
+START_SECTION((void addMap(const FeatureMap& map)))
+  store.addMap(map1);
+  store.addMap(map2);
+  store.addMap(FeatureMap());
+  TEST_EQUAL(store.size(), 3)
+
+  FeatureMap duplicates;
+  duplicates.push_back(map1[0]);
+  duplicates.push_back(map1[0]);
+  TEST_EXCEPTION(Exception::InvalidValue, store.addMap(duplicates))
+END_SECTION
+
+START_SECTION((Size size() const))
+  TEST_EQUAL(store.size(), 3)
+END_SECTION
+
+START_SECTION((Size getNumberOfFeatures() const))
+  TEST_EQUAL(store.getNumberOfFeatures(), 5)
+END_SECTION
+
+START_SECTION((double getMaxIntensity() const))
+  TEST_REAL_SIMILAR(store.getMaxIntensity(), 7000.0)
+END_SECTION
+
+START_SECTION((void forEachMZ(const std::function<void(double)>& f) const))
+  vector<double> mzs;
+  store.forEachMZ([&mzs](double mz) { mzs.push_back(mz); });
+  ABORT_IF(mzs.size() != 5)
+  TEST_REAL_SIMILAR(mzs[0], 300.0)
+  TEST_REAL_SIMILAR(mzs[1], 305.0)
+  TEST_REAL_SIMILAR(mzs[2], 310.0)
+  TEST_REAL_SIMILAR(mzs[3], 500.0)
+  TEST_REAL_SIMILAR(mzs[4], 700.0)
+END_SECTION
+
+START_SECTION((void setPartitions(const std::vector<double>& boundaries)))
+  store.setPartitions({300.0, 400.0, 701.0});
+  TEST_EQUAL(store.getNumberOfPartitions(), 2)
+END_SECTION
+
+START_SECTION((Size getNumberOfPartitions() const))
+  TEST_EQUAL(store.getNumberOfPartitions(), 2)
+END_SECTION
+
+START_SECTION((void loadPartition(Size j, std::vector<FeatureMap>& maps) const))
+  vector<FeatureMap> maps;
+  store.loadPartition(0, maps);
+  ABORT_IF(maps.size() != 3)
+  // original order of the input map is kept
+  ABORT_IF(maps[0].size() != 2)
+  TEST_REAL_SIMILAR(maps[0][0].getMZ(), 300.0)
+  TEST_REAL_SIMILAR(maps[0][1].getMZ(), 310.0)
+  TEST_REAL_SIMILAR(maps[0][0].getRT(), 200.0)
+  TEST_REAL_SIMILAR(maps[0][0].getIntensity(), 2000.0)
+  TEST_REAL_SIMILAR(maps[0][0].getOverallQuality(), 0.25)
+  TEST_REAL_SIMILAR(maps[0][0].getWidth(), 2.5)
+  TEST_EQUAL(maps[0][0].getCharge(), 1)
+  TEST_EQUAL(maps[0][0].getUniqueId(), 11)
+  TEST_EQUAL(maps[0][0].getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS), "H1")
+  TEST_EQUAL(maps[0][0].getMetaValue(Constants::UserParam::ADDUCT_GROUP), "group_1")
+  TEST_EQUAL(maps[0][1].getUniqueId(), 13)
+  TEST_EQUAL(maps[0][1].metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS), false)
+  ABORT_IF(maps[1].size() != 1)
+  TEST_EQUAL(maps[1][0].getUniqueId(), 20)
+  TEST_EQUAL(maps[1][0].metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS), false)
+  TEST_EQUAL(maps[1][0].getMetaValue(Constants::UserParam::ADDUCT_GROUP), "group_2")
+  TEST_EQUAL(maps[2].size(), 0)
+
+  store.loadPartition(1, maps);
+  ABORT_IF(maps[0].size() != 2)
+  TEST_EQUAL(maps[0][0].getUniqueId(), 10)
+  TEST_EQUAL(maps[0][1].getUniqueId(), 12)
+  TEST_EQUAL(maps[1].size(), 0)
+
+  TEST_EXCEPTION(Exception::IndexOverflow, store.loadPartition(2, maps))
+END_SECTION
+
+START_SECTION((void restoreIdentifications(Size map_index, const FeatureMap& map, ConsensusMap& out)))
+  FeatureMap full1 = map1, full2 = map2;
+  full1[1].getPeptideIdentifications().resize(2);
+  full1.getUnassignedPeptideIdentifications().resize(1);
+  full1.getProteinIdentifications().resize(1);
+  full2[0].getPeptideIdentifications().resize(1);
+
+  // consensus features as produced by linking
+  ConsensusMap out;
+  ConsensusFeature cf;
+  cf.insert(0, map1[1]);
+  cf.insert(1, map2[0]);
+  out.push_back(cf);
+  cf.clear();
+  cf.insert(0, map1[0]);
+  out.push_back(cf);
+
+  store.restoreIdentifications(0, full1, out);
+  store.restoreIdentifications(1, full2, out);
+  store.restoreIdentifications(2, FeatureMap(), out);
+  ABORT_IF(out[0].getPeptideIdentifications().size() != 3)
+  TEST_EQUAL(out[0].getPeptideIdentifications()[0].getMetaValue("map_index"), 0)
+  TEST_EQUAL(out[0].getPeptideIdentifications()[1].getMetaValue("map_index"), 0)
+  TEST_EQUAL(out[0].getPeptideIdentifications()[2].getMetaValue("map_index"), 1)
+  TEST_EQUAL(out[1].getPeptideIdentifications().size(), 0)
+  ABORT_IF(out.getUnassignedPeptideIdentifications().size() != 1)
+  TEST_EQUAL(out.getUnassignedPeptideIdentifications()[0].getMetaValue("map_index"), 0)
+  TEST_EQUAL(out.getProteinIdentifications().size(), 1)
+
+  TEST_EXCEPTION(Exception::InvalidValue, store.restoreIdentifications(1, full1, out))
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+END_TEST
@@ -57,6 +57,8 @@
 #else
 
 #include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/MRMFeatureAccessOpenMS.h>
+#include <OpenMS/KERNEL/MRMFeature.h>
 #define BOOST_AUTO_TEST_CASE START_SECTION
 using namespace OpenMS;
 
@@ -883,6 +885,139 @@ mean(m4)
         }
     END_SECTION
 
+    BOOST_AUTO_TEST_CASE(initializeXCorrMatrices)
+        {
+          MockMRMFeature * imrmfeature = new MockMRMFeature();
+          MRMScoring mrmscore, expected;
+
+          std::vector<std::string> precursor_ids;
+          std::vector<std::string> native_ids;
+          fill_mock_objects2(imrmfeature, precursor_ids, native_ids);
+
+          // all matrices at once give the same result as the individual initialization
+          mrmscore.initializeXCorrMatrices(imrmfeature, native_ids, precursor_ids);
+          expected.initializeXCorrMatrix(imrmfeature, native_ids);
+          expected.initializeXCorrPrecursorMatrix(imrmfeature, precursor_ids);
+          expected.initializeXCorrPrecursorContrastMatrix(imrmfeature, precursor_ids, native_ids);
+          expected.initializeXCorrPrecursorCombinedMatrix(imrmfeature, precursor_ids, native_ids);
+          delete imrmfeature;
+
+          TEST_EQUAL(mrmscore.getXCorrPrecursorCombinedMatrix().rows(), 5)
+          TEST_EQUAL(mrmscore.getXCorrPrecursorCombinedMatrix().cols(), 5)
+          TEST_EQUAL(mrmscore.getXCorrMatrix().rows(), 2)
+          TEST_EQUAL(mrmscore.getXCorrPrecursorContrastMatrix().rows(), 3)
+          TEST_EQUAL(mrmscore.getXCorrPrecursorContrastMatrix().cols(), 2)
+          for (std::size_t i = 0; i < 5; ++i)
+          {
+            for (std::size_t j = i; j < 5; ++j)
+            {
+              TEST_EQUAL(mrmscore.getXCorrPrecursorCombinedMatrix().getValue(i, j).data == expected.getXCorrPrecursorCombinedMatrix().getValue(i, j).data, true)
+            }
+          }
+          TEST_EQUAL(mrmscore.getXCorrMatrix().getValue(0, 1).data == expected.getXCorrMatrix().getValue(0, 1).data, true)
+          TEST_EQUAL(mrmscore.getXCorrPrecursorContrastMatrix().getValue(2, 1).data == expected.getXCorrPrecursorContrastMatrix().getValue(2, 1).data, true)
+
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrCoelutionScore(), expected.calcXcorrCoelutionScore())
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrShapeScore(), expected.calcXcorrShapeScore())
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrPrecursorCoelutionScore(), expected.calcXcorrPrecursorCoelutionScore())
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrPrecursorShapeScore(), expected.calcXcorrPrecursorShapeScore())
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrPrecursorContrastCoelutionScore(), 9.5741984)
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrPrecursorCombinedCoelutionScore(), 9.2444789)
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrPrecursorContrastShapeScore(), 0.3772868)
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrPrecursorCombinedShapeScore(), 0.5079334)
+        }
+    END_SECTION
+
+    BOOST_AUTO_TEST_CASE(initializeMIMatrices)
+        {
+          MockMRMFeature * imrmfeature = new MockMRMFeature();
+          MRMScoring mrmscore, expected;
+
+          std::vector<std::string> precursor_ids;
+          std::vector<std::string> native_ids;
+          fill_mock_objects2(imrmfeature, precursor_ids, native_ids);
+
+          // all matrices at once give the same result as the individual initialization
+          mrmscore.initializeMIMatrices(imrmfeature, native_ids, precursor_ids);
+          expected.initializeMIMatrix(imrmfeature, native_ids);
+          expected.initializeMIPrecursorMatrix(imrmfeature, precursor_ids);
+          expected.initializeMIPrecursorContrastMatrix(imrmfeature, precursor_ids, native_ids);
+          expected.initializeMIPrecursorCombinedMatrix(imrmfeature, precursor_ids, native_ids);
+          delete imrmfeature;
+
+          TEST_EQUAL(mrmscore.getMIPrecursorCombinedMatrix().rows(), 5)
+          TEST_EQUAL(mrmscore.getMIPrecursorCombinedMatrix().cols(), 5)
+          for (std::size_t i = 0; i < 5; ++i)
+          {
+            for (std::size_t j = 0; j < 5; ++j)
+            {
+              TEST_REAL_SIMILAR(mrmscore.getMIPrecursorCombinedMatrix().getValue(i, j), expected.getMIPrecursorCombinedMatrix().getValue(i, j))
+            }
+          }
+          TEST_REAL_SIMILAR(mrmscore.getMIMatrix().getValue(0, 1), expected.getMIMatrix().getValue(0, 1))
+
+          TEST_REAL_SIMILAR(mrmscore.calcMIScore(), expected.calcMIScore())
+          TEST_REAL_SIMILAR(mrmscore.calcMIPrecursorScore(), expected.calcMIPrecursorScore())
+          TEST_REAL_SIMILAR(mrmscore.calcMIPrecursorContrastScore(), 2.003257)
+          TEST_REAL_SIMILAR(mrmscore.calcMIPrecursorCombinedScore(), 1.959490)
+        }
+    END_SECTION
+
+#ifndef USE_BOOST_UNIT_TEST
+    START_SECTION([EXTRA] initializeMIMatrices with OpenMS features)
+        {
+          // FeatureOpenMS appends to the intensity vector it is given (unlike MockFeature), so reused buffers have to be cleared
+          MockMRMFeature * imrmfeature = new MockMRMFeature();
+          std::vector<std::string> precursor_ids;
+          std::vector<std::string> native_ids;
+          fill_mock_objects2(imrmfeature, precursor_ids, native_ids);
+
+          auto toFeature = [](const MockFeature& mock)
+          {
+            ConvexHull2D::PointArrayType points;
+            for (std::size_t k = 0; k < mock.m_intensity_vec.size(); ++k)
+            {
+              points.push_back(ConvexHull2D::PointType(100.0 + k, mock.m_intensity_vec[k]));
+            }
+            ConvexHull2D hull;
+            hull.setHullPoints(points);
+            Feature f;
+            f.getConvexHulls().push_back(hull);
+            return f;
+          };
+          MRMFeature feature;
+          for (const auto& id : native_ids)
+          {
+            feature.addFeature(toFeature(*imrmfeature->m_features[id]), id);
+          }
+          for (const auto& id : precursor_ids)
+          {
+            feature.addPrecursorFeature(toFeature(*imrmfeature->m_precursor_features[id]), id);
+          }
+          MRMFeatureOpenMS openms_feature(feature);
+
+          MRMScoring mrmscore, expected;
+          mrmscore.initializeMIMatrices(&openms_feature, native_ids, precursor_ids);
+          expected.initializeMIMatrices(imrmfeature, native_ids, precursor_ids);
+          delete imrmfeature;
+
+          TEST_EQUAL(mrmscore.getMIPrecursorCombinedMatrix().rows(), 5)
+          TEST_EQUAL(mrmscore.getMIPrecursorCombinedMatrix().cols(), 5)
+          for (std::size_t i = 0; i < 5; ++i)
+          {
+            for (std::size_t j = 0; j < 5; ++j)
+            {
+              TEST_REAL_SIMILAR(mrmscore.getMIPrecursorCombinedMatrix().getValue(i, j), expected.getMIPrecursorCombinedMatrix().getValue(i, j))
+            }
+          }
+          TEST_REAL_SIMILAR(mrmscore.calcMIScore(), expected.calcMIScore())
+          TEST_REAL_SIMILAR(mrmscore.calcMIPrecursorScore(), expected.calcMIPrecursorScore())
+          TEST_REAL_SIMILAR(mrmscore.calcMIPrecursorContrastScore(), 2.003257)
+          TEST_REAL_SIMILAR(mrmscore.calcMIPrecursorCombinedScore(), 1.959490)
+        }
+    END_SECTION
+#endif
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
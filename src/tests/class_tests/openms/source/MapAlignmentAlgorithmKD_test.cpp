@@ -61,6 +61,14 @@ START_SECTION((void addRTFitData(const KDTreeFeatureMaps& kd_data)))
   NOT_TESTABLE;
 END_SECTION
 
+START_SECTION((void computeRTFitData(const KDTreeFeatureMaps& kd_data, std::vector<TransformationModel::DataPoints>& fit_data) const))
+  NOT_TESTABLE;
+END_SECTION
+
+START_SECTION((void addRTFitData(const std::vector<TransformationModel::DataPoints>& fit_data)))
+  NOT_TESTABLE;
+END_SECTION
+
 START_SECTION((void fitLOWESS()))
   NOT_TESTABLE;
 END_SECTION
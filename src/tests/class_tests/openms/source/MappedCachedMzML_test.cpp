@@ -0,0 +1,369 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/MappedCachedMzML.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <cstdint>
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+// Write a cached file in the layout of format version 1 (no versioned header, no alignment)
+void writeLegacyCache(const PeakMap& exp, const std::string& filename)
+{
+  std::ofstream ofs(filename.c_str(), std::ios::binary);
+  int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+  ofs.write((char*)&file_identifier, sizeof(file_identifier));
+  auto writeArrays = [&ofs](const auto& first, const auto& second, const auto& fdas)
+  {
+    for (double v : first) ofs.write((char*)&v, sizeof(v));
+    for (double v : second) ofs.write((char*)&v, sizeof(v));
+    for (const auto& fda : fdas)
+    {
+      Size len = fda.size(), len_name = fda.getName().size();
+      ofs.write((char*)&len, sizeof(len));
+      ofs.write((char*)&len_name, sizeof(len_name));
+      ofs.write(fda.getName().c_str(), len_name);
+      for (double v : fda) ofs.write((char*)&v, sizeof(v));
+    }
+  };
+  for (const auto& s : exp)
+  {
+    Size size = s.size(), nr_arrays = s.getFloatDataArrays().size();
+    int ms_level = s.getMSLevel();
+    double rt = s.getRT();
+    ofs.write((char*)&size, sizeof(size));
+    ofs.write((char*)&nr_arrays, sizeof(nr_arrays));
+    ofs.write((char*)&ms_level, sizeof(ms_level));
+    ofs.write((char*)&rt, sizeof(rt));
+    if (s.empty()) continue;
+    std::vector<double> mz, intensity;
+    for (const auto& p : s) { mz.push_back(p.getMZ()); intensity.push_back(p.getIntensity()); }
+    writeArrays(mz, intensity, s.getFloatDataArrays());
+  }
+  for (const auto& c : exp.getChromatograms())
+  {
+    Size size = c.size(), nr_arrays = c.getFloatDataArrays().size();
+    ofs.write((char*)&size, sizeof(size));
+    ofs.write((char*)&nr_arrays, sizeof(nr_arrays));
+    if (c.empty()) continue;
+    std::vector<double> rt, intensity;
+    for (const auto& p : c) { rt.push_back(p.getRT()); intensity.push_back(p.getIntensity()); }
+    writeArrays(rt, intensity, c.getFloatDataArrays());
+  }
+  Size exp_size = exp.size(), chrom_size = exp.getChromatograms().size();
+  ofs.write((char*)&exp_size, sizeof(exp_size));
+  ofs.write((char*)&chrom_size, sizeof(chrom_size));
+}
+
+START_TEST(MappedCachedMzML, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MappedCachedMzML* ptr = nullptr;
+MappedCachedMzML* nullPointer = nullptr;
+
+START_SECTION(MappedCachedMzML())
+{
+  ptr = new MappedCachedMzML();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrSpectra(), 0)
+  TEST_EQUAL(ptr->getNrChromatograms(), 0)
+  TEST_EQUAL(ptr->getMetaData().size(), 0)
+}
+END_SECTION
+
+START_SECTION(~MappedCachedMzML())
+{
+  delete ptr;
+}
+END_SECTION
+
+// Load experiment
+PeakMap exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+// Cache the experiment to a temporary file
+std::string tmpf;
+NEW_TMP_FILE(tmpf);
+CachedmzML::store(tmpf, exp);
+
+// Same data in the layout of format version 1
+std::string tmpf_legacy;
+NEW_TMP_FILE(tmpf_legacy);
+CachedmzML::store(tmpf_legacy, exp);
+writeLegacyCache(exp, tmpf_legacy + ".cached");
+
+START_SECTION(explicit MappedCachedMzML(const String& filename))
+{
+  MappedCachedMzML cache(tmpf);
+  TEST_EQUAL(cache.getNrSpectra(), 4)
+  TEST_EQUAL(cache.getNrChromatograms(), 2)
+
+  std::string missing;
+  NEW_TMP_FILE(missing);
+  TEST_EXCEPTION(Exception::FileNotFound, MappedCachedMzML cache_missing(missing))
+  // the cached file is not a cached mzML file
+  std::string wrong;
+  NEW_TMP_FILE(wrong);
+  {
+    std::ifstream ifs(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), std::ios::binary);
+    std::ofstream ofs((wrong + ".cached").c_str(), std::ios::binary);
+    ofs << ifs.rdbuf();
+  }
+  TEST_EXCEPTION(Exception::ParseError, MappedCachedMzML cache_wrong(wrong))
+}
+END_SECTION
+
+START_SECTION(static void load(const String& filename, MappedCachedMzML& map))
+{
+  MappedCachedMzML cache;
+  MappedCachedMzML::load(tmpf, cache);
+  TEST_EQUAL(cache.getNrSpectra(), 4)
+  TEST_EQUAL(cache.getNrChromatograms(), 2)
+  TEST_EQUAL(cache.getFileVersion(), CACHED_MZML_FILE_VERSION)
+
+  // truncated files are detected while loading
+  std::string truncated;
+  NEW_TMP_FILE(truncated);
+  CachedmzML::store(truncated, exp);
+  {
+    std::ifstream ifs((tmpf + ".cached").c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    // keep the trailer (number of spectra and chromatograms) but cut the data of the last chromatogram
+    std::string trailer = content.substr(content.size() - 2 * sizeof(Size));
+    std::ofstream ofs((truncated + ".cached").c_str(), std::ios::binary);
+    ofs << content.substr(0, content.size() - 2 * sizeof(Size) - 64) << trailer;
+  }
+  TEST_EXCEPTION(Exception::ParseError, MappedCachedMzML::load(truncated, cache))
+}
+END_SECTION
+
+MappedCachedMzML cache_example(tmpf);
+MappedCachedMzML cache_legacy(tmpf_legacy);
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  TEST_EQUAL(cache_example.getNrSpectra(), 4)
+  TEST_EQUAL(cache_legacy.getNrSpectra(), 4)
+}
+END_SECTION
+
+START_SECTION(size_t getNrChromatograms() const)
+{
+  TEST_EQUAL(cache_example.getNrChromatograms(), 2)
+  TEST_EQUAL(cache_legacy.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(const MSExperiment& getMetaData() const)
+{
+  TEST_EQUAL(cache_example.getMetaData().size(), 4)
+  TEST_EQUAL(cache_example.getMetaData().getNrChromatograms(), 2)
+  TEST_EQUAL(cache_example.getMetaData()[0].size(), 0)
+  TEST_EQUAL(cache_example.getMetaData()[0].getNativeID(), exp[0].getNativeID())
+}
+END_SECTION
+
+START_SECTION(UInt32 getFileVersion() const)
+{
+  TEST_EQUAL(cache_example.getFileVersion(), CACHED_MZML_FILE_VERSION)
+  TEST_EQUAL(cache_legacy.getFileVersion(), 1)
+}
+END_SECTION
+
+START_SECTION(bool providesViews() const)
+{
+  TEST_EQUAL(cache_example.providesViews(), true)
+  TEST_EQUAL(cache_legacy.providesViews(), false)
+}
+END_SECTION
+
+START_SECTION(SpectrumView getSpectrumView(Size id) const)
+{
+  for (Size i = 0; i < 4; ++i)
+  {
+    MappedCachedMzML::SpectrumView view = cache_example.getSpectrumView(i);
+    TEST_EQUAL(view.ms_level, exp[i].getMSLevel())
+    TEST_REAL_SIMILAR(view.rt, exp[i].getRT())
+    TEST_EQUAL(view.mz.size(), exp[i].size())
+    TEST_EQUAL(view.intensity.size(), exp[i].size())
+    // the views point into the mapped file and are aligned
+    TEST_EQUAL(reinterpret_cast<std::uintptr_t>(view.mz.data()) % alignof(double), 0)
+    TEST_EQUAL(reinterpret_cast<std::uintptr_t>(view.intensity.data()) % alignof(double), 0)
+    for (Size k = 0; k < view.mz.size(); ++k)
+    {
+      TEST_REAL_SIMILAR(view.mz[k], exp[i][k].getMZ())
+      TEST_REAL_SIMILAR(view.intensity[k], exp[i][k].getIntensity())
+    }
+  }
+
+  MappedCachedMzML::SpectrumView view = cache_example.getSpectrumView(1);
+  TEST_EQUAL(view.extra_arrays.size(), 2)
+  ABORT_IF(view.extra_arrays.size() != 2)
+  TEST_EQUAL(std::string(view.extra_arrays[0].name), "signal to noise array")
+  TEST_EQUAL(std::string(view.extra_arrays[1].name), "user-defined name")
+  TEST_EQUAL(view.extra_arrays[0].data.size(), exp[1].getFloatDataArrays()[0].size())
+  TEST_EQUAL(reinterpret_cast<std::uintptr_t>(view.extra_arrays[0].data.data()) % alignof(double), 0)
+  TEST_EQUAL(reinterpret_cast<std::uintptr_t>(view.extra_arrays[1].data.data()) % alignof(double), 0)
+  for (Size k = 0; k < view.extra_arrays[1].data.size(); ++k)
+  {
+    TEST_REAL_SIMILAR(view.extra_arrays[1].data[k], exp[1].getFloatDataArrays()[1][k])
+  }
+  TEST_EQUAL(cache_example.getSpectrumView(0).extra_arrays.empty(), true)
+
+  // views stay valid as long as any copy of the object exists
+  MappedCachedMzML::SpectrumView view_copy;
+  {
+    MappedCachedMzML tmp(cache_example);
+    view_copy = tmp.getSpectrumView(2);
+  }
+  TEST_EQUAL(view_copy.mz.size(), exp[2].size())
+  TEST_REAL_SIMILAR(view_copy.mz[0], exp[2][0].getMZ())
+
+  TEST_EXCEPTION(Exception::IllegalArgument, cache_legacy.getSpectrumView(0))
+}
+END_SECTION
+
+START_SECTION(ChromatogramView getChromatogramView(Size id) const)
+{
+  for (Size i = 0; i < 2; ++i)
+  {
+    MappedCachedMzML::ChromatogramView view = cache_example.getChromatogramView(i);
+    const MSChromatogram& chrom = exp.getChromatograms()[i];
+    TEST_EQUAL(view.rt.size(), chrom.size())
+    TEST_EQUAL(view.intensity.size(), chrom.size())
+    TEST_EQUAL(reinterpret_cast<std::uintptr_t>(view.rt.data()) % alignof(double), 0)
+    for (Size k = 0; k < view.rt.size(); ++k)
+    {
+      TEST_REAL_SIMILAR(view.rt[k], chrom[k].getRT())
+      TEST_REAL_SIMILAR(view.intensity[k], chrom[k].getIntensity())
+    }
+  }
+  TEST_EXCEPTION(Exception::IllegalArgument, cache_legacy.getChromatogramView(0))
+}
+END_SECTION
+
+START_SECTION(MSSpectrum getSpectrum(Size id) const)
+{
+  CachedmzML cached;
+  CachedmzML::load(tmpf, cached);
+  for (Size i = 0; i < 4; ++i)
+  {
+    // identical to the stream-based access for both format versions
+    TEST_EQUAL(cache_example.getSpectrum(i) == cached.getSpectrum(i), true)
+    TEST_EQUAL(cache_legacy.getSpectrum(i) == cached.getSpectrum(i), true)
+  }
+  TEST_EQUAL(cache_example.getSpectrum(1).getFloatDataArrays().size(), 2)
+  TEST_EQUAL(cache_example.getSpectrum(1).getFloatDataArrays()[1].getName(), "user-defined name")
+}
+END_SECTION
+
+START_SECTION(MSChromatogram getChromatogram(Size id) const)
+{
+  CachedmzML cached;
+  CachedmzML::load(tmpf, cached);
+  for (Size i = 0; i < 2; ++i)
+  {
+    TEST_EQUAL(cache_example.getChromatogram(i) == cached.getChromatogram(i), true)
+    TEST_EQUAL(cache_legacy.getChromatogram(i) == cached.getChromatogram(i), true)
+  }
+}
+END_SECTION
+
+START_SECTION(std::vector<OpenSwath::BinaryDataArrayPtr> getSpectrumData(Size id) const)
+{
+  for (Size i = 0; i < 4; ++i)
+  {
+    std::vector<OpenSwath::BinaryDataArrayPtr> data = cache_legacy.getSpectrumData(i);
+    TEST_EQUAL(data.size() >= 2, true)
+    TEST_EQUAL(data[0]->data.size(), exp[i].size())
+    for (Size k = 0; k < data[0]->data.size(); ++k)
+    {
+      TEST_REAL_SIMILAR(data[0]->data[k], exp[i][k].getMZ())
+      TEST_REAL_SIMILAR(data[1]->data[k], exp[i][k].getIntensity())
+    }
+  }
+  std::vector<OpenSwath::BinaryDataArrayPtr> data = cache_example.getSpectrumData(1);
+  TEST_EQUAL(data.size(), 4)
+  TEST_EQUAL(data[2]->description, "signal to noise array")
+  TEST_EQUAL(data[3]->description, "user-defined name")
+}
+END_SECTION
+
+START_SECTION(std::vector<OpenSwath::BinaryDataArrayPtr> getChromatogramData(Size id) const)
+{
+  for (Size i = 0; i < 2; ++i)
+  {
+    std::vector<OpenSwath::BinaryDataArrayPtr> data = cache_example.getChromatogramData(i);
+    TEST_EQUAL(data.size() >= 2, true)
+    TEST_EQUAL(data[0]->data.size(), exp.getChromatograms()[i].size())
+    TEST_EQUAL(data[1]->data.size(), exp.getChromatograms()[i].size())
+  }
+}
+END_SECTION
+
+START_SECTION(MappedCachedMzML(const MappedCachedMzML& rhs))
+{
+  MappedCachedMzML copy(cache_example);
+  TEST_EQUAL(copy.getNrSpectra(), 4)
+  // shares the mapping
+  TEST_EQUAL(copy.getSpectrumView(0).mz.data() == cache_example.getSpectrumView(0).mz.data(), true)
+}
+END_SECTION
+
+START_SECTION(MappedCachedMzML& operator=(const MappedCachedMzML& rhs))
+{
+  MappedCachedMzML copy;
+  copy = cache_example;
+  TEST_EQUAL(copy.getNrChromatograms(), 2)
+  TEST_EQUAL(copy.getChromatogramView(1).rt.data() == cache_example.getChromatogramView(1).rt.data(), true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
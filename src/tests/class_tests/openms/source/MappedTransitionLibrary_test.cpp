@@ -0,0 +1,438 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/MappedTransitionLibrary.h>
+///////////////////////////
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+// a small library: three peptides (given in decreasing precursor m/z) with
+// two transitions each (interleaved) and one metabolite without transitions
+OpenSwath::LightTargetedExperiment createExperiment()
+{
+  OpenSwath::LightTargetedExperiment exp;
+  const char* ids[] = {"PEPA_2", "PEPB_2", "PEPC_3"};
+  const double mz[] = {600.0, 500.0, 400.0};
+  const double rt[] = {20.0, 40.0, 10.0};
+  for (Size i = 0; i < 3; ++i)
+  {
+    OpenSwath::LightCompound c;
+    c.id = ids[i];
+    c.sequence = String("PEP") + String(char('A' + i));
+    c.rt = rt[i];
+    c.charge = int(i) + 2;
+    c.peptide_group_label = "group";
+    c.protein_refs.push_back(i < 2 ? "P1" : "P2");
+    if (i == 0)
+    {
+      c.protein_refs.push_back("P2");
+      c.modifications.push_back({1, 35});
+      c.drift_time = 0.8;
+    }
+    exp.compounds.push_back(c);
+  }
+  OpenSwath::LightCompound metabolite;
+  metabolite.id = "M1";
+  metabolite.compound_name = "Glucose";
+  metabolite.sum_formula = "C6H12O6";
+  metabolite.rt = 5.0;
+  exp.compounds.push_back(metabolite);
+
+  for (Size k = 0; k < 2; ++k)
+  {
+    for (Size i = 0; i < 3; ++i)
+    {
+      OpenSwath::LightTransition t;
+      t.transition_name = String(ids[i]) + "_y" + String(k + 3);
+      t.peptide_ref = ids[i];
+      t.precursor_mz = mz[i];
+      t.product_mz = 300.0 + 100.0 * k + i;
+      t.library_intensity = 100.0 * (k + 1);
+      t.fragment_charge = 1;
+      t.decoy = (i == 1);
+      t.detecting_transition = true;
+      t.quantifying_transition = (k == 0);
+      t.identifying_transition = false;
+      exp.transitions.push_back(t);
+    }
+  }
+
+  OpenSwath::LightProtein p1, p2;
+  p1.id = "P1";
+  p1.sequence = "PEPAPEPB";
+  p2.id = "P2";
+  p2.sequence = "PEPC";
+  exp.proteins.push_back(p1);
+  exp.proteins.push_back(p2);
+  return exp;
+}
+
+START_TEST(MappedTransitionLibrary, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MappedTransitionLibrary* ptr = nullptr;
+MappedTransitionLibrary* null_ptr = nullptr;
+
+START_SECTION(MappedTransitionLibrary())
+{
+  ptr = new MappedTransitionLibrary();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->getNumberOfCompounds(), 0)
+  TEST_EQUAL(ptr->getNumberOfTransitions(), 0)
+  TEST_EQUAL(ptr->isMapped(), false)
+}
+END_SECTION
+
+START_SECTION(~MappedTransitionLibrary())
+{
+  delete ptr;
+}
+END_SECTION
+
+const OpenSwath::LightTargetedExperiment exp = createExperiment();
+MappedTransitionLibrary lib;
+
+START_SECTION(void build(const OpenSwath::LightTargetedExperiment& exp))
+{
+  lib.build(exp);
+  TEST_EQUAL(lib.getNumberOfCompounds(), 4)
+  TEST_EQUAL(lib.getNumberOfTransitions(), 6)
+  TEST_EQUAL(lib.getNumberOfProteins(), 2)
+  TEST_EQUAL(lib.isMapped(), false)
+
+  OpenSwath::LightTargetedExperiment invalid = createExperiment();
+  invalid.transitions[0].peptide_ref = "UNKNOWN";
+  MappedTransitionLibrary invalid_lib;
+  TEST_EXCEPTION(Exception::IllegalArgument, invalid_lib.build(invalid))
+}
+END_SECTION
+
+START_SECTION(Size getNumberOfCompounds() const)
+{
+  TEST_EQUAL(lib.getNumberOfCompounds(), 4)
+}
+END_SECTION
+
+START_SECTION(Size getNumberOfTransitions() const)
+{
+  TEST_EQUAL(lib.getNumberOfTransitions(), 6)
+}
+END_SECTION
+
+START_SECTION(Size getNumberOfProteins() const)
+{
+  TEST_EQUAL(lib.getNumberOfProteins(), 2)
+}
+END_SECTION
+
+START_SECTION(double getPrecursorMZ(Size index) const)
+{
+  // sorted by precursor m/z, the metabolite without transitions comes first
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(0), 0.0)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(1), 400.0)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(2), 500.0)
+  TEST_REAL_SIMILAR(lib.getPrecursorMZ(3), 600.0)
+}
+END_SECTION
+
+START_SECTION(double getRT(Size index) const)
+{
+  TEST_REAL_SIMILAR(lib.getRT(0), 5.0)
+  TEST_REAL_SIMILAR(lib.getRT(1), 10.0)
+  TEST_REAL_SIMILAR(lib.getRT(2), 40.0)
+  TEST_REAL_SIMILAR(lib.getRT(3), 20.0)
+}
+END_SECTION
+
+START_SECTION(double getDriftTime(Size index) const)
+{
+  TEST_REAL_SIMILAR(lib.getDriftTime(1), -1.0)
+  TEST_REAL_SIMILAR(lib.getDriftTime(3), 0.8)
+}
+END_SECTION
+
+START_SECTION(Int getCharge(Size index) const)
+{
+  TEST_EQUAL(lib.getCharge(0), 0)
+  TEST_EQUAL(lib.getCharge(1), 4)
+  TEST_EQUAL(lib.getCharge(3), 2)
+}
+END_SECTION
+
+START_SECTION(StringView getCompoundId(Size index) const)
+{
+  TEST_EQUAL(lib.getCompoundId(0).getString(), "M1")
+  TEST_EQUAL(lib.getCompoundId(1).getString(), "PEPC_3")
+  TEST_EQUAL(lib.getCompoundId(2).getString(), "PEPB_2")
+  TEST_EQUAL(lib.getCompoundId(3).getString(), "PEPA_2")
+}
+END_SECTION
+
+START_SECTION(StringView getSequence(Size index) const)
+{
+  TEST_EQUAL(lib.getSequence(0).getString(), "")
+  TEST_EQUAL(lib.getSequence(1).getString(), "PEPC")
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getTransitionRange(Size index) const))
+{
+  TEST_EQUAL(lib.getTransitionRange(0).first, 0)
+  TEST_EQUAL(lib.getTransitionRange(0).second, 0)
+  TEST_EQUAL(lib.getTransitionRange(1).first, 0)
+  TEST_EQUAL(lib.getTransitionRange(1).second, 2)
+  TEST_EQUAL(lib.getTransitionRange(3).first, 4)
+  TEST_EQUAL(lib.getTransitionRange(3).second, 6)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::LightCompound getCompound(Size index) const)
+{
+  OpenSwath::LightCompound c = lib.getCompound(3);
+  TEST_EQUAL(c.id, "PEPA_2")
+  TEST_EQUAL(c.sequence, "PEPA")
+  TEST_EQUAL(c.peptide_group_label, "group")
+  TEST_EQUAL(c.isPeptide(), true)
+  TEST_EQUAL(c.protein_refs.size(), 2)
+  TEST_EQUAL(c.protein_refs[1], "P2")
+  TEST_EQUAL(c.modifications.size(), 1)
+  TEST_EQUAL(c.modifications[0].location, 1)
+  TEST_EQUAL(c.modifications[0].unimod_id, 35)
+
+  OpenSwath::LightCompound m = lib.getCompound(0);
+  TEST_EQUAL(m.isPeptide(), false)
+  TEST_EQUAL(m.compound_name, "Glucose")
+  TEST_EQUAL(m.sum_formula, "C6H12O6")
+  TEST_EQUAL(m.protein_refs.empty(), true)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::LightTransition getTransition(Size index) const)
+{
+  // transitions are grouped by compound, in their original order
+  OpenSwath::LightTransition t = lib.getTransition(2);
+  TEST_EQUAL(t.transition_name, "PEPB_2_y3")
+  TEST_EQUAL(t.peptide_ref, "PEPB_2")
+  TEST_REAL_SIMILAR(t.precursor_mz, 500.0)
+  TEST_REAL_SIMILAR(t.product_mz, 301.0)
+  TEST_REAL_SIMILAR(t.library_intensity, 100.0)
+  TEST_EQUAL(t.fragment_charge, 1)
+  TEST_EQUAL(t.decoy, true)
+  TEST_EQUAL(t.isDetectingTransition(), true)
+  TEST_EQUAL(t.isQuantifyingTransition(), true)
+  TEST_EQUAL(t.isIdentifyingTransition(), false)
+
+  t = lib.getTransition(3);
+  TEST_EQUAL(t.transition_name, "PEPB_2_y4")
+  TEST_EQUAL(t.isQuantifyingTransition(), false)
+  TEST_EQUAL(t.isPrecursorImSet(), false)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::LightProtein getProtein(Size index) const)
+{
+  TEST_EQUAL(lib.getProtein(0).id, "P1")
+  TEST_EQUAL(lib.getProtein(1).sequence, "PEPC")
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getMZRange(double min_mz, double max_mz) const))
+{
+  TEST_EQUAL(lib.getMZRange(450.0, 650.0).first, 2)
+  TEST_EQUAL(lib.getMZRange(450.0, 650.0).second, 4)
+  TEST_EQUAL(lib.getMZRange(400.0, 500.0).first, 1)
+  TEST_EQUAL(lib.getMZRange(400.0, 500.0).second, 3)
+  TEST_EQUAL(lib.getMZRange(700.0, 800.0).first, lib.getMZRange(700.0, 800.0).second)
+  TEST_EQUAL(lib.getMZRange(500.0, 400.0).first, lib.getMZRange(500.0, 400.0).second)
+}
+END_SECTION
+
+START_SECTION((std::pair<const UInt32*, const UInt32*> getRTRange(double min_rt, double max_rt) const))
+{
+  std::pair<const UInt32*, const UInt32*> range = lib.getRTRange(8.0, 30.0);
+  TEST_EQUAL(range.second - range.first, 2)
+  TEST_EQUAL(range.first[0], 1) // RT 10
+  TEST_EQUAL(range.first[1], 3) // RT 20
+  range = lib.getRTRange(0.0, 100.0);
+  TEST_EQUAL(range.second - range.first, 4)
+  range = lib.getRTRange(50.0, 100.0);
+  TEST_EQUAL(range.second - range.first, 0)
+}
+END_SECTION
+
+START_SECTION(Size findCompound(const String& id) const)
+{
+  TEST_EQUAL(lib.findCompound("PEPA_2"), 3)
+  TEST_EQUAL(lib.findCompound("PEPB_2"), 2)
+  TEST_EQUAL(lib.findCompound("M1"), 0)
+  TEST_EQUAL(lib.findCompound("PEPD_2"), 4)
+  TEST_EQUAL(lib.findCompound(""), 4)
+}
+END_SECTION
+
+START_SECTION(void toLightTargetedExperiment(OpenSwath::LightTargetedExperiment& exp) const)
+{
+  OpenSwath::LightTargetedExperiment converted;
+  lib.toLightTargetedExperiment(converted);
+  TEST_EQUAL(converted.getCompounds().size(), exp.getCompounds().size())
+  TEST_EQUAL(converted.getTransitions().size(), exp.getTransitions().size())
+  TEST_EQUAL(converted.getProteins().size(), exp.getProteins().size())
+
+  // all transitions are preserved (by name)
+  for (const OpenSwath::LightTransition& t : exp.getTransitions())
+  {
+    bool found = false;
+    for (const OpenSwath::LightTransition& c : converted.getTransitions())
+    {
+      if (c.transition_name == t.transition_name)
+      {
+        found = true;
+        TEST_EQUAL(c.peptide_ref, t.peptide_ref)
+        TEST_REAL_SIMILAR(c.product_mz, t.product_mz)
+        TEST_EQUAL(c.decoy, t.decoy)
+      }
+    }
+    TEST_EQUAL(found, true)
+  }
+  TEST_EQUAL(converted.getCompoundByRef("PEPC_3").sequence, "PEPC")
+  TEST_REAL_SIMILAR(converted.getCompoundByRef("PEPA_2").rt, 20.0)
+}
+END_SECTION
+
+START_SECTION(void toLightTargetedExperiment(double min_mz, double max_mz, OpenSwath::LightTargetedExperiment& exp) const)
+{
+  OpenSwath::LightTargetedExperiment converted;
+  lib.toLightTargetedExperiment(350.0, 450.0, converted);
+  TEST_EQUAL(converted.getCompounds().size(), 1)
+  TEST_EQUAL(converted.getCompounds()[0].id, "PEPC_3")
+  TEST_EQUAL(converted.getTransitions().size(), 2)
+  TEST_EQUAL(converted.getTransitions()[0].transition_name, "PEPC_3_y3")
+  TEST_EQUAL(converted.getTransitions()[1].transition_name, "PEPC_3_y4")
+  // only the referenced protein
+  TEST_EQUAL(converted.getProteins().size(), 1)
+  TEST_EQUAL(converted.getProteins()[0].id, "P2")
+
+  lib.toLightTargetedExperiment(700.0, 800.0, converted);
+  TEST_EQUAL(converted.getCompounds().size(), 0)
+  TEST_EQUAL(converted.getTransitions().size(), 0)
+  TEST_EQUAL(converted.getProteins().size(), 0)
+}
+END_SECTION
+
+START_SECTION(void store(const String& filename) const)
+{
+  NOT_TESTABLE // tested with load
+}
+END_SECTION
+
+START_SECTION(void load(const String& filename))
+{
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+  lib.store(tmp_file);
+
+  MappedTransitionLibrary loaded;
+  loaded.load(tmp_file);
+  TEST_EQUAL(loaded.isMapped(), true)
+  TEST_EQUAL(loaded.getNumberOfCompounds(), lib.getNumberOfCompounds())
+  TEST_EQUAL(loaded.getNumberOfTransitions(), lib.getNumberOfTransitions())
+  TEST_EQUAL(loaded.getNumberOfProteins(), lib.getNumberOfProteins())
+  for (Size i = 0; i < loaded.getNumberOfCompounds(); ++i)
+  {
+    TEST_EQUAL(loaded.getCompoundId(i).getString(), lib.getCompoundId(i).getString())
+    TEST_REAL_SIMILAR(loaded.getPrecursorMZ(i), lib.getPrecursorMZ(i))
+  }
+  for (Size i = 0; i < loaded.getNumberOfTransitions(); ++i)
+  {
+    TEST_EQUAL(loaded.getTransition(i).transition_name, lib.getTransition(i).transition_name)
+  }
+  TEST_EQUAL(loaded.findCompound("PEPB_2"), 2)
+
+  // empty library
+  MappedTransitionLibrary().store(tmp_file);
+  loaded.load(tmp_file);
+  TEST_EQUAL(loaded.getNumberOfCompounds(), 0)
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("this_file_does_not_exist.tlib"))
+
+  String invalid_file;
+  NEW_TMP_FILE(invalid_file)
+  {
+    ofstream ofs(invalid_file.c_str());
+    ofs << "not a transition library";
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(invalid_file))
+
+  // truncated file
+  lib.store(tmp_file);
+  {
+    ifstream ifs(tmp_file.c_str(), ios::binary);
+    string content((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+    ifs.close();
+    ofstream ofs(tmp_file.c_str(), ios::binary | ios::trunc);
+    ofs.write(content.data(), content.size() / 2);
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(tmp_file))
+}
+END_SECTION
+
+START_SECTION(static bool isMappedTransitionLibrary(const String& filename))
+{
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+  lib.store(tmp_file);
+  TEST_EQUAL(MappedTransitionLibrary::isMappedTransitionLibrary(tmp_file), true)
+  TEST_EQUAL(MappedTransitionLibrary::isMappedTransitionLibrary(OPENMS_GET_TEST_DATA_PATH("MRMAssay_detectingTransitions_input.TraML")), false)
+  TEST_EQUAL(MappedTransitionLibrary::isMappedTransitionLibrary("this_file_does_not_exist.tlib"), false)
+}
+END_SECTION
+
+START_SECTION(bool isMapped() const)
+{
+  NOT_TESTABLE // tested with load
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -36,6 +36,10 @@
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////
 #include <OpenMS/FILTERING/DATAREDUCTION/MassTraceDetection.h>
 ///////////////////////////
@@ -236,7 +240,48 @@ START_SECTION((void run(PeakMap::ConstAreaIterator &begin, PeakMap::ConstAreaIte
 }
 END_SECTION
 
-
+START_SECTION(([EXTRA] parallel m/z strips))
+{
+  // speculative traces of the m/z strips are validated against the serial order: results must not depend on strips or threads
+  PeakMap lcms;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("../../../topp/FeatureFinderMetabo_1_input.mzML"), lcms);
+
+  MassTraceDetection mtd;
+  Param p = mtd.getParameters();
+  p.setValue("noise_threshold_int", 10.0);
+  p.setValue("mz_strips", 1);
+  mtd.setParameters(p);
+  mtd.setLogType(ProgressLogger::NONE);
+
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  std::vector<MassTrace> reference;
+  mtd.run(lcms, reference);
+  TEST_NOT_EQUAL(reference.size(), 0)
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  for (int strips : {0, 3, 16})
+  {
+    p.setValue("mz_strips", strips);
+    mtd.setParameters(p);
+    std::vector<MassTrace> traces;
+    mtd.run(lcms, traces);
+
+    ABORT_IF(traces.size() != reference.size())
+    for (Size i = 0; i != traces.size(); ++i)
+    {
+      TEST_EQUAL(traces[i].getLabel(), reference[i].getLabel())
+      TEST_EQUAL(traces[i].getSize(), reference[i].getSize())
+      TEST_EQUAL(traces[i].getCentroidMZ(), reference[i].getCentroidMZ())
+      TEST_EQUAL(traces[i].getCentroidRT(), reference[i].getCentroidRT())
+    }
+  }
+}
+END_SECTION
 
 
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,190 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+///////////////////////////
+
+#include <fstream>
+#include <iterator>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(MemoryMappedFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MemoryMappedFile* ptr = nullptr;
+MemoryMappedFile* nullPointer = nullptr;
+
+START_SECTION(MemoryMappedFile())
+{
+  ptr = new MemoryMappedFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->data() == nullptr, true)
+}
+END_SECTION
+
+START_SECTION(~MemoryMappedFile())
+{
+  delete ptr;
+}
+END_SECTION
+
+const String filename = OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML");
+std::ifstream ifs(filename.c_str(), std::ios::binary);
+const std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+START_SECTION(explicit MemoryMappedFile(const String& filename))
+{
+  MemoryMappedFile file(filename);
+  TEST_EQUAL(file.isOpen(), true)
+  TEST_EQUAL(file.size(), content.size())
+  TEST_EQUAL(std::string(file.data(), file.size()) == content, true)
+  TEST_EQUAL(file.getFilename(), filename)
+
+  TEST_EXCEPTION(Exception::FileNotFound, MemoryMappedFile("does_not_exist.txt"))
+}
+END_SECTION
+
+START_SECTION(void open(const String& filename))
+{
+  MemoryMappedFile file;
+  file.open(filename);
+  TEST_EQUAL(file.isOpen(), true)
+  TEST_EQUAL(file.size(), content.size())
+  TEST_EQUAL(std::string(file.data(), file.size()) == content, true)
+
+  // empty files can be opened, but do not provide data
+  file.open(OPENMS_GET_TEST_DATA_PATH("File_test_empty.txt"));
+  TEST_EQUAL(file.isOpen(), true)
+  TEST_EQUAL(file.size(), 0)
+  TEST_EQUAL(file.data() == nullptr, true)
+
+  TEST_EXCEPTION(Exception::FileNotFound, file.open("does_not_exist.txt"))
+  TEST_EQUAL(file.isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  MemoryMappedFile file(filename);
+  file.close();
+  TEST_EQUAL(file.isOpen(), false)
+  TEST_EQUAL(file.size(), 0)
+  TEST_EQUAL(file.data() == nullptr, true)
+  TEST_EQUAL(file.getFilename(), "")
+  file.close(); // closing twice is fine
+  TEST_EQUAL(file.isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(bool isOpen() const)
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION(const char* data() const)
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION(Size size() const)
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION(const String& getFilename() const)
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION(MemoryMappedFile(MemoryMappedFile&& rhs) noexcept)
+{
+  MemoryMappedFile file(filename);
+  const char* data = file.data();
+  MemoryMappedFile moved(std::move(file));
+  TEST_EQUAL(moved.isOpen(), true)
+  TEST_EQUAL(moved.data() == data, true)
+  TEST_EQUAL(moved.size(), content.size())
+  TEST_EQUAL(file.isOpen(), false)
+  TEST_EQUAL(file.data() == nullptr, true)
+}
+END_SECTION
+
+START_SECTION(MemoryMappedFile& operator=(MemoryMappedFile&& rhs) noexcept)
+{
+  MemoryMappedFile file(filename);
+  const char* data = file.data();
+  MemoryMappedFile moved(OPENMS_GET_TEST_DATA_PATH("File_test_empty.txt"));
+  moved = std::move(file);
+  TEST_EQUAL(moved.isOpen(), true)
+  TEST_EQUAL(moved.data() == data, true)
+  TEST_EQUAL(std::string(moved.data(), moved.size()) == content, true)
+  TEST_EQUAL(file.isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(void advise(AccessPattern pattern) const)
+{
+  MemoryMappedFile file(filename);
+  file.advise(MemoryMappedFile::AccessPattern::SEQUENTIAL);
+  file.advise(MemoryMappedFile::AccessPattern::RANDOM);
+  file.advise(MemoryMappedFile::AccessPattern::NORMAL);
+  // only a hint, content does not change
+  TEST_EQUAL(std::string(file.data(), file.size()) == content, true)
+
+  MemoryMappedFile empty;
+  empty.advise(MemoryMappedFile::AccessPattern::RANDOM);
+  TEST_EQUAL(empty.isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(void prefetch(Size offset, Size length) const)
+{
+  MemoryMappedFile file(filename);
+  file.prefetch(0, file.size());
+  file.prefetch(17, 100);
+  file.prefetch(file.size() - 1, 1000); // clipped
+  file.prefetch(file.size() + 1000, 10); // ignored
+  TEST_EQUAL(std::string(file.data(), file.size()) == content, true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -40,6 +40,7 @@
 ///////////////////////////
 
 #include <OpenMS/FORMAT/FileTypes.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataStoringConsumer.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
 using namespace OpenMS;
@@ -72,12 +73,16 @@ public:
   double TIC;
   int nr_spectra;
   long int nr_peaks;
+  Size expected_spectra;
+  Size expected_chromatograms;
 
   // Create new consumer, set TIC to zero
   TICConsumer() :
     TIC(0.0),
     nr_spectra(0.0),
-    nr_peaks(0)
+    nr_peaks(0),
+    expected_spectra(0),
+    expected_chromatograms(0)
     {}
 
   void consumeSpectrum(SpectrumType & s) override
@@ -91,7 +96,11 @@ public:
   }
 
   void consumeChromatogram(ChromatogramType& /* c */) override {}
-  void setExpectedSize(Size /* expectedSpectra */, Size /* expectedChromatograms */) override {}
+  void setExpectedSize(Size expectedSpectra, Size expectedChromatograms) override
+  {
+    expected_spectra = expectedSpectra;
+    expected_chromatograms = expectedChromatograms;
+  }
   void setExperimentalSettings(const ExperimentalSettings& /* exp */) override {}
 };
 
@@ -1233,6 +1242,57 @@ START_SECTION(void transform(const String& filename_in, Interfaces::IMSDataConsu
 }
 END_SECTION
 
+START_SECTION(void transformParallel(const String& filename_in, Interfaces::IMSDataConsumer * consumer, bool skip_full_count = false, bool skip_first_pass = false))
+{
+  MzMLFile mzml;
+  PeakFileOptions opt = mzml.getOptions();
+  opt.setMaxDataPoolSize(1); // one spectrum per chunk
+  mzml.setOptions(opt);
+
+  // indexed file: chunks are parsed in parallel
+  String in = OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML");
+  PeakMap reference;
+  mzml.load(in, reference);
+
+  MSDataStoringConsumer consumer;
+  mzml.transformParallel(in, &consumer);
+  const PeakMap& result = consumer.getData();
+  TEST_EQUAL(result.size(), reference.size())
+  TEST_EQUAL(result.getChromatograms().size(), reference.getChromatograms().size())
+  ABORT_IF(result.size() != reference.size())
+  for (Size i = 0; i < result.size(); ++i)
+  {
+    TEST_EQUAL(result[i].getNativeID(), reference[i].getNativeID())
+    TEST_REAL_SIMILAR(result[i].getRT(), reference[i].getRT())
+    TEST_EQUAL(result[i].getMSLevel(), reference[i].getMSLevel())
+    TEST_EQUAL(result[i].size(), reference[i].size())
+    ABORT_IF(result[i].empty())
+    TEST_REAL_SIMILAR(result[i].back().getMZ(), reference[i].back().getMZ())
+    TEST_REAL_SIMILAR(result[i].back().getIntensity(), reference[i].back().getIntensity())
+  }
+  ABORT_IF(result.getChromatograms().size() != reference.getChromatograms().size())
+  for (Size i = 0; i < result.getChromatograms().size(); ++i)
+  {
+    TEST_EQUAL(result.getChromatograms()[i].getNativeID(), reference.getChromatograms()[i].getNativeID())
+    TEST_EQUAL(result.getChromatograms()[i].size(), reference.getChromatograms()[i].size())
+  }
+  TEST_EQUAL(result.getInstrument().getName(), reference.getInstrument().getName())
+
+  // the expected size is taken from the index
+  TICConsumer indexed_consumer;
+  mzml.transformParallel(in, &indexed_consumer);
+  TEST_EQUAL(indexed_consumer.expected_spectra, reference.size())
+  TEST_EQUAL(indexed_consumer.expected_chromatograms, reference.getChromatograms().size())
+
+  // non-indexed file: falls back to serial parsing
+  TICConsumer tic_consumer;
+  mzml.transformParallel(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &tic_consumer, true, true);
+  TEST_EQUAL(tic_consumer.nr_spectra, 4)
+  TEST_EQUAL(tic_consumer.nr_peaks, 40)
+  TEST_REAL_SIMILAR(tic_consumer.TIC, 350)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
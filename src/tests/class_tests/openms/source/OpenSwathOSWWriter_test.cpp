@@ -0,0 +1,322 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/SqliteConnector.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+// a small feature map with one feature (and two fragment ion subordinates) per entry
+FeatureMap createFeatures(Size nr_features, Size offset)
+{
+  FeatureMap features;
+  for (Size i = 0; i < nr_features; ++i)
+  {
+    Feature f;
+    f.setUniqueId(offset + i + 1);
+    f.setRT(100.0 + i);
+    f.setIntensity(1000.0 + i);
+    f.setMetaValue("leftWidth", 95.0 + i);
+    f.setMetaValue("rightWidth", 105.0 + i);
+    f.setMetaValue("total_xic", 100.0);
+    f.setMetaValue("peak_apices_sum", 15.0);
+    f.setMetaValue("var_xcorr_shape", 0.5 + 0.01 * i);
+    for (Size k = 0; k < 2; ++k)
+    {
+      Feature sub;
+      sub.setIntensity(10.0 * (k + 1));
+      sub.setMetaValue("FeatureLevel", "MS2");
+      sub.setMetaValue("native_id", Int(k + 1));
+      sub.setMetaValue("total_xic", 50.0);
+      sub.setMetaValue("peak_apex_int", 5.0 * (k + 1));
+      f.getSubordinates().push_back(sub);
+    }
+    features.push_back(f);
+  }
+  return features;
+}
+
+// number of rows of @p table which differ between the two databases (using @p scratch for the comparison)
+Size countDifferentRows(const String& filename1, const String& filename2, const String& table, const String& scratch)
+{
+  SqliteConnector conn(scratch);
+  conn.executeStatement("DROP TABLE IF EXISTS DIFF; ATTACH DATABASE '" + filename1 + "' AS db1; ATTACH DATABASE '" + filename2 + "' AS db2;");
+  conn.executeStatement("CREATE TABLE DIFF AS SELECT * FROM (SELECT * FROM db1." + table + " EXCEPT SELECT * FROM db2." + table + ") "
+                        "UNION ALL SELECT * FROM (SELECT * FROM db2." + table + " EXCEPT SELECT * FROM db1." + table + ");");
+  return conn.countTableRows("DIFF");
+}
+
+// the file format version bytes in the SQLite header are 1 for rollback journal and 2 for WAL mode
+int fileFormatVersion(const String& filename)
+{
+  std::ifstream is(filename.c_str(), std::ios::binary);
+  char header[20];
+  is.read(header, 20);
+  return header[18];
+}
+
+START_TEST(OpenSwathOSWWriter, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OpenSwathOSWWriter* ptr = nullptr;
+OpenSwathOSWWriter* nullPointer = nullptr;
+
+START_SECTION(OpenSwathOSWWriter(const String& output_filename, const UInt64 run_id, const String& input_filename = "inputfile", bool ms1_scores = false, bool sonar = false, bool uis_scores = false))
+{
+  ptr = new OpenSwathOSWWriter("", 1);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+}
+END_SECTION
+
+START_SECTION(~OpenSwathOSWWriter())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(bool isActive() const)
+{
+  TEST_EQUAL(OpenSwathOSWWriter("", 1).isActive(), false)
+  TEST_EQUAL(OpenSwathOSWWriter("test.osw", 1).isActive(), true)
+}
+END_SECTION
+
+String sync_file;
+NEW_TMP_FILE(sync_file)
+
+START_SECTION(void writeLines(const std::vector<String>& to_osw_output))
+{
+  OpenSwathOSWWriter writer(sync_file, 42, "run.mzML");
+  writer.writeHeader();
+  for (Size batch = 0; batch < 8; ++batch)
+  {
+    vector<String> lines;
+    lines.push_back(writer.prepareLine(OpenSwath::LightCompound(), nullptr, createFeatures(5, batch * 5), String(batch)));
+    writer.writeLines(lines);
+  }
+
+  SqliteConnector conn(sync_file);
+  TEST_EQUAL(conn.countTableRows("RUN"), 1)
+  TEST_EQUAL(conn.countTableRows("FEATURE"), 40)
+  TEST_EQUAL(conn.countTableRows("FEATURE_MS2"), 40)
+  TEST_EQUAL(conn.countTableRows("FEATURE_TRANSITION"), 80)
+
+  // without writer thread, concurrent writes are serialized
+  String parallel_file;
+  NEW_TMP_FILE(parallel_file)
+  OpenSwathOSWWriter parallel_writer(parallel_file, 42, "run.mzML");
+  parallel_writer.writeHeader();
+#pragma omp parallel for
+  for (SignedSize batch = 0; batch < 8; ++batch)
+  {
+    vector<String> lines;
+    lines.push_back(parallel_writer.prepareLine(OpenSwath::LightCompound(), nullptr, createFeatures(5, batch * 5), String(batch)));
+    parallel_writer.writeLines(lines);
+  }
+  TEST_EQUAL(SqliteConnector(parallel_file).countTableRows("FEATURE"), 40)
+  TEST_EQUAL(SqliteConnector(parallel_file).countTableRows("FEATURE_TRANSITION"), 80)
+}
+END_SECTION
+
+START_SECTION(void startWriterThread(Size max_queued_statements = 10000))
+{
+  // writes from several threads end up in the same file as the sequential writes
+  String async_file;
+  NEW_TMP_FILE(async_file)
+  OpenSwathOSWWriter writer(async_file, 42, "run.mzML");
+  writer.writeHeader();
+  writer.startWriterThread();
+  writer.startWriterThread(); // no-op while running
+#pragma omp parallel for
+  for (SignedSize batch = 7; batch >= 0; --batch)
+  {
+    vector<String> lines;
+    lines.push_back(writer.prepareLine(OpenSwath::LightCompound(), nullptr, createFeatures(5, batch * 5), String(batch)));
+    writer.writeLines(std::move(lines));
+  }
+  writer.flush();
+
+  String scratch_file;
+  NEW_TMP_FILE(scratch_file)
+  for (const String table : {"RUN", "FEATURE", "FEATURE_MS1", "FEATURE_MS2", "FEATURE_PRECURSOR", "FEATURE_TRANSITION"})
+  {
+    TEST_EQUAL(SqliteConnector(async_file).countTableRows(table), SqliteConnector(sync_file).countTableRows(table))
+    TEST_EQUAL(countDifferentRows(sync_file, async_file, table, scratch_file), 0)
+  }
+
+  // the database is left in rollback journal mode without a WAL file
+  TEST_EQUAL(fileFormatVersion(async_file), 1)
+  TEST_EQUAL(File::exists(async_file + "-wal"), false)
+
+  // after flush, writes go directly to disk again
+  vector<String> lines;
+  lines.push_back(writer.prepareLine(OpenSwath::LightCompound(), nullptr, createFeatures(1, 100), "8"));
+  writer.writeLines(lines);
+  TEST_EQUAL(SqliteConnector(async_file).countTableRows("FEATURE"), 41)
+
+  // with a full queue, writeLines waits for the writer thread
+  String bounded_file;
+  NEW_TMP_FILE(bounded_file)
+  OpenSwathOSWWriter bounded_writer(bounded_file, 42, "run.mzML");
+  bounded_writer.writeHeader();
+  bounded_writer.startWriterThread(1);
+#pragma omp parallel for
+  for (SignedSize batch = 7; batch >= 0; --batch)
+  {
+    vector<String> lines;
+    lines.push_back(bounded_writer.prepareLine(OpenSwath::LightCompound(), nullptr, createFeatures(5, batch * 5), String(batch)));
+    bounded_writer.writeLines(std::move(lines));
+  }
+  bounded_writer.flush();
+  for (const String table : {"FEATURE", "FEATURE_MS2", "FEATURE_TRANSITION"})
+  {
+    TEST_EQUAL(countDifferentRows(sync_file, bounded_file, table, scratch_file), 0)
+  }
+}
+END_SECTION
+
+START_SECTION(void flush())
+{
+  // no-op without writer thread
+  OpenSwathOSWWriter inactive("", 1);
+  inactive.startWriterThread();
+  inactive.flush();
+
+  // errors on the writer thread are reported by flush()
+  String async_file;
+  NEW_TMP_FILE(async_file)
+  OpenSwathOSWWriter writer(async_file, 42, "run.mzML");
+  writer.writeHeader();
+  writer.startWriterThread();
+  writer.writeLines(vector<String>{"INSERT INTO NO_SUCH_TABLE VALUES (1);"});
+  // after the error, further statements are discarded instead of waiting for the failed writer
+  OpenSwathOSWWriter bounded(async_file, 42, "run.mzML");
+  bounded.startWriterThread(1);
+  bounded.writeLines(vector<String>{"INSERT INTO NO_SUCH_TABLE VALUES (1);"});
+  bounded.writeLines(vector<String>{"INSERT INTO RUN VALUES (1, 'a');"});
+  bounded.writeLines(vector<String>{"INSERT INTO RUN VALUES (2, 'b');"});
+  TEST_EXCEPTION(Exception::IllegalArgument, bounded.flush())
+  TEST_EXCEPTION(Exception::IllegalArgument, writer.flush())
+  writer.flush(); // error is only reported once
+}
+END_SECTION
+
+String checkpoint_file;
+NEW_TMP_FILE(checkpoint_file)
+
+START_SECTION(void enableCheckpointing(const String& fingerprint))
+{
+  // first run: window 0 is written completely, then the run is interrupted
+  OpenSwathOSWWriter writer(checkpoint_file, 42, "run.mzML");
+  TEST_EQUAL(writer.isCheckpointing(), false)
+  writer.enableCheckpointing("abc");
+  TEST_EQUAL(writer.isCheckpointing(), true)
+  TEST_EQUAL(writer.isResuming(), false)
+  TEST_EQUAL(writer.getCompletedWindows().empty(), true)
+  writer.writeHeader();
+  writer.startWriterThread();
+  writer.writeLines(vector<String>{writer.prepareLine(OpenSwath::LightCompound(), nullptr, createFeatures(5, 0), "0"),
+                                   writer.prepareCheckpoint(0)});
+  writer.flush();
+  TEST_EQUAL(SqliteConnector(checkpoint_file).countTableRows("CHECKPOINT"), 2)
+
+  // restart with a different run id: the run of the checkpoint is continued
+  OpenSwathOSWWriter resumed(checkpoint_file, 43, "run.mzML");
+  resumed.enableCheckpointing("abc");
+  TEST_EQUAL(resumed.isResuming(), true)
+  TEST_EQUAL(resumed.getCompletedWindows().size(), 1)
+  TEST_EQUAL(*resumed.getCompletedWindows().begin(), 0)
+  resumed.writeHeader(); // keeps the existing tables
+  resumed.writeLines(vector<String>{resumed.prepareLine(OpenSwath::LightCompound(), nullptr, createFeatures(5, 5), "1"),
+                                    resumed.prepareCheckpoint(1)});
+
+  SqliteConnector conn(checkpoint_file);
+  TEST_EQUAL(conn.countTableRows("RUN"), 1)
+  TEST_EQUAL(conn.countTableRows("FEATURE"), 10)
+  TEST_EQUAL(conn.countTableRows("CHECKPOINT"), 3)
+
+  // a checkpoint of different inputs or parameters cannot be continued
+  OpenSwathOSWWriter other(checkpoint_file, 44, "run.mzML");
+  TEST_EXCEPTION(Exception::IllegalArgument, other.enableCheckpointing("xyz"))
+
+  // without checkpoint, a new run is started
+  OpenSwathOSWWriter inactive("", 1);
+  inactive.enableCheckpointing("abc");
+  TEST_EQUAL(inactive.isCheckpointing(), false)
+  TEST_EQUAL(inactive.prepareCheckpoint(0), "")
+}
+END_SECTION
+
+START_SECTION(static bool hasCheckpoint(const String& filename, const String& fingerprint))
+{
+  TEST_EQUAL(OpenSwathOSWWriter::hasCheckpoint(checkpoint_file, "abc"), true)
+  TEST_EQUAL(OpenSwathOSWWriter::hasCheckpoint(checkpoint_file, "xyz"), false)
+  TEST_EQUAL(OpenSwathOSWWriter::hasCheckpoint(sync_file, "abc"), false)
+  TEST_EQUAL(OpenSwathOSWWriter::hasCheckpoint(checkpoint_file + ".missing", "abc"), false)
+}
+END_SECTION
+
+START_SECTION(void finishCheckpointing())
+{
+  OpenSwathOSWWriter writer(checkpoint_file, 42, "run.mzML");
+  writer.enableCheckpointing("abc");
+  writer.finishCheckpointing();
+  TEST_EQUAL(writer.isCheckpointing(), false)
+  TEST_EQUAL(SqliteConnector(checkpoint_file).tableExists("CHECKPOINT"), false)
+  TEST_EQUAL(OpenSwathOSWWriter::hasCheckpoint(checkpoint_file, "abc"), false)
+
+  // all features belong to the run of the first start
+  String scratch_file;
+  NEW_TMP_FILE(scratch_file)
+  SqliteConnector conn(scratch_file);
+  conn.executeStatement("ATTACH DATABASE '" + checkpoint_file + "' AS db; CREATE TABLE OTHER_RUN AS SELECT * FROM db.FEATURE WHERE RUN_ID != 42;");
+  TEST_EQUAL(conn.countTableRows("OTHER_RUN"), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
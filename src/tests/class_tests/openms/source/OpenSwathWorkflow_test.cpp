@@ -0,0 +1,127 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+class OpenSwathWorkflowBaseTest :
+  public OpenSwathWorkflowBase
+{
+public:
+  explicit OpenSwathWorkflowBaseTest(int threads_outer_loop) :
+    OpenSwathWorkflowBase(false, false, false, false, threads_outer_loop)
+  {
+  }
+
+  using OpenSwathWorkflowBase::getWindowSlotCount_;
+  using OpenSwathWorkflowBase::runWindowTasks_;
+};
+
+START_TEST(OpenSwathWorkflow, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+START_SECTION(Size getWindowSlotCount_(Size nr_windows) const)
+{
+  Size nr_threads = 1;
+#ifdef _OPENMP
+  nr_threads = omp_get_max_threads();
+#endif
+  // by default one window per thread
+  TEST_EQUAL(OpenSwathWorkflowBaseTest(-1).getWindowSlotCount_(1000), nr_threads)
+  TEST_EQUAL(OpenSwathWorkflowBaseTest(-1).getWindowSlotCount_(1), 1)
+  TEST_EQUAL(OpenSwathWorkflowBaseTest(-1).getWindowSlotCount_(0), 1)
+  // threads_outer_loop_ takes precedence
+  TEST_EQUAL(OpenSwathWorkflowBaseTest(3).getWindowSlotCount_(1000), 3)
+}
+END_SECTION
+
+START_SECTION(static void runWindowTasks_(const std::vector<Size>& windows, Size nr_slots, const std::function<void(Size)>& process_window))
+{
+#ifdef _OPENMP
+  const int old_nr_threads = omp_get_max_threads();
+  omp_set_num_threads(6);
+#endif
+  std::vector<Size> windows(40);
+  for (Size i = 0; i < windows.size(); ++i)
+  {
+    windows[i] = windows.size() - 1 - i;
+  }
+
+  for (Size nr_slots : {Size(1), Size(2), Size(4)})
+  {
+    std::vector<int> processed(windows.size(), 0);
+    int active = 0, peak_active = 0;
+    OpenSwathWorkflowBaseTest::runWindowTasks_(windows, nr_slots, [&](Size i)
+      {
+#pragma omp critical (test_window_count)
+        {
+          ++processed[i];
+          peak_active = std::max(peak_active, ++active);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+#pragma omp critical (test_window_count)
+        --active;
+      });
+    TEST_EQUAL(std::count(processed.begin(), processed.end(), 1), windows.size())
+    TEST_EQUAL(peak_active <= int(nr_slots), true)
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(old_nr_threads);
+#endif
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,183 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataStoringConsumer.h>
+
+#include <cmath>
+
+using namespace OpenMS;
+using namespace std;
+
+// profile spectrum with Gaussian peaks at 400, 400.5, ... (one every 0.5 m/z, every 'shift'-th one left out)
+MSSpectrum profileSpectrum(Size index, Size shift)
+{
+  MSSpectrum s;
+  s.setRT(10.0 * index);
+  s.setName(String("spec") + index);
+  s.setMSLevel(index % 3 == 2 ? 2 : 1);
+  s.setType(SpectrumSettings::PROFILE);
+  for (Size i = 0; i < 2000; ++i)
+  {
+    double mz = 400.0 + i * 0.002;
+    double offset = std::fmod(mz - 400.0, 0.5);
+    Size peak = Size((mz - 400.0) / 0.5);
+    double intensity = (peak % shift == 0) ? 0.0 : 1000.0 * (peak + 1) * std::exp(-(offset - 0.25) * (offset - 0.25) / (2 * 0.01 * 0.01));
+    s.push_back(Peak1D(mz, intensity));
+  }
+  return s;
+}
+
+START_TEST(PeakPickerHiResConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeakPickerHiResConsumer* ptr = nullptr;
+PeakPickerHiResConsumer* null_ptr = nullptr;
+MSDataStoringConsumer storage;
+PeakPickerHiRes pp;
+
+START_SECTION((PeakPickerHiResConsumer(Interfaces::IMSDataConsumer* next_consumer, const PeakPickerHiRes& pp, Size batch_size = 0)))
+{
+  ptr = new PeakPickerHiResConsumer(&storage, pp);
+  TEST_NOT_EQUAL(ptr, null_ptr)
+}
+END_SECTION
+
+START_SECTION((~PeakPickerHiResConsumer()))
+{
+  delete ptr;
+}
+END_SECTION
+
+// input: profile spectra, one centroided spectrum and a chromatogram
+PeakMap input;
+for (Size i = 0; i < 7; ++i)
+{
+  input.addSpectrum(profileSpectrum(i, 2 + i % 3));
+}
+MSSpectrum centroided;
+centroided.setName("centroided");
+centroided.setType(SpectrumSettings::CENTROID);
+centroided.push_back(Peak1D(500.0, 10.0));
+input.addSpectrum(centroided);
+MSChromatogram chrom;
+for (Size i = 0; i < 100; ++i)
+{
+  chrom.push_back(ChromatogramPeak(i, 100.0 * std::exp(-(i - 50.0) * (i - 50.0) / 50.0)));
+}
+input.addChromatogram(chrom);
+
+START_SECTION((void consumeSpectrum(SpectrumType& s)))
+{
+  PeakMap expected;
+  pp.pickExperiment(input, expected);
+
+  for (Size batch_size : {Size(0), Size(1), Size(3)})
+  {
+    MSDataStoringConsumer store;
+    {
+      PeakPickerHiResConsumer consumer(&store, pp, batch_size);
+      consumer.setExpectedSize(input.size(), input.getNrChromatograms());
+      for (MSSpectrum s : input.getSpectra())
+      {
+        consumer.consumeSpectrum(s);
+      }
+      for (MSChromatogram c : input.getChromatograms())
+      {
+        consumer.consumeChromatogram(c);
+      }
+      // remaining data is passed on by the destructor
+    }
+    const PeakMap& result = store.getData();
+    TEST_EQUAL(result.size(), expected.size())
+    TEST_EQUAL(result.getNrChromatograms(), 1)
+    for (Size i = 0; i < expected.size(); ++i)
+    {
+      TEST_EQUAL(result[i].getName(), expected[i].getName())
+      TEST_EQUAL(result[i].getType(), expected[i].getType())
+      TEST_EQUAL(result[i].size(), expected[i].size())
+      ABORT_IF(result[i].size() != expected[i].size())
+      for (Size p = 0; p < expected[i].size(); ++p)
+      {
+        TEST_EQUAL(result[i][p] == expected[i][p], true)
+      }
+    }
+    TEST_EQUAL(result.getChromatograms()[0] == expected.getChromatograms()[0], true)
+  }
+  // picked peaks at the apex of each Gaussian; every 2nd one is left out in spectrum 0
+  TEST_EQUAL(expected[0].size(), 4)
+  TEST_REAL_SIMILAR(expected[0][0].getMZ(), 400.75)
+  TEST_EQUAL(expected[7].size(), 1) // centroided, copied
+}
+END_SECTION
+
+START_SECTION((void flush()))
+{
+  Param param = pp.getParameters();
+  param.setValue("ms_levels", ListUtils::create<Int>("2"));
+  pp.setParameters(param);
+
+  MSDataStoringConsumer store;
+  PeakPickerHiResConsumer consumer(&store, pp, 100);
+  for (Size i = 0; i < 3; ++i)
+  {
+    MSSpectrum s = input[i];
+    consumer.consumeSpectrum(s);
+  }
+  TEST_EQUAL(store.getData().size(), 0)
+  consumer.flush();
+  TEST_EQUAL(store.getData().size(), 3)
+  // only the MS2 spectrum (index 2) is picked
+  TEST_EQUAL(store.getData()[0].size(), input[0].size())
+  TEST_EQUAL(store.getData()[1].size(), input[1].size())
+  MSSpectrum picked;
+  pp.pick(input[2], picked);
+  TEST_EQUAL(store.getData()[2].size(), picked.size())
+  TEST_EQUAL(store.getData()[2].getType(), SpectrumSettings::CENTROID)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
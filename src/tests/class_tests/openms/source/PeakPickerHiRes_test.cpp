@@ -574,4 +574,43 @@ START_SECTION(void pick(const MSSpectrum& input, MSSpectrum& output, std::vector
 }
 END_SECTION
 
+START_SECTION(void pick(const ColumnarSpectrum& input, ColumnarSpectrum& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = true) const)
+{
+  // the columnar layout must give exactly the same result as MSSpectrum
+  PeakPickerHiRes pp;
+  Param p;
+  p.setValue("signal_to_noise", 1.0);
+  p.setValue("report_FWHM", "true");
+  pp.setParameters(p);
+
+  Size total_peaks = 0;
+  for (Size scan_idx = 0; scan_idx < input.size(); ++scan_idx)
+  {
+    MSSpectrum picked;
+    std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+    pp.pick(input[scan_idx], picked, boundaries);
+
+    ColumnarSpectrum picked_columnar;
+    std::vector<PeakPickerHiRes::PeakBoundary> boundaries_columnar;
+    pp.pick(ColumnarSpectrum(input[scan_idx]), picked_columnar, boundaries_columnar);
+
+    TEST_EQUAL(picked_columnar.size(), picked.size())
+    TEST_EQUAL(boundaries_columnar.size(), boundaries.size())
+    TEST_EQUAL(picked_columnar.getType(), SpectrumSettings::CENTROID)
+    TEST_REAL_SIMILAR(picked_columnar.getRT(), picked.getRT())
+    ABORT_IF(picked_columnar.size() != picked.size())
+    for (Size i = 0; i < picked.size(); ++i)
+    {
+      TEST_EQUAL(picked_columnar.getMZ(i), picked[i].getMZ())
+      TEST_EQUAL(picked_columnar.getIntensity(i), picked[i].getIntensity())
+      TEST_EQUAL(boundaries_columnar[i].mz_min, boundaries[i].mz_min)
+      TEST_EQUAL(boundaries_columnar[i].mz_max, boundaries[i].mz_max)
+    }
+    TEST_EQUAL(picked_columnar.getFloatDataArrays() == picked.getFloatDataArrays(), true)
+    total_peaks += picked.size();
+  }
+  TEST_EQUAL(total_peaks > 0, true)
+}
+END_SECTION
+
 END_TEST
@@ -0,0 +1,316 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(PeptideDatabase, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeptideDatabase* ptr = nullptr;
+PeptideDatabase* null_ptr = nullptr;
+
+vector<FASTAFile::FASTAEntry> proteins(2);
+proteins[0].identifier = "P1";
+proteins[0].sequence = "MPEPTIDEKCAAAR";
+proteins[1].identifier = "P2";
+proteins[1].sequence = "GGGGKMPEPTIDEKXAAAK";
+
+PeptideDatabase::Settings settings;
+settings.missed_cleavages = 0;
+settings.min_size = 4;
+settings.fixed_modifications = {"Carbamidomethyl (C)"};
+settings.variable_modifications = {"Oxidation (M)"};
+settings.max_variable_mods_per_peptide = 1;
+
+START_SECTION(PeptideDatabase())
+{
+  ptr = new PeptideDatabase();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_EQUAL(ptr->isMapped(), false)
+}
+END_SECTION
+
+START_SECTION(~PeptideDatabase())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(String Settings::toString() const)
+{
+  TEST_EQUAL(settings.toString(), "enzyme=Trypsin;missed_cleavages=0;min_size=4;max_size=40;fixed=Carbamidomethyl (C);variable=Oxidation (M);max_variable_mods_per_peptide=1")
+}
+END_SECTION
+
+START_SECTION((static String getCacheKey(const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings)))
+{
+  String key = PeptideDatabase::getCacheKey(proteins, settings);
+  TEST_EQUAL(key.hasPrefix(settings.toString() + ";proteins=2;hash="), true)
+  TEST_EQUAL(key, PeptideDatabase::getCacheKey(proteins, settings))
+
+  // key changes with the sequences and the settings
+  vector<FASTAFile::FASTAEntry> other_proteins = proteins;
+  other_proteins[1].sequence += "K";
+  TEST_NOT_EQUAL(key, PeptideDatabase::getCacheKey(other_proteins, settings))
+  PeptideDatabase::Settings other_settings = settings;
+  other_settings.missed_cleavages = 1;
+  TEST_NOT_EQUAL(key, PeptideDatabase::getCacheKey(proteins, other_settings))
+}
+END_SECTION
+
+START_SECTION((static String getCacheFilename(const String& cache_dir, const String& key)))
+{
+  String filename = PeptideDatabase::getCacheFilename("cache", "key");
+  TEST_EQUAL(filename.hasPrefix("cache/"), true)
+  TEST_EQUAL(filename.hasSuffix(".pepdb"), true)
+  TEST_EQUAL(filename.size(), String("cache/0123456789abcdef.pepdb").size())
+  TEST_NOT_EQUAL(filename, PeptideDatabase::getCacheFilename("cache", "other key"))
+}
+END_SECTION
+
+PeptideDatabase db;
+
+START_SECTION((void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings)))
+{
+  db.build(proteins, settings);
+  TEST_EQUAL(db.getKey(), PeptideDatabase::getCacheKey(proteins, settings))
+  TEST_EQUAL(db.isMapped(), false)
+  // GGGGK, CAAAR, MPEPTIDEK and M(Oxidation)PEPTIDEK (XAAAK is skipped)
+  TEST_EQUAL(db.size(), 4)
+  ABORT_IF(db.size() != 4)
+  TEST_EQUAL(db.getSequence(0).getString(), "GGGGK")
+  TEST_EQUAL(db.getSequence(1).getString(), "CAAAR")
+  TEST_EQUAL(db.getModifiedSequence(1).getString(), "C(Carbamidomethyl)AAAR")
+  TEST_EQUAL(db.getSequence(2).getString(), "MPEPTIDEK")
+  TEST_EQUAL(db.getModifiedSequence(2).getString(), "MPEPTIDEK")
+  TEST_EQUAL(db.getModificationIndex(2), 0)
+  TEST_EQUAL(db.getSequence(3).getString(), "MPEPTIDEK")
+  TEST_EQUAL(db.getModifiedSequence(3).getString(), "M(Oxidation)PEPTIDEK")
+  TEST_EQUAL(db.getModificationIndex(3), 1)
+  TEST_REAL_SIMILAR(db.getMass(2), AASequence::fromString("MPEPTIDEK").getMonoWeight())
+  TEST_REAL_SIMILAR(db.getMass(3), AASequence::fromString("M(Oxidation)PEPTIDEK").getMonoWeight())
+
+  TEST_EXCEPTION(Exception::ElementNotFound, PeptideDatabase().build(proteins, PeptideDatabase::Settings{"NoSuchEnzyme"}))
+}
+END_SECTION
+
+START_SECTION(const String& getKey() const)
+{
+  TEST_EQUAL(PeptideDatabase().getKey(), "")
+  TEST_EQUAL(db.getKey().hasPrefix("enzyme=Trypsin"), true)
+}
+END_SECTION
+
+START_SECTION(bool isMapped() const)
+{
+  NOT_TESTABLE // tested with load
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  TEST_EQUAL(db.size(), 4)
+}
+END_SECTION
+
+START_SECTION(bool empty() const)
+{
+  TEST_EQUAL(db.empty(), false)
+}
+END_SECTION
+
+START_SECTION(Size getNumberOfProteins() const)
+{
+  TEST_EQUAL(db.getNumberOfProteins(), 2)
+  TEST_EQUAL(PeptideDatabase().getNumberOfProteins(), 0)
+}
+END_SECTION
+
+START_SECTION(StringView getProteinAccession(Size protein_index) const)
+{
+  TEST_EQUAL(db.getProteinAccession(0).getString(), "P1")
+  TEST_EQUAL(db.getProteinAccession(1).getString(), "P2")
+}
+END_SECTION
+
+START_SECTION(double getMass(Size index) const)
+{
+  TEST_REAL_SIMILAR(db.getMass(0), AASequence::fromString("GGGGK").getMonoWeight())
+}
+END_SECTION
+
+START_SECTION(StringView getSequence(Size index) const)
+{
+  TEST_EQUAL(db.getSequence(0).getString(), "GGGGK")
+}
+END_SECTION
+
+START_SECTION(StringView getModifiedSequence(Size index) const)
+{
+  TEST_EQUAL(db.getModifiedSequence(0).getString(), "GGGGK")
+}
+END_SECTION
+
+START_SECTION(Size getModificationIndex(Size index) const)
+{
+  TEST_EQUAL(db.getModificationIndex(0), 0)
+}
+END_SECTION
+
+START_SECTION((std::pair<const UInt32*, const UInt32*> getProteinIndices(Size index) const))
+{
+  pair<const UInt32*, const UInt32*> p = db.getProteinIndices(0);
+  TEST_EQUAL(p.second - p.first, 1)
+  TEST_EQUAL(*p.first, 1)
+  p = db.getProteinIndices(1);
+  TEST_EQUAL(p.second - p.first, 1)
+  TEST_EQUAL(*p.first, 0)
+  p = db.getProteinIndices(3);
+  TEST_EQUAL(p.second - p.first, 2)
+  TEST_EQUAL(p.first[0], 0)
+  TEST_EQUAL(p.first[1], 1)
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getMassRange(double min_mass, double max_mass) const))
+{
+  pair<Size, Size> range = db.getMassRange(db.getMass(1), db.getMass(2));
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 3)
+  range = db.getMassRange(0.0, 1.0);
+  TEST_EQUAL(range.first, range.second)
+  range = db.getMassRange(0.0, 10000.0);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 4)
+}
+END_SECTION
+
+START_SECTION(void store(const String& filename) const)
+{
+  NOT_TESTABLE // tested with load
+}
+END_SECTION
+
+START_SECTION(void load(const String& filename))
+{
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+  db.store(tmp_file);
+
+  PeptideDatabase loaded;
+  loaded.load(tmp_file);
+  TEST_EQUAL(loaded.isMapped(), true)
+  TEST_EQUAL(loaded.getKey(), db.getKey())
+  TEST_EQUAL(loaded.size(), db.size())
+  TEST_EQUAL(loaded.getNumberOfProteins(), 2)
+  for (Size i = 0; i < loaded.size(); ++i)
+  {
+    TEST_EQUAL(loaded.getModifiedSequence(i).getString(), db.getModifiedSequence(i).getString())
+    TEST_REAL_SIMILAR(loaded.getMass(i), db.getMass(i))
+    TEST_EQUAL(loaded.getProteinIndices(i).second - loaded.getProteinIndices(i).first, db.getProteinIndices(i).second - db.getProteinIndices(i).first)
+  }
+  TEST_EQUAL(loaded.getProteinAccession(1).getString(), "P2")
+
+  // empty table
+  PeptideDatabase().store(tmp_file);
+  loaded.load(tmp_file);
+  TEST_EQUAL(loaded.size(), 0)
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("this_file_does_not_exist.pepdb"))
+
+  String invalid_file;
+  NEW_TMP_FILE(invalid_file)
+  {
+    ofstream ofs(invalid_file.c_str());
+    ofs << "not a peptide database";
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(invalid_file))
+
+  // truncated file
+  db.store(tmp_file);
+  {
+    ifstream ifs(tmp_file.c_str(), ios::binary);
+    string content((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+    ifs.close();
+    ofstream ofs(tmp_file.c_str(), ios::binary | ios::trunc);
+    ofs.write(content.data(), content.size() / 2);
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(tmp_file))
+}
+END_SECTION
+
+START_SECTION((bool loadOrBuild(const String& cache_dir, const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings)))
+{
+  String cache_dir = File::getTempDirectory() + "/" + File::getUniqueName() + "_pepdb_cache";
+
+  PeptideDatabase cached;
+  TEST_EQUAL(cached.loadOrBuild(cache_dir, proteins, settings), false) // built and stored
+  TEST_EQUAL(cached.size(), 4)
+  TEST_EQUAL(File::exists(PeptideDatabase::getCacheFilename(cache_dir, cached.getKey())), true)
+
+  TEST_EQUAL(cached.loadOrBuild(cache_dir, proteins, settings), true) // loaded from cache
+  TEST_EQUAL(cached.isMapped(), true)
+  TEST_EQUAL(cached.size(), 4)
+  TEST_EQUAL(cached.getModifiedSequence(3).getString(), "M(Oxidation)PEPTIDEK")
+
+  // different settings use a different table
+  PeptideDatabase::Settings other_settings = settings;
+  other_settings.variable_modifications.clear();
+  TEST_EQUAL(cached.loadOrBuild(cache_dir, proteins, other_settings), false)
+  TEST_EQUAL(cached.size(), 3)
+
+  File::removeDirRecursively(cache_dir);
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -369,6 +369,62 @@ START_SECTION((ExitCodes run(std::vector<FASTAFile::FASTAEntry>& proteins, std::
 }
 END_SECTION
 
+START_SECTION([EXTRA] suffix_array backend)
+{
+  std::vector<FASTAFile::FASTAEntry> proteins = toFASTAVec(QStringList() << "MKPEPTIDERXXXBEBEARAAAK" << "GGGKPEPTLDERKJJKTTK" << "KPEPTIDERK",
+                                                           QStringList() << "Protein1" << "Protein2" << "DECOY_Protein3");
+  QStringList peptides = QStringList() << "PEPTIDER" << "PEPTLDER" << "DDNEAR" << "LLK" << "IIK" << "TTTK" << "KPEPTIDER";
+
+  // run both backends with the same settings and compare the resulting peptide evidences
+  for (const String IL : {"false", "true"})
+  {
+    for (int aaa_max : {0, 3})
+    {
+      std::vector<std::vector<PeptideEvidence>> evidences[2];
+      for (int backend = 0; backend < 2; ++backend)
+      {
+        PeptideIndexing pi;
+        Param p = pi.getParameters();
+        p.setValue("backend", backend == 0 ? "aho_corasick" : "suffix_array");
+        p.setValue("decoy_string", "DECOY_");
+        p.setValue("aaa_max", aaa_max);
+        p.setValue("IL_equivalent", IL);
+        p.setValue("unmatched_action", "warn");
+        pi.setParameters(p);
+        std::vector<ProteinIdentification> prot_ids(1);
+        std::vector<PeptideIdentification> pep_ids = toPepVec(peptides);
+        TEST_EQUAL(pi.run(proteins, prot_ids, pep_ids), PeptideIndexing::EXECUTION_OK)
+        for (const auto& pep : pep_ids)
+        {
+          evidences[backend].push_back(pep.getHits()[0].getPeptideEvidences());
+        }
+      }
+      TEST_EQUAL(evidences[0] == evidences[1], true)
+    }
+  }
+
+  // the index is written to (and reused from) a file
+  String index_file;
+  NEW_TMP_FILE(index_file)
+  for (int run = 0; run < 2; ++run)
+  {
+    PeptideIndexing pi;
+    Param p = pi.getParameters();
+    p.setValue("backend", "suffix_array");
+    p.setValue("suffix_array_file", index_file);
+    p.setValue("decoy_string", "DECOY_");
+    p.setValue("unmatched_action", "warn");
+    pi.setParameters(p);
+    std::vector<ProteinIdentification> prot_ids(1);
+    std::vector<PeptideIdentification> pep_ids = toPepVec(QStringList() << "PEPTIDER");
+    TEST_EQUAL(pi.run(proteins, prot_ids, pep_ids), PeptideIndexing::EXECUTION_OK)
+    TEST_EQUAL(pep_ids[0].getHits()[0].getPeptideEvidences().size(), 2)
+    TEST_EQUAL(pep_ids[0].getHits()[0].getMetaValue("target_decoy"), "target+decoy")
+    TEST_EQUAL(prot_ids[0].getHits().size(), 2)
+  }
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,302 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/ProteinSuffixArray.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/ID/AhoCorasickAmbiguous.h>
+
+#include <fstream>
+#include <random>
+#include <set>
+#include <tuple>
+
+using namespace OpenMS;
+using namespace std;
+
+/// all matches of @p peptide as "protein:position" (for easy comparison)
+String matchString(const ProteinSuffixArray& index, const String& peptide, UInt32 max_aaa, UInt32 max_mm)
+{
+  vector<ProteinSuffixArray::Match> matches;
+  index.findAll(peptide, max_aaa, max_mm, matches);
+  String result;
+  for (const auto& m : matches)
+  {
+    result += String(m.protein) + ":" + String(m.position) + " ";
+  }
+  return result.trim();
+}
+
+START_TEST(ProteinSuffixArray, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ProteinSuffixArray* ptr = nullptr;
+ProteinSuffixArray* null_ptr = nullptr;
+
+StringList proteins = {"MPEPTIDEKCAAAR", "GGGGKMPEPTLDEK*XAAAK", "peptidebzj", "ACDEFPEPTIDE"};
+
+START_SECTION(ProteinSuffixArray())
+{
+  ptr = new ProteinSuffixArray();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->isILEquivalent(), false)
+  TEST_EQUAL(matchString(*ptr, "PEPTIDE", 3, 1), "")
+}
+END_SECTION
+
+START_SECTION(~ProteinSuffixArray())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((static String normalize(const String& protein, bool IL_equivalent)))
+{
+  TEST_EQUAL(ProteinSuffixArray::normalize("pep*TLJ", false), "PEPTLJ")
+  TEST_EQUAL(ProteinSuffixArray::normalize("pep*TLJ", true), "PEPTII")
+}
+END_SECTION
+
+START_SECTION((void build(const StringList& proteins, bool IL_equivalent)))
+{
+  ProteinSuffixArray index;
+  index.build(proteins, false);
+  TEST_EQUAL(index.size(), 4)
+  TEST_EQUAL(index.isILEquivalent(), false)
+  TEST_EQUAL(index.getSequence(1).getString(), "GGGGKMPEPTLDEKXAAAK")
+  TEST_EQUAL(index.getSequence(2).getString(), "PEPTIDEBZJ")
+
+  index.build(proteins, true);
+  TEST_EQUAL(index.size(), 4)
+  TEST_EQUAL(index.isILEquivalent(), true)
+  TEST_EQUAL(index.getSequence(1).getString(), "GGGGKMPEPTIDEKXAAAK")
+  TEST_EQUAL(index.getSequence(2).getString(), "PEPTIDEBZI")
+
+  index.build(StringList(), false);
+  TEST_EQUAL(index.size(), 0)
+  TEST_EQUAL(matchString(index, "PEPTIDE", 3, 1), "")
+}
+END_SECTION
+
+START_SECTION((bool isILEquivalent() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((StringView getSequence(Size index) const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void findAll(const String& peptide, UInt32 max_aaa, UInt32 max_mm, std::vector<Match>& matches) const))
+{
+  ProteinSuffixArray index;
+  index.build(proteins, false);
+  // exact matches
+  TEST_EQUAL(matchString(index, "PEPTIDE", 0, 0), "0:1 2:0 3:5")
+  TEST_EQUAL(matchString(index, "PEPTLDE", 0, 0), "1:6")
+  TEST_EQUAL(matchString(index, "GGGG", 0, 0), "1:0")
+  TEST_EQUAL(matchString(index, "GGGGG", 0, 0), "")
+  TEST_EQUAL(matchString(index, "AAAR", 0, 0), "0:10")
+  TEST_EQUAL(matchString(index, "", 0, 0), "")
+  // matches do not span proteins
+  TEST_EQUAL(matchString(index, "AAARGGGG", 3, 0), "")
+  // stop codons are removed, ambiguous amino acids in the protein
+  TEST_EQUAL(matchString(index, "DEKHAAAK", 0, 0), "")
+  TEST_EQUAL(matchString(index, "DEKHAAAK", 1, 0), "1:11")
+  TEST_EQUAL(matchString(index, "DEKXAAAK", 0, 0), "1:11")
+  TEST_EQUAL(matchString(index, "PEPTIDEDEL", 1, 0), "")
+  TEST_EQUAL(matchString(index, "PEPTIDEDEL", 3, 0), "2:0")
+  TEST_EQUAL(matchString(index, "PEPTIDENQI", 3, 0), "2:0")
+  // mismatches (in addition to ambiguous amino acids)
+  TEST_EQUAL(matchString(index, "PEPTIDEDEL", 2, 1), "2:0")
+  TEST_EQUAL(matchString(index, "PEPTIDEDEL", 0, 2), "")
+  TEST_EQUAL(matchString(index, "PEPTIDEDEL", 0, 3), "0:1 2:0")
+  TEST_EQUAL(matchString(index, "PEPTLDE", 0, 1), "0:1 1:6 2:0 3:5")
+  TEST_EQUAL(matchString(index, "PAPTLDE", 0, 1), "1:6")
+  TEST_EQUAL(matchString(index, "PAPTLDE", 0, 2), "0:1 1:6 2:0 3:5")
+
+  // I/L equivalence
+  index.build(proteins, true);
+  TEST_EQUAL(matchString(index, "PEPTIDE", 0, 0), "0:1 1:6 2:0 3:5")
+  TEST_EQUAL(matchString(index, "PEPTLDE", 0, 0), "0:1 1:6 2:0 3:5")
+  TEST_EQUAL(matchString(index, "PEPTIDEDEL", 2, 0), "2:0") // 'J' is no longer ambiguous
+}
+END_SECTION
+
+START_SECTION((bool isIndexOf(const StringList& proteins, bool IL_equivalent) const))
+{
+  ProteinSuffixArray index;
+  index.build(proteins, false);
+  TEST_EQUAL(index.isIndexOf(proteins, false), true)
+  TEST_EQUAL(index.isIndexOf(proteins, true), false)
+  StringList other = proteins;
+  other[3] += "K";
+  TEST_EQUAL(index.isIndexOf(other, false), false)
+  other = proteins;
+  other.pop_back();
+  TEST_EQUAL(index.isIndexOf(other, false), false)
+  other = proteins;
+  other[0] = "mpep*tidekcaaar"; // identical after normalization
+  TEST_EQUAL(index.isIndexOf(other, false), true)
+}
+END_SECTION
+
+START_SECTION((void store(const String& filename) const))
+{
+  NOT_TESTABLE // tested below
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+{
+  ProteinSuffixArray index;
+  index.build(proteins, true);
+  String filename;
+  NEW_TMP_FILE(filename)
+  index.store(filename);
+
+  ProteinSuffixArray loaded;
+  loaded.load(filename);
+  TEST_EQUAL(loaded.size(), 4)
+  TEST_EQUAL(loaded.isILEquivalent(), true)
+  TEST_EQUAL(loaded.isIndexOf(proteins, true), true)
+  TEST_EQUAL(loaded.getSequence(3).getString(), "ACDEFPEPTIDE")
+  TEST_EQUAL(matchString(loaded, "PEPTLDE", 0, 0), "0:1 1:6 2:0 3:5")
+  TEST_EQUAL(matchString(loaded, "DEKHAAAK", 1, 0), "1:11")
+
+  // moving keeps the mapping alive
+  ProteinSuffixArray moved(std::move(loaded));
+  TEST_EQUAL(matchString(moved, "PEPTLDE", 0, 0), "0:1 1:6 2:0 3:5")
+
+  // errors
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load(OPENMS_GET_TEST_DATA_PATH("this_file_does_not_exist.psa")))
+  String not_an_index;
+  NEW_TMP_FILE(not_an_index)
+  {
+    ofstream ofs(not_an_index.c_str());
+    ofs << "definitely not a protein index";
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(not_an_index))
+}
+END_SECTION
+
+START_SECTION([EXTRA] same matches as ACTrie)
+{
+  // random proteins with some ambiguous amino acids; peptides taken from the proteins (and mutated)
+  mt19937 rng(42);
+  const String residues = "ACDEFGHIKLMNPQRSTVWY";
+  const String ambiguous = "BJZX";
+  StringList db;
+  for (Size i = 0; i < 50; ++i)
+  {
+    String prot;
+    const Size length = 20 + rng() % 200;
+    for (Size k = 0; k < length; ++k)
+    {
+      prot += (rng() % 25 == 0) ? ambiguous[rng() % ambiguous.size()] : residues[rng() % residues.size()];
+    }
+    db.push_back(prot);
+  }
+  StringList peptides;
+  for (Size i = 0; i < 300; ++i)
+  {
+    const String& prot = db[rng() % db.size()];
+    const Size length = 4 + rng() % 8;
+    String pep = prot.substr(rng() % (prot.size() - length), length);
+    for (char& c : pep)
+    {
+      if (ambiguous.has(c) || rng() % 20 == 0)
+      {
+        c = residues[rng() % residues.size()];
+      }
+    }
+    peptides.push_back(pep);
+  }
+
+  ProteinSuffixArray index;
+  index.build(db, false);
+  for (UInt32 max_aaa : {0u, 1u, 3u})
+  {
+    for (UInt32 max_mm : {0u, 1u, 2u})
+    {
+      ACTrie trie(max_aaa, max_mm);
+      trie.addNeedles(vector<string>(peptides.begin(), peptides.end()));
+      trie.compressTrie();
+      set<tuple<UInt32, UInt32, UInt32>> expected; // peptide, protein, position
+      ACTrieState state;
+      for (Size p = 0; p < db.size(); ++p)
+      {
+        state.setQuery(db[p]);
+        trie.getAllHits(state);
+        for (const auto& hit : state.hits)
+        {
+          expected.emplace(hit.needle_index, UInt32(p), hit.query_pos);
+        }
+      }
+      set<tuple<UInt32, UInt32, UInt32>> found;
+      vector<ProteinSuffixArray::Match> matches;
+      for (Size i = 0; i < peptides.size(); ++i)
+      {
+        index.findAll(peptides[i], max_aaa, max_mm, matches);
+        for (const auto& m : matches)
+        {
+          found.emplace(UInt32(i), m.protein, m.position);
+        }
+      }
+      TEST_EQUAL(found.size(), expected.size())
+      TEST_EQUAL(found == expected, true)
+    }
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
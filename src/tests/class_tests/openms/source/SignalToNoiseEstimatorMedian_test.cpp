@@ -35,6 +35,7 @@
 #include <OpenMS/CONCEPT/ClassTest.h>
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/DTAFile.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 
 ///////////////////////////
 #include <OpenMS/FILTERING/NOISEESTIMATION/SignalToNoiseEstimatorMedian.h>
@@ -115,6 +116,33 @@ START_SECTION([EXTRA](virtual void init(const Container& c)))
 END_SECTION
 
 
+START_SECTION([EXTRA](virtual void init(const ColumnarSpectrum& c)))
+{
+  MSSpectrum raw_data;
+  DTAFile dta_file;
+  dta_file.load(OPENMS_GET_TEST_DATA_PATH("SignalToNoiseEstimator_test.dta"), raw_data);
+
+  Param p;
+  p.setValue("win_len", 40.0);
+  p.setValue("noise_for_empty_window", 2.0);
+  p.setValue("min_required_elements", 10);
+
+  SignalToNoiseEstimatorMedian< MSSpectrum > sne;
+  sne.setParameters(p);
+  sne.init(raw_data);
+
+  SignalToNoiseEstimatorMedian< ColumnarSpectrum > sne_columnar;
+  sne_columnar.setParameters(p);
+  sne_columnar.init(ColumnarSpectrum(raw_data));
+
+  for (Size i = 0; i < raw_data.size(); ++i)
+  {
+    TEST_EQUAL(sne_columnar.getSignalToNoise(i), sne.getSignalToNoise(i))
+  }
+}
+END_SECTION
+
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
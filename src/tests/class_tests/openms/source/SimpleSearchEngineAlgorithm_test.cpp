@@ -33,14 +33,62 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
 
 ///////////////////////////
 #include <OpenMS/ANALYSIS/ID/SimpleSearchEngineAlgorithm.h>
 ///////////////////////////
 
+#include <OpenMS/SYSTEM/File.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
+// default parameters with the tolerances used for the SimpleSearchEngine TOPP test data
+Param searchParameters()
+{
+  Param p = SimpleSearchEngineAlgorithm().getParameters();
+  p.setValue("precursor:mass_tolerance", 5.0);
+  p.setValue("fragment:mass_tolerance", 0.3);
+  p.setValue("fragment:mass_tolerance_unit", "Da");
+  return p;
+}
+
+// searches the SimpleSearchEngine TOPP test data with parameters @p p
+vector<PeptideIdentification> search(const Param& p, vector<ProteinIdentification>& prot_ids)
+{
+  SimpleSearchEngineAlgorithm sse;
+  sse.setParameters(p);
+  sse.setLogType(ProgressLogger::NONE);
+  vector<PeptideIdentification> pep_ids;
+  prot_ids.clear();
+  TEST_EQUAL(sse.search(OPENMS_GET_TEST_DATA_PATH("../../../topp/SimpleSearchEngine_1.mzML"), OPENMS_GET_TEST_DATA_PATH("../../../topp/SimpleSearchEngine_1.fasta"),
+    prot_ids, pep_ids) == SimpleSearchEngineAlgorithm::ExitCodes::EXECUTION_OK, true)
+  return pep_ids;
+}
+
+// compares sequences and scores of all hits
+void compareHits(const vector<PeptideIdentification>& pep_ids, const vector<PeptideIdentification>& reference)
+{
+  TEST_NOT_EQUAL(reference.size(), 0)
+  TEST_EQUAL(pep_ids.size(), reference.size())
+  for (Size i = 0; i < std::min(pep_ids.size(), reference.size()); ++i)
+  {
+    const vector<PeptideHit>& hits = pep_ids[i].getHits();
+    const vector<PeptideHit>& ref_hits = reference[i].getHits();
+    TEST_EQUAL(hits.size(), ref_hits.size())
+    for (Size j = 0; j < std::min(hits.size(), ref_hits.size()); ++j)
+    {
+      TEST_EQUAL(hits[j].getSequence(), ref_hits[j].getSequence())
+      TEST_REAL_SIMILAR(hits[j].getScore(), ref_hits[j].getScore())
+    }
+  }
+}
+
 START_TEST(SimpleSearchEngineAlgorithm, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -68,6 +116,60 @@ START_SECTION((ExitCodes search(const String &in_mzML, const String &in_db, std:
 }
 END_SECTION
 
+START_SECTION(([EXTRA] serial and parallel search yield identical hits))
+{
+  // hits are collected per thread and merged at the end: the results must not depend on the number of threads
+  Param p = searchParameters();
+  p.setValue("decoys", "true");
+  p.setValue("report:top_hits", 5);
+
+  vector<ProteinIdentification> prot_ids;
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  const vector<PeptideIdentification> reference = search(p, prot_ids);
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+  compareHits(search(p, prot_ids), reference);
+}
+END_SECTION
+
+START_SECTION(([EXTRA] peptide database search yields the hits of the digest search))
+{
+  // candidates of the peptide database are rebuilt from their modified sequences without parsing them with AASequence::fromString()
+  Param p = searchParameters();
+  p.setValue("modifications:variable", std::vector<std::string>{"Oxidation (M)", "Acetyl (N-term)"});
+  p.setValue("report:top_hits", 5);
+
+  vector<ProteinIdentification> prot_ids;
+  const vector<PeptideIdentification> reference = search(p, prot_ids);
+
+  const String cache_dir = File::getTempDirectory() + "/" + File::getUniqueName() + "_sse_pepdb_cache";
+  p.setValue("peptide_db:cache_dir", cache_dir);
+  const vector<PeptideIdentification> pep_ids = search(p, prot_ids);
+  File::removeDirRecursively(cache_dir);
+  compareHits(pep_ids, reference);
+}
+END_SECTION
+
+START_SECTION(([EXTRA] semi-specific fragment index search))
+{
+  Param p = searchParameters();
+  p.setValue("fragment_index:enabled", "true");
+
+  vector<ProteinIdentification> prot_ids;
+  const vector<PeptideIdentification> specific = search(p, prot_ids);
+  TEST_EQUAL(prot_ids[0].getSearchParameters().enzyme_term_specificity, EnzymaticDigestion::SPEC_FULL)
+
+  // the semi-specific peptides include all fully specific ones: every spectrum identified before is identified again
+  p.setValue("fragment_index:semi_specific", "true");
+  const vector<PeptideIdentification> semi_specific = search(p, prot_ids);
+  TEST_EQUAL(prot_ids[0].getSearchParameters().enzyme_term_specificity, EnzymaticDigestion::SPEC_SEMI)
+  TEST_EQUAL(semi_specific.size() >= specific.size(), true)
+}
+END_SECTION
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
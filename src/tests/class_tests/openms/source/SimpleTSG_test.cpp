@@ -0,0 +1,217 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/SimpleTSG.h>
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+START_TEST(SimpleTSG, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+SimpleTSG* ptr = nullptr;
+SimpleTSG* nullPointer = nullptr;
+
+START_SECTION(SimpleTSG())
+  ptr = new SimpleTSG();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+END_SECTION
+
+START_SECTION(SimpleTSG(const SimpleTSG& source))
+  SimpleTSG copy(*ptr);
+  TEST_EQUAL(copy.getParameters(), ptr->getParameters())
+END_SECTION
+
+START_SECTION(~SimpleTSG())
+  delete ptr;
+END_SECTION
+
+ptr = new SimpleTSG();
+
+START_SECTION(SimpleTSG& operator=(const SimpleTSG& source))
+  SimpleTSG copy;
+  Param p = copy.getParameters();
+  p.setValue("add_a_ions", "true");
+  copy.setParameters(p);
+  copy = *ptr;
+  TEST_EQUAL(copy.getParameters(), ptr->getParameters())
+END_SECTION
+
+// compares the fast path against the full generator for the same parameters
+auto compareToTSG = [](SimpleTSG& simple_tsg, const AASequence& peptide, Int min_charge, Int max_charge)
+{
+  TheoreticalSpectrumGenerator tsg;
+  Param p = simple_tsg.getParameters();
+  p.setValue("add_metainfo", "true");
+  tsg.setParameters(p);
+  PeakSpectrum spec;
+  tsg.getSpectrum(spec, peptide, min_charge, max_charge);
+
+  vector<SimpleTSG::Fragment> fragments;
+  simple_tsg.getSpectrum(fragments, peptide, min_charge, max_charge);
+  vector<double> mzs;
+  simple_tsg.getSpectrum(mzs, peptide, min_charge, max_charge);
+
+  TEST_EQUAL(fragments.size(), spec.size())
+  TEST_EQUAL(mzs.size(), spec.size())
+  if (fragments.size() != spec.size() || mzs.size() != spec.size()) return;
+  for (Size i = 0; i != spec.size(); ++i)
+  {
+    // bit-identical m/z values, not only similar ones
+    TEST_EQUAL(fragments[i].mz, spec[i].getMZ())
+    TEST_EQUAL(mzs[i], spec[i].getMZ())
+    TEST_EQUAL(fragments[i].intensity, spec[i].getIntensity())
+    TEST_EQUAL(fragments[i].charge, spec.getIntegerDataArrays()[0][i])
+    TEST_EQUAL(fragments[i].ion_type, spec.getStringDataArrays()[0][i][0])
+  }
+};
+
+START_SECTION((void getSpectrum(std::vector<Fragment>& fragments, const AASequence& peptide, Int min_charge, Int max_charge)))
+{
+  AASequence peptide = AASequence::fromString("IFSQVGK");
+
+  // default: b- and y-ions
+  compareToTSG(*ptr, peptide, 1, 1);
+  compareToTSG(*ptr, peptide, 1, 3);
+
+  vector<SimpleTSG::Fragment> fragments;
+  ptr->getSpectrum(fragments, peptide, 1, 1);
+  TEST_EQUAL(fragments.size(), 11)
+  TEST_REAL_SIMILAR(fragments[0].mz, 147.112804)
+  TEST_EQUAL(fragments[0].ion_type, 'y')
+  TEST_REAL_SIMILAR(fragments[1].mz, 204.134267)
+  TEST_EQUAL(fragments[1].ion_type, 'y')
+  TEST_REAL_SIMILAR(fragments[2].mz, 261.159755)
+  TEST_EQUAL(fragments[2].ion_type, 'b')
+
+  // all ion types, first prefix ion and modified variants
+  SimpleTSG all;
+  Param p = all.getParameters();
+  p.setValue("add_first_prefix_ion", "true");
+  p.setValue("add_a_ions", "true");
+  p.setValue("add_c_ions", "true");
+  p.setValue("add_x_ions", "true");
+  p.setValue("add_z_ions", "true");
+  p.setValue("b_intensity", 0.5);
+  p.setValue("x_intensity", 0.25);
+  all.setParameters(p);
+  compareToTSG(all, peptide, 1, 3);
+  compareToTSG(all, AASequence::fromString(".(Acetyl)PEPM(Oxidation)TIDEK.(Amidated)"), 1, 2);
+  compareToTSG(all, AASequence::fromString("C(Carbamidomethyl)PEPTIDER"), 2, 2);
+  compareToTSG(all, AASequence::fromString("AR"), 1, 2);
+
+  // an empty peptide yields no fragments
+  all.getSpectrum(fragments, AASequence(), 1, 2);
+  TEST_EQUAL(fragments.size(), 0)
+
+  // c- and x-ions need at least two residues
+  TEST_EXCEPTION(Exception::InvalidSize, all.getSpectrum(fragments, AASequence::fromString("A"), 1, 1))
+}
+END_SECTION
+
+START_SECTION((void getSpectrum(std::vector<double>& mzs, const AASequence& peptide, Int min_charge, Int max_charge)))
+{
+  vector<double> mzs;
+  ptr->getSpectrum(mzs, AASequence::fromString("IFSQVGK"), 1, 2);
+  TEST_EQUAL(mzs.size(), 22)
+  TEST_EQUAL(is_sorted(mzs.begin(), mzs.end()), true)
+
+  // results are written into the caller-owned buffer, replacing previous content
+  ptr->getSpectrum(mzs, AASequence::fromString("AR"), 1, 1);
+  TEST_EQUAL(mzs.size(), 2)
+}
+END_SECTION
+
+START_SECTION((Size getComputedResidueMasses() const))
+{
+  SimpleTSG tsg;
+  vector<double> mzs;
+
+  // first peptide: prefix and suffix ladder computed completely
+  tsg.getSpectrum(mzs, AASequence::fromString("PEPTIDEK"), 1, 1);
+  TEST_EQUAL(tsg.getComputedResidueMasses(), 16)
+
+  // shared prefix "PEPTIDE": only one prefix residue but the full suffix ladder is recomputed
+  tsg.getSpectrum(mzs, AASequence::fromString("PEPTIDER"), 1, 1);
+  TEST_EQUAL(tsg.getComputedResidueMasses(), 9)
+  compareToTSG(tsg, AASequence::fromString("PEPTIDER"), 1, 1);
+
+  // same peptide again: nothing to compute
+  tsg.getSpectrum(mzs, AASequence::fromString("PEPTIDER"), 1, 1);
+  TEST_EQUAL(tsg.getComputedResidueMasses(), 0)
+
+  // shared suffix "R": the suffix ladder is partially reused
+  tsg.getSpectrum(mzs, AASequence::fromString("SAMPLER"), 1, 1);
+  TEST_EQUAL(tsg.getComputedResidueMasses(), 7 + 5)
+  compareToTSG(tsg, AASequence::fromString("SAMPLER"), 1, 1);
+
+  // a modification breaks the shared prefix at the modified residue
+  tsg.getSpectrum(mzs, AASequence::fromString("SAM(Oxidation)PLER"), 1, 1);
+  TEST_EQUAL(tsg.getComputedResidueMasses(), 5 + 3)
+  compareToTSG(tsg, AASequence::fromString("SAM(Oxidation)PLER"), 1, 1);
+
+  // an N-terminal modification invalidates the prefix ladder
+  tsg.getSpectrum(mzs, AASequence::fromString(".(Acetyl)SAM(Oxidation)PLER"), 1, 1);
+  TEST_EQUAL(tsg.getComputedResidueMasses(), 7)
+  compareToTSG(tsg, AASequence::fromString(".(Acetyl)SAM(Oxidation)PLER"), 1, 1);
+
+  // a different charge range invalidates both ladders
+  tsg.getSpectrum(mzs, AASequence::fromString(".(Acetyl)SAM(Oxidation)PLER"), 1, 2);
+  TEST_EQUAL(tsg.getComputedResidueMasses(), 28)
+  compareToTSG(tsg, AASequence::fromString(".(Acetyl)SAM(Oxidation)PLER"), 1, 2);
+
+  // cached results equal those of a fresh generator
+  SimpleTSG fresh;
+  vector<double> fresh_mzs;
+  tsg.getSpectrum(mzs, AASequence::fromString("SAMPLEK"), 1, 2);
+  fresh.getSpectrum(fresh_mzs, AASequence::fromString("SAMPLEK"), 1, 2);
+  TEST_EQUAL(mzs == fresh_mzs, true)
+}
+END_SECTION
+
+delete ptr;
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,224 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMapped.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+#include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+#include <algorithm>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumAccessOpenMSCachedMapped, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeakMap exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+std::string tmpf;
+NEW_TMP_FILE(tmpf);
+CachedmzML::store(tmpf, exp);
+
+SpectrumAccessOpenMSCachedMapped* ptr = nullptr;
+SpectrumAccessOpenMSCachedMapped* nullPointer = nullptr;
+
+START_SECTION(explicit SpectrumAccessOpenMSCachedMapped(const String& filename))
+{
+  ptr = new SpectrumAccessOpenMSCachedMapped(tmpf);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessOpenMSCachedMapped())
+{
+  delete ptr;
+}
+END_SECTION
+
+SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+SpectrumAccessOpenMSCached cached(tmpf);
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  TEST_EQUAL(mapped.getNrSpectra(), 4)
+}
+END_SECTION
+
+START_SECTION(size_t getNrChromatograms() const)
+{
+  TEST_EQUAL(mapped.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  // identical to the stream-based implementation
+  for (int i = 0; i < 4; ++i)
+  {
+    OpenSwath::SpectrumPtr s1 = mapped.getSpectrumById(i);
+    OpenSwath::SpectrumPtr s2 = cached.getSpectrumById(i);
+    TEST_EQUAL(s1->getDataArrays().size(), s2->getDataArrays().size())
+    for (Size k = 0; k < s1->getDataArrays().size(); ++k)
+    {
+      TEST_EQUAL(s1->getDataArrays()[k]->data == s2->getDataArrays()[k]->data, true)
+      TEST_EQUAL(s1->getDataArrays()[k]->description, s2->getDataArrays()[k]->description)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::ChromatogramPtr getChromatogramById(int id))
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    OpenSwath::ChromatogramPtr c1 = mapped.getChromatogramById(i);
+    OpenSwath::ChromatogramPtr c2 = cached.getChromatogramById(i);
+    TEST_EQUAL(c1->getDataArrays().size(), c2->getDataArrays().size())
+    TEST_EQUAL(c1->getTimeArray()->data == c2->getTimeArray()->data, true)
+    TEST_EQUAL(c1->getIntensityArray()->data == c2->getIntensityArray()->data, true)
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    TEST_REAL_SIMILAR(mapped.getSpectrumMetaById(i).RT, exp[i].getRT())
+    TEST_EQUAL(mapped.getSpectrumMetaById(i).ms_level, exp[i].getMSLevel())
+  }
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  TEST_EQUAL(mapped.getSpectraByRT(exp[1].getRT(), 0.1) == cached.getSpectraByRT(exp[1].getRT(), 0.1), true)
+  TEST_EQUAL(mapped.getSpectraByRT(exp[0].getRT(), 100.0) == cached.getSpectraByRT(exp[0].getRT(), 100.0), true)
+  TEST_EQUAL(mapped.getSpectraByRT(1e6, 1.0).empty(), true)
+}
+END_SECTION
+
+START_SECTION(SpectrumSettings getSpectraMetaInfo(int id) const)
+{
+  TEST_EQUAL(mapped.getSpectraMetaInfo(2) == cached.getSpectraMetaInfo(2), true)
+}
+END_SECTION
+
+START_SECTION(ChromatogramSettings getChromatogramMetaInfo(int id) const)
+{
+  TEST_EQUAL(mapped.getChromatogramMetaInfo(1) == cached.getChromatogramMetaInfo(1), true)
+}
+END_SECTION
+
+START_SECTION(std::string getChromatogramNativeID(int id) const)
+{
+  TEST_EQUAL(mapped.getChromatogramNativeID(0), exp.getChromatograms()[0].getNativeID())
+  TEST_EQUAL(mapped.getChromatogramNativeID(1), exp.getChromatograms()[1].getNativeID())
+}
+END_SECTION
+
+START_SECTION(SpectrumView getSpectrumViewById(int id) const)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    MappedCachedMzML::SpectrumView view = mapped.getSpectrumViewById(i);
+    OpenSwath::SpectrumPtr s = cached.getSpectrumById(i);
+    TEST_EQUAL(view.mz.size(), s->getMZArray()->data.size())
+    TEST_EQUAL(std::equal(view.mz.begin(), view.mz.end(), s->getMZArray()->data.begin()), true)
+    TEST_EQUAL(std::equal(view.intensity.begin(), view.intensity.end(), s->getIntensityArray()->data.begin()), true)
+    TEST_EQUAL(view.extra_arrays.size() + 2, s->getDataArrays().size())
+  }
+}
+END_SECTION
+
+START_SECTION(ChromatogramView getChromatogramViewById(int id) const)
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    MappedCachedMzML::ChromatogramView view = mapped.getChromatogramViewById(i);
+    OpenSwath::ChromatogramPtr c = cached.getChromatogramById(i);
+    TEST_EQUAL(view.rt.size(), c->getTimeArray()->data.size())
+    TEST_EQUAL(std::equal(view.rt.begin(), view.rt.end(), c->getTimeArray()->data.begin()), true)
+    TEST_EQUAL(std::equal(view.intensity.begin(), view.intensity.end(), c->getIntensityArray()->data.begin()), true)
+  }
+}
+END_SECTION
+
+START_SECTION(SpectrumAccessOpenMSCachedMapped(const SpectrumAccessOpenMSCachedMapped & rhs))
+{
+  SpectrumAccessOpenMSCachedMapped copy(mapped);
+  TEST_EQUAL(copy.getNrSpectra(), 4)
+  TEST_EQUAL(copy.getSpectrumViewById(0).mz.data() == mapped.getSpectrumViewById(0).mz.data(), true)
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone = mapped.lightClone();
+  TEST_EQUAL(clone->getNrSpectra(), 4)
+  TEST_EQUAL(clone->getNrChromatograms(), 2)
+  TEST_EQUAL(clone->getSpectrumById(3)->getMZArray()->data == mapped.getSpectrumById(3)->getMZArray()->data, true)
+}
+END_SECTION
+
+START_SECTION([EXTRA] concurrent access)
+{
+  // all accessors are const and can be used from multiple threads without cloning
+  std::vector<Size> sizes(40, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize i = 0; i < (SignedSize)sizes.size(); ++i)
+  {
+    sizes[i] = mapped.getSpectrumViewById(i % 4).mz.size();
+  }
+  for (Size i = 0; i < sizes.size(); ++i)
+  {
+    TEST_EQUAL(sizes[i], exp[i % 4].size())
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
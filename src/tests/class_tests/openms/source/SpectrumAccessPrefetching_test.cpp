@@ -0,0 +1,201 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessPrefetching.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+boost::shared_ptr<PeakMap > getData()
+{
+  boost::shared_ptr<PeakMap > exp(new PeakMap);
+  for (int i = 0; i < 100; ++i)
+  {
+    MSSpectrum spec;
+    spec.setRT(10.0 * i);
+    spec.push_back(Peak1D(100 + i, 50 + i));
+    spec.push_back(Peak1D(500 + i, 150 + i));
+    exp->addSpectrum(spec);
+  }
+  return exp;
+}
+
+Size nrAccesses(const SpectrumAccessPrefetching::StatisticsPtr& s)
+{
+  return s->hits + s->late_hits + s->misses;
+}
+
+START_TEST(SpectrumAccessPrefetching, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectrumAccessPrefetching* ptr = nullptr;
+SpectrumAccessPrefetching* nullPointer = nullptr;
+
+boost::shared_ptr<PeakMap > exp = getData();
+OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+START_SECTION((SpectrumAccessPrefetching(OpenSwath::SpectrumAccessPtr sptr, Size cache_size = 128, Size read_ahead = 32, StatisticsPtr statistics = StatisticsPtr())))
+{
+  ptr = new SpectrumAccessPrefetching(expptr);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(bool(ptr->getStatistics()), true)
+  TEST_EQUAL(nrAccesses(ptr->getStatistics()), 0)
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessPrefetching())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  SpectrumAccessPrefetching prefetching(expptr);
+  TEST_EQUAL(prefetching.getNrSpectra(), 100)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  // sequential access as done by the chromatogram extraction (small cache to test eviction)
+  SpectrumAccessPrefetching prefetching(expptr, 16, 8);
+  for (int i = 0; i < 100; ++i)
+  {
+    OpenSwath::SpectrumPtr spec = prefetching.getSpectrumById(i);
+    TEST_EQUAL(spec->getMZArray()->data.size(), 2)
+    TEST_REAL_SIMILAR(spec->getMZArray()->data[0], 100 + i)
+    TEST_REAL_SIMILAR(spec->getIntensityArray()->data[1], 150 + i)
+  }
+  TEST_EQUAL(nrAccesses(prefetching.getStatistics()), 100)
+  TEST_EQUAL(prefetching.getStatistics()->prefetched <= 99, true)
+
+  // recently used spectra are served from the cache
+  Size hits = prefetching.getStatistics()->hits;
+  OpenSwath::SpectrumPtr spec = prefetching.getSpectrumById(99);
+  TEST_REAL_SIMILAR(spec->getMZArray()->data[0], 199)
+  TEST_EQUAL(prefetching.getStatistics()->hits, hits + 1)
+
+  // random access
+  for (int i : {50, 3, 97, 3, 42, 0})
+  {
+    spec = prefetching.getSpectrumById(i);
+    TEST_REAL_SIMILAR(spec->getMZArray()->data[0], 100 + i)
+  }
+  TEST_EQUAL(nrAccesses(prefetching.getStatistics()), 107)
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  SpectrumAccessPrefetching prefetching(expptr);
+  std::vector<std::size_t> ids = prefetching.getSpectraByRT(500.0, 25.0);
+  TEST_EQUAL(ids == expptr->getSpectraByRT(500.0, 25.0), true)
+  TEST_EQUAL(ids.size(), 5)
+  for (std::size_t id : ids)
+  {
+    OpenSwath::SpectrumPtr spec = prefetching.getSpectrumById(int(id));
+    TEST_REAL_SIMILAR(spec->getMZArray()->data[0], 100 + id)
+  }
+  TEST_EQUAL(nrAccesses(prefetching.getStatistics()), 5)
+}
+END_SECTION
+
+START_SECTION(void prefetch(const std::vector<std::size_t>& ids) const)
+{
+  SpectrumAccessPrefetching prefetching(expptr);
+  std::vector<std::size_t> ids = {10, 20, 30, 30, 40};
+  prefetching.prefetch(ids);
+  for (std::size_t id : ids)
+  {
+    OpenSwath::SpectrumPtr spec = prefetching.getSpectrumById(int(id));
+    TEST_REAL_SIMILAR(spec->getMZArray()->data[0], 100 + id)
+  }
+  TEST_EQUAL(nrAccesses(prefetching.getStatistics()), 5)
+  // the second access to 30 is always served from the cache
+  TEST_EQUAL(prefetching.getStatistics()->hits + prefetching.getStatistics()->late_hits >= 1, true)
+  TEST_EQUAL(prefetching.getStatistics()->prefetched <= 4, true)
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  SpectrumAccessPrefetching prefetching(expptr);
+  prefetching.getSpectrumById(0);
+  OpenSwath::SpectrumAccessPtr clone = prefetching.lightClone();
+  TEST_EQUAL(clone->getNrSpectra(), 100)
+
+  // clones are used concurrently and share the statistics
+  std::vector<OpenSwath::SpectrumAccessPtr> clones;
+  for (int t = 0; t < 4; ++t)
+  {
+    clones.push_back(prefetching.lightClone());
+  }
+  Size errors = 0;
+#pragma omp parallel for reduction(+: errors)
+  for (int t = 0; t < 4; ++t)
+  {
+    for (int i = 0; i < 100; ++i)
+    {
+      OpenSwath::SpectrumPtr spec = clones[t]->getSpectrumById(i);
+      if (spec->getMZArray()->data[0] != 100 + i) ++errors;
+    }
+  }
+  TEST_EQUAL(errors, 0)
+  TEST_EQUAL(nrAccesses(prefetching.getStatistics()), 401)
+}
+END_SECTION
+
+START_SECTION(const StatisticsPtr& getStatistics() const)
+{
+  SpectrumAccessPrefetching::StatisticsPtr statistics(new SpectrumAccessPrefetching::Statistics);
+  SpectrumAccessPrefetching prefetching(expptr, 128, 32, statistics);
+  TEST_EQUAL(prefetching.getStatistics() == statistics, true)
+  prefetching.getSpectrumById(1);
+  TEST_EQUAL(statistics->misses + statistics->late_hits + statistics->hits, 1)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,350 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/StreamingChromatogramExtractor.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <numeric>
+
+using namespace OpenMS;
+using namespace std;
+
+typedef ChromatogramExtractorAlgorithm::ExtractionCoordinates ExtractionCoordinates;
+
+// create one (empty) output chromatogram per coordinate
+std::vector< OpenSwath::ChromatogramPtr > createOutput(Size n)
+{
+  std::vector< OpenSwath::ChromatogramPtr > output;
+  for (Size i = 0; i < n; ++i)
+  {
+    output.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+  }
+  return output;
+}
+
+ExtractionCoordinates createCoordinate(double mz, double mz_precursor, const String& id)
+{
+  ExtractionCoordinates coord;
+  coord.mz = mz;
+  coord.mz_precursor = mz_precursor;
+  coord.rt_start = 0;
+  coord.rt_end = -1;
+  coord.id = id;
+  return coord;
+}
+
+MSSpectrum createSpectrum(double rt, Int ms_level, double center, double offset)
+{
+  MSSpectrum s;
+  s.setRT(rt);
+  s.setMSLevel(ms_level);
+  if (ms_level > 1)
+  {
+    Precursor prec;
+    prec.setMZ(center);
+    prec.setIsolationWindowLowerOffset(offset);
+    prec.setIsolationWindowUpperOffset(offset);
+    s.getPrecursors().push_back(prec);
+  }
+  // peaks from 300.05 to 899.95 m/z, not on any window border
+  for (int k = 0; k < 600; ++k)
+  {
+    s.push_back(Peak1D(300.05 + k, 1.0 + k % 7 + rt));
+  }
+  return s;
+}
+
+START_TEST(StreamingChromatogramExtractor, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+StreamingChromatogramExtractor* ptr = nullptr;
+StreamingChromatogramExtractor* nullPointer = nullptr;
+
+START_SECTION((StreamingChromatogramExtractor(double mz_extraction_window, bool ppm, double im_extraction_window, const String& filter)))
+{
+  ptr = new StreamingChromatogramExtractor(0.05, false, -1, "tophat");
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrSpectra(), 0)
+  TEST_EQUAL(ptr->getSwathWindows().size(), 0)
+  TEST_EXCEPTION(Exception::IllegalArgument, StreamingChromatogramExtractor(0.05, false, -1, "gauss"))
+}
+END_SECTION
+
+START_SECTION(~StreamingChromatogramExtractor())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void addMS1Coordinates(const std::vector<ExtractionCoordinates>& coordinates, const std::vector<OpenSwath::ChromatogramPtr>& output)))
+{
+  // same data and coordinates as in ChromatogramExtractorAlgorithm_test
+  PeakMap exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.mzML"), exp);
+
+  std::vector< ExtractionCoordinates > coordinates;
+  coordinates.push_back(createCoordinate(654.38, 0, "tr3"));
+  coordinates.push_back(createCoordinate(618.31, 0, "tr1"));
+  coordinates.push_back(createCoordinate(628.45, 0, "tr2"));
+  std::vector< OpenSwath::ChromatogramPtr > output = createOutput(coordinates.size());
+
+  StreamingChromatogramExtractor extractor(0.05, false, -1, "tophat");
+  extractor.addMS1Coordinates(coordinates, output);
+  for (MSSpectrum& s : exp)
+  {
+    extractor.consumeSpectrum(s);
+  }
+  TEST_EQUAL(extractor.getNrSpectra(), 59)
+
+  // the coordinates do not need to be sorted, output stays in input order
+  for (Size k = 0; k < output.size(); ++k)
+  {
+    TEST_EQUAL(output[k]->getTimeArray()->data.size(), 59)
+    TEST_EQUAL(output[k]->getIntensityArray()->data.size(), 59)
+  }
+  std::vector<double> intensities = output[2]->getIntensityArray()->data;
+  Size max_idx = std::max_element(intensities.begin(), intensities.end()) - intensities.begin();
+  TEST_REAL_SIMILAR(intensities[max_idx], 169.792)
+  TEST_REAL_SIMILAR(output[2]->getTimeArray()->data[max_idx], 3120.26)
+  intensities = output[0]->getIntensityArray()->data;
+  max_idx = std::max_element(intensities.begin(), intensities.end()) - intensities.begin();
+  TEST_REAL_SIMILAR(intensities[max_idx], 577.33)
+  TEST_REAL_SIMILAR(output[0]->getTimeArray()->data[max_idx], 3120.26)
+  intensities = output[1]->getIntensityArray()->data;
+  max_idx = std::max_element(intensities.begin(), intensities.end()) - intensities.begin();
+  TEST_REAL_SIMILAR(intensities[max_idx], 35.593)
+  TEST_REAL_SIMILAR(output[1]->getTimeArray()->data[max_idx], 3055.16)
+
+  // coordinates cannot be added after the first spectrum
+  TEST_EXCEPTION(Exception::IllegalArgument, extractor.addMS1Coordinates(coordinates, output))
+  StreamingChromatogramExtractor other(0.05, false, -1, "tophat");
+  TEST_EXCEPTION(Exception::IllegalArgument, other.addMS1Coordinates(coordinates, createOutput(2)))
+}
+END_SECTION
+
+START_SECTION((void addMS2Coordinates(const std::vector<ExtractionCoordinates>& coordinates, const std::vector<OpenSwath::ChromatogramPtr>& output, double min_upper_edge_dist = 0.0)))
+{
+  StreamingChromatogramExtractor extractor(0.5, false, -1, "tophat");
+  std::vector< ExtractionCoordinates > coordinates;
+  coordinates.push_back(createCoordinate(500.0, 412.0, "w1"));
+  coordinates.push_back(createCoordinate(400.0, 437.0, "w2"));
+  coordinates.push_back(createCoordinate(600.0, 424.9, "w1_edge"));
+  coordinates.push_back(createCoordinate(700.0, 480.0, "none"));
+  std::vector< OpenSwath::ChromatogramPtr > output = createOutput(coordinates.size());
+  extractor.addMS2Coordinates(coordinates, output, 0.5);
+  TEST_EXCEPTION(Exception::IllegalArgument, extractor.addMS2Coordinates(coordinates, createOutput(1)))
+
+  // no window seen yet
+  TEST_EQUAL(extractor.getWindowIndex(0), -1)
+  TEST_EXCEPTION(Exception::IndexOverflow, extractor.getWindowIndex(4))
+}
+END_SECTION
+
+START_SECTION((void consumeSpectrum(SpectrumType& s)))
+{
+  // MS1 and two overlapping SWATH windows (400-425 and 424-450) in a single stream
+  PeakMap exp;
+  for (int cycle = 0; cycle < 5; ++cycle)
+  {
+    exp.addSpectrum(createSpectrum(10.0 * cycle, 1, 0, 0));
+    exp.addSpectrum(createSpectrum(10.0 * cycle + 1, 2, 412.5, 12.5));
+    exp.addSpectrum(createSpectrum(10.0 * cycle + 2, 2, 437.0, 13.0));
+  }
+
+  std::vector< ExtractionCoordinates > ms1_coordinates;
+  ms1_coordinates.push_back(createCoordinate(412.05, 0, "prec1"));
+  ms1_coordinates.push_back(createCoordinate(437.05, 0, "prec2"));
+  std::vector< OpenSwath::ChromatogramPtr > ms1_output = createOutput(ms1_coordinates.size());
+
+  std::vector< ExtractionCoordinates > ms2_coordinates;
+  ms2_coordinates.push_back(createCoordinate(500.05, 412.05, "w1"));
+  ms2_coordinates.push_back(createCoordinate(400.05, 437.05, "w2"));
+  ms2_coordinates.push_back(createCoordinate(600.05, 424.8, "overlap")); // too close to upper edge of window 1
+  ms2_coordinates.push_back(createCoordinate(700.05, 480.0, "none"));
+  ms2_coordinates.push_back(createCoordinate(800.05, 412.05, "w1_rt"));
+  ms2_coordinates.back().rt_start = 15.0;
+  ms2_coordinates.back().rt_end = 35.0;
+  std::vector< OpenSwath::ChromatogramPtr > ms2_output = createOutput(ms2_coordinates.size());
+
+  StreamingChromatogramExtractor extractor(0.5, false, -1, "tophat");
+  extractor.addMS1Coordinates(ms1_coordinates, ms1_output);
+  extractor.addMS2Coordinates(ms2_coordinates, ms2_output, 0.5);
+  for (MSSpectrum& s : exp)
+  {
+    extractor.consumeSpectrum(s);
+  }
+
+  TEST_EQUAL(extractor.getNrSpectra(), 15)
+  TEST_EQUAL(extractor.getSwathWindows().size(), 2)
+  TEST_REAL_SIMILAR(extractor.getSwathWindows()[0].lower, 400.0)
+  TEST_REAL_SIMILAR(extractor.getSwathWindows()[0].upper, 425.0)
+  TEST_REAL_SIMILAR(extractor.getSwathWindows()[1].center, 437.0)
+  TEST_EQUAL(extractor.getWindowIndex(0), 0)
+  TEST_EQUAL(extractor.getWindowIndex(1), 1)
+  TEST_EQUAL(extractor.getWindowIndex(2), 1)
+  TEST_EQUAL(extractor.getWindowIndex(3), -1)
+  TEST_EQUAL(extractor.getWindowIndex(4), 0)
+
+  // compare to the extraction from the separate maps
+  for (int ms_level = 0; ms_level < 3; ++ms_level)
+  {
+    boost::shared_ptr<PeakMap> window_map(new PeakMap);
+    for (const MSSpectrum& s : exp)
+    {
+      bool use = (ms_level == 0 && s.getMSLevel() == 1) ||
+                 (ms_level > 0 && s.getMSLevel() == 2 && std::fabs(s.getPrecursors()[0].getMZ() - extractor.getSwathWindows()[ms_level - 1].center) < 1e-6);
+      if (use) window_map->addSpectrum(s);
+    }
+    OpenSwath::SpectrumAccessPtr window_ptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(window_map);
+
+    std::vector< ExtractionCoordinates > coordinates;
+    std::vector< OpenSwath::ChromatogramPtr > streamed;
+    if (ms_level == 0)
+    {
+      coordinates = ms1_coordinates;
+      streamed = ms1_output;
+    }
+    else
+    {
+      for (Size k = 0; k < ms2_coordinates.size(); ++k)
+      {
+        if (extractor.getWindowIndex(k) == ms_level - 1)
+        {
+          coordinates.push_back(ms2_coordinates[k]);
+          streamed.push_back(ms2_output[k]);
+        }
+      }
+    }
+    std::vector<Size> order(coordinates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&coordinates](Size a, Size b) { return coordinates[a].mz < coordinates[b].mz; });
+    std::vector< ExtractionCoordinates > sorted_coordinates;
+    std::vector< OpenSwath::ChromatogramPtr > sorted_streamed;
+    for (Size k : order)
+    {
+      sorted_coordinates.push_back(coordinates[k]);
+      sorted_streamed.push_back(streamed[k]);
+    }
+
+    std::vector< OpenSwath::ChromatogramPtr > expected = createOutput(sorted_coordinates.size());
+    ChromatogramExtractorAlgorithm().extractChromatograms(window_ptr, expected, sorted_coordinates, 0.5, false, -1, "tophat");
+    for (Size k = 0; k < expected.size(); ++k)
+    {
+      TEST_EQUAL(sorted_streamed[k]->getTimeArray()->data == expected[k]->getTimeArray()->data, true)
+      ABORT_IF(sorted_streamed[k]->getIntensityArray()->data.size() != expected[k]->getIntensityArray()->data.size())
+      for (Size i = 0; i < expected[k]->getIntensityArray()->data.size(); ++i)
+      {
+        TEST_REAL_SIMILAR(sorted_streamed[k]->getIntensityArray()->data[i], expected[k]->getIntensityArray()->data[i])
+      }
+    }
+  }
+
+  // each window has one data point per cycle, the RT restricted coordinate only two
+  TEST_EQUAL(ms1_output[0]->getTimeArray()->data.size(), 5)
+  TEST_EQUAL(ms2_output[1]->getTimeArray()->data.size(), 5)
+  TEST_REAL_SIMILAR(ms2_output[1]->getTimeArray()->data[0], 2.0)
+  TEST_EQUAL(ms2_output[3]->getTimeArray()->data.size(), 0)
+  TEST_EQUAL(ms2_output[4]->getTimeArray()->data.size(), 2)
+  TEST_REAL_SIMILAR(ms2_output[4]->getTimeArray()->data[0], 21.0)
+
+  // MS2 spectra need a precursor
+  MSSpectrum no_precursor = createSpectrum(60.0, 2, 0, 0);
+  no_precursor.getPrecursors().clear();
+  TEST_EXCEPTION(Exception::InvalidParameter, extractor.consumeSpectrum(no_precursor))
+
+  // bartlett: peaks in the center count fully, towards the borders less
+  {
+    StreamingChromatogramExtractor bartlett(2.0, false, -1, "bartlett");
+    std::vector< ExtractionCoordinates > coordinates(1, createCoordinate(500.55, 0, "b"));
+    std::vector< OpenSwath::ChromatogramPtr > output = createOutput(1);
+    bartlett.addMS1Coordinates(coordinates, output);
+    MSSpectrum s = createSpectrum(0.0, 1, 0, 0); // peaks at 500.05 (0.5 from center) and 501.05 (0.5 from center)
+    bartlett.consumeSpectrum(s);
+    ABORT_IF(output[0]->getIntensityArray()->data.size() != 1)
+    TEST_REAL_SIMILAR(output[0]->getIntensityArray()->data[0], 0.5 * s[200].getIntensity() + 0.5 * s[201].getIntensity())
+  }
+
+  // ion mobility: only peaks within the IM window are extracted
+  {
+    StreamingChromatogramExtractor with_im(2.0, false, 10.0, "tophat");
+    std::vector< ExtractionCoordinates > coordinates(1, createCoordinate(500.55, 0, "im"));
+    coordinates[0].ion_mobility = 20.0;
+    std::vector< OpenSwath::ChromatogramPtr > output = createOutput(1);
+    with_im.addMS1Coordinates(coordinates, output);
+    MSSpectrum s = createSpectrum(0.0, 1, 0, 0);
+    TEST_EXCEPTION(Exception::IllegalArgument, with_im.consumeSpectrum(s))
+    s.getFloatDataArrays().resize(1);
+    s.getFloatDataArrays()[0].setName("Ion Mobility");
+    for (Size k = 0; k < s.size(); ++k)
+    {
+      s.getFloatDataArrays()[0].push_back(k % 2 == 0 ? 18.0 : 30.0);
+    }
+    with_im.consumeSpectrum(s);
+    ABORT_IF(output[0]->getIntensityArray()->data.size() != 1)
+    TEST_REAL_SIMILAR(output[0]->getIntensityArray()->data[0], s[200].getIntensity())
+  }
+}
+END_SECTION
+
+START_SECTION((const std::vector<OpenSwath::SwathMap>& getSwathWindows() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((int getWindowIndex(Size index) const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size getNrSpectra() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
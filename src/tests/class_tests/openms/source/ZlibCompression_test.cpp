@@ -207,6 +207,50 @@ START_SECTION((static void uncompressString(const QByteArray& compressed_data, Q
 }
 END_SECTION
 
+START_SECTION((static void compressData(const void * raw_data, size_t nr_bytes, std::string& compressed_data, int level)))
+{
+  std::string compressed_data;
+  std::string compressed_data_fast;
+
+  ZlibCompression::compressData(raw_data4.data(), raw_data4.size(), compressed_data, 9);
+  ZlibCompression::compressData(raw_data4.data(), raw_data4.size(), compressed_data_fast, 1);
+  TEST_EQUAL(compressed_data.size() < raw_data4.size(), true)
+  TEST_EQUAL(compressed_data_fast.size() < raw_data4.size(), true)
+
+  // default level yields the same result as compressString
+  std::string compressed_string;
+  ZlibCompression::compressData(raw_data3.data(), raw_data3.size(), compressed_data, -1);
+  ZlibCompression::compressString(raw_data3, compressed_string);
+  TEST_EQUAL(compressed_data == compressed_string, true)
+
+  // level 0 only wraps the data
+  ZlibCompression::compressData(raw_data.data(), raw_data.size(), compressed_data, 0);
+  TEST_EQUAL(compressed_data.size() > raw_data.size(), true)
+}
+END_SECTION
+
+START_SECTION((static void uncompressData(const void * compressed_data, size_t nr_bytes, void * raw_data, size_t raw_size)))
+{
+  std::string compressed_data;
+  for (int level = 0; level <= 9; level += 3)
+  {
+    ZlibCompression::compressData(raw_data4.data(), raw_data4.size(), compressed_data, level);
+    std::string uncompressed_data(raw_data4.size(), '\0');
+    ZlibCompression::uncompressData(compressed_data.data(), compressed_data.size(), &uncompressed_data[0], uncompressed_data.size());
+    TEST_EQUAL(uncompressed_data == raw_data4, true)
+  }
+
+  // wrong size of the uncompressed data
+  std::string too_small(raw_data4.size() - 1, '\0');
+  TEST_EXCEPTION(Exception::ConversionError, ZlibCompression::uncompressData(compressed_data.data(), compressed_data.size(), &too_small[0], too_small.size()))
+  std::string too_large(raw_data4.size() + 1, '\0');
+  TEST_EXCEPTION(Exception::ConversionError, ZlibCompression::uncompressData(compressed_data.data(), compressed_data.size(), &too_large[0], too_large.size()))
+
+  // corrupt data
+  TEST_EXCEPTION(Exception::ConversionError, ZlibCompression::uncompressData(raw_data.data(), raw_data.size(), &too_large[0], too_large.size()))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
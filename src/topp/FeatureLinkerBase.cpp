@@ -201,25 +201,7 @@ protected:
         FeatureMap tmp;
         f.load(ins[i], tmp);
 
-        StringList ms_runs;
-        tmp.getPrimaryMSRunPath(ms_runs);
-
-        // associate mzML file with map i in consensusXML
-        if (ms_runs.size() > 1 || ms_runs.empty())
-        {
-          OPENMS_LOG_WARN << "Exactly one MS run should be associated with a FeatureMap. "
-            << ms_runs.size() 
-            << " provided." << endl;
-        }
-        else
-        {
-          out_map.getColumnHeaders()[i].filename = ms_runs.front();
-        }
-        out_map.getColumnHeaders()[i].size = tmp.size();
-        out_map.getColumnHeaders()[i].unique_id = tmp.getUniqueId();
-
-        // copy over information on the primary MS run
-        ms_run_locations.insert(ms_run_locations.end(), ms_runs.begin(), ms_runs.end());
+        annotateColumnHeader_(i, tmp, out_map, ms_run_locations);
 
         // to save memory, remove convex hulls, subordinates:
         for (Feature& ft : tmp)
@@ -343,6 +325,38 @@ protected:
       }
     }
 
+    writeConsensusMap_(out, out_map);
+
+    return EXECUTION_OK;
+  }
+
+  /// Describes input map @p i in the column headers of @p out_map and collects its primary MS run
+  void annotateColumnHeader_(Size i, const FeatureMap& map, ConsensusMap& out_map, StringList& ms_run_locations)
+  {
+    StringList ms_runs;
+    map.getPrimaryMSRunPath(ms_runs);
+
+    // associate mzML file with map i in consensusXML
+    if (ms_runs.size() > 1 || ms_runs.empty())
+    {
+      OPENMS_LOG_WARN << "Exactly one MS run should be associated with a FeatureMap. "
+        << ms_runs.size() 
+        << " provided." << endl;
+    }
+    else
+    {
+      out_map.getColumnHeaders()[i].filename = ms_runs.front();
+    }
+    out_map.getColumnHeaders()[i].size = map.size();
+    out_map.getColumnHeaders()[i].unique_id = map.getUniqueId();
+
+    // copy over information on the primary MS run
+    ms_run_locations.insert(ms_run_locations.end(), ms_runs.begin(), ms_runs.end());
+  }
+
+  /// Finalizes the linking result @p out_map, writes it to @p out and logs statistics
+  void writeConsensusMap_(const String& out, ConsensusMap& out_map)
+  {
     // assign unique ids
     out_map.applyMemberFunction(&UniqueIdInterface::setUniqueId);
 
@@ -372,8 +386,6 @@ protected:
                << i->second << endl;
     }
     OPENMS_LOG_INFO << "  total:      " << setw(6) << out_map.size() << endl;
-
-    return EXECUTION_OK;
   }
 
 };
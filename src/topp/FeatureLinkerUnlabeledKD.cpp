@@ -37,6 +37,8 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureGroupingAlgorithmKD.h>
+#include <OpenMS/ANALYSIS/MAPMATCHING/LinkingFeatureStore.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include "../topp/FeatureLinkerBase.cpp"
 
@@ -96,6 +98,17 @@ using namespace std;
  used connected components memory-wise. More stringent m/z or retention time
  tolerances might be required then.
 
+ For very large numbers of featureXML inputs, the flag -out_of_core avoids
+ holding all input maps in memory: the data needed for linking (position,
+ intensity, charge, quality, width, unique id and adduct annotation) is
+ written to a temporary file one map at a time, and the maps are aligned and
+ linked one m/z partition at a time from that file. Peptide and protein
+ identifications are read from the inputs again when writing the output.
+ Memory use then mainly depends on the size of the partitions (see
+ -algorithm:nr_partitions) and of the result. The result is the same as
+ without the flag. The feature unique ids within each input file must be
+ unique.
+
  <B>The command line parameters of this tool are:</B>
  @verbinclude TOPP_FeatureLinkerUnlabeledKD.cli
  <B>INI file documentation of this tool:</B>
@@ -121,6 +134,7 @@ protected:
   void registerOptionsAndFlags_() override
   {
     TOPPFeatureLinkerBase::registerOptionsAndFlags_();
+    registerFlag_("out_of_core", "For featureXML input only: Keep only the data needed for linking in a temporary file and link one m/z partition at a time, instead of loading all input maps into memory.", true);
     registerSubsection_("algorithm", "Algorithm parameters section");
   }
 
@@ -134,9 +148,84 @@ protected:
   ExitCodes main_(int, const char **) override
   {
     FeatureGroupingAlgorithmKD algo;
+    if (getFlag_("out_of_core"))
+    {
+      return outOfCoreMain_(algo);
+    }
     return TOPPFeatureLinkerBase::common_main_(&algo);
   }
 
+  ExitCodes outOfCoreMain_(FeatureGroupingAlgorithmKD& algo)
+  {
+    StringList ins = getStringList_("in");
+    String out = getStringOption_("out");
+    for (const String& in : ins)
+    {
+      if (FileHandler::getType(in) != FileTypes::FEATUREXML)
+      {
+        writeLogError_("Error: Out-of-core linking requires featureXML input!");
+        return ILLEGAL_PARAMETERS;
+      }
+    }
+    if (!getStringOption_("design").empty())
+    {
+      writeLogError_("Error: Out-of-core linking does not support an experimental design!");
+      return ILLEGAL_PARAMETERS;
+    }
+
+    Param algorithm_param = getParam_().copy("algorithm:", true);
+    writeDebug_("Used algorithm parameters", algorithm_param, 3);
+    algo.setParameters(algorithm_param);
+
+    FeatureXMLFile f;
+    FeatureFileOptions options = f.getOptions();
+    options.setLoadSubordinates(false);
+    options.setLoadConvexHull(false);
+    f.setOptions(options);
+
+    ConsensusMap out_map;
+    StringList ms_run_locations;
+    File::TempDir tmp_dir;
+    LinkingFeatureStore store(tmp_dir.getPath() + "linking_features.bin");
+
+    OPENMS_LOG_INFO << "Linking " << ins.size() << " featureXMLs (out of core)." << endl;
+    startProgress(0, ins.size(), "reading input");
+    for (Size i = 0; i < ins.size(); ++i)
+    {
+      FeatureMap map;
+      f.load(ins[i], map);
+      annotateColumnHeader_(i, map, out_map, ms_run_locations);
+      try
+      {
+        store.addMap(map);
+      }
+      catch (Exception::InvalidValue& e)
+      {
+        writeLogError_("Error: " + ins[i] + ": " + e.what() + " Link without -out_of_core.");
+        return INCOMPATIBLE_INPUT_DATA;
+      }
+      setProgress(i);
+    }
+    endProgress();
+
+    algo.group(store, out_map);
+
+    // the identifications were not stored, add them from the inputs
+    startProgress(0, ins.size(), "restoring identifications");
+    for (Size i = 0; i < ins.size(); ++i)
+    {
+      FeatureMap map;
+      f.load(ins[i], map);
+      store.restoreIdentifications(i, map, out_map);
+      setProgress(i);
+    }
+    endProgress();
+
+    writeConsensusMap_(out, out_map);
+
+    return EXECUTION_OK;
+  }
+
 };
 
 
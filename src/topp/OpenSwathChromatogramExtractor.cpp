@@ -34,6 +34,7 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractor.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/StreamingChromatogramExtractor.h>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 
@@ -44,6 +45,8 @@
 #include <OpenMS/FORMAT/TraMLFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/TransformationXMLFile.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataChainingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataTransformingConsumer.h>
 
 
 using namespace std;
@@ -123,6 +126,14 @@ using namespace OpenMS;
   window, bartlett will weigh the signal in the center of the window more than
   the signal on the edge.
 
+  With the advanced @p -stream flag, each input file is read only once and
+  spectra are extracted as they are parsed, without loading the whole map
+  into memory. In this mode a single input file may contain the MS1 spectra
+  and all SWATH windows: every MS2 spectrum is assigned to its isolation
+  window (based on its precursor) and each transition is extracted from the
+  first window its precursor falls into. Use @p -extract_MS1 to extract the
+  MS1 precursor traces instead.
+
   [1] Gillet LC, Navarro P, Tate S, Rost H, Selevsek N, Reiter L, Bonner R, Aebersold R. \n
   <a href="https://doi.org/10.1074/mcp.O111.016717"> Targeted data extraction of the MS/MS spectra generated by data-independent
   acquisition: a new concept for consistent and accurate proteome analysis. </a> \n
@@ -183,6 +194,8 @@ protected:
     model_types.push_back("bartlett"); // bartlett if we use zeros at the end
     setValidStrings_("extraction_function", model_types);
 
+    registerFlag_("stream", "Extract all windows in a single pass over each input file while it is parsed instead of loading it into memory (an input file may then contain all SWATH windows)", true);
+
     registerModelOptions_("linear");
   }
 
@@ -200,6 +213,102 @@ protected:
     registerFlag_("model:symmetric_regression", "Only for 'linear' model: Perform linear regression on 'y - x' vs. 'y + x', instead of on 'y' vs. 'x'.", true);
   }
 
+  /// prepare the coordinates (with or without rt extraction) for the given transitions
+  void prepareCoordinates_(std::vector< OpenSwath::ChromatogramPtr >& chromatogram_ptrs,
+                           std::vector< ChromatogramExtractor::ExtractionCoordinates >& coordinates,
+                           const OpenMS::TargetedExperiment& transition_exp_used,
+                           const TransformationDescription& trafo_inverse,
+                           double rt_extraction_window, bool extract_MS1) const
+  {
+    if (rt_extraction_window < 0)
+    {
+      ChromatogramExtractor::prepare_coordinates(chromatogram_ptrs, coordinates, transition_exp_used, rt_extraction_window, extract_MS1);
+    }
+    else
+    {
+      // Use an rt extraction window of 0.0 which will just write the retention time in start / end positions
+      ChromatogramExtractor::prepare_coordinates(chromatogram_ptrs, coordinates, transition_exp_used, 0.0, extract_MS1);
+      for (ChromatogramExtractor::ExtractionCoordinates& chrom : coordinates)
+      {
+        chrom.rt_start = trafo_inverse.apply(chrom.rt_start) - rt_extraction_window / 2.0;
+        chrom.rt_end = trafo_inverse.apply(chrom.rt_end) + rt_extraction_window / 2.0;
+      }
+    }
+  }
+
+  /// extract all transitions from a file in a single pass while it is parsed
+  void extractStreaming_(const String& file, const OpenMS::TargetedExperiment& targeted_exp,
+                         const TransformationDescription& trafo_inverse, MapType& out_exp,
+                         std::vector< OpenMS::MSChromatogram >& chromatograms, bool first_file,
+                         bool extract_MS1, double min_upper_edge_dist, double rt_extraction_window,
+                         double mz_extraction_window, bool ppm, double im_window,
+                         const String& extraction_function) const
+  {
+    std::vector< OpenSwath::ChromatogramPtr > chromatogram_ptrs;
+    std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+    prepareCoordinates_(chromatogram_ptrs, coordinates, targeted_exp, trafo_inverse, rt_extraction_window, extract_MS1);
+
+    StreamingChromatogramExtractor extractor(mz_extraction_window, ppm, im_window, extraction_function);
+    if (extract_MS1)
+    {
+      extractor.addMS1Coordinates(coordinates, chromatogram_ptrs);
+    }
+    else
+    {
+      extractor.addMS2Coordinates(coordinates, chromatogram_ptrs, min_upper_edge_dist);
+    }
+
+    // capture the meta data of the run and of the first spectrum while parsing
+    ExperimentalSettings exp_settings;
+    SpectrumSettings spec_settings;
+    bool has_spectrum = false;
+    MSDataTransformingConsumer settings_consumer;
+    settings_consumer.setExperimentalSettingsFunc([&exp_settings](const ExperimentalSettings& s) { exp_settings = s; });
+    settings_consumer.setSpectraProcessingFunc([&spec_settings, &has_spectrum](MSSpectrum& s)
+      {
+        if (!has_spectrum) spec_settings = s;
+        has_spectrum = true;
+      });
+
+    MSDataChainingConsumer chain;
+    chain.appendConsumer(&settings_consumer);
+    chain.appendConsumer(&extractor);
+    MzMLFile().transform(file, &chain);
+    if (!has_spectrum)
+    {
+      return; // if empty, go on
+    }
+
+    if (first_file)
+    {
+      static_cast<ExperimentalSettings&>(out_exp) = exp_settings;
+    }
+
+    // keep only the coordinates which were extracted from one of the windows
+    std::vector< OpenSwath::ChromatogramPtr > used_ptrs;
+    std::vector< ChromatogramExtractor::ExtractionCoordinates > used_coordinates;
+    for (Size k = 0; k < coordinates.size(); ++k)
+    {
+      if (extract_MS1 || extractor.getWindowIndex(k) != -1)
+      {
+        used_ptrs.push_back(chromatogram_ptrs[k]);
+        used_coordinates.push_back(coordinates[k]);
+      }
+    }
+    std::cout << "Extracted " << used_coordinates.size() << " transitions from " << extractor.getSwathWindows().size()
+              << " SWATH windows in " << extractor.getNrSpectra() << " spectra" << std::endl;
+
+    // Remove potential meta value indicating cached data
+    for (Size j = 0; j < spec_settings.getDataProcessing().size(); j++)
+    {
+      if (spec_settings.getDataProcessing()[j]->metaValueExists("cached_data"))
+      {
+        spec_settings.getDataProcessing()[j]->removeMetaValue("cached_data");
+      }
+    }
+    ChromatogramExtractor::return_chromatogram(used_ptrs, used_coordinates, targeted_exp, spec_settings, chromatograms, extract_MS1, im_window);
+  }
+
   ExitCodes main_(int, const char **) override
   {
     StringList file_list = getStringList_("in");
@@ -214,6 +323,7 @@ protected:
     double im_window = getDoubleOption_("ion_mobility_window");
 
     String extraction_function = getStringOption_("extraction_function");
+    bool stream = getFlag_("stream");
 
     // If we have a transformation file, trafo will transform the RT in the
     // scoring according to the model. If we don't have one, it will apply the
@@ -243,90 +353,88 @@ protected:
     traml.load(tr_file, targeted_exp);
     std::cout << "Loaded TraML file" << std::endl;
 
-    // Do parallelization over the different input files
-    // Only in OpenMP 3.0 are unsigned loop variables allowed
-#pragma omp parallel for
-    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(file_list.size()); ++i)
+    if (stream)
     {
-      boost::shared_ptr<PeakMap > exp(new PeakMap);
-      MzMLFile f;
-      // Logging and output to the console
-      // IF_MASTERTHREAD f.setLogType(log_type_); 
-
-      // Find the transitions to extract and extract them
-      MapType tmp_out;
-      OpenMS::TargetedExperiment transition_exp_used;
-      f.load(file_list[i], *exp);
-      if (exp->empty())
-      { 
-        continue; // if empty, go on
-      } 
-      OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
-      bool do_continue = true;
-      if (is_swath)
-      {
-        do_continue = OpenSwathHelper::checkSwathMapAndSelectTransitions(*exp, targeted_exp, transition_exp_used, min_upper_edge_dist);  
-      }
-      else
+      for (Size i = 0; i < file_list.size(); ++i)
       {
-        transition_exp_used = targeted_exp;
+        extractStreaming_(file_list[i], targeted_exp, trafo_inverse, out_exp, chromatograms, i == 0, extract_MS1,
+                          min_upper_edge_dist, rt_extraction_window, mz_extraction_window, ppm, im_window, extraction_function);
       }
-
-      // after loading the first file, copy the meta data from that experiment
-      // this may happen *after* chromatograms were already added to the
-      // output, thus we do NOT fill the experiment here but rather store all
-      // the chromatograms in the "chromatograms" array and store them in
-      // out_exp afterwards.
-#pragma omp critical (OpenSwathChromatogramExtractor_metadata)
-      if (i == 0) 
-      {
-        out_exp = *exp;
-        out_exp.clear(false);
-      }
-
-      std::cout << "Extracting " << transition_exp_used.getTransitions().size() << " transitions" << std::endl;
-      std::vector< OpenSwath::ChromatogramPtr > chromatogram_ptrs;
-      std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
-
-      // continue if the map is not empty
-      if (do_continue)
+    }
+    else
+    {
+      // Do parallelization over the different input files
+      // Only in OpenMP 3.0 are unsigned loop variables allowed
+#pragma omp parallel for
+      for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(file_list.size()); ++i)
       {
-
-        // Prepare the coordinates (with or without rt extraction) and then extract the chromatograms
-        ChromatogramExtractor extractor;
-        if (rt_extraction_window < 0)
+        boost::shared_ptr<PeakMap > exp(new PeakMap);
+        MzMLFile f;
+        // Logging and output to the console
+        // IF_MASTERTHREAD f.setLogType(log_type_); 
+
+        // Find the transitions to extract and extract them
+        MapType tmp_out;
+        OpenMS::TargetedExperiment transition_exp_used;
+        f.load(file_list[i], *exp);
+        if (exp->empty())
+        { 
+          continue; // if empty, go on
+        } 
+        OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+        bool do_continue = true;
+        if (is_swath)
         {
-          extractor.prepare_coordinates(chromatogram_ptrs, coordinates, transition_exp_used, rt_extraction_window, extract_MS1);
+          do_continue = OpenSwathHelper::checkSwathMapAndSelectTransitions(*exp, targeted_exp, transition_exp_used, min_upper_edge_dist);  
         }
         else
         {
-          // Use an rt extraction window of 0.0 which will just write the retention time in start / end positions
-          extractor.prepare_coordinates(chromatogram_ptrs, coordinates, transition_exp_used, 0.0, extract_MS1);
-          for (ChromatogramExtractor::ExtractionCoordinates& chrom : coordinates)
-          {
-            chrom.rt_start = trafo_inverse.apply(chrom.rt_start) - rt_extraction_window / 2.0;
-            chrom.rt_end = trafo_inverse.apply(chrom.rt_end) + rt_extraction_window / 2.0;
-          }
+          transition_exp_used = targeted_exp;
         }
-        extractor.extractChromatograms(expptr, chromatogram_ptrs, coordinates, 
-            mz_extraction_window, ppm, im_window, extraction_function);
 
-#pragma omp critical (OpenSwathChromatogramExtractor_insertMS1)
+        // after loading the first file, copy the meta data from that experiment
+        // this may happen *after* chromatograms were already added to the
+        // output, thus we do NOT fill the experiment here but rather store all
+        // the chromatograms in the "chromatograms" array and store them in
+        // out_exp afterwards.
+#pragma omp critical (OpenSwathChromatogramExtractor_metadata)
+        if (i == 0) 
         {
-          // Remove potential meta value indicating cached data
-          SpectrumSettings exp_settings = (*exp)[0];
-          for (Size j = 0; j < exp_settings.getDataProcessing().size(); j++)
+          out_exp = *exp;
+          out_exp.clear(false);
+        }
+
+        std::cout << "Extracting " << transition_exp_used.getTransitions().size() << " transitions" << std::endl;
+        std::vector< OpenSwath::ChromatogramPtr > chromatogram_ptrs;
+        std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+
+        // continue if the map is not empty
+        if (do_continue)
+        {
+
+          // Prepare the coordinates (with or without rt extraction) and then extract the chromatograms
+          ChromatogramExtractor extractor;
+          prepareCoordinates_(chromatogram_ptrs, coordinates, transition_exp_used, trafo_inverse, rt_extraction_window, extract_MS1);
+          extractor.extractChromatograms(expptr, chromatogram_ptrs, coordinates, 
+              mz_extraction_window, ppm, im_window, extraction_function);
+
+#pragma omp critical (OpenSwathChromatogramExtractor_insertMS1)
           {
-            if (exp_settings.getDataProcessing()[j]->metaValueExists("cached_data"))
+            // Remove potential meta value indicating cached data
+            SpectrumSettings exp_settings = (*exp)[0];
+            for (Size j = 0; j < exp_settings.getDataProcessing().size(); j++)
             {
-              exp_settings.getDataProcessing()[j]->removeMetaValue("cached_data");
+              if (exp_settings.getDataProcessing()[j]->metaValueExists("cached_data"))
+              {
+                exp_settings.getDataProcessing()[j]->removeMetaValue("cached_data");
+              }
             }
+            extractor.return_chromatogram(chromatogram_ptrs, coordinates, transition_exp_used, exp_settings, chromatograms, extract_MS1, im_window);
           }
-          extractor.return_chromatogram(chromatogram_ptrs, coordinates, transition_exp_used, exp_settings, chromatograms, extract_MS1, im_window);
-        }
 
-      } // end of do_continue
-    } // end of loop over all files / end of OpenMP
+        } // end of do_continue
+      } // end of loop over all files / end of OpenMP
+    }
 
     // TODO check that no chromatogram IDs occur multiple times !
     
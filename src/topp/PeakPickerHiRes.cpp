@@ -36,6 +36,7 @@
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 
 #include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
@@ -125,54 +126,6 @@ public:
 
 protected:
 
-  /**
-    @brief Helper class for the Low Memory peak-picking
-  */
-  class PPHiResMzMLConsumer :
-    public MSDataWritingConsumer
-  {
-
-  public:
-
-    PPHiResMzMLConsumer(String filename, const PeakPickerHiRes& pp) :
-      MSDataWritingConsumer(std::move(filename)),
-      ms_levels_(pp.getParameters().getValue("ms_levels").toIntVector())
-    {
-      pp_ = pp;
-    }
-
-    void processSpectrum_(MapType::SpectrumType& s) override
-    {
-      if (ms_levels_.empty()) //auto mode
-      {
-        if (s.getType() == SpectrumSettings::CENTROID)
-        {
-          return;
-        }
-      }
-      else if (!ListUtils::contains(ms_levels_, s.getMSLevel()))
-      {
-        return;
-      }
-
-      MapType::SpectrumType sout;
-      pp_.pick(s, sout);
-      s = std::move(sout);
-    }
-
-    void processChromatogram_(MapType::ChromatogramType & c) override
-    {
-      MapType::ChromatogramType c_out;
-      pp_.pick(c, c_out);
-      c = std::move(c_out);
-    }
-
-  private:
-
-    PeakPickerHiRes pp_;
-    std::vector<Int> ms_levels_;
-  };
-
   void registerOptionsAndFlags_() override
   {
     registerInputFile_("in", "<file>", "", "input profile data file ");
@@ -194,17 +147,22 @@ protected:
   ExitCodes doLowMemAlgorithm(const PeakPickerHiRes& pp)
   {
     ///////////////////////////////////
-    // Create the consumer object, add data processing
+    // Create the consumer objects, add data processing
     ///////////////////////////////////
-    PPHiResMzMLConsumer pp_consumer(out, pp);
-    pp_consumer.addDataProcessing(getProcessingInfo_(DataProcessing::PEAK_PICKING));
-
-    ///////////////////////////////////
-    // Create new MSDataReader and set our consumer
-    ///////////////////////////////////
-    MzMLFile mz_data_file;
-    mz_data_file.setLogType(log_type_);
-    mz_data_file.transform(in, &pp_consumer);
+    PlainMSDataWritingConsumer writing_consumer(out);
+    writing_consumer.addDataProcessing(getProcessingInfo_(DataProcessing::PEAK_PICKING));
+    {
+      // picks batches of spectra in parallel and passes them on to the writer (in order)
+      PeakPickerHiResConsumer pp_consumer(&writing_consumer, pp);
+
+      ///////////////////////////////////
+      // Create new MSDataReader and set our consumer
+      ///////////////////////////////////
+      MzMLFile mz_data_file;
+      mz_data_file.setLogType(log_type_);
+      mz_data_file.transform(in, &pp_consumer);
+      pp_consumer.flush();
+    }
 
     return EXECUTION_OK;
   }
@@ -83,6 +83,9 @@ using namespace OpenMS;
   Runtime: PeptideIndexer is usually very fast (loading and storing the data takes the most time) and search speed can be further improved (linearly) by using more threads. 
   Avoid allowing too many (>=4) ambiguous amino acids if your database contains long stretches of 'X' (exponential search space).
 
+  When many idXML files are mapped against the same database, use @p backend 'suffix_array' together with @p suffix_array_file:
+  the first run builds a suffix array of the database and stores it; all following runs memory-map the index and only look up their peptides.
+
   PeptideIndexer supports relative database filenames, which (when not found in the current working directory) are looked up in the directories specified
   by @p OpenMS.ini:id_db_dir (see @subpage TOPP_advanced). The database is by default derived from the input idXML's metainformation ('auto' setting), but can be specified explicitly.
 
@@ -187,7 +190,7 @@ protected:
     param_pi.update(param, false, false, false, false, OpenMS_Log_debug); // suppress param. update message
     indexer.setParameters(param_pi);
     indexer.setLogType(this->log_type_);
-    FASTAContainer<TFI_File> proteins(db_name);
+    FASTAContainer<TFI_Arena> proteins(db_name); // parsed in parallel; needs about as much memory as the FASTA file
     PeptideIndexing::ExitCodes indexer_exit = indexer.run(proteins, prot_ids, pep_ids);
 
     //-------------------------------------------------------------
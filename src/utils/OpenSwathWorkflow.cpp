@@ -74,6 +74,8 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
 
+#include <QtCore/QCryptographicHash>
+
 #include <cassert>
 #include <limits>
 
@@ -146,11 +148,17 @@ using namespace OpenMS;
       <li> @ref OpenMS::TraMLFile "TraML" </li>
       <li> @ref OpenMS::TransitionTSVFile "OpenSWATH TSV transition lists" </li>
       <li> @ref OpenMS::TransitionPQPFile "OpenSWATH PQP SQLite files" </li>
+      <li> @ref OpenMS::MappedTransitionLibrary "OpenSWATH binary transition libraries (tlib)" </li>
       <li> SpectraST MRM transition lists </li>
       <li> Skyline transition lists </li>
       <li> Spectronaut transition lists </li>
     </ul>
 
+  Binary transition libraries are created from the other formats with
+  @ref UTILS_TargetedFileConverter and are memory-mapped instead of parsed,
+  which makes loading very large libraries much faster. They cannot be used
+  to produce OSW output (@p -out_osw), which requires a PQP library.
+
   <h3>Parameters</h3>
   The current parameters are optimized for 2 hour gradients on SCIEX 5600 /
   6600 TripleTOF instruments with a peak width of around 30 seconds using iRT
@@ -188,6 +196,12 @@ using namespace OpenMS;
   In addition, the extracted chromatograms can be written out using the
   @p -out_chrom parameter.
 
+  For long runs on clusters where jobs may be preempted, @p -checkpoint records
+  each completed SWATH window in the @p -out_osw file (together with a hash of
+  all inputs and parameters). Restarting the same command line on an
+  interrupted run skips the completed windows and only analyzes the remaining
+  ones; the record is removed once the run has finished.
+
   <h4> Feature list output format </h4>
 
   The tab-separated feature output contains the following information:
@@ -433,10 +447,10 @@ protected:
     registerInputFileList_("in", "<files>", StringList(), "Input files separated by blank");
     setValidFormats_("in", ListUtils::create<String>("mzML,mzXML,sqMass"));
 
-    registerInputFile_("tr", "<file>", "", "transition file ('TraML','tsv','pqp')");
-    setValidFormats_("tr", ListUtils::create<String>("traML,tsv,pqp"));
+    registerInputFile_("tr", "<file>", "", "transition file ('TraML','tsv','pqp','tlib')");
+    setValidFormats_("tr", ListUtils::create<String>("traML,tsv,pqp,tlib"));
     registerStringOption_("tr_type", "<type>", "", "input file type -- default: determined from file extension or content\n", false);
-    setValidStrings_("tr_type", ListUtils::create<String>("traML,tsv,pqp"));
+    setValidStrings_("tr_type", ListUtils::create<String>("traML,tsv,pqp,tlib"));
 
     // one of the following two needs to be set
     registerInputFile_("tr_irt", "<file>", "", "transition file ('TraML')", false);
@@ -471,6 +485,8 @@ protected:
     registerOutputFile_("out_chrom", "<file>", "", "Also output all computed chromatograms output in mzML (chrom.mzML) or sqMass (SQLite format)", false, true);
     setValidFormats_("out_chrom", ListUtils::create<String>("mzML,sqMass"));
 
+    registerFlag_("checkpoint", "Record completed SWATH windows in the OSW output (-out_osw), so that an interrupted run restarted with the same inputs and parameters continues with the remaining windows. Requires hashing all input files at startup and keeps the features of each window in memory until the window is complete.", true);
+
     // additional QC data
     registerOutputFile_("out_qc", "<file>", "", "Optional QC meta data (charge distribution in MS1). Only works with mzML input files.", false, true);
     setValidFormats_("out_qc", ListUtils::create<String>("json"));
@@ -530,7 +546,7 @@ protected:
 
     registerIntOption_("batchSize", "<number>", 1000, "The batch size of chromatograms to process (0 means to only have one batch, sensible values are around 250-1000)", false, true);
     setMinInt_("batchSize", 0);
-    registerIntOption_("outer_loop_threads", "<number>", -1, "How many threads should be used for the outer loop (-1 use all threads, use 4 to analyze 4 SWATH windows in memory at once).", false, true);
+    registerIntOption_("outer_loop_threads", "<number>", -1, "How many SWATH windows should be processed at the same time (-1 no limit, use 4 to keep at most 4 SWATH windows in memory at once). All threads are used in any case.", false, true);
 
     registerIntOption_("ms1_isotopes", "<number>", 3, "The number of MS1 isotopes used for extraction", false, true);
     setMinInt_("ms1_isotopes", 0);
@@ -648,6 +664,29 @@ protected:
     }
   }
 
+  /// Hash of the content of all input files and of all parameters which influence the results (see -checkpoint)
+  String computeCheckpointFingerprint_(const StringList& input_files) const
+  {
+    QCryptographicHash crypto(QCryptographicHash::Sha1);
+    for (const String& file : input_files)
+    {
+      if (file.empty()) continue;
+      crypto.addData(String(file + "=" + FileHandler::computeFileHash(file) + "\n").c_str());
+    }
+
+    // output files, threading and logging do not change the results
+    const std::set<String> ignored = {"checkpoint", "threads", "outer_loop_threads", "batchSize", "readOptions",
+                                      "tempDirectory", "debug", "log", "no_progress", "force", "test", "ini"};
+    const Param& param = getParam_();
+    for (Param::ParamIterator it = param.begin(); it != param.end(); ++it)
+    {
+      const String name = it.getName();
+      if (ignored.count(name) > 0 || name.hasPrefix("out_") || name.hasPrefix("Debugging:")) continue;
+      crypto.addData(String(name + "=" + String(it->value.toString()) + "\n").c_str());
+    }
+    return String((QString)crypto.result().toHex());
+  }
+
   ExitCodes main_(int, const char **) override
   {
     ///////////////////////////////////
@@ -686,6 +725,7 @@ protected:
     bool split_file = getFlag_("split_file_input");
     bool use_emg_score = getFlag_("use_elution_model_score");
     bool force = getFlag_("force");
+    bool checkpoint = getFlag_("checkpoint");
     bool sonar = getFlag_("sonar");
     bool pasef = getFlag_("pasef");
     bool sort_swath_maps = getFlag_("sort_swath_maps");
@@ -745,6 +785,11 @@ protected:
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
           "OSW output files can only be generated in combination with PQP input files (-tr).");
     }
+    if (checkpoint && (out_osw.empty() || !out_chrom.empty() || sonar))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Checkpointing (-checkpoint) requires OSW output (-out_osw) and is not supported with -out_chrom or -sonar.");
+    }
 
     // Check swath window input
     if (!swath_windows_file.empty())
@@ -811,9 +856,24 @@ protected:
     OPENMS_LOG_INFO << "Loaded " << transition_exp.getProteins().size() << " proteins, " <<
       transition_exp.getCompounds().size() << " compounds with " << transition_exp.getTransitions().size() << " transitions." << std::endl;
 
+    // an interrupted run with identical inputs and parameters is continued on its OSW file
+    String checkpoint_fingerprint;
+    bool resume = false;
+    if (checkpoint)
+    {
+      StringList input_files = file_list;
+      input_files.insert(input_files.end(), {tr_file, irt_tr_file, nonlinear_irt_tr_file, trafo_in, swath_windows_file});
+      checkpoint_fingerprint = computeCheckpointFingerprint_(input_files);
+      resume = OpenSwathOSWWriter::hasCheckpoint(out_osw, checkpoint_fingerprint);
+      if (resume)
+      {
+        OPENMS_LOG_INFO << "Found checkpoint in " << out_osw << ", resuming the interrupted run." << std::endl;
+      }
+    }
+
     if (tr_type == FileTypes::PQP)
     {
-      if (!out_osw.empty())
+      if (!out_osw.empty() && !resume)
       { // copy the PQP file and name it OSW file
         std::ifstream  src(tr_file.c_str(), std::ios::binary);
         std::ofstream  dst(out_osw.c_str(), std::ios::binary | std::ios::trunc);
@@ -938,6 +998,10 @@ protected:
     FeatureMap out_featureFile;
     OpenSwathTSVWriter tsvwriter(out_tsv, file_list[0], use_ms1_traces, sonar); // only active if filename not empty
     OpenSwathOSWWriter oswwriter(out_osw, run_id, file_list[0], use_ms1_traces, sonar, enable_uis_scoring); // only active if filename not empty
+    if (checkpoint)
+    {
+      oswwriter.enableCheckpointing(checkpoint_fingerprint); // reuses the run id when resuming
+    }
 
     ///////////////////////////////////
     // Extract and score
@@ -0,0 +1,173 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/APPLICATIONS/TOPPBase.h>
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
+#include <OpenMS/CHEMISTRY/ModificationsDB.h>
+#include <OpenMS/CHEMISTRY/ProteaseDB.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+using namespace OpenMS;
+using namespace std;
+
+//-------------------------------------------------------------
+//Doxygen docu
+//-------------------------------------------------------------
+
+/**
+    @page UTILS_PeptideDatabaseBuilder PeptideDatabaseBuilder
+
+    @brief Precomputes the digested and modified peptides of a protein database for reuse by search engines.
+<CENTER>
+    <table>
+        <tr>
+            <td ALIGN = "center" BGCOLOR="#EBEBEB"> pot. predecessor tools </td>
+            <td VALIGN="middle" ROWSPAN=2> \f$ \longrightarrow \f$ PeptideDatabaseBuilder \f$ \longrightarrow \f$</td>
+            <td ALIGN = "center" BGCOLOR="#EBEBEB"> pot. successor tools </td>
+        </tr>
+        <tr>
+            <td VALIGN="middle" ALIGN = "center" ROWSPAN=1> @ref UTILS_DecoyDatabase (or any FASTA source)</td>
+            <td VALIGN="middle" ALIGN = "center" ROWSPAN=1> @ref UTILS_SimpleSearchEngine </td>
+        </tr>
+    </table>
+</CENTER>
+
+    Digesting a large protein database and enumerating all modified peptides
+    takes a considerable amount of time, which is spent again by every search.
+    This tool computes the table of all (modified) peptides with their masses
+    and proteins once and stores it in a cache directory. The file name is
+    derived from a hash of the database content and the digestion settings,
+    so searches using the same directory (e.g. @ref UTILS_SimpleSearchEngine
+    with 'Search:peptide_db:cache_dir') find and memory-map a matching table
+    automatically.
+
+    Searches that generate decoys internally digest the extended database, so
+    their tables differ from the ones created here. Use a target-decoy
+    database (e.g. created by @ref UTILS_DecoyDatabase) to share a table
+    between this tool and such searches.
+
+    <B>The command line parameters of this tool are:</B>
+    @verbinclude UTILS_PeptideDatabaseBuilder.cli
+    <B>INI file documentation of this tool:</B>
+    @htmlinclude UTILS_PeptideDatabaseBuilder.html
+*/
+
+// We do not want this class to show up in the docu:
+/// @cond TOPPCLASSES
+
+class TOPPPeptideDatabaseBuilder :
+  public TOPPBase
+{
+public:
+  TOPPPeptideDatabaseBuilder() :
+    TOPPBase("PeptideDatabaseBuilder", "Precomputes the digested and modified peptides of a protein database for reuse by search engines.", false)
+  {
+  }
+
+protected:
+  void registerOptionsAndFlags_() override
+  {
+    registerInputFile_("in", "<file>", "", "Protein database");
+    setValidFormats_("in", ListUtils::create<String>("fasta"));
+    registerStringOption_("cache_dir", "<directory>", "", "Directory the peptide table is stored in (created if it does not exist)");
+
+    vector<String> all_enzymes;
+    ProteaseDB::getInstance()->getAllNames(all_enzymes);
+    registerStringOption_("enzyme", "<string>", "Trypsin", "The enzyme used for peptide digestion.", false);
+    setValidStrings_("enzyme", all_enzymes);
+    registerIntOption_("missed_cleavages", "<number>", 1, "Number of missed cleavages.", false);
+    setMinInt_("missed_cleavages", 0);
+    registerIntOption_("min_length", "<number>", 7, "Minimum length of peptides.", false);
+    setMinInt_("min_length", 1);
+    registerIntOption_("max_length", "<number>", 40, "Maximum length of peptides (0 = disabled).", false);
+    setMinInt_("max_length", 0);
+
+    vector<String> all_mods;
+    ModificationsDB::getInstance()->getAllSearchModifications(all_mods);
+    registerStringList_("fixed_modifications", "<mods>", ListUtils::create<String>("Carbamidomethyl (C)", ','), "Fixed modifications, specified using UniMod (www.unimod.org) terms, e.g. 'Carbamidomethyl (C)'", false);
+    setValidStrings_("fixed_modifications", all_mods);
+    registerStringList_("variable_modifications", "<mods>", ListUtils::create<String>("Oxidation (M)", ','), "Variable modifications, specified using UniMod (www.unimod.org) terms, e.g. 'Oxidation (M)'", false);
+    setValidStrings_("variable_modifications", all_mods);
+    registerIntOption_("max_variable_mods_per_peptide", "<number>", 2, "Maximum number of residues carrying a variable modification per peptide.", false);
+    setMinInt_("max_variable_mods_per_peptide", 0);
+  }
+
+  ExitCodes main_(int, const char**) override
+  {
+    //-------------------------------------------------------------
+    // parsing parameters
+    //-------------------------------------------------------------
+    String in = getStringOption_("in");
+    String cache_dir = getStringOption_("cache_dir");
+
+    PeptideDatabase::Settings settings;
+    settings.enzyme = getStringOption_("enzyme");
+    settings.missed_cleavages = getIntOption_("missed_cleavages");
+    settings.min_size = getIntOption_("min_length");
+    settings.max_size = getIntOption_("max_length");
+    settings.fixed_modifications = getStringList_("fixed_modifications");
+    settings.variable_modifications = getStringList_("variable_modifications");
+    settings.max_variable_mods_per_peptide = getIntOption_("max_variable_mods_per_peptide");
+
+    //-------------------------------------------------------------
+    // reading input
+    //-------------------------------------------------------------
+    vector<FASTAFile::FASTAEntry> proteins;
+    FASTAFile().load(in, proteins);
+
+    //-------------------------------------------------------------
+    // calculations
+    //-------------------------------------------------------------
+    PeptideDatabase db;
+    const bool cached = db.loadOrBuild(cache_dir, proteins, settings);
+
+    //-------------------------------------------------------------
+    // writing output
+    //-------------------------------------------------------------
+    const String filename = PeptideDatabase::getCacheFilename(cache_dir, db.getKey());
+    OPENMS_LOG_INFO << (cached ? "Found existing" : "Created") << " peptide database '" << filename << "'." << endl;
+    OPENMS_LOG_INFO << "Proteins: " << db.getNumberOfProteins() << endl;
+    OPENMS_LOG_INFO << "Peptides (incl. modified variants): " << db.size() << endl;
+
+    return EXECUTION_OK;
+  }
+};
+
+int main(int argc, const char** argv)
+{
+  TOPPPeptideDatabaseBuilder tool;
+  return tool.main(argc, argv);
+}
+
+/// @endcond
@@ -37,6 +37,7 @@
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
 #include <OpenMS/ANALYSIS/ID/PrecursorPurity.h>
 #include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
 #include <OpenMS/ANALYSIS/RNPXL/RNPxlModificationsGenerator.h>
 #include <OpenMS/ANALYSIS/RNPXL/RNPxlReport.h>
 #include <OpenMS/ANALYSIS/RNPXL/MorpheusScore.h>
@@ -182,6 +183,8 @@ protected:
     registerStringOption_("peptide:enzyme", "<cleavage site>", "Trypsin", "The enzyme used for peptide digestion.", false);
     setValidStrings_("peptide:enzyme", all_enzymes);
 
+    registerTOPPSubsection_("peptide_db", "Peptide Database Options");
+    registerStringOption_("peptide_db:cache_dir", "<dir>", "", "If set, the digested and modified peptides of the database are stored in this directory and reused by later searches (also of other tools, e.g. SimpleSearchEngine) with the same database and digestion settings.", false, true);
 
     registerTOPPSubsection_("report", "Reporting Options");
     registerIntOption_("report:top_hits", "<num>", 1, "Maximum number of top scoring hits per spectrum that are reported.", false, true);
@@ -1752,6 +1755,16 @@ protected:
                               spectra,
                               multimap_mass_2_scan_index);
 
+    // bin the peaks of each spectrum once for the HyperScore calculation of all candidates
+    vector<HyperScore::PreparedSpectrum> prepared_spectra(spectra.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
+    {
+      prepared_spectra[scan_index] = HyperScore::PreparedSpectrum(spectra[scan_index]);
+    }
+
     // initialize spectrum generators (generated ions, etc.)
     TheoreticalSpectrumGenerator total_loss_spectrum_generator;
     TheoreticalSpectrumGenerator partial_loss_spectrum_generator;
@@ -1803,8 +1816,6 @@ protected:
     digestor.setEnzyme(getStringOption_("peptide:enzyme"));
     digestor.setMissedCleavages(missed_cleavages);
 
-    progresslogger.startProgress(0, (Size)(fasta_db.end() - fasta_db.begin()), "Scoring peptide models against spectra...");
-
     // lookup for processed peptides. must be defined outside of omp section and synchronized
     set<StringView> processed_petides;
 
@@ -1812,51 +1823,102 @@ protected:
     Size min_peptide_length = (Size)getIntOption_("peptide:min_size");
     Size max_peptide_length = (Size)getIntOption_("peptide:max_size");
 
-    Size count_proteins(0), count_peptides(0);
+    // with a peptide database, the unique peptides are taken from the (cached) table instead of digesting every protein
+    // (the table enumerates the modified variants like ModifiedPeptideGenerator, so the same candidates are scored)
+    PeptideDatabase peptide_db;
+    vector<StringView> db_peptides;
+    const String peptide_db_cache_dir = getStringOption_("peptide_db:cache_dir");
+    const bool use_peptide_db = !peptide_db_cache_dir.empty();
+    if (use_peptide_db)
+    {
+      PeptideDatabase::Settings settings;
+      settings.enzyme = digestor.getEnzymeName();
+      settings.missed_cleavages = missed_cleavages;
+      settings.min_size = min_peptide_length;
+      settings.max_size = max_peptide_length;
+      settings.fixed_modifications = fixedModNames;
+      settings.variable_modifications = varModNames;
+      settings.max_variable_mods_per_peptide = max_variable_mods_per_peptide;
+
+      progresslogger.startProgress(0, 1, "Loading peptide database...");
+      const bool cached = peptide_db.loadOrBuild(peptide_db_cache_dir, fasta_db, settings);
+      progresslogger.endProgress();
+      OPENMS_LOG_INFO << (cached ? "Reusing" : "Created") << " peptide database '" << PeptideDatabase::getCacheFilename(peptide_db_cache_dir, peptide_db.getKey()) << "'." << endl;
+
+      db_peptides.reserve(peptide_db.size());
+      for (Size db_index = 0; db_index != peptide_db.size(); ++db_index)
+      {
+        db_peptides.push_back(peptide_db.getSequence(db_index));
+      }
+      sort(db_peptides.begin(), db_peptides.end());
+      db_peptides.erase(unique(db_peptides.begin(), db_peptides.end()), db_peptides.end());
+    }
+
+    // one batch per protein (digested here) or per unique peptide of the peptide database
+    const SignedSize batch_count = use_peptide_db ? (SignedSize)db_peptides.size() : (SignedSize)fasta_db.size();
+    progresslogger.startProgress(0, (Size)batch_count, "Scoring peptide models against spectra...");
+
+    Size count_proteins(0), count_peptides(0), count_batches(0);
 
 #ifdef _OPENMP
 #pragma omp parallel for schedule(guided)
 #endif
-    for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+    for (SignedSize batch_index = 0; batch_index < batch_count; ++batch_index)
     {
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
 
-      ++count_proteins;
+      ++count_batches;
 
       IF_MASTERTHREAD
       {
-        progresslogger.setProgress((SignedSize)count_proteins);
+        progresslogger.setProgress((SignedSize)count_batches);
       }
 
       vector<StringView> current_digest;
 
-      auto const & current_fasta_entry = fasta_db[fasta_index];
+      if (use_peptide_db)
+      {
+        current_digest.push_back(db_peptides[batch_index]);
+      }
+      else
+      {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++count_proteins;
+
+        auto const & current_fasta_entry = fasta_db[batch_index];
 
-      digestor.digestUnmodified(current_fasta_entry.sequence, current_digest, min_peptide_length, max_peptide_length);
+        digestor.digestUnmodified(current_fasta_entry.sequence, current_digest, min_peptide_length, max_peptide_length);
+      }
 
       for (auto cit = current_digest.begin(); cit != current_digest.end(); ++cit)
       {
-        bool already_processed = false;
+        // the peptides of the database are unique
+        if (!use_peptide_db)
+        {
+          bool already_processed = false;
 #ifdef _OPENMP
 #pragma omp critical (processed_peptides_access)
 #endif
-        {
-          // skip peptide (and all modified variants) if already processed
-          if (processed_petides.find(*cit) != processed_petides.end())
           {
-            already_processed = true;
+            // skip peptide (and all modified variants) if already processed
+            if (processed_petides.find(*cit) != processed_petides.end())
+            {
+              already_processed = true;
+            }
           }
-        }
 
-        if (already_processed) { continue; }
+          if (already_processed) { continue; }
 
 #ifdef _OPENMP
 #pragma omp critical (processed_peptides_access)
 #endif
-        {
-          processed_petides.insert(*cit);
+          {
+            processed_petides.insert(*cit);
+          }
         }
 
 #ifdef _OPENMP
@@ -1970,6 +2032,7 @@ protected:
                         tlss_Morph(0);
 
                   scoreTotalLossFragments_(exp_spectrum,
+                                         prepared_spectra[scan_index],
                                          total_loss_spectrum,
                                          fragment_mass_tolerance,
                                          fragment_mass_tolerance_unit_ppm,
@@ -2110,6 +2173,7 @@ protected:
                     PeakSpectrum & total_loss_spectrum = (exp_pc_charge < 3) ? total_loss_spectrum_z1 : total_loss_spectrum_z2;
 
                     scoreTotalLossFragments_(exp_spectrum,
+                                             prepared_spectra[scan_index],
                                              total_loss_spectrum,
                                              fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm,
                                              a_ion_sub_score_spectrum,
@@ -2127,6 +2191,7 @@ protected:
                     if (score < 0.01) { continue; }
 
                     scorePartialLossFragments_(exp_spectrum,
+                                               prepared_spectra[scan_index],
                                                fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm,
                                                partial_loss_spectrum_z1, partial_loss_spectrum_z2,
                                                marker_ions_sub_score_spectrum_z1,
@@ -2205,6 +2270,7 @@ protected:
                 PeakSpectrum & total_loss_spectrum = (exp_pc_charge < 3) ? total_loss_spectrum_z1 : total_loss_spectrum_z2;
 
                 scoreTotalLossFragments_(exp_spectrum,
+                                         prepared_spectra[scan_index],
                                          total_loss_spectrum,
                                          fragment_mass_tolerance,
                                          fragment_mass_tolerance_unit_ppm,
@@ -2270,9 +2336,9 @@ protected:
     }
     progresslogger.endProgress();
 
-    OPENMS_LOG_INFO << "Proteins: " << count_proteins << endl;
+    OPENMS_LOG_INFO << "Proteins: " << (use_peptide_db ? peptide_db.getNumberOfProteins() : count_proteins) << endl;
     OPENMS_LOG_INFO << "Peptides: " << count_peptides << endl;
-    OPENMS_LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
+    OPENMS_LOG_INFO << "Processed peptides: " << (use_peptide_db ? db_peptides.size() : processed_petides.size()) << endl;
 
     vector<PeptideIdentification> peptide_ids;
     vector<ProteinIdentification> protein_ids;
@@ -2385,6 +2451,7 @@ protected:
 
   // determine main score and sub scores of peaks without shifts
   void scoreTotalLossFragments_(const PeakSpectrum &exp_spectrum,
+                                const HyperScore::PreparedSpectrum &prepared_exp_spectrum,
                                 const PeakSpectrum &total_loss_spectrum,
                                 double fragment_mass_tolerance,
                                 bool fragment_mass_tolerance_unit_ppm,
@@ -2400,7 +2467,7 @@ protected:
                                 float &a_ion_sub_score) const
   {
     total_loss_score = HyperScore::compute(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm,
-                                           exp_spectrum, total_loss_spectrum);
+                                           prepared_exp_spectrum, total_loss_spectrum);
 
     // bad score, likely wihout any single matching peak
     if (total_loss_score < 0.01) { return; }
@@ -2444,6 +2511,7 @@ protected:
   }
 
   void scorePartialLossFragments_(const PeakSpectrum &exp_spectrum,
+                                  const HyperScore::PreparedSpectrum &prepared_exp_spectrum,
                                   double fragment_mass_tolerance,
                                   bool fragment_mass_tolerance_unit_ppm,
                                   const PeakSpectrum &partial_loss_spectrum_z1,
@@ -2481,7 +2549,7 @@ protected:
       if (exp_pc_charge < 3)
       {
         partial_loss_sub_score = HyperScore::compute(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm,
-                                                     exp_spectrum, partial_loss_spectrum_z1);
+                                                     prepared_exp_spectrum, partial_loss_spectrum_z1);
         auto const & pl_sub_scores = MorpheusScore::compute(fragment_mass_tolerance,
                                                            fragment_mass_tolerance_unit_ppm,
                                                            exp_spectrum,
@@ -2494,7 +2562,7 @@ protected:
       else //if (exp_pc_charge >= 3)
       {
         partial_loss_sub_score = HyperScore::compute(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm,
-                                                     exp_spectrum, partial_loss_spectrum_z2);
+                                                     prepared_exp_spectrum, partial_loss_spectrum_z2);
         auto const & pl_sub_scores = MorpheusScore::compute(fragment_mass_tolerance,
                                                            fragment_mass_tolerance_unit_ppm,
                                                            exp_spectrum,
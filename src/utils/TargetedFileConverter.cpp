@@ -34,6 +34,8 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionTSVFile.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionPQPFile.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/MappedTransitionLibrary.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/CONCEPT/Exception.h>
@@ -60,6 +62,7 @@ using namespace OpenMS;
           <li> @ref OpenMS::TraMLFile "TraML" </li>
           <li> @ref OpenMS::TransitionTSVFile "OpenSWATH TSV transition lists" </li>
           <li> @ref OpenMS::TransitionPQPFile "OpenSWATH PQP SQLite files" </li>
+          <li> @ref OpenMS::MappedTransitionLibrary "OpenSWATH binary transition libraries (tlib, output only)" </li>
           <li> SpectraST MRM transition lists </li>
           <li> Skyline transition lists </li>
           <li> Spectronaut transition lists </li>
@@ -94,7 +97,7 @@ protected:
     setValidFormats_("in", formats);
     setValidStrings_("in_type", formats);
 
-    formats = { "tsv", "pqp", "TraML" };
+    formats = { "tsv", "pqp", "TraML", "tlib" };
     registerOutputFile_("out", "<file>", "", "Output file");
     setValidFormats_("out", formats);
     registerStringOption_("out_type", "<type>", "", "Output file type -- default: determined from file extension or content\nNote: not all conversion paths work or make sense.", false);
@@ -150,6 +153,39 @@ protected:
     //--------------------------------------------------------------------------- 
     // Start Conversion
     //--------------------------------------------------------------------------- 
+    if (out_type == FileTypes::TLIB)
+    {
+      // binary libraries hold the content of a LightTargetedExperiment, which
+      // TSV and PQP files can be converted to directly
+      OpenSwath::LightTargetedExperiment light_exp;
+      Param reader_parameters = getParam_().copy("algorithm:", true);
+      if (in_type == FileTypes::TSV || in_type == FileTypes::MRM)
+      {
+        TransitionTSVFile tsv_reader;
+        tsv_reader.setLogType(log_type_);
+        tsv_reader.setParameters(reader_parameters);
+        tsv_reader.convertTSVToTargetedExperiment(in.c_str(), in_type, light_exp);
+      }
+      else if (in_type == FileTypes::PQP)
+      {
+        TransitionPQPFile pqp_reader;
+        pqp_reader.setLogType(log_type_);
+        pqp_reader.setParameters(reader_parameters);
+        pqp_reader.convertPQPToTargetedExperiment(in.c_str(), light_exp, legacy_traml_id);
+      }
+      else if (in_type == FileTypes::TRAML)
+      {
+        TargetedExperiment targeted_exp;
+        TraMLFile().load(in, targeted_exp);
+        OpenSwathDataAccessHelper::convertTargetedExp(targeted_exp, light_exp);
+      }
+
+      MappedTransitionLibrary library;
+      library.build(light_exp);
+      library.store(out);
+      return EXECUTION_OK;
+    }
+
     TargetedExperiment targeted_exp;
     if (in_type == FileTypes::TSV || in_type == FileTypes::MRM)
     {
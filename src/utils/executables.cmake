@@ -39,6 +39,7 @@ NucleicAcidSearchEngine
 OpenMSDatabasesInfo
 OpenMSInfo
 PeakPickerIterative
+PeptideDatabaseBuilder
 PSMFeatureExtractor
 QCCalculator
 QCEmbedder